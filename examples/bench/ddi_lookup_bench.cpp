@@ -0,0 +1,79 @@
+#include <agrobus/isobus/tc/ddi_database.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// Converts 1M logged samples to engineering units the way a task controller
+// does when it records process data: a realistic mix of rate, geometry,
+// section-state and high-range DDIs. Compares the previous linear table scan
+// with the indexed ddi_to_engineering() and the compile-time Ddi<N> helpers.
+
+static constexpr usize SAMPLES = 1'000'000;
+
+static const DDIDefinition *linear_lookup(u16 ddi) {
+    for (usize i = 0; i < DDI_DATABASE_SIZE; ++i)
+        if (DDI_DATABASE[i].ddi == ddi)
+            return &DDI_DATABASE[i];
+    return nullptr;
+}
+
+static f64 linear_to_engineering(u16 ddi, i32 raw) {
+    auto *def = linear_lookup(ddi);
+    return static_cast<f64>(raw) * (def ? def->resolution : 1.0);
+}
+
+template <typename F> static f64 time_ms(F &&fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main() {
+    echo::info("=== DDI lookup benchmark ===");
+
+    const u16 mix[] = {ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE, ddi::ACTUAL_MASS_PER_AREA_APPLICATION_RATE,
+                       ddi::ACTUAL_WORKING_WIDTH,                    ddi::TOTAL_AREA,
+                       ddi::ACTUAL_WORK_STATE,                       ddi::ACTUAL_CONDENSED_WORK_STATE_1_16,
+                       ddi::DEVICE_ELEMENT_OFFSET_X,                 ddi::ACTUAL_TEMPERATURE,
+                       ddi::ACTUAL_CROP_CONDITIONING_INTENSITY,      ddi::PGN_BASED_DATA};
+    constexpr usize MIX = sizeof(mix) / sizeof(mix[0]);
+
+    dp::Vector<u16> ddis(SAMPLES);
+    dp::Vector<i32> raws(SAMPLES);
+    u32 rng = 12345;
+    for (usize i = 0; i < SAMPLES; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        ddis[i] = mix[(rng >> 16) % MIX];
+        raws[i] = static_cast<i32>(rng & 0xFFFFF);
+    }
+
+    f64 sum_linear = 0.0, sum_indexed = 0.0, sum_typed = 0.0;
+    f64 linear_ms = time_ms([&] {
+        for (usize i = 0; i < SAMPLES; ++i)
+            sum_linear += linear_to_engineering(ddis[i], raws[i]);
+    });
+    f64 indexed_ms = time_ms([&] {
+        for (usize i = 0; i < SAMPLES; ++i)
+            sum_indexed += ddi_to_engineering(ddis[i], raws[i]);
+    });
+    // Typed path: a stream of one known DDI, e.g. a logged rate column
+    f64 typed_ms = time_ms([&] {
+        for (usize i = 0; i < SAMPLES; ++i)
+            sum_typed += Ddi<ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE>::to_engineering(raws[i]);
+    });
+
+    echo::info("linear scan:  ", linear_ms, " ms (", linear_ms * 1e6 / SAMPLES, " ns/sample)");
+    echo::info("indexed:      ", indexed_ms, " ms (", indexed_ms * 1e6 / SAMPLES, " ns/sample), ",
+               linear_ms / indexed_ms, "x faster");
+    echo::info("Ddi<N>:       ", typed_ms, " ms (", typed_ms * 1e6 / SAMPLES, " ns/sample)");
+    echo::info("dense slots:  ", detail::DDI_DENSE_LIMIT, " DDIs (", sizeof(detail::DDI_DENSE_SLOTS), " bytes), ",
+               DDI_DATABASE_SIZE - detail::DDI_DENSE_ENTRIES, " entries by binary search");
+
+    bool same = sum_linear == sum_indexed;
+    if (!same)
+        echo::error("indexed conversion disagrees with the linear scan");
+    echo::info("checksum ", sum_indexed, " / ", sum_typed);
+    return same && indexed_ms < linear_ms ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include <agrobus/isobus/tc/ddop.hpp>
+#include <agrobus/isobus/tc/ddop_helpers.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// A 3,000-object DDOP: a large seeder with 500 row sections, each carrying
+// work-state process data and offset/width properties. Times validate(),
+// repeated serialization (every reconnect re-enters TransferDDOP), object
+// lookups and section geometry extraction against the linear scans the pool
+// used before it was indexed.
+
+static constexpr u32 SECTIONS = 500;
+static constexpr u32 ROUNDS = 200;
+
+static DDOP build_pool() {
+    DDOP ddop;
+    ddop.add_device(DeviceObject{}.set_designator("Seeder 50m").set_software_version("2.4"));
+    ObjectID root = ddop.add_element(DeviceElement{}.set_type(DeviceElementType::Device).set_designator("Seeder"))
+                        .value();
+    ObjectID vp_mm = ddop.add_value_presentation(DeviceValuePresentation{}.set_scale(0.001f).set_unit("m")).value();
+    ObjectID vp_rate = ddop.add_value_presentation(DeviceValuePresentation{}.set_unit("seeds/m2")).value();
+    ObjectID boom = ddop.add_element(DeviceElement{}
+                                         .set_type(DeviceElementType::Function)
+                                         .set_number(1)
+                                         .set_parent(root)
+                                         .set_designator("Bar"))
+                        .value();
+
+    for (u32 s = 0; s < SECTIONS; ++s) {
+        DeviceElement sec;
+        sec.set_type(DeviceElementType::Section).set_number(static_cast<ElementNumber>(s + 2)).set_parent(boom);
+        sec.set_designator("Row " + dp::to_string(s + 1));
+        sec.add_child(ddop.add_process_data(DeviceProcessData{}.set_ddi(ddi::ACTUAL_WORK_STATE)).value());
+        sec.add_child(ddop.add_process_data(DeviceProcessData{}
+                                                .set_ddi(ddi::SETPOINT_COUNT_PER_AREA_APPLICATION_RATE)
+                                                .set_presentation(vp_rate))
+                          .value());
+        sec.add_child(
+            ddop.add_property(DeviceProperty{}.set_ddi(ddi::DEVICE_ELEMENT_OFFSET_X).set_value(-2500)).value());
+        sec.add_child(ddop.add_property(DeviceProperty{}
+                                            .set_ddi(ddi::DEVICE_ELEMENT_OFFSET_Y)
+                                            .set_value(static_cast<i32>(s * 100) - 25000)
+                                            .set_presentation(vp_mm))
+                          .value());
+        sec.add_child(ddop.add_property(DeviceProperty{}.set_ddi(ddi::ACTUAL_WORKING_WIDTH).set_value(100)).value());
+        ddop.add_element(std::move(sec));
+    }
+    return ddop;
+}
+
+// Pre-index behaviour: linear existence check over all five object vectors
+static bool linear_exists(const DDOP &ddop, ObjectID id) {
+    for (const auto &d : ddop.devices())
+        if (d.id == id)
+            return true;
+    for (const auto &e : ddop.elements())
+        if (e.id == id)
+            return true;
+    for (const auto &pd : ddop.process_data())
+        if (pd.id == id)
+            return true;
+    for (const auto &p : ddop.properties())
+        if (p.id == id)
+            return true;
+    for (const auto &vp : ddop.value_presentations())
+        if (vp.id == id)
+            return true;
+    return false;
+}
+
+static usize linear_validate(const DDOP &ddop) {
+    usize refs = 0;
+    for (const auto &elem : ddop.elements()) {
+        refs += elem.parent_id == 0 || linear_exists(ddop, elem.parent_id);
+        for (auto child : elem.child_objects)
+            refs += linear_exists(ddop, child);
+    }
+    return refs;
+}
+
+static dp::Vector<u8> full_serialize(const DDOP &ddop) {
+    dp::Vector<u8> data;
+    auto append = [&data](const dp::Vector<u8> &bytes) { data.insert(data.end(), bytes.begin(), bytes.end()); };
+    for (const auto &o : ddop.devices())
+        append(o.serialize());
+    for (const auto &o : ddop.elements())
+        append(o.serialize());
+    for (const auto &o : ddop.process_data())
+        append(o.serialize());
+    for (const auto &o : ddop.properties())
+        append(o.serialize());
+    for (const auto &o : ddop.value_presentations())
+        append(o.serialize());
+    return data;
+}
+
+template <typename F> static f64 time_us(u32 rounds, F &&fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < rounds; ++i)
+        fn();
+    return std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - t0).count() / rounds;
+}
+
+int main() {
+    echo::info("=== DDOP index benchmark ===");
+    DDOP ddop = build_pool();
+    echo::info(ddop.object_count(), " objects, ", ddop.image().size(), " bytes serialized");
+
+    usize sink = 0;
+    f64 validate_linear = time_us(20, [&] { sink += linear_validate(ddop); });
+    f64 validate_indexed = time_us(ROUNDS, [&] { sink += ddop.validate().is_ok(); });
+    f64 serialize_full = time_us(ROUNDS, [&] { sink += full_serialize(ddop).size(); });
+    f64 serialize_cached = time_us(ROUNDS, [&] { sink += ddop.serialize().value().size(); });
+
+    const ObjectID last = static_cast<ObjectID>(ddop.object_count() - 1);
+    f64 lookup_linear = time_us(ROUNDS, [&] { sink += linear_exists(ddop, last); });
+    f64 lookup_indexed = time_us(ROUNDS * 100, [&] { sink += ddop.property(last) != nullptr; });
+    f64 geometry = time_us(ROUNDS, [&] { sink += DDOPHelpers::extract_geometry(ddop).sections.size(); });
+
+    // Index rebuild after a mutation (first lookup pays it once)
+    f64 rebuild = time_us(ROUNDS, [&] {
+        ddop.add_value_presentation(DeviceValuePresentation{}.set_unit("x"));
+        sink += ddop.contains(last);
+    });
+
+    echo::info("validate:   linear ", validate_linear, " us, indexed ", validate_indexed, " us (",
+               validate_linear / validate_indexed, "x)");
+    echo::info("serialize:  rebuild ", serialize_full, " us, cached copy ", serialize_cached, " us (",
+               serialize_full / serialize_cached, "x)");
+    echo::info("lookup:     linear ", lookup_linear * 1000.0, " ns, indexed ", lookup_indexed * 1000.0, " ns");
+    echo::info("geometry:   ", geometry, " us for ", SECTIONS, " sections");
+    echo::info("re-index:   ", rebuild, " us after a mutation");
+    echo::info("(checksum ", sink, ")");
+
+    return validate_indexed < validate_linear && serialize_cached < serialize_full ? 0 : 1;
+}
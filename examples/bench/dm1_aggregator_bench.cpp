@@ -0,0 +1,110 @@
+#include <agrobus.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::j1939;
+
+// 50 ECUs each broadcast a DM1 with 20 DTCs once a second for ten minutes;
+// every second one ECU's DM1 actually changes (an occurrence count, or a DTC
+// swapped for another). Compares a display that decodes every DM1 and diffs
+// it against its table (what an on_dm1_received listener has to do) with the
+// aggregator, which skips unchanged payloads by hash.
+
+static constexpr u32 ECUS = 50;
+static constexpr u32 DTCS_PER_ECU = 20;
+static constexpr u32 SECONDS = 600;
+
+static dp::Vector<u8> encode_dm1(const DiagnosticLamps &lamps, const dp::Vector<DTC> &dtcs) {
+    auto lamp_bytes = lamps.encode();
+    dp::Vector<u8> data{lamp_bytes[0], lamp_bytes[1]};
+    for (const auto &dtc : dtcs) {
+        auto bytes = dtc.encode();
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+    return data;
+}
+
+// Decodes every message and looks each DTC up in the previous table
+struct DecodeEveryTime {
+    dp::Map<Address, dp::Vector<DTC>> tables;
+    u64 events = 0;
+
+    void on_dm1(Address source, const dp::Vector<u8> &data) {
+        dp::Vector<DTC> now;
+        for (usize i = 2; i + 3 < data.size(); i += 4) {
+            DTC dtc = DTC::decode(&data[i]);
+            if (dtc.spn != 0 || static_cast<u8>(dtc.fmi) != 0)
+                now.push_back(dtc);
+        }
+        auto &before = tables[source];
+        for (const auto &dtc : now) {
+            auto it = std::find(before.begin(), before.end(), dtc);
+            if (it == before.end() || it->occurrence_count != dtc.occurrence_count)
+                ++events; // added or count changed
+        }
+        for (const auto &dtc : before)
+            if (std::find(now.begin(), now.end(), dtc) == now.end())
+                ++events; // removed
+        before = std::move(now);
+    }
+};
+
+struct Traffic {
+    Address source;
+    dp::Vector<u8> data;
+};
+
+int main() {
+    echo::info("=== DM1 aggregator benchmark (", ECUS, " ECUs x ", DTCS_PER_ECU, " DTCs, ", SECONDS,
+               " s of DM1 broadcasts) ===");
+
+    // Build the whole recording first so both consumers see identical bytes
+    DiagnosticLamps lamps;
+    lamps.amber_warning = LampStatus::On;
+    dp::Vector<dp::Vector<DTC>> ecu(ECUS);
+    for (u32 e = 0; e < ECUS; ++e)
+        for (u32 d = 0; d < DTCS_PER_ECU; ++d)
+            ecu[e].push_back(DTC{1000 + e * 100 + d, static_cast<FMI>(d % 14), 1});
+
+    dp::Vector<Traffic> recording;
+    recording.reserve(ECUS * SECONDS);
+    u32 rng = 12345;
+    for (u32 s = 0; s < SECONDS; ++s) {
+        rng = rng * 1103515245 + 12345;
+        auto &dtcs = ecu[(rng >> 8) % ECUS];
+        auto &dtc = dtcs[(rng >> 16) % DTCS_PER_ECU];
+        if (s % 3 == 0)
+            dtc.spn += 50; // a different fault
+        else
+            dtc.occurrence_count = static_cast<u8>(dtc.occurrence_count % 126 + 1);
+        for (u32 e = 0; e < ECUS; ++e)
+            recording.push_back({static_cast<Address>(0x10 + e), encode_dm1(lamps, ecu[e])});
+    }
+
+    DecodeEveryTime naive;
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto &msg : recording)
+        naive.on_dm1(msg.source, msg.data);
+    f64 naive_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+    DM1Aggregator agg;
+    u64 events = 0;
+    agg.on_dtc_added.subscribe([&](const FleetDTC &) { ++events; });
+    agg.on_dtc_removed.subscribe([&](const FleetDTC &) { ++events; });
+    agg.on_occurrence_changed.subscribe([&](const FleetDTC &, u8) { ++events; });
+    t0 = std::chrono::steady_clock::now();
+    for (const auto &msg : recording)
+        agg.ingest(msg.source, msg.data.data(), msg.data.size());
+    f64 agg_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+    const auto &stats = agg.stats();
+    echo::info("decode every DM1: ", naive_ns / recording.size(), " ns/message, ", naive.events, " events");
+    echo::info("aggregator:       ", agg_ns / recording.size(), " ns/message, ", events, " events; ", stats.decoded,
+               " of ", stats.messages, " decoded");
+    echo::info("speedup ", naive_ns / agg_ns, "x; ", agg.active_dtcs().size(), " active DTCs, ",
+               agg.count(DTCSeverity::Warning), " at warning level");
+
+    bool ok = events == naive.events && agg.active_dtcs().size() == ECUS * DTCS_PER_ECU && agg_ns < naive_ns;
+    return ok ? 0 : 1;
+}
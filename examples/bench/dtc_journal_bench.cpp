@@ -0,0 +1,127 @@
+#include <agrobus.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+#include <filesystem>
+
+using namespace agrobus::net;
+using namespace agrobus::j1939;
+
+// Writes a 100,000-record DTC journal to a file the way a machine with
+// intermittent faults would over many key cycles (activation with a freeze
+// frame, then the DTC going inactive into DM2 history), then measures how long
+// a restart takes to replay it, before and after compaction.
+
+static constexpr u32 RECORDS = 100'000;
+static constexpr u32 RECORDS_PER_EPISODE = 5; // active, freeze frame, inactive, previous, history
+static constexpr u32 FAULTS = 400;            // distinct SPN/FMI pairs
+
+static bool same_state(const DiagnosticProtocol &a, const DiagnosticProtocol &b) {
+    auto dtcs_equal = [](const dp::Vector<DTC> &x, const dp::Vector<DTC> &y) {
+        if (x.size() != y.size())
+            return false;
+        for (usize i = 0; i < x.size(); ++i)
+            if (!(x[i] == y[i]) || x[i].occurrence_count != y[i].occurrence_count)
+                return false;
+        return true;
+    };
+    if (!dtcs_equal(a.active_dtcs(), b.active_dtcs()) || !dtcs_equal(a.previous_dtcs(), b.previous_dtcs()))
+        return false;
+    const auto &ha = a.previously_active_dtcs();
+    const auto &hb = b.previously_active_dtcs();
+    if (ha.size() != hb.size())
+        return false;
+    for (usize i = 0; i < ha.size(); ++i)
+        if (!(ha[i].dtc == hb[i].dtc) || ha[i].occurrence_count != hb[i].occurrence_count)
+            return false;
+    if (a.freeze_frames().size() != b.freeze_frames().size())
+        return false;
+    for (const auto &[key, frames] : a.freeze_frames()) {
+        auto it = b.freeze_frames().find(key);
+        if (it == b.freeze_frames().end() || it->second.size() != frames.size())
+            return false;
+        for (usize i = 0; i < frames.size(); ++i)
+            if (frames[i].encode() != it->second[i].encode())
+                return false;
+    }
+    return true;
+}
+
+struct Replay {
+    f64 ms = 0;
+    u64 records = 0;
+    bool ok = false;
+};
+
+static Replay replay(const std::filesystem::path &path, const DiagnosticProtocol &live) {
+    IsoNet nm;
+    DiagnosticProtocol diag(nm, nm.create_internal(Name{}, 0, 0x28).value());
+    FileNvm nvm(path);
+    DTCJournal journal(nvm);
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool attached = diag.attach_store(journal).is_ok();
+    Replay out;
+    out.ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    out.records = journal.stats().records_replayed;
+    out.ok = attached && same_state(live, diag);
+    return out;
+}
+
+int main() {
+    echo::info("=== DTC journal replay benchmark (", RECORDS, " records, ", FAULTS, " faults) ===");
+
+    auto dir = std::filesystem::temp_directory_path() / "agrobus_dtc_journal_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto path = dir / "dtc.journal";
+
+    // Build the journal without compaction or per-record fdatasync
+    IsoNet nm;
+    DiagnosticProtocol live(nm, nm.create_internal(Name{}, 0, 0x28).value(),
+                            DiagnosticConfig{}.auto_capture_freeze_frames_enabled(false));
+    f64 write_ms = 0;
+    {
+        FileNvm nvm(path);
+        DTCJournal journal(nvm, DTCJournalConfig{}.compact_at(usize(-1)).durable(false));
+        if (!live.attach_store(journal).is_ok()) {
+            echo::error("cannot open ", path.string());
+            return 1;
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        for (u32 i = 0; i < RECORDS / RECORDS_PER_EPISODE; ++i) {
+            DTC dtc{500 + (i * 7919) % FAULTS, static_cast<FMI>(i % 4), 0};
+            live.set_active(dtc);
+            live.capture_freeze_frame(dtc, {{190, 800 + i % 1200}, {110, 80 + i % 30}, {100, 300}}, i * 100);
+            live.clear_active(dtc.spn, dtc.fmi);
+        }
+        live.set_active({91, FMI::AboveNormal, 0}); // still active at shutdown
+        journal.flush();
+        write_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        live.detach_store();
+    }
+    usize journal_bytes = std::filesystem::file_size(path);
+    echo::info("wrote ", journal_bytes / 1024, " KB in ", write_ms, " ms (write-behind, no sync)");
+
+    Replay full = replay(path, live);
+    echo::info("replay of full journal: ", full.records, " records in ", full.ms, " ms (",
+               full.records / std::max(full.ms, 1e-3) / 1000.0, " M records/s)", full.ok ? "" : " (MISMATCH)");
+
+    // Compact, as the journal would have done on its own past 64 KB
+    {
+        FileNvm nvm(path);
+        DTCJournal journal(nvm);
+        if (journal.load(live.limits()).is_ok())
+            journal.compact(live.state());
+        journal.flush();
+    }
+    usize compact_bytes = std::filesystem::file_size(path);
+    Replay compacted = replay(path, live);
+    echo::info("after compaction: ", compact_bytes / 1024, " KB, ", compacted.records, " records in ", compacted.ms,
+               " ms", compacted.ok ? "" : " (MISMATCH)");
+    echo::info("live state: ", live.active_dtcs().size(), " active, ", live.previous_dtcs().size(), " previous, ",
+               live.freeze_frames().size(), " DTCs with freeze frames");
+
+    std::filesystem::remove_all(dir);
+    bool ok = full.ok && compacted.ok && full.records == RECORDS + 1 && compact_bytes < journal_bytes / 10;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+#include <agrobus.hpp>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <echo/echo.hpp>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+// A TASKDATA directory with 10,000 log files on a volume holding 100,000
+// files. Lists a small sibling directory through the directory tree and
+// through a flat path index (how the in-memory volume used to list), then
+// reads the whole 10K directory page by page over a simulated bus, twice,
+// with a write in between, to show the encoded listing is built once and
+// patched rather than rebuilt.
+
+static constexpr u32 BIG_DIR = 10'000;
+static constexpr u32 OTHER_DIRS = 9;
+
+// One direction of the bus
+class QueueLink : public wirebit::Link {
+    std::deque<wirebit::Frame> *tx_;
+    std::deque<wirebit::Frame> *rx_;
+
+  public:
+    QueueLink(std::deque<wirebit::Frame> *tx, std::deque<wirebit::Frame> *rx) : tx_(tx), rx_(rx) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        tx_->push_back(frame);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        if (rx_->empty())
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+        auto frame = std::move(rx_->front());
+        rx_->pop_front();
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::ok(std::move(frame));
+    }
+    wirebit::String name() const override { return "queue"; }
+};
+
+// Every path in one ordered map; a listing scans all of them for the prefix
+struct FlatIndex {
+    dp::Map<dp::String, u32> files;
+
+    usize list(const dp::String &directory) const {
+        usize n = 0;
+        for (const auto &[path, size] : files)
+            n += path.find(directory) == 0;
+        return n;
+    }
+};
+
+static dp::String log_name(u32 i) {
+    char name[24];
+    std::snprintf(name, sizeof(name), "LOG%05u.BIN", i);
+    return name;
+}
+
+template <typename F> static f64 time_us(F &&f, u32 reps) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < reps; ++i)
+        f();
+    return std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - t0).count() / reps;
+}
+
+int main() {
+    echo::info("=== File server directory benchmark (", BIG_DIR, "-file directory, ", BIG_DIR * (OTHER_DIRS + 1),
+               " files) ===");
+
+    std::deque<wirebit::Frame> to_client, to_server;
+    wirebit::CanEndpoint server_ep{std::make_shared<QueueLink>(&to_client, &to_server), wirebit::CanConfig{}, 1};
+    wirebit::CanEndpoint client_ep{std::make_shared<QueueLink>(&to_server, &to_client), wirebit::CanConfig{}, 2};
+    IsoNet server_net, client_net;
+    server_net.set_endpoint(0, &server_ep);
+    client_net.set_endpoint(0, &client_ep);
+    FileServerEnhanced server(server_net, server_net.create_internal(Name{}, 0, 0x20).value());
+    FileClient client(client_net, client_net.create_internal(Name{}, 0, 0x80).value());
+    server.initialize();
+    client.initialize();
+
+    FlatIndex flat;
+    for (u32 d = 0; d <= OTHER_DIRS; ++d) {
+        dp::String dir = d == 0 ? dp::String("\\TASKDATA\\") : "\\FIELD" + dp::to_string(d) + "\\";
+        for (u32 i = 0; i < BIG_DIR; ++i) {
+            server.add_file(dir + log_name(i), dp::Vector<u8>(i % 64));
+            flat.files[dir + log_name(i)] = i % 64;
+        }
+    }
+    for (u32 i = 0; i < 10; ++i) {
+        server.add_file("\\SETTINGS\\" + log_name(i), {1});
+        flat.files["\\SETTINGS\\" + log_name(i)] = 1;
+    }
+
+    // Small directory next to 100K files
+    usize sink = 0;
+    f64 tree_us = time_us([&] { sink += server.volume().list("\\SETTINGS\\").size(); }, 1000);
+    f64 flat_us = time_us([&] { sink += flat.list("\\SETTINGS\\"); }, 20);
+    echo::info("list 10-file directory: tree ", tree_us, " us, flat index ", flat_us, " us (", flat_us / tree_us,
+               "x)");
+
+    auto step = [&] {
+        server_net.update(1);
+        server.update(1);
+        client_net.update(1);
+        client.update(1);
+    };
+    auto wait = [&](bool &done) {
+        for (u32 i = 0; i < 100'000 && !done; ++i)
+            step();
+        return done;
+    };
+
+    client.connect_to_server(0x20);
+    for (u32 i = 0; i < 20; ++i)
+        step();
+
+    FileHandle handle = INVALID_FILE_HANDLE;
+    bool done = false;
+    client.open_file("\\TASKDATA\\", OpenFlags::OpenDir, [&](Result<FileHandle> r) {
+        done = true;
+        handle = r.is_ok() ? r.value() : INVALID_FILE_HANDLE;
+    });
+    if (!wait(done) || handle == INVALID_FILE_HANDLE) {
+        echo::error("open directory failed");
+        return 1;
+    }
+
+    // Whole directory, page by page; returns entries and wall time
+    auto list_all = [&](dp::Vector<FileEntry> &entries, usize &pages) {
+        entries.clear();
+        pages = 0;
+        bool seeked = false;
+        client.seek_file(handle, 0, [&](Result<void>) { seeked = true; });
+        wait(seeked);
+        auto t0 = std::chrono::steady_clock::now();
+        while (true) {
+            bool page_done = false;
+            dp::Vector<FileEntry> page;
+            client.read_directory(handle, 0xFFFF, [&](Result<dp::Vector<FileEntry>> r) {
+                page_done = true;
+                if (r.is_ok())
+                    page = r.value();
+            });
+            if (!wait(page_done) || page.empty())
+                break;
+            ++pages;
+            entries.insert(entries.end(), page.begin(), page.end());
+        }
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+
+    dp::Vector<FileEntry> entries;
+    usize pages = 0;
+    f64 first_ms = list_all(entries, pages);
+    bool complete = entries.size() == BIG_DIR;
+    for (u32 i = 0; complete && i < BIG_DIR; ++i)
+        complete = entries[i].name == log_name(i) && entries[i].size == i % 64;
+    echo::info("first listing: ", entries.size(), " entries in ", pages, " pages, ", first_ms,
+               " ms through both stacks");
+
+    // Append to one log file, then list again
+    FileHandle log = INVALID_FILE_HANDLE;
+    done = false;
+    client.open_file("\\TASKDATA\\" + log_name(4242), OpenFlags::Write | OpenFlags::Append,
+                     [&](Result<FileHandle> r) {
+                         done = true;
+                         log = r.is_ok() ? r.value() : INVALID_FILE_HANDLE;
+                     });
+    wait(done);
+    done = false;
+    client.write_file(log, dp::Vector<u8>(100, 0x55), [&](Result<u16>) { done = true; });
+    wait(done);
+
+    f64 second_ms = list_all(entries, pages);
+    bool patched = entries.size() == BIG_DIR && entries[4242].size == 100;
+    const auto &stats = server.listing_stats();
+    echo::info("second listing after a write: ", second_ms, " ms; listing builds ", stats.builds, ", pages ",
+               stats.pages, ", size patches ", stats.patches, ", invalidations ", stats.invalidations);
+
+    bool ok = complete && patched && stats.builds == 1 && flat_us > tree_us * 10 && sink > 0;
+    return ok ? 0 : 1;
+}
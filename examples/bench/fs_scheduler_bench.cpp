@@ -0,0 +1,193 @@
+#include <agrobus.hpp>
+#include <cstring>
+#include <deque>
+#include <echo/echo.hpp>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+// Two clients share one file server on a 250 kbit/s bus: a logger pulling a
+// large file in pipelined 1780-byte blocks and a VT loading a 4 KB config in
+// 255-byte requests. With arrival-order (FIFO) scheduling the VT's requests
+// wait behind the logger's pipeline for the response budget; with deficit
+// round-robin they are served on the next round. Times are simulated bus time.
+
+static constexpr usize BIG_FILE = 256 * 1024;
+static constexpr usize CONFIG_FILE = 4 * 1024;
+static constexpr f64 BITS_PER_FRAME = 130.0; // extended frame, 8 data bytes, average stuffing
+static constexpr f64 FRAMES_PER_MS = 250'000.0 / BITS_PER_FRAME / 1000.0;
+static constexpr u32 TASK_PERIOD_MS = 10;
+static constexpr f32 RESPONSE_BUDGET = 0.4f;
+
+// A shared bus: frames wait on the wire and reach every other node as fast as
+// the bitrate allows
+struct Bus {
+    std::deque<std::pair<usize, wirebit::Frame>> wire;
+    dp::Vector<std::deque<wirebit::Frame>> rx;
+    f64 budget = 0;
+
+    explicit Bus(usize nodes) : rx(nodes) {}
+
+    void tick() {
+        budget = std::min(budget + FRAMES_PER_MS, FRAMES_PER_MS * TASK_PERIOD_MS);
+        while (budget >= 1.0 && !wire.empty()) {
+            auto &[from, frame] = wire.front();
+            for (usize i = 0; i < rx.size(); ++i)
+                if (i != from)
+                    rx[i].push_back(frame);
+            wire.pop_front();
+            budget -= 1.0;
+        }
+    }
+};
+
+// Each node's acceptance filter drops frames addressed to another node
+class BusLink : public wirebit::Link {
+    Bus *bus_;
+    usize node_;
+    Address address_;
+
+    bool accepts(const wirebit::Frame &frame) const {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        u8 pf = static_cast<u8>(cf.can_id >> 16);
+        u8 ps = static_cast<u8>(cf.can_id >> 8);
+        return pf >= 240 || ps == BROADCAST_ADDRESS || ps == address_;
+    }
+
+  public:
+    BusLink(Bus *bus, usize node, Address address) : bus_(bus), node_(node), address_(address) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        bus_->wire.emplace_back(node_, frame);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        auto &rx = bus_->rx[node_];
+        while (!rx.empty() && !accepts(rx.front()))
+            rx.pop_front();
+        if (rx.empty())
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+        auto frame = std::move(rx.front());
+        rx.pop_front();
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::ok(std::move(frame));
+    }
+    wirebit::String name() const override { return "bus"; }
+};
+
+struct Run {
+    u32 vt_load_ms = 0;
+    f64 logger_kbs = 0;
+    u32 vt_max_wait_ms = 0;
+    f64 vt_mean_wait_ms = 0;
+    u32 logger_max_wait_ms = 0;
+    bool ok = false;
+};
+
+static dp::Vector<u8> content(usize size, u8 seed) {
+    dp::Vector<u8> data(size);
+    for (usize i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(i * 131 + seed + (i >> 9));
+    return data;
+}
+
+static Run run(FSSchedulePolicy policy) {
+    Run out;
+    Bus bus(3);
+    wirebit::CanEndpoint server_ep{std::make_shared<BusLink>(&bus, 0, 0x20), wirebit::CanConfig{}, 1};
+    wirebit::CanEndpoint logger_ep{std::make_shared<BusLink>(&bus, 1, 0x81), wirebit::CanConfig{}, 2};
+    wirebit::CanEndpoint vt_ep{std::make_shared<BusLink>(&bus, 2, 0x82), wirebit::CanConfig{}, 3};
+    IsoNet server_net, logger_net, vt_net;
+    server_net.set_endpoint(0, &server_ep);
+    logger_net.set_endpoint(0, &logger_ep);
+    vt_net.set_endpoint(0, &vt_ep);
+
+    FileServerEnhanced server(server_net, server_net.create_internal(Name{}, 0, 0x20).value(),
+                              FileServerConfig{}.scheduling(policy).response_budget(RESPONSE_BUDGET));
+    InternalCF *logger_cf = logger_net.create_internal(Name{}, 0, 0x81).value();
+    InternalCF *vt_cf = vt_net.create_internal(Name{}, 0, 0x82).value();
+    FileClient logger(logger_net, logger_cf, FileClientConfig{}.block_size(FS_TP_BLOCK_SIZE).window(8));
+    FileClient vt(vt_net, vt_cf, FileClientConfig{}.block_size(255).window(1));
+    server.initialize();
+    logger.initialize();
+    vt.initialize();
+
+    auto big = content(BIG_FILE, 1);
+    auto config = content(CONFIG_FILE, 2);
+    server.add_file("\\LOG\\FIELD.BIN", big);
+    server.add_file("\\VT\\CONFIG.BIN", config);
+
+    u32 now_ms = 0;
+    auto step = [&] {
+        for (u32 i = 0; i < TASK_PERIOD_MS; ++i)
+            bus.tick();
+        server_net.update(TASK_PERIOD_MS);
+        server.update(TASK_PERIOD_MS);
+        logger_net.update(TASK_PERIOD_MS);
+        logger.update(TASK_PERIOD_MS);
+        vt_net.update(TASK_PERIOD_MS);
+        vt.update(TASK_PERIOD_MS);
+        now_ms += TASK_PERIOD_MS;
+    };
+
+    logger.connect_to_server(0x20);
+    vt.connect_to_server(0x20);
+    while ((!logger.is_connected() || !vt.is_connected()) && now_ms < 1000)
+        step();
+
+    dp::Vector<u8> logged, loaded;
+    bool logger_done = false, logger_ok = false, vt_done = false, vt_ok = false;
+    u32 logger_start = now_ms;
+    logger.download_file(
+        "\\LOG\\FIELD.BIN", [&](const u8 *data, usize n) { logged.insert(logged.end(), data, data + n); },
+        [&](Result<u64> r) {
+            logger_done = true;
+            logger_ok = r.is_ok();
+        });
+
+    // The VT starts once the logger's pipeline is full
+    for (u32 i = 0; i < 100; ++i)
+        step();
+    u32 vt_start = now_ms;
+    vt.download_file(
+        "\\VT\\CONFIG.BIN", [&](const u8 *data, usize n) { loaded.insert(loaded.end(), data, data + n); },
+        [&](Result<u64> r) {
+            vt_done = true;
+            vt_ok = r.is_ok();
+            out.vt_load_ms = now_ms - vt_start;
+        });
+
+    while ((!logger_done || !vt_done) && now_ms < 600'000)
+        step();
+    out.logger_kbs = BIG_FILE / 1024.0 / ((now_ms - logger_start) / 1000.0);
+
+    // Per-client statistics, read before the clients go quiet and time out
+    if (const auto *stats = server.client_stats(0x82)) {
+        out.vt_max_wait_ms = stats->max_latency_ms;
+        out.vt_mean_wait_ms = stats->mean_latency_ms();
+    }
+    if (const auto *stats = server.client_stats(0x81))
+        out.logger_max_wait_ms = stats->max_latency_ms;
+
+    out.ok = logger_ok && vt_ok && logged == big && loaded == config;
+    return out;
+}
+
+int main() {
+    echo::info("=== File server scheduling benchmark (", BIG_FILE / 1024, " KB log download + ", CONFIG_FILE / 1024,
+               " KB VT load, ", RESPONSE_BUDGET * 100, "% response budget) ===");
+
+    Run fifo = run(FSSchedulePolicy::Fifo);
+    Run drr = run(FSSchedulePolicy::DeficitRoundRobin);
+    for (auto [name, r] : {std::pair<const char *, const Run &>{"fifo", fifo}, {"drr ", drr}}) {
+        echo::info(name, ": VT config loaded in ", r.vt_load_ms, " ms (request wait mean ", r.vt_mean_wait_ms,
+                   " ms, max ", r.vt_max_wait_ms, " ms); logger ", r.logger_kbs, " KB/s, max wait ",
+                   r.logger_max_wait_ms, " ms", r.ok ? "" : " (FAILED)");
+    }
+    echo::info("VT load ", static_cast<f64>(fifo.vt_load_ms) / std::max<u32>(1, drr.vt_load_ms),
+               "x faster with deficit round-robin");
+
+    return fifo.ok && drr.ok && drr.vt_load_ms < fifo.vt_load_ms ? 0 : 1;
+}
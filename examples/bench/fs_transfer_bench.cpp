@@ -0,0 +1,159 @@
+#include <agrobus.hpp>
+#include <echo/echo.hpp>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/shm/shm_link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+// Downloads and uploads a 512 KB file between a FileClient and a
+// FileServerEnhanced joined by a ShmLink, for several block sizes and request
+// windows. The bus is paced to 250 kbit/s in 1 ms steps, so the figures are
+// simulated bus throughput: with one 255-byte request at a time the bus idles
+// for a full request/RTS/CTS round trip per block (several 10 ms task periods),
+// large blocks and a window of requests in flight keep it busy.
+
+static constexpr usize FILE_SIZE = 512 * 1024;
+static constexpr f64 BITS_PER_FRAME = 130.0; // extended frame, 8 data bytes, average stuffing
+static constexpr f64 FRAMES_PER_MS = 250'000.0 / BITS_PER_FRAME / 1000.0;
+static constexpr u32 TASK_PERIOD_MS = 10;
+
+// Frames leave the shared memory ring only as fast as the bus carries them
+struct Bus {
+    f64 budget = 0;
+    void tick() { budget = std::min(budget + FRAMES_PER_MS, FRAMES_PER_MS * TASK_PERIOD_MS); }
+};
+
+class PacedLink : public wirebit::Link {
+    std::shared_ptr<wirebit::ShmLink> link_;
+    Bus *bus_;
+
+  public:
+    PacedLink(std::shared_ptr<wirebit::ShmLink> link, Bus *bus) : link_(std::move(link)), bus_(bus) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        return link_->send(frame);
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        if (bus_->budget < 1.0)
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("bus busy"));
+        auto frame = link_->recv();
+        if (frame.is_ok())
+            bus_->budget -= 1.0;
+        return frame;
+    }
+    wirebit::String name() const override { return "paced"; }
+};
+
+struct Run {
+    f64 download_kbs = 0;
+    f64 upload_kbs = 0;
+    bool ok = false;
+};
+
+static Run run(u16 block, u8 window, u32 index) {
+    Run out;
+    dp::String name = "fs_transfer_bench_" + dp::to_string(index);
+    auto created = wirebit::ShmLink::create(name, 1 << 20);
+    auto attached = wirebit::ShmLink::attach(name);
+    if (!created.is_ok() || !attached.is_ok()) {
+        echo::error("ShmLink setup failed");
+        return out;
+    }
+
+    Bus bus;
+    auto server_link =
+        std::make_shared<PacedLink>(std::make_shared<wirebit::ShmLink>(std::move(created.value())), &bus);
+    auto client_link =
+        std::make_shared<PacedLink>(std::make_shared<wirebit::ShmLink>(std::move(attached.value())), &bus);
+    wirebit::CanEndpoint server_ep(server_link, wirebit::CanConfig{.bitrate = 250000}, 1);
+    wirebit::CanEndpoint client_ep(client_link, wirebit::CanConfig{.bitrate = 250000}, 2);
+
+    IsoNet server_net, client_net;
+    server_net.set_endpoint(0, &server_ep);
+    client_net.set_endpoint(0, &client_ep);
+    FileServerEnhanced server(server_net, server_net.create_internal(Name{}, 0, 0x20).value());
+    FileClient client(client_net, client_net.create_internal(Name{}, 0, 0x80).value(),
+                      FileClientConfig{}.block_size(block).window(window));
+    server.initialize();
+    client.initialize();
+
+    dp::Vector<u8> content(FILE_SIZE);
+    for (usize i = 0; i < content.size(); ++i)
+        content[i] = static_cast<u8>(i * 131 + (i >> 9));
+    server.add_file("\\TASKDATA.BIN", content);
+
+    // The bus moves frames every millisecond, the nodes run on a 10 ms ECU task
+    u32 now_ms = 0;
+    auto step = [&] {
+        for (u32 i = 0; i < TASK_PERIOD_MS; ++i)
+            bus.tick();
+        server_net.update(TASK_PERIOD_MS);
+        server.update(TASK_PERIOD_MS);
+        client_net.update(TASK_PERIOD_MS);
+        client.update(TASK_PERIOD_MS);
+        now_ms += TASK_PERIOD_MS;
+    };
+
+    client.connect_to_server(0x20);
+    while (!client.is_connected() && now_ms < 1000)
+        step();
+
+    // Download
+    dp::Vector<u8> received;
+    received.reserve(FILE_SIZE);
+    bool finished = false, ok = false;
+    u32 start = now_ms;
+    client.download_file(
+        "\\TASKDATA.BIN", [&](const u8 *data, usize n) { received.insert(received.end(), data, data + n); },
+        [&](Result<u64> r) {
+            finished = true;
+            ok = r.is_ok();
+        });
+    while (!finished && now_ms - start < 600'000)
+        step();
+    out.download_kbs = FILE_SIZE / 1024.0 / ((now_ms - start) / 1000.0);
+    bool download_ok = ok && received == content;
+
+    // Upload
+    finished = ok = false;
+    start = now_ms;
+    client.upload_file("\\COPY.BIN", content, [&](Result<u64> r) {
+        finished = true;
+        ok = r.is_ok();
+    });
+    while (!finished && now_ms - start < 600'000)
+        step();
+    out.upload_kbs = FILE_SIZE / 1024.0 / ((now_ms - start) / 1000.0);
+
+    dp::Vector<u8> stored(FILE_SIZE);
+    auto copy = server.volume().open("\\COPY.BIN", false, false);
+    bool upload_ok = ok && copy.is_ok() && copy.value()->read(0, stored.data(), FILE_SIZE).is_ok() && stored == content;
+
+    out.ok = download_ok && upload_ok;
+    return out;
+}
+
+int main() {
+    echo::info("=== File transfer benchmark (", FILE_SIZE / 1024, " KB, 250 kbit/s bus) ===");
+    echo::info("bus ceiling ~", FRAMES_PER_MS * 7 * 1000 / 1024, " KB/s of TP payload");
+
+    const u16 blocks[] = {255, FS_TP_BLOCK_SIZE};
+    const u8 windows[] = {1, 2, 4, 8};
+    u32 index = 0;
+    bool all_ok = true;
+    f64 baseline = 0, best = 0;
+    for (u16 block : blocks) {
+        for (u8 window : windows) {
+            Run r = run(block, window, index++);
+            all_ok = all_ok && r.ok;
+            if (block == 255 && window == 1)
+                baseline = r.download_kbs;
+            best = std::max(best, r.download_kbs);
+            echo::info("block ", block, " window ", static_cast<u32>(window), ": download ", r.download_kbs,
+                       " KB/s, upload ", r.upload_kbs, " KB/s", r.ok ? "" : " (FAILED)");
+        }
+    }
+    echo::info("best download ", best / baseline, "x one 255-byte request at a time");
+    return all_ok && best > baseline * 1.5 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include <agrobus.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <echo/echo.hpp>
+#include <fstream>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+// A file server on a directory volume streams a 500 MB file to a client over
+// a simulated CAN bus: two IsoNet nodes joined by in-process frame queues,
+// 255-byte ReadFile requests answered over TP. Reports throughput and the
+// server's resident set size, which stays bounded by the mmap resident window
+// instead of growing with the file as it did with the in-memory volume.
+// Usage: fs_volume_bench [size_mb]
+
+static constexpr Address SERVER = 0x20;
+static constexpr Address CLIENT = 0x80;
+static constexpr u8 READ_SIZE = 255;
+
+// One direction of the bus
+class QueueLink : public wirebit::Link {
+    std::deque<wirebit::Frame> *tx_;
+    std::deque<wirebit::Frame> *rx_;
+
+  public:
+    QueueLink(std::deque<wirebit::Frame> *tx, std::deque<wirebit::Frame> *rx) : tx_(tx), rx_(rx) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        tx_->push_back(frame);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        if (rx_->empty())
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+        auto frame = std::move(rx_->front());
+        rx_->pop_front();
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::ok(std::move(frame));
+    }
+    wirebit::String name() const override { return "queue"; }
+};
+
+// kB value of a /proc/self/status field
+static usize status_kb(const char *field) {
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    while (std::getline(in, line))
+        if (line.rfind(field, 0) == 0)
+            return std::strtoull(line.c_str() + std::strlen(field) + 1, nullptr, 10);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    usize size_mb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500;
+    usize size = size_mb << 20;
+    echo::info("=== File server volume benchmark (", size_mb, " MB) ===");
+
+    // Volume contents, written without holding the file in memory
+    auto root = std::filesystem::temp_directory_path() / "agrobus_fs_volume_bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    u64 expected = 0;
+    {
+        std::ofstream out(root / "TASKDATA.BIN", std::ios::binary);
+        dp::Vector<u8> block(1 << 20);
+        for (usize off = 0; off < size; off += block.size()) {
+            for (usize i = 0; i < block.size(); ++i) {
+                block[i] = static_cast<u8>((off + i) * 31 + ((off + i) >> 12));
+                expected += block[i];
+            }
+            out.write(reinterpret_cast<const char *>(block.data()), static_cast<std::streamsize>(block.size()));
+        }
+    }
+
+    std::deque<wirebit::Frame> to_client, to_server;
+    wirebit::CanEndpoint server_ep{std::make_shared<QueueLink>(&to_client, &to_server), wirebit::CanConfig{}, 1};
+    wirebit::CanEndpoint client_ep{std::make_shared<QueueLink>(&to_server, &to_client), wirebit::CanConfig{}, 2};
+
+    IsoNet server_net, client_net;
+    server_net.set_endpoint(0, &server_ep);
+    client_net.set_endpoint(0, &client_ep);
+    auto *server_cf = server_net.create_internal(Name{}, 0, SERVER).value();
+    auto *client_cf = client_net.create_internal(Name{}, 0, CLIENT).value();
+
+    // TANs wrap every 256 reads, so cached responses must expire sooner than that
+    FileServerConfig config;
+    config.tan_cache_timeout_ms = 1000;
+    FileServerEnhanced server(server_net, server_cf, config, std::make_unique<DirectoryVolume>(root));
+    server.initialize();
+    usize rss_start = status_kb("VmRSS:");
+
+    // Responses are matched by function and TAN; status broadcasts are ignored
+    dp::Vector<u8> response;
+    bool answered = false;
+    u8 tan = 0;
+    u8 function = 0;
+    client_net.register_pgn_callback(PGN_FILE_SERVER_TO_CLIENT, [&](const Message &msg) {
+        if (msg.data.size() < 3 || msg.data[0] != function || msg.data[1] != tan)
+            return;
+        response = msg.data;
+        answered = true;
+    });
+
+    ControlFunction server_addr;
+    server_addr.address = SERVER;
+    u32 now_ms = 0, last_ccm_ms = 0;
+    // Sends a request and runs both nodes in 1 ms steps until the response arrives
+    auto call = [&](dp::Vector<u8> req) -> bool {
+        if (now_ms - last_ccm_ms >= 2000 || now_ms == 0) {
+            client_net.send(PGN_FILE_CLIENT_TO_SERVER, {0xFF, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, client_cf,
+                            &server_addr);
+            last_ccm_ms = now_ms;
+        }
+        function = req[0];
+        req[1] = ++tan;
+        req.resize(std::max<usize>(req.size(), 8), 0xFF);
+        answered = false;
+        if (!client_net.send(PGN_FILE_CLIENT_TO_SERVER, req, client_cf, &server_addr).is_ok())
+            return false;
+        for (u32 steps = 0; !answered && steps < 10'000; ++steps, ++now_ms) {
+            server_net.update(1);
+            server.update(1);
+            client_net.update(1);
+        }
+        return answered;
+    };
+
+    const dp::String path = "\\TASKDATA.BIN";
+    dp::Vector<u8> open = {static_cast<u8>(FSFunction::OpenFile), 0, static_cast<u8>(path.size()),
+                           static_cast<u8>(OpenFlags::Read)};
+    open.insert(open.end(), path.begin(), path.end());
+    if (!call(open) || response[2] != static_cast<u8>(FSError::Success)) {
+        echo::error("open failed");
+        return 1;
+    }
+    u8 handle = response[3];
+
+    usize received = 0, reads = 0, peak_rss = rss_start;
+    u64 sum = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    while (call({static_cast<u8>(FSFunction::ReadFile), 0, handle, READ_SIZE, 0})) {
+        if (response[2] != static_cast<u8>(FSError::Success))
+            break;
+        usize count = static_cast<usize>(response[3]) | (static_cast<usize>(response[4]) << 8);
+        if (count == 0)
+            break;
+        for (usize i = 0; i < count; ++i)
+            sum += response[FS_BLOCK_HEADER_SIZE + i];
+        received += count;
+        if (++reads % 65536 == 0)
+            peak_rss = std::max(peak_rss, status_kb("VmRSS:"));
+    }
+    f64 secs = std::chrono::duration<f64>(std::chrono::steady_clock::now() - t0).count();
+    peak_rss = std::max(peak_rss, status_kb("VmRSS:"));
+    call({static_cast<u8>(FSFunction::CloseFile), 0, handle});
+
+    echo::info("streamed ", received >> 20, " MB in ", reads, " reads, ", secs, " s (", received / secs / (1 << 20),
+               " MB/s through both stacks, ", secs * 1e6 / std::max<usize>(reads, 1), " us/read)");
+    echo::info("server RSS: ", rss_start / 1024, " MB at start, peak ", peak_rss / 1024, " MB, VmHWM ",
+               status_kb("VmHWM:") / 1024, " MB; an in-memory volume holds ", size_mb, " MB");
+
+    std::filesystem::remove_all(root);
+    bool complete = received == size && sum == expected;
+    bool bounded = peak_rss - rss_start < 64 * 1024; // resident window plus bookkeeping, not the file
+    return complete && bounded ? 0 : 1;
+}
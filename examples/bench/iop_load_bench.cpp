@@ -0,0 +1,126 @@
+#include <agrobus/net/iop_parser.hpp>
+#include <chrono>
+#include <cstdio>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::vt;
+
+// Startup cost of a large object pool: legacy fread + per-byte copy + checked
+// add, the bulk-copy parse, the zero-copy mmap index (optionally materialized),
+// and serial vs. parallel structural validation.
+
+static constexpr u16 OBJECTS = 60000;
+static constexpr u32 RUNS = 5;
+
+static void put_header(dp::Vector<u8> &out, ObjectID id, ObjectType type, u16 w, u16 h) {
+    out.insert(out.end(), {static_cast<u8>(id & 0xFF), static_cast<u8>(id >> 8), static_cast<u8>(type),
+                           static_cast<u8>(w & 0xFF), static_cast<u8>(w >> 8), static_cast<u8>(h & 0xFF),
+                           static_cast<u8>(h >> 8)});
+}
+
+// WS + DataMask + SoftKeyMask, then OutputStrings (with 120 byte text) and NumberVariables
+static dp::Vector<u8> make_iop() {
+    dp::Vector<u8> out;
+    put_header(out, 0, ObjectType::WorkingSet, 200, 200);
+    out.insert(out.end(), {0, 1, 1, 0});
+    put_header(out, 1, ObjectType::DataMask, 480, 480);
+    out.insert(out.end(), {0, 2, 0});
+    put_header(out, 2, ObjectType::SoftKeyMask, 80, 480);
+    for (u16 id = 10; id < OBJECTS; ++id) {
+        if (id % 2) {
+            put_header(out, id, ObjectType::OutputString, 120, 16);
+            out.insert(out.end(), {120, 0});
+            for (u8 c = 0; c < 120; ++c)
+                out.push_back(static_cast<u8>('A' + c % 26));
+            out.insert(out.end(), {0, 0, 0, 0});
+        } else {
+            put_header(out, id, ObjectType::NumberVariable, 0, 0);
+            out.insert(out.end(), {0, 0, 0, 0});
+        }
+    }
+    return out;
+}
+
+// Replica of the previous parse_iop_data: one push_back per byte, add() scans for duplicates
+static usize legacy_parse(const dp::Vector<u8> &data) {
+    ObjectPool pool;
+    usize offset = 0;
+    while (offset + 7 <= data.size()) {
+        VTObject obj;
+        obj.id = static_cast<u16>(data[offset]) | (static_cast<u16>(data[offset + 1]) << 8);
+        obj.type = static_cast<ObjectType>(data[offset + 2]);
+        usize start = offset + 3;
+        offset += 7;
+        usize len = 0;
+        if (obj.type == ObjectType::WorkingSet || obj.type == ObjectType::NumberVariable)
+            len = 4;
+        else if (obj.type == ObjectType::DataMask)
+            len = 3;
+        else if (obj.type == ObjectType::OutputString)
+            len = 2 + (static_cast<u16>(data[offset]) | (static_cast<u16>(data[offset + 1]) << 8)) + 4;
+        offset += len;
+        for (usize i = start; i < offset; ++i)
+            obj.body.push_back(data[i]);
+        pool.add(std::move(obj));
+    }
+    return pool.size();
+}
+
+template <typename F> static f64 time_ms(F &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (u32 r = 0; r < RUNS; ++r)
+        fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::milli>(end - start).count() / RUNS;
+}
+
+int main() {
+    echo::info("=== IOP load benchmark ===");
+
+    auto data = make_iop();
+    auto path = std::filesystem::temp_directory_path() / "agrobus_iop_bench.iop";
+    std::FILE *f = std::fopen(path.string().c_str(), "wb");
+    if (!f)
+        return 1;
+    std::fwrite(data.data(), 1, data.size(), f);
+    std::fclose(f);
+    dp::String file(path.string().c_str());
+    echo::info(OBJECTS, " objects, ", data.size() / 1024, " KiB");
+
+    usize legacy_objects = 0;
+    f64 legacy_ms = time_ms([&] {
+        auto bytes = IOPParser::read_iop_file(file);
+        legacy_objects = legacy_parse(bytes.value());
+    });
+
+    usize parsed_objects = 0;
+    f64 parse_ms = time_ms([&] {
+        auto bytes = IOPParser::read_iop_file(file);
+        parsed_objects = IOPParser::parse_iop_data(bytes.value()).value().size();
+    });
+
+    usize mapped_objects = 0;
+    f64 map_ms = time_ms([&] { mapped_objects = IOPParser::load_iop_file(file).value().object_count(); });
+
+    usize pool_objects = 0;
+    f64 map_pool_ms = time_ms([&] { pool_objects = IOPParser::load_iop_file(file).value().to_pool().size(); });
+
+    auto image = IOPParser::load_iop_file(file).value();
+    bool serial_ok = true;
+    bool parallel_ok = true;
+    f64 serial_ms = time_ms(
+        [&] { serial_ok = IOPParser::validate_structure(image, IOPValidateOptions{}.with_threads(1)).is_ok(); });
+    f64 parallel_ms = time_ms([&] { parallel_ok = IOPParser::validate_structure(image).is_ok(); });
+
+    echo::info("legacy read + parse : ", legacy_ms, " ms");
+    echo::info("read + bulk parse   : ", parse_ms, " ms");
+    echo::info("mmap + index        : ", map_ms, " ms");
+    echo::info("mmap + to_pool      : ", map_pool_ms, " ms");
+    echo::info("validate serial     : ", serial_ms, " ms");
+    echo::info("validate parallel   : ", parallel_ms, " ms (", std::thread::hardware_concurrency(), " threads)");
+
+    std::filesystem::remove(path);
+    bool same = legacy_objects == parsed_objects && parsed_objects == mapped_objects && mapped_objects == pool_objects;
+    return same && serial_ok && parallel_ok ? 0 : 1;
+}
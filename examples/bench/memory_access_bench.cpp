@@ -0,0 +1,158 @@
+#include <agrobus.hpp>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <echo/echo.hpp>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::j1939;
+
+// A service tool writes a 4 MB ECU image over DM14/DM15/DM16 on a simulated
+// 250 kbit/s bus and reads it back, with DM16 blocks small enough for TP and
+// large enough for ETP. Each block costs a DM14/DM15 round trip and, over
+// TP/ETP, an RTS/CTS/EOMA exchange; the larger the block, the less of the
+// bus those take. Times are simulated bus time.
+
+static constexpr u32 IMAGE_SIZE = 4 * 1024 * 1024;
+static constexpr f64 BITS_PER_FRAME = 130.0; // extended frame, 8 data bytes, average stuffing
+static constexpr f64 FRAMES_PER_MS = 250'000.0 / BITS_PER_FRAME / 1000.0;
+static constexpr f64 PAYLOAD_KBS = FRAMES_PER_MS * 7.0; // TP data bytes per ms, the ceiling
+static constexpr u32 TASK_PERIOD_MS = 2;
+static constexpr Address ECU = 0x00;
+static constexpr Address TOOL = 0xF9;
+
+// Frames wait on the wire and reach the other node as fast as the bitrate allows
+struct Bus {
+    std::deque<std::pair<usize, wirebit::Frame>> wire;
+    std::deque<wirebit::Frame> rx[2];
+    f64 budget = 0;
+    u64 frames = 0;
+
+    void tick() {
+        budget = std::min(budget + FRAMES_PER_MS, FRAMES_PER_MS * TASK_PERIOD_MS);
+        while (budget >= 1.0 && !wire.empty()) {
+            auto &[from, frame] = wire.front();
+            rx[1 - from].push_back(frame);
+            wire.pop_front();
+            budget -= 1.0;
+            ++frames;
+        }
+    }
+};
+
+class BusLink : public wirebit::Link {
+    Bus *bus_;
+    usize node_;
+
+  public:
+    BusLink(Bus *bus, usize node) : bus_(bus), node_(node) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        bus_->wire.emplace_back(node_, frame);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        auto &rx = bus_->rx[node_];
+        if (rx.empty())
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+        auto frame = std::move(rx.front());
+        rx.pop_front();
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::ok(std::move(frame));
+    }
+    wirebit::String name() const override { return "bus"; }
+};
+
+struct Run {
+    f64 write_s = 0;
+    f64 read_s = 0;
+    u64 frames = 0;
+    u64 blocks = 0;
+    f64 wall_ms = 0;
+    bool ok = false;
+};
+
+static Run run(u16 block, const dp::Vector<u8> &image) {
+    Run out;
+    Bus bus;
+    wirebit::CanEndpoint ecu_ep{std::make_shared<BusLink>(&bus, 0), wirebit::CanConfig{}, 1};
+    wirebit::CanEndpoint tool_ep{std::make_shared<BusLink>(&bus, 1), wirebit::CanConfig{}, 2};
+    IsoNet ecu_net, tool_net;
+    ecu_net.set_endpoint(0, &ecu_ep);
+    tool_net.set_endpoint(0, &tool_ep);
+
+    RamMemory memory(IMAGE_SIZE);
+    MemoryAccessServer server(ecu_net, ecu_net.create_internal(Name{}, 0, ECU).value(), memory);
+    MemoryAccessClient tool(tool_net, tool_net.create_internal(Name{}, 0, TOOL).value(),
+                            MemoryClientConfig{}.block_size(block));
+    server.initialize();
+    tool.initialize();
+
+    u64 now_ms = 0;
+    auto step = [&] {
+        for (u32 i = 0; i < TASK_PERIOD_MS; ++i)
+            bus.tick();
+        ecu_net.update(TASK_PERIOD_MS);
+        server.update(TASK_PERIOD_MS);
+        tool_net.update(TASK_PERIOD_MS);
+        tool.update(TASK_PERIOD_MS);
+        now_ms += TASK_PERIOD_MS;
+    };
+    auto wall = std::chrono::steady_clock::now();
+
+    bool wrote = false, write_ok = false;
+    tool.write(ECU, 0, image, [&](Result<void> r) {
+        wrote = true;
+        write_ok = r.is_ok();
+    });
+    while (!wrote)
+        step();
+    out.write_s = now_ms / 1000.0;
+
+    bool read = false;
+    dp::Vector<u8> back;
+    u64 read_start = now_ms;
+    tool.read(ECU, 0, IMAGE_SIZE, [&](Result<dp::Vector<u8>> r) {
+        read = true;
+        if (r.is_ok())
+            back = std::move(r.value());
+    });
+    while (!read)
+        step();
+    out.read_s = (now_ms - read_start) / 1000.0;
+
+    out.wall_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - wall).count();
+    out.frames = bus.frames;
+    out.blocks = tool.stats().blocks;
+    out.ok = write_ok && memory.image() == image && back == image && tool.stats().retries == 0;
+    return out;
+}
+
+int main() {
+    echo::info("=== DM14/DM16 memory access benchmark (", IMAGE_SIZE / (1024 * 1024), " MB image, 250 kbit/s, ",
+               TASK_PERIOD_MS, " ms task period) ===");
+    echo::info("TP payload ceiling: ", PAYLOAD_KBS, " KB/s");
+
+    dp::Vector<u8> image(IMAGE_SIZE);
+    for (u32 i = 0; i < IMAGE_SIZE; ++i)
+        image[i] = static_cast<u8>(i * 131 + (i >> 11));
+
+    bool ok = true;
+    f64 slowest = 0, fastest = 0;
+    for (u16 block : {u16{255}, DM16_TP_BLOCK, u16{16 * 1024}, DM16_ETP_BLOCK}) {
+        Run r = run(block, image);
+        f64 write_kbs = IMAGE_SIZE / 1000.0 / r.write_s;
+        f64 read_kbs = IMAGE_SIZE / 1000.0 / r.read_s;
+        echo::info(block, "-byte blocks", block > DM16_TP_BLOCK ? " (ETP)" : " (TP)", ": write ", r.write_s,
+                   " s (", write_kbs, " KB/s), read ", r.read_s, " s (", read_kbs, " KB/s), ",
+                   100.0 * write_kbs / PAYLOAD_KBS, "% of ceiling; ", r.blocks, " blocks, ", r.frames,
+                   " frames; ", r.wall_ms, " ms wall", r.ok ? "" : "  IMAGE MISMATCH");
+        ok = ok && r.ok;
+        if (block == 255)
+            slowest = write_kbs;
+        fastest = write_kbs;
+    }
+    echo::info("largest blocks write ", fastest / slowest, "x faster than 255-byte blocks");
+    return ok && fastest > slowest ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <agrobus/isobus/tc/peer_control.hpp>
+#include <chrono>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// A soil sensor implement drives the row-unit downforce of a 64-row seeder
+// through peer control. Every row has its own assignment; the sensor reports
+// all rows at 50 Hz. Measures the router's per-value cost against scanning the
+// assignment list, the wall-clock latency from source message to setpoint
+// frame, and checks that a 50 Hz fixed-rate route holds its rate.
+
+static constexpr Address SENSOR = 0x90;
+static constexpr Address SEEDER = 0x80;
+static constexpr u32 ROWS = 64;
+static constexpr DDI DOWNFORCE = 0x01F5;
+static constexpr u32 VALUES = 1'000'000;
+
+class NullLink : public wirebit::Link {
+  public:
+    u64 frames = 0;
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &) override {
+        ++frames;
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "null"; }
+};
+
+static Message sensor_value(ElementNumber element, i32 value) {
+    dp::Vector<u8> data(8);
+    data[0] = static_cast<u8>(ProcessDataCommands::Value) | static_cast<u8>((element & 0x0F) << 4);
+    data[1] = static_cast<u8>(element >> 4);
+    data[2] = static_cast<u8>(DOWNFORCE & 0xFF);
+    data[3] = static_cast<u8>(DOWNFORCE >> 8);
+    std::memcpy(&data[4], &value, 4);
+    return Message(PGN_ECU_TO_TC, data, SENSOR, 0xF7);
+}
+
+// Without a routing table: scan the assignments for every value
+static const PeerControlAssignment *linear_find(const PeerControlInterface &pc, Address src, ElementNumber element,
+                                                DDI ddi) {
+    for (const auto &a : pc.assignments())
+        if (a.active && a.source_address == src && a.source_element == element && a.source_ddi == ddi)
+            return &a;
+    return nullptr;
+}
+
+static u64 now_us() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+}
+
+int main() {
+    echo::info("=== Peer control router benchmark ===");
+
+    auto link = std::make_shared<NullLink>();
+    wirebit::CanEndpoint ep{link, wirebit::CanConfig{}, 1};
+    IsoNet net;
+    net.set_endpoint(0, &ep);
+    auto *cf = net.create_internal(Name{}, 0, 0x10).value();
+
+    PeerControlInterface pc(net, cf);
+    PeerControlRouter router(net, cf, pc);
+    router.initialize();
+    router.set_clock(now_us);
+    for (u32 row = 0; row < ROWS; ++row) {
+        PeerControlAssignment a;
+        a.source(SENSOR).from(static_cast<ElementNumber>(row + 1), DOWNFORCE);
+        a.destination(SEEDER).to(static_cast<ElementNumber>(row + 1), DOWNFORCE);
+        a.active = true;
+        pc.add_assignment(a);
+    }
+
+    dp::Vector<Message> traffic;
+    for (u32 i = 0; i < ROWS * 16; ++i)
+        traffic.push_back(sensor_value(static_cast<ElementNumber>(i % ROWS + 1), static_cast<i32>(i)));
+
+    usize found = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < VALUES; ++i) {
+        const auto &m = traffic[i % traffic.size()];
+        found += linear_find(pc, m.source, static_cast<ElementNumber>((m.data[0] >> 4) | (m.data[1] << 4)),
+                             DOWNFORCE) != nullptr;
+    }
+    f64 linear_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / VALUES;
+
+    t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < VALUES; ++i) {
+        const auto &m = traffic[i % traffic.size()];
+        found += router.find(m.source, static_cast<ElementNumber>((m.data[0] >> 4) | (m.data[1] << 4)), DOWNFORCE) !=
+                 nullptr;
+    }
+    f64 table_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / VALUES;
+
+    // On-change path end to end: dispatch, parse, route, encode, send
+    t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < VALUES; ++i)
+        net.inject_message(traffic[i % traffic.size()]);
+    f64 routed_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / VALUES;
+    const auto &on_change = router.stats();
+    u64 forwarded = on_change.forwarded;
+    f64 avg_latency = on_change.avg_latency_us();
+    u64 max_latency = on_change.latency_max_us;
+
+    echo::info(ROWS, " routes, ", VALUES, " sensor values");
+    echo::info("lookup: assignment scan ", linear_ns, " ns, routing table ", table_ns, " ns");
+    echo::info("on-change path: ", routed_ns, " ns/value incl. dispatch and send, ", forwarded, " forwarded");
+    echo::info("latency source -> setpoint: avg ", avg_latency, " us, max ", max_latency, " us");
+
+    // 50 Hz fixed-rate over one simulated minute at 1 ms ticks
+    pc.clear_assignments();
+    PeerControlAssignment fixed;
+    fixed.source(SENSOR).from(1, DOWNFORCE).destination(SEEDER).to(1, DOWNFORCE).every(20);
+    fixed.active = true;
+    pc.add_assignment(fixed);
+    u64 sim_us = 0;
+    router.set_clock([&] { return sim_us; });
+    u64 frames_before = link->frames;
+    for (u32 ms = 0; ms < 60'000; ++ms) {
+        sim_us += 1000;
+        if (ms % 7 == 0) // sensor reports at ~143 Hz
+            net.inject_message(sensor_value(1, static_cast<i32>(ms)));
+        router.update(1);
+    }
+    u64 fixed_frames = link->frames - frames_before;
+    const auto &fixed_route = router.routes().front();
+    echo::info("fixed-rate 50 Hz: ", fixed_frames / 60.0, " setpoints/s, hold latency avg ",
+               fixed_route.stats.avg_latency_us(), " us, max ", fixed_route.stats.latency_max_us, " us");
+
+    echo::info("(checksum ", found, ")");
+    bool rate_ok = fixed_frames >= 2995 && fixed_frames <= 3005;
+    return table_ns < linear_ns && rate_ok ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <agrobus/isobus/tc/section_control.hpp>
+#include <algorithm>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// Automatic section control for a 36 m sprayer boom with 48 sections (0.75 m)
+// at 2 cm coverage resolution and 20 Hz position updates. The machine sprays
+// 300 m north/south passes across a 400 x 300 m field at 4 m/s, 35 m apart so
+// neighbouring passes overlap by 1 m, with the field boundary active.
+
+static constexpr u32 SECTIONS = 48;
+static constexpr i32 SECTION_MM = 750;
+static constexpr f64 SPEED = 4.0;
+static constexpr f64 HZ = 20.0;
+static constexpr f64 FIELD_W = 400.0;
+static constexpr f64 FIELD_H = 300.0;
+static constexpr f64 PASS_SPACING = 35.0;
+
+int main() {
+    echo::info("=== Section control benchmark ===");
+
+    ImplementGeometry geo;
+    for (u32 i = 0; i < SECTIONS; ++i) {
+        SectionInfo s;
+        s.number = static_cast<ElementNumber>(i + 1);
+        s.offset_x_mm = -3000;
+        s.offset_y_mm = static_cast<i32>((SECTIONS - 1) * SECTION_MM / 2 - i * SECTION_MM);
+        s.width_mm = SECTION_MM;
+        geo.sections.push_back(s);
+    }
+
+    SectionControl sc(geo, SectionControlConfig{}.resolution(0.02).look_ahead(0.5));
+    LocalFrame frame(52.0, 5.0);
+    sc.set_origin(frame.to_wgs(0, 0));
+    sc.set_boundary(
+        {frame.to_wgs(0, 0), frame.to_wgs(FIELD_W, 0), frame.to_wgs(FIELD_W, FIELD_H), frame.to_wgs(0, FIELD_H)});
+
+    const f64 step = SPEED / HZ;
+    dp::Vector<f64> tick_us;
+    f64 heading = 0.0;
+    u32 pass = 0;
+    for (f64 x = 17.0; x < FIELD_W; x += PASS_SPACING, ++pass) {
+        bool north = pass % 2 == 0;
+        heading = north ? 0.0 : 3.14159265358979;
+        sc.set_master(true);
+        for (f64 d = 0.0; d <= FIELD_H; d += step) {
+            f64 y = north ? d : FIELD_H - d;
+            auto t0 = std::chrono::steady_clock::now();
+            sc.update_local(LocalPoint{x, y}, heading, SPEED);
+            tick_us.push_back(std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        }
+        sc.set_master(false); // headland turn
+        sc.update_local(LocalPoint{x, north ? FIELD_H : 0.0}, heading, SPEED);
+    }
+
+    std::sort(tick_us.begin(), tick_us.end());
+    f64 sum = 0.0;
+    for (f64 t : tick_us)
+        sum += t;
+    f64 avg = sum / tick_us.size();
+    f64 p99 = tick_us[tick_us.size() * 99 / 100];
+    f64 worst = tick_us.back();
+    f64 budget = 1e6 / HZ;
+
+    const auto &cov = sc.coverage();
+    echo::info(SECTIONS, " sections x ", SECTION_MM, " mm, ", cov.resolution() * 100, " cm cells, ", pass,
+               " passes, ", tick_us.size(), " updates @ ", HZ, " Hz");
+    echo::info("update: avg ", avg, " us, p99 ", p99, " us, worst ", worst, " us (budget ", budget, " us)");
+    echo::info("covered ", cov.covered_area_m2() / 10000.0, " ha of ", FIELD_W * FIELD_H / 10000.0, " ha, ",
+               sc.stats().switches, " section switches");
+    echo::info("coverage grid: ", cov.tile_count(), " tiles, ", cov.memory_bytes() / (1024.0 * 1024.0),
+               " MiB (byte-per-cell would be ", FIELD_W * FIELD_H / 0.0004 / (1024.0 * 1024.0), " MiB)");
+
+    return worst < budget && sc.stats().switches > 0 ? 0 : 1;
+}
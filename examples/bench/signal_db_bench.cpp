@@ -0,0 +1,201 @@
+#include <agrobus.hpp>
+#include <chrono>
+#include <cmath>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::j1939;
+
+// Decodes a log of 1M frames spread over seven engine PGNs (29 SPNs) four
+// ways: the hand-written per-message decode() structs, the constexpr
+// extractors, the run-time SignalDB frame by frame, and BatchDecoder's
+// columns over 16K-frame chunks. Then compares decoding everything (what
+// EngineInterface did for every PGN) with a SignalDecoder subscribed to two
+// SPNs. Frame by frame, the PGN dispatch costs about as much as decoding the
+// few fields of a message, so only the batch decode is expected to win.
+
+static constexpr u32 FRAMES = 1'000'000;
+static constexpr u32 POOL = 4096;
+static constexpr u32 CHUNK = 16 * 1024; // frames per batch, as a log reader would hand them over
+static constexpr PGN PGNS[] = {PGN_EEC1, PGN_EEC2,         PGN_ET1,         PGN_EFLP,
+                               PGN_ENGINE_HOURS, PGN_FUEL_ECONOMY, PGN_AMBIENT_CONDITIONS};
+
+template <typename F> static f64 time_ns(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / FRAMES;
+}
+
+// Every SPN the database knows, from the hand-written structs
+static f64 hand_written(PGN pgn, const dp::Vector<u8> &data) {
+    switch (pgn) {
+    case PGN_EEC1: {
+        auto m = EEC1::decode(data);
+        return m.engine_torque_percent + m.driver_demand_percent + m.actual_engine_percent + m.engine_speed_rpm +
+               m.starter_mode;
+    }
+    case PGN_EEC2: {
+        auto m = EEC2::decode(data);
+        return m.accel_pedal_low_idle + m.accel_pedal_kickdown + m.accel_pedal_position * 0.4 + m.engine_load_percent;
+    }
+    case PGN_ET1: {
+        auto m = EngineTemp1::decode(data);
+        return m.coolant_temp_c + m.fuel_temp_c + m.oil_temp_c + m.turbo_oil_temp_c + m.intercooler_temp_c;
+    }
+    case PGN_EFLP: {
+        auto m = EngineFluidLP::decode(data);
+        return m.fuel_delivery_pressure_kpa + m.oil_pressure_kpa + m.coolant_pressure_kpa +
+               m.oil_level_percent * 0.4 + m.coolant_level_percent * 0.4 + m.crankcase_pressure_kpa;
+    }
+    case PGN_ENGINE_HOURS: {
+        auto m = EngineHours::decode(data);
+        return m.total_hours + m.total_revolutions;
+    }
+    case PGN_FUEL_ECONOMY: {
+        auto m = FuelEconomy::decode(data);
+        return m.fuel_rate_lph + m.instantaneous_lph + m.throttle_position;
+    }
+    case PGN_AMBIENT_CONDITIONS: {
+        auto m = AmbientConditions::decode(data);
+        return m.barometric_pressure_kpa + m.ambient_air_temp_c + m.intake_air_temp_c + m.road_surface_temp_c;
+    }
+    default:
+        return 0.0;
+    }
+}
+
+template <const SignalDef &...S> static f64 sum_of(const u8 *data, usize size) {
+    return (decode<S>(data, size).value_or(0.0) + ...);
+}
+
+static f64 constexpr_extractors(PGN pgn, const u8 *d, usize n) {
+    using namespace spns;
+    switch (pgn) {
+    case PGN_EEC1:
+        return sum_of<ActualEngineTorque, DriverDemandTorque, FrictionTorque, EngineSpeed, StarterMode>(d, n);
+    case PGN_EEC2:
+        return sum_of<AccelPedalLowIdle, AccelPedalKickdown, AccelPedalPosition, EngineLoad>(d, n);
+    case PGN_ET1:
+        return sum_of<CoolantTemp, FuelTemp, OilTemp, TurboOilTemp, IntercoolerTemp>(d, n);
+    case PGN_EFLP:
+        return sum_of<FuelDeliveryPressure, OilPressure, CoolantPressure, OilLevel, CoolantLevel,
+                      CrankcasePressure>(d, n);
+    case PGN_ENGINE_HOURS:
+        return sum_of<spns::EngineHours, EngineRevolutions>(d, n);
+    case PGN_FUEL_ECONOMY:
+        return sum_of<FuelRate, InstantFuelEconomy, ThrottlePosition>(d, n);
+    case PGN_AMBIENT_CONDITIONS:
+        return sum_of<BarometricPressure, AmbientAirTemp, IntakeAirTemp, RoadSurfaceTemp>(d, n);
+    default:
+        return 0.0;
+    }
+}
+
+static bool close(f64 a, f64 b) { return std::fabs(a - b) <= 1e-9 * std::fabs(a); }
+
+int main() {
+    echo::info("=== Signal DB benchmark (", FRAMES / 1000, "K frames, ", std::size(PGNS), " PGNs, ",
+               std::size(spns::ENGINE), " SPNs) ===");
+
+    // Valid values only, so every decoder sums the same numbers. Messages come
+    // from a pool small enough to stay in cache, as a just-received one is;
+    // the log of frames is streamed.
+    dp::Vector<dp::Vector<u8>> payloads; // what a Message would carry
+    dp::Vector<Frame> pool;
+    u32 rng = 2463534242u;
+    auto next = [&] {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    };
+    for (u32 i = 0; i < POOL; ++i) {
+        PGN pgn = PGNS[next() % std::size(PGNS)];
+        dp::Vector<u8> data(8);
+        for (auto &b : data)
+            b = static_cast<u8>(next() % 0xFB);
+        if (pgn == PGN_EEC1)
+            data[6] = static_cast<u8>(next() % 15); // starter mode, 4 bits
+        if (pgn == PGN_EEC2)
+            data[0] = static_cast<u8>(next() % 3 | (next() % 3) << 2);
+        pool.push_back(Frame::from_message(Priority::Default, pgn, 0x00, BROADCAST_ADDRESS, data.data()));
+        payloads.push_back(std::move(data));
+    }
+    dp::Vector<Frame> log(FRAMES);
+    dp::Vector<u32> message(FRAMES); // log[i] carries payloads[message[i]]
+    for (u32 i = 0; i < FRAMES; ++i) {
+        message[i] = next() % POOL;
+        log[i] = pool[message[i]];
+    }
+
+    f64 hand_sum = 0, cx_sum = 0, db_sum = 0, batch_sum = 0;
+    f64 hand_ns = time_ns([&] {
+        for (u32 i = 0; i < FRAMES; ++i)
+            hand_sum += hand_written(log[i].pgn(), payloads[message[i]]);
+    });
+    f64 cx_ns = time_ns([&] {
+        for (const auto &f : log)
+            cx_sum += constexpr_extractors(f.pgn(), f.data.data(), f.length);
+    });
+
+    auto db = SignalDB::engine();
+    f64 db_ns = time_ns([&] {
+        for (const auto &f : log) {
+            const auto *defs = db.of(f.pgn());
+            if (!defs)
+                continue;
+            for (const auto *def : *defs) {
+                u64 raw = extract_bits(f.data.data(), def->start_bit, def->length);
+                if (signal_valid(raw, def->length))
+                    db_sum += def->physical(raw);
+            }
+        }
+    });
+
+    dp::Vector<const SignalDef *> all;
+    for (const auto &def : db)
+        all.push_back(&def);
+    BatchDecoder batch(all);
+    usize values = 0;
+    f64 batch_ns = 0;
+    for (u32 at = 0; at < FRAMES; at += CHUNK) {
+        batch_ns += time_ns([&] { batch.decode(log.data() + at, std::min(CHUNK, FRAMES - at)); });
+        for (const auto &col : batch.columns()) { // summed off the clock, like the others' callers would
+            values += col.value.size();
+            for (f64 v : col.value)
+                batch_sum += std::isnan(v) ? 0.0 : v;
+        }
+    }
+
+    echo::info("hand-written decode(): ", hand_ns, " ns/frame");
+    echo::info("constexpr extractors:  ", cx_ns, " ns/frame (", hand_ns / cx_ns, "x)");
+    echo::info("SignalDB per frame:    ", db_ns, " ns/frame (", hand_ns / db_ns, "x)");
+    echo::info("BatchDecoder:          ", batch_ns, " ns/frame (", hand_ns / batch_ns, "x), ", values, " values");
+
+    // Two SPNs of interest: decode everything, or only what is subscribed
+    f64 rpm_sum = 0, lazy_rpm_sum = 0, everything = 0;
+    f64 full_ns = time_ns([&] {
+        for (u32 i = 0; i < FRAMES; ++i) {
+            PGN pgn = log[i].pgn();
+            everything += hand_written(pgn, payloads[message[i]]); // kept so the decode is not optimized away
+            if (pgn == PGN_EEC1)
+                rpm_sum += EEC1::decode(payloads[message[i]]).engine_speed_rpm;
+        }
+    });
+    SignalDecoder decoder(db);
+    decoder.subscribe(spns::EngineSpeed, [&](f64 rpm, Address) { lazy_rpm_sum += rpm; });
+    decoder.subscribe(spns::CoolantTemp, [&](f64, Address) {});
+    f64 lazy_ns = time_ns([&] {
+        for (u32 i = 0; i < FRAMES; ++i)
+            decoder.feed(log[i].pgn(), payloads[message[i]].data(), payloads[message[i]].size(), 0x00);
+    });
+    echo::info("2 subscribed SPNs: decode every PGN ", full_ns, " ns/frame, lazy decoder ", lazy_ns, " ns/frame (",
+               full_ns / lazy_ns, "x), ", decoder.decoded(), " values decoded");
+
+    bool same = close(hand_sum, cx_sum) && close(hand_sum, db_sum) && close(hand_sum, batch_sum) &&
+                close(hand_sum, everything) && close(rpm_sum, lazy_rpm_sum);
+    if (!same)
+        echo::error("mismatch: ", hand_sum, " ", cx_sum, " ", db_sum, " ", batch_sum);
+    bool ok = same && batch_ns < hand_ns;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include <agrobus.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::j1939;
+
+// 100 SPNs spread over 13 proprietary PGNs, each broadcast every 10 ms, feed
+// a signal history. Measures what a received PGN costs and what a freeze
+// frame capture costs when a DTC goes active, with and without pre-trigger
+// frames, against the empty capture DiagnosticProtocol used to store.
+
+static constexpr u32 SPNS = 100;
+static constexpr u32 SPNS_PER_PGN = 8;
+static constexpr u32 PGNS = (SPNS + SPNS_PER_PGN - 1) / SPNS_PER_PGN;
+static constexpr PGN FIRST_PGN = 0xFF20;
+static constexpr u32 PERIOD_MS = 10;
+static constexpr u32 CAPTURES = 20'000;
+
+template <typename F> static f64 time_ns(F &&f, u32 reps) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < reps; ++i)
+        f(i);
+    return std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / reps;
+}
+
+static SignalHistoryConfig hundred_spns() {
+    SignalHistoryConfig config;
+    for (u32 i = 0; i < SPNS; ++i)
+        config.signal(5000 + i, FIRST_PGN + i / SPNS_PER_PGN, static_cast<u16>((i % SPNS_PER_PGN) * 8), 8);
+    return config;
+}
+
+// Ten seconds of bus traffic
+static f64 fill(SignalHistory &history) {
+    u8 data[8];
+    u32 messages = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (u32 tick = 0; tick < 1000; ++tick) {
+        for (u32 p = 0; p < PGNS; ++p) {
+            for (u32 b = 0; b < 8; ++b)
+                data[b] = static_cast<u8>((tick + p * 8 + b) % 200);
+            history.feed(FIRST_PGN + p, data, sizeof(data));
+            ++messages;
+        }
+        history.update(PERIOD_MS);
+    }
+    return std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / messages;
+}
+
+struct Capture {
+    f64 ns = 0;
+    usize frames = 0;
+    usize snapshots = 0; // in the trigger frame
+};
+
+static Capture measure(const SignalHistory *history, u8 depth) {
+    IsoNet nm;
+    DiagnosticProtocol diag(nm, nm.create_internal(Name{}, 0, 0x28).value(),
+                            DiagnosticConfig{}.freeze_frame_depth(depth));
+    if (history)
+        diag.attach_signal_history(*history);
+    Capture out;
+    out.ns = time_ns([&](u32 i) { diag.capture_freeze_frame(DTC{100 + i % 64, FMI::AboveNormal, 1}); }, CAPTURES);
+    const auto &frames = diag.freeze_frames().begin()->second;
+    out.frames = frames.size();
+    out.snapshots = frames.back().snapshots.size();
+    return out;
+}
+
+int main() {
+    echo::info("=== Signal history benchmark (", SPNS, " SPNs in ", PGNS, " PGNs every ", PERIOD_MS, " ms) ===");
+
+    SignalHistory trigger_only(hundred_spns());
+    SignalHistory pre_trigger(hundred_spns().pre_trigger(400, 4));
+    f64 feed_ns = fill(trigger_only);
+    fill(pre_trigger);
+    echo::info("feed: ", feed_ns, " ns per PGN (", feed_ns / SPNS_PER_PGN, " ns per SPN); ring memory ",
+               trigger_only.memory_bytes() / 1024, " KB for ", trigger_only.config().depth, " samples per SPN");
+
+    Capture empty = measure(nullptr, 3);
+    Capture now = measure(&trigger_only, 3);
+    Capture history = measure(&pre_trigger, 5);
+    echo::info("capture without history: ", empty.ns / 1000.0, " us, ", empty.snapshots, " SPNs");
+    echo::info("capture at trigger:      ", now.ns / 1000.0, " us, ", now.snapshots, " SPNs");
+    echo::info("capture with 4 pre-trigger frames over 400 ms: ", history.ns / 1000.0, " us, ", history.frames,
+               " frames of ", history.snapshots, " SPNs");
+
+    bool ok = now.snapshots == SPNS && history.snapshots == SPNS && history.frames == 5 && empty.snapshots == 0;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include <agrobus/isobus/tc/taskdata.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <echo/echo.hpp>
+#include <fstream>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// Imports a synthetic farm-management export: 2,000 partfields with 400-vertex
+// boundaries, one task per partfield with 8 polygon treatment zones, and a
+// 1,000 x 1,000 type-1 grid on every 100th task. Tasks are handed off through
+// the streaming callbacks, so only the object being parsed is held in memory.
+
+static constexpr u32 FIELDS = 2000;
+static constexpr u32 BOUNDARY_POINTS = 400;
+static constexpr u32 ZONES = 8;
+static constexpr u32 ZONE_POINTS = 40;
+static constexpr u32 GRID_EVERY = 100;
+static constexpr u32 GRID_SIZE = 1000;
+
+static void write_ring(std::ofstream &out, u8 type, f64 lat, f64 lon, f64 radius, u32 points) {
+    out << "<LSG A=\"" << int(type) << "\">";
+    for (u32 i = 0; i < points; ++i) {
+        f64 a = 6.283185307 * i / points;
+        out << "<PNT A=\"2\" C=\"" << lat + radius * std::cos(a) << "\" D=\"" << lon + radius * std::sin(a) << "\"/>";
+    }
+    out << "</LSG>";
+}
+
+static std::filesystem::path generate() {
+    auto dir = std::filesystem::temp_directory_path() / "agrobus_taskdata_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream out(dir / "TASKDATA.XML");
+    out.precision(9);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<ISO11783_TaskData VersionMajor=\"4\" VersionMinor=\"3\">\n";
+
+    dp::Vector<u8> codes(static_cast<usize>(GRID_SIZE) * GRID_SIZE);
+    for (usize i = 0; i < codes.size(); ++i)
+        codes[i] = static_cast<u8>(1 + (i / 37) % ZONES);
+
+    for (u32 f = 0; f < FIELDS; ++f) {
+        f64 lat = 52.0 + (f / 50) * 0.02;
+        f64 lon = 5.0 + (f % 50) * 0.02;
+        out << "<PFD A=\"PFD" << f << "\" C=\"Field " << f << "\"><PLN A=\"1\">";
+        write_ring(out, 1, lat, lon, 0.005, BOUNDARY_POINTS);
+        out << "</PLN></PFD>\n<TSK A=\"TSK" << f << "\" B=\"Task " << f << "\" E=\"PFD" << f << "\">";
+        for (u32 z = 0; z < ZONES; ++z) {
+            out << "<TZN A=\"" << z + 1 << "\"><PDV A=\"0001\" B=\"" << (z + 1) * 10000 << "\"/><PLN A=\"2\">";
+            write_ring(out, 1, lat + 0.001 * z, lon, 0.0005, ZONE_POINTS);
+            out << "</PLN></TZN>";
+        }
+        if (f % GRID_EVERY == 0) {
+            char file[16];
+            std::snprintf(file, sizeof(file), "GRD%05u", f / GRID_EVERY);
+            out << "<GRD A=\"" << lat << "\" B=\"" << lon << "\" C=\"0.00001\" D=\"0.00001\" E=\"" << GRID_SIZE
+                << "\" F=\"" << GRID_SIZE << "\" G=\"" << file << "\" I=\"1\"/>";
+            std::ofstream(dir / (std::string(file) + ".bin"), std::ios::binary)
+                .write(reinterpret_cast<const char *>(codes.data()), static_cast<std::streamsize>(codes.size()));
+        }
+        out << "</TSK>\n";
+    }
+    out << "</ISO11783_TaskData>\n";
+    return dir;
+}
+
+int main() {
+    echo::info("=== TASKDATA import benchmark ===");
+    auto dir = generate();
+    f64 xml_mb = std::filesystem::file_size(dir / "TASKDATA.XML") / (1024.0 * 1024.0);
+
+    usize tasks = 0, vertices = 0, peak_task_points = 0;
+    TaskDataHandlers handlers;
+    handlers.on_partfield = [&](TaskDataPartfield &&p) { vertices += p.boundary.size(); };
+    handlers.on_task = [&](TaskDataTask &&t) {
+        ++tasks;
+        usize pts = 0;
+        for (const auto &z : t.zones.zones)
+            pts += z.boundary.size();
+        vertices += pts;
+        peak_task_points = std::max(peak_task_points, pts);
+    };
+
+    TaskDataReader reader(TaskDataConfig{}.rate(0x0001));
+    auto t0 = std::chrono::steady_clock::now();
+    auto stats = reader.read(dir, handlers);
+    f64 secs = std::chrono::duration<f64>(std::chrono::steady_clock::now() - t0).count();
+    if (!stats.is_ok()) {
+        echo::error("import failed: ", stats.error().message);
+        return 1;
+    }
+
+    const auto &s = stats.value();
+    echo::info("TASKDATA.XML ", xml_mb, " MiB, ", s.elements, " elements, ", s.tasks, " tasks, ", s.partfields,
+               " partfields, ", s.zones, " zones, ", s.grid_cells, " grid cells");
+    echo::info("import: ", secs * 1000.0, " ms, ", xml_mb / secs, " MiB/s, ", vertices, " vertices");
+    echo::info("largest task held in memory: ", peak_task_points, " zone vertices");
+
+    std::filesystem::remove_all(dir);
+    return tasks == FIELDS && s.grid_cells == static_cast<u64>(FIELDS / GRID_EVERY) * GRID_SIZE * GRID_SIZE ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include <agrobus/isobus/tc/prescription_index.hpp>
+#include <chrono>
+#include <cmath>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// Rate lookup on a shapefile-sized prescription: 224 x 224 = 50,176 management
+// zones of 64 vertices each (~10 m cells, 2.2 km square field). A tractor
+// drives serpentine passes at 3 m/s with 10 Hz GNSS and 1 s actuator look-ahead.
+// Compares the linear scan over every zone, the grid index and a 2 m raster.
+
+static constexpr u32 GRID = 224;
+static constexpr u32 VERTICES = 64;
+static constexpr f64 CELL_M = 10.0;
+static constexpr u32 FIXES = 36000; // one hour at 10 Hz
+static constexpr u32 LINEAR_FIXES = 100;
+
+static dp::Optional<i32> linear(const PrescriptionMap &map, const concord::earth::WGS &p) {
+    for (const auto &zone : map.zones) {
+        bool inside = false;
+        const auto &v = zone.boundary;
+        for (usize i = 0, j = v.size() - 1; i < v.size(); j = i++)
+            if (((v[i].latitude > p.latitude) != (v[j].latitude > p.latitude)) &&
+                (p.longitude <
+                 (v[j].longitude - v[i].longitude) * (p.latitude - v[i].latitude) / (v[j].latitude - v[i].latitude) +
+                     v[i].longitude))
+                inside = !inside;
+        if (inside)
+            return zone.application_rate;
+    }
+    return dp::nullopt;
+}
+
+int main() {
+    echo::info("=== TC-GEO prescription index benchmark ===");
+
+    LocalFrame frame(52.0, 5.0);
+    dp::Vector<PrescriptionMap> maps(1);
+    maps[0].structure_label = "VRA";
+    maps[0].zones.reserve(GRID * GRID);
+    for (u32 r = 0; r < GRID; ++r)
+        for (u32 c = 0; c < GRID; ++c) {
+            // Wobbly ring filling most of the cell, like a dissolved soil zone
+            PrescriptionZone zone;
+            f64 cx = (c + 0.5) * CELL_M, cy = (r + 0.5) * CELL_M;
+            for (u32 k = 0; k < VERTICES; ++k) {
+                f64 a = 2 * 3.14159265358979 * k / VERTICES;
+                f64 radius = CELL_M * (0.62 + 0.08 * std::sin(5 * a + r + c));
+                zone.boundary.push_back(frame.to_wgs(cx + radius * std::sin(a), cy + radius * std::cos(a)));
+            }
+            zone.application_rate = static_cast<i32>(100 + (r * 7 + c * 13) % 200);
+            maps[0].zones.push_back(std::move(zone));
+        }
+
+    // Serpentine passes 12 m apart, 0.3 m per fix
+    dp::Vector<concord::earth::WGS> fixes;
+    f64 x = 5.0, y = 5.0, dir = 1.0;
+    for (u32 i = 0; i < FIXES; ++i) {
+        fixes.push_back(project_ahead(frame.to_wgs(x, y), dir > 0 ? 0.0 : 3.14159265358979, 3.0, 1.0));
+        y += 0.3 * dir;
+        if (y > GRID * CELL_M - 5 || y < 5) {
+            dir = -dir;
+            x += 12.0;
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    PrescriptionIndex index(maps);
+    auto t1 = std::chrono::steady_clock::now();
+    auto raster = RasterPrescription::from_maps(maps, 2.0);
+    auto t2 = std::chrono::steady_clock::now();
+
+    u64 checksum_index = 0;
+    for (const auto &p : fixes)
+        if (auto rate = index.rate_at(p))
+            checksum_index += static_cast<u64>(*rate);
+    auto t3 = std::chrono::steady_clock::now();
+
+    u64 checksum_raster = 0;
+    for (const auto &p : fixes)
+        if (auto rate = raster.rate_at(p))
+            checksum_raster += static_cast<u64>(*rate);
+    auto t4 = std::chrono::steady_clock::now();
+
+    usize mismatches = 0;
+    for (u32 i = 0; i < LINEAR_FIXES; ++i) {
+        const auto &p = fixes[i * (FIXES / LINEAR_FIXES)];
+        if (linear(maps[0], p) != index.rate_at(p))
+            ++mismatches;
+    }
+    auto t5 = std::chrono::steady_clock::now();
+
+    auto ms = [](auto a, auto b) { return std::chrono::duration<f64, std::milli>(b - a).count(); };
+    f64 linear_us = ms(t4, t5) * 1000.0 / LINEAR_FIXES;
+    f64 index_us = ms(t2, t3) * 1000.0 / FIXES;
+    f64 raster_us = ms(t3, t4) * 1000.0 / FIXES;
+
+    echo::info(maps[0].zones.size(), " zones x ", VERTICES, " vertices, ", FIXES, " fixes (1 h @ 10 Hz)");
+    echo::info("build: index ", ms(t0, t1), " ms (", index.cell_count(), " cells of ", index.cell_size_m(),
+               " m), raster ", ms(t1, t2), " ms (", raster.columns, "x", raster.rows, ")");
+    echo::info("linear scan : ", linear_us, " us/fix (budget at 10 Hz: 100000 us)");
+    echo::info("grid index  : ", index_us, " us/fix, ", linear_us / index_us, "x faster");
+    echo::info("raster      : ", raster_us, " us/fix, ", linear_us / raster_us, "x faster");
+    echo::info("index vs linear mismatches: ", mismatches, "/", LINEAR_FIXES, ", checksums ", checksum_index, " / ",
+               checksum_raster);
+
+    return (mismatches == 0 && index_us < linear_us) ? 0 : 1;
+}
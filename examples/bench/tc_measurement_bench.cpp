@@ -0,0 +1,83 @@
+#include <agrobus/isobus/tc/measurement.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// Bus traffic of a 48-section sprayer reporting to a TC for 10 simulated
+// minutes: server-side polling of every (element, DDI) pair at 200 ms (one
+// Request Value plus one Value frame each) vs. measurement subscriptions:
+//   - per section: actual rate (change threshold 2%), section state (on change),
+//     work state (on change), applied area (distance 1 m)
+//   - boom: total area / volume (time 1 s), tank level (threshold window)
+
+static constexpr u16 SECTIONS = 48;
+static constexpr u32 TICK_MS = 10;
+static constexpr u32 SIM_MS = 10 * 60 * 1000;
+static constexpr u32 POLL_MS = 200;
+
+static constexpr DDI DDI_ACTUAL_RATE = 0x0002;
+static constexpr DDI DDI_SECTION_STATE = 0x00A1;
+static constexpr DDI DDI_WORK_STATE = 0x008D;
+static constexpr DDI DDI_AREA = 0x0074;
+static constexpr DDI DDI_TOTAL_VOLUME = 0x0050;
+static constexpr DDI DDI_TANK_LEVEL = 0x0048;
+
+int main() {
+    echo::info("=== TC measurement trigger benchmark ===");
+
+    MeasurementEngine engine;
+    for (u16 s = 1; s <= SECTIONS; ++s) {
+        engine.configure(ProcessDataCommands::MeasurementChangeThreshold, s, DDI_ACTUAL_RATE, 40);
+        engine.configure(ProcessDataCommands::MeasurementChangeThreshold, s, DDI_SECTION_STATE, 0);
+        engine.configure(ProcessDataCommands::MeasurementChangeThreshold, s, DDI_WORK_STATE, 0);
+        engine.configure(ProcessDataCommands::MeasurementDistanceInterval, s, DDI_AREA, 1000);
+    }
+    engine.configure(ProcessDataCommands::MeasurementTimeInterval, 0, DDI_AREA, 1000);
+    engine.configure(ProcessDataCommands::MeasurementTimeInterval, 0, DDI_TOTAL_VOLUME, 1000);
+    engine.configure(ProcessDataCommands::MeasurementMinimumWithinThreshold, 0, DDI_TANK_LEVEL, 0);
+    engine.configure(ProcessDataCommands::MeasurementMaximumWithinThreshold, 0, DDI_TANK_LEVEL, 200000);
+    usize pairs = engine.size();
+
+    u64 frames = 0;
+    auto emit = [&](ElementNumber, DDI, i32) { ++frames; };
+    auto fetch = [](ElementNumber e, DDI d) -> dp::Optional<i32> { return static_cast<i32>(e * 1000 + d); };
+
+    // 3 m/s ground speed, rate jitter every 100 ms, a section toggles every 5 s
+    u32 lcg = 12345;
+    auto start = std::chrono::steady_clock::now();
+    for (u32 t = 0; t < SIM_MS; t += TICK_MS) {
+        if (t % 100 == 0) {
+            for (u16 s = 1; s <= SECTIONS; ++s) {
+                lcg = lcg * 1664525u + 1013904223u;
+                engine.set_value(s, DDI_ACTUAL_RATE, 2000 + static_cast<i32>((lcg >> 16) % 60), emit);
+            }
+            engine.set_value(0, DDI_TANK_LEVEL, 300000 - static_cast<i32>(t / 4), emit);
+        }
+        if (t % 5000 == 0) {
+            u16 s = static_cast<u16>((t / 5000) % SECTIONS + 1);
+            i32 state = static_cast<i32>((t / 5000 / SECTIONS) % 2);
+            engine.set_value(s, DDI_SECTION_STATE, state, emit);
+            engine.set_value(s, DDI_WORK_STATE, state, emit);
+        }
+        engine.advance(TICK_MS, 30, fetch, emit);
+    }
+    auto end = std::chrono::steady_clock::now();
+    f64 total_us = std::chrono::duration<f64, std::micro>(end - start).count();
+    u32 ticks = SIM_MS / TICK_MS;
+
+    f64 seconds = SIM_MS / 1000.0;
+    f64 poll_fps = 2.0 * pairs * (1000.0 / POLL_MS);
+    f64 trigger_fps = frames / seconds;
+
+    echo::info(SECTIONS, " sections, ", pairs, " process data pairs, ", seconds, " s simulated");
+    echo::info("polling @", POLL_MS, " ms : ", poll_fps, " frames/s");
+    echo::info("measurement triggers : ", trigger_fps, " frames/s");
+    if (trigger_fps > 0.0)
+        echo::info("reduction: ", poll_fps / trigger_fps, "x");
+    echo::info("engine cost: ", total_us / ticks, " us/tick, ", engine.stats().scans, " scans over ", ticks,
+               " ticks");
+
+    return trigger_fps < poll_fps ? 0 : 1;
+}
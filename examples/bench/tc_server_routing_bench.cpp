@@ -0,0 +1,181 @@
+#include <agrobus/isobus/tc/ddi_database.hpp>
+#include <agrobus/isobus/tc/server.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// A task controller serving 8 implements at once, each with 48 sections
+// reporting work state, rate and applied volume. Measures how fast incoming
+// process data is matched to its (client, element, DDI) route compared with
+// scanning the client list and DDOP per message, then runs one simulated
+// minute of scheduled value requests under a 10% bus budget and reports the
+// request rate, lateness and how evenly the budget was shared.
+
+static constexpr Address FIRST_CLIENT = 0x80;
+static constexpr u32 CLIENTS = 8;
+static constexpr u32 SECTIONS = 48;
+static constexpr u32 VALUES = 1'000'000;
+static constexpr u32 POLL_INTERVAL_MS = 1000;
+static constexpr u32 SIM_MS = 60'000;
+
+// Counts value requests per destination, drops everything else
+class CountingLink : public wirebit::Link {
+  public:
+    dp::Array<u64, 256> requests{};
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        if (((cf.can_id >> 16) & 0xFF) == (PGN_TC_TO_ECU >> 8) &&
+            (cf.data[0] & 0x0F) == static_cast<u8>(ProcessDataCommands::RequestValue) && cf.data[3] != 0xFF)
+            ++requests[(cf.can_id >> 8) & 0xFF];
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "counting"; }
+};
+
+static DDOP build_pool(u32 client) {
+    DDOP ddop;
+    ddop.add_device(DeviceObject{}.set_designator("Implement " + dp::to_string(client)));
+    ObjectID root = ddop.add_element(DeviceElement{}.set_type(DeviceElementType::Device)).value();
+    for (u32 s = 0; s < SECTIONS; ++s) {
+        DeviceElement sec;
+        sec.set_type(DeviceElementType::Section).set_number(static_cast<ElementNumber>(s + 1)).set_parent(root);
+        sec.add_child(ddop.add_process_data(DeviceProcessData{}.set_ddi(ddi::ACTUAL_WORK_STATE)).value());
+        sec.add_child(
+            ddop.add_process_data(DeviceProcessData{}.set_ddi(ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE)).value());
+        sec.add_child(ddop.add_process_data(DeviceProcessData{}.set_ddi(ddi::APPLICATION_TOTAL_VOLUME)).value());
+        ddop.add_element(std::move(sec));
+    }
+    return ddop;
+}
+
+static Message value_message(Address from, ElementNumber element, DDI ddi, i32 value) {
+    dp::Vector<u8> data(8);
+    data[0] = static_cast<u8>(ProcessDataCommands::Value) | static_cast<u8>((element & 0x0F) << 4);
+    data[1] = static_cast<u8>(element >> 4);
+    data[2] = static_cast<u8>(ddi & 0xFF);
+    data[3] = static_cast<u8>(ddi >> 8);
+    std::memcpy(&data[4], &value, 4);
+    return Message(PGN_ECU_TO_TC, data, from, 0x10);
+}
+
+// Pre-routing behaviour: find the client, then its element and process data by scanning
+static bool linear_route(const dp::Vector<TCClientInfo> &clients, Address addr, ElementNumber element, DDI ddi) {
+    for (const auto &c : clients) {
+        if (c.address != addr)
+            continue;
+        for (const auto &elem : c.ddop.elements()) {
+            if (elem.number != element)
+                continue;
+            for (auto child : elem.child_objects)
+                for (const auto &pd : c.ddop.process_data())
+                    if (pd.id == child && pd.ddi == ddi)
+                        return true;
+        }
+    }
+    return false;
+}
+
+int main() {
+    echo::info("=== TC server routing benchmark ===");
+
+    auto link = std::make_shared<CountingLink>();
+    wirebit::CanEndpoint ep{link, wirebit::CanConfig{}, 1};
+    IsoNet net;
+    net.set_endpoint(0, &ep);
+    auto *cf = net.create_internal(Name{}, 0, 0x10).value();
+
+    TaskControllerServer server(net, cf, TCServerConfig{}.poll_budget(0.10f));
+    server.start();
+    for (u32 c = 0; c < CLIENTS; ++c) {
+        auto pool = build_pool(c).serialize().value();
+        pool.insert(pool.begin(), tc_cmd::OBJECT_POOL_TRANSFER);
+        Address addr = static_cast<Address>(FIRST_CLIENT + c);
+        net.inject_message(Message(PGN_ECU_TO_TC, pool, addr, 0x10));
+        net.inject_message(
+            Message(PGN_ECU_TO_TC, {tc_cmd::ACTIVATE_POOL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, addr, 0x10));
+    }
+
+    usize routes = 0;
+    for (const auto &c : server.clients())
+        routes += c.routes.size();
+    echo::info(server.clients().size(), " clients, ", routes, " routes");
+
+    // Incoming traffic: a pseudo-random mix over all clients and routes
+    const DDI ddis[] = {ddi::ACTUAL_WORK_STATE, ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE,
+                        ddi::APPLICATION_TOTAL_VOLUME};
+    dp::Vector<Message> traffic;
+    traffic.reserve(4096);
+    u32 rng = 12345;
+    for (u32 i = 0; i < 4096; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        auto addr = static_cast<Address>(FIRST_CLIENT + (rng >> 8) % CLIENTS);
+        auto element = static_cast<ElementNumber>(1 + (rng >> 12) % SECTIONS);
+        traffic.push_back(value_message(addr, element, ddis[(rng >> 20) % 3], static_cast<i32>(i)));
+    }
+
+    auto element_of = [](const Message &m) { return static_cast<ElementNumber>((m.data[0] >> 4) | (m.data[1] << 4)); };
+    auto ddi_of = [](const Message &m) { return static_cast<DDI>(m.data[2] | (m.data[3] << 8)); };
+
+    usize found = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < VALUES / 10; ++i) {
+        const auto &m = traffic[i & 4095];
+        found += linear_route(server.clients(), m.source, element_of(m), ddi_of(m));
+    }
+    f64 linear_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() * 10 / VALUES;
+
+    t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < VALUES; ++i) {
+        const auto &m = traffic[i & 4095];
+        found += server.route(m.source, element_of(m), ddi_of(m)) != nullptr;
+    }
+    f64 indexed_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / VALUES;
+
+    // Full receive path: dispatch, parse, route, per-DDI handler
+    u64 handled = 0;
+    server.on_route_value(ddi::ACTUAL_WORK_STATE, [&](TCClientInfo &, const TCProcessRoute &) { ++handled; });
+    t0 = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < VALUES; ++i)
+        net.inject_message(traffic[i & 4095]);
+    f64 receive_ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - t0).count() / VALUES;
+
+    echo::info("route lookup: linear ", linear_ns, " ns, indexed ", indexed_ns, " ns (", linear_ns / indexed_ns,
+               "x)");
+    echo::info("receive path: ", receive_ns, " ns/value, ", handled, " work-state handler calls");
+
+    // One minute of polling every work state at 1 Hz: 384 requests/s wanted,
+    // ~195/s allowed by a 10% budget at 250 kbit/s
+    server.poll(ddi::ACTUAL_WORK_STATE, POLL_INTERVAL_MS);
+    link->requests.fill(0);
+    for (u32 t = 0; t < SIM_MS; t += 10)
+        server.update(10);
+
+    u64 lo = ~0ull, hi = 0, total = 0;
+    for (u32 c = 0; c < CLIENTS; ++c) {
+        u64 n = link->requests[FIRST_CLIENT + c];
+        lo = std::min(lo, n);
+        hi = std::max(hi, n);
+        total += n;
+    }
+    const auto &ps = server.poll_stats();
+    f64 rate = total * 1000.0 / SIM_MS;
+    f64 allowed = TCServerConfig{}.poll_budget(0.10f).poll_frames_per_s();
+    echo::info("polling: ", rate, " requests/s (budget ", allowed, "/s), per client ", lo, "..", hi, ", ",
+               ps.deferred_budget, " deferred, max lateness ", ps.max_lateness_ms, " ms");
+
+    echo::info("(checksum ", found, ")");
+    bool paced = rate <= allowed * 1.01 && rate >= allowed * 0.9;
+    bool fair = hi - lo <= 2; // within one round-robin pass
+    return indexed_ns < linear_ns && paced && fair ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include <agrobus/isobus/tc/task_log.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+#include <thread>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+// Sustained TLG logging: 20 implements each reporting 200 DDIs at 5 Hz into one
+// TC for 10 simulated minutes, replayed at 100x real time (2,000,000 samples/s)
+// on the caller's thread while the writer drains blocks in the background. The
+// run passes if no sample is dropped at that pace.
+
+static constexpr u32 CLIENTS = 20;
+static constexpr u16 DDIS = 200;
+static constexpr u32 RATE_HZ = 5;
+static constexpr u32 SIM_S = 600;
+static constexpr u32 SPEEDUP = 100;
+
+int main() {
+    echo::info("=== TC task log benchmark ===");
+
+    auto dir = std::filesystem::temp_directory_path() / "agrobus_tlg_bench";
+    std::filesystem::remove_all(dir);
+
+    TaskLogger logger(TaskLogConfig{}.path(dir).blocks(4096, 64).flush_interval(1000));
+    if (!logger.start().is_ok()) {
+        echo::error("cannot start task logger");
+        return 1;
+    }
+    logger.set_time(16000, 0);
+    logger.set_position(GeoPoint{concord::earth::WGS(52.0, 5.0), 0});
+
+    const u32 period_ms = 1000 / RATE_HZ;
+    u64 offered = 0;
+    f64 worst_tick_us = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto next_tick = start;
+    for (u32 t = 0; t < SIM_S * 1000; t += period_ms) {
+        auto tick_start = std::chrono::steady_clock::now();
+        for (u32 c = 0; c < CLIENTS; ++c)
+            for (u16 d = 0; d < DDIS; ++d) {
+                logger.log(0x1000 + c, static_cast<ElementNumber>(d / 20), static_cast<DDI>(d + 1),
+                           static_cast<i32>(t + d));
+                ++offered;
+            }
+        logger.update(period_ms);
+        f64 tick_us =
+            std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - tick_start).count();
+        if (tick_us > worst_tick_us)
+            worst_tick_us = tick_us;
+        next_tick += std::chrono::microseconds(period_ms * 1000 / SPEEDUP);
+        std::this_thread::sleep_until(next_tick);
+    }
+    auto ingested = std::chrono::steady_clock::now();
+    logger.stop();
+    auto drained = std::chrono::steady_clock::now();
+
+    auto stats = logger.stats();
+    f64 total_s = std::chrono::duration<f64>(drained - start).count();
+    f64 drain_ms = std::chrono::duration<f64, std::milli>(drained - ingested).count();
+    f64 required = static_cast<f64>(CLIENTS) * DDIS * RATE_HZ;
+
+    echo::info(CLIENTS, " clients x ", DDIS, " DDIs @ ", RATE_HZ, " Hz, ", SIM_S, " s simulated at ", SPEEDUP,
+               "x");
+    echo::info("offered: ", offered, " samples, logged: ", stats.samples, ", dropped: ", stats.dropped);
+    echo::info("worst 200 ms tick (", CLIENTS * DDIS, " samples): ", worst_tick_us, " us");
+    echo::info("sustained: ", offered / total_s, " samples/s (real time needs ", required, "), final drain ",
+               drain_ms, " ms");
+    echo::info("written: ", stats.records, " records, ", stats.bytes_written / (1024.0 * 1024.0), " MiB, ",
+               stats.blocks_written, " blocks; memory bound ", logger.memory_bound() / 1024, " KiB");
+
+    std::filesystem::remove_all(dir);
+    return stats.dropped == 0 ? 0 : 1;
+}
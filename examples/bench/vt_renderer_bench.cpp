@@ -0,0 +1,111 @@
+#include <agrobus/isobus/vt/renderer.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::vt;
+
+// Full data mask render vs. incremental Change Numeric Value updates on an
+// 800x480 terminal: a 480x480 data mask with a 6x6 grid of gauge tiles (output
+// number, frame, meter, bar graph) and a bitmap, plus a six key soft key mask.
+
+static constexpr u16 GRID = 6;
+static constexpr u16 TILE = 80;
+static constexpr u32 FULL_FRAMES = 200;
+static constexpr u32 UPDATE_FRAMES = 20000;
+
+static dp::Vector<u8> sized(u16 w, u16 h, std::initializer_list<u8> extra = {}) {
+    dp::Vector<u8> body = {static_cast<u8>(w & 0xFF), static_cast<u8>(w >> 8), static_cast<u8>(h & 0xFF),
+                           static_cast<u8>(h >> 8)};
+    for (auto b : extra)
+        body.push_back(b);
+    return body;
+}
+
+static ObjectID number_id(u16 tile) { return static_cast<ObjectID>(1000 + tile * 10 + 1); }
+
+static ObjectPool make_pool(VTRenderer &renderer) {
+    ObjectPool pool;
+    pool.add(VTObject{}.set_id(0).set_type(ObjectType::WorkingSet).set_children({1}));
+
+    VTObject mask;
+    mask.set_id(1).set_type(ObjectType::DataMask).set_body(sized(480, 480, {15, 2, 0}));
+    for (u16 t = 0; t < GRID * GRID; ++t) {
+        ObjectID base = static_cast<ObjectID>(1000 + t * 10);
+        mask.add_child(base);
+        renderer.set_position(base, static_cast<i16>((t % GRID) * TILE), static_cast<i16>((t / GRID) * TILE));
+
+        pool.add(VTObject{}.set_id(base).set_type(ObjectType::Container).set_body(sized(TILE, TILE)).set_children(
+            {static_cast<ObjectID>(base + 1), static_cast<ObjectID>(base + 2), static_cast<ObjectID>(base + 3),
+             static_cast<ObjectID>(base + 4)}));
+        pool.add(VTObject{}.set_id(base + 1).set_type(ObjectType::OutputNumber).set_body(
+            sized(TILE, 20, {0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x80, 0x3F, 1})));
+        pool.add(VTObject{}.set_id(base + 2).set_type(ObjectType::Rectangle).set_body(sized(TILE, TILE, {8})));
+        pool.add(VTObject{}.set_id(base + 3).set_type(ObjectType::Meter).set_body(
+            sized(44, 44, {12, 1, 0, 0, 100, 0, 50, 0, 0, 0})));
+        pool.add(VTObject{}.set_id(base + 4).set_type(ObjectType::LinearBarGraph).set_body(
+            sized(TILE - 8, 8, {10, 1, 0, 0, 100, 0, 25, 0, 0, 0})));
+        renderer.set_position(base + 1, 0, 0);
+        renderer.set_position(base + 2, 0, 0);
+        renderer.set_position(base + 3, 18, 22);
+        renderer.set_position(base + 4, 4, 68);
+    }
+
+    dp::Vector<u8> bitmap = sized(64, 64, {VT_NO_COLOUR});
+    for (u32 i = 0; i < 64u * 64u; ++i)
+        bitmap.push_back(static_cast<u8>(16 + (i % 216)));
+    pool.add(VTObject{}.set_id(2000).set_type(ObjectType::PictureGraphic).set_body(std::move(bitmap)));
+    mask.add_child(2000);
+    renderer.set_position(2000, 400, 400);
+    pool.add(std::move(mask));
+
+    VTObject keys;
+    keys.set_id(2).set_type(ObjectType::SoftKeyMask).set_body(sized(320, 480));
+    for (u16 k = 0; k < 6; ++k) {
+        ObjectID key = static_cast<ObjectID>(3000 + k);
+        keys.add_child(key);
+        pool.add(VTObject{}.set_id(key).set_type(ObjectType::Key).set_body(sized(0, 0, {static_cast<u8>(7 + k % 2)})));
+    }
+    pool.add(std::move(keys));
+    return pool;
+}
+
+int main() {
+    echo::info("=== VT renderer benchmark ===");
+
+    VTRenderer renderer(VTRendererConfig{}.screen(800, 480));
+    renderer.set_pool(make_pool(renderer));
+    renderer.render();
+    echo::info("800x480, ", renderer.node_count(), " nodes on screen");
+
+    // Full repaint (mask change / first frame)
+    u64 full_pixels = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (u32 f = 0; f < FULL_FRAMES; ++f) {
+        renderer.invalidate_all();
+        full_pixels += renderer.render().pixels;
+    }
+    auto end = std::chrono::steady_clock::now();
+    f64 full_us = std::chrono::duration<f64, std::micro>(end - start).count() / FULL_FRAMES;
+
+    // Incremental: one Change Numeric Value per frame, rotating over the tiles
+    u64 update_pixels = 0;
+    u32 partial = 0;
+    start = std::chrono::steady_clock::now();
+    for (u32 f = 0; f < UPDATE_FRAMES; ++f) {
+        renderer.set_numeric_value(number_id(static_cast<u16>(f % (GRID * GRID))), f);
+        auto result = renderer.render();
+        update_pixels += result.pixels;
+        partial += result.full ? 0 : 1;
+    }
+    end = std::chrono::steady_clock::now();
+    f64 update_us = std::chrono::duration<f64, std::micro>(end - start).count() / UPDATE_FRAMES;
+
+    echo::info("full mask render  : ", full_us, " us/frame, ", full_pixels / FULL_FRAMES, " px/frame");
+    echo::info("numeric update    : ", update_us, " us/frame, ", update_pixels / UPDATE_FRAMES, " px/frame");
+    if (update_us > 0.0)
+        echo::info("speedup: ", full_us / update_us, "x");
+
+    return partial == UPDATE_FRAMES ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <agrobus/isobus/vt/state_tracker.hpp>
+#include <chrono>
+#include <echo/echo.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::vt;
+
+// Compares the sparse (dp::Map) and dense (slot) layouts of VTClientStateTracker
+// for the duplicate-suppression path of VTClientUpdateHelper: one lookup plus a
+// conditional store per output number per update tick.
+
+static constexpr u16 OUTPUT_COUNT = 600;
+static constexpr u32 TICKS = 20 * 60 * 10; // 10 minutes at 20 Hz
+
+static ObjectPool make_pool() {
+    ObjectPool pool;
+    pool.add(VTObject{}.set_id(0).set_type(ObjectType::WorkingSet));
+    pool.add(VTObject{}.set_id(1).set_type(ObjectType::DataMask));
+    // Spread IDs like a designer-generated pool does
+    for (u16 i = 0; i < OUTPUT_COUNT; ++i)
+        pool.add(VTObject{}.set_id(static_cast<ObjectID>(2000 + i * 7)).set_type(ObjectType::OutputNumber));
+    return pool;
+}
+
+static f64 run(VTClientStateTracker &tracker, usize &changes) {
+    changes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (u32 tick = 0; tick < TICKS; ++tick) {
+        for (u16 i = 0; i < OUTPUT_COUNT; ++i) {
+            ObjectID id = static_cast<ObjectID>(2000 + i * 7);
+            // Roughly 1 in 8 values change per tick
+            u32 value = (i % 8 == tick % 8) ? tick : (tick & ~7u);
+            auto current = tracker.numeric_value(id);
+            if (current && *current == value)
+                continue;
+            tracker.set_numeric_value(id, value);
+            ++changes;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::micro>(end - start).count();
+}
+
+int main() {
+    echo::info("=== VT state tracker benchmark ===");
+    echo::info(OUTPUT_COUNT, " output numbers, ", TICKS, " ticks");
+
+    IsoNet nm;
+    auto pool = make_pool();
+
+    VTClientStateTracker sparse(nm);
+    usize sparse_changes = 0;
+    f64 sparse_us = run(sparse, sparse_changes);
+
+    VTClientStateTracker dense(nm);
+    dense.bind_pool(pool);
+    usize dense_changes = 0;
+    f64 dense_us = run(dense, dense_changes);
+
+    f64 updates = static_cast<f64>(TICKS) * OUTPUT_COUNT;
+    echo::info("map   : ", sparse_us / 1000.0, " ms total, ", sparse_us * 1000.0 / updates, " ns/update (",
+               sparse_changes, " changes)");
+    echo::info("dense : ", dense_us / 1000.0, " ms total, ", dense_us * 1000.0 / updates, " ns/update (",
+               dense_changes, " changes)");
+    if (dense_us > 0.0)
+        echo::info("speedup: ", sparse_us / dense_us, "x");
+
+    return sparse_changes == dense_changes ? 0 : 1;
+}
@@ -392,6 +392,14 @@ static const char *tc_state_name(TCState s) {
         return "RequestVersion";
     case TCState::WaitForVersion:
         return "WaitForVersion";
+    case TCState::RequestStructureLabel:
+        return "RequestStructureLabel";
+    case TCState::WaitForStructureLabel:
+        return "WaitForStructureLabel";
+    case TCState::RequestLocalizationLabel:
+        return "RequestLocalizationLabel";
+    case TCState::WaitForLocalizationLabel:
+        return "WaitForLocalizationLabel";
     case TCState::ProcessDDOP:
         return "ProcessDDOP";
     case TCState::TransferDDOP:
@@ -17,6 +17,7 @@
 #include "agrobus/net/identifier.hpp"
 #include "agrobus/net/internal_cf.hpp"
 #include "agrobus/net/iop_parser.hpp"
+#include "agrobus/net/mapped_file.hpp"
 #include "agrobus/net/message.hpp"
 #include "agrobus/net/name.hpp"
 #include "agrobus/net/name_manager.hpp"
@@ -33,19 +34,25 @@
 #include "agrobus/net/tp.hpp"
 #include "agrobus/net/types.hpp"
 #include "agrobus/net/working_set.hpp"
+#include "agrobus/net/xml_reader.hpp"
 
 // ─── J1939 (engine, diagnostics, protocol messages) ─────────────────────────
 #include "agrobus/j1939/acknowledgment.hpp"
 #include "agrobus/j1939/diagnostic.hpp"
+#include "agrobus/j1939/dm1_aggregator.hpp"
 #include "agrobus/j1939/dm_memory.hpp"
+#include "agrobus/j1939/dtc_journal.hpp"
 #include "agrobus/j1939/engine.hpp"
 #include "agrobus/j1939/heartbeat.hpp"
 #include "agrobus/j1939/language.hpp"
 #include "agrobus/j1939/maintain_power.hpp"
+#include "agrobus/j1939/memory_access.hpp"
 #include "agrobus/j1939/pgn_request.hpp"
 #include "agrobus/j1939/proprietary.hpp"
 #include "agrobus/j1939/request2.hpp"
 #include "agrobus/j1939/shortcut_button.hpp"
+#include "agrobus/j1939/signal_db.hpp"
+#include "agrobus/j1939/signal_history.hpp"
 #include "agrobus/j1939/speed_distance.hpp"
 #include "agrobus/j1939/time_date.hpp"
 #include "agrobus/j1939/transmission.hpp"
@@ -57,6 +64,7 @@
 #include "agrobus/isobus/fs/error_codes.hpp"
 #include "agrobus/isobus/fs/server.hpp"
 #include "agrobus/isobus/fs/types.hpp"
+#include "agrobus/isobus/fs/volume.hpp"
 #include "agrobus/isobus/functionalities.hpp"
 #include "agrobus/isobus/group_function.hpp"
 #include "agrobus/isobus/guidance.hpp"
@@ -74,18 +82,28 @@
 #include "agrobus/isobus/tc/client.hpp"
 #include "agrobus/isobus/tc/ddi_database.hpp"
 #include "agrobus/isobus/tc/ddop.hpp"
+#include "agrobus/isobus/tc/ddop_cache.hpp"
 #include "agrobus/isobus/tc/ddop_helpers.hpp"
 #include "agrobus/isobus/tc/geo.hpp"
+#include "agrobus/isobus/tc/measurement.hpp"
 #include "agrobus/isobus/tc/objects.hpp"
 #include "agrobus/isobus/tc/peer_control.hpp"
+#include "agrobus/isobus/tc/prescription_index.hpp"
+#include "agrobus/isobus/tc/section_control.hpp"
 #include "agrobus/isobus/tc/server.hpp"
 #include "agrobus/isobus/tc/server_options.hpp"
+#include "agrobus/isobus/tc/task_log.hpp"
+#include "agrobus/isobus/tc/taskdata.hpp"
 #include "agrobus/isobus/tim.hpp"
 #include "agrobus/isobus/tractor_ecu.hpp"
 #include "agrobus/isobus/vt/auxiliary_caps.hpp"
 #include "agrobus/isobus/vt/client.hpp"
+#include "agrobus/isobus/vt/command_queue.hpp"
 #include "agrobus/isobus/vt/commands.hpp"
+#include "agrobus/isobus/vt/dense_state.hpp"
 #include "agrobus/isobus/vt/objects.hpp"
+#include "agrobus/isobus/vt/pool_store.hpp"
+#include "agrobus/isobus/vt/renderer.hpp"
 #include "agrobus/isobus/vt/server.hpp"
 #include "agrobus/isobus/vt/server_working_set.hpp"
 #include "agrobus/isobus/vt/state_tracker.hpp"
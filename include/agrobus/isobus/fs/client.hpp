@@ -9,6 +9,7 @@
 #include <agrobus/net/message.hpp>
 #include <agrobus/net/network_manager.hpp>
 #include <datapod/datapod.hpp>
+#include <deque>
 #include <echo/echo.hpp>
 
 namespace agrobus::isobus::fs {
@@ -46,11 +47,13 @@ namespace agrobus::isobus::fs {
 
     // ─── File Client Configuration ───────────────────────────────────────────────
     struct FileClientConfig {
-        u32 ccm_interval_ms = 2000;          // Send CCM every 2s
-        u32 request_timeout_ms = 6000;       // Request timeout (6s)
-        u32 server_status_timeout_ms = 6000; // Server status timeout (6s)
-        u32 retry_delay_ms = 500;            // Delay before retry
-        u8 max_retries_ = 3;                 // Max request retries
+        u32 ccm_interval_ms = 2000;            // Send CCM every 2s
+        u32 request_timeout_ms = 6000;         // Request timeout (6s)
+        u32 server_status_timeout_ms = 6000;   // Server status timeout (6s)
+        u32 retry_delay_ms = 500;              // Delay before retry
+        u8 max_retries_ = 3;                   // Max request retries
+        u16 transfer_block = FS_TP_BLOCK_SIZE; // Bytes per request in download_file/upload_file
+        u8 transfer_window = 4;                // Requests in flight in download_file/upload_file
 
         FileClientConfig &ccm_interval(u32 ms) {
             ccm_interval_ms = ms;
@@ -66,6 +69,42 @@ namespace agrobus::isobus::fs {
             max_retries_ = n;
             return *this;
         }
+
+        FileClientConfig &block_size(u16 bytes) {
+            transfer_block = bytes;
+            return *this;
+        }
+
+        FileClientConfig &window(u8 n) {
+            transfer_window = n;
+            return *this;
+        }
+    };
+
+    // ─── Streaming transfer callbacks ────────────────────────────────────────────
+    using TransferSink = std::function<void(const u8 *data, usize size)>; // file data in order
+    using TransferProgress = std::function<void(u64 bytes)>;              // bytes delivered/acknowledged so far
+    using TransferDone = std::function<void(Result<u64>)>;                // total bytes, or the first error
+
+    // ─── Streaming transfer state ────────────────────────────────────────────────
+    // download_file/upload_file keep up to transfer_window requests in flight so
+    // the next block is already queued at the server when the previous one
+    // leaves the bus. Responses are put back in request order before delivery.
+    struct FileTransfer {
+        bool upload = false;
+        FileHandle handle = INVALID_FILE_HANDLE;
+        u64 bytes = 0;       // delivered to the sink / acknowledged by the server
+        u64 next_offset = 0; // upload: next byte to send
+        u32 next_seq = 0;    // sequence number of the next request
+        u32 deliver_seq = 0; // download: next sequence handed to the sink
+        u8 in_flight = 0;
+        bool eof = false;
+        u32 last_activity_ms = 0;
+        dp::Map<u32, dp::Vector<u8>> reorder; // download: blocks that overtook an earlier one
+        dp::Vector<u8> source;                // upload data
+        TransferSink sink;
+        TransferProgress progress;
+        TransferDone done;
     };
 
     // ─── File Client ─────────────────────────────────────────────────────────────
@@ -95,6 +134,13 @@ namespace agrobus::isobus::fs {
         // Current directory
         dp::String current_directory_ = "\\";
 
+        // Requests waiting for the transport session to the server
+        std::deque<dp::Vector<u8>> tx_queue_;
+
+        // Streaming transfers by id
+        dp::Map<u32, FileTransfer> transfers_;
+        u32 next_transfer_id_ = 0;
+
       public:
         FileClient(IsoNet &net, InternalCF *cf, FileClientConfig config = {}) : net_(net), cf_(cf), config_(config) {}
 
@@ -145,7 +191,9 @@ namespace agrobus::isobus::fs {
             state_ = ClientState::Disconnected;
             server_address_ = NULL_ADDRESS;
             pending_requests_.clear();
+            tx_queue_.clear();
             open_files_.clear();
+            fail_transfers("disconnected");
             current_directory_ = "\\";
 
             echo::category("isobus.fs.client").info("Disconnected from file server");
@@ -187,9 +235,12 @@ namespace agrobus::isobus::fs {
             echo::category("isobus.fs.client").debug("Open file request: ", path);
         }
 
-        void close_file(FileHandle handle) {
+        // The callback reports the server's result, e.g. WriteFail for data it could not store
+        void close_file(FileHandle handle, std::function<void(Result<void>)> callback = {}) {
             if (!open_files_.count(handle)) {
                 echo::category("isobus.fs.client").warn("Close: invalid handle ", static_cast<u32>(handle));
+                if (callback)
+                    callback(Result<void>::err(Error::invalid_state("invalid handle")));
                 return;
             }
 
@@ -200,13 +251,15 @@ namespace agrobus::isobus::fs {
             request[1] = tan;
             request[2] = handle;
 
-            send_request(tan, FSFunction::CloseFile, request,
-                         [this, handle](const dp::Vector<u8> &response) { handle_close_response(handle, response); });
+            send_request(tan, FSFunction::CloseFile, request, [this, handle, callback](const dp::Vector<u8> &response) {
+                handle_close_response(handle, response, callback);
+            });
 
             echo::category("isobus.fs.client").debug("Close file request: handle=", static_cast<u32>(handle));
         }
 
-        void read_file(FileHandle handle, u8 count, std::function<void(Result<dp::Vector<u8>>)> callback) {
+        // Up to 65535 bytes; blocks over FS_TP_BLOCK_SIZE come back over ETP
+        void read_file(FileHandle handle, u16 count, std::function<void(Result<dp::Vector<u8>>)> callback) {
 
             if (!open_files_.count(handle)) {
                 callback(Result<dp::Vector<u8>>::err(Error::invalid_state("invalid handle")));
@@ -219,7 +272,8 @@ namespace agrobus::isobus::fs {
             TAN tan = allocate_tan();
             request[1] = tan;
             request[2] = handle;
-            request[3] = count;
+            request[3] = static_cast<u8>(count & 0xFF);
+            request[4] = static_cast<u8>(count >> 8);
 
             send_request(tan, FSFunction::ReadFile, request, [this, handle, callback](const dp::Vector<u8> &response) {
                 handle_read_response(handle, response, callback);
@@ -229,32 +283,61 @@ namespace agrobus::isobus::fs {
                 .trace("Read file request: handle=", static_cast<u32>(handle), " count=", static_cast<u32>(count));
         }
 
-        void write_file(FileHandle handle, const dp::Vector<u8> &data, std::function<void(Result<u8>)> callback) {
+        // Next page of a handle opened with OpenFlags::OpenDir, up to max_entries;
+        // an empty page marks the end of the directory
+        void read_directory(FileHandle handle, u16 max_entries,
+                            std::function<void(Result<dp::Vector<FileEntry>>)> callback) {
+            read_file(handle, max_entries, [callback](Result<dp::Vector<u8>> result) {
+                if (!result.is_ok()) {
+                    callback(Result<dp::Vector<FileEntry>>::err(result.error()));
+                    return;
+                }
+                const auto &data = result.value();
+                dp::Vector<FileEntry> entries;
+                usize offset = 0, consumed = 0;
+                while (offset < data.size()) {
+                    FileEntry entry = FileEntry::decode(data.data() + offset, data.size() - offset, consumed);
+                    if (consumed == 0)
+                        break;
+                    entries.push_back(std::move(entry));
+                    offset += consumed;
+                }
+                callback(Result<dp::Vector<FileEntry>>::ok(std::move(entries)));
+            });
+        }
+
+        void write_file(FileHandle handle, const dp::Vector<u8> &data, std::function<void(Result<u16>)> callback) {
+            write_file(handle, data.data(), data.size(), std::move(callback));
+        }
+
+        // Up to 65535 bytes; the request goes out over TP/ETP when it exceeds one frame
+        void write_file(FileHandle handle, const u8 *data, usize size, std::function<void(Result<u16>)> callback) {
 
             if (!open_files_.count(handle)) {
-                callback(Result<u8>::err(Error::invalid_state("invalid handle")));
+                callback(Result<u16>::err(Error::invalid_state("invalid handle")));
+                return;
+            }
+            if (size > 0xFFFF) {
+                callback(Result<u16>::err(Error::invalid_data("write exceeds 65535 bytes")));
                 return;
             }
 
             // Build request
-            dp::Vector<u8> request(8, 0xFF);
+            dp::Vector<u8> request(std::max<usize>(8, FS_BLOCK_HEADER_SIZE + size), 0xFF);
             request[0] = static_cast<u8>(FSFunction::WriteFile);
             TAN tan = allocate_tan();
             request[1] = tan;
             request[2] = handle;
-            request[3] = static_cast<u8>(data.size());
-
-            // Add data
-            for (usize i = 0; i < data.size() && i + 4 < 8; ++i) {
-                request[4 + i] = data[i];
-            }
+            request[3] = static_cast<u8>(size & 0xFF);
+            request[4] = static_cast<u8>(size >> 8);
+            std::copy_n(data, size, request.begin() + FS_BLOCK_HEADER_SIZE);
 
             send_request(tan, FSFunction::WriteFile, request, [this, handle, callback](const dp::Vector<u8> &response) {
                 handle_write_response(handle, response, callback);
             });
 
             echo::category("isobus.fs.client")
-                .trace("Write file request: handle=", static_cast<u32>(handle), " bytes=", data.size());
+                .trace("Write file request: handle=", static_cast<u32>(handle), " bytes=", size);
         }
 
         void seek_file(FileHandle handle, u32 position, std::function<void(Result<void>)> callback) {
@@ -284,6 +367,47 @@ namespace agrobus::isobus::fs {
                 .trace("Seek file request: handle=", static_cast<u32>(handle), " pos=", position);
         }
 
+        // ─── Streaming Transfers ─────────────────────────────────────────────────
+        // Reads a whole file in transfer_block requests, transfer_window at a time.
+        // The sink sees the data in file order; done reports the byte count.
+        void download_file(const dp::String &path, TransferSink sink, TransferDone done,
+                           TransferProgress progress = {}) {
+            if (!is_connected()) {
+                done(Result<u64>::err(Error::invalid_state("not connected")));
+                return;
+            }
+
+            u32 id = next_transfer_id_++;
+            FileTransfer &t = transfers_[id];
+            t.sink = std::move(sink);
+            t.done = std::move(done);
+            t.progress = std::move(progress);
+            t.last_activity_ms = current_time_ms_;
+            open_file(path, OpenFlags::Read, [this, id](Result<FileHandle> result) { on_transfer_open(id, result); });
+        }
+
+        // Creates or overwrites a file from memory, keeping transfer_window writes in flight.
+        // done fires once the server confirmed the close, so the data is stored.
+        void upload_file(const dp::String &path, dp::Vector<u8> data, TransferDone done,
+                         TransferProgress progress = {}) {
+            if (!is_connected()) {
+                done(Result<u64>::err(Error::invalid_state("not connected")));
+                return;
+            }
+
+            u32 id = next_transfer_id_++;
+            FileTransfer &t = transfers_[id];
+            t.upload = true;
+            t.source = std::move(data);
+            t.done = std::move(done);
+            t.progress = std::move(progress);
+            t.last_activity_ms = current_time_ms_;
+            open_file(path, OpenFlags::Write | OpenFlags::Create,
+                      [this, id](Result<FileHandle> result) { on_transfer_open(id, result); });
+        }
+
+        usize active_transfers() const noexcept { return transfers_.size(); }
+
         // ─── Directory Operations ────────────────────────────────────────────────
         void get_current_directory(std::function<void(Result<dp::String>)> callback) {
             if (!is_connected()) {
@@ -373,8 +497,12 @@ namespace agrobus::isobus::fs {
                 }
             }
 
+            // Requests held back while an earlier one was still on the bus
+            flush_requests();
+
             // Check for expired requests and retry
             check_expired_requests();
+            check_stalled_transfers();
         }
 
       private:
@@ -420,7 +548,7 @@ namespace agrobus::isobus::fs {
             FSFunction function = static_cast<FSFunction>(data[0]);
 
             if (function == FSFunction::FileServerStatus) {
-                server_status_ = FileServerStatus::decode(data);
+                server_status_ = FileServerStatus::decode(dp::Vector<u8>(data.begin() + 3, data.end()));
                 echo::category("isobus.fs.client")
                     .trace("Server status: busy=", server_status_->busy,
                            " open_files=", static_cast<u32>(server_status_->number_of_open_files));
@@ -482,16 +610,26 @@ namespace agrobus::isobus::fs {
             callback(Result<FileHandle>::ok(handle));
         }
 
-        void handle_close_response(FileHandle handle, const dp::Vector<u8> &response) {
+        void handle_close_response(FileHandle handle, const dp::Vector<u8> &response,
+                                   std::function<void(Result<void>)> callback) {
             open_files_.erase(handle);
             echo::category("isobus.fs.client").debug("File closed: handle=", static_cast<u32>(handle));
             on_file_closed.emit(handle);
+
+            if (!callback)
+                return;
+            FSError error = response.size() >= 3 ? static_cast<FSError>(response[2]) : FSError::MalformedRequest;
+            if (error != FSError::Success) {
+                callback(Result<void>::err(Error::invalid_state(fs_error_to_string(error))));
+                return;
+            }
+            callback(Result<void>::ok());
         }
 
         void handle_read_response(FileHandle handle, const dp::Vector<u8> &response,
                                   std::function<void(Result<dp::Vector<u8>>)> callback) {
 
-            if (response.size() < 4) {
+            if (response.size() < 3) {
                 callback(Result<dp::Vector<u8>>::err(Error::invalid_state("malformed response")));
                 return;
             }
@@ -509,13 +647,21 @@ namespace agrobus::isobus::fs {
                 return;
             }
 
-            u8 count = response[3];
-            dp::Vector<u8> data;
-
-            for (u8 i = 0; i < count && i + 4 < response.size(); ++i) {
-                data.push_back(response[4 + i]);
+            if (response.size() < FS_BLOCK_HEADER_SIZE) {
+                callback(Result<dp::Vector<u8>>::err(Error::invalid_state("malformed response")));
+                return;
             }
 
+            // Directory reads count entries; their records fill the rest of the response
+            u16 count = static_cast<u16>(response[3] | (response[4] << 8));
+            auto file = open_files_.find(handle);
+            bool directory = file != open_files_.end() && get_access_mode(file->second.flags) == OpenFlags::OpenDir;
+            usize bytes = response.size() - FS_BLOCK_HEADER_SIZE;
+            if (!directory)
+                bytes = count = static_cast<u16>(std::min<usize>(count, bytes));
+            dp::Vector<u8> data(response.begin() + FS_BLOCK_HEADER_SIZE,
+                                response.begin() + FS_BLOCK_HEADER_SIZE + static_cast<isize>(bytes));
+
             // Update position
             if (open_files_.count(handle)) {
                 open_files_[handle].position += count;
@@ -525,29 +671,34 @@ namespace agrobus::isobus::fs {
         }
 
         void handle_write_response(FileHandle handle, const dp::Vector<u8> &response,
-                                   std::function<void(Result<u8>)> callback) {
+                                   std::function<void(Result<u16>)> callback) {
 
-            if (response.size() < 4) {
-                callback(Result<u8>::err(Error::invalid_state("malformed response")));
+            if (response.size() < 3) {
+                callback(Result<u16>::err(Error::invalid_state("malformed response")));
                 return;
             }
 
             FSError error = static_cast<FSError>(response[2]);
             if (error != FSError::Success) {
                 echo::category("isobus.fs.client").error("Write failed: ", fs_error_to_string(error));
-                callback(Result<u8>::err(Error::invalid_state(fs_error_to_string(error))));
+                callback(Result<u16>::err(Error::invalid_state(fs_error_to_string(error))));
                 on_error.emit(error);
                 return;
             }
 
-            u8 written = response[3];
+            if (response.size() < FS_BLOCK_HEADER_SIZE) {
+                callback(Result<u16>::err(Error::invalid_state("malformed response")));
+                return;
+            }
+
+            u16 written = static_cast<u16>(response[3] | (response[4] << 8));
 
             // Update position
             if (open_files_.count(handle)) {
                 open_files_[handle].position += written;
             }
 
-            callback(Result<u8>::ok(written));
+            callback(Result<u16>::ok(written));
         }
 
         void handle_seek_response(FileHandle handle, u32 position, const dp::Vector<u8> &response,
@@ -640,8 +791,26 @@ namespace agrobus::isobus::fs {
             pending.callback = callback;
             pending_requests_[tan] = pending;
 
-            // Send to server (broadcast to all file servers)
-            net_.send(PGN_FILE_CLIENT_TO_SERVER, request, cf_);
+            // Multi-frame requests (large writes) queue behind one still on the bus
+            if (tx_queue_.empty() && transmit(request))
+                return;
+            tx_queue_.push_back(request);
+        }
+
+        // False only while the transport session to the server is busy
+        bool transmit(const dp::Vector<u8> &request) {
+            if (request.size() > CAN_DATA_LENGTH &&
+                net_.transport_busy(PGN_FILE_CLIENT_TO_SERVER, cf_->address(), server_address_))
+                return false;
+            ControlFunction dest;
+            dest.address = server_address_;
+            net_.send(PGN_FILE_CLIENT_TO_SERVER, request, cf_, &dest);
+            return true;
+        }
+
+        void flush_requests() {
+            while (!tx_queue_.empty() && transmit(tx_queue_.front()))
+                tx_queue_.pop_front();
         }
 
         void send_ccm() {
@@ -673,6 +842,148 @@ namespace agrobus::isobus::fs {
                 pending_requests_.erase(tan);
             }
         }
+
+        // ─── Streaming Transfer Internals ────────────────────────────────────────
+        void on_transfer_open(u32 id, Result<FileHandle> result) {
+            auto it = transfers_.find(id);
+            if (it == transfers_.end())
+                return;
+            if (!result.is_ok()) {
+                finish_transfer(id, Result<u64>::err(result.error()));
+                return;
+            }
+            it->second.handle = result.value();
+            pump_transfer(id);
+        }
+
+        // Tops the transfer up to transfer_window requests in flight
+        void pump_transfer(u32 id) {
+            FileTransfer &t = transfers_[id];
+            u16 block = std::max<u16>(config_.transfer_block, 1);
+            u8 window = std::max<u8>(config_.transfer_window, 1);
+
+            while (t.in_flight < window) {
+                u32 seq = t.next_seq;
+                if (t.upload) {
+                    if (t.next_offset >= t.source.size())
+                        break;
+                    usize n = std::min<usize>(block, t.source.size() - t.next_offset);
+                    const u8 *data = t.source.data() + t.next_offset;
+                    t.next_offset += n;
+                    ++t.next_seq;
+                    ++t.in_flight;
+                    write_file(t.handle, data, n, [this, id, n](Result<u16> r) { on_transfer_write(id, n, r); });
+                } else {
+                    if (t.eof)
+                        break;
+                    ++t.next_seq;
+                    ++t.in_flight;
+                    read_file(t.handle, block,
+                              [this, id, seq](Result<dp::Vector<u8>> r) { on_transfer_read(id, seq, std::move(r)); });
+                }
+                if (!transfers_.count(id))
+                    return; // failed synchronously
+            }
+
+            bool complete = t.upload ? t.bytes == t.source.size() : t.eof;
+            if (complete && t.in_flight == 0) {
+                close_file(t.handle, [this, id](Result<void> r) {
+                    auto it = transfers_.find(id);
+                    if (it == transfers_.end())
+                        return;
+                    u64 bytes = it->second.bytes;
+                    it->second.handle = INVALID_FILE_HANDLE; // closed
+                    finish_transfer(id, r.is_ok() ? Result<u64>::ok(bytes) : Result<u64>::err(r.error()));
+                });
+                t.in_flight = 1; // the close
+            }
+        }
+
+        void on_transfer_read(u32 id, u32 seq, Result<dp::Vector<u8>> result) {
+            auto it = transfers_.find(id);
+            if (it == transfers_.end())
+                return;
+            FileTransfer &t = it->second;
+            --t.in_flight;
+            t.last_activity_ms = current_time_ms_;
+            if (!result.is_ok()) {
+                finish_transfer(id, Result<u64>::err(result.error()));
+                return;
+            }
+
+            // A short block means the end of the file; stop asking for more
+            if (result.value().size() < config_.transfer_block)
+                t.eof = true;
+            t.reorder[seq] = std::move(result.value());
+
+            for (auto next = t.reorder.find(t.deliver_seq); next != t.reorder.end();
+                 next = t.reorder.find(t.deliver_seq)) {
+                if (!next->second.empty()) {
+                    if (t.sink)
+                        t.sink(next->second.data(), next->second.size());
+                    t.bytes += next->second.size();
+                    if (t.progress)
+                        t.progress(t.bytes);
+                }
+                t.reorder.erase(next);
+                ++t.deliver_seq;
+            }
+            pump_transfer(id);
+        }
+
+        void on_transfer_write(u32 id, usize requested, Result<u16> result) {
+            auto it = transfers_.find(id);
+            if (it == transfers_.end())
+                return;
+            FileTransfer &t = it->second;
+            --t.in_flight;
+            t.last_activity_ms = current_time_ms_;
+            if (!result.is_ok()) {
+                finish_transfer(id, Result<u64>::err(result.error()));
+                return;
+            }
+            if (result.value() != requested) {
+                finish_transfer(id, Result<u64>::err(Error::invalid_state(fs_error_to_string(FSError::NoSpace))));
+                return;
+            }
+            t.bytes += requested;
+            if (t.progress)
+                t.progress(t.bytes);
+            pump_transfer(id);
+        }
+
+        void finish_transfer(u32 id, Result<u64> result) {
+            auto it = transfers_.find(id);
+            if (it == transfers_.end())
+                return;
+            FileTransfer t = std::move(it->second);
+            transfers_.erase(it);
+            if (t.handle != INVALID_FILE_HANDLE && open_files_.count(t.handle))
+                close_file(t.handle);
+            if (!result.is_ok())
+                echo::category("isobus.fs.client").warn("Transfer failed after ", t.bytes, " bytes");
+            if (t.done)
+                t.done(std::move(result));
+        }
+
+        // Requests that timed out are dropped, so a transfer waiting on them would never finish
+        void check_stalled_transfers() {
+            dp::Vector<u32> stalled;
+            for (const auto &[id, t] : transfers_) {
+                if (t.in_flight > 0 && current_time_ms_ - t.last_activity_ms > config_.request_timeout_ms)
+                    stalled.push_back(id);
+            }
+            for (u32 id : stalled)
+                finish_transfer(id, Result<u64>::err(Error::timeout("transfer stalled")));
+        }
+
+        void fail_transfers(const char *reason) {
+            while (!transfers_.empty()) {
+                u32 id = transfers_.begin()->first;
+                transfers_[id].handle = INVALID_FILE_HANDLE;
+                finish_transfer(id, Result<u64>::err(Error::invalid_state(reason)));
+            }
+        }
     };
 
 } // namespace agrobus::isobus::fs
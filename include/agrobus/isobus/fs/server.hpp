@@ -2,6 +2,7 @@
 
 #include "error_codes.hpp"
 #include "types.hpp"
+#include "volume.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/error.hpp>
 #include <agrobus/net/event.hpp>
@@ -9,7 +10,9 @@
 #include <agrobus/net/message.hpp>
 #include <agrobus/net/network_manager.hpp>
 #include <agrobus/net/state_machine.hpp>
+#include <algorithm>
 #include <datapod/datapod.hpp>
+#include <deque>
 #include <echo/echo.hpp>
 
 namespace agrobus::isobus::fs {
@@ -19,6 +22,30 @@ namespace agrobus::isobus::fs {
     // Enhanced File Server with full TAN support and idempotency (ISO 11783-13)
     // ═════════════════════════════════════════════════════════════════════════════
 
+    // ─── Per-client scheduling statistics ────────────────────────────────────────
+    struct FSClientStats {
+        u64 requests = 0;         // requests executed
+        u64 dropped = 0;          // arrived while the client's request queue was full
+        u64 duplicates = 0;       // retries of a TAN still waiting in the queue
+        u64 response_bytes = 0;   // bytes of all executed responses
+        u32 queued = 0;           // requests waiting now
+        u32 max_latency_ms = 0;   // worst wait from arrival to execution
+        u64 total_latency_ms = 0; // summed waits, for the mean
+        f32 bytes_per_s = 0.0f;   // response bytes over the last rate window
+
+        f64 mean_latency_ms() const noexcept {
+            return requests ? static_cast<f64>(total_latency_ms) / static_cast<f64>(requests) : 0.0;
+        }
+    };
+
+    // A request accepted from a client, waiting for the scheduler
+    struct QueuedRequest {
+        dp::Vector<u8> data;
+        u32 arrived_ms = 0;
+        u32 cost = 0; // estimated bus bytes, request and response together
+        u64 sequence = 0;
+    };
+
     // ─── Per-client connection state ─────────────────────────────────────────────
     struct ClientConnection {
         Address client_address;
@@ -26,8 +53,26 @@ namespace agrobus::isobus::fs {
         dp::String current_directory = "\\";
         dp::Vector<FileHandle> open_handles;
 
-        // TAN cache for idempotency (ISO 11783-13 Section 7.2.2)
-        dp::Map<TAN, TANResponse> tan_cache;
+        // TAN cache for idempotency (ISO 11783-13 Section 7.2.2). Clients count
+        // TANs up, so a ring indexed by TAN holds the most recent responses
+        dp::Vector<TANResponse> tan_ring;
+
+        // Responses to pipelined requests waiting for the client's TP session
+        std::deque<SharedPayload> tx_queue;
+
+        // Requests in arrival order, and the client's deficit round-robin credit
+        std::deque<QueuedRequest> rx_queue;
+        u32 deficit = 0;
+        u32 window_bytes = 0; // response bytes in the current rate window
+
+        FSClientStats stats;
+
+        TANResponse *cached_response(TAN tan) {
+            if (tan_ring.empty())
+                return nullptr;
+            auto &slot = tan_ring[tan % tan_ring.size()];
+            return slot.response_data && slot.tan == tan ? &slot : nullptr;
+        }
 
         bool is_connected(u32 current_time_ms, u32 timeout_ms) const {
             return (current_time_ms - last_ccm_timestamp_ms) <= timeout_ms;
@@ -41,20 +86,35 @@ namespace agrobus::isobus::fs {
         FileHandle handle = INVALID_FILE_HANDLE;
         Address owner = NULL_ADDRESS;
         dp::String path;
-        dp::Vector<u8> *data = nullptr; // Pointer to actual file data
+        std::shared_ptr<VolumeFile> file; // null for directory listings
         u32 position = 0;
         OpenFlags flags = OpenFlags::Read;
         bool is_directory = false;
     };
 
+    // ─── Request scheduling policy ───────────────────────────────────────────────
+    enum class FSSchedulePolicy : u8 {
+        Fifo,              // all clients' requests in arrival order
+        DeficitRoundRobin, // clients take turns, each earning the same bytes per round
+    };
+
     // ─── File Server Configuration ───────────────────────────────────────────────
     struct FileServerConfig {
         u32 status_broadcast_interval_ms = 2000;
         u32 busy_status_interval_ms = 200;
-        u32 ccm_timeout_ms = 6000;        // 6 seconds without CCM = disconnect
-        u32 tan_cache_timeout_ms = 10000; // TAN cache entry lifetime
+        u32 ccm_timeout_ms = 6000;              // 6 seconds without CCM = disconnect
+        u32 tan_cache_timeout_ms = 10000;       // TAN cache entry lifetime
+        u8 tan_cache_depth = 32;                // responses kept per client; older TANs are new requests again
+        u32 tan_cache_budget_bytes = 64 * 1024; // all clients together; oldest responses are evicted first
         u8 max_open_files_per_client = 8;
         u8 max_open_files_total = 32;
+        u8 max_queued_responses = 16; // per client; beyond this the client must retry
+        u8 max_pending_requests = 16; // per client; requests beyond this are dropped and retried
+        FSSchedulePolicy schedule = FSSchedulePolicy::DeficitRoundRobin;
+        u16 drr_quantum_bytes = 512;    // credit a waiting client earns per round
+        u32 bitrate = 250000;           // CAN bitrate (bit/s)
+        f32 response_bus_budget = 1.0f; // fraction of the bus responses may use
+        u32 bits_per_frame = 128;       // worst-case extended frame incl. stuffing
 
         FileServerConfig &status_interval(u32 ms) {
             status_broadcast_interval_ms = ms;
@@ -80,6 +140,81 @@ namespace agrobus::isobus::fs {
             max_open_files_total = n;
             return *this;
         }
+
+        FileServerConfig &response_queue(u8 n) {
+            max_queued_responses = n;
+            return *this;
+        }
+
+        FileServerConfig &tan_cache(u8 depth, u32 budget_bytes) {
+            tan_cache_depth = depth;
+            tan_cache_budget_bytes = budget_bytes;
+            return *this;
+        }
+
+        FileServerConfig &request_queue(u8 n) {
+            max_pending_requests = n;
+            return *this;
+        }
+
+        FileServerConfig &scheduling(FSSchedulePolicy policy, u16 quantum_bytes = 512) {
+            schedule = policy;
+            drr_quantum_bytes = quantum_bytes;
+            return *this;
+        }
+
+        FileServerConfig &response_budget(f32 fraction) {
+            response_bus_budget = fraction;
+            return *this;
+        }
+
+        FileServerConfig &bus_bitrate(u32 bits_per_s) {
+            bitrate = bits_per_s;
+            return *this;
+        }
+
+        // Response frames per second allowed by the budget
+        f64 response_frames_per_s() const noexcept {
+            return static_cast<f64>(bitrate) * static_cast<f64>(response_bus_budget) /
+                   static_cast<f64>(bits_per_frame);
+        }
+    };
+
+    // ─── Request scheduler metrics ───────────────────────────────────────────────
+    struct FSSchedulerStats {
+        u64 executed = 0;        // requests run by the scheduler
+        u64 deferred_budget = 0; // passes stopped with work left because the response budget ran out
+        u32 max_backlog = 0;     // most requests waiting across all clients
+    };
+
+    // ─── TAN cache statistics ────────────────────────────────────────────────────
+    struct TANCacheStats {
+        u32 hits = 0;     // retried requests answered from the cache
+        u32 stored = 0;   // responses cached
+        u32 replaced = 0; // entries overwritten by a newer TAN in the same slot
+        u32 evicted = 0;  // entries dropped for the memory budget
+        u32 expired = 0;  // entries removed by age
+        u32 entries = 0;  // entries currently cached
+        usize bytes = 0;  // response bytes currently referenced
+    };
+
+    // ─── Encoded directory listing ───────────────────────────────────────────────
+    // A directory's entries in wire format, built on the first directory read
+    // and served page by page until the directory changes
+    struct DirectoryListing {
+        dp::Vector<u8> encoded;
+        dp::Vector<u32> offsets;        // start of each entry, plus the end
+        dp::Map<dp::String, u32> index; // entry name -> position, for size updates
+
+        u32 count() const { return offsets.empty() ? 0 : static_cast<u32>(offsets.size() - 1); }
+    };
+
+    // ─── Directory listing statistics ────────────────────────────────────────────
+    struct ListingStats {
+        u32 builds = 0;        // listings encoded from the volume
+        u32 pages = 0;         // directory reads served from a listing
+        u32 invalidations = 0; // listings dropped after an entry was added, deleted or moved
+        u32 patches = 0;       // sizes updated in place after a write
     };
 
     // ─── Enhanced File Server ────────────────────────────────────────────────────
@@ -88,10 +223,8 @@ namespace agrobus::isobus::fs {
         InternalCF *cf_;
         FileServerConfig config_;
 
-        // File system state
-        dp::Map<dp::String, dp::Vector<u8>> files_;      // path -> data
-        dp::Map<dp::String, FileAttributes> file_attrs_; // path -> attributes
-        dp::Vector<dp::String> directories_;             // List of directories
+        // File system state (the volume outlives the open files)
+        std::unique_ptr<Volume> volume_;
         dp::Vector<OpenFile> open_files_;
         FileHandle next_handle_ = 1;
 
@@ -113,9 +246,26 @@ namespace agrobus::isobus::fs {
         // Properties
         FileServerProperties properties_;
 
+        TANCacheStats tan_stats_;
+
+        // Directory listings by directory path ("\\dir\\")
+        dp::Map<dp::String, DirectoryListing> listings_;
+        ListingStats listing_stats_;
+
+        // Request scheduler: arrival counter, round-robin position, response budget
+        u64 next_sequence_ = 0;
+        Address drr_cursor_ = 0;
+        bool drr_credited_ = false; // the client at the cursor already earned this round's quantum
+        f64 response_tokens_ = 0.0;
+        u32 rate_timer_ms_ = 0;
+        FSSchedulerStats scheduler_stats_;
+
       public:
-        FileServerEnhanced(IsoNet &net, InternalCF *cf, FileServerConfig config = {})
-            : net_(net), cf_(cf), config_(config) {
+        // Serves an in-memory volume unless a backend is given
+        FileServerEnhanced(IsoNet &net, InternalCF *cf, FileServerConfig config = {},
+                           std::unique_ptr<Volume> volume = nullptr)
+            : net_(net), cf_(cf), config_(config),
+              volume_(volume ? std::move(volume) : std::make_unique<MemoryVolume>()) {
 
             // Initialize properties
             properties_.version_number = 1;
@@ -125,9 +275,7 @@ namespace agrobus::isobus::fs {
             properties_.supports_file_attributes = true;
             properties_.supports_move_file = true;
             properties_.supports_delete_file = true;
-
-            // Initialize root directory
-            directories_.push_back("\\");
+            response_tokens_ = response_burst();
         }
 
         // ─── Initialization ──────────────────────────────────────────────────────
@@ -146,89 +294,53 @@ namespace agrobus::isobus::fs {
 
         // ─── File Management ─────────────────────────────────────────────────────
         Result<void> add_file(dp::String path, dp::Vector<u8> data, FileAttributes attrs = FileAttributes::None) {
-            files_[path] = std::move(data);
-            file_attrs_[path] = attrs;
-            echo::category("isobus.fs.server").debug("File added: ", path);
-            return {};
+            bool parent_existed = directory_exists(parent_directory(path));
+            auto result = volume_->add_file(path, std::move(data), attrs);
+            if (result.is_ok()) {
+                invalidate_listing(path, !parent_existed);
+                echo::category("isobus.fs.server").debug("File added: ", path);
+            }
+            return result;
         }
 
         Result<void> remove_file(const dp::String &path) {
-            if (files_.erase(path) > 0) {
-                file_attrs_.erase(path);
+            auto result = volume_->remove_file(path);
+            if (result.is_ok()) {
+                invalidate_listing(path, false);
                 echo::category("isobus.fs.server").debug("File removed: ", path);
-                return {};
             }
-            return Result<void>::err(Error::invalid_state("file not found"));
+            return result;
         }
 
+        Volume &volume() noexcept { return *volume_; }
+        const Volume &volume() const noexcept { return *volume_; }
+
         // ─── Directory Management ────────────────────────────────────────────────
         Result<void> add_directory(dp::String path) {
             if (!path.empty() && path.back() != '\\') {
                 path += '\\';
             }
-            directories_.push_back(path);
-            echo::category("isobus.fs.server").debug("Directory added: ", path);
-            return {};
-        }
-
-        bool directory_exists(const dp::String &path) const {
-            for (const auto &dir : directories_) {
-                if (dir == path)
-                    return true;
+            bool parent_existed = directory_exists(parent_directory(path));
+            auto result = volume_->add_directory(path);
+            if (result.is_ok()) {
+                invalidate_listing(path, !parent_existed);
+                echo::category("isobus.fs.server").debug("Directory added: ", path);
             }
-            return false;
+            return result;
         }
 
+        bool directory_exists(const dp::String &path) const { return volume_->directory_exists(path); }
+
         // List all files in a directory (supports wildcards)
         dp::Vector<FileEntry> list_directory(const dp::String &path, const dp::String &pattern = "*") {
-            dp::Vector<FileEntry> entries;
-
-            // List files
-            for (const auto &[file_path, data] : files_) {
-                // Check if file is in the specified directory
-                if (file_path.find(path) == 0) {
-                    // Extract filename from path
-                    auto filename = file_path.substr(path.size());
-
-                    // Check wildcard match
-                    if (pattern != "*" && !wildcard_match(filename, pattern)) {
-                        continue;
-                    }
-
-                    FileEntry entry;
-                    entry.name = filename;
-                    entry.size = data.size();
-                    entry.attributes = file_attrs_.count(file_path) ? file_attrs_.at(file_path) : FileAttributes::None;
-                    entry.date = pack_dos_date(2025, 1, 1);
-                    entry.time = pack_dos_time(12, 0, 0);
-                    entries.push_back(entry);
-                }
-            }
-
-            // List subdirectories
-            for (const auto &dir : directories_) {
-                if (dir == path)
-                    continue; // Skip self
-
-                if (dir.find(path) == 0 && dir.size() > path.size()) {
-                    auto subdir = dir.substr(path.size());
-
-                    // Only include immediate subdirectories
-                    auto next_slash = subdir.find('\\');
-                    if (next_slash != dp::String::npos && next_slash < subdir.size() - 1) {
-                        continue; // This is a nested subdirectory
-                    }
-
-                    FileEntry entry;
-                    entry.name = subdir;
-                    entry.size = 0;
-                    entry.attributes = FileAttributes::Directory;
-                    entry.date = pack_dos_date(2025, 1, 1);
-                    entry.time = pack_dos_time(12, 0, 0);
-                    entries.push_back(entry);
-                }
+            auto entries = volume_->list(path);
+            if (pattern != "*") {
+                entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                             [&](const FileEntry &e) {
+                                                 return !e.is_directory() && !wildcard_match(e.name, pattern);
+                                             }),
+                              entries.end());
             }
-
             return entries;
         }
 
@@ -292,6 +404,7 @@ namespace agrobus::isobus::fs {
 
         // Force volume to removed state
         Result<void> set_volume_removed() {
+            volume_->flush();
             volume_state_.transition(VolumeState::Removed);
             echo::category("isobus.fs.server").warn("Volume set to REMOVED state");
 
@@ -315,6 +428,7 @@ namespace agrobus::isobus::fs {
             }
 
             volume_state_.transition(VolumeState::Present);
+            listings_.clear(); // the media may have changed while it was out
             echo::category("isobus.fs.server").info("Volume reinserted, state: PRESENT");
 
             broadcast_volume_status();
@@ -328,10 +442,34 @@ namespace agrobus::isobus::fs {
 
         bool is_busy() const { return busy_; }
 
+        const TANCacheStats &tan_cache_stats() const noexcept { return tan_stats_; }
+        const ListingStats &listing_stats() const noexcept { return listing_stats_; }
+        const FSSchedulerStats &scheduler_stats() const noexcept { return scheduler_stats_; }
+
+        // Null for clients the server has not heard from
+        const FSClientStats *client_stats(Address client) const {
+            auto it = clients_.find(client);
+            return it != clients_.end() ? &it->second.stats : nullptr;
+        }
+
+        u32 pending_requests() const {
+            u32 n = 0;
+            for (const auto &[addr, conn] : clients_)
+                n += static_cast<u32>(conn.rx_queue.size());
+            return n;
+        }
+
         // ─── Update Loop ─────────────────────────────────────────────────────────
         void update(u32 elapsed_ms) {
             current_time_ms_ += elapsed_ms;
 
+            // Responses held back while an earlier one was still on the bus
+            flush_responses();
+
+            // Queued requests, as fairness and the response budget allow
+            run_scheduler(elapsed_ms);
+            update_rates(elapsed_ms);
+
             // Update volume state machine
             update_volume_state_machine(elapsed_ms);
 
@@ -381,27 +519,210 @@ namespace agrobus::isobus::fs {
             }
 
             // Check TAN cache for idempotency
-            if (client.tan_cache.count(tan) > 0) {
+            if (auto *cached = client.cached_response(tan)) {
                 // TAN match: resend cached response, don't re-execute
-                auto &cached = client.tan_cache[tan];
+                ++tan_stats_.hits;
                 echo::category("isobus.fs.server")
                     .debug("TAN cache hit for client ", msg.source, " TAN=", static_cast<u32>(tan));
-                send_response(msg.source, cached.response_data);
+                send_response(msg.source, cached->response_data);
                 return;
             }
 
-            // Execute function and cache response
-            auto response = execute_function(msg.source, function, tan, msg.data);
+            enqueue_request(client, msg.data);
+        }
 
-            // Cache the response for this TAN
-            TANResponse tan_response;
-            tan_response.tan = tan;
-            tan_response.response_data = response;
-            tan_response.timestamp_ms = current_time_ms_;
-            client.tan_cache[tan] = tan_response;
+        // ─── Request Scheduling ──────────────────────────────────────────────────
+        // Requests run from update() rather than the PGN callback, so one client
+        // streaming large reads cannot push every other client's small request
+        // behind its own, and responses leave no faster than the bus budget
+        void enqueue_request(ClientConnection &client, const dp::Vector<u8> &request) {
+            for (const auto &pending : client.rx_queue) {
+                if (pending.data[1] == request[1]) {
+                    ++client.stats.duplicates; // a retry, the original is still waiting
+                    return;
+                }
+            }
+            if (client.rx_queue.size() >= config_.max_pending_requests) {
+                ++client.stats.dropped;
+                echo::category("isobus.fs.server").warn("Request queue full for client ", client.client_address);
+                return;
+            }
+            client.rx_queue.push_back({request, current_time_ms_, request_cost(request), next_sequence_++});
+            client.stats.queued = static_cast<u32>(client.rx_queue.size());
+            scheduler_stats_.max_backlog = std::max(scheduler_stats_.max_backlog, pending_requests());
+        }
+
+        // Bus bytes a request will cost, known before it runs: reads are charged
+        // for the block they ask for, everything else for a single frame reply
+        static u32 request_cost(const dp::Vector<u8> &request) {
+            u32 response = CAN_DATA_LENGTH;
+            if (request[0] == static_cast<u8>(FSFunction::ReadFile) && request.size() >= FS_BLOCK_HEADER_SIZE)
+                response = std::min<u32>(FS_BLOCK_HEADER_SIZE + (request[3] | (request[4] << 8)), TP_MAX_DATA_LENGTH);
+            return static_cast<u32>(request.size()) + response;
+        }
+
+        // Frames a response occupies: one, or RTS, CTS, the data and EoMA
+        static u32 response_frames(usize bytes) {
+            return bytes <= CAN_DATA_LENGTH ? 1 : static_cast<u32>((bytes + 6) / 7) + 3;
+        }
+
+        f64 response_burst() const noexcept { return std::max(1.0, config_.response_frames_per_s() / 10.0); }
+
+        // A client still waiting for the transport to take its last response
+        // sits the round out; it gets no credit for time it could not use
+        static bool schedulable(const ClientConnection &conn) {
+            return !conn.rx_queue.empty() && conn.tx_queue.empty();
+        }
+
+        void run_scheduler(u32 elapsed_ms) {
+            response_tokens_ =
+                std::min(response_burst(), response_tokens_ + config_.response_frames_per_s() * elapsed_ms / 1000.0);
+            if (config_.schedule == FSSchedulePolicy::Fifo)
+                run_fifo();
+            else
+                run_deficit_round_robin();
+        }
+
+        void run_fifo() {
+            while (true) {
+                ClientConnection *next = nullptr;
+                for (auto &[addr, conn] : clients_)
+                    if (schedulable(conn) &&
+                        (!next || conn.rx_queue.front().sequence < next->rx_queue.front().sequence))
+                        next = &conn;
+                if (!next)
+                    return;
+                if (response_tokens_ < 1.0) {
+                    ++scheduler_stats_.deferred_budget;
+                    return;
+                }
+                dispatch(*next);
+            }
+        }
+
+        // Classic DRR: each waiting client earns a quantum of bytes per round and
+        // runs requests while its credit covers them. A client reading 1780-byte
+        // blocks waits a few rounds per request while one loading a small file is
+        // served every round, so both get the same share of the bus
+        void run_deficit_round_robin() {
+            dp::Vector<Address> order;
+            for (const auto &[addr, conn] : clients_)
+                if (!conn.rx_queue.empty())
+                    order.push_back(addr);
+            if (order.empty())
+                return;
+            std::sort(order.begin(), order.end());
+            std::rotate(order.begin(), std::lower_bound(order.begin(), order.end(), drr_cursor_), order.end());
+
+            u32 quantum = std::max<u32>(1, config_.drr_quantum_bytes);
+            bool progress = true;
+            while (progress) {
+                progress = false;
+                for (Address addr : order) {
+                    auto &conn = clients_[addr];
+                    if (!schedulable(conn))
+                        continue;
+                    if (!(drr_credited_ && drr_cursor_ == addr))
+                        conn.deficit += quantum;
+                    drr_cursor_ = addr;
+                    drr_credited_ = true;
+                    while (schedulable(conn) && conn.rx_queue.front().cost <= conn.deficit) {
+                        if (response_tokens_ < 1.0) {
+                            ++scheduler_stats_.deferred_budget;
+                            return;
+                        }
+                        conn.deficit -= conn.rx_queue.front().cost;
+                        dispatch(conn);
+                    }
+                    if (conn.rx_queue.empty())
+                        conn.deficit = 0;
+                    drr_cursor_ = static_cast<Address>(addr + 1);
+                    drr_credited_ = false;
+                    progress = true;
+                }
+            }
+        }
 
-            // Send response
-            send_response(msg.source, response);
+        // Executes the client's oldest request; the cache and the transport share the response
+        void dispatch(ClientConnection &conn) {
+            QueuedRequest request = std::move(conn.rx_queue.front());
+            conn.rx_queue.pop_front();
+            TAN tan = request.data[1];
+            auto response = std::make_shared<const dp::Vector<u8>>(
+                execute_function(conn.client_address, request.data[0], tan, request.data));
+
+            u32 waited = current_time_ms_ - request.arrived_ms;
+            auto &stats = conn.stats;
+            ++stats.requests;
+            stats.response_bytes += response->size();
+            conn.window_bytes += static_cast<u32>(response->size());
+            stats.queued = static_cast<u32>(conn.rx_queue.size());
+            stats.total_latency_ms += waited;
+            stats.max_latency_ms = std::max(stats.max_latency_ms, waited);
+            ++scheduler_stats_.executed;
+            response_tokens_ -= response_frames(response->size());
+
+            cache_response(conn, tan, response);
+            send_response(conn.client_address, std::move(response));
+        }
+
+        void update_rates(u32 elapsed_ms) {
+            rate_timer_ms_ += elapsed_ms;
+            if (rate_timer_ms_ < 1000)
+                return;
+            for (auto &[addr, conn] : clients_) {
+                conn.stats.bytes_per_s = static_cast<f32>(conn.window_bytes) * 1000.0f / rate_timer_ms_;
+                conn.window_bytes = 0;
+            }
+            rate_timer_ms_ = 0;
+        }
+
+        // ─── TAN Cache ───────────────────────────────────────────────────────────
+        // A client streaming blocks wraps its TANs within seconds, so only the
+        // most recent ones can still be retries
+        void cache_response(ClientConnection &client, TAN tan, const SharedPayload &response) {
+            if (config_.tan_cache_depth == 0)
+                return;
+            if (client.tan_ring.size() != config_.tan_cache_depth)
+                client.tan_ring.resize(config_.tan_cache_depth);
+
+            auto &slot = client.tan_ring[tan % client.tan_ring.size()];
+            if (slot.response_data) {
+                drop_cached(slot);
+                ++tan_stats_.replaced;
+            }
+            while (tan_stats_.bytes + response->size() > config_.tan_cache_budget_bytes && evict_oldest_cached())
+                ++tan_stats_.evicted;
+            if (tan_stats_.bytes + response->size() > config_.tan_cache_budget_bytes)
+                return;
+
+            slot.tan = tan;
+            slot.response_data = response;
+            slot.timestamp_ms = current_time_ms_;
+            tan_stats_.bytes += slot.bytes();
+            ++tan_stats_.entries;
+            ++tan_stats_.stored;
+        }
+
+        void drop_cached(TANResponse &slot) {
+            tan_stats_.bytes -= slot.bytes();
+            --tan_stats_.entries;
+            slot = TANResponse{};
+        }
+
+        bool evict_oldest_cached() {
+            TANResponse *oldest = nullptr;
+            for (auto &[addr, client] : clients_) {
+                for (auto &slot : client.tan_ring) {
+                    if (slot.response_data && (!oldest || current_time_ms_ - slot.timestamp_ms >
+                                                              current_time_ms_ - oldest->timestamp_ms))
+                        oldest = &slot;
+                }
+            }
+            if (!oldest)
+                return false;
+            drop_cached(*oldest);
+            return true;
         }
 
         // ─── CCM Handling ────────────────────────────────────────────────────────
@@ -450,6 +771,12 @@ namespace agrobus::isobus::fs {
             case FSFunction::ChangeDirectory:
                 return handle_change_directory(client, tan, request);
 
+            case FSFunction::DeleteFile:
+                return handle_delete_file(client, tan, request);
+
+            case FSFunction::MoveFile:
+                return handle_move_file(client, tan, request);
+
             default:
                 echo::category("isobus.fs.server").warn("Unsupported function: ", static_cast<u32>(function_code));
                 return encode_error_response(function_code, tan, FSError::NotSupported);
@@ -497,17 +824,25 @@ namespace agrobus::isobus::fs {
                 if (!directory_exists(dir_path)) {
                     return encode_error_response(static_cast<u8>(FSFunction::OpenFile), tan, FSError::NotFound);
                 }
-            } else {
-                // Check if file exists
-                if (files_.find(path) == files_.end()) {
-                    if (!has_flag(flags, OpenFlags::Create)) {
-                        return encode_error_response(static_cast<u8>(FSFunction::OpenFile), tan, FSError::NotFound);
-                    }
+                path = dir_path; // the handle's listing key
+            }
 
-                    // Create new file
-                    files_[path] = dp::Vector<u8>();
-                    file_attrs_[path] = FileAttributes::None;
+            std::shared_ptr<VolumeFile> file;
+            if (!is_dir_listing) {
+                bool create = has_flag(flags, OpenFlags::Create);
+                bool exists = volume_->file_exists(path);
+                if (!create && !exists) {
+                    return encode_error_response(static_cast<u8>(FSFunction::OpenFile), tan, FSError::NotFound);
+                }
+                bool parent_existed = exists || directory_exists(parent_directory(path));
+                bool writable = access_mode == OpenFlags::Write || access_mode == OpenFlags::ReadWrite;
+                auto opened = volume_->open(path, create, writable);
+                if (!opened.is_ok()) {
+                    return encode_error_response(static_cast<u8>(FSFunction::OpenFile), tan, FSError::AccessDenied);
                 }
+                file = std::move(opened.value());
+                if (!exists)
+                    invalidate_listing(path, !parent_existed);
             }
 
             // Allocate handle
@@ -521,7 +856,7 @@ namespace agrobus::isobus::fs {
             open_file.handle = handle;
             open_file.owner = client;
             open_file.path = path;
-            open_file.data = is_dir_listing ? nullptr : &files_[path];
+            open_file.file = std::move(file);
             open_file.position = 0;
             open_file.flags = flags;
             open_file.is_directory = is_dir_listing;
@@ -554,6 +889,9 @@ namespace agrobus::isobus::fs {
             // Find open file
             for (auto it = open_files_.begin(); it != open_files_.end(); ++it) {
                 if (it->handle == handle && it->owner == client) {
+                    // Written data must be on the volume before the close is confirmed
+                    bool flushed = !it->file || it->file->flush().is_ok();
+
                     // Remove from client's handle list
                     auto &conn = clients_[client];
                     conn.open_handles.erase(std::remove(conn.open_handles.begin(), conn.open_handles.end(), handle),
@@ -566,6 +904,10 @@ namespace agrobus::isobus::fs {
 
                     open_files_.erase(it);
 
+                    if (!flushed) {
+                        return encode_error_response(static_cast<u8>(FSFunction::CloseFile), tan, FSError::WriteFail);
+                    }
+
                     // Success response
                     dp::Vector<u8> response(8, 0xFF);
                     response[0] = static_cast<u8>(FSFunction::CloseFile);
@@ -580,41 +922,44 @@ namespace agrobus::isobus::fs {
 
         // ─── Read File ───────────────────────────────────────────────────────────
         dp::Vector<u8> handle_read_file(Address client, TAN tan, const dp::Vector<u8> &request) {
-            if (request.size() < 4) {
+            if (request.size() < FS_BLOCK_HEADER_SIZE) {
                 return encode_error_response(static_cast<u8>(FSFunction::ReadFile), tan, FSError::MalformedRequest);
             }
 
             FileHandle handle = request[2];
-            u8 count = request[3]; // Number of bytes to read
+            u16 count = static_cast<u16>(request[3] | (request[4] << 8)); // Number of bytes to read
 
             // Find open file
             for (auto &open_file : open_files_) {
                 if (open_file.handle == handle && open_file.owner == client) {
-                    if (open_file.data == nullptr) {
+                    if (open_file.is_directory) {
+                        return read_directory(open_file, tan, count);
+                    }
+                    if (!open_file.file) {
                         return encode_error_response(static_cast<u8>(FSFunction::ReadFile), tan,
                                                      FSError::InvalidHandle);
                     }
 
                     // Check EOF
-                    if (open_file.position >= open_file.data->size()) {
+                    if (open_file.position >= open_file.file->size()) {
                         return encode_error_response(static_cast<u8>(FSFunction::ReadFile), tan, FSError::EndOfFile);
                     }
 
-                    // Read data
-                    u32 available = open_file.data->size() - open_file.position;
-                    u32 to_read = std::min(static_cast<u32>(count), available);
-
+                    // Read straight into the response (TP or ETP for blocks over 3 bytes)
                     dp::Vector<u8> response;
-                    response.resize(4 + to_read);
+                    response.resize(FS_BLOCK_HEADER_SIZE + count);
+                    u8 *dst = response.data() + FS_BLOCK_HEADER_SIZE;
+                    auto read = open_file.file->read(open_file.position, dst, count);
+                    if (!read.is_ok()) {
+                        return encode_error_response(static_cast<u8>(FSFunction::ReadFile), tan, FSError::AccessDenied);
+                    }
+                    u32 to_read = static_cast<u32>(read.value());
+                    response.resize(FS_BLOCK_HEADER_SIZE + to_read);
                     response[0] = static_cast<u8>(FSFunction::ReadFile);
                     response[1] = tan;
                     response[2] = static_cast<u8>(FSError::Success);
-                    response[3] = static_cast<u8>(to_read);
-
-                    // Append data (may trigger TP if > 8 bytes total)
-                    for (u32 i = 0; i < to_read; ++i) {
-                        response[4 + i] = (*open_file.data)[open_file.position + i];
-                    }
+                    response[3] = static_cast<u8>(to_read & 0xFF);
+                    response[4] = static_cast<u8>(to_read >> 8);
 
                     open_file.position += to_read;
 
@@ -630,21 +975,21 @@ namespace agrobus::isobus::fs {
 
         // ─── Write File ──────────────────────────────────────────────────────────
         dp::Vector<u8> handle_write_file(Address client, TAN tan, const dp::Vector<u8> &request) {
-            if (request.size() < 4) {
+            if (request.size() < FS_BLOCK_HEADER_SIZE) {
                 return encode_error_response(static_cast<u8>(FSFunction::WriteFile), tan, FSError::MalformedRequest);
             }
 
             FileHandle handle = request[2];
-            u8 count = request[3];
+            u16 count = static_cast<u16>(request[3] | (request[4] << 8));
 
-            if (request.size() < 4 + count) {
+            if (request.size() < static_cast<usize>(FS_BLOCK_HEADER_SIZE) + count) {
                 return encode_error_response(static_cast<u8>(FSFunction::WriteFile), tan, FSError::MalformedRequest);
             }
 
             // Find open file
             for (auto &open_file : open_files_) {
                 if (open_file.handle == handle && open_file.owner == client) {
-                    if (open_file.data == nullptr) {
+                    if (!open_file.file) {
                         return encode_error_response(static_cast<u8>(FSFunction::WriteFile), tan,
                                                      FSError::InvalidHandle);
                     }
@@ -656,17 +1001,14 @@ namespace agrobus::isobus::fs {
                                                      FSError::InvalidAccess);
                     }
 
-                    // Write data
-                    auto &data = *open_file.data;
-                    if (open_file.position + count > data.size()) {
-                        data.resize(open_file.position + count);
-                    }
-
-                    for (u8 i = 0; i < count; ++i) {
-                        data[open_file.position + i] = request[4 + i];
+                    // Write data (queued on volumes with write-behind)
+                    const u8 *data = request.data() + FS_BLOCK_HEADER_SIZE;
+                    if (!open_file.file->write(open_file.position, data, count).is_ok()) {
+                        return encode_error_response(static_cast<u8>(FSFunction::WriteFile), tan, FSError::WriteFail);
                     }
 
                     open_file.position += count;
+                    patch_listing_size(open_file.path, open_file.file->size());
 
                     echo::category("isobus.fs.server")
                         .trace("Wrote ", static_cast<u32>(count), " bytes to handle ", static_cast<u32>(handle));
@@ -676,7 +1018,8 @@ namespace agrobus::isobus::fs {
                     response[0] = static_cast<u8>(FSFunction::WriteFile);
                     response[1] = tan;
                     response[2] = static_cast<u8>(FSError::Success);
-                    response[3] = count; // Bytes written
+                    response[3] = static_cast<u8>(count & 0xFF); // Bytes written
+                    response[4] = static_cast<u8>(count >> 8);
                     return response;
                 }
             }
@@ -684,6 +1027,99 @@ namespace agrobus::isobus::fs {
             return encode_error_response(static_cast<u8>(FSFunction::WriteFile), tan, FSError::InvalidHandle);
         }
 
+        // ─── Read Directory ──────────────────────────────────────────────────────
+        // ReadFile on a directory handle: count is the most entries wanted and
+        // the position an entry index. A page ends early rather than outgrow one
+        // TP session, so a large directory is listed in several reads.
+        dp::Vector<u8> read_directory(OpenFile &open_file, TAN tan, u16 count) {
+            const auto &listing = directory_listing(open_file.path);
+            if (open_file.position >= listing.count()) {
+                return encode_error_response(static_cast<u8>(FSFunction::ReadFile), tan, FSError::EndOfFile);
+            }
+
+            u32 first = open_file.position;
+            u32 last = first;
+            while (last < listing.count() && last - first < count &&
+                   FS_BLOCK_HEADER_SIZE + listing.offsets[last + 1] - listing.offsets[first] <= TP_MAX_DATA_LENGTH)
+                ++last;
+
+            dp::Vector<u8> response;
+            response.reserve(FS_BLOCK_HEADER_SIZE + listing.offsets[last] - listing.offsets[first]);
+            response.push_back(static_cast<u8>(FSFunction::ReadFile));
+            response.push_back(tan);
+            response.push_back(static_cast<u8>(FSError::Success));
+            response.push_back(static_cast<u8>((last - first) & 0xFF));
+            response.push_back(static_cast<u8>((last - first) >> 8));
+            response.insert(response.end(), listing.encoded.begin() + listing.offsets[first],
+                            listing.encoded.begin() + listing.offsets[last]);
+
+            open_file.position = last;
+            ++listing_stats_.pages;
+            return response;
+        }
+
+        // ─── Delete File ─────────────────────────────────────────────────────────
+        // [fn, TAN, path length, path]
+        dp::Vector<u8> handle_delete_file(Address client, TAN tan, const dp::Vector<u8> &request) {
+            if (request.size() < 3 || request.size() < 3u + request[2]) {
+                return encode_error_response(static_cast<u8>(FSFunction::DeleteFile), tan, FSError::MalformedRequest);
+            }
+            dp::String path(reinterpret_cast<const char *>(request.data() + 3), request[2]);
+
+            if (is_open(path)) {
+                return encode_error_response(static_cast<u8>(FSFunction::DeleteFile), tan, FSError::AccessDenied);
+            }
+            if (!volume_->file_exists(path)) {
+                return encode_error_response(static_cast<u8>(FSFunction::DeleteFile), tan, FSError::NotFound);
+            }
+            if (!remove_file(path).is_ok()) {
+                return encode_error_response(static_cast<u8>(FSFunction::DeleteFile), tan, FSError::AccessDenied);
+            }
+
+            dp::Vector<u8> response(8, 0xFF);
+            response[0] = static_cast<u8>(FSFunction::DeleteFile);
+            response[1] = tan;
+            response[2] = static_cast<u8>(FSError::Success);
+            return response;
+        }
+
+        // ─── Move File ───────────────────────────────────────────────────────────
+        // [fn, TAN, source length, destination length, source, destination]
+        dp::Vector<u8> handle_move_file(Address client, TAN tan, const dp::Vector<u8> &request) {
+            if (request.size() < 4 || request.size() < 4u + request[2] + request[3]) {
+                return encode_error_response(static_cast<u8>(FSFunction::MoveFile), tan, FSError::MalformedRequest);
+            }
+            dp::String from(reinterpret_cast<const char *>(request.data() + 4), request[2]);
+            dp::String to(reinterpret_cast<const char *>(request.data() + 4 + request[2]), request[3]);
+
+            if (!volume_->file_exists(from)) {
+                return encode_error_response(static_cast<u8>(FSFunction::MoveFile), tan, FSError::InvalidSourceName);
+            }
+            if (to.empty() || to.back() == '\\' || volume_->file_exists(to) || directory_exists(to + '\\')) {
+                return encode_error_response(static_cast<u8>(FSFunction::MoveFile), tan, FSError::InvalidDestName);
+            }
+            bool parent_existed = directory_exists(parent_directory(to));
+            if (!volume_->move_file(from, to).is_ok()) {
+                return encode_error_response(static_cast<u8>(FSFunction::MoveFile), tan, FSError::AccessDenied);
+            }
+            invalidate_listing(from, false);
+            invalidate_listing(to, !parent_existed);
+
+            // Handles on the file keep working under the new name
+            for (auto &open_file : open_files_) {
+                if (!open_file.is_directory && open_file.path == from)
+                    open_file.path = to;
+            }
+
+            echo::category("isobus.fs.server").debug("File moved: ", from, " -> ", to);
+
+            dp::Vector<u8> response(8, 0xFF);
+            response[0] = static_cast<u8>(FSFunction::MoveFile);
+            response[1] = tan;
+            response[2] = static_cast<u8>(FSError::Success);
+            return response;
+        }
+
         // ─── Seek File ───────────────────────────────────────────────────────────
         dp::Vector<u8> handle_seek_file(Address client, TAN tan, const dp::Vector<u8> &request) {
             if (request.size() < 7) {
@@ -697,12 +1133,12 @@ namespace agrobus::isobus::fs {
             // Find open file
             for (auto &open_file : open_files_) {
                 if (open_file.handle == handle && open_file.owner == client) {
-                    if (open_file.data == nullptr) {
+                    if (!open_file.file && !open_file.is_directory) {
                         return encode_error_response(static_cast<u8>(FSFunction::SeekFile), tan,
                                                      FSError::InvalidHandle);
                     }
 
-                    open_file.position = position;
+                    open_file.position = position; // entry index on directory handles
 
                     echo::category("isobus.fs.server")
                         .trace("Seek handle ", static_cast<u32>(handle), " to position ", position);
@@ -739,7 +1175,7 @@ namespace agrobus::isobus::fs {
         // ─── Get Status ──────────────────────────────────────────────────────────
         dp::Vector<u8> handle_get_status(Address client, TAN tan) {
             FileServerStatus status;
-            status.busy = busy_;
+            status.busy = busy_ || pending_requests() > 0;
             status.number_of_open_files = static_cast<u8>(open_files_.size());
 
             auto status_data = status.encode();
@@ -894,17 +1330,49 @@ namespace agrobus::isobus::fs {
             return response;
         }
 
-        void send_response(Address client, const dp::Vector<u8> &data) {
-            // TODO: Look up client ControlFunction from address
-            net_.send(PGN_FILE_SERVER_TO_CLIENT, data, cf_);
+        // Only one TP session per client can be open, so with several requests
+        // in flight later multi-frame responses queue behind the active one
+        void send_response(Address client, SharedPayload data) {
+            auto &conn = clients_[client];
+            if (conn.tx_queue.empty() && transmit(client, data))
+                return;
+            if (conn.tx_queue.size() >= config_.max_queued_responses) {
+                echo::category("isobus.fs.server").warn("Response queue full for client ", client);
+                return;
+            }
+            conn.tx_queue.push_back(std::move(data));
+        }
+
+        // False only while the transport session to the client is busy
+        bool transmit(Address client, const SharedPayload &data) {
+            if (data->size() > CAN_DATA_LENGTH &&
+                net_.transport_busy(PGN_FILE_SERVER_TO_CLIENT, cf_->address(), client))
+                return false;
+            ControlFunction dest;
+            dest.address = client;
+            net_.send(PGN_FILE_SERVER_TO_CLIENT, data, cf_, &dest);
+            return true;
+        }
+
+        void flush_responses() {
+            for (auto &[addr, conn] : clients_) {
+                while (!conn.tx_queue.empty() && transmit(addr, conn.tx_queue.front()))
+                    conn.tx_queue.pop_front();
+            }
         }
 
         void broadcast_status() {
             FileServerStatus status;
-            status.busy = busy_;
+            status.busy = busy_ || pending_requests() > 0;
             status.number_of_open_files = static_cast<u8>(open_files_.size());
 
-            auto data = status.encode();
+            // Same layout as the GetStatus response, with TAN 0xFF so no pending request matches it
+            auto status_data = status.encode();
+            dp::Vector<u8> data(8, 0xFF);
+            data[0] = static_cast<u8>(FSFunction::FileServerStatus);
+            data[2] = static_cast<u8>(FSError::Success);
+            for (usize i = 0; i + 3 < data.size(); ++i)
+                data[3 + i] = status_data[i];
             net_.send(PGN_FILE_SERVER_TO_CLIENT, data, cf_);
 
             echo::category("isobus.fs.server").trace("Status broadcast: busy=", busy_);
@@ -935,14 +1403,84 @@ namespace agrobus::isobus::fs {
             return INVALID_FILE_HANDLE;
         }
 
+        // ─── Directory Listings ──────────────────────────────────────────────────
+        // "\\A\\B.TXT" -> "\\A\\", "\\A\\B\\" -> "\\A\\"
+        static dp::String parent_directory(const dp::String &path) {
+            if (path.size() < 2)
+                return "\\";
+            auto slash = path.rfind('\\', path.size() - 2);
+            return slash == dp::String::npos ? dp::String("\\") : path.substr(0, slash + 1);
+        }
+
+        bool is_open(const dp::String &path) const {
+            for (const auto &f : open_files_)
+                if (!f.is_directory && f.path == path)
+                    return true;
+            return false;
+        }
+
+        // Entries are sorted by name, so pages stay stable whatever order the
+        // volume enumerates them in
+        const DirectoryListing &directory_listing(const dp::String &directory) {
+            auto it = listings_.find(directory);
+            if (it != listings_.end())
+                return it->second;
+
+            auto entries = volume_->list(directory);
+            std::sort(entries.begin(), entries.end(),
+                      [](const FileEntry &a, const FileEntry &b) { return a.name < b.name; });
+
+            DirectoryListing listing;
+            usize bytes = 0;
+            for (const auto &e : entries)
+                bytes += e.encoded_size();
+            listing.encoded.reserve(bytes);
+            listing.offsets.reserve(entries.size() + 1);
+            for (const auto &e : entries) {
+                listing.index[e.name] = static_cast<u32>(listing.offsets.size());
+                listing.offsets.push_back(static_cast<u32>(listing.encoded.size()));
+                e.encode(listing.encoded);
+            }
+            listing.offsets.push_back(static_cast<u32>(listing.encoded.size()));
+            ++listing_stats_.builds;
+            return listings_[directory] = std::move(listing);
+        }
+
+        // An entry of path's directory appeared, disappeared or was renamed.
+        // New intermediate directories also change the ancestors' listings.
+        void invalidate_listing(const dp::String &path, bool with_ancestors) {
+            dp::String dir = parent_directory(path);
+            while (true) {
+                listing_stats_.invalidations += static_cast<u32>(listings_.erase(dir));
+                if (!with_ancestors || dir == "\\")
+                    break;
+                dir = parent_directory(dir);
+            }
+        }
+
+        // A write changed only the file's size: patch it in the cached record
+        void patch_listing_size(const dp::String &path, u64 size) {
+            auto it = listings_.find(parent_directory(path));
+            if (it == listings_.end())
+                return;
+            auto &listing = it->second;
+            auto entry = listing.index.find(path.substr(path.rfind('\\') + 1));
+            if (entry == listing.index.end())
+                return;
+            u32 start = listing.offsets[entry->second];
+            u8 *p = listing.encoded.data() + start + FileEntry::size_offset(listing.encoded[start]);
+            u32 value = static_cast<u32>(std::min<u64>(size, 0xFFFFFFFFu));
+            for (u8 i = 0; i < 4; ++i)
+                p[i] = static_cast<u8>(value >> (8 * i));
+            ++listing_stats_.patches;
+        }
+
         void cleanup_expired_tan_cache() {
             for (auto &[addr, client] : clients_) {
-                for (auto it = client.tan_cache.begin(); it != client.tan_cache.end();) {
-                    if (it->second.is_expired(current_time_ms_, config_.tan_cache_timeout_ms)) {
-                        client.tan_cache.erase(it->first);
-                        it = client.tan_cache.begin(); // Restart iteration
-                    } else {
-                        ++it;
+                for (auto &slot : client.tan_ring) {
+                    if (slot.response_data && slot.is_expired(current_time_ms_, config_.tan_cache_timeout_ms)) {
+                        drop_cached(slot);
+                        ++tan_stats_.expired;
                     }
                 }
             }
@@ -972,6 +1510,9 @@ namespace agrobus::isobus::fs {
             for (Address addr : to_remove) {
                 echo::category("isobus.fs.server").info("Client disconnected: ", addr);
                 on_client_disconnected.emit(addr);
+                for (auto &slot : clients_[addr].tan_ring)
+                    if (slot.response_data)
+                        drop_cached(slot);
                 clients_.erase(addr);
             }
         }
@@ -1016,6 +1557,7 @@ namespace agrobus::isobus::fs {
                     }
 
                     // Force close any remaining files
+                    volume_->flush();
                     if (!open_files_.empty()) {
                         echo::category("isobus.fs.server")
                             .warn("Force-closing ", open_files_.size(), " remaining files");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "error_codes.hpp"
+#include <agrobus/net/constants.hpp>
 #include <agrobus/net/types.hpp>
 #include <datapod/datapod.hpp>
 
@@ -26,6 +27,13 @@ namespace agrobus::isobus::fs {
     inline constexpr FileHandle INVALID_FILE_HANDLE = 0xFF;
     inline constexpr FileHandle RESERVED_FILE_HANDLE_0 = 0x00;
 
+    // ─── Read/Write blocks ───────────────────────────────────────────────────────
+    // ReadFile and WriteFile carry a 16-bit count after a 5-byte header
+    // (function, TAN, handle/error, count LSB, count MSB). A FS_TP_BLOCK_SIZE
+    // block is the largest that still fits one TP session; larger ones use ETP.
+    inline constexpr u16 FS_BLOCK_HEADER_SIZE = 5;
+    inline constexpr u16 FS_TP_BLOCK_SIZE = static_cast<u16>(TP_MAX_DATA_LENGTH - FS_BLOCK_HEADER_SIZE);
+
     // ─── Function Codes (ISO 11783-13 Section 7) ────────────────────────────────
     enum class FSFunction : u8 {
         // Directory operations
@@ -124,14 +132,52 @@ namespace agrobus::isobus::fs {
         bool is_directory() const { return has_attribute(attributes, FileAttributes::Directory); }
 
         bool is_read_only() const { return has_attribute(attributes, FileAttributes::ReadOnly); }
+
+        // Directory read record: name length, name, attributes, date, time, size
+        usize encoded_size() const { return std::min<usize>(name.size(), 255) + 10; }
+        static usize size_offset(usize name_length) { return name_length + 6; } // within the record
+
+        void encode(dp::Vector<u8> &out) const {
+            usize len = std::min<usize>(name.size(), 255);
+            out.push_back(static_cast<u8>(len));
+            out.insert(out.end(), name.begin(), name.begin() + static_cast<isize>(len));
+            out.push_back(static_cast<u8>(attributes));
+            out.push_back(static_cast<u8>(date & 0xFF));
+            out.push_back(static_cast<u8>(date >> 8));
+            out.push_back(static_cast<u8>(time & 0xFF));
+            out.push_back(static_cast<u8>(time >> 8));
+            for (u8 i = 0; i < 4; ++i)
+                out.push_back(static_cast<u8>(size >> (8 * i)));
+        }
+
+        // Decodes one record at data; consumed is 0 if it is truncated
+        static FileEntry decode(const u8 *data, usize available, usize &consumed) {
+            FileEntry entry;
+            consumed = 0;
+            if (available < 1 || available < static_cast<usize>(data[0]) + 10)
+                return entry;
+            usize len = data[0];
+            entry.name.assign(reinterpret_cast<const char *>(data + 1), len);
+            const u8 *p = data + 1 + len;
+            entry.attributes = static_cast<FileAttributes>(p[0]);
+            entry.date = static_cast<u16>(p[1] | (p[2] << 8));
+            entry.time = static_cast<u16>(p[3] | (p[4] << 8));
+            entry.size = static_cast<u32>(p[5]) | (static_cast<u32>(p[6]) << 8) | (static_cast<u32>(p[7]) << 16) |
+                         (static_cast<u32>(p[8]) << 24);
+            consumed = len + 10;
+            return entry;
+        }
     };
 
     // ─── TAN Cache Entry (for idempotency) ──────────────────────────────────────
+    // The response buffer is shared with the transport session sending it
     struct TANResponse {
         TAN tan = INVALID_TAN;
-        dp::Vector<u8> response_data;
+        SharedPayload response_data;
         u32 timestamp_ms = 0;
 
+        usize bytes() const { return response_data ? response_data->size() : 0; }
+
         bool is_expired(u32 current_time_ms, u32 timeout_ms) const {
             return (current_time_ms - timestamp_ms) > timeout_ms;
         }
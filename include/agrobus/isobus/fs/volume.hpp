@@ -0,0 +1,667 @@
+#pragma once
+
+#include "types.hpp"
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/mapped_file.hpp>
+#include <cerrno>
+#include <condition_variable>
+#include <ctime>
+#include <datapod/datapod.hpp>
+#include <deque>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+namespace agrobus::isobus::fs {
+    using namespace agrobus::net;
+
+    // ═════════════════════════════════════════════════════════════════════════════
+    // File server volume backends
+    // ═════════════════════════════════════════════════════════════════════════════
+    // FileServerEnhanced reaches its files through a Volume. Paths are the ISO
+    // 11783-13 paths clients send ("\\dir\\file"); directories end in '\\'.
+
+    // ─── Open file on a volume ───────────────────────────────────────────────────
+    class VolumeFile {
+      public:
+        virtual ~VolumeFile() = default;
+
+        virtual u64 size() const = 0;
+
+        // Copies up to count bytes at offset into dst; returns 0 at end of file
+        virtual Result<usize> read(u64 offset, u8 *dst, usize count) = 0;
+        virtual Result<void> write(u64 offset, const u8 *src, usize count) = 0;
+
+        // Complete writes still in flight; reports a deferred write error
+        virtual Result<void> flush() { return {}; }
+    };
+
+    // ─── Volume interface ────────────────────────────────────────────────────────
+    class Volume {
+      public:
+        virtual ~Volume() = default;
+
+        virtual bool file_exists(const dp::String &path) const = 0;
+        virtual bool directory_exists(const dp::String &path) const = 0;
+
+        virtual Result<std::shared_ptr<VolumeFile>> open(const dp::String &path, bool create, bool writable) = 0;
+
+        virtual Result<void> add_file(const dp::String &path, dp::Vector<u8> data, FileAttributes attrs) = 0;
+        virtual Result<void> remove_file(const dp::String &path) = 0;
+        virtual Result<void> move_file(const dp::String &from, const dp::String &to) = 0;
+        virtual Result<void> add_directory(const dp::String &path) = 0;
+
+        // Entries below a directory path; directory names end in '\\'
+        virtual dp::Vector<FileEntry> list(const dp::String &directory) const = 0;
+
+        // Complete all writes in flight (volume removal, shutdown)
+        virtual Result<void> flush() { return {}; }
+    };
+
+    // ─── In-memory volume ────────────────────────────────────────────────────────
+    // The whole volume lives in RAM. Used by tests, demos and small generated
+    // volumes; open files share the data with the volume. Files sit in a
+    // directory tree, so a listing costs the size of the directory, not of
+    // the volume.
+    class MemoryVolume : public Volume {
+        class File : public VolumeFile {
+            std::shared_ptr<dp::Vector<u8>> data_;
+
+          public:
+            explicit File(std::shared_ptr<dp::Vector<u8>> data) : data_(std::move(data)) {}
+
+            u64 size() const override { return data_->size(); }
+
+            Result<usize> read(u64 offset, u8 *dst, usize count) override {
+                if (offset >= data_->size())
+                    return Result<usize>::ok(0);
+                usize n = std::min<usize>(count, data_->size() - offset);
+                std::copy_n(data_->data() + offset, n, dst);
+                return Result<usize>::ok(n);
+            }
+
+            Result<void> write(u64 offset, const u8 *src, usize count) override {
+                if (offset + count > data_->size())
+                    data_->resize(offset + count);
+                std::copy_n(src, count, data_->data() + offset);
+                return {};
+            }
+        };
+
+        struct FileNode {
+            std::shared_ptr<dp::Vector<u8>> data;
+            FileAttributes attrs = FileAttributes::None;
+        };
+
+        // One directory with its children indexed by name, so lookups walk the
+        // path and listings touch only the directory itself
+        struct DirNode {
+            dp::Map<dp::String, std::shared_ptr<DirNode>> dirs;
+            dp::Map<dp::String, FileNode> files;
+        };
+
+        DirNode root_;
+
+        // Path components; leading, trailing and doubled '\\' are ignored
+        static dp::Vector<dp::String> split(const dp::String &path) {
+            dp::Vector<dp::String> parts;
+            usize start = 0;
+            while (start <= path.size()) {
+                usize end = path.find('\\', start);
+                if (end == dp::String::npos)
+                    end = path.size();
+                if (end > start)
+                    parts.push_back(path.substr(start, end - start));
+                start = end + 1;
+            }
+            return parts;
+        }
+
+        const DirNode *find_dir(const dp::Vector<dp::String> &parts, usize count) const {
+            const DirNode *dir = &root_;
+            for (usize i = 0; i < count && dir; ++i) {
+                auto it = dir->dirs.find(parts[i]);
+                dir = it != dir->dirs.end() ? it->second.get() : nullptr;
+            }
+            return dir;
+        }
+
+        DirNode *find_dir(const dp::Vector<dp::String> &parts, usize count) {
+            return const_cast<DirNode *>(std::as_const(*this).find_dir(parts, count));
+        }
+
+        DirNode *make_dir(const dp::Vector<dp::String> &parts, usize count) {
+            DirNode *dir = &root_;
+            for (usize i = 0; i < count; ++i) {
+                auto &child = dir->dirs[parts[i]];
+                if (!child)
+                    child = std::make_shared<DirNode>();
+                dir = child.get();
+            }
+            return dir;
+        }
+
+        const FileNode *find_file(const dp::String &path) const {
+            auto parts = split(path);
+            if (parts.empty())
+                return nullptr;
+            const DirNode *dir = find_dir(parts, parts.size() - 1);
+            if (!dir)
+                return nullptr;
+            auto it = dir->files.find(parts.back());
+            return it != dir->files.end() ? &it->second : nullptr;
+        }
+
+        // Parent directory and name of a file path, creating missing directories
+        std::pair<DirNode *, dp::String> place_file(const dp::String &path) {
+            auto parts = split(path);
+            if (parts.empty())
+                return {nullptr, {}};
+            return {make_dir(parts, parts.size() - 1), parts.back()};
+        }
+
+        static FileEntry make_entry(dp::String name, u32 size, FileAttributes attrs) {
+            FileEntry entry;
+            entry.name = std::move(name);
+            entry.size = size;
+            entry.attributes = attrs;
+            entry.date = pack_dos_date(2025, 1, 1);
+            entry.time = pack_dos_time(12, 0, 0);
+            return entry;
+        }
+
+      public:
+        bool file_exists(const dp::String &path) const override { return find_file(path) != nullptr; }
+
+        bool directory_exists(const dp::String &path) const override {
+            auto parts = split(path);
+            return find_dir(parts, parts.size()) != nullptr;
+        }
+
+        Result<std::shared_ptr<VolumeFile>> open(const dp::String &path, bool create, bool) override {
+            using R = Result<std::shared_ptr<VolumeFile>>;
+            if (const FileNode *node = find_file(path))
+                return R::ok(std::make_shared<File>(node->data));
+            if (!create)
+                return R::err(Error::invalid_state("file not found"));
+            auto [dir, name] = place_file(path);
+            if (!dir)
+                return R::err(Error::invalid_data("invalid path"));
+            auto &node = dir->files[name];
+            node.data = std::make_shared<dp::Vector<u8>>();
+            return R::ok(std::make_shared<File>(node.data));
+        }
+
+        Result<void> add_file(const dp::String &path, dp::Vector<u8> data, FileAttributes attrs) override {
+            auto [dir, name] = place_file(path);
+            if (!dir)
+                return Result<void>::err(Error::invalid_data("invalid path"));
+            dir->files[name] = FileNode{std::make_shared<dp::Vector<u8>>(std::move(data)), attrs};
+            return {};
+        }
+
+        Result<void> remove_file(const dp::String &path) override {
+            auto parts = split(path);
+            DirNode *dir = parts.empty() ? nullptr : find_dir(parts, parts.size() - 1);
+            if (!dir || dir->files.erase(parts.back()) == 0)
+                return Result<void>::err(Error::invalid_state("file not found"));
+            return {};
+        }
+
+        Result<void> move_file(const dp::String &from, const dp::String &to) override {
+            auto parts = split(from);
+            DirNode *src = parts.empty() ? nullptr : find_dir(parts, parts.size() - 1);
+            if (!src || src->files.count(parts.back()) == 0)
+                return Result<void>::err(Error::invalid_state("file not found"));
+            if (file_exists(to))
+                return Result<void>::err(Error::invalid_state("target exists"));
+            auto [dst, name] = place_file(to);
+            if (!dst)
+                return Result<void>::err(Error::invalid_data("invalid path"));
+            FileNode node = std::move(src->files[parts.back()]);
+            src->files.erase(parts.back());
+            dst->files[name] = std::move(node);
+            return {};
+        }
+
+        Result<void> add_directory(const dp::String &path) override {
+            auto parts = split(path);
+            make_dir(parts, parts.size());
+            return {};
+        }
+
+        dp::Vector<FileEntry> list(const dp::String &directory) const override {
+            dp::Vector<FileEntry> entries;
+            auto parts = split(directory);
+            const DirNode *dir = find_dir(parts, parts.size());
+            if (!dir)
+                return entries;
+            entries.reserve(dir->files.size() + dir->dirs.size());
+            for (const auto &[name, node] : dir->files)
+                entries.push_back(make_entry(name, static_cast<u32>(node.data->size()), node.attrs));
+            for (const auto &[name, node] : dir->dirs)
+                entries.push_back(make_entry(name + '\\', 0, FileAttributes::Directory));
+            return entries;
+        }
+    };
+
+    // ─── Directory volume configuration ─────────────────────────────────────────
+    struct DirectoryVolumeConfig {
+        usize mmap_threshold = 1u << 20;        // read-only files at least this large are mapped
+        usize resident_window = 4u << 20;       // mapped bytes kept resident behind the last read
+        usize write_behind_bytes = 8u << 20;    // queued write data before write() blocks
+        usize write_coalesce_bytes = 64u << 10; // contiguous writes merged into one pwrite up to this size
+        bool sync_on_flush = false;             // fsync written files when they are flushed or closed
+
+        DirectoryVolumeConfig &mmap_from(usize bytes) {
+            mmap_threshold = bytes;
+            return *this;
+        }
+        DirectoryVolumeConfig &resident(usize bytes) {
+            resident_window = bytes;
+            return *this;
+        }
+        DirectoryVolumeConfig &write_behind(usize bytes) {
+            write_behind_bytes = bytes;
+            return *this;
+        }
+        DirectoryVolumeConfig &sync(bool enable) {
+            sync_on_flush = enable;
+            return *this;
+        }
+    };
+
+    namespace detail {
+
+        // File descriptor shared by an open file and its queued writes
+        struct WriteTarget {
+            int fd = -1;
+            usize pending = 0; // queued jobs, guarded by the WriteBehind mutex
+            int error = 0;     // first failed pwrite (errno), guarded by the WriteBehind mutex
+
+            ~WriteTarget() {
+                if (fd >= 0)
+                    ::close(fd);
+            }
+        };
+
+        // ─── Write-behind I/O thread ─────────────────────────────────────────────
+        // write() returns once the data is queued; a single I/O thread issues the
+        // pwrite calls. Contiguous writes to the same file are merged, so a client
+        // writing 255-byte blocks costs one syscall per write_coalesce_bytes. The
+        // queue is bounded: producers wait when write_behind_bytes are in flight.
+        class WriteBehind {
+            struct Job {
+                std::shared_ptr<WriteTarget> target;
+                u64 offset = 0;
+                dp::Vector<u8> data;
+            };
+
+            usize limit_;
+            usize coalesce_;
+            std::mutex mutex_;
+            std::condition_variable work_cv_;
+            std::condition_variable done_cv_;
+            std::deque<Job> queue_;
+            usize queued_bytes_ = 0;
+            bool stop_ = false;
+            std::thread thread_;
+
+          public:
+            WriteBehind(usize limit, usize coalesce) : limit_(limit), coalesce_(coalesce) {}
+            ~WriteBehind() {
+                if (!thread_.joinable())
+                    return;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stop_ = true;
+                }
+                work_cv_.notify_all();
+                thread_.join();
+            }
+
+            WriteBehind(const WriteBehind &) = delete;
+            WriteBehind &operator=(const WriteBehind &) = delete;
+
+            void submit(const std::shared_ptr<WriteTarget> &target, u64 offset, const u8 *src, usize count) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (!thread_.joinable())
+                    thread_ = std::thread([this] { run(); });
+                done_cv_.wait(lock, [this] { return queued_bytes_ < limit_; });
+
+                // Not yet picked up by the I/O thread, so it can still grow
+                if (!queue_.empty()) {
+                    auto &last = queue_.back();
+                    if (last.target == target && last.offset + last.data.size() == offset &&
+                        last.data.size() + count <= coalesce_) {
+                        last.data.insert(last.data.end(), src, src + count);
+                        queued_bytes_ += count;
+                        return;
+                    }
+                }
+                queue_.push_back({target, offset, dp::Vector<u8>(src, src + count)});
+                queued_bytes_ += count;
+                ++target->pending;
+                lock.unlock();
+                work_cv_.notify_one();
+            }
+
+            // Wait until every queued write of this target is on disk (or failed)
+            int drain(WriteTarget &target) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_cv_.wait(lock, [&] { return target.pending == 0; });
+                return target.error;
+            }
+
+            // First deferred write error of this target without waiting for the queue
+            int error(const WriteTarget &target) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return target.error;
+            }
+
+            void drain_all() {
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_cv_.wait(lock, [this] { return queued_bytes_ == 0; });
+            }
+
+            usize queued_bytes() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return queued_bytes_;
+            }
+
+          private:
+            void run() {
+                for (;;) {
+                    Job job;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        work_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                        if (queue_.empty())
+                            return;
+                        job = std::move(queue_.front());
+                        queue_.pop_front();
+                    }
+
+                    int error = 0;
+                    usize done = 0;
+                    while (done < job.data.size()) {
+                        ssize_t n = ::pwrite(job.target->fd, job.data.data() + done, job.data.size() - done,
+                                             static_cast<off_t>(job.offset + done));
+                        if (n < 0 && errno == EINTR)
+                            continue;
+                        if (n <= 0) {
+                            error = n < 0 ? errno : EIO;
+                            break;
+                        }
+                        done += static_cast<usize>(n);
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (error && !job.target->error)
+                            job.target->error = error;
+                        --job.target->pending;
+                        queued_bytes_ -= job.data.size();
+                    }
+                    done_cv_.notify_all();
+                }
+            }
+        };
+
+    } // namespace detail
+
+    // ─── Directory volume ────────────────────────────────────────────────────────
+    // Serves a host directory (a mounted USB stick, an SD card) without loading
+    // it. Large read-only files are memory-mapped and only a window of pages
+    // behind the read position stays resident; other reads use pread. Writes go
+    // through the write-behind thread and are completed on flush or close.
+    class DirectoryVolume : public Volume {
+        class File : public VolumeFile {
+            std::shared_ptr<MappedFile> map_;
+            std::shared_ptr<detail::WriteTarget> target_;
+            detail::WriteBehind *writer_ = nullptr; // null for read-only files
+            u64 size_ = 0;
+            usize window_ = 0;
+            usize resident_from_ = 0; // mapped pages before this offset were released
+            bool sync_ = false;
+
+          public:
+            File(std::shared_ptr<MappedFile> map, usize window) : map_(std::move(map)), window_(window) {
+                size_ = map_->size();
+                map_->advise_sequential();
+            }
+            File(std::shared_ptr<detail::WriteTarget> target, u64 size, detail::WriteBehind *writer, bool sync)
+                : target_(std::move(target)), writer_(writer), size_(size), sync_(sync) {}
+            ~File() override {
+                if (writer_)
+                    writer_->drain(*target_);
+            }
+
+            u64 size() const override { return size_; }
+
+            Result<usize> read(u64 offset, u8 *dst, usize count) override {
+                if (offset >= size_)
+                    return Result<usize>::ok(0);
+                usize n = std::min<usize>(count, size_ - offset);
+                if (map_) {
+                    std::copy_n(map_->data() + offset, n, dst);
+                    if (offset > resident_from_ + 2 * window_) {
+                        map_->release(resident_from_, offset - window_ - resident_from_);
+                        resident_from_ = offset - window_;
+                    } else if (offset < resident_from_) {
+                        resident_from_ = offset; // seek back: pages fault in again
+                    }
+                    return Result<usize>::ok(n);
+                }
+                if (writer_ && writer_->drain(*target_) != 0)
+                    return Result<usize>::err(Error::driver_error("deferred write failed"));
+                usize done = 0;
+                while (done < n) {
+                    ssize_t r = ::pread(target_->fd, dst + done, n - done, static_cast<off_t>(offset + done));
+                    if (r < 0 && errno == EINTR)
+                        continue;
+                    if (r < 0)
+                        return Result<usize>::err(Error::driver_error("pread failed"));
+                    if (r == 0)
+                        break;
+                    done += static_cast<usize>(r);
+                }
+                return Result<usize>::ok(done);
+            }
+
+            Result<void> write(u64 offset, const u8 *src, usize count) override {
+                if (!writer_)
+                    return Result<void>::err(Error::invalid_state("file opened read-only"));
+                if (writer_->error(*target_) != 0)
+                    return Result<void>::err(Error::driver_error("deferred write failed"));
+                writer_->submit(target_, offset, src, count);
+                size_ = std::max<u64>(size_, offset + count);
+                return {};
+            }
+
+            Result<void> flush() override {
+                if (!writer_)
+                    return {};
+                if (writer_->drain(*target_) != 0)
+                    return Result<void>::err(Error::driver_error("deferred write failed"));
+                if (sync_ && ::fsync(target_->fd) != 0)
+                    return Result<void>::err(Error::driver_error("fsync failed"));
+                return {};
+            }
+        };
+
+        std::filesystem::path root_;
+        DirectoryVolumeConfig config_;
+        std::unique_ptr<detail::WriteBehind> writer_;
+
+      public:
+        explicit DirectoryVolume(std::filesystem::path root, DirectoryVolumeConfig config = {})
+            : root_(std::move(root)), config_(config),
+              writer_(std::make_unique<detail::WriteBehind>(config.write_behind_bytes, config.write_coalesce_bytes)) {
+            std::error_code ec;
+            std::filesystem::create_directories(root_, ec);
+        }
+
+        const std::filesystem::path &root() const noexcept { return root_; }
+
+        // Host path of a volume path; nullopt for paths escaping the root
+        dp::Optional<std::filesystem::path> host_path(const dp::String &path) const {
+            std::filesystem::path out = root_;
+            usize i = 0;
+            while (i < path.size()) {
+                usize end = path.find('\\', i);
+                if (end == dp::String::npos)
+                    end = path.size();
+                if (end > i) {
+                    dp::String part = path.substr(i, end - i);
+                    if (part == "." || part == ".." || part.find('/') != dp::String::npos)
+                        return dp::nullopt;
+                    out /= std::string(part);
+                }
+                i = end + 1;
+            }
+            return out;
+        }
+
+        bool file_exists(const dp::String &path) const override {
+            auto host = host_path(path);
+            std::error_code ec;
+            return host && std::filesystem::is_regular_file(*host, ec);
+        }
+
+        bool directory_exists(const dp::String &path) const override {
+            auto host = host_path(path);
+            std::error_code ec;
+            return host && std::filesystem::is_directory(*host, ec);
+        }
+
+        Result<std::shared_ptr<VolumeFile>> open(const dp::String &path, bool create, bool writable) override {
+            using R = Result<std::shared_ptr<VolumeFile>>;
+            auto host = host_path(path);
+            if (!host)
+                return R::err(Error::invalid_data("invalid path"));
+
+            if (!writable && !create) {
+                struct stat st {};
+                if (::stat(host->c_str(), &st) != 0)
+                    return R::err(Error::invalid_state("file not found"));
+                if (static_cast<usize>(st.st_size) >= config_.mmap_threshold && st.st_size > 0) {
+                    if (auto map = MappedFile::open(*host))
+                        return R::ok(std::make_shared<File>(std::move(map), config_.resident_window));
+                }
+            }
+
+            int flags = (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC | (create ? O_CREAT : 0);
+            int fd = ::open(host->c_str(), flags, 0644);
+            if (fd < 0)
+                return R::err(Error::invalid_state(errno == ENOENT ? "file not found" : "access denied"));
+            auto target = std::make_shared<detail::WriteTarget>();
+            target->fd = fd;
+            struct stat st {};
+            ::fstat(fd, &st);
+            return R::ok(std::make_shared<File>(std::move(target), static_cast<u64>(st.st_size),
+                                                writable ? writer_.get() : nullptr, config_.sync_on_flush));
+        }
+
+        Result<void> add_file(const dp::String &path, dp::Vector<u8> data, FileAttributes attrs) override {
+            auto host = host_path(path);
+            if (!host)
+                return Result<void>::err(Error::invalid_data("invalid path"));
+            std::error_code ec;
+            std::filesystem::create_directories(host->parent_path(), ec);
+            std::ofstream out(*host, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!out)
+                return Result<void>::err(Error::driver_error("cannot write file"));
+            out.close();
+            if (has_attribute(attrs, FileAttributes::ReadOnly))
+                std::filesystem::permissions(*host,
+                                             std::filesystem::perms::owner_write |
+                                                 std::filesystem::perms::group_write |
+                                                 std::filesystem::perms::others_write,
+                                             std::filesystem::perm_options::remove, ec);
+            return {};
+        }
+
+        Result<void> remove_file(const dp::String &path) override {
+            auto host = host_path(path);
+            std::error_code ec;
+            if (!host || !std::filesystem::is_regular_file(*host, ec) || !std::filesystem::remove(*host, ec))
+                return Result<void>::err(Error::invalid_state("file not found"));
+            return {};
+        }
+
+        // Open files keep their descriptors, so queued writes follow the rename
+        Result<void> move_file(const dp::String &from, const dp::String &to) override {
+            auto src = host_path(from);
+            auto dst = host_path(to);
+            std::error_code ec;
+            if (!src || !std::filesystem::is_regular_file(*src, ec))
+                return Result<void>::err(Error::invalid_state("file not found"));
+            if (!dst || std::filesystem::exists(*dst, ec))
+                return Result<void>::err(Error::invalid_state("target exists"));
+            std::filesystem::create_directories(dst->parent_path(), ec);
+            std::filesystem::rename(*src, *dst, ec);
+            if (ec)
+                return Result<void>::err(Error::driver_error("cannot move file"));
+            return {};
+        }
+
+        Result<void> add_directory(const dp::String &path) override {
+            auto host = host_path(path);
+            std::error_code ec;
+            if (!host || (std::filesystem::create_directories(*host, ec), ec))
+                return Result<void>::err(Error::invalid_state("cannot create directory"));
+            return {};
+        }
+
+        dp::Vector<FileEntry> list(const dp::String &directory) const override {
+            dp::Vector<FileEntry> entries;
+            auto host = host_path(directory);
+            std::error_code ec;
+            if (!host)
+                return entries;
+            for (const auto &de : std::filesystem::directory_iterator(*host, ec)) {
+                struct stat st {};
+                if (::stat(de.path().c_str(), &st) != 0)
+                    continue;
+                FileEntry entry;
+                entry.name = de.path().filename().string();
+                if (S_ISDIR(st.st_mode)) {
+                    entry.name += '\\';
+                    entry.attributes = FileAttributes::Directory;
+                } else {
+                    entry.size = static_cast<u32>(std::min<u64>(static_cast<u64>(st.st_size), 0xFFFFFFFFu));
+                    if (::access(de.path().c_str(), W_OK) != 0)
+                        entry.attributes = entry.attributes | FileAttributes::ReadOnly;
+                }
+                if (!entry.name.empty() && entry.name[0] == '.')
+                    entry.attributes = entry.attributes | FileAttributes::Hidden;
+                std::tm tm{};
+                ::localtime_r(&st.st_mtime, &tm);
+                entry.date = pack_dos_date(static_cast<u16>(std::max(tm.tm_year + 1900, 1980)),
+                                           static_cast<u8>(tm.tm_mon + 1), static_cast<u8>(tm.tm_mday));
+                entry.time = pack_dos_time(static_cast<u8>(tm.tm_hour), static_cast<u8>(tm.tm_min),
+                                           static_cast<u8>(tm.tm_sec));
+                entries.push_back(entry);
+            }
+            return entries;
+        }
+
+        Result<void> flush() override {
+            writer_->drain_all();
+            return {};
+        }
+
+        // Write data accepted but not yet on disk
+        usize pending_write_bytes() const { return writer_->queued_bytes(); }
+    };
+
+} // namespace agrobus::isobus::fs
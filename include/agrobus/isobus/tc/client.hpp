@@ -1,13 +1,16 @@
 #pragma once
 
 #include "ddop.hpp"
+#include "measurement.hpp"
 #include "objects.hpp"
+#include "server_options.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/error.hpp>
 #include <agrobus/net/event.hpp>
 #include <agrobus/net/internal_cf.hpp>
 #include <agrobus/net/message.hpp>
 #include <agrobus/net/network_manager.hpp>
+#include <agrobus/net/pgn_defs.hpp>
 #include <agrobus/net/state_machine.hpp>
 #include <datapod/datapod.hpp>
 #include <echo/echo.hpp>
@@ -19,11 +22,23 @@ namespace agrobus::isobus::tc {
     // ─── TC Client Config ────────────────────────────────────────────────────────
     struct TCClientConfig {
         u32 timeout_ms = 6000;
+        bool negotiate_labels = true;  // ask for stored labels before transferring the DDOP
+        bool content_labels = true;    // derive an unset structure label from the pool content
+        u32 label_timeout_ms = 1000;   // TCs that do not answer get the full transfer
 
         TCClientConfig &timeout(u32 ms) {
             timeout_ms = ms;
             return *this;
         }
+        TCClientConfig &labels(bool negotiate, u32 wait_ms = 1000) {
+            negotiate_labels = negotiate;
+            label_timeout_ms = wait_ms;
+            return *this;
+        }
+        TCClientConfig &content_label(bool enable) {
+            content_labels = enable;
+            return *this;
+        }
     };
 
     // ─── TC Client state ─────────────────────────────────────────────────────────
@@ -34,6 +49,10 @@ namespace agrobus::isobus::tc {
         SendWorkingSetMaster,
         RequestVersion,
         WaitForVersion,
+        RequestStructureLabel,
+        WaitForStructureLabel,
+        RequestLocalizationLabel,
+        WaitForLocalizationLabel,
         ProcessDDOP,
         TransferDDOP,
         WaitForPoolResponse,
@@ -42,25 +61,6 @@ namespace agrobus::isobus::tc {
         Connected
     };
 
-    // ─── TC command types ────────────────────────────────────────────────────────
-    namespace tc_cmd {
-        inline constexpr u8 VERSION_REQUEST = 0x00;
-        inline constexpr u8 VERSION_RESPONSE = 0x10;
-        inline constexpr u8 STRUCTURE_LABEL = 0x01;
-        inline constexpr u8 LOCALIZATION_LABEL = 0x21;
-        inline constexpr u8 REQUEST_OBJECT_POOL = 0x41;
-        inline constexpr u8 OBJECT_POOL_TRANSFER = 0x11;
-        inline constexpr u8 OBJECT_POOL_RESPONSE = 0x12;
-        inline constexpr u8 ACTIVATE_POOL = 0x22;
-        inline constexpr u8 ACTIVATE_RESPONSE = 0x23;
-        inline constexpr u8 DELETE_POOL = 0x32;
-        inline constexpr u8 PROCESS_DATA = 0x03;
-        inline constexpr u8 SET_VALUE = 0x24;
-        inline constexpr u8 REQUEST_VALUE = 0x04;
-        inline constexpr u8 VALUE_RESPONSE = 0x05;
-        inline constexpr u8 TC_STATUS = 0xFE;
-    } // namespace tc_cmd
-
     // ─── Task Controller Client ──────────────────────────────────────────────────
     class TaskControllerClient {
         IsoNet &net_;
@@ -73,6 +73,14 @@ namespace agrobus::isobus::tc {
         u8 tc_version_ = 0;
         u8 num_booms_ = 0;
         u8 num_sections_ = 0;
+        bool transfer_skipped_ = false;
+
+        // Measurement triggers
+        MeasurementEngine measurements_;
+        u32 pending_distance_mm_ = 0;
+        u32 last_distance_raw_ = 0;
+        bool have_distance_ = false;
+        u64 values_sent_ = 0;
 
         // Callbacks
         using ValueCallback = std::function<Result<i32>(ElementNumber, DDI)>;
@@ -93,6 +101,9 @@ namespace agrobus::isobus::tc {
                 echo::category("isobus.tc.client").error("DDOP validation failed");
                 return Result<void>::err(Error::invalid_state("DDOP validation failed"));
             }
+            if (config_.content_labels && ddop_.stamp_structure_label())
+                echo::category("isobus.tc.client").debug("structure label derived from DDOP content");
+            transfer_skipped_ = false;
 
             state_.transition(TCState::WaitForServerStatus);
             echo::category("isobus.tc.client").debug("state: ", static_cast<u8>(state_.state()));
@@ -106,6 +117,7 @@ namespace agrobus::isobus::tc {
 
         Result<void> disconnect() {
             state_.transition(TCState::Disconnected);
+            measurements_.clear();
             echo::category("isobus.tc.client").debug("state: ", static_cast<u8>(state_.state()));
             echo::category("isobus.tc.client").info("TC client disconnected");
             return {};
@@ -113,9 +125,41 @@ namespace agrobus::isobus::tc {
 
         TCState state() const noexcept { return state_.state(); }
 
+        // True when the last activation reused the pool the TC already had stored
+        bool transfer_skipped() const noexcept { return transfer_skipped_; }
+
         void on_value_request(ValueCallback cb) { value_callback_ = std::move(cb); }
         void on_value_command(CommandCallback cb) { command_callback_ = std::move(cb); }
 
+        // ─── Measurement triggers ────────────────────────────────────────────────
+        // Push the current value of a process data pair. Threshold and on-change
+        // subscriptions fire immediately; time and distance triggers use the latest
+        // pushed value. Pairs that were never pushed are read via on_value_request.
+        bool set_value(ElementNumber element, DDI ddi, i32 value) {
+            return measurements_.set_value(element, ddi, value, [this](ElementNumber e, DDI d, i32 v) {
+                send_value(e, d, v);
+            });
+        }
+
+        // Feed travelled distance for distance-interval triggers
+        void add_distance(f64 metres) {
+            if (metres > 0.0)
+                pending_distance_mm_ += static_cast<u32>(metres * 1000.0 + 0.5);
+        }
+
+        // Take travelled distance from a speed/distance broadcast (wheel-based,
+        // ground-based or machine-selected; all carry distance at 1 mm/bit).
+        Result<void> track_distance(PGN pgn = PGN_MACHINE_SELECTED_SPEED) {
+            if (pgn != PGN_WHEEL_BASED_SPEED_DIST && pgn != PGN_GROUND_BASED_SPEED_DIST &&
+                pgn != PGN_MACHINE_SELECTED_SPEED)
+                return Result<void>::err(Error::invalid_state("not a speed/distance PGN"));
+            have_distance_ = false;
+            return net_.register_pgn_callback(pgn, [this](const Message &msg) { handle_distance(msg); });
+        }
+
+        const MeasurementEngine &measurements() const noexcept { return measurements_; }
+        u64 values_sent() const noexcept { return values_sent_; }
+
         void update(u32 elapsed_ms) {
             timer_ms_ += elapsed_ms;
 
@@ -152,30 +196,52 @@ namespace agrobus::isobus::tc {
                 }
                 break;
 
-            case TCState::TransferDDOP: {
-                auto pool_result = ddop_.serialize();
-                if (pool_result) {
-                    auto &pool_data = pool_result.value();
-                    // Send DDOP via IsoNet (auto-selects TP/ETP based on size)
-                    ControlFunction tc_cf;
-                    tc_cf.address = tc_address_;
-                    auto send_result = net_.send(PGN_ECU_TO_TC, pool_data, cf_, &tc_cf);
-                    if (!send_result.is_ok()) {
-                        echo::category("isobus.tc.client").error("DDOP transfer failed: transport error");
-                        state_.transition(TCState::Disconnected);
-                        break;
-                    }
-                    state_.transition(TCState::WaitForPoolResponse);
+            case TCState::RequestStructureLabel:
+                send_label_request(tc_cmd::STRUCTURE_LABEL);
+                state_.transition(TCState::WaitForStructureLabel);
+                timer_ms_ = 0;
+                break;
+
+            case TCState::RequestLocalizationLabel:
+                send_label_request(tc_cmd::LOCALIZATION_LABEL);
+                state_.transition(TCState::WaitForLocalizationLabel);
+                timer_ms_ = 0;
+                break;
+
+            case TCState::WaitForStructureLabel:
+            case TCState::WaitForLocalizationLabel:
+                if (timer_ms_ >= config_.label_timeout_ms) {
+                    echo::category("isobus.tc.client").debug("no label response, transferring DDOP");
+                    state_.transition(TCState::TransferDDOP);
                     timer_ms_ = 0;
-                    echo::category("isobus.tc.client")
-                        .info("DDOP transferred: ", pool_data.size(), " bytes via transport");
                 }
                 break;
+
+            case TCState::TransferDDOP: {
+                const auto &image = ddop_.image();
+                dp::Vector<u8> pool_data;
+                pool_data.reserve(image.size() + 1);
+                pool_data.push_back(tc_cmd::OBJECT_POOL_TRANSFER);
+                pool_data.insert(pool_data.end(), image.begin(), image.end());
+                // Send DDOP via IsoNet (auto-selects TP/ETP based on size)
+                ControlFunction tc_cf;
+                tc_cf.address = tc_address_;
+                auto send_result = net_.send(PGN_ECU_TO_TC, pool_data, cf_, &tc_cf);
+                if (!send_result.is_ok()) {
+                    echo::category("isobus.tc.client").error("DDOP transfer failed: transport error");
+                    state_.transition(TCState::Disconnected);
+                    break;
+                }
+                state_.transition(TCState::WaitForPoolResponse);
+                timer_ms_ = 0;
+                echo::category("isobus.tc.client").info("DDOP transferred: ", pool_data.size(), " bytes via transport");
+                break;
             }
 
             case TCState::ActivatePool: {
                 dp::Vector<u8> data(8, 0xFF);
                 data[0] = tc_cmd::ACTIVATE_POOL;
+                data[1] = 0x01; // activate
                 net_.send(PGN_ECU_TO_TC, data, cf_);
                 state_.transition(TCState::WaitForActivation);
                 timer_ms_ = 0;
@@ -190,6 +256,21 @@ namespace agrobus::isobus::tc {
                 }
                 break;
 
+            case TCState::Connected:
+                measurements_.advance(
+                    elapsed_ms, pending_distance_mm_,
+                    [this](ElementNumber e, DDI d) -> dp::Optional<i32> {
+                        if (!value_callback_)
+                            return dp::nullopt;
+                        auto result = value_callback_(e, d);
+                        if (!result)
+                            return dp::nullopt;
+                        return result.value();
+                    },
+                    [this](ElementNumber e, DDI d, i32 v) { send_value(e, d, v); });
+                pending_distance_mm_ = 0;
+                break;
+
             default:
                 break;
             }
@@ -204,28 +285,99 @@ namespace agrobus::isobus::tc {
                 return;
             u8 cmd = msg.data[0];
 
-            switch (cmd) {
-            case tc_cmd::TC_STATUS:
+            if (cmd == tc_cmd::TC_STATUS) {
                 handle_tc_status(msg);
-                break;
+                return;
+            }
+            // Once the pool is active the low nibble is the process data command
+            // and the high nibble part of the element number.
+            if (state_.state() == TCState::Connected) {
+                handle_process_data(msg);
+                return;
+            }
+
+            switch (cmd) {
             case tc_cmd::VERSION_RESPONSE:
                 handle_version_response(msg);
                 break;
+            case tc_cmd::STRUCTURE_LABEL_RESPONSE:
+                handle_label_response(msg, TCState::WaitForStructureLabel, ddop_.devices().front().structure_label);
+                break;
+            case tc_cmd::LOCALIZATION_LABEL_RESPONSE:
+                handle_label_response(msg, TCState::WaitForLocalizationLabel,
+                                      ddop_.devices().front().localization_label);
+                break;
             case tc_cmd::OBJECT_POOL_RESPONSE:
                 handle_pool_response(msg);
                 break;
             case tc_cmd::ACTIVATE_RESPONSE:
                 handle_activate_response(msg);
                 break;
-            case tc_cmd::REQUEST_VALUE:
+            }
+        }
+
+        void handle_process_data(const Message &msg) {
+            switch (static_cast<ProcessDataCommands>(msg.data[0] & 0x0F)) {
+            case ProcessDataCommands::RequestValue:
                 handle_value_request(msg);
                 break;
-            case tc_cmd::SET_VALUE:
+            case ProcessDataCommands::Value:
+            case ProcessDataCommands::SetValueAndAcknowledge:
                 handle_value_command(msg);
                 break;
+            case ProcessDataCommands::MeasurementTimeInterval:
+            case ProcessDataCommands::MeasurementDistanceInterval:
+            case ProcessDataCommands::MeasurementMinimumWithinThreshold:
+            case ProcessDataCommands::MeasurementMaximumWithinThreshold:
+            case ProcessDataCommands::MeasurementChangeThreshold:
+                handle_measurement_command(msg);
+                break;
+            default:
+                echo::category("isobus.tc.client").trace("Unhandled process data command: ", msg.data[0] & 0x0F);
+                break;
             }
         }
 
+        void handle_measurement_command(const Message &msg) {
+            if (msg.data.size() < 8)
+                return;
+            ElementNumber elem = static_cast<u16>((msg.data[0] >> 4) & 0x0F) | (static_cast<u16>(msg.data[1]) << 4);
+            DDI ddi = static_cast<u16>(msg.data[2]) | (static_cast<u16>(msg.data[3]) << 8);
+            i32 value = static_cast<i32>(msg.data[4]) | (static_cast<i32>(msg.data[5]) << 8) |
+                        (static_cast<i32>(msg.data[6]) << 16) | (static_cast<i32>(msg.data[7]) << 24);
+            measurements_.configure(static_cast<ProcessDataCommands>(msg.data[0] & 0x0F), elem, ddi, value);
+        }
+
+        void handle_distance(const Message &msg) {
+            if (msg.data.size() < 6)
+                return;
+            u32 raw = static_cast<u32>(msg.data[2]) | (static_cast<u32>(msg.data[3]) << 8) |
+                      (static_cast<u32>(msg.data[4]) << 16) | (static_cast<u32>(msg.data[5]) << 24);
+            if (raw >= 0xFAFFFFFF)
+                return; // error / not available
+            if (have_distance_ && raw >= last_distance_raw_)
+                pending_distance_mm_ += raw - last_distance_raw_;
+            last_distance_raw_ = raw;
+            have_distance_ = true;
+        }
+
+        void send_value(ElementNumber elem, DDI ddi, i32 val) {
+            dp::Vector<u8> data(8, 0xFF);
+            data[0] = (static_cast<u8>(ProcessDataCommands::Value) & 0x0F) | ((static_cast<u8>(elem) & 0x0F) << 4);
+            data[1] = static_cast<u8>((elem >> 4) & 0xFF);
+            data[2] = static_cast<u8>(ddi & 0xFF);
+            data[3] = static_cast<u8>((ddi >> 8) & 0xFF);
+            data[4] = static_cast<u8>(val & 0xFF);
+            data[5] = static_cast<u8>((val >> 8) & 0xFF);
+            data[6] = static_cast<u8>((val >> 16) & 0xFF);
+            data[7] = static_cast<u8>((val >> 24) & 0xFF);
+
+            ControlFunction tc_cf;
+            tc_cf.address = tc_address_;
+            if (net_.send(PGN_ECU_TO_TC, data, cf_, &tc_cf).is_ok())
+                ++values_sent_;
+        }
+
         void handle_tc_status(const Message &msg) {
             tc_address_ = msg.source;
             if (state_.state() == TCState::WaitForServerStatus) {
@@ -244,8 +396,39 @@ namespace agrobus::isobus::tc {
             num_sections_ = msg.data[3];
             echo::category("isobus.tc.client")
                 .info("TC version=", tc_version_, " booms=", num_booms_, " sections=", num_sections_);
-            state_.transition(TCState::TransferDDOP);
+            state_.transition(config_.negotiate_labels ? TCState::RequestStructureLabel : TCState::TransferDDOP);
+            timer_ms_ = 0;
+        }
+
+        void send_label_request(u8 cmd) {
+            dp::Vector<u8> data(8, 0xFF);
+            data[0] = cmd;
+            ControlFunction tc_cf;
+            tc_cf.address = tc_address_;
+            net_.send(PGN_ECU_TO_TC, data, cf_, &tc_cf);
+        }
+
+        // The TC answers with the label of the pool it has stored for our NAME,
+        // or all 0xFF when it has none. Both labels must match to skip the
+        // transfer; the structure label is checked first.
+        void handle_label_response(const Message &msg, TCState expected, const dp::Array<u8, 7> &ours) {
+            if (state_.state() != expected || msg.data.size() < 8)
+                return;
+            bool match = true;
+            for (usize i = 0; i < 7; ++i)
+                match = match && msg.data[1 + i] == ours[i];
             timer_ms_ = 0;
+
+            if (!match) {
+                echo::category("isobus.tc.client").info("stored DDOP differs, transferring");
+                state_.transition(TCState::TransferDDOP);
+            } else if (expected == TCState::WaitForStructureLabel) {
+                state_.transition(TCState::RequestLocalizationLabel);
+            } else {
+                echo::category("isobus.tc.client").info("TC has our DDOP, skipping transfer");
+                transfer_skipped_ = true;
+                state_.transition(TCState::ActivatePool);
+            }
         }
 
         void handle_pool_response(const Message &msg) {
@@ -284,23 +467,8 @@ namespace agrobus::isobus::tc {
             DDI ddi = static_cast<u16>(msg.data[2]) | (static_cast<u16>(msg.data[3]) << 8);
 
             auto result = value_callback_(elem, ddi);
-            if (result) {
-                dp::Vector<u8> response(8, 0xFF);
-                // Pack: VALUE command in low nibble, element high nibble in high nibble
-                response[0] = (static_cast<u8>(tc_cmd::VALUE_RESPONSE) & 0x0F) | ((static_cast<u8>(elem) & 0x0F) << 4);
-                response[1] = static_cast<u8>((elem >> 4) & 0xFF);
-                response[2] = static_cast<u8>(ddi & 0xFF);
-                response[3] = static_cast<u8>((ddi >> 8) & 0xFF);
-                i32 val = result.value();
-                response[4] = static_cast<u8>(val & 0xFF);
-                response[5] = static_cast<u8>((val >> 8) & 0xFF);
-                response[6] = static_cast<u8>((val >> 16) & 0xFF);
-                response[7] = static_cast<u8>((val >> 24) & 0xFF);
-
-                ControlFunction tc_cf;
-                tc_cf.address = tc_address_;
-                net_.send(PGN_ECU_TO_TC, response, cf_, &tc_cf);
-            }
+            if (result)
+                send_value(elem, ddi, result.value());
         }
 
         void handle_value_command(const Message &msg) {
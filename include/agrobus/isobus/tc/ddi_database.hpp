@@ -1168,7 +1168,7 @@ namespace agrobus::isobus::tc {
         {358, "Average Dry Yield Mass Per Time", "mg/s", 1.0, 0, 2147483647},
         {359, "Average Dry Yield Mass Per Area", "mg/m2", 1.0, 0, 2147483647},
         {360, "Last Bale Size", "mm", 1.0, 0, 2147483647},
-        {361, "Last Bale Density", "mg/l (mass per unit volume)", 1.0, 0, 2147483647},
+        {361, "Last Bale Density", "mg/l", 1.0, 0, 2147483647},
         {362, "Total Bale Length", "mm", 1.0, 0, 2147483647},
         {363, "Last Bale Dry Mass", "g", 1.0, 0, 2147483647},
         {364, "Actual Flake Size", "mm", 1.0, 0, 1000},
@@ -1300,7 +1300,7 @@ namespace agrobus::isobus::tc {
         {491, "Fuel Percentage Level", "%", 0.01, 0, 2147483647},
         {492, "Total Engine Hours", "h", 0.05, 0, 2147483647},
         {493, "Lifetime Engine Hours", "h", 0.1, 0, 2147483647},
-        {494, "Last Event Partner ID (Byte 1-4)", "", 1.0, 0, 0},
+        {494, "Last Event Partner ID (Byte 1-4)", "", 1.0, 0, 2147483647},
         {495, "Last Event Partner ID (Byte 5-8)", "n.a. -", 1.0, 0, 2147483647},
         {496, "Last Event Partner ID (Byte 9-12)", "n.a. -", 1.0, 0, 2147483647},
         {497, "Last Event Partner ID (Byte 13-16)", "", 1.0, 0, 2147483647},
@@ -1379,10 +1379,10 @@ namespace agrobus::isobus::tc {
         {571, "Maximum Electrical Power", "W", 0.001, 0, 2147483647},
         {572, "Minimum Electrical Power", "W", 0.001, 0, 2147483647},
         {573, "Total Electrical Energy", "kWh", 0.001, 0, 2147483647},
-        {574, "Setpoint Electrical Energy per Area Application Rate", "kWh/m2", 1.0, 0, 2147483647},
-        {575, "Actual  Electrical Energy per Area Application Rate", "kWh/m2", 1.0, 0, 2147483647},
-        {576, "Maximum  Electrical Energy  per Area Application Rate", "kWh/m2", 1.0, 0, 2147483647},
-        {577, "Minimum  Electrical Energy per Area Application Rate", "kWh/m2", 1.0, 0, 2147483647},
+        {574, "Setpoint Electrical Energy per Area Application Rate", "kWh/m2", 1e-07, 0, 2147483647},
+        {575, "Actual  Electrical Energy per Area Application Rate", "kWh/m2", 1e-07, 0, 2147483647},
+        {576, "Maximum  Electrical Energy  per Area Application Rate", "kWh/m2", 1e-07, 0, 2147483647},
+        {577, "Minimum  Electrical Energy per Area Application Rate", "kWh/m2", 1e-07, 0, 2147483647},
         {578, "Setpoint Temperature", "mK", 1.0, 0, 1000000},
         {579, "Actual Temperature", "mK", 1.0, 0, 1000000},
         {580, "Minimum Temperature", "mK", 1.0, 0, 1000000},
@@ -1497,7 +1497,7 @@ namespace agrobus::isobus::tc {
         {689, "Effective Total Electrical Battery Energy Consumption", "kWh", 0.001, -2147483648, 2147483647},
         {690, "Ineffective Total Electrical Battery Energy Consumption", "kWh", 0.001, -2147483648, 2147483647},
         {691, "Instantaneous Electrical Battery Energy Consumption per Time", "W", 1.0, -2147483648, 2147483647},
-        {692, "Instantaneous Electrical Battery Energy Consumption per Area", "kWh/m2", 1.0, -2147483648, 2147483647},
+        {692, "Instantaneous Electrical Battery Energy Consumption per Area", "kWh/m2", 1e-05, -2147483648, 2147483647},
         {693, "Lifetime Total Loading Time", "s", 1.0, 0, 2147483647},
         {694, "Lifetime Total Unloading Time", "s", 1.0, 0, 2147483647},
         {695, "Mesh Total Used", "mm", 1.0, 0, 2147483647},
@@ -1532,8 +1532,8 @@ namespace agrobus::isobus::tc {
         {724, "Average NDF Content", "ppm", 1.0, 0, 2147483647},
         {725, "Actual uNDFom240 Content", "ppm", 1.0, 0, 2147483647},
         {726, "Average uNDFom240 Content", "ppm", 1.0, 0, 2147483647},
-        {727, "Actual Biomethanation Production Potential", "mm3/kg", 1.0, 0, 2147483647},
-        {728, "Average Biomethanation Production Potential", "mm3/kg", 1.0, 0, 2147483647},
+        {727, "Actual Biomethanation Production Potential", "mm3/kg", 1e-06, 0, 2147483647},
+        {728, "Average Biomethanation Production Potential", "mm3/kg", 1e-06, 0, 2147483647},
         {32768, "Maximum Droplet Size", "n.a. -", 1.0, 0, 255},
         {32769, "Maximum Crop Grade Diameter", "mm", 0.001, 0, 2147483647},
         {32770, "Maximum Crop Grade Length", "mm", 0.001, 0, 2147483647},
@@ -1572,36 +1572,108 @@ namespace agrobus::isobus::tc {
     inline constexpr usize DDI_DATABASE_SIZE = 760;
 
     // ─── DDI Lookup ──────────────────────────────────────────────────────────
-    inline const DDIDefinition *ddi_lookup(u16 ddi) {
-        for (usize i = 0; i < DDI_DATABASE_SIZE; ++i) {
-            if (DDI_DATABASE[i].ddi == ddi)
-                return &DDI_DATABASE[i];
+    // DDI_DATABASE is sorted by DDI. The standard range at the bottom is nearly
+    // contiguous and resolves through a slot table built at compile time (one
+    // u16 per DDI, ~1.5 KiB); the few blocks above it (0x8000+ and the
+    // proprietary markers) are found by binary search over the remaining tail.
+    namespace detail {
+        inline constexpr u16 DDI_NO_SLOT = 0xFFFF;
+        inline constexpr u16 DDI_DENSE_MAX_GAP = 16;
+
+        constexpr usize ddi_dense_entries() {
+            usize n = 1;
+            while (n < DDI_DATABASE_SIZE && DDI_DATABASE[n].ddi - DDI_DATABASE[n - 1].ddi <= DDI_DENSE_MAX_GAP)
+                ++n;
+            return n;
+        }
+
+        inline constexpr usize DDI_DENSE_ENTRIES = ddi_dense_entries();
+        inline constexpr usize DDI_DENSE_LIMIT = DDI_DATABASE[DDI_DENSE_ENTRIES - 1].ddi + 1;
+
+        constexpr dp::Array<u16, DDI_DENSE_LIMIT> ddi_dense_slots() {
+            dp::Array<u16, DDI_DENSE_LIMIT> slots{};
+            for (auto &s : slots)
+                s = DDI_NO_SLOT;
+            for (usize i = 0; i < DDI_DENSE_ENTRIES; ++i)
+                slots[DDI_DATABASE[i].ddi] = static_cast<u16>(i);
+            return slots;
         }
-        return nullptr;
+
+        inline constexpr auto DDI_DENSE_SLOTS = ddi_dense_slots();
+
+        constexpr bool ddi_database_sorted() {
+            for (usize i = 1; i < DDI_DATABASE_SIZE; ++i)
+                if (DDI_DATABASE[i].ddi <= DDI_DATABASE[i - 1].ddi)
+                    return false;
+            return true;
+        }
+        static_assert(ddi_database_sorted(), "DDI_DATABASE must be sorted by DDI");
+        static_assert(sizeof(DDI_DATABASE) / sizeof(DDI_DATABASE[0]) == DDI_DATABASE_SIZE);
+    } // namespace detail
+
+    constexpr const DDIDefinition *ddi_lookup(u16 ddi) noexcept {
+        if (ddi < detail::DDI_DENSE_LIMIT) {
+            u16 slot = detail::DDI_DENSE_SLOTS[ddi];
+            return slot == detail::DDI_NO_SLOT ? nullptr : &DDI_DATABASE[slot];
+        }
+        usize lo = detail::DDI_DENSE_ENTRIES, hi = DDI_DATABASE_SIZE;
+        while (lo < hi) {
+            usize mid = (lo + hi) / 2;
+            if (DDI_DATABASE[mid].ddi < ddi)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return (lo < DDI_DATABASE_SIZE && DDI_DATABASE[lo].ddi == ddi) ? &DDI_DATABASE[lo] : nullptr;
     }
 
-    inline const char *ddi_name(u16 ddi) {
+    constexpr const char *ddi_name(u16 ddi) noexcept {
         auto *def = ddi_lookup(ddi);
         return def ? def->name : "Unknown";
     }
 
-    inline const char *ddi_unit(u16 ddi) {
+    constexpr const char *ddi_unit(u16 ddi) noexcept {
         auto *def = ddi_lookup(ddi);
         return def ? def->unit : "";
     }
 
-    inline f64 ddi_resolution(u16 ddi) {
+    constexpr f64 ddi_resolution(u16 ddi) noexcept {
         auto *def = ddi_lookup(ddi);
         return def ? def->resolution : 1.0;
     }
 
-    inline f64 ddi_to_engineering(u16 ddi, i32 raw) { return static_cast<f64>(raw) * ddi_resolution(ddi); }
+    constexpr f64 ddi_to_engineering(u16 ddi, i32 raw) noexcept { return static_cast<f64>(raw) * ddi_resolution(ddi); }
 
-    inline i32 ddi_from_engineering(u16 ddi, f64 eng) {
+    constexpr i32 ddi_from_engineering(u16 ddi, f64 eng) noexcept {
         f64 res = ddi_resolution(ddi);
         return (res != 0.0) ? static_cast<i32>(eng / res) : static_cast<i32>(eng);
     }
 
+    // ─── Compile-time DDI ────────────────────────────────────────────────────
+    // Ddi<ddi::ACTUAL_WORKING_WIDTH>::to_engineering(raw) resolves the database
+    // entry while compiling, so a conversion is a single multiply. DDIs missing
+    // from the database fail to compile.
+    template <u16 N> struct Ddi {
+        static_assert(ddi_lookup(N) != nullptr, "DDI is not in the ISO 11783-11 database");
+
+        static constexpr u16 value = N;
+        static constexpr const DDIDefinition &definition = *ddi_lookup(N);
+        static constexpr const char *name = definition.name;
+        static constexpr const char *unit = definition.unit;
+        static constexpr f64 resolution = definition.resolution;
+        static constexpr i32 min_value = definition.min_value;
+        static constexpr i32 max_value = definition.max_value;
+
+        static constexpr f64 to_engineering(i32 raw) noexcept { return static_cast<f64>(raw) * resolution; }
+        static constexpr i32 from_engineering(f64 eng) noexcept {
+            if constexpr (resolution != 0.0)
+                return static_cast<i32>(eng / resolution);
+            else
+                return static_cast<i32>(eng);
+        }
+        static constexpr bool in_range(i32 raw) noexcept { return raw >= min_value && raw <= max_value; }
+    };
+
     // ─── DDI Category Helpers ────────────────────────────────────────────────
     inline bool ddi_is_rate(u16 ddi) { return ddi >= 1 && ddi <= 55; }
     inline bool ddi_is_total(u16 ddi) {
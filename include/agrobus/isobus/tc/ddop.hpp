@@ -5,12 +5,25 @@
 #include <cstring>
 #include <datapod/datapod.hpp>
 #include <echo/echo.hpp>
+#include <type_traits>
 
 namespace agrobus::isobus::tc {
     using namespace agrobus::net;
 
     // ─── Device Descriptor Object Pool ──────────────────────────────────────────
+    // Objects are stored per kind in insertion order (the transfer order). An
+    // ObjectID index, an element-number index and a child -> parent index are
+    // rebuilt lazily on the first lookup after a mutation, and the serialized
+    // pool image is cached until the pool changes. Both indexes are dense
+    // vectors keyed by ID/number: DDOP IDs are allocated sequentially, so they
+    // stay small while giving O(1) lookups.
     class DDOP {
+        struct ObjectSlot {
+            u32 index = NO_SLOT;
+            TCObjectType type = TCObjectType::Device;
+        };
+        static constexpr u32 NO_SLOT = 0xFFFFFFFF;
+
         dp::Vector<DeviceObject> devices_;
         dp::Vector<DeviceElement> elements_;
         dp::Vector<DeviceProcessData> process_data_;
@@ -18,6 +31,18 @@ namespace agrobus::isobus::tc {
         dp::Vector<DeviceValuePresentation> value_presentations_;
         ObjectID next_id_ = 0;
 
+        mutable dp::Vector<ObjectSlot> id_slots_; // ObjectID -> kind + position
+        mutable dp::Vector<u32> element_numbers_; // element number -> position in elements_
+        mutable dp::Vector<u32> parents_;         // ObjectID -> element listing it as a child
+        mutable bool index_dirty_ = true;
+        mutable dp::Vector<u8> image_;
+        mutable bool image_dirty_ = true;
+
+        void touch() noexcept {
+            index_dirty_ = true;
+            image_dirty_ = true;
+        }
+
       public:
         ObjectID next_id() noexcept { return next_id_++; }
 
@@ -28,6 +53,7 @@ namespace agrobus::isobus::tc {
             if (obj.id == 0)
                 obj.id = next_id();
             devices_.push_back(std::move(obj));
+            touch();
             return Result<ObjectID>::ok(devices_.back().id);
         }
 
@@ -35,6 +61,7 @@ namespace agrobus::isobus::tc {
             if (elem.id == 0)
                 elem.id = next_id();
             elements_.push_back(std::move(elem));
+            touch();
             return Result<ObjectID>::ok(elements_.back().id);
         }
 
@@ -42,6 +69,7 @@ namespace agrobus::isobus::tc {
             if (pd.id == 0)
                 pd.id = next_id();
             process_data_.push_back(std::move(pd));
+            touch();
             return Result<ObjectID>::ok(process_data_.back().id);
         }
 
@@ -49,6 +77,7 @@ namespace agrobus::isobus::tc {
             if (prop.id == 0)
                 prop.id = next_id();
             properties_.push_back(std::move(prop));
+            touch();
             return Result<ObjectID>::ok(properties_.back().id);
         }
 
@@ -56,36 +85,31 @@ namespace agrobus::isobus::tc {
             if (vp.id == 0)
                 vp.id = next_id();
             value_presentations_.push_back(std::move(vp));
+            touch();
             return Result<ObjectID>::ok(value_presentations_.back().id);
         }
 
         // Serialize the entire DDOP to binary
-        Result<dp::Vector<u8>> serialize() const {
-            dp::Vector<u8> data;
-
-            for (const auto &dev : devices_) {
-                auto bytes = dev.serialize();
-                data.insert(data.end(), bytes.begin(), bytes.end());
-            }
-            for (const auto &elem : elements_) {
-                auto bytes = elem.serialize();
-                data.insert(data.end(), bytes.begin(), bytes.end());
-            }
-            for (const auto &pd : process_data_) {
-                auto bytes = pd.serialize();
-                data.insert(data.end(), bytes.begin(), bytes.end());
-            }
-            for (const auto &prop : properties_) {
-                auto bytes = prop.serialize();
-                data.insert(data.end(), bytes.begin(), bytes.end());
-            }
-            for (const auto &vp : value_presentations_) {
-                auto bytes = vp.serialize();
-                data.insert(data.end(), bytes.begin(), bytes.end());
-            }
-
-            echo::category("isobus.tc").debug("DDOP serialized: ", data.size(), " bytes");
-            return Result<dp::Vector<u8>>::ok(std::move(data));
+        Result<dp::Vector<u8>> serialize() const { return Result<dp::Vector<u8>>::ok(image()); }
+
+        // Serialized pool, rebuilt only after the pool has changed
+        const dp::Vector<u8> &image() const {
+            if (!image_dirty_)
+                return image_;
+            image_.clear();
+            for (const auto &dev : devices_)
+                dev.serialize_to(image_);
+            for (const auto &elem : elements_)
+                elem.serialize_to(image_);
+            for (const auto &pd : process_data_)
+                pd.serialize_to(image_);
+            for (const auto &prop : properties_)
+                prop.serialize_to(image_);
+            for (const auto &vp : value_presentations_)
+                vp.serialize_to(image_);
+            image_dirty_ = false;
+            echo::category("isobus.tc").debug("DDOP serialized: ", image_.size(), " bytes");
+            return image_;
         }
 
         // Validate the pool structure
@@ -99,14 +123,14 @@ namespace agrobus::isobus::tc {
             // Check that all parent references are valid
             for (const auto &elem : elements_) {
                 if (elem.parent_id != 0) {
-                    if (!object_exists(elem.parent_id)) {
+                    if (!contains(elem.parent_id)) {
                         return Result<void>::err(
                             Error(ErrorCode::PoolValidation, "element references non-existent parent"));
                     }
                 }
                 // Validate child object references
                 for (auto child_id : elem.child_objects) {
-                    if (!object_exists(child_id)) {
+                    if (!contains(child_id)) {
                         return Result<void>::err(
                             Error(ErrorCode::PoolValidation, "element references non-existent child object"));
                     }
@@ -117,7 +141,7 @@ namespace agrobus::isobus::tc {
                 // Presentation IDs use ObjectID semantics. 0 means "unset" in builder-style code.
                 // Treat both 0 and 0xFFFF as "no presentation".
                 if (pd.presentation_object_id != 0xFFFF && pd.presentation_object_id != 0) {
-                    if (!vp_exists(pd.presentation_object_id)) {
+                    if (!value_presentation(pd.presentation_object_id)) {
                         return Result<void>::err(Error(ErrorCode::PoolValidation,
                                                        "process data references non-existent presentation object"));
                     }
@@ -127,7 +151,7 @@ namespace agrobus::isobus::tc {
             for (const auto &prop : properties_) {
                 // Treat both 0 and 0xFFFF as "no presentation".
                 if (prop.presentation_object_id != 0xFFFF && prop.presentation_object_id != 0) {
-                    if (!vp_exists(prop.presentation_object_id)) {
+                    if (!value_presentation(prop.presentation_object_id)) {
                         return Result<void>::err(
                             Error(ErrorCode::PoolValidation, "property references non-existent presentation object"));
                     }
@@ -141,12 +165,46 @@ namespace agrobus::isobus::tc {
         const dp::Vector<DeviceElement> &elements() const noexcept { return elements_; }
         const dp::Vector<DeviceProcessData> &process_data() const noexcept { return process_data_; }
         const dp::Vector<DeviceProperty> &properties() const noexcept { return properties_; }
+        const dp::Vector<DeviceValuePresentation> &value_presentations() const noexcept {
+            return value_presentations_;
+        }
 
         usize object_count() const noexcept {
             return devices_.size() + elements_.size() + process_data_.size() + properties_.size() +
                    value_presentations_.size();
         }
 
+        // ─── Lookup ─────────────────────────────────────────────────────────────
+        // With duplicate IDs the first object added wins, like a linear scan.
+        dp::Optional<TCObjectType> object_type(ObjectID id) const {
+            const ObjectSlot *slot = find_slot(id);
+            return slot ? dp::Optional<TCObjectType>(slot->type) : dp::nullopt;
+        }
+        bool contains(ObjectID id) const { return find_slot(id) != nullptr; }
+
+        const DeviceObject *device(ObjectID id) const { return find<DeviceObject>(id, devices_); }
+        const DeviceElement *element(ObjectID id) const { return find<DeviceElement>(id, elements_); }
+        const DeviceProcessData *process_data(ObjectID id) const { return find<DeviceProcessData>(id, process_data_); }
+        const DeviceProperty *property(ObjectID id) const { return find<DeviceProperty>(id, properties_); }
+        const DeviceValuePresentation *value_presentation(ObjectID id) const {
+            return find<DeviceValuePresentation>(id, value_presentations_);
+        }
+
+        const DeviceElement *element_by_number(ElementNumber number) const {
+            ensure_index();
+            if (number >= element_numbers_.size() || element_numbers_[number] == NO_SLOT)
+                return nullptr;
+            return &elements_[element_numbers_[number]];
+        }
+
+        // Element whose child object list contains the given object
+        const DeviceElement *parent_element(ObjectID child) const {
+            ensure_index();
+            if (child >= parents_.size() || parents_[child] == NO_SLOT)
+                return nullptr;
+            return &elements_[parents_[child]];
+        }
+
         // Fluent API (chainable)
         DDOP &with_device(DeviceObject device) {
             add_device(std::move(device));
@@ -169,6 +227,51 @@ namespace agrobus::isobus::tc {
             return *this;
         }
 
+        // ─── Labels ─────────────────────────────────────────────────────────────
+        // Structure label derived from the pool content (FNV-1a 64 over the
+        // serialized pool with both device labels zeroed, first 7 bytes).
+        // Any change to the object tree yields a different label.
+        dp::Array<u8, 7> content_label() const {
+            u64 hash = 14695981039346656037ull;
+            auto mix = [&hash](const dp::Vector<u8> &bytes) {
+                for (auto b : bytes) {
+                    hash ^= b;
+                    hash *= 1099511628211ull;
+                }
+            };
+            for (auto dev : devices_) {
+                dev.structure_label = {};
+                dev.localization_label = {};
+                mix(dev.serialize());
+            }
+            for (const auto &elem : elements_)
+                mix(elem.serialize());
+            for (const auto &pd : process_data_)
+                mix(pd.serialize());
+            for (const auto &prop : properties_)
+                mix(prop.serialize());
+            for (const auto &vp : value_presentations_)
+                mix(vp.serialize());
+
+            dp::Array<u8, 7> label = {};
+            for (usize i = 0; i < label.size(); ++i)
+                label[i] = static_cast<u8>(hash >> (i * 8));
+            return label;
+        }
+
+        // Give a device without a structure label (all zero) the content label.
+        // Returns true if the label was set.
+        bool stamp_structure_label() {
+            if (devices_.empty())
+                return false;
+            for (auto b : devices_.front().structure_label)
+                if (b != 0)
+                    return false;
+            devices_.front().structure_label = content_label();
+            image_dirty_ = true;
+            return true;
+        }
+
         // ─── Deserialization ────────────────────────────────────────────────────
         // Parse a binary DDOP back into an object tree
         static Result<DDOP> deserialize(const dp::Vector<u8> &data) {
@@ -286,6 +389,7 @@ namespace agrobus::isobus::tc {
             properties_.clear();
             value_presentations_.clear();
             next_id_ = 0;
+            touch();
         }
 
       private:
@@ -513,79 +617,106 @@ namespace agrobus::isobus::tc {
 
             // Emit process data and properties that are children of this element
             for (auto child_id : elem.child_objects) {
-                for (const auto &pd : process_data_) {
-                    if (pd.id == child_id) {
-                        xml += "      <DPD A=\"DPD-";
-                        xml += dp::to_string(pd.id);
-                        xml += "\" B=\"";
-                        xml += dp::to_string(pd.ddi);
-                        xml += "\" C=\"";
-                        xml += dp::to_string(static_cast<u32>(pd.trigger_methods));
-                        xml += "\" D=\"";
-                        xml += xml_escape(pd.designator);
+                if (const auto *pd = process_data(child_id)) {
+                    xml += "      <DPD A=\"DPD-";
+                    xml += dp::to_string(pd->id);
+                    xml += "\" B=\"";
+                    xml += dp::to_string(pd->ddi);
+                    xml += "\" C=\"";
+                    xml += dp::to_string(static_cast<u32>(pd->trigger_methods));
+                    xml += "\" D=\"";
+                    xml += xml_escape(pd->designator);
+                    xml += "\"";
+                    if (pd->presentation_object_id != 0xFFFF) {
+                        xml += " E=\"DVP-";
+                        xml += dp::to_string(pd->presentation_object_id);
                         xml += "\"";
-                        if (pd.presentation_object_id != 0xFFFF) {
-                            xml += " E=\"DVP-";
-                            xml += dp::to_string(pd.presentation_object_id);
-                            xml += "\"";
-                        }
-                        xml += "/>\n";
                     }
-                }
-                for (const auto &prop : properties_) {
-                    if (prop.id == child_id) {
-                        xml += "      <DPT A=\"DPT-";
-                        xml += dp::to_string(prop.id);
-                        xml += "\" B=\"";
-                        xml += dp::to_string(prop.ddi);
-                        xml += "\" C=\"";
-                        xml += dp::to_string(prop.value);
-                        xml += "\" D=\"";
-                        xml += xml_escape(prop.designator);
+                    xml += "/>\n";
+                } else if (const auto *prop = property(child_id)) {
+                    xml += "      <DPT A=\"DPT-";
+                    xml += dp::to_string(prop->id);
+                    xml += "\" B=\"";
+                    xml += dp::to_string(prop->ddi);
+                    xml += "\" C=\"";
+                    xml += dp::to_string(prop->value);
+                    xml += "\" D=\"";
+                    xml += xml_escape(prop->designator);
+                    xml += "\"";
+                    if (prop->presentation_object_id != 0xFFFF) {
+                        xml += " E=\"DVP-";
+                        xml += dp::to_string(prop->presentation_object_id);
                         xml += "\"";
-                        if (prop.presentation_object_id != 0xFFFF) {
-                            xml += " E=\"DVP-";
-                            xml += dp::to_string(prop.presentation_object_id);
-                            xml += "\"";
-                        }
-                        xml += "/>\n";
                     }
+                    xml += "/>\n";
                 }
             }
 
             xml += "    </DET>\n";
             return xml;
         }
-        bool object_exists(ObjectID id) const {
-            for (const auto &d : devices_) {
-                if (d.id == id)
-                    return true;
-            }
-            for (const auto &e : elements_) {
-                if (e.id == id)
-                    return true;
-            }
-            for (const auto &pd : process_data_) {
-                if (pd.id == id)
-                    return true;
-            }
-            for (const auto &p : properties_) {
-                if (p.id == id)
-                    return true;
-            }
-            for (const auto &vp : value_presentations_) {
-                if (vp.id == id)
-                    return true;
+
+        // ─── Index helpers ─────────────────────────────────────────────────────
+        template <typename T> static TCObjectType kind_of() {
+            if constexpr (std::is_same_v<T, DeviceObject>)
+                return TCObjectType::Device;
+            else if constexpr (std::is_same_v<T, DeviceElement>)
+                return TCObjectType::DeviceElement;
+            else if constexpr (std::is_same_v<T, DeviceProcessData>)
+                return TCObjectType::DeviceProcessData;
+            else if constexpr (std::is_same_v<T, DeviceProperty>)
+                return TCObjectType::DeviceProperty;
+            else
+                return TCObjectType::DeviceValuePresentation;
+        }
+
+        template <typename T> const T *find(ObjectID id, const dp::Vector<T> &objects) const {
+            const ObjectSlot *slot = find_slot(id);
+            return (slot && slot->type == kind_of<T>()) ? &objects[slot->index] : nullptr;
+        }
+
+        const ObjectSlot *find_slot(ObjectID id) const {
+            ensure_index();
+            if (id >= id_slots_.size() || id_slots_[id].index == NO_SLOT)
+                return nullptr;
+            return &id_slots_[id];
+        }
+
+        template <typename T> void index_objects(const dp::Vector<T> &objects) const {
+            for (usize i = 0; i < objects.size(); ++i) {
+                ObjectID id = objects[i].id;
+                if (id >= id_slots_.size())
+                    id_slots_.resize(static_cast<usize>(id) + 1);
+                if (id_slots_[id].index == NO_SLOT)
+                    id_slots_[id] = ObjectSlot{static_cast<u32>(i), kind_of<T>()};
             }
-            return false;
         }
 
-        bool vp_exists(ObjectID id) const {
-            for (const auto &vp : value_presentations_) {
-                if (vp.id == id)
-                    return true;
+        void ensure_index() const {
+            if (!index_dirty_)
+                return;
+            id_slots_.clear();
+            element_numbers_.clear();
+            parents_.clear();
+            index_objects(devices_);
+            index_objects(elements_);
+            index_objects(process_data_);
+            index_objects(properties_);
+            index_objects(value_presentations_);
+            for (usize i = 0; i < elements_.size(); ++i) {
+                const auto &elem = elements_[i];
+                if (elem.number >= element_numbers_.size())
+                    element_numbers_.resize(static_cast<usize>(elem.number) + 1, NO_SLOT);
+                if (element_numbers_[elem.number] == NO_SLOT)
+                    element_numbers_[elem.number] = static_cast<u32>(i);
+                for (auto child : elem.child_objects) {
+                    if (child >= parents_.size())
+                        parents_.resize(static_cast<usize>(child) + 1, NO_SLOT);
+                    if (parents_[child] == NO_SLOT)
+                        parents_[child] = static_cast<u32>(i);
+                }
             }
-            return false;
+            index_dirty_ = false;
         }
     };
 
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "ddop.hpp"
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/types.hpp>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+#include <filesystem>
+#include <fstream>
+
+namespace agrobus::isobus::tc {
+    using namespace agrobus::net;
+
+    // ─── Cached client pool ──────────────────────────────────────────────────────
+    struct CachedDDOP {
+        dp::Vector<u8> data; // serialized pool as transferred
+        DDOP ddop;
+        dp::Array<u8, 7> structure_label = {};
+        dp::Array<u8, 7> localization_label = {};
+        u64 last_used = 0;
+    };
+
+    // ─── DDOP cache ──────────────────────────────────────────────────────────────
+    // Device descriptor pools a Task Controller has seen, keyed by the client's
+    // NAME, so a client that reconnects with matching structure and localization
+    // labels can activate without transferring its DDOP again. Least recently
+    // used pools are evicted beyond the capacity; save()/load() keep the cache
+    // across a TC restart.
+    class DDOPCache {
+        dp::Map<u64, CachedDDOP> entries_;
+        usize capacity_ = 16;
+        u64 tick_ = 0;
+        u64 hits_ = 0;
+        u64 stores_ = 0;
+
+        static constexpr u32 FILE_VERSION = 1;
+
+        void evict() {
+            while (entries_.size() > capacity_) {
+                auto oldest = entries_.begin();
+                for (auto it = entries_.begin(); it != entries_.end(); ++it)
+                    if (it->second.last_used < oldest->second.last_used)
+                        oldest = it;
+                echo::category("isobus.tc.cache").debug("evicting DDOP of NAME ", oldest->first);
+                entries_.erase(oldest);
+            }
+        }
+
+        template <typename T> static void put_raw(std::ofstream &file, const T &v) {
+            file.write(reinterpret_cast<const char *>(&v), sizeof(T));
+        }
+        template <typename T> static bool get_raw(std::ifstream &file, T &v) {
+            return static_cast<bool>(file.read(reinterpret_cast<char *>(&v), sizeof(T)));
+        }
+
+      public:
+        explicit DDOPCache(usize capacity = 16) : capacity_(capacity ? capacity : 1) {}
+
+        // Store a serialized pool. Fails if it does not parse or has no device.
+        Result<void> store(u64 name, dp::Vector<u8> data) {
+            auto parsed = DDOP::deserialize(data);
+            if (!parsed.is_ok())
+                return Result<void>::err(parsed.error());
+            if (parsed.value().devices().empty())
+                return Result<void>::err(Error::invalid_state("DDOP has no device object"));
+
+            CachedDDOP entry;
+            entry.ddop = std::move(parsed.value());
+            entry.structure_label = entry.ddop.devices().front().structure_label;
+            entry.localization_label = entry.ddop.devices().front().localization_label;
+            entry.data = std::move(data);
+            entry.last_used = ++tick_;
+            entries_[name] = std::move(entry);
+            ++stores_;
+            evict();
+            return {};
+        }
+
+        // Look up and mark as recently used
+        const CachedDDOP *find(u64 name) {
+            auto it = entries_.find(name);
+            if (it == entries_.end())
+                return nullptr;
+            it->second.last_used = ++tick_;
+            ++hits_;
+            return &it->second;
+        }
+
+        bool contains(u64 name) const { return entries_.find(name) != entries_.end(); }
+        bool remove(u64 name) { return entries_.erase(name) > 0; }
+        void clear() { entries_.clear(); }
+
+        usize size() const noexcept { return entries_.size(); }
+        usize capacity() const noexcept { return capacity_; }
+        u64 hits() const noexcept { return hits_; }
+        u64 stores() const noexcept { return stores_; }
+
+        void set_capacity(usize capacity) {
+            capacity_ = capacity ? capacity : 1;
+            evict();
+        }
+
+        // ─── Persistence ─────────────────────────────────────────────────────────
+        // [magic "TCDC"][version u32][count u32] count x [name u64][size u32][pool bytes]
+        Result<void> save(const std::filesystem::path &path) const {
+            auto tmp = path;
+            tmp += ".tmp";
+            try {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file)
+                    return Result<void>::err(Error::invalid_state("cannot write DDOP cache"));
+                file.write("TCDC", 4);
+                put_raw(file, FILE_VERSION);
+                put_raw(file, static_cast<u32>(entries_.size()));
+                for (const auto &[name, entry] : entries_) {
+                    put_raw(file, name);
+                    put_raw(file, static_cast<u32>(entry.data.size()));
+                    file.write(reinterpret_cast<const char *>(entry.data.data()),
+                               static_cast<std::streamsize>(entry.data.size()));
+                }
+                file.close();
+                if (!file)
+                    return Result<void>::err(Error::invalid_state("cannot write DDOP cache"));
+                std::filesystem::rename(tmp, path);
+            } catch (...) {
+                return Result<void>::err(Error::invalid_state("cannot write DDOP cache"));
+            }
+            return {};
+        }
+
+        // Returns the number of pools loaded; a truncated tail keeps what came before
+        Result<u32> load(const std::filesystem::path &path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+                return Result<u32>::err(Error::invalid_state("cannot open DDOP cache"));
+            char magic[4];
+            u32 version = 0;
+            u32 count = 0;
+            if (!file.read(magic, 4) || std::string(magic, 4) != "TCDC" || !get_raw(file, version) ||
+                version != FILE_VERSION || !get_raw(file, count))
+                return Result<u32>::err(Error::invalid_state("not a DDOP cache file"));
+
+            u32 loaded = 0;
+            for (u32 i = 0; i < count; ++i) {
+                u64 name = 0;
+                u32 size = 0;
+                if (!get_raw(file, name) || !get_raw(file, size))
+                    break;
+                dp::Vector<u8> data(size);
+                if (!file.read(reinterpret_cast<char *>(data.data()), size))
+                    break;
+                if (store(name, std::move(data)).is_ok())
+                    ++loaded;
+            }
+            echo::category("isobus.tc.cache").info("loaded ", loaded, " cached DDOPs");
+            return Result<u32>::ok(loaded);
+        }
+    };
+
+} // namespace agrobus::isobus::tc
@@ -75,17 +75,13 @@ namespace agrobus::isobus::tc {
 
                     // Find width property
                     for (auto child_id : elem.child_objects) {
-                        for (const auto &prop : ddop.properties()) {
-                            if (prop.id == child_id && prop.ddi == ddi::ACTUAL_WORKING_WIDTH) {
-                                section.width_mm = prop.value;
-                            }
-                        }
-                        for (const auto &prop : ddop.properties()) {
-                            if (prop.id == child_id && prop.ddi == ddi::MAXIMUM_WORKING_WIDTH) {
-                                if (section.width_mm == 0)
-                                    section.width_mm = prop.value;
-                            }
-                        }
+                        const auto *prop = ddop.property(child_id);
+                        if (!prop)
+                            continue;
+                        if (prop->ddi == ddi::ACTUAL_WORKING_WIDTH)
+                            section.width_mm = prop->value;
+                        else if (prop->ddi == ddi::MAXIMUM_WORKING_WIDTH && section.width_mm == 0)
+                            section.width_mm = prop->value;
                     }
 
                     geo.sections.push_back(std::move(section));
@@ -152,26 +148,21 @@ namespace agrobus::isobus::tc {
 
         // Find the device element containing a specific process data or property
         static dp::Optional<const DeviceElement *> find_parent_element(const DDOP &ddop, ObjectID child_id) {
-            for (const auto &elem : ddop.elements()) {
-                for (auto cid : elem.child_objects) {
-                    if (cid == child_id)
-                        return &elem;
-                }
-            }
+            if (const auto *elem = ddop.parent_element(child_id))
+                return elem;
             return dp::nullopt;
         }
 
       private:
         static void extract_offsets(const DDOP &ddop, const DeviceElement &elem, i32 &x_mm, i32 &y_mm) {
             for (auto child_id : elem.child_objects) {
-                for (const auto &prop : ddop.properties()) {
-                    if (prop.id == child_id) {
-                        if (prop.ddi == ddi::DEVICE_ELEMENT_OFFSET_X || prop.ddi == ddi::CONNECTOR_PIVOT_X_OFFSET) {
-                            x_mm = prop.value;
-                        } else if (prop.ddi == ddi::DEVICE_ELEMENT_OFFSET_Y) {
-                            y_mm = prop.value;
-                        }
-                    }
+                const auto *prop = ddop.property(child_id);
+                if (!prop)
+                    continue;
+                if (prop->ddi == ddi::DEVICE_ELEMENT_OFFSET_X || prop->ddi == ddi::CONNECTOR_PIVOT_X_OFFSET) {
+                    x_mm = prop->value;
+                } else if (prop->ddi == ddi::DEVICE_ELEMENT_OFFSET_Y) {
+                    y_mm = prop->value;
                 }
             }
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "objects.hpp"
+#include "prescription_index.hpp"
 #include "server_options.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/control_function.hpp>
@@ -33,27 +34,30 @@ namespace agrobus::isobus::tc {
         u64 timestamp_us = 0;
     };
 
-    struct PrescriptionZone {
-        dp::Vector<concord::earth::WGS> boundary; // Polygon vertices
-        i32 application_rate = 0;                 // Rate value (DDI-dependent units)
-    };
-
-    struct PrescriptionMap {
-        dp::String structure_label;
-        dp::Vector<PrescriptionZone> zones;
-    };
-
     // ─── TC-GEO Interface ────────────────────────────────────────────────────────
     // Position data arrives via GNSS PGNs (129025/129027). The TC-GEO interface
     // uses standard TC process data DDIs to communicate position to the TC server,
-    // and evaluates prescription maps to determine application rates.
+    // and evaluates prescription maps to determine application rates. Polygon
+    // maps are looked up through a PrescriptionIndex rebuilt on first use after
+    // a change; raster maps are consulted after all polygon maps. With a look-
+    // ahead set, rates are evaluated where the implement will be once the
+    // actuator has responded (position + speed x latency along the heading).
     class TCGEOInterface {
         IsoNet &net_;
         InternalCF *cf_;
         dp::Vector<PrescriptionMap> maps_;
+        dp::Vector<RasterPrescription> rasters_;
+        mutable PrescriptionIndex index_;
+        mutable bool index_dirty_ = false;
         dp::Optional<GeoPoint> current_position_;
         dp::Optional<i32> last_rate_;
 
+        // Motion for look-ahead: from COG/SOG when available, else from fixes
+        u32 look_ahead_ms_ = 0;
+        f64 speed_mps_ = 0.0;
+        f64 heading_rad_ = 0.0;
+        bool cog_sog_seen_ = false;
+
       public:
         TCGEOInterface(IsoNet &net, InternalCF *cf) : net_(net), cf_(cf) {}
 
@@ -63,12 +67,15 @@ namespace agrobus::isobus::tc {
             }
             // Listen for GNSS position updates (PGN 129025 - Position Rapid Update)
             net_.register_pgn_callback(PGN_GNSS_POSITION, [this](const Message &msg) { handle_gnss_position(msg); });
+            net_.register_pgn_callback(PGN_GNSS_COG_SOG, [this](const Message &msg) { handle_cog_sog(msg); });
             echo::category("isobus.tc.geo").info("TC-GEO interface initialized");
             return {};
         }
 
         // ─── Position from GNSS ────────────────────────────────────────────────────
         Result<void> set_position(const GeoPoint &position) {
+            if (!cog_sog_seen_ && current_position_.has_value())
+                derive_motion(*current_position_, position);
             current_position_ = position;
             echo::category("isobus.tc.geo")
                 .trace("position set: lat=", position.position.latitude, " lon=", position.position.longitude);
@@ -116,19 +123,47 @@ namespace agrobus::isobus::tc {
             echo::category("isobus.tc.geo")
                 .info("Prescription map added: ", map.structure_label, " zones=", map.zones.size());
             maps_.push_back(std::move(map));
+            index_dirty_ = true;
+            return {};
+        }
+
+        Result<void> add_raster_prescription(RasterPrescription raster) {
+            if (!raster.valid())
+                return Result<void>::err(Error::invalid_state("raster size does not match its rates"));
+            echo::category("isobus.tc.geo")
+                .info("Raster prescription added: ", raster.structure_label, " ", raster.columns, "x", raster.rows);
+            rasters_.push_back(std::move(raster));
             return {};
         }
 
         Result<void> clear_prescription_maps() {
             maps_.clear();
+            rasters_.clear();
+            index_.clear();
+            index_dirty_ = false;
             echo::category("isobus.tc.geo").trace("prescription maps cleared");
             return {};
         }
 
         const dp::Vector<PrescriptionMap> &prescription_maps() const noexcept { return maps_; }
+        const dp::Vector<RasterPrescription> &raster_prescriptions() const noexcept { return rasters_; }
 
         // Check if a position falls within any prescription zone and return rate
         dp::Optional<i32> get_rate_at_position(const concord::earth::WGS &pos) const {
+            if (index_dirty_) {
+                index_.build(maps_);
+                index_dirty_ = false;
+            }
+            if (auto rate = index_.rate_at(pos))
+                return rate;
+            for (const auto &raster : rasters_)
+                if (auto rate = raster.rate_at(pos))
+                    return rate;
+            return dp::nullopt;
+        }
+
+        // Unindexed reference lookup: every zone of every map in order
+        dp::Optional<i32> get_rate_at_position_linear(const concord::earth::WGS &pos) const {
             for (const auto &map : maps_) {
                 for (const auto &zone : map.zones) {
                     if (point_in_polygon(pos, zone.boundary)) {
@@ -136,11 +171,44 @@ namespace agrobus::isobus::tc {
                     }
                 }
             }
+            for (const auto &raster : rasters_)
+                if (auto rate = raster.rate_at(pos))
+                    return rate;
             return dp::nullopt;
         }
 
         dp::Optional<GeoPoint> current_position() const noexcept { return current_position_; }
 
+        // ─── Look-ahead ──────────────────────────────────────────────────────────
+        // Actuator latency to compensate; 0 evaluates at the current position
+        void set_look_ahead(u32 latency_ms) { look_ahead_ms_ = latency_ms; }
+        u32 look_ahead() const noexcept { return look_ahead_ms_; }
+
+        // Explicit ground speed and heading (clockwise from north); disables
+        // deriving motion from consecutive fixes
+        void set_motion(f64 speed_mps, f64 heading_rad) {
+            speed_mps_ = speed_mps;
+            heading_rad_ = heading_rad;
+            cog_sog_seen_ = true;
+        }
+        f64 speed() const noexcept { return speed_mps_; }
+        f64 heading() const noexcept { return heading_rad_; }
+
+        dp::Optional<concord::earth::WGS> look_ahead_position() const {
+            if (!current_position_.has_value())
+                return dp::nullopt;
+            if (look_ahead_ms_ == 0 || speed_mps_ <= 0.0)
+                return current_position_->position;
+            return project_ahead(current_position_->position, heading_rad_, speed_mps_, look_ahead_ms_ / 1000.0);
+        }
+
+        dp::Optional<i32> rate_ahead() const {
+            auto pos = look_ahead_position();
+            if (!pos.has_value())
+                return dp::nullopt;
+            return get_rate_at_position(*pos);
+        }
+
         // ─── Events ──────────────────────────────────────────────────────────────
         Event<const GeoPoint &> on_position_update;
         Event<i32> on_application_rate_changed; // New rate based on position
@@ -149,7 +217,7 @@ namespace agrobus::isobus::tc {
         void update(u32 /*elapsed_ms*/) {
             // Check current position against prescription maps
             if (current_position_.has_value()) {
-                auto rate = get_rate_at_position(current_position_->position);
+                auto rate = rate_ahead();
                 if (rate.has_value() && (!last_rate_.has_value() || *last_rate_ != *rate)) {
                     last_rate_ = *rate;
                     on_application_rate_changed.emit(*rate);
@@ -179,6 +247,29 @@ namespace agrobus::isobus::tc {
             set_position(point);
         }
 
+        // PGN 129026: COG u16 1e-4 rad at bytes 2-3, SOG u16 0.01 m/s at bytes 4-5
+        void handle_cog_sog(const Message &msg) {
+            if (msg.data.size() < 6)
+                return;
+            u16 cog = static_cast<u16>(msg.data[2] | (msg.data[3] << 8));
+            u16 sog = static_cast<u16>(msg.data[4] | (msg.data[5] << 8));
+            if (cog == 0xFFFF || sog == 0xFFFF)
+                return;
+            set_motion(sog * 0.01, cog * 1e-4);
+        }
+
+        void derive_motion(const GeoPoint &from, const GeoPoint &to) {
+            if (to.timestamp_us <= from.timestamp_us)
+                return;
+            LocalFrame frame(from.position.latitude, from.position.longitude);
+            f64 de = frame.east(to.position.longitude);
+            f64 dn = frame.north(to.position.latitude);
+            f64 dt = (to.timestamp_us - from.timestamp_us) * 1e-6;
+            speed_mps_ = std::sqrt(de * de + dn * dn) / dt;
+            if (speed_mps_ > 0.0)
+                heading_rad_ = std::atan2(de, dn);
+        }
+
         // Ray-casting point-in-polygon test
         static bool point_in_polygon(const concord::earth::WGS &point, const dp::Vector<concord::earth::WGS> &polygon) {
             if (polygon.size() < 3)
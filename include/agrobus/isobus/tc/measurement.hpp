@@ -0,0 +1,244 @@
+#pragma once
+
+#include "objects.hpp"
+#include "server_options.hpp"
+#include <agrobus/net/types.hpp>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+
+namespace agrobus::isobus::tc {
+    using namespace agrobus::net;
+
+    // ─── Measurement subscription ────────────────────────────────────────────────
+    // One (element, DDI) pair the TC asked to be reported on. ISO 11783-10 lets a
+    // server combine several measurement commands on the same pair; each one just
+    // switches on another trigger.
+    struct MeasurementSubscription {
+        ElementNumber element = 0;
+        DDI ddi = 0;
+        u32 time_interval_ms = 0;     // 0 = off
+        u32 distance_interval_mm = 0; // 0 = off
+        dp::Optional<i32> min_threshold;    // report while value > min
+        dp::Optional<i32> max_threshold;    // report while value < max
+        dp::Optional<i32> change_threshold; // report on |value - last sent| >= threshold
+
+        // Runtime state
+        u64 next_time_ms = 0;
+        u64 next_distance_mm = 0;
+        i32 value = 0;
+        bool has_value = false;
+        i32 last_sent = 0;
+        bool sent = false;
+        bool in_window = false;
+
+        bool has_value_triggers() const noexcept {
+            return min_threshold.has_value() || max_threshold.has_value() || change_threshold.has_value();
+        }
+    };
+
+    // ─── Measurement statistics ──────────────────────────────────────────────────
+    struct MeasurementStats {
+        u64 commands = 0;
+        u64 scans = 0; // full passes over the subscription list
+        u64 fired_time = 0;
+        u64 fired_distance = 0;
+        u64 fired_threshold = 0;
+        u64 fired_change = 0;
+
+        u64 fired() const noexcept { return fired_time + fired_distance + fired_threshold + fired_change; }
+    };
+
+    // ─── Measurement trigger engine ──────────────────────────────────────────────
+    // Stores measurement subscriptions and decides when a Value message is due.
+    // Threshold and on-change triggers are evaluated only for the pair whose value
+    // was pushed with set_value(). Time and distance triggers keep the earliest
+    // deadline over all subscriptions, so advance() only scans the list on ticks
+    // where something is actually due.
+    //
+    // Threshold triggers are edge-triggered: a value is sent when it enters the
+    // window formed by the min/max thresholds, not on every update inside it.
+    class MeasurementEngine {
+        dp::Vector<MeasurementSubscription> subs_;
+        dp::Map<u32, u32> index_; // (element << 16 | ddi) -> subs_ index
+        u64 now_ms_ = 0;
+        u64 distance_mm_ = 0;
+        u64 next_time_due_ = NEVER;
+        u64 next_distance_due_ = NEVER;
+        MeasurementStats stats_;
+
+        static u32 key(ElementNumber element, DDI ddi) noexcept { return (static_cast<u32>(element) << 16) | ddi; }
+
+        MeasurementSubscription &subscription(ElementNumber element, DDI ddi) {
+            auto it = index_.find(key(element, ddi));
+            if (it != index_.end())
+                return subs_[it->second];
+            index_[key(element, ddi)] = static_cast<u32>(subs_.size());
+            MeasurementSubscription sub;
+            sub.element = element;
+            sub.ddi = ddi;
+            subs_.push_back(sub);
+            return subs_.back();
+        }
+
+        bool window_contains(const MeasurementSubscription &sub, i32 value) const noexcept {
+            if (sub.min_threshold && !(value > *sub.min_threshold))
+                return false;
+            if (sub.max_threshold && !(value < *sub.max_threshold))
+                return false;
+            return sub.min_threshold.has_value() || sub.max_threshold.has_value();
+        }
+
+        template <typename Emit> void emit_value(MeasurementSubscription &sub, i32 value, Emit &emit) {
+            sub.last_sent = value;
+            sub.sent = true;
+            emit(sub.element, sub.ddi, value);
+        }
+
+      public:
+        static constexpr u64 NEVER = ~0ull;
+
+        // Apply a measurement command. Returns false for commands that are not
+        // measurement commands. A zero interval switches that trigger off.
+        bool configure(ProcessDataCommands cmd, ElementNumber element, DDI ddi, i32 value) {
+            MeasurementSubscription *sub = nullptr;
+            switch (cmd) {
+            case ProcessDataCommands::MeasurementTimeInterval:
+                sub = &subscription(element, ddi);
+                sub->time_interval_ms = value > 0 ? static_cast<u32>(value) : 0;
+                sub->next_time_ms = now_ms_ + sub->time_interval_ms;
+                if (sub->time_interval_ms && sub->next_time_ms < next_time_due_)
+                    next_time_due_ = sub->next_time_ms;
+                break;
+            case ProcessDataCommands::MeasurementDistanceInterval:
+                sub = &subscription(element, ddi);
+                sub->distance_interval_mm = value > 0 ? static_cast<u32>(value) : 0;
+                sub->next_distance_mm = distance_mm_ + sub->distance_interval_mm;
+                if (sub->distance_interval_mm && sub->next_distance_mm < next_distance_due_)
+                    next_distance_due_ = sub->next_distance_mm;
+                break;
+            case ProcessDataCommands::MeasurementMinimumWithinThreshold:
+                sub = &subscription(element, ddi);
+                sub->min_threshold = value;
+                sub->in_window = false;
+                break;
+            case ProcessDataCommands::MeasurementMaximumWithinThreshold:
+                sub = &subscription(element, ddi);
+                sub->max_threshold = value;
+                sub->in_window = false;
+                break;
+            case ProcessDataCommands::MeasurementChangeThreshold:
+                sub = &subscription(element, ddi);
+                sub->change_threshold = value < 0 ? -value : value;
+                break;
+            default:
+                return false;
+            }
+            ++stats_.commands;
+            echo::category("isobus.tc.measure")
+                .debug("cmd=", static_cast<u8>(cmd), " elem=", element, " ddi=", ddi, " value=", value);
+            return true;
+        }
+
+        // Drop all subscriptions (pool deactivated or TC lost)
+        void clear() {
+            subs_.clear();
+            index_.clear();
+            next_time_due_ = NEVER;
+            next_distance_due_ = NEVER;
+        }
+
+        const MeasurementSubscription *find(ElementNumber element, DDI ddi) const {
+            auto it = index_.find(key(element, ddi));
+            return it != index_.end() ? &subs_[it->second] : nullptr;
+        }
+
+        const dp::Vector<MeasurementSubscription> &subscriptions() const noexcept { return subs_; }
+        usize size() const noexcept { return subs_.size(); }
+        u64 now_ms() const noexcept { return now_ms_; }
+        u64 distance_mm() const noexcept { return distance_mm_; }
+        u64 next_time_due() const noexcept { return next_time_due_; }
+        const MeasurementStats &stats() const noexcept { return stats_; }
+
+        // Push the current value of a pair. Fires threshold / on-change triggers
+        // through emit(element, ddi, value). Returns true if a value was emitted.
+        template <typename Emit> bool set_value(ElementNumber element, DDI ddi, i32 value, Emit &&emit) {
+            auto it = index_.find(key(element, ddi));
+            if (it == index_.end())
+                return false;
+            auto &sub = subs_[it->second];
+            sub.value = value;
+            sub.has_value = true;
+            if (!sub.has_value_triggers())
+                return false;
+
+            bool inside = window_contains(sub, value);
+            bool entered = inside && !sub.in_window;
+            sub.in_window = inside;
+
+            bool changed = false;
+            if (sub.change_threshold) {
+                i64 delta = static_cast<i64>(value) - sub.last_sent;
+                i64 threshold = *sub.change_threshold > 0 ? *sub.change_threshold : 1;
+                changed = !sub.sent || delta >= threshold || -delta >= threshold;
+            }
+
+            if (!entered && !changed)
+                return false;
+            ++(entered ? stats_.fired_threshold : stats_.fired_change);
+            emit_value(sub, value, emit);
+            return true;
+        }
+
+        // Advance time and travelled distance, firing due time / distance triggers.
+        // fetch(element, ddi) -> dp::Optional<i32> supplies a value for pairs that
+        // never had one pushed. Returns the number of values emitted.
+        template <typename Fetch, typename Emit>
+        usize advance(u32 elapsed_ms, u32 travelled_mm, Fetch &&fetch, Emit &&emit) {
+            now_ms_ += elapsed_ms;
+            distance_mm_ += travelled_mm;
+            if (now_ms_ < next_time_due_ && distance_mm_ < next_distance_due_)
+                return 0;
+
+            ++stats_.scans;
+            usize fired = 0;
+            next_time_due_ = NEVER;
+            next_distance_due_ = NEVER;
+            for (auto &sub : subs_) {
+                bool time_due = sub.time_interval_ms && now_ms_ >= sub.next_time_ms;
+                bool distance_due = sub.distance_interval_mm && distance_mm_ >= sub.next_distance_mm;
+
+                if (time_due || distance_due) {
+                    dp::Optional<i32> value;
+                    if (sub.has_value)
+                        value = sub.value;
+                    else
+                        value = fetch(sub.element, sub.ddi);
+                    if (value) {
+                        emit_value(sub, *value, emit);
+                        ++fired;
+                        ++(time_due ? stats_.fired_time : stats_.fired_distance);
+                    }
+                }
+
+                // Re-arm from now when a deadline was missed by more than one period
+                if (time_due) {
+                    sub.next_time_ms += sub.time_interval_ms;
+                    if (sub.next_time_ms <= now_ms_)
+                        sub.next_time_ms = now_ms_ + sub.time_interval_ms;
+                }
+                if (distance_due) {
+                    sub.next_distance_mm += sub.distance_interval_mm;
+                    if (sub.next_distance_mm <= distance_mm_)
+                        sub.next_distance_mm = distance_mm_ + sub.distance_interval_mm;
+                }
+
+                if (sub.time_interval_ms && sub.next_time_ms < next_time_due_)
+                    next_time_due_ = sub.next_time_ms;
+                if (sub.distance_interval_mm && sub.next_distance_mm < next_distance_due_)
+                    next_distance_due_ = sub.next_distance_mm;
+            }
+            return fired;
+        }
+    };
+
+} // namespace agrobus::isobus::tc
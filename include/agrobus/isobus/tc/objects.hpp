@@ -79,29 +79,33 @@ namespace agrobus::isobus::tc {
 
         dp::Vector<u8> serialize() const {
             dp::Vector<u8> data;
-            data.push_back(static_cast<u8>(TCObjectType::Device));
+            serialize_to(data);
+            return data;
+        }
+
+        void serialize_to(dp::Vector<u8> &out) const {
+            out.push_back(static_cast<u8>(TCObjectType::Device));
             // Object ID
-            data.push_back(static_cast<u8>(id & 0xFF));
-            data.push_back(static_cast<u8>((id >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(id & 0xFF));
+            out.push_back(static_cast<u8>((id >> 8) & 0xFF));
             // Designator length + string
-            data.push_back(static_cast<u8>(designator.size()));
+            out.push_back(static_cast<u8>(designator.size()));
             for (char c : designator)
-                data.push_back(static_cast<u8>(c));
+                out.push_back(static_cast<u8>(c));
             // Software version
-            data.push_back(static_cast<u8>(software_version.size()));
+            out.push_back(static_cast<u8>(software_version.size()));
             for (char c : software_version)
-                data.push_back(static_cast<u8>(c));
+                out.push_back(static_cast<u8>(c));
             // Serial number
-            data.push_back(static_cast<u8>(serial_number.size()));
+            out.push_back(static_cast<u8>(serial_number.size()));
             for (char c : serial_number)
-                data.push_back(static_cast<u8>(c));
+                out.push_back(static_cast<u8>(c));
             // Structure label
             for (auto b : structure_label)
-                data.push_back(b);
+                out.push_back(b);
             // Localization label
             for (auto b : localization_label)
-                data.push_back(b);
-            return data;
+                out.push_back(b);
         }
     };
 
@@ -146,26 +150,30 @@ namespace agrobus::isobus::tc {
 
         dp::Vector<u8> serialize() const {
             dp::Vector<u8> data;
-            data.push_back(static_cast<u8>(TCObjectType::DeviceElement));
-            data.push_back(static_cast<u8>(id & 0xFF));
-            data.push_back(static_cast<u8>((id >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(type));
-            data.push_back(static_cast<u8>(designator.size()));
+            serialize_to(data);
+            return data;
+        }
+
+        void serialize_to(dp::Vector<u8> &out) const {
+            out.push_back(static_cast<u8>(TCObjectType::DeviceElement));
+            out.push_back(static_cast<u8>(id & 0xFF));
+            out.push_back(static_cast<u8>((id >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(type));
+            out.push_back(static_cast<u8>(designator.size()));
             for (char c : designator)
-                data.push_back(static_cast<u8>(c));
-            data.push_back(static_cast<u8>(number & 0xFF));
-            data.push_back(static_cast<u8>((number >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(parent_id & 0xFF));
-            data.push_back(static_cast<u8>((parent_id >> 8) & 0xFF));
+                out.push_back(static_cast<u8>(c));
+            out.push_back(static_cast<u8>(number & 0xFF));
+            out.push_back(static_cast<u8>((number >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(parent_id & 0xFF));
+            out.push_back(static_cast<u8>((parent_id >> 8) & 0xFF));
             // Number of child object references
             u16 num_children = static_cast<u16>(child_objects.size());
-            data.push_back(static_cast<u8>(num_children & 0xFF));
-            data.push_back(static_cast<u8>((num_children >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(num_children & 0xFF));
+            out.push_back(static_cast<u8>((num_children >> 8) & 0xFF));
             for (auto obj_id : child_objects) {
-                data.push_back(static_cast<u8>(obj_id & 0xFF));
-                data.push_back(static_cast<u8>((obj_id >> 8) & 0xFF));
+                out.push_back(static_cast<u8>(obj_id & 0xFF));
+                out.push_back(static_cast<u8>((obj_id >> 8) & 0xFF));
             }
-            return data;
         }
     };
 
@@ -205,19 +213,23 @@ namespace agrobus::isobus::tc {
 
         dp::Vector<u8> serialize() const {
             dp::Vector<u8> data;
-            data.push_back(static_cast<u8>(TCObjectType::DeviceProcessData));
-            data.push_back(static_cast<u8>(id & 0xFF));
-            data.push_back(static_cast<u8>((id >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(ddi & 0xFF));
-            data.push_back(static_cast<u8>((ddi >> 8) & 0xFF));
-            data.push_back(trigger_methods);
-            data.push_back(static_cast<u8>(presentation_object_id & 0xFF));
-            data.push_back(static_cast<u8>((presentation_object_id >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(designator.size()));
-            for (char c : designator)
-                data.push_back(static_cast<u8>(c));
+            serialize_to(data);
             return data;
         }
+
+        void serialize_to(dp::Vector<u8> &out) const {
+            out.push_back(static_cast<u8>(TCObjectType::DeviceProcessData));
+            out.push_back(static_cast<u8>(id & 0xFF));
+            out.push_back(static_cast<u8>((id >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(ddi & 0xFF));
+            out.push_back(static_cast<u8>((ddi >> 8) & 0xFF));
+            out.push_back(trigger_methods);
+            out.push_back(static_cast<u8>(presentation_object_id & 0xFF));
+            out.push_back(static_cast<u8>((presentation_object_id >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(designator.size()));
+            for (char c : designator)
+                out.push_back(static_cast<u8>(c));
+        }
     };
 
     // ─── Device property ─────────────────────────────────────────────────────────
@@ -252,22 +264,26 @@ namespace agrobus::isobus::tc {
 
         dp::Vector<u8> serialize() const {
             dp::Vector<u8> data;
-            data.push_back(static_cast<u8>(TCObjectType::DeviceProperty));
-            data.push_back(static_cast<u8>(id & 0xFF));
-            data.push_back(static_cast<u8>((id >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(ddi & 0xFF));
-            data.push_back(static_cast<u8>((ddi >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(value & 0xFF));
-            data.push_back(static_cast<u8>((value >> 8) & 0xFF));
-            data.push_back(static_cast<u8>((value >> 16) & 0xFF));
-            data.push_back(static_cast<u8>((value >> 24) & 0xFF));
-            data.push_back(static_cast<u8>(presentation_object_id & 0xFF));
-            data.push_back(static_cast<u8>((presentation_object_id >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(designator.size()));
-            for (char c : designator)
-                data.push_back(static_cast<u8>(c));
+            serialize_to(data);
             return data;
         }
+
+        void serialize_to(dp::Vector<u8> &out) const {
+            out.push_back(static_cast<u8>(TCObjectType::DeviceProperty));
+            out.push_back(static_cast<u8>(id & 0xFF));
+            out.push_back(static_cast<u8>((id >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(ddi & 0xFF));
+            out.push_back(static_cast<u8>((ddi >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(value & 0xFF));
+            out.push_back(static_cast<u8>((value >> 8) & 0xFF));
+            out.push_back(static_cast<u8>((value >> 16) & 0xFF));
+            out.push_back(static_cast<u8>((value >> 24) & 0xFF));
+            out.push_back(static_cast<u8>(presentation_object_id & 0xFF));
+            out.push_back(static_cast<u8>((presentation_object_id >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(designator.size()));
+            for (char c : designator)
+                out.push_back(static_cast<u8>(c));
+        }
     };
 
     // ─── Device value presentation ───────────────────────────────────────────────
@@ -302,25 +318,29 @@ namespace agrobus::isobus::tc {
 
         dp::Vector<u8> serialize() const {
             dp::Vector<u8> data;
-            data.push_back(static_cast<u8>(TCObjectType::DeviceValuePresentation));
-            data.push_back(static_cast<u8>(id & 0xFF));
-            data.push_back(static_cast<u8>((id >> 8) & 0xFF));
-            data.push_back(static_cast<u8>(offset & 0xFF));
-            data.push_back(static_cast<u8>((offset >> 8) & 0xFF));
-            data.push_back(static_cast<u8>((offset >> 16) & 0xFF));
-            data.push_back(static_cast<u8>((offset >> 24) & 0xFF));
+            serialize_to(data);
+            return data;
+        }
+
+        void serialize_to(dp::Vector<u8> &out) const {
+            out.push_back(static_cast<u8>(TCObjectType::DeviceValuePresentation));
+            out.push_back(static_cast<u8>(id & 0xFF));
+            out.push_back(static_cast<u8>((id >> 8) & 0xFF));
+            out.push_back(static_cast<u8>(offset & 0xFF));
+            out.push_back(static_cast<u8>((offset >> 8) & 0xFF));
+            out.push_back(static_cast<u8>((offset >> 16) & 0xFF));
+            out.push_back(static_cast<u8>((offset >> 24) & 0xFF));
             // Scale as IEEE 754 float
             u32 scale_bits;
             std::memcpy(&scale_bits, &scale, sizeof(u32));
-            data.push_back(static_cast<u8>(scale_bits & 0xFF));
-            data.push_back(static_cast<u8>((scale_bits >> 8) & 0xFF));
-            data.push_back(static_cast<u8>((scale_bits >> 16) & 0xFF));
-            data.push_back(static_cast<u8>((scale_bits >> 24) & 0xFF));
-            data.push_back(decimal_digits);
-            data.push_back(static_cast<u8>(unit_designator.size()));
+            out.push_back(static_cast<u8>(scale_bits & 0xFF));
+            out.push_back(static_cast<u8>((scale_bits >> 8) & 0xFF));
+            out.push_back(static_cast<u8>((scale_bits >> 16) & 0xFF));
+            out.push_back(static_cast<u8>((scale_bits >> 24) & 0xFF));
+            out.push_back(decimal_digits);
+            out.push_back(static_cast<u8>(unit_designator.size()));
             for (char c : unit_designator)
-                data.push_back(static_cast<u8>(c));
-            return data;
+                out.push_back(static_cast<u8>(c));
         }
     };
 
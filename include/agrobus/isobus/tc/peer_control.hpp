@@ -1,6 +1,7 @@
 #pragma once
 
 #include "objects.hpp"
+#include "server_options.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/control_function.hpp>
 #include <agrobus/net/error.hpp>
@@ -9,8 +10,10 @@
 #include <agrobus/net/message.hpp>
 #include <agrobus/net/network_manager.hpp>
 #include <agrobus/net/types.hpp>
+#include <algorithm>
 #include <datapod/datapod.hpp>
 #include <echo/echo.hpp>
+#include <functional>
 
 namespace agrobus::isobus::tc {
     using namespace agrobus::net;
@@ -19,14 +22,22 @@ namespace agrobus::isobus::tc {
     // Allows a TC server to assign process data elements on one device to control
     // elements on another device (peer-to-peer control without TC involvement).
 
+    // How the router forwards a source value to its destination
+    enum class PeerForwardMode : u8 {
+        OnChange, // as soon as the source value changes
+        FixedRate // latest source value every interval_ms
+    };
+
     struct PeerControlAssignment {
         ElementNumber source_element = 0;
         DDI source_ddi = 0;
         ElementNumber destination_element = 0;
         DDI destination_ddi = 0;
-        Address source_address = NULL_ADDRESS;
+        Address source_address = NULL_ADDRESS; // NULL_ADDRESS = the local control function
         Address destination_address = NULL_ADDRESS;
         bool active = false;
+        PeerForwardMode forward_mode = PeerForwardMode::OnChange;
+        u32 forward_interval_ms = 0; // FixedRate period
 
         PeerControlAssignment &from(ElementNumber elem, DDI ddi) {
             source_element = elem;
@@ -46,6 +57,15 @@ namespace agrobus::isobus::tc {
             destination_address = addr;
             return *this;
         }
+        PeerControlAssignment &on_change() {
+            forward_mode = PeerForwardMode::OnChange;
+            return *this;
+        }
+        PeerControlAssignment &every(u32 interval_ms) {
+            forward_mode = PeerForwardMode::FixedRate;
+            forward_interval_ms = interval_ms;
+            return *this;
+        }
     };
 
     class PeerControlInterface {
@@ -102,7 +122,12 @@ namespace agrobus::isobus::tc {
             return Result<void>::err(Error::invalid_state("assignment not found"));
         }
 
-        void clear_assignments() { assignments_.clear(); }
+        void clear_assignments() {
+            auto removed = std::move(assignments_);
+            assignments_.clear();
+            for (const auto &a : removed)
+                on_assignment_removed.emit(a);
+        }
 
         const dp::Vector<PeerControlAssignment> &assignments() const noexcept { return assignments_; }
 
@@ -131,4 +156,252 @@ namespace agrobus::isobus::tc {
         void update(u32 /*elapsed_ms*/) {}
     };
 
+    // ─── Peer control data path ──────────────────────────────────────────────────
+    // Forwards source process data straight to the assigned destination elements
+    // once assignments are active, so the TC is not in the control loop. Source
+    // values are picked up from the bus (Value messages an implement sends to the
+    // TC) or published locally; each becomes a Value command to the destination
+    // implement, which handles it like a TC setpoint.
+
+    struct PeerRouteStats {
+        u64 received = 0;   // source values seen
+        u64 forwarded = 0;  // values sent to the destination
+        u64 suppressed = 0; // on-change values equal to the last one sent
+        u64 send_errors = 0;
+        u64 latency_total_us = 0; // source arrival -> forward, summed over forwarded
+        u64 latency_max_us = 0;
+
+        f64 avg_latency_us() const noexcept {
+            return forwarded ? static_cast<f64>(latency_total_us) / static_cast<f64>(forwarded) : 0.0;
+        }
+    };
+
+    struct PeerRoute {
+        Address source_address = NULL_ADDRESS;
+        ElementNumber source_element = 0;
+        DDI source_ddi = 0;
+        Address destination_address = NULL_ADDRESS;
+        ElementNumber destination_element = 0;
+        DDI destination_ddi = 0;
+        PeerForwardMode mode = PeerForwardMode::OnChange;
+        u64 interval_us = 0;
+
+        i32 value = 0; // latest source value
+        bool has_value = false;
+        bool has_sent = false;
+        i32 sent_value = 0;
+        u64 arrived_us = 0; // router time the latest value arrived
+        u64 due_us = 0;     // next FixedRate send
+        PeerRouteStats stats;
+    };
+
+    class PeerControlRouter {
+        IsoNet &net_;
+        InternalCF *cf_;
+        PeerControlInterface &assignments_;
+        std::function<u64()> clock_;
+
+        // Sorted by source key; a source may fan out to several routes
+        dp::Vector<PeerRoute> routes_;
+        dp::Vector<u64> keys_;
+        dp::Vector<usize> fixed_rate_;
+        bool dirty_ = true;
+        u64 tick_us_ = 0;
+        PeerRouteStats totals_;
+        ListenerToken added_token_ = INVALID_TOKEN;
+        ListenerToken removed_token_ = INVALID_TOKEN;
+        ListenerToken changed_token_ = INVALID_TOKEN;
+
+        static u64 key(Address addr, ElementNumber element, DDI ddi) noexcept {
+            return (static_cast<u64>(addr) << 32) | (static_cast<u64>(element) << 16) | ddi;
+        }
+
+      public:
+        PeerControlRouter(IsoNet &net, InternalCF *cf, PeerControlInterface &assignments)
+            : net_(net), cf_(cf), assignments_(assignments) {
+            auto mark = [this](const PeerControlAssignment &) { dirty_ = true; };
+            added_token_ = assignments_.on_assignment_added.subscribe(mark);
+            removed_token_ = assignments_.on_assignment_removed.subscribe(mark);
+            changed_token_ = assignments_.on_assignment_state_changed.subscribe(mark);
+        }
+
+        ~PeerControlRouter() {
+            assignments_.on_assignment_added.unsubscribe(added_token_);
+            assignments_.on_assignment_removed.unsubscribe(removed_token_);
+            assignments_.on_assignment_state_changed.unsubscribe(changed_token_);
+        }
+
+        // The assignment listeners capture this router
+        PeerControlRouter(const PeerControlRouter &) = delete;
+        PeerControlRouter &operator=(const PeerControlRouter &) = delete;
+        PeerControlRouter(PeerControlRouter &&) = delete;
+        PeerControlRouter &operator=(PeerControlRouter &&) = delete;
+
+        Result<void> initialize() {
+            if (!cf_)
+                return Result<void>::err(Error::invalid_state("control function not set"));
+            net_.register_pgn_callback(PGN_ECU_TO_TC, [this](const Message &msg) { handle_value(msg); });
+            echo::category("isobus.tc.peer_control").info("Peer control router initialized");
+            return {};
+        }
+
+        // Microsecond clock for latency; defaults to the time advanced by update()
+        void set_clock(std::function<u64()> clock) { clock_ = std::move(clock); }
+
+        // Source value produced by this node itself
+        void publish(ElementNumber element, DDI ddi, i32 value) { route(cf_->address(), element, ddi, value); }
+
+        // First route fed by this source value, nullptr if none is active
+        const PeerRoute *find(Address source, ElementNumber element, DDI ddi) {
+            usize i = first_route(key(source, element, ddi));
+            return i < routes_.size() ? &routes_[i] : nullptr;
+        }
+
+        // Forward one source value; returns false if no active assignment uses it
+        bool route(Address source, ElementNumber element, DDI ddi, i32 value) {
+            u64 k = key(source, element, ddi);
+            usize first = first_route(k);
+            if (first == routes_.size())
+                return false;
+            u64 now = now_us();
+            for (usize i = first; i < keys_.size() && keys_[i] == k; ++i) {
+                auto &r = routes_[i];
+                r.value = value;
+                r.has_value = true;
+                r.arrived_us = now;
+                ++r.stats.received;
+                ++totals_.received;
+                if (r.mode != PeerForwardMode::OnChange)
+                    continue;
+                if (r.has_sent && r.sent_value == value) {
+                    ++r.stats.suppressed;
+                    ++totals_.suppressed;
+                    continue;
+                }
+                forward(r);
+            }
+            return true;
+        }
+
+        void update(u32 elapsed_ms) {
+            tick_us_ += static_cast<u64>(elapsed_ms) * 1000;
+            rebuild();
+            u64 now = now_us();
+            for (usize i : fixed_rate_) {
+                auto &r = routes_[i];
+                if (!r.has_value || now < r.due_us)
+                    continue;
+                forward(r);
+                // Stay on the fixed grid unless a whole period was missed
+                r.due_us = r.due_us + r.interval_us > now ? r.due_us + r.interval_us : now + r.interval_us;
+            }
+        }
+
+        const dp::Vector<PeerRoute> &routes() {
+            rebuild();
+            return routes_;
+        }
+        const PeerRouteStats &stats() const noexcept { return totals_; }
+
+      private:
+        u64 now_us() const { return clock_ ? clock_() : tick_us_; }
+
+        usize first_route(u64 k) {
+            rebuild();
+            auto it = std::lower_bound(keys_.begin(), keys_.end(), k);
+            return it != keys_.end() && *it == k ? static_cast<usize>(it - keys_.begin()) : routes_.size();
+        }
+
+        void rebuild() {
+            if (!dirty_)
+                return;
+            dirty_ = false;
+
+            // Keep values and counters of routes that survive the rebuild
+            dp::Vector<PeerRoute> old = std::move(routes_);
+            routes_.clear();
+            for (const auto &a : assignments_.assignments()) {
+                if (!a.active || a.destination_address == NULL_ADDRESS)
+                    continue;
+                PeerRoute r;
+                r.source_address = a.source_address == NULL_ADDRESS ? cf_->address() : a.source_address;
+                r.source_element = a.source_element;
+                r.source_ddi = a.source_ddi;
+                r.destination_address = a.destination_address;
+                r.destination_element = a.destination_element;
+                r.destination_ddi = a.destination_ddi;
+                r.mode = a.forward_mode;
+                r.interval_us = static_cast<u64>(a.forward_interval_ms) * 1000;
+                for (const auto &o : old) {
+                    if (o.source_address == r.source_address && o.source_element == r.source_element &&
+                        o.source_ddi == r.source_ddi && o.destination_address == r.destination_address &&
+                        o.destination_element == r.destination_element && o.destination_ddi == r.destination_ddi) {
+                        r.value = o.value;
+                        r.has_value = o.has_value;
+                        r.arrived_us = o.arrived_us;
+                        r.has_sent = o.has_sent;
+                        r.sent_value = o.sent_value;
+                        r.stats = o.stats;
+                        break;
+                    }
+                }
+                routes_.push_back(r);
+            }
+            std::stable_sort(routes_.begin(), routes_.end(), [](const PeerRoute &a, const PeerRoute &b) {
+                return key(a.source_address, a.source_element, a.source_ddi) <
+                       key(b.source_address, b.source_element, b.source_ddi);
+            });
+
+            keys_.clear();
+            fixed_rate_.clear();
+            u64 now = now_us();
+            for (usize i = 0; i < routes_.size(); ++i) {
+                auto &r = routes_[i];
+                keys_.push_back(key(r.source_address, r.source_element, r.source_ddi));
+                if (r.mode == PeerForwardMode::FixedRate) {
+                    r.due_us = now;
+                    fixed_rate_.push_back(i);
+                }
+            }
+            echo::category("isobus.tc.peer_control").debug("peer routes rebuilt: ", routes_.size(), " active");
+        }
+
+        void forward(PeerRoute &r) {
+            dp::Vector<u8> data(8);
+            data[0] = static_cast<u8>(ProcessDataCommands::Value) |
+                      static_cast<u8>((r.destination_element & 0x0F) << 4);
+            data[1] = static_cast<u8>((r.destination_element >> 4) & 0xFF);
+            data[2] = static_cast<u8>(r.destination_ddi & 0xFF);
+            data[3] = static_cast<u8>((r.destination_ddi >> 8) & 0xFF);
+            for (usize i = 0; i < 4; ++i)
+                data[4 + i] = static_cast<u8>(static_cast<u32>(r.value) >> (8 * i));
+
+            ControlFunction dest;
+            dest.address = r.destination_address;
+            if (!net_.send(PGN_TC_TO_ECU, data, cf_, &dest, Priority::Default).is_ok()) {
+                ++r.stats.send_errors;
+                ++totals_.send_errors;
+                return;
+            }
+            u64 latency = now_us() - r.arrived_us;
+            r.has_sent = true;
+            r.sent_value = r.value;
+            for (auto *s : {&r.stats, &totals_}) {
+                ++s->forwarded;
+                s->latency_total_us += latency;
+                s->latency_max_us = std::max(s->latency_max_us, latency);
+            }
+        }
+
+        void handle_value(const Message &msg) {
+            if (msg.data.size() < 8 || (msg.data[0] & 0x0F) != static_cast<u8>(ProcessDataCommands::Value))
+                return;
+            auto element = static_cast<ElementNumber>(((msg.data[0] >> 4) & 0x0F) | (msg.data[1] << 4));
+            auto ddi = static_cast<DDI>(msg.data[2] | (msg.data[3] << 8));
+            i32 value = static_cast<i32>(static_cast<u32>(msg.data[4]) | (static_cast<u32>(msg.data[5]) << 8) |
+                                         (static_cast<u32>(msg.data[6]) << 16) | (static_cast<u32>(msg.data[7]) << 24));
+            route(msg.source, element, ddi, value);
+        }
+    };
+
 } // namespace agrobus::isobus::tc
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <agrobus/net/types.hpp>
+#include <algorithm>
+#include <cmath>
+#include <concord/concord.hpp>
+#include <datapod/datapod.hpp>
+#include <limits>
+
+namespace agrobus::isobus::tc {
+    using namespace agrobus::net;
+
+    // ─── Prescription data ───────────────────────────────────────────────────────
+    struct PrescriptionZone {
+        dp::Vector<concord::earth::WGS> boundary; // Polygon vertices
+        i32 application_rate = 0;                 // Rate value (DDI-dependent units)
+    };
+
+    struct PrescriptionMap {
+        dp::String structure_label;
+        dp::Vector<PrescriptionZone> zones;
+    };
+
+    // ─── Local metric frame ──────────────────────────────────────────────────────
+    // Equirectangular projection around an origin. Over a field (a few km) the
+    // error is far below GNSS accuracy, and because it is affine in lat/lon a
+    // point-in-polygon answer is identical to testing the raw WGS coordinates.
+    struct LocalFrame {
+        static constexpr f64 EARTH_RADIUS_M = 6371008.8;
+        static constexpr f64 DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+        f64 origin_lat = 0.0;
+        f64 origin_lon = 0.0;
+        f64 m_per_deg_lat = EARTH_RADIUS_M * DEG_TO_RAD;
+        f64 m_per_deg_lon = EARTH_RADIUS_M * DEG_TO_RAD;
+
+        LocalFrame() = default;
+        LocalFrame(f64 lat, f64 lon)
+            : origin_lat(lat), origin_lon(lon), m_per_deg_lon(EARTH_RADIUS_M * DEG_TO_RAD * std::cos(lat * DEG_TO_RAD)) {
+        }
+
+        f64 east(f64 lon) const noexcept { return (lon - origin_lon) * m_per_deg_lon; }
+        f64 north(f64 lat) const noexcept { return (lat - origin_lat) * m_per_deg_lat; }
+
+        concord::earth::WGS to_wgs(f64 east_m, f64 north_m) const {
+            return concord::earth::WGS(origin_lat + north_m / m_per_deg_lat, origin_lon + east_m / m_per_deg_lon);
+        }
+    };
+
+    // Position a moving implement reaches after `seconds` at `speed_mps` along
+    // `heading_rad` (clockwise from north)
+    inline concord::earth::WGS project_ahead(const concord::earth::WGS &pos, f64 heading_rad, f64 speed_mps,
+                                             f64 seconds) {
+        LocalFrame frame(pos.latitude, pos.longitude);
+        f64 d = speed_mps * seconds;
+        auto ahead = frame.to_wgs(d * std::sin(heading_rad), d * std::cos(heading_rad));
+        ahead.altitude = pos.altitude;
+        return ahead;
+    }
+
+    // ─── Polygon prescription index ──────────────────────────────────────────────
+    // Uniform grid over polygon prescriptions in a local metric frame. Every
+    // polygon is listed in the cells its bounding box overlaps (CSR layout), so a
+    // lookup is one cell fetch, a bounding-box reject and point-in-polygon tests
+    // on the few candidates. Candidates keep map/zone order, so the first match
+    // is the same zone the linear scan over maps and zones would return.
+    class PrescriptionIndex {
+        struct Point {
+            f64 x, y;
+        };
+        struct Polygon {
+            u32 first = 0; // into points_
+            u32 count = 0;
+            f64 min_x, min_y, max_x, max_y;
+            i32 rate = 0;
+        };
+
+        LocalFrame frame_;
+        dp::Vector<Point> points_;
+        dp::Vector<Polygon> polygons_;
+        dp::Vector<u32> cell_start_; // cols*rows + 1 offsets into cell_items_
+        dp::Vector<u32> cell_items_;
+        f64 min_x_ = 0, min_y_ = 0, cell_m_ = 1;
+        u32 cols_ = 0, rows_ = 0;
+
+        static constexpr usize MAX_CELLS = 1u << 22;
+
+      public:
+        PrescriptionIndex() = default;
+        explicit PrescriptionIndex(const dp::Vector<PrescriptionMap> &maps, f64 cell_m = 0.0) { build(maps, cell_m); }
+
+        // cell_m = 0 picks a cell size giving about two polygons per cell
+        void build(const dp::Vector<PrescriptionMap> &maps, f64 cell_m = 0.0) {
+            clear();
+            f64 lat_min = 90, lat_max = -90, lon_min = 180, lon_max = -180;
+            usize vertices = 0;
+            for (const auto &map : maps)
+                for (const auto &zone : map.zones) {
+                    if (zone.boundary.size() < 3)
+                        continue;
+                    vertices += zone.boundary.size();
+                    for (const auto &v : zone.boundary) {
+                        lat_min = std::min(lat_min, v.latitude);
+                        lat_max = std::max(lat_max, v.latitude);
+                        lon_min = std::min(lon_min, v.longitude);
+                        lon_max = std::max(lon_max, v.longitude);
+                    }
+                }
+            if (vertices == 0)
+                return;
+
+            frame_ = LocalFrame((lat_min + lat_max) / 2, (lon_min + lon_max) / 2);
+            points_.reserve(vertices);
+            for (const auto &map : maps)
+                for (const auto &zone : map.zones) {
+                    if (zone.boundary.size() < 3)
+                        continue;
+                    Polygon poly;
+                    poly.first = static_cast<u32>(points_.size());
+                    poly.count = static_cast<u32>(zone.boundary.size());
+                    poly.rate = zone.application_rate;
+                    poly.min_x = poly.min_y = std::numeric_limits<f64>::max();
+                    poly.max_x = poly.max_y = std::numeric_limits<f64>::lowest();
+                    for (const auto &v : zone.boundary) {
+                        Point p{frame_.east(v.longitude), frame_.north(v.latitude)};
+                        points_.push_back(p);
+                        poly.min_x = std::min(poly.min_x, p.x);
+                        poly.min_y = std::min(poly.min_y, p.y);
+                        poly.max_x = std::max(poly.max_x, p.x);
+                        poly.max_y = std::max(poly.max_y, p.y);
+                    }
+                    polygons_.push_back(poly);
+                }
+
+            min_x_ = frame_.east(lon_min);
+            min_y_ = frame_.north(lat_min);
+            f64 width = std::max(frame_.east(lon_max) - min_x_, 1.0);
+            f64 height = std::max(frame_.north(lat_max) - min_y_, 1.0);
+            cell_m_ = cell_m > 0.0 ? cell_m : std::sqrt(width * height / (2.0 * polygons_.size()));
+            cell_m_ = std::max(cell_m_, std::sqrt(width * height / MAX_CELLS));
+            cols_ = static_cast<u32>(width / cell_m_) + 1;
+            rows_ = static_cast<u32>(height / cell_m_) + 1;
+
+            // Two passes: count, then fill in polygon order
+            cell_start_.assign(static_cast<usize>(cols_) * rows_ + 1, 0);
+            for_each_cell_pass([&](usize cell, u32) { ++cell_start_[cell + 1]; });
+            for (usize i = 1; i < cell_start_.size(); ++i)
+                cell_start_[i] += cell_start_[i - 1];
+            cell_items_.resize(cell_start_.back());
+            dp::Vector<u32> fill(cell_start_.size() - 1);
+            for (usize i = 0; i < fill.size(); ++i)
+                fill[i] = cell_start_[i];
+            for_each_cell_pass([&](usize cell, u32 poly) { cell_items_[fill[cell]++] = poly; });
+        }
+
+        void clear() {
+            points_.clear();
+            polygons_.clear();
+            cell_start_.clear();
+            cell_items_.clear();
+            cols_ = rows_ = 0;
+        }
+
+        dp::Optional<i32> rate_at(const concord::earth::WGS &pos) const {
+            if (polygons_.empty())
+                return dp::nullopt;
+            f64 x = frame_.east(pos.longitude);
+            f64 y = frame_.north(pos.latitude);
+            f64 cx = (x - min_x_) / cell_m_;
+            f64 cy = (y - min_y_) / cell_m_;
+            if (cx < 0 || cy < 0 || cx >= cols_ || cy >= rows_)
+                return dp::nullopt;
+            usize cell = static_cast<usize>(cy) * cols_ + static_cast<usize>(cx);
+            for (u32 i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i) {
+                const auto &poly = polygons_[cell_items_[i]];
+                if (x < poly.min_x || x > poly.max_x || y < poly.min_y || y > poly.max_y)
+                    continue;
+                if (contains(poly, x, y))
+                    return poly.rate;
+            }
+            return dp::nullopt;
+        }
+
+        bool empty() const noexcept { return polygons_.empty(); }
+        usize polygon_count() const noexcept { return polygons_.size(); }
+        usize cell_count() const noexcept { return static_cast<usize>(cols_) * rows_; }
+        f64 cell_size_m() const noexcept { return cell_m_; }
+        const LocalFrame &frame() const noexcept { return frame_; }
+
+      private:
+        template <typename Fn> void for_each_cell_pass(Fn &&fn) const {
+            for (u32 p = 0; p < polygons_.size(); ++p) {
+                const auto &poly = polygons_[p];
+                u32 x0 = static_cast<u32>((poly.min_x - min_x_) / cell_m_);
+                u32 x1 = std::min(static_cast<u32>((poly.max_x - min_x_) / cell_m_), cols_ - 1);
+                u32 y0 = static_cast<u32>((poly.min_y - min_y_) / cell_m_);
+                u32 y1 = std::min(static_cast<u32>((poly.max_y - min_y_) / cell_m_), rows_ - 1);
+                for (u32 cy = y0; cy <= y1; ++cy)
+                    for (u32 cx = x0; cx <= x1; ++cx)
+                        fn(static_cast<usize>(cy) * cols_ + cx, p);
+            }
+        }
+
+        // Ray casting on projected vertices
+        bool contains(const Polygon &poly, f64 x, f64 y) const {
+            const Point *v = points_.data() + poly.first;
+            bool inside = false;
+            for (u32 i = 0, j = poly.count - 1; i < poly.count; j = i++) {
+                if (((v[i].y > y) != (v[j].y > y)) &&
+                    (x < (v[j].x - v[i].x) * (y - v[i].y) / (v[j].y - v[i].y) + v[i].x))
+                    inside = !inside;
+            }
+            return inside;
+        }
+    };
+
+    // ─── Raster prescription ─────────────────────────────────────────────────────
+    // ISO 11783-10 grid (GRD) style prescription: rows x columns of rates laid
+    // out south to north, west to east, with the cell size in degrees. A lookup
+    // is two subtractions, two divisions and one array read.
+    struct RasterPrescription {
+        dp::String structure_label;
+        f64 min_north = 0.0; // south-west corner, degrees
+        f64 min_east = 0.0;
+        f64 cell_north = 0.0; // cell size, degrees
+        f64 cell_east = 0.0;
+        u32 columns = 0;
+        u32 rows = 0;
+        dp::Vector<i32> rates; // rows * columns, row-major from the south-west cell
+        i32 no_data = std::numeric_limits<i32>::min();
+
+        bool valid() const noexcept {
+            return columns > 0 && rows > 0 && cell_north > 0.0 && cell_east > 0.0 &&
+                   rates.size() == static_cast<usize>(columns) * rows;
+        }
+
+        dp::Optional<i32> rate_at(const concord::earth::WGS &pos) const {
+            f64 r = (pos.latitude - min_north) / cell_north;
+            f64 c = (pos.longitude - min_east) / cell_east;
+            if (r < 0 || c < 0 || r >= rows || c >= columns)
+                return dp::nullopt;
+            i32 rate = rates[static_cast<usize>(r) * columns + static_cast<usize>(c)];
+            if (rate == no_data)
+                return dp::nullopt;
+            return rate;
+        }
+
+        // Rasterize polygon maps at a fixed cell size: one index lookup per cell
+        // centre, after which every position lookup is constant time
+        static RasterPrescription from_maps(const dp::Vector<PrescriptionMap> &maps, f64 cell_m) {
+            RasterPrescription raster;
+            PrescriptionIndex index(maps);
+            if (index.empty() || cell_m <= 0.0)
+                return raster;
+            f64 lat_min = 90, lat_max = -90, lon_min = 180, lon_max = -180;
+            for (const auto &map : maps)
+                for (const auto &zone : map.zones)
+                    for (const auto &v : zone.boundary) {
+                        lat_min = std::min(lat_min, v.latitude);
+                        lat_max = std::max(lat_max, v.latitude);
+                        lon_min = std::min(lon_min, v.longitude);
+                        lon_max = std::max(lon_max, v.longitude);
+                    }
+            const auto &frame = index.frame();
+            raster.structure_label = maps.front().structure_label;
+            raster.min_north = lat_min;
+            raster.min_east = lon_min;
+            raster.cell_north = cell_m / frame.m_per_deg_lat;
+            raster.cell_east = cell_m / frame.m_per_deg_lon;
+            raster.rows = static_cast<u32>((lat_max - lat_min) / raster.cell_north) + 1;
+            raster.columns = static_cast<u32>((lon_max - lon_min) / raster.cell_east) + 1;
+            raster.rates.resize(static_cast<usize>(raster.rows) * raster.columns);
+            for (u32 r = 0; r < raster.rows; ++r)
+                for (u32 c = 0; c < raster.columns; ++c) {
+                    concord::earth::WGS centre(lat_min + (r + 0.5) * raster.cell_north,
+                                               lon_min + (c + 0.5) * raster.cell_east);
+                    auto rate = index.rate_at(centre);
+                    raster.rates[static_cast<usize>(r) * raster.columns + c] = rate ? *rate : raster.no_data;
+                }
+            return raster;
+        }
+    };
+
+} // namespace agrobus::isobus::tc
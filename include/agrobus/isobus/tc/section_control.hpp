@@ -0,0 +1,445 @@
+#pragma once
+
+#include "client.hpp"
+#include "ddi_database.hpp"
+#include "ddop_helpers.hpp"
+#include "prescription_index.hpp"
+#include <agrobus/net/event.hpp>
+#include <agrobus/net/types.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concord/concord.hpp>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+#include <memory>
+
+namespace agrobus::isobus::tc {
+    using namespace agrobus::net;
+
+    // ─── Swath geometry ──────────────────────────────────────────────────────────
+    struct LocalPoint {
+        f64 x = 0.0; // east, m
+        f64 y = 0.0; // north, m
+    };
+
+    // Convex quadrilateral, vertices in order around the outline
+    using SwathQuad = dp::Array<LocalPoint, 4>;
+
+    // ─── Bit-packed coverage grid ────────────────────────────────────────────────
+    // Square cells in a local metric frame, one bit per cell. Storage is split
+    // into 256 x 256 cell tiles allocated on first write, each row of a tile being
+    // four 64-bit words, so marking and counting a span of cells is a few masked
+    // word operations and popcounts rather than a loop over bytes.
+    class CoverageGrid {
+      public:
+        static constexpr i64 TILE_CELLS = 256;
+        static constexpr i64 TILE_WORDS = TILE_CELLS / 64;
+
+      private:
+        struct Tile {
+            dp::Array<u64, TILE_CELLS * TILE_WORDS> rows = {};
+        };
+
+        f64 resolution_m_;
+        dp::Map<u64, std::unique_ptr<Tile>> tiles_;
+        mutable u64 last_key_ = ~0ull;
+        mutable Tile *last_tile_ = nullptr;
+        u64 covered_ = 0;
+
+        static i64 floor_div(i64 a, i64 b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+        static u64 tile_key(i64 tx, i64 ty) {
+            return (static_cast<u64>(static_cast<u32>(tx)) << 32) | static_cast<u32>(ty);
+        }
+
+        Tile *tile(i64 tx, i64 ty, bool create) {
+            u64 key = tile_key(tx, ty);
+            if (key == last_key_ && last_tile_)
+                return last_tile_;
+            auto it = tiles_.find(key);
+            if (it == tiles_.end()) {
+                if (!create)
+                    return nullptr;
+                it = tiles_.emplace(key, std::make_unique<Tile>()).first;
+            }
+            last_key_ = key;
+            last_tile_ = it->second.get();
+            return last_tile_;
+        }
+
+        // Mask of bits [b0, b1] within one word
+        static u64 word_mask(i64 b0, i64 b1) {
+            u64 hi = b1 >= 63 ? ~0ull : ((1ull << (b1 + 1)) - 1);
+            return hi & (~0ull << b0);
+        }
+
+        // Apply fn(word, mask) to every word covering cells [x0, x1] of row y
+        template <typename Fn> void for_span(i64 y, i64 x0, i64 x1, bool create, Fn &&fn) {
+            i64 ty = floor_div(y, TILE_CELLS);
+            i64 ry = y - ty * TILE_CELLS;
+            for (i64 x = x0; x <= x1;) {
+                i64 tx = floor_div(x, TILE_CELLS);
+                i64 tile_end = std::min(x1, (tx + 1) * TILE_CELLS - 1);
+                Tile *t = tile(tx, ty, create);
+                if (t) {
+                    u64 *row = t->rows.data() + ry * TILE_WORDS;
+                    i64 c0 = x - tx * TILE_CELLS, c1 = tile_end - tx * TILE_CELLS;
+                    for (i64 w = c0 / 64; w <= c1 / 64; ++w)
+                        fn(row[w], word_mask(std::max<i64>(c0 - w * 64, 0), std::min<i64>(c1 - w * 64, 63)));
+                }
+                x = tile_end + 1;
+            }
+        }
+
+      public:
+        explicit CoverageGrid(f64 resolution_m = 0.02) : resolution_m_(resolution_m > 0.0 ? resolution_m : 0.02) {}
+
+        f64 resolution() const noexcept { return resolution_m_; }
+
+        // Set cells [x0, x1] of row y; returns how many were newly covered
+        u64 mark_span(i64 y, i64 x0, i64 x1) {
+            u64 added = 0;
+            for_span(y, x0, x1, true, [&](u64 &word, u64 mask) {
+                added += static_cast<u64>(std::popcount(mask & ~word));
+                word |= mask;
+            });
+            covered_ += added;
+            return added;
+        }
+
+        u64 count_span(i64 y, i64 x0, i64 x1) const {
+            u64 count = 0;
+            const_cast<CoverageGrid *>(this)->for_span(
+                y, x0, x1, false, [&](u64 &word, u64 mask) { count += static_cast<u64>(std::popcount(word & mask)); });
+            return count;
+        }
+
+        bool test(i64 x, i64 y) const { return count_span(y, x, x) != 0; }
+
+        // Visit the cell spans whose centres lie inside a convex quad
+        template <typename Fn> void scan(const SwathQuad &quad, Fn &&fn) const {
+            f64 min_y = quad[0].y, max_y = quad[0].y;
+            for (const auto &p : quad) {
+                min_y = std::min(min_y, p.y);
+                max_y = std::max(max_y, p.y);
+            }
+            i64 y0 = static_cast<i64>(std::ceil(min_y / resolution_m_ - 0.5));
+            i64 y1 = static_cast<i64>(std::floor(max_y / resolution_m_ - 0.5));
+            for (i64 y = y0; y <= y1; ++y) {
+                f64 cy = (y + 0.5) * resolution_m_;
+                f64 lo = 1e300, hi = -1e300;
+                for (usize i = 0, j = 3; i < 4; j = i++) {
+                    const auto &a = quad[j];
+                    const auto &b = quad[i];
+                    if ((a.y <= cy && b.y >= cy) || (b.y <= cy && a.y >= cy)) {
+                        f64 x = a.y == b.y ? std::min(a.x, b.x) : a.x + (cy - a.y) * (b.x - a.x) / (b.y - a.y);
+                        f64 x_other = a.y == b.y ? std::max(a.x, b.x) : x;
+                        lo = std::min(lo, x);
+                        hi = std::max(hi, x_other);
+                    }
+                }
+                if (lo > hi)
+                    continue;
+                i64 x0 = static_cast<i64>(std::ceil(lo / resolution_m_ - 0.5));
+                i64 x1 = static_cast<i64>(std::floor(hi / resolution_m_ - 0.5));
+                if (x0 <= x1)
+                    fn(y, x0, x1);
+            }
+        }
+
+        // Cover every cell of a quad; returns the newly covered cell count
+        u64 fill(const SwathQuad &quad) {
+            u64 added = 0;
+            scan(quad, [&](i64 y, i64 x0, i64 x1) { added += mark_span(y, x0, x1); });
+            return added;
+        }
+
+        // Covered cells inside a quad; total receives the quad's cell count
+        u64 count(const SwathQuad &quad, u64 &total) const {
+            u64 covered = 0;
+            total = 0;
+            scan(quad, [&](i64 y, i64 x0, i64 x1) {
+                total += static_cast<u64>(x1 - x0 + 1);
+                covered += count_span(y, x0, x1);
+            });
+            return covered;
+        }
+
+        // Even-odd fill of a polygon (field boundary), row by row
+        void fill_polygon(const dp::Vector<LocalPoint> &polygon) {
+            if (polygon.size() < 3)
+                return;
+            f64 min_y = polygon[0].y, max_y = polygon[0].y;
+            for (const auto &p : polygon) {
+                min_y = std::min(min_y, p.y);
+                max_y = std::max(max_y, p.y);
+            }
+            dp::Vector<f64> xs;
+            i64 y0 = static_cast<i64>(std::ceil(min_y / resolution_m_ - 0.5));
+            i64 y1 = static_cast<i64>(std::floor(max_y / resolution_m_ - 0.5));
+            for (i64 y = y0; y <= y1; ++y) {
+                f64 cy = (y + 0.5) * resolution_m_;
+                xs.clear();
+                for (usize i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+                    const auto &a = polygon[j];
+                    const auto &b = polygon[i];
+                    if ((a.y > cy) != (b.y > cy))
+                        xs.push_back(a.x + (cy - a.y) * (b.x - a.x) / (b.y - a.y));
+                }
+                std::sort(xs.begin(), xs.end());
+                for (usize k = 0; k + 1 < xs.size(); k += 2) {
+                    i64 x0 = static_cast<i64>(std::ceil(xs[k] / resolution_m_ - 0.5));
+                    i64 x1 = static_cast<i64>(std::floor(xs[k + 1] / resolution_m_ - 0.5));
+                    if (x0 <= x1)
+                        mark_span(y, x0, x1);
+                }
+            }
+        }
+
+        void clear() {
+            tiles_.clear();
+            last_key_ = ~0ull;
+            last_tile_ = nullptr;
+            covered_ = 0;
+        }
+
+        u64 covered_cells() const noexcept { return covered_; }
+        f64 covered_area_m2() const noexcept { return covered_ * resolution_m_ * resolution_m_; }
+        usize tile_count() const noexcept { return tiles_.size(); }
+        usize memory_bytes() const noexcept { return tiles_.size() * sizeof(Tile); }
+    };
+
+    // ─── Section control configuration ───────────────────────────────────────────
+    struct SectionControlConfig {
+        f64 resolution_m = 0.02;          // coverage cell size
+        f64 boundary_resolution_m = 0.25; // field boundary mask cell size
+        f64 look_ahead_s = 0.5;           // section valve / actuator latency
+        f64 max_overlap = 0.5;            // switch off above this covered fraction
+        f64 max_outside = 0.5;            // switch off above this fraction outside the boundary
+
+        SectionControlConfig &resolution(f64 metres) {
+            resolution_m = metres;
+            return *this;
+        }
+        SectionControlConfig &boundary_resolution(f64 metres) {
+            boundary_resolution_m = metres;
+            return *this;
+        }
+        SectionControlConfig &look_ahead(f64 seconds) {
+            look_ahead_s = seconds;
+            return *this;
+        }
+        SectionControlConfig &overlap(f64 fraction) {
+            max_overlap = fraction;
+            return *this;
+        }
+        SectionControlConfig &outside(f64 fraction) {
+            max_outside = fraction;
+            return *this;
+        }
+    };
+
+    struct SectionControlStats {
+        u64 ticks = 0;
+        u64 switches = 0;
+        u64 condensed_updates = 0; // condensed work state values pushed to the TC client
+    };
+
+    // ─── Automatic section control ───────────────────────────────────────────────
+    // Decides section on/off from the area already covered and the field
+    // boundary. Each update paints the swath of every working section since the
+    // previous pose into the coverage grid, then looks ahead along the heading by
+    // speed x latency and switches a section off when too much of the ground it
+    // is about to cover is already covered or outside the field. Section
+    // geometry comes from DDOPHelpers::extract_geometry: x forward, y left, both
+    // relative to the navigation reference point.
+    class SectionControl {
+        struct Section {
+            f64 x = 0.0;     // m forward of the reference point
+            f64 left = 0.0;  // m, left edge
+            f64 right = 0.0; // m, right edge
+            bool on = false;
+            f64 overlap = 0.0;
+            f64 outside = 0.0;
+        };
+
+        SectionControlConfig config_;
+        dp::Vector<Section> sections_;
+        CoverageGrid coverage_;
+        CoverageGrid boundary_;
+        bool has_boundary_ = false;
+        dp::Optional<LocalFrame> frame_;
+        dp::Optional<LocalPoint> last_pos_;
+        f64 last_heading_ = 0.0;
+        bool master_ = true;
+        SectionControlStats stats_;
+
+        TaskControllerClient *client_ = nullptr;
+        ElementNumber element_ = 0;
+        dp::Vector<i32> last_condensed_;
+
+        // Section edge points at a pose
+        static void edges(const Section &s, const LocalPoint &pos, f64 heading, LocalPoint &left, LocalPoint &right) {
+            f64 fx = std::sin(heading), fy = std::cos(heading); // forward
+            f64 lx = -fy, ly = fx;                              // left
+            left = {pos.x + fx * s.x + lx * s.left, pos.y + fy * s.x + ly * s.left};
+            right = {pos.x + fx * s.x + lx * s.right, pos.y + fy * s.x + ly * s.right};
+        }
+
+        void publish() {
+            if (!client_)
+                return;
+            usize blocks = (sections_.size() + 15) / 16;
+            last_condensed_.resize(blocks, -1);
+            for (usize b = 0; b < blocks; ++b) {
+                i32 value = condensed(b);
+                if (value == last_condensed_[b])
+                    continue;
+                last_condensed_[b] = value;
+                client_->set_value(element_, static_cast<DDI>(ddi::ACTUAL_CONDENSED_WORK_STATE_1_16 + b), value);
+                ++stats_.condensed_updates;
+            }
+        }
+
+      public:
+        explicit SectionControl(const ImplementGeometry &geometry, SectionControlConfig config = {})
+            : config_(config), coverage_(config.resolution_m), boundary_(config.boundary_resolution_m) {
+            for (const auto &info : geometry.sections) {
+                Section s;
+                s.x = (info.offset_x_mm + geometry.connector_x_mm + geometry.boom_offset_x_mm) / 1000.0;
+                f64 centre = (info.offset_y_mm + geometry.boom_offset_y_mm) / 1000.0;
+                s.left = centre + info.width_mm / 2000.0;
+                s.right = centre - info.width_mm / 2000.0;
+                sections_.push_back(s);
+            }
+        }
+
+        // ─── Setup ───────────────────────────────────────────────────────────────
+        // Local frame origin; defaults to the first position seen
+        void set_origin(const concord::earth::WGS &origin) { frame_ = LocalFrame(origin.latitude, origin.longitude); }
+
+        // Field boundary (outer ring); sections switch off where it is left
+        void set_boundary(const dp::Vector<concord::earth::WGS> &polygon) {
+            if (polygon.empty())
+                return;
+            if (!frame_.has_value())
+                set_origin(polygon.front());
+            dp::Vector<LocalPoint> local;
+            local.reserve(polygon.size());
+            for (const auto &p : polygon)
+                local.push_back(to_local(p));
+            boundary_.clear();
+            boundary_.fill_polygon(local);
+            has_boundary_ = true;
+        }
+
+        // Report the condensed work state (DDI 161+) of `element` through a TC client
+        void bind(TaskControllerClient &client, ElementNumber element) {
+            client_ = &client;
+            element_ = element;
+            last_condensed_.clear();
+            publish();
+        }
+
+        // Master work state: when off, nothing is painted and all sections are off
+        void set_master(bool working) { master_ = working; }
+
+        LocalPoint to_local(const concord::earth::WGS &p) const {
+            return frame_.has_value() ? LocalPoint{frame_->east(p.longitude), frame_->north(p.latitude)} : LocalPoint{};
+        }
+
+        // ─── Update ──────────────────────────────────────────────────────────────
+        void update(const concord::earth::WGS &position, f64 heading_rad, f64 speed_mps) {
+            if (!frame_.has_value())
+                set_origin(position);
+            update_local(to_local(position), heading_rad, speed_mps);
+        }
+
+        void update_local(const LocalPoint &pos, f64 heading_rad, f64 speed_mps) {
+            ++stats_.ticks;
+
+            // Paint what the working sections covered since the previous pose
+            if (last_pos_.has_value()) {
+                for (const auto &s : sections_) {
+                    if (!s.on)
+                        continue;
+                    LocalPoint l0, r0, l1, r1;
+                    edges(s, *last_pos_, last_heading_, l0, r0);
+                    edges(s, pos, heading_rad, l1, r1);
+                    // As two triangles: stays correct when a turn folds the quad
+                    coverage_.fill(SwathQuad{l0, l1, r1, r1});
+                    coverage_.fill(SwathQuad{l0, r1, r0, r0});
+                }
+            }
+            last_pos_ = pos;
+            last_heading_ = heading_rad;
+
+            // Ground each section will cover once a switch takes effect; at least
+            // one cell deep so a stationary machine still sees what is under it
+            f64 ahead = std::max(speed_mps * config_.look_ahead_s, coverage_.resolution());
+            f64 fx = std::sin(heading_rad) * ahead, fy = std::cos(heading_rad) * ahead;
+            bool changed = false;
+            for (auto &s : sections_) {
+                LocalPoint l0, r0;
+                edges(s, pos, heading_rad, l0, r0);
+                SwathQuad quad{l0, LocalPoint{l0.x + fx, l0.y + fy}, LocalPoint{r0.x + fx, r0.y + fy}, r0};
+
+                u64 total = 0;
+                u64 covered = coverage_.count(quad, total);
+                s.overlap = total ? static_cast<f64>(covered) / total : 0.0;
+                s.outside = 0.0;
+                if (has_boundary_) {
+                    u64 cells = 0;
+                    u64 inside = boundary_.count(quad, cells);
+                    s.outside = cells ? 1.0 - static_cast<f64>(inside) / cells : 0.0;
+                }
+
+                bool on = master_ && s.overlap <= config_.max_overlap && s.outside <= config_.max_outside;
+                if (on != s.on) {
+                    s.on = on;
+                    changed = true;
+                    ++stats_.switches;
+                }
+            }
+
+            if (changed) {
+                on_sections_changed.emit(states());
+                publish();
+            }
+        }
+
+        // ─── State ───────────────────────────────────────────────────────────────
+        usize section_count() const noexcept { return sections_.size(); }
+        bool section_on(usize i) const { return i < sections_.size() && sections_[i].on; }
+        f64 overlap(usize i) const { return i < sections_.size() ? sections_[i].overlap : 0.0; }
+        f64 outside(usize i) const { return i < sections_.size() ? sections_[i].outside : 0.0; }
+
+        dp::Vector<bool> states() const {
+            dp::Vector<bool> out(sections_.size());
+            for (usize i = 0; i < sections_.size(); ++i)
+                out[i] = sections_[i].on;
+            return out;
+        }
+
+        // Condensed work state for sections 16*block+1 .. 16*block+16: two bits per
+        // section, section 1 in the lowest bits, 00 off, 01 on, 11 not installed
+        i32 condensed(usize block) const {
+            u32 value = 0;
+            for (usize k = 0; k < 16; ++k) {
+                usize i = block * 16 + k;
+                u32 state = i < sections_.size() ? (sections_[i].on ? 0x1u : 0x0u) : 0x3u;
+                value |= state << (2 * k);
+            }
+            return static_cast<i32>(value);
+        }
+
+        const CoverageGrid &coverage() const noexcept { return coverage_; }
+        CoverageGrid &coverage() noexcept { return coverage_; }
+        const SectionControlStats &stats() const noexcept { return stats_; }
+        const SectionControlConfig &config() const noexcept { return config_; }
+
+        // ─── Events ──────────────────────────────────────────────────────────────
+        Event<const dp::Vector<bool> &> on_sections_changed;
+    };
+
+} // namespace agrobus::isobus::tc
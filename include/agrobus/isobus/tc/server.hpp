@@ -1,8 +1,10 @@
 #pragma once
 
 #include "ddop.hpp"
+#include "ddop_cache.hpp"
 #include "objects.hpp"
 #include "server_options.hpp"
+#include "task_log.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/control_function.hpp>
 #include <agrobus/net/error.hpp>
@@ -11,6 +13,7 @@
 #include <agrobus/net/message.hpp>
 #include <agrobus/net/network_manager.hpp>
 #include <agrobus/net/state_machine.hpp>
+#include <algorithm>
 #include <datapod/datapod.hpp>
 #include <echo/echo.hpp>
 #include <functional>
@@ -18,12 +21,100 @@
 namespace agrobus::isobus::tc {
     using namespace agrobus::net;
 
+    // ─── Process data routing ────────────────────────────────────────────────────
+    // One (element, DDI) pair a client's activated DDOP declares as process
+    // data, with the latest value received for it.
+    struct TCProcessRoute {
+        ElementNumber element = 0;
+        DDI ddi = 0;
+        ObjectID object_id = 0; // DeviceProcessData object
+        u8 trigger_methods = 0;
+        i32 value = 0;
+        bool has_value = false;
+        u32 updated_ms = 0; // server time of the last value
+        u64 received = 0;
+    };
+
+    // Routes of one client, sorted by (element, DDI) for binary search
+    class TCRoutingTable {
+        dp::Vector<TCProcessRoute> routes_;
+
+        static u32 key(ElementNumber element, DDI ddi) noexcept {
+            return (static_cast<u32>(element) << 16) | static_cast<u32>(ddi);
+        }
+
+      public:
+        void build(const DDOP &ddop) {
+            routes_.clear();
+            for (const auto &elem : ddop.elements()) {
+                for (auto child : elem.child_objects) {
+                    if (const auto *pd = ddop.process_data(child)) {
+                        TCProcessRoute route;
+                        route.element = elem.number;
+                        route.ddi = pd->ddi;
+                        route.object_id = pd->id;
+                        route.trigger_methods = pd->trigger_methods;
+                        routes_.push_back(route);
+                    }
+                }
+            }
+            std::sort(routes_.begin(), routes_.end(), [](const TCProcessRoute &a, const TCProcessRoute &b) {
+                return key(a.element, a.ddi) < key(b.element, b.ddi);
+            });
+            routes_.erase(std::unique(routes_.begin(), routes_.end(),
+                                      [](const TCProcessRoute &a, const TCProcessRoute &b) {
+                                          return a.element == b.element && a.ddi == b.ddi;
+                                      }),
+                          routes_.end());
+        }
+
+        TCProcessRoute *find(ElementNumber element, DDI ddi) {
+            u32 k = key(element, ddi);
+            auto it = std::lower_bound(routes_.begin(), routes_.end(), k,
+                                       [](const TCProcessRoute &r, u32 v) { return key(r.element, r.ddi) < v; });
+            return (it != routes_.end() && key(it->element, it->ddi) == k) ? &*it : nullptr;
+        }
+        const TCProcessRoute *find(ElementNumber element, DDI ddi) const {
+            return const_cast<TCRoutingTable *>(this)->find(element, ddi);
+        }
+
+        const dp::Vector<TCProcessRoute> &routes() const noexcept { return routes_; }
+        dp::Vector<TCProcessRoute> &routes() noexcept { return routes_; }
+        usize size() const noexcept { return routes_.size(); }
+        bool empty() const noexcept { return routes_.empty(); }
+        void clear() { routes_.clear(); }
+    };
+
+    // ─── Per-client statistics ───────────────────────────────────────────────────
+    struct TCClientStats {
+        u64 messages = 0;      // all ECU -> TC messages
+        u64 values = 0;        // process data values on a known route
+        u64 unrouted = 0;      // values for pairs not in the client's DDOP
+        u64 requests_sent = 0; // scheduled value requests
+        f32 messages_per_s = 0.0f;
+        u32 last_message_ms = 0;
+
+        u32 window_messages_ = 0; // messages in the current rate window
+    };
+
+    // Periodic value request for one route
+    struct TCValuePoll {
+        ElementNumber element = 0;
+        DDI ddi = 0;
+        u32 interval_ms = 0;
+        u32 due_ms = 0;
+    };
+
     // ─── TC Server client tracking ───────────────────────────────────────────────
     struct TCClientInfo {
         Address address = NULL_ADDRESS;
         DDOP ddop;
         bool pool_activated = false;
         u32 last_status_ms = 0;
+        u64 client_name = 0; // NAME, key into the DDOP cache (0 = unknown)
+        TCRoutingTable routes; // built from the DDOP on activation
+        dp::Vector<TCValuePoll> polls;
+        TCClientStats stats;
     };
 
     // ─── TC Status broadcast interval ────────────────────────────────────────────
@@ -37,6 +128,11 @@ namespace agrobus::isobus::tc {
         u8 num_sections = 0;
         u8 num_channels = 0;
         u8 server_options = 0;
+        usize ddop_cache_entries = 16;
+        u32 bitrate = 250000;         // CAN bitrate (bit/s)
+        f32 poll_bus_budget = 0.20f;  // fraction of the bus scheduled value requests may use
+        f32 poll_bus_limit = 70.0f;   // measured bus load (%) above which polling pauses
+        u32 bits_per_frame = 128;     // worst-case extended frame incl. stuffing
 
         TCServerConfig &number(u8 n) {
             tc_number = n;
@@ -62,14 +158,50 @@ namespace agrobus::isobus::tc {
             server_options = o;
             return *this;
         }
+        TCServerConfig &ddop_cache(usize entries) {
+            ddop_cache_entries = entries;
+            return *this;
+        }
+        TCServerConfig &poll_budget(f32 fraction) {
+            poll_bus_budget = fraction;
+            return *this;
+        }
+        TCServerConfig &poll_limit(f32 load_percent) {
+            poll_bus_limit = load_percent;
+            return *this;
+        }
+
+        // Value requests per second allowed by the budget
+        f64 poll_frames_per_s() const noexcept {
+            return static_cast<f64>(bitrate) * static_cast<f64>(poll_bus_budget) / static_cast<f64>(bits_per_frame);
+        }
+    };
+
+    // ─── Value request scheduler metrics ─────────────────────────────────────────
+    struct TCPollStats {
+        u64 sent = 0;
+        u64 deferred_budget = 0;   // due requests held back by the frame budget
+        u64 deferred_bus_load = 0; // update ticks skipped because the bus was busy
+        u32 max_lateness_ms = 0;   // worst send time past the due time
     };
 
     // ─── ISO 11783-10 Task Controller Server ─────────────────────────────────────
+    // Serves several implements at once. Clients are found through an
+    // address-indexed slot table; each activated DDOP yields a routing table of
+    // its process data (element, DDI) pairs, so incoming values are matched,
+    // timestamped and dispatched to per-DDI handlers. Periodic value requests
+    // are scheduled round-robin across clients and paced by a token bucket
+    // sized from the bus budget, pausing while measured bus load is high.
     class TaskControllerServer {
+        static constexpr u16 NO_CLIENT = 0xFFFF;
+        static constexpr u32 RATE_WINDOW_MS = 1000;
+
         IsoNet &net_;
         InternalCF *cf_;
+        TCServerConfig config_;
         StateMachine<TCServerState> state_{TCServerState::Disconnected};
         dp::Vector<TCClientInfo> clients_;
+        dp::Array<u16, 256> client_slot_;
         u8 server_options_ = 0;
         u32 status_timer_ms_ = 0;
         u8 tc_number_ = 0;
@@ -77,6 +209,9 @@ namespace agrobus::isobus::tc {
         u8 num_booms_ = 0;
         u8 num_sections_ = 0;
         u8 num_channels_ = 0;
+        DDOPCache ddop_cache_;
+        dp::Map<Address, u64> pending_names_; // set before the client's first message
+        TaskLogger *task_logger_ = nullptr;
 
         // Callbacks
         using ValueRequestCallback = std::function<Result<i32>(ElementNumber, DDI, TCClientInfo *)>;
@@ -84,16 +219,34 @@ namespace agrobus::isobus::tc {
             std::function<Result<ProcessDataAcknowledgeErrorCodes>(ElementNumber, DDI, i32, TCClientInfo *)>;
         using PeerControlCallback =
             std::function<Result<void>(ElementNumber src_element, DDI src_ddi, ElementNumber dst_element, DDI dst_ddi)>;
+        using RouteCallback = std::function<void(TCClientInfo &, const TCProcessRoute &)>;
 
         dp::Optional<ValueRequestCallback> value_request_cb_;
         dp::Optional<ValueCallback> value_cb_;
         dp::Optional<PeerControlCallback> peer_control_cb_;
+        dp::Map<DDI, dp::Vector<RouteCallback>> route_handlers_;
+
+        // Value request scheduling
+        struct PollRule {
+            DDI ddi = 0;
+            u32 interval_ms = 0;
+        };
+        dp::Vector<PollRule> poll_rules_;
+        f64 poll_tokens_ = 0.0;
+        usize poll_cursor_ = 0;
+        TCPollStats poll_stats_;
+        u32 now_ms_ = 0;
+        u32 rate_timer_ms_ = 0;
 
       public:
         TaskControllerServer(IsoNet &net, InternalCF *cf, TCServerConfig config = {})
-            : net_(net), cf_(cf), server_options_(config.server_options), tc_number_(config.tc_number),
-              tc_version_(config.tc_version), num_booms_(config.num_booms), num_sections_(config.num_sections),
-              num_channels_(config.num_channels) {}
+            : net_(net), cf_(cf), config_(config), server_options_(config.server_options),
+              tc_number_(config.tc_number), tc_version_(config.tc_version), num_booms_(config.num_booms),
+              num_sections_(config.num_sections), num_channels_(config.num_channels),
+              ddop_cache_(config.ddop_cache_entries) {
+            client_slot_.fill(NO_CLIENT);
+            poll_tokens_ = poll_burst();
+        }
 
         Result<void> start() {
             state_.transition(TCServerState::WaitForClients);
@@ -105,6 +258,7 @@ namespace agrobus::isobus::tc {
         Result<void> stop() {
             state_.transition(TCServerState::Disconnected);
             clients_.clear();
+            client_slot_.fill(NO_CLIENT);
             echo::category("isobus.tc.server").info("TC Server stopped");
             return {};
         }
@@ -116,13 +270,21 @@ namespace agrobus::isobus::tc {
         void on_value_received(ValueCallback cb) { value_cb_ = std::move(cb); }
         void on_peer_control_assignment(PeerControlCallback cb) { peer_control_cb_ = std::move(cb); }
 
+        // Called for every value on a known route with this DDI, from any client
+        void on_route_value(DDI ddi, RouteCallback cb) { route_handlers_[ddi].push_back(std::move(cb)); }
+
         // ─── Pool management ─────────────────────────────────────────────────────
         Result<ObjectPoolActivationError> activate_pool(TCClientInfo &client) {
             if (client.ddop.devices().empty()) {
                 return Result<ObjectPoolActivationError>::ok(ObjectPoolActivationError::ThereAreErrorsInTheDDOP);
             }
             client.pool_activated = true;
-            echo::category("isobus.tc.server").info("Pool activated for client ", client.address);
+            client.routes.build(client.ddop);
+            client.polls.clear();
+            for (const auto &rule : poll_rules_)
+                add_polls(client, rule);
+            echo::category("isobus.tc.server")
+                .info("Pool activated for client ", client.address, ": ", client.routes.size(), " routes");
             return Result<ObjectPoolActivationError>::ok(ObjectPoolActivationError::NoErrors);
         }
 
@@ -149,8 +311,84 @@ namespace agrobus::isobus::tc {
             return net_.send(PGN_TC_TO_ECU, data, cf_, dest, Priority::Default);
         }
 
+        // Subscribe to a value instead of polling it (time/distance interval,
+        // min/max threshold or change threshold)
+        Result<void> send_measurement_command(ProcessDataCommands cmd, ElementNumber element, DDI ddi, i32 value,
+                                              ControlFunction *dest) {
+            if (cmd < ProcessDataCommands::MeasurementTimeInterval || cmd > ProcessDataCommands::MeasurementChangeThreshold)
+                return Result<void>::err(Error::invalid_state("not a measurement command"));
+            dp::Vector<u8> data(8, 0xFF);
+            data[0] = (static_cast<u8>(cmd) & 0x0F) | ((static_cast<u8>(element) & 0x0F) << 4);
+            data[1] = static_cast<u8>((element >> 4) & 0xFF);
+            data[2] = static_cast<u8>(ddi & 0xFF);
+            data[3] = static_cast<u8>((ddi >> 8) & 0xFF);
+            data[4] = static_cast<u8>(value & 0xFF);
+            data[5] = static_cast<u8>((value >> 8) & 0xFF);
+            data[6] = static_cast<u8>((value >> 16) & 0xFF);
+            data[7] = static_cast<u8>((value >> 24) & 0xFF);
+            return net_.send(PGN_TC_TO_ECU, data, cf_, dest, Priority::Default);
+        }
+
         const dp::Vector<TCClientInfo> &clients() const noexcept { return clients_; }
 
+        TCClientInfo *client(Address addr) { return find_client(addr); }
+        const TCClientInfo *client(Address addr) const {
+            return client_slot_[addr] == NO_CLIENT ? nullptr : &clients_[client_slot_[addr]];
+        }
+
+        // ─── Routing and value requests ──────────────────────────────────────────
+        const TCProcessRoute *route(Address addr, ElementNumber element, DDI ddi) const {
+            const auto *c = client(addr);
+            return c ? c->routes.find(element, ddi) : nullptr;
+        }
+
+        // Milliseconds since the last value on a route (nullopt if none yet)
+        dp::Optional<u32> value_age_ms(Address addr, ElementNumber element, DDI ddi) const {
+            const auto *r = route(addr, element, ddi);
+            if (!r || !r->has_value)
+                return dp::nullopt;
+            return now_ms_ - r->updated_ms;
+        }
+
+        // Request every route with this DDI every interval_ms, in all current and
+        // future clients
+        void poll(DDI ddi, u32 interval_ms) {
+            PollRule rule{ddi, interval_ms};
+            poll_rules_.push_back(rule);
+            for (auto &c : clients_)
+                if (c.pool_activated)
+                    add_polls(c, rule);
+        }
+
+        // Request one route of one client periodically
+        Result<void> poll_value(Address addr, ElementNumber element, DDI ddi, u32 interval_ms) {
+            auto *c = find_client(addr);
+            if (!c || !c->routes.find(element, ddi))
+                return Result<void>::err(Error::invalid_state("no such process data route"));
+            c->polls.push_back({element, ddi, interval_ms, now_ms_});
+            return {};
+        }
+
+        const TCPollStats &poll_stats() const noexcept { return poll_stats_; }
+        u32 now_ms() const noexcept { return now_ms_; }
+
+        // ─── DDOP cache ──────────────────────────────────────────────────────────
+        // Clients are identified by NAME: taken from a claimed partner CF at the
+        // client's address, or set explicitly here. A NAME set for an address
+        // that has not spoken yet is applied when its first message arrives.
+        void set_client_name(Address addr, u64 name) {
+            if (auto *client = find_client(addr))
+                client->client_name = name;
+            else
+                pending_names_[addr] = name;
+        }
+
+        DDOPCache &ddop_cache() noexcept { return ddop_cache_; }
+        const DDOPCache &ddop_cache() const noexcept { return ddop_cache_; }
+
+        // Record every received process data value into a TLG (nullptr to stop)
+        void set_task_logger(TaskLogger *logger) { task_logger_ = logger; }
+
         // ─── Events ──────────────────────────────────────────────────────────────
         Event<TCServerState> on_state_change;
         Event<Address> on_client_connected;
@@ -162,14 +400,81 @@ namespace agrobus::isobus::tc {
             if (state_.state() == TCServerState::Disconnected)
                 return;
 
+            now_ms_ += elapsed_ms;
             status_timer_ms_ += elapsed_ms;
             if (status_timer_ms_ >= TC_STATUS_INTERVAL_MS) {
                 status_timer_ms_ -= TC_STATUS_INTERVAL_MS;
                 send_tc_status();
             }
+
+            rate_timer_ms_ += elapsed_ms;
+            if (rate_timer_ms_ >= RATE_WINDOW_MS) {
+                for (auto &c : clients_) {
+                    c.stats.messages_per_s = static_cast<f32>(c.stats.window_messages_) * 1000.0f / rate_timer_ms_;
+                    c.stats.window_messages_ = 0;
+                }
+                rate_timer_ms_ = 0;
+            }
+
+            run_polls(elapsed_ms);
         }
 
       private:
+        // ─── Value request scheduling ────────────────────────────────────────────
+        void add_polls(TCClientInfo &client, const PollRule &rule) {
+            for (const auto &r : client.routes.routes())
+                if (r.ddi == rule.ddi)
+                    client.polls.push_back({r.element, r.ddi, rule.interval_ms, now_ms_});
+        }
+
+        f64 poll_burst() const noexcept { return std::max(1.0, config_.poll_frames_per_s() / 10.0); }
+
+        // One due request per client per pass, starting after the client served
+        // last, until the budget runs out: every implement sees the same latency
+        void run_polls(u32 elapsed_ms) {
+            poll_tokens_ = std::min(poll_burst(), poll_tokens_ + config_.poll_frames_per_s() * elapsed_ms / 1000.0);
+            if (clients_.empty())
+                return;
+            if (net_.bus_load(0) > config_.poll_bus_limit) {
+                ++poll_stats_.deferred_bus_load;
+                return;
+            }
+
+            bool sent_any = true;
+            while (sent_any) {
+                sent_any = false;
+                for (usize n = 0; n < clients_.size(); ++n) {
+                    usize idx = (poll_cursor_ + n) % clients_.size();
+                    auto &c = clients_[idx];
+                    TCValuePoll *due = nullptr;
+                    for (auto &p : c.polls)
+                        if (static_cast<i32>(now_ms_ - p.due_ms) >= 0 && (!due || p.due_ms < due->due_ms))
+                            due = &p;
+                    if (!due)
+                        continue;
+                    if (poll_tokens_ < 1.0) {
+                        ++poll_stats_.deferred_budget;
+                        poll_cursor_ = idx;
+                        return;
+                    }
+                    ControlFunction dest;
+                    dest.address = c.address;
+                    if (!send_request_value(due->element, due->ddi, &dest).is_ok())
+                        continue;
+                    poll_tokens_ -= 1.0;
+                    poll_stats_.max_lateness_ms = std::max(poll_stats_.max_lateness_ms, now_ms_ - due->due_ms);
+                    ++poll_stats_.sent;
+                    ++c.stats.requests_sent;
+                    // Next slot on the fixed grid; skip slots missed while deferred
+                    due->due_ms += due->interval_ms;
+                    if (static_cast<i32>(now_ms_ - due->due_ms) >= 0)
+                        due->due_ms = now_ms_ + due->interval_ms;
+                    poll_cursor_ = (idx + 1) % clients_.size();
+                    sent_any = true;
+                }
+            }
+        }
+
         void send_tc_status() {
             dp::Vector<u8> data(8, 0xFF);
             data[0] = static_cast<u8>(ProcessDataCommands::Status);
@@ -189,6 +494,17 @@ namespace agrobus::isobus::tc {
             if (msg.data.empty())
                 return;
 
+            auto *known = find_client(msg.source);
+            if (known) {
+                ++known->stats.messages;
+                ++known->stats.window_messages_;
+                known->stats.last_message_ms = now_ms_;
+            }
+            // Device descriptor commands are handled in any state: a client that
+            // restarts at the same address begins the handshake again
+            if (handle_pool_command(msg))
+                return;
+
             u8 cmd = msg.data[0] & 0x0F;
 
             switch (static_cast<ProcessDataCommands>(cmd)) {
@@ -213,6 +529,140 @@ namespace agrobus::isobus::tc {
             }
         }
 
+        bool handle_pool_command(const Message &msg) {
+            switch (msg.data[0]) {
+            case tc_cmd::STRUCTURE_LABEL:
+            case tc_cmd::LOCALIZATION_LABEL:
+                handle_label_request(msg);
+                return true;
+            case tc_cmd::OBJECT_POOL_TRANSFER:
+                if (msg.data.size() <= 8)
+                    return false;
+                handle_pool_transfer(msg);
+                return true;
+            case tc_cmd::ACTIVATE_POOL:
+                handle_activate(msg);
+                return true;
+            case tc_cmd::DELETE_POOL:
+                ensure_client(msg.source);
+                if (auto *client = find_client(msg.source)) {
+                    reset_session(*client);
+                    client->ddop.clear();
+                    if (u64 name = name_of(*client))
+                        ddop_cache_.remove(name);
+                }
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        // Reply with the label of the pool stored for this client, 0xFF if none
+        void handle_label_request(const Message &msg) {
+            ensure_client(msg.source);
+            auto *client = find_client(msg.source);
+            // A label request starts a new session; the pool is reloaded on activation
+            reset_session(*client);
+            client->ddop.clear();
+            const CachedDDOP *cached = nullptr;
+            if (u64 name = name_of(*client))
+                cached = ddop_cache_.find(name);
+
+            bool structure = msg.data[0] == tc_cmd::STRUCTURE_LABEL;
+            dp::Vector<u8> data(8, 0xFF);
+            data[0] = structure ? tc_cmd::STRUCTURE_LABEL_RESPONSE : tc_cmd::LOCALIZATION_LABEL_RESPONSE;
+            if (cached) {
+                const auto &label = structure ? cached->structure_label : cached->localization_label;
+                for (usize i = 0; i < label.size(); ++i)
+                    data[1 + i] = label[i];
+            }
+            ControlFunction dest_cf;
+            dest_cf.address = msg.source;
+            net_.send(PGN_TC_TO_ECU, data, cf_, &dest_cf, Priority::Default);
+        }
+
+        void handle_pool_transfer(const Message &msg) {
+            ensure_client(msg.source);
+            auto *client = find_client(msg.source);
+            dp::Vector<u8> pool(msg.data.begin() + 1, msg.data.end());
+
+            dp::Vector<u8> response(8, 0xFF);
+            response[0] = tc_cmd::OBJECT_POOL_RESPONSE;
+            auto parsed = DDOP::deserialize(pool);
+            if (parsed.is_ok()) {
+                reset_session(*client);
+                client->ddop = std::move(parsed.value());
+                if (u64 name = name_of(*client))
+                    ddop_cache_.store(name, std::move(pool));
+                response[1] = static_cast<u8>(ObjectPoolErrorCodes::NoErrors);
+                echo::category("isobus.tc.server")
+                    .info("DDOP received from ", msg.source, ": ", client->ddop.object_count(), " objects");
+            } else {
+                response[1] = static_cast<u8>(ObjectPoolErrorCodes::AnyOtherError);
+                echo::category("isobus.tc.server").warn("invalid DDOP from ", msg.source);
+            }
+            ControlFunction dest_cf;
+            dest_cf.address = msg.source;
+            net_.send(PGN_TC_TO_ECU, response, cf_, &dest_cf, Priority::Default);
+        }
+
+        // Byte 1 is the activation code: 0x00 deactivates, anything else activates.
+        // Activation without a transfer in this session uses the cached pool.
+        void handle_activate(const Message &msg) {
+            ensure_client(msg.source);
+            auto *client = find_client(msg.source);
+            dp::Vector<u8> response(8, 0xFF);
+            response[0] = tc_cmd::ACTIVATE_RESPONSE;
+            ControlFunction dest_cf;
+            dest_cf.address = msg.source;
+
+            if (msg.data.size() > 1 && msg.data[1] == 0x00) {
+                reset_session(*client);
+                response[1] = static_cast<u8>(ObjectPoolActivationError::NoErrors);
+                net_.send(PGN_TC_TO_ECU, response, cf_, &dest_cf, Priority::Default);
+                echo::category("isobus.tc.server").info("Pool deactivated for client ", msg.source);
+                return;
+            }
+
+            if (client->ddop.devices().empty()) {
+                if (u64 name = name_of(*client)) {
+                    if (const auto *cached = ddop_cache_.find(name)) {
+                        client->ddop = cached->ddop;
+                        echo::category("isobus.tc.server").info("activating cached DDOP for ", msg.source);
+                    }
+                }
+            }
+
+            auto result = activate_pool(*client);
+            auto error = result.is_ok() ? result.value() : ObjectPoolActivationError::AnyOtherError;
+            if (error != ObjectPoolActivationError::NoErrors)
+                on_pool_activation_error.emit(error);
+
+            response[1] = static_cast<u8>(error);
+            net_.send(PGN_TC_TO_ECU, response, cf_, &dest_cf, Priority::Default);
+        }
+
+        // Drop the active pool and everything derived from it
+        void reset_session(TCClientInfo &client) {
+            client.pool_activated = false;
+            client.routes.clear();
+            client.polls.clear();
+        }
+
+        u64 pending_name(Address addr) const {
+            auto it = pending_names_.find(addr);
+            return it != pending_names_.end() ? it->second : 0;
+        }
+
+        u64 name_of(const TCClientInfo &client) {
+            if (client.client_name != 0)
+                return client.client_name;
+            for (auto &partner : net_.partner_cfs())
+                if (partner.address() == client.address)
+                    return partner.cf().name.raw;
+            return 0;
+        }
+
         void handle_tech_capabilities(const Message &msg) {
             ensure_client(msg.source);
 
@@ -247,12 +697,35 @@ namespace agrobus::isobus::tc {
                         (static_cast<i32>(msg.data[6]) << 16) | (static_cast<i32>(msg.data[7]) << 24);
 
             auto *client = find_client(msg.source);
+            if (task_logger_) {
+                u64 name = client ? name_of(*client) : pending_name(msg.source);
+                task_logger_->log(name ? name : msg.source, element, ddi, value);
+            }
+            if (client)
+                route_value(*client, element, ddi, value);
             if (value_cb_.has_value() && client) {
                 auto result = (*value_cb_)(element, ddi, value, client);
                 (void)result;
             }
         }
 
+        void route_value(TCClientInfo &client, ElementNumber element, DDI ddi, i32 value) {
+            auto *route = client.routes.find(element, ddi);
+            if (!route) {
+                ++client.stats.unrouted;
+                return;
+            }
+            route->value = value;
+            route->has_value = true;
+            route->updated_ms = now_ms_;
+            ++route->received;
+            ++client.stats.values;
+            auto it = route_handlers_.find(ddi);
+            if (it != route_handlers_.end())
+                for (auto &cb : it->second)
+                    cb(client, *route);
+        }
+
         void handle_request_value(const Message &msg) {
             if (msg.data.size() < 4)
                 return;
@@ -316,11 +789,17 @@ namespace agrobus::isobus::tc {
         }
 
         void ensure_client(Address addr) {
-            for (auto &c : clients_) {
-                if (c.address == addr)
-                    return;
+            if (client_slot_[addr] != NO_CLIENT)
+                return;
+            client_slot_[addr] = static_cast<u16>(clients_.size());
+            TCClientInfo info;
+            info.address = addr;
+            info.stats.last_message_ms = now_ms_;
+            if (auto it = pending_names_.find(addr); it != pending_names_.end()) {
+                info.client_name = it->second;
+                pending_names_.erase(it);
             }
-            clients_.push_back({addr, {}, false, 0});
+            clients_.push_back(std::move(info));
             echo::category("isobus.tc.server").info("client connected: addr=", addr);
             on_client_connected.emit(addr);
 
@@ -331,11 +810,7 @@ namespace agrobus::isobus::tc {
         }
 
         TCClientInfo *find_client(Address addr) {
-            for (auto &c : clients_) {
-                if (c.address == addr)
-                    return &c;
-            }
-            return nullptr;
+            return client_slot_[addr] == NO_CLIENT ? nullptr : &clients_[client_slot_[addr]];
         }
     };
 
@@ -0,0 +1,496 @@
+#pragma once
+
+#include "geo.hpp"
+#include "objects.hpp"
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/types.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <datapod/datapod.hpp>
+#include <deque>
+#include <echo/echo.hpp>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace agrobus::isobus::tc {
+    using namespace agrobus::net;
+
+    // ─── Task log configuration ──────────────────────────────────────────────────
+    struct TaskLogConfig {
+        std::filesystem::path directory = "tasklog";
+        usize block_samples = 4096;   // samples per columnar block
+        usize max_blocks = 64;        // hard memory bound across all clients
+        u32 flush_interval_ms = 1000; // hand partially filled blocks to the writer
+        bool log_position = true;     // add a PTN (north, east, status) to each record
+
+        TaskLogConfig &path(std::filesystem::path dir) {
+            directory = std::move(dir);
+            return *this;
+        }
+        TaskLogConfig &blocks(usize samples_per_block, usize max) {
+            block_samples = samples_per_block ? samples_per_block : 1;
+            max_blocks = max ? max : 1;
+            return *this;
+        }
+        TaskLogConfig &flush_interval(u32 ms) {
+            flush_interval_ms = ms;
+            return *this;
+        }
+        TaskLogConfig &position(bool enable) {
+            log_position = enable;
+            return *this;
+        }
+    };
+
+    struct TaskLogStats {
+        u64 samples = 0;       // accepted into a block
+        u64 dropped = 0;       // rejected: no free block
+        u64 unmapped = 0;      // rejected: more than 255 DLVs for one client
+        u64 records = 0;       // binary records written
+        u64 bytes_written = 0; // binary bytes written
+        u64 blocks_written = 0;
+    };
+
+    // ─── Columnar sample block ───────────────────────────────────────────────────
+    // Samples are appended column by column so the ingest path is a handful of
+    // stores into preallocated arrays. Blocks circulate between a free list, the
+    // per-client active slot and the writer queue; none are allocated after start.
+    struct TaskLogBlock {
+        usize client = 0;
+        usize count = 0;
+        u32 opened_ms = 0;
+        dp::Vector<u64> time_ms; // ms since 1980-01-01
+        dp::Vector<u8> dlv;
+        dp::Vector<i32> value;
+        dp::Vector<i32> north; // 1e-7 degrees
+        dp::Vector<i32> east;
+        dp::Vector<u8> fix;
+        dp::Vector<std::pair<ElementNumber, DDI>> header; // DLV table snapshot, empty if unchanged
+
+        explicit TaskLogBlock(usize capacity)
+            : time_ms(capacity), dlv(capacity), value(capacity), north(capacity), east(capacity), fix(capacity) {}
+
+        bool full() const noexcept { return count == time_ms.size(); }
+    };
+
+    // ─── Binary task log writer ──────────────────────────────────────────────────
+    // Records process data received by a TC server into ISO 11783-10 TimeLog
+    // files: TLGnnnnn.bin holds the records, TLGnnnnn.xml the TIM/PTN/DLV header
+    // describing them. One TLG pair per client. log() only appends to an
+    // in-memory block; encoding and file I/O run on a background thread, and a
+    // full pool of blocks drops samples (counted) instead of blocking the bus.
+    //
+    // Record layout (little endian):
+    //   [ms since midnight u32][days since 1980-01-01 u16]
+    //   [north i32][east i32][status u8]          (only with log_position)
+    //   [DLV count u8] count x [DLV index u8][value i32]
+    // Consecutive samples with the same timestamp share one record.
+    class TaskLogger {
+        struct ClientSlot {
+            u64 key = 0;
+            u32 file_number = 0;
+            dp::Map<u32, u8> dlv_index; // (element << 16 | ddi) -> DLV index
+            dp::Vector<std::pair<ElementNumber, DDI>> dlvs;
+            bool header_dirty = false;
+            std::unique_ptr<TaskLogBlock> active;
+        };
+
+        TaskLogConfig config_;
+        dp::Vector<ClientSlot> slots_;
+        dp::Map<u64, usize> slot_of_;
+        u32 next_file_number_ = 1;
+
+        // Clock: wall clock by default, manual after set_time()
+        bool manual_clock_ = false;
+        u64 manual_ms_ = 0;
+        u32 uptime_ms_ = 0;
+
+        const TCGEOInterface *geo_ = nullptr;
+        dp::Optional<GeoPoint> position_;
+
+        // Shared with the writer thread
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::condition_variable idle_cv_;
+        std::deque<std::unique_ptr<TaskLogBlock>> queue_;
+        dp::Vector<std::unique_ptr<TaskLogBlock>> free_;
+        dp::Vector<dp::String> paths_; // file stem per slot
+        usize allocated_ = 0;
+        bool busy_ = false;
+        bool stop_ = false;
+        std::thread writer_;
+
+        std::atomic<u64> samples_{0};
+        std::atomic<u64> dropped_{0};
+        std::atomic<u64> unmapped_{0};
+        std::atomic<u64> records_{0};
+        std::atomic<u64> bytes_{0};
+        std::atomic<u64> blocks_written_{0};
+
+        static constexpr u64 MS_PER_DAY = 86400000ull;
+        // 1970-01-01 -> 1980-01-01
+        static constexpr u64 EPOCH_1980_MS = 315532800000ull;
+        // Worst case: a record per sample (time 6, position 9, count 1, DLV 5)
+        static constexpr usize MAX_SAMPLE_BYTES = 21;
+
+      public:
+        explicit TaskLogger(TaskLogConfig config = {}) : config_(std::move(config)) {}
+        ~TaskLogger() { stop(); }
+
+        TaskLogger(const TaskLogger &) = delete;
+        TaskLogger &operator=(const TaskLogger &) = delete;
+
+        Result<void> start() {
+            if (writer_.joinable())
+                return {};
+            std::error_code ec;
+            std::filesystem::create_directories(config_.directory, ec);
+            if (ec)
+                return Result<void>::err(Error::invalid_state("cannot create task log directory"));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = false;
+            }
+            writer_ = std::thread([this] { run(); });
+            echo::category("isobus.tc.log").info("task log writing to ", config_.directory.string());
+            return {};
+        }
+
+        // Hand every buffered sample to the writer, then stop it
+        void stop() {
+            if (!writer_.joinable())
+                return;
+            flush();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            writer_.join();
+        }
+
+        bool running() const noexcept { return writer_.joinable(); }
+
+        // ─── Time and position ───────────────────────────────────────────────────
+        // Switch to a manual clock (tests, replay); update() advances it
+        void set_time(u16 days_since_1980, u32 ms_since_midnight) {
+            manual_clock_ = true;
+            manual_ms_ = static_cast<u64>(days_since_1980) * MS_PER_DAY + ms_since_midnight;
+        }
+
+        u64 now_ms() const {
+            if (manual_clock_)
+                return manual_ms_;
+            auto since_epoch = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count();
+            return static_cast<u64>(since_epoch) - EPOCH_1980_MS;
+        }
+
+        void set_position_source(const TCGEOInterface *geo) { geo_ = geo; }
+        void set_position(const GeoPoint &position) { position_ = position; }
+
+        // ─── Ingest ──────────────────────────────────────────────────────────────
+        // Called from the bus thread. Returns false if the sample was dropped.
+        bool log(u64 client_key, ElementNumber element, DDI ddi, i32 value) {
+            auto &slot = slot_for(client_key);
+            u32 dlv_key = (static_cast<u32>(element) << 16) | ddi;
+            auto it = slot.dlv_index.find(dlv_key);
+            u8 index = 0;
+            if (it != slot.dlv_index.end()) {
+                index = it->second;
+            } else {
+                if (slot.dlvs.size() >= 255) {
+                    unmapped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                index = static_cast<u8>(slot.dlvs.size());
+                slot.dlv_index[dlv_key] = index;
+                slot.dlvs.push_back({element, ddi});
+                slot.header_dirty = true;
+            }
+
+            if (!slot.active) {
+                slot.active = acquire();
+                if (!slot.active) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                slot.active->client = static_cast<usize>(&slot - slots_.data());
+                slot.active->opened_ms = uptime_ms_;
+            }
+
+            auto &block = *slot.active;
+            usize i = block.count++;
+            block.time_ms[i] = now_ms();
+            block.dlv[i] = index;
+            block.value[i] = value;
+            if (config_.log_position) {
+                const dp::Optional<GeoPoint> &pos = geo_ ? geo_->current_position() : position_;
+                if (pos.has_value()) {
+                    block.north[i] = static_cast<i32>(pos->position.latitude * 1e7);
+                    block.east[i] = static_cast<i32>(pos->position.longitude * 1e7);
+                    block.fix[i] = 1; // GNSS fix
+                } else {
+                    block.north[i] = 0;
+                    block.east[i] = 0;
+                    block.fix[i] = 0; // no fix
+                }
+            }
+            samples_.fetch_add(1, std::memory_order_relaxed);
+
+            if (block.full())
+                submit(slot);
+            return true;
+        }
+
+        // Advance the manual clock and hand over blocks older than the flush interval
+        void update(u32 elapsed_ms) {
+            uptime_ms_ += elapsed_ms;
+            if (manual_clock_)
+                manual_ms_ += elapsed_ms;
+            for (auto &slot : slots_)
+                if (slot.active && uptime_ms_ - slot.active->opened_ms >= config_.flush_interval_ms)
+                    submit(slot);
+        }
+
+        // Submit all active blocks and wait until the writer has drained them
+        void flush() {
+            for (auto &slot : slots_)
+                if (slot.active)
+                    submit(slot);
+            if (!writer_.joinable())
+                return;
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_cv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+        }
+
+        // ─── Introspection ───────────────────────────────────────────────────────
+        TaskLogStats stats() const {
+            TaskLogStats s;
+            s.samples = samples_.load(std::memory_order_relaxed);
+            s.dropped = dropped_.load(std::memory_order_relaxed);
+            s.unmapped = unmapped_.load(std::memory_order_relaxed);
+            s.records = records_.load(std::memory_order_relaxed);
+            s.bytes_written = bytes_.load(std::memory_order_relaxed);
+            s.blocks_written = blocks_written_.load(std::memory_order_relaxed);
+            return s;
+        }
+
+        usize client_count() const noexcept { return slots_.size(); }
+
+        // Binary file of a client, empty if it never logged
+        std::filesystem::path binary_path(u64 client_key) const {
+            auto it = slot_of_.find(client_key);
+            if (it == slot_of_.end())
+                return {};
+            return config_.directory / (file_stem(slots_[it->second].file_number) + ".bin");
+        }
+        std::filesystem::path header_path(u64 client_key) const {
+            auto it = slot_of_.find(client_key);
+            if (it == slot_of_.end())
+                return {};
+            return config_.directory / (file_stem(slots_[it->second].file_number) + ".xml");
+        }
+
+        // Upper bound of sample memory held by this logger
+        usize memory_bound() const noexcept {
+            return config_.max_blocks * config_.block_samples *
+                   (sizeof(u64) + sizeof(u8) + sizeof(i32) * 3 + sizeof(u8));
+        }
+
+      private:
+        static dp::String file_stem(u32 number) {
+            char buf[16];
+            std::snprintf(buf, sizeof(buf), "TLG%05u", number % 100000);
+            return dp::String(buf);
+        }
+
+        ClientSlot &slot_for(u64 key) {
+            auto it = slot_of_.find(key);
+            if (it != slot_of_.end())
+                return slots_[it->second];
+            // Blocks refer to slots by index, so slots are never erased
+            ClientSlot slot;
+            slot.key = key;
+            slot.file_number = next_file_number_++;
+            slots_.push_back(std::move(slot));
+            slot_of_[key] = slots_.size() - 1;
+            echo::category("isobus.tc.log").debug("client ", key, " logs to ", file_stem(slots_.back().file_number));
+            return slots_.back();
+        }
+
+        std::unique_ptr<TaskLogBlock> acquire() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_.empty()) {
+                auto block = std::move(free_.back());
+                free_.pop_back();
+                return block;
+            }
+            if (allocated_ >= config_.max_blocks)
+                return nullptr;
+            ++allocated_;
+            return std::make_unique<TaskLogBlock>(config_.block_samples);
+        }
+
+        void submit(ClientSlot &slot) {
+            auto block = std::move(slot.active);
+            if (!block || block->count == 0) {
+                if (block)
+                    release(std::move(block));
+                return;
+            }
+            if (slot.header_dirty) {
+                block->header = slot.dlvs;
+                slot.header_dirty = false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (paths_.size() < slots_.size())
+                    for (usize i = paths_.size(); i < slots_.size(); ++i)
+                        paths_.push_back(file_stem(slots_[i].file_number));
+                queue_.push_back(std::move(block));
+            }
+            cv_.notify_one();
+        }
+
+        void release(std::unique_ptr<TaskLogBlock> block) {
+            block->count = 0;
+            block->header.clear();
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(std::move(block));
+        }
+
+        // ─── Writer thread ───────────────────────────────────────────────────────
+        void run() {
+            dp::Vector<u8> out;
+            dp::Map<usize, std::FILE *> files; // binary files stay open, writer thread only
+            for (;;) {
+                std::unique_ptr<TaskLogBlock> block;
+                dp::String stem;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                    if (queue_.empty()) {
+                        busy_ = false;
+                        idle_cv_.notify_all();
+                        if (stop_)
+                            break;
+                        continue;
+                    }
+                    block = std::move(queue_.front());
+                    queue_.pop_front();
+                    stem = paths_[block->client];
+                    busy_ = true;
+                }
+
+                auto &file = files[block->client];
+                write_block(*block, stem, file, out);
+                release(std::move(block));
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    busy_ = false;
+                    if (queue_.empty())
+                        idle_cv_.notify_all();
+                }
+            }
+            for (auto &[client, file] : files)
+                if (file)
+                    std::fclose(file);
+        }
+
+        template <typename T> static u8 *put(u8 *p, T v) {
+            for (usize b = 0; b < sizeof(T); ++b)
+                *p++ = static_cast<u8>(static_cast<u64>(v) >> (8 * b));
+            return p;
+        }
+
+        // Returns the encoded size; out must hold MAX_SAMPLE_BYTES per sample
+        usize encode(const TaskLogBlock &block, u8 *out, u64 &records) const {
+            u8 *p = out;
+            usize i = 0;
+            while (i < block.count) {
+                u64 t = block.time_ms[i];
+                usize end = i + 1;
+                while (end < block.count && end - i < 255 && block.time_ms[end] == t)
+                    ++end;
+
+                p = put(p, static_cast<u32>(t % MS_PER_DAY));
+                p = put(p, static_cast<u16>(t / MS_PER_DAY));
+                if (config_.log_position) {
+                    p = put(p, block.north[i]);
+                    p = put(p, block.east[i]);
+                    *p++ = block.fix[i];
+                }
+                *p++ = static_cast<u8>(end - i);
+                for (usize k = i; k < end; ++k) {
+                    *p++ = block.dlv[k];
+                    p = put(p, block.value[k]);
+                }
+                ++records;
+                i = end;
+            }
+            return static_cast<usize>(p - out);
+        }
+
+        void write_block(const TaskLogBlock &block, const dp::String &stem, std::FILE *&file,
+                         dp::Vector<u8> &out) {
+            if (!block.header.empty())
+                write_header(block.header, stem);
+
+            auto path = config_.directory / (std::string(stem.c_str()) + ".bin");
+            if (!file)
+                file = std::fopen(path.string().c_str(), "ab");
+            if (!file) {
+                echo::category("isobus.tc.log").error("cannot open ", path.string());
+                dropped_.fetch_add(block.count, std::memory_order_relaxed);
+                return;
+            }
+
+            out.resize(block.count * MAX_SAMPLE_BYTES);
+            u64 records = 0;
+            usize size = encode(block, out.data(), records);
+            usize written = std::fwrite(out.data(), 1, size, file);
+            std::fflush(file);
+            if (written != size)
+                echo::category("isobus.tc.log").error("short write to ", path.string());
+
+            records_.fetch_add(records, std::memory_order_relaxed);
+            bytes_.fetch_add(written, std::memory_order_relaxed);
+            blocks_written_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // TIM with binary (empty) attributes; rewritten whenever the DLV table grows
+        void write_header(const dp::Vector<std::pair<ElementNumber, DDI>> &dlvs, const dp::String &stem) const {
+            auto path = config_.directory / (std::string(stem.c_str()) + ".xml");
+            auto tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream file(tmp, std::ios::trunc);
+                if (!file) {
+                    echo::category("isobus.tc.log").error("cannot write ", path.string());
+                    return;
+                }
+                file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+                file << "<TIM A=\"\" D=\"4\">\n";
+                if (config_.log_position)
+                    file << "<PTN A=\"\" B=\"\" D=\"\"/>\n";
+                char line[64];
+                for (const auto &[element, ddi] : dlvs) {
+                    std::snprintf(line, sizeof(line), "<DLV A=\"%04X\" B=\"\" C=\"DET-%u\"/>\n", ddi,
+                                  static_cast<unsigned>(element));
+                    file << line;
+                }
+                file << "</TIM>\n";
+            }
+            std::error_code ec;
+            std::filesystem::rename(tmp, path, ec);
+        }
+    };
+
+} // namespace agrobus::isobus::tc
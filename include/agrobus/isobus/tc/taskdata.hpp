@@ -0,0 +1,463 @@
+#pragma once
+
+#include "ddop.hpp"
+#include "objects.hpp"
+#include "prescription_index.hpp"
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/mapped_file.hpp>
+#include <agrobus/net/types.hpp>
+#include <agrobus/net/xml_reader.hpp>
+#include <concord/concord.hpp>
+#include <cstring>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+#include <filesystem>
+#include <functional>
+
+namespace agrobus::isobus::tc {
+    using namespace agrobus::net;
+
+    // ─── Imported TASKDATA objects ───────────────────────────────────────────────
+    struct TaskDataPartfield {
+        dp::String id; // PFD A, e.g. "PFD1"
+        dp::String designator;
+        dp::Vector<concord::earth::WGS> boundary;          // exterior ring of the partfield boundary
+        dp::Vector<dp::Vector<concord::earth::WGS>> holes; // interior rings (obstacles)
+    };
+
+    struct TaskDataTask {
+        dp::String id; // TSK A, e.g. "TSK1"
+        dp::String designator;
+        dp::String partfield;                  // PFD reference, may be empty
+        DDI rate_ddi = 0;                      // DDI the prescription rates belong to
+        PrescriptionMap zones;                 // polygon treatment zones
+        dp::Optional<RasterPrescription> grid; // GRD prescription
+    };
+
+    struct TaskDataDevice {
+        dp::String id; // DVC A, e.g. "DVC1"
+        u64 client_name = 0;
+        DDOP ddop;
+    };
+
+    struct TaskDataStats {
+        usize bytes = 0;
+        usize elements = 0;
+        usize tasks = 0;
+        usize partfields = 0;
+        usize devices = 0;
+        usize zones = 0;
+        usize grid_cells = 0;
+    };
+
+    // Receives each top-level object as soon as its closing tag is read
+    struct TaskDataHandlers {
+        std::function<void(TaskDataTask &&)> on_task;
+        std::function<void(TaskDataPartfield &&)> on_partfield;
+        std::function<void(TaskDataDevice &&)> on_device;
+    };
+
+    struct TaskDataConfig {
+        DDI rate_ddi = 0; // prescription DDI to import; 0 = first PDV of each zone
+        bool load_grids = true;
+
+        TaskDataConfig &rate(DDI ddi) {
+            rate_ddi = ddi;
+            return *this;
+        }
+        TaskDataConfig &grids(bool enable) {
+            load_grids = enable;
+            return *this;
+        }
+    };
+
+    // Everything from one TASKDATA set, for callers that want it all at once
+    struct TaskDataSet {
+        dp::Vector<TaskDataTask> tasks;
+        dp::Vector<TaskDataPartfield> partfields;
+        dp::Vector<TaskDataDevice> devices;
+        TaskDataStats stats;
+    };
+
+    // ─── ISO 11783-10 TASKDATA reader ────────────────────────────────────────────
+    // Streams TASKDATA.XML through XmlReader over a memory-mapped file: parser
+    // state is the object currently open, so memory does not grow with the
+    // document, and every task, partfield and device is handed to the callbacks
+    // when it closes. Grid (GRD) binaries next to the XML are memory-mapped and
+    // converted straight into RasterPrescription cells. Devices become DDOPs with
+    // the object IDs from the XML, ready for the DDOP cache or a TC server.
+    class TaskDataReader {
+        struct Zone {
+            u8 code = 0;
+            dp::Vector<std::pair<DDI, i32>> values; // PDVs in document order
+            dp::Vector<dp::Vector<concord::earth::WGS>> polygons;
+        };
+        struct Grid {
+            f64 min_north = 0, min_east = 0, cell_north = 0, cell_east = 0;
+            u32 columns = 0, rows = 0;
+            dp::String file;
+            u8 type = 1;
+            u8 zone_code = 0;
+        };
+
+        TaskDataConfig config_;
+        std::filesystem::path directory_;
+        TaskDataStats stats_;
+
+        // Parse state: the objects currently open
+        dp::Optional<TaskDataPartfield> pfd_;
+        dp::Optional<TaskDataTask> task_;
+        dp::Vector<Zone> zones_;
+        dp::Optional<Grid> grid_;
+        bool in_zone_ = false;
+        dp::Optional<TaskDataDevice> device_;
+        dp::Optional<DeviceElement> element_;
+        u8 polygon_type_ = 0;
+        u8 line_type_ = 0;
+        dp::Vector<concord::earth::WGS> points_;
+
+      public:
+        explicit TaskDataReader(TaskDataConfig config = {}) : config_(config) {}
+
+        // Read TASKDATA.XML from a directory (or the file itself)
+        Result<TaskDataStats> read(const std::filesystem::path &path, const TaskDataHandlers &handlers) {
+            std::filesystem::path file = path;
+            if (std::filesystem::is_directory(path)) {
+                file = path / "TASKDATA.XML";
+                if (!std::filesystem::exists(file))
+                    file = path / "TASKDATA.xml";
+            }
+            auto mapped = MappedFile::open(file);
+            if (!mapped)
+                return Result<TaskDataStats>::err(Error::invalid_state("cannot open " + dp::String(file.string())));
+            mapped->advise_sequential();
+            return read(std::string_view(reinterpret_cast<const char *>(mapped->data()), mapped->size()),
+                        file.parent_path(), handlers);
+        }
+
+        // Read an in-memory document; grid files are looked up in `directory`
+        Result<TaskDataStats> read(std::string_view xml, const std::filesystem::path &directory,
+                                   const TaskDataHandlers &handlers) {
+            reset();
+            directory_ = directory;
+            stats_.bytes = xml.size();
+            XmlReader reader(xml);
+            bool root_seen = false;
+            for (;;) {
+                auto ev = reader.next();
+                if (ev == XmlReader::Event::Eof)
+                    break;
+                if (ev == XmlReader::Event::Error)
+                    return Result<TaskDataStats>::err(Error::invalid_state(
+                        dp::String("TASKDATA: ") + reader.error() + " at byte " + dp::to_string(reader.offset())));
+                if (ev == XmlReader::Event::Start) {
+                    ++stats_.elements;
+                    if (!root_seen) {
+                        if (reader.name() != "ISO11783_TaskData")
+                            return Result<TaskDataStats>::err(Error::invalid_state("not an ISO 11783 TASKDATA file"));
+                        root_seen = true;
+                        continue;
+                    }
+                    start(reader);
+                } else {
+                    end(reader.name(), handlers);
+                }
+            }
+            if (!root_seen)
+                return Result<TaskDataStats>::err(Error::invalid_state("not an ISO 11783 TASKDATA file"));
+            echo::category("isobus.tc.taskdata")
+                .info("TASKDATA: ", stats_.tasks, " tasks, ", stats_.partfields, " partfields, ", stats_.devices,
+                      " devices, ", stats_.elements, " elements");
+            return Result<TaskDataStats>::ok(stats_);
+        }
+
+        // ─── Attribute helpers ───────────────────────────────────────────────────
+        // "DVC-12", "DET12" -> 12 (the numeric part of an XML object id)
+        static dp::Optional<u32> id_number(std::string_view id) {
+            usize i = 0;
+            while (i < id.size() && !(id[i] >= '0' && id[i] <= '9'))
+                ++i;
+            return XmlReader::to_int<u32>(id.substr(i));
+        }
+
+        // 14 hex digits -> 7 label bytes
+        static dp::Array<u8, 7> hex_label(std::string_view hex) {
+            dp::Array<u8, 7> label = {};
+            for (usize i = 0; i < 7 && 2 * i + 1 < hex.size(); ++i)
+                label[i] = XmlReader::to_int<u8>(hex.substr(2 * i, 2), 16).value_or(0);
+            return label;
+        }
+
+      private:
+        void reset() {
+            stats_ = {};
+            pfd_.reset();
+            task_.reset();
+            zones_.clear();
+            grid_.reset();
+            in_zone_ = false;
+            device_.reset();
+            element_.reset();
+            points_.clear();
+        }
+
+        static dp::String text(const XmlReader &r, std::string_view name) { return XmlReader::unescape(r.attr(name)); }
+        template <typename T> static T num(const XmlReader &r, std::string_view name, T fallback = 0, int base = 10) {
+            return XmlReader::to_int<T>(r.attr(name), base).value_or(fallback);
+        }
+        static f64 real(const XmlReader &r, std::string_view name) { return XmlReader::to_f64(r.attr(name)).value_or(0.0); }
+
+        void start(const XmlReader &r) {
+            auto n = r.name();
+            if (n == "PNT") {
+                points_.push_back(concord::earth::WGS(real(r, "C"), real(r, "D"), real(r, "E") / 1000.0));
+            } else if (n == "LSG") {
+                line_type_ = num<u8>(r, "A");
+                points_.clear();
+            } else if (n == "PLN") {
+                polygon_type_ = num<u8>(r, "A");
+            } else if (n == "PDV" && in_zone_) {
+                zones_.back().values.push_back({num<DDI>(r, "A", 0, 16), num<i32>(r, "B")});
+            } else if (n == "TZN" && task_) {
+                zones_.push_back(Zone{num<u8>(r, "A"), {}, {}});
+                in_zone_ = true;
+            } else if (n == "GRD" && task_) {
+                Grid g;
+                g.min_north = real(r, "A");
+                g.min_east = real(r, "B");
+                g.cell_north = real(r, "C");
+                g.cell_east = real(r, "D");
+                g.columns = num<u32>(r, "E");
+                g.rows = num<u32>(r, "F");
+                g.file = dp::String(r.attr("G"));
+                g.type = num<u8>(r, "I", 1);
+                g.zone_code = num<u8>(r, "J");
+                grid_ = std::move(g);
+            } else if (n == "TSK") {
+                TaskDataTask t;
+                t.id = dp::String(r.attr("A"));
+                t.designator = text(r, "B");
+                t.partfield = dp::String(r.attr("E"));
+                t.zones.structure_label = t.id;
+                task_ = std::move(t);
+                zones_.clear();
+                grid_.reset();
+            } else if (n == "PFD") {
+                TaskDataPartfield p;
+                p.id = dp::String(r.attr("A"));
+                p.designator = text(r, "C");
+                pfd_ = std::move(p);
+            } else if (n == "DVC") {
+                TaskDataDevice d;
+                d.id = dp::String(r.attr("A"));
+                d.client_name = num<u64>(r, "D", 0, 16);
+                DeviceObject obj;
+                obj.id = static_cast<ObjectID>(id_number(d.id).value_or(0));
+                obj.designator = text(r, "B");
+                obj.software_version = text(r, "C");
+                obj.serial_number = text(r, "E");
+                obj.structure_label = hex_label(r.attr("F"));
+                obj.localization_label = hex_label(r.attr("G"));
+                if (obj.designator.empty())
+                    obj.designator = d.id;
+                d.ddop.add_device(std::move(obj));
+                device_ = std::move(d);
+            } else if (device_) {
+                start_device_object(r, n);
+            }
+        }
+
+        void start_device_object(const XmlReader &r, std::string_view n) {
+            if (n == "DET") {
+                flush_element();
+                DeviceElement e;
+                e.id = num<ObjectID>(r, "B");
+                e.type = static_cast<DeviceElementType>(num<u8>(r, "C", 1));
+                e.designator = text(r, "D");
+                e.number = num<ElementNumber>(r, "E");
+                e.parent_id = num<ObjectID>(r, "F");
+                element_ = std::move(e);
+            } else if (n == "DOR" && element_) {
+                element_->child_objects.push_back(num<ObjectID>(r, "A"));
+            } else if (n == "DPD") {
+                DeviceProcessData pd;
+                pd.id = num<ObjectID>(r, "A");
+                pd.ddi = num<DDI>(r, "B", 0, 16);
+                pd.trigger_methods = num<u8>(r, "D");
+                pd.designator = text(r, "E");
+                pd.presentation_object_id = num<ObjectID>(r, "F", 0xFFFF);
+                device_->ddop.add_process_data(std::move(pd));
+            } else if (n == "DPT") {
+                DeviceProperty pt;
+                pt.id = num<ObjectID>(r, "A");
+                pt.ddi = num<DDI>(r, "B", 0, 16);
+                pt.value = num<i32>(r, "C");
+                pt.designator = text(r, "D");
+                pt.presentation_object_id = num<ObjectID>(r, "E", 0xFFFF);
+                device_->ddop.add_property(std::move(pt));
+            } else if (n == "DVP") {
+                DeviceValuePresentation vp;
+                vp.id = num<ObjectID>(r, "A");
+                vp.offset = num<i32>(r, "B");
+                vp.scale = static_cast<f32>(XmlReader::to_f64(r.attr("C")).value_or(1.0));
+                vp.decimal_digits = num<u8>(r, "D");
+                vp.unit_designator = text(r, "E");
+                device_->ddop.add_value_presentation(std::move(vp));
+            }
+        }
+
+        void flush_element() {
+            if (element_ && device_) {
+                device_->ddop.add_element(std::move(*element_));
+                element_.reset();
+            }
+        }
+
+        void end(std::string_view n, const TaskDataHandlers &handlers) {
+            if (n == "LSG") {
+                // Exterior rings (type 1) become boundaries, interior rings (2) holes
+                if (points_.size() >= 3) {
+                    if (in_zone_ && line_type_ == 1) {
+                        zones_.back().polygons.push_back(std::move(points_));
+                    } else if (pfd_ && polygon_type_ == 1) {
+                        if (line_type_ == 1 && pfd_->boundary.empty())
+                            pfd_->boundary = std::move(points_);
+                        else if (line_type_ == 2)
+                            pfd_->holes.push_back(std::move(points_));
+                    }
+                }
+                points_.clear();
+            } else if (n == "TZN") {
+                in_zone_ = false;
+            } else if (n == "DET") {
+                flush_element();
+            } else if (n == "TSK" && task_) {
+                finish_task();
+                ++stats_.tasks;
+                if (handlers.on_task)
+                    handlers.on_task(std::move(*task_));
+                task_.reset();
+            } else if (n == "PFD" && pfd_) {
+                ++stats_.partfields;
+                if (handlers.on_partfield)
+                    handlers.on_partfield(std::move(*pfd_));
+                pfd_.reset();
+            } else if (n == "DVC" && device_) {
+                flush_element();
+                ++stats_.devices;
+                if (handlers.on_device)
+                    handlers.on_device(std::move(*device_));
+                device_.reset();
+            }
+        }
+
+        // Index of the PDV holding the prescription rate in a zone
+        dp::Optional<usize> rate_slot(const Zone &zone) const {
+            for (usize i = 0; i < zone.values.size(); ++i)
+                if (config_.rate_ddi == 0 || zone.values[i].first == config_.rate_ddi)
+                    return i;
+            return dp::nullopt;
+        }
+
+        const Zone *find_zone(u8 code) const {
+            for (const auto &z : zones_)
+                if (z.code == code)
+                    return &z;
+            return nullptr;
+        }
+
+        void finish_task() {
+            auto &task = *task_;
+            for (const auto &zone : zones_) {
+                auto slot = rate_slot(zone);
+                if (!slot)
+                    continue;
+                if (task.rate_ddi == 0)
+                    task.rate_ddi = zone.values[*slot].first;
+                for (const auto &poly : zone.polygons) {
+                    task.zones.zones.push_back(PrescriptionZone{poly, zone.values[*slot].second});
+                    ++stats_.zones;
+                }
+            }
+            if (grid_ && config_.load_grids)
+                task.grid = load_grid(*grid_, task);
+        }
+
+        dp::Optional<RasterPrescription> load_grid(const Grid &g, TaskDataTask &task) {
+            usize cells = static_cast<usize>(g.columns) * g.rows;
+            if (cells == 0 || g.cell_north <= 0.0 || g.cell_east <= 0.0)
+                return dp::nullopt;
+
+            std::shared_ptr<MappedFile> file;
+            for (const char *ext : {".bin", ".BIN"}) {
+                file = MappedFile::open(directory_ / (std::string(g.file.c_str()) + ext));
+                if (file)
+                    break;
+            }
+            if (!file) {
+                echo::category("isobus.tc.taskdata").warn("grid file ", g.file, " missing");
+                return dp::nullopt;
+            }
+
+            RasterPrescription raster;
+            raster.structure_label = task.id;
+            raster.min_north = g.min_north;
+            raster.min_east = g.min_east;
+            raster.cell_north = g.cell_north;
+            raster.cell_east = g.cell_east;
+            raster.columns = g.columns;
+            raster.rows = g.rows;
+            raster.rates.resize(cells);
+            const u8 *data = file->data();
+
+            if (g.type == 1) {
+                // One treatment zone code per cell
+                if (file->size() < cells)
+                    return dp::nullopt;
+                dp::Array<i32, 256> rate_of;
+                rate_of.fill(raster.no_data);
+                for (const auto &zone : zones_)
+                    if (auto slot = rate_slot(zone)) {
+                        rate_of[zone.code] = zone.values[*slot].second;
+                        if (task.rate_ddi == 0)
+                            task.rate_ddi = zone.values[*slot].first;
+                    }
+                for (usize i = 0; i < cells; ++i)
+                    raster.rates[i] = rate_of[data[i]];
+            } else {
+                // Type 2: one i32 per PDV of the referenced zone, per cell
+                const Zone *zone = find_zone(g.zone_code);
+                auto slot = zone ? rate_slot(*zone) : dp::nullopt;
+                usize stride = zone ? zone->values.size() : 0;
+                if (!slot || file->size() < cells * stride * sizeof(i32))
+                    return dp::nullopt;
+                if (task.rate_ddi == 0)
+                    task.rate_ddi = zone->values[*slot].first;
+                const u8 *p = data + *slot * sizeof(i32);
+                for (usize i = 0; i < cells; ++i, p += stride * sizeof(i32)) {
+                    i32 v;
+                    std::memcpy(&v, p, sizeof(i32)); // little endian on the wire and on target
+                    raster.rates[i] = v;
+                }
+            }
+            stats_.grid_cells += cells;
+            return raster;
+        }
+    };
+
+    // Read a whole TASKDATA set into memory
+    inline Result<TaskDataSet> load_taskdata(const std::filesystem::path &path, TaskDataConfig config = {}) {
+        TaskDataSet set;
+        TaskDataHandlers handlers;
+        handlers.on_task = [&](TaskDataTask &&t) { set.tasks.push_back(std::move(t)); };
+        handlers.on_partfield = [&](TaskDataPartfield &&p) { set.partfields.push_back(std::move(p)); };
+        handlers.on_device = [&](TaskDataDevice &&d) { set.devices.push_back(std::move(d)); };
+        TaskDataReader reader(config);
+        auto result = reader.read(path, handlers);
+        if (!result.is_ok())
+            return Result<TaskDataSet>::err(result.error());
+        set.stats = result.value();
+        return Result<TaskDataSet>::ok(std::move(set));
+    }
+
+} // namespace agrobus::isobus::tc
@@ -0,0 +1,507 @@
+#pragma once
+
+#include "client.hpp"
+#include "commands.hpp"
+#include "objects.hpp"
+#include <agrobus/net/constants.hpp>
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/event.hpp>
+#include <agrobus/net/message.hpp>
+#include <agrobus/net/network_manager.hpp>
+#include <agrobus/net/types.hpp>
+#include <algorithm>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+#include <functional>
+
+namespace agrobus::isobus::vt {
+    using namespace agrobus::net;
+
+    // ─── Queued command kinds ─────────────────────────────────────────────────────
+    enum class VTCommandKind : u8 { ActiveMask, SoftKeyMask, Numeric, String, Visibility, Enable, Attribute };
+
+    // ─── Send priority classes (lower is sent first) ──────────────────────────────
+    enum class VTCommandPriority : u8 {
+        MaskChange = 0, // active mask / soft key mask switches
+        ActiveMask = 1, // objects reachable from the active data or soft key mask
+        Background = 2  // everything else
+    };
+
+    // ─── Queued command (latest value for one object attribute) ───────────────────
+    struct VTQueuedCommand {
+        VTCommandKind kind = VTCommandKind::Numeric;
+        ObjectID id = 0;   // object id (working set / data mask id for mask changes)
+        u8 attribute = 0;  // attribute id for Attribute commands
+        u32 value = 0;     // numeric / attribute value, mask id, bool
+        dp::String text;   // String commands
+        u32 enqueued_ms = 0;
+        u64 sequence = 0;
+    };
+
+    // ─── Queue configuration ──────────────────────────────────────────────────────
+    struct VTCommandQueueConfig {
+        u32 bitrate = 250000;          // CAN bitrate (bit/s)
+        f32 bus_load_budget = 0.10f;   // fraction of the bus this client may use
+        u32 bits_per_frame = 128;      // worst-case extended frame incl. stuffing
+        u8 max_outstanding = 1;        // VTs process one command at a time
+        u32 response_timeout_ms = 1500;
+        u8 busy_hold_mask = vt_busy::PARSING_POOL | vt_busy::OUT_OF_MEMORY | vt_busy::EXECUTING_MACRO;
+
+        VTCommandQueueConfig &bus_load(f32 fraction) {
+            bus_load_budget = fraction;
+            return *this;
+        }
+        VTCommandQueueConfig &outstanding(u8 n) {
+            max_outstanding = n;
+            return *this;
+        }
+        VTCommandQueueConfig &response_timeout(u32 ms) {
+            response_timeout_ms = ms;
+            return *this;
+        }
+        VTCommandQueueConfig &hold_on_busy(u8 mask) {
+            busy_hold_mask = mask;
+            return *this;
+        }
+
+        // Frames per second allowed by the budget
+        f64 frame_budget_per_s() const noexcept {
+            return static_cast<f64>(bitrate) * static_cast<f64>(bus_load_budget) / static_cast<f64>(bits_per_frame);
+        }
+    };
+
+    // ─── Queue metrics ────────────────────────────────────────────────────────────
+    struct VTCommandQueueStats {
+        u64 enqueued = 0;
+        u64 coalesced = 0; // updates replaced by a newer value before sending
+        u64 sent = 0;
+        u64 send_failures = 0; // requeued and retried on the next update
+        u64 responses = 0;
+        u64 rejected = 0;      // VT answered with an error code
+        u64 timeouts = 0;      // requeued and retried
+        u64 frames_sent = 0;
+
+        u64 queue_latency_total_ms = 0; // enqueue -> send
+        u32 queue_latency_max_ms = 0;
+        u64 response_time_total_ms = 0; // send -> VT response
+        u32 response_time_max_ms = 0;
+
+        f64 avg_queue_latency_ms() const noexcept {
+            return sent ? static_cast<f64>(queue_latency_total_ms) / static_cast<f64>(sent) : 0.0;
+        }
+        f64 avg_response_time_ms() const noexcept {
+            return responses ? static_cast<f64>(response_time_total_ms) / static_cast<f64>(responses) : 0.0;
+        }
+    };
+
+    // ─── VT Command Queue ─────────────────────────────────────────────────────────
+    // Coalescing, rate-limited sender for VT object updates.
+    //
+    // - Keeps only the latest value per (object, attribute); older pending
+    //   values are dropped and counted as coalesced
+    // - Sends mask changes first, then objects on the active mask, then the rest
+    // - Holds back while the VT reports a busy code in busy_hold_mask and limits
+    //   in-flight commands to max_outstanding (released by the VT response or
+    //   response_timeout_ms)
+    // - A command is done only when the VT accepts it: failed sends and
+    //   response timeouts put it back in the queue unless a newer value for the
+    //   same attribute arrived meanwhile. Responses are matched by function
+    //   code and object id (and attribute id for Change Attribute)
+    // - Paces frames with a token bucket sized from the bus-load budget
+    //
+    // Usage:
+    //   VTCommandQueue queue(nm, client);
+    //   queue.initialize();
+    //   queue.set_pool(&pool);
+    //   queue.change_numeric_value(id, 42);
+    //   // main loop:
+    //   queue.update(elapsed_ms);
+    //
+    // Commands go out through the VTClient unless set_sender() installs a
+    // different transport (e.g. for simulation).
+    class VTCommandQueue {
+      public:
+        using Sender = std::function<Result<void>(const VTQueuedCommand &)>;
+
+      private:
+        using Entry = VTQueuedCommand;
+
+        struct InFlight {
+            Entry entry;
+            u8 function = 0;
+            u32 sent_ms = 0;
+        };
+
+        struct Response {
+            ObjectID id = 0;
+            u8 attribute = 0;
+            u8 error = 0;
+        };
+
+        IsoNet &net_;
+        VTClient &client_;
+        VTCommandQueueConfig config_;
+        const ObjectPool *pool_ = nullptr;
+        Sender sender_;
+
+        dp::Map<u32, Entry> pending_; // key: id << 16 | kind << 8 | attribute
+        dp::Vector<InFlight> in_flight_;
+        dp::Vector<ObjectID> active_objects_; // sorted, reachable from active masks
+
+        ObjectID active_data_mask_ = 0xFFFF;
+        ObjectID active_soft_key_mask_ = 0xFFFF;
+        u8 busy_code_ = 0;
+        u32 now_ms_ = 0;
+        u64 next_sequence_ = 0;
+        f64 tokens_ = 0.0; // frames available to send
+
+        VTCommandQueueStats stats_;
+
+      public:
+        VTCommandQueue(IsoNet &net, VTClient &client, VTCommandQueueConfig config = {})
+            : net_(net), client_(client), config_(config) {
+            tokens_ = burst_capacity();
+        }
+
+        Result<void> initialize() {
+            net_.register_pgn_callback(PGN_VT_TO_ECU, [this](const Message &msg) { process_vt_message(msg); });
+            echo::category("isobus.vt.queue").debug("command queue initialized");
+            return {};
+        }
+
+        void set_pool(const ObjectPool *pool) {
+            pool_ = pool;
+            rebuild_active_objects();
+        }
+
+        void set_sender(Sender sender) { sender_ = std::move(sender); }
+
+        const VTCommandQueueConfig &config() const noexcept { return config_; }
+        void set_config(VTCommandQueueConfig config) { config_ = config; }
+
+        // ─── Enqueue ─────────────────────────────────────────────────────────────
+        void change_numeric_value(ObjectID id, u32 value) { push(VTCommandKind::Numeric, id, 0, value); }
+        void hide_show(ObjectID id, bool visible) { push(VTCommandKind::Visibility, id, 0, visible ? 1 : 0); }
+        void enable_disable(ObjectID id, bool enabled) { push(VTCommandKind::Enable, id, 0, enabled ? 1 : 0); }
+        void change_attribute(ObjectID id, u8 attribute_id, u32 value) {
+            push(VTCommandKind::Attribute, id, attribute_id, value);
+        }
+        void change_active_mask(ObjectID working_set_id, ObjectID mask_id) {
+            push(VTCommandKind::ActiveMask, working_set_id, 0, mask_id);
+        }
+        void change_soft_key_mask(ObjectID data_mask_id, ObjectID sk_mask_id) {
+            push(VTCommandKind::SoftKeyMask, data_mask_id, 0, sk_mask_id);
+        }
+        void change_string_value(ObjectID id, dp::String value) {
+            auto &e = push(VTCommandKind::String, id, 0, 0);
+            e.text = std::move(value);
+        }
+
+        // ─── Main loop ───────────────────────────────────────────────────────────
+        void update(u32 elapsed_ms) {
+            now_ms_ += elapsed_ms;
+            tokens_ = std::min(burst_capacity(), tokens_ + config_.frame_budget_per_s() * elapsed_ms / 1000.0);
+            expire_in_flight();
+
+            while (!pending_.empty()) {
+                if (is_held())
+                    break;
+                if (in_flight_.size() >= config_.max_outstanding)
+                    break;
+
+                auto it = select_next();
+                f64 frames = static_cast<f64>(frame_count(it->second));
+                if (tokens_ < frames && tokens_ < burst_capacity())
+                    break;
+
+                Entry entry = std::move(it->second);
+                pending_.erase(it);
+                if (!dispatch(entry, static_cast<u32>(frames))) {
+                    requeue(std::move(entry)); // retried next update
+                    break;
+                }
+                tokens_ -= frames;
+            }
+        }
+
+        // Feed VT-to-ECU messages (registered by initialize(); public for replay)
+        void process_vt_message(const Message &msg) {
+            if (msg.data.size() < 1)
+                return;
+            u8 func = msg.data[0];
+            if (func == vt_cmd::VT_STATUS) {
+                handle_vt_status(msg);
+                return;
+            }
+            auto response = parse_response(msg);
+            if (!response)
+                return;
+            for (auto it = in_flight_.begin(); it != in_flight_.end(); ++it) {
+                const Entry &e = it->entry;
+                if (it->function != func || response_id(e) != response->id)
+                    continue;
+                if (e.kind == VTCommandKind::Attribute && e.attribute != response->attribute)
+                    continue;
+                u32 rtt = now_ms_ - it->sent_ms;
+                stats_.responses++;
+                stats_.response_time_total_ms += rtt;
+                stats_.response_time_max_ms = std::max(stats_.response_time_max_ms, rtt);
+                Entry done = std::move(it->entry);
+                in_flight_.erase(it);
+                if (response->error == 0) {
+                    on_acknowledged.emit(done);
+                } else {
+                    stats_.rejected++;
+                    echo::category("isobus.vt.queue").warn("VT rejected id=", done.id, " error=", response->error);
+                    on_rejected.emit(done.id, done.kind, response->error);
+                }
+                return;
+            }
+        }
+
+        // ─── Accessors ───────────────────────────────────────────────────────────
+        usize pending_count() const noexcept { return pending_.size(); }
+        usize in_flight_count() const noexcept { return in_flight_.size(); }
+        u8 busy_code() const noexcept { return busy_code_; }
+        bool is_held() const noexcept { return (busy_code_ & config_.busy_hold_mask) != 0; }
+        ObjectID active_data_mask() const noexcept { return active_data_mask_; }
+        const VTCommandQueueStats &stats() const noexcept { return stats_; }
+        void reset_stats() { stats_ = {}; }
+
+        // True while a command for this (object, attribute) is pending or awaiting
+        // the VT's response
+        bool is_queued(VTCommandKind kind, ObjectID id, u8 attribute = 0) const {
+            if (pending_.find(make_key(kind, id, attribute)) != pending_.end())
+                return true;
+            for (const auto &f : in_flight_)
+                if (f.entry.kind == kind && f.entry.id == id && f.entry.attribute == attribute)
+                    return true;
+            return false;
+        }
+
+        bool is_on_active_mask(ObjectID id) const {
+            return std::binary_search(active_objects_.begin(), active_objects_.end(), id);
+        }
+
+        void clear() {
+            pending_.clear();
+            in_flight_.clear();
+        }
+
+        // ─── Events ──────────────────────────────────────────────────────────────
+        Event<ObjectID, VTCommandKind> on_sent;
+        Event<ObjectID, VTCommandKind> on_send_failed;
+        Event<const VTQueuedCommand &> on_acknowledged; // the VT now shows this value
+        Event<ObjectID, VTCommandKind, u8> on_rejected; // with the VT error code; not retried
+
+      private:
+        static u32 make_key(VTCommandKind kind, ObjectID id, u8 attribute) {
+            return (static_cast<u32>(id) << 16) | (static_cast<u32>(kind) << 8) | attribute;
+        }
+
+        Entry &push(VTCommandKind kind, ObjectID id, u8 attribute, u32 value) {
+            stats_.enqueued++;
+            u32 key = make_key(kind, id, attribute);
+            auto it = pending_.find(key);
+            if (it != pending_.end()) {
+                // Latest value wins; keep the original enqueue time and order
+                stats_.coalesced++;
+                it->second.value = value;
+                return it->second;
+            }
+            Entry e;
+            e.kind = kind;
+            e.id = id;
+            e.attribute = attribute;
+            e.value = value;
+            e.enqueued_ms = now_ms_;
+            e.sequence = next_sequence_++;
+            return pending_[key] = std::move(e);
+        }
+
+        // Puts back a command that was not delivered; a newer value for the same
+        // attribute supersedes it
+        void requeue(Entry e) {
+            u32 key = make_key(e.kind, e.id, e.attribute);
+            if (pending_.find(key) == pending_.end())
+                pending_[key] = std::move(e);
+        }
+
+        VTCommandPriority priority_of(const Entry &e) const {
+            if (e.kind == VTCommandKind::ActiveMask || e.kind == VTCommandKind::SoftKeyMask)
+                return VTCommandPriority::MaskChange;
+            if (is_on_active_mask(e.id))
+                return VTCommandPriority::ActiveMask;
+            return VTCommandPriority::Background;
+        }
+
+        dp::Map<u32, Entry>::iterator select_next() {
+            auto best = pending_.begin();
+            auto best_prio = priority_of(best->second);
+            for (auto it = std::next(pending_.begin()); it != pending_.end(); ++it) {
+                auto prio = priority_of(it->second);
+                if (prio < best_prio || (prio == best_prio && it->second.sequence < best->second.sequence)) {
+                    best = it;
+                    best_prio = prio;
+                }
+            }
+            return best;
+        }
+
+        // Single frame for fixed-size commands, TP (RTS + CTS-paced data + EOM) for long strings
+        static u32 frame_count(const Entry &e) {
+            if (e.kind != VTCommandKind::String)
+                return 1;
+            usize len = 5 + e.text.size();
+            if (len <= CAN_DATA_LENGTH)
+                return 1;
+            return static_cast<u32>((len + 6) / 7) + 2;
+        }
+
+        f64 burst_capacity() const noexcept { return std::max(1.0, config_.frame_budget_per_s() / 10.0); }
+
+        static u8 function_of(VTCommandKind kind) {
+            switch (kind) {
+            case VTCommandKind::Numeric:
+                return vt_cmd::CHANGE_NUMERIC_VALUE;
+            case VTCommandKind::String:
+                return vt_cmd::CHANGE_STRING_VALUE;
+            case VTCommandKind::Visibility:
+                return vt_cmd::HIDE_SHOW;
+            case VTCommandKind::Enable:
+                return vt_cmd::ENABLE_DISABLE;
+            case VTCommandKind::Attribute:
+                return vt_cmd::CHANGE_ATTRIBUTE;
+            case VTCommandKind::ActiveMask:
+                return vt_cmd::CHANGE_ACTIVE_MASK;
+            case VTCommandKind::SoftKeyMask:
+                return vt_cmd::CHANGE_SOFT_KEY_MASK;
+            }
+            return 0;
+        }
+
+        // The object a response names: the new mask for Change Active Mask, the
+        // target object otherwise
+        static ObjectID response_id(const Entry &e) {
+            return e.kind == VTCommandKind::ActiveMask ? static_cast<ObjectID>(e.value) : e.id;
+        }
+
+        // Object id, attribute id and error code of a command response (ISO 11783-6 layouts)
+        static dp::Optional<Response> parse_response(const Message &msg) {
+            const auto &d = msg.data;
+            if (d.size() < 6)
+                return dp::nullopt;
+            auto id_at = [&](usize i) { return static_cast<ObjectID>(d[i] | (static_cast<u16>(d[i + 1]) << 8)); };
+            switch (d[0]) {
+            case vt_cmd::HIDE_SHOW:
+            case vt_cmd::ENABLE_DISABLE:
+                return Response{id_at(1), 0, d[4]};
+            case vt_cmd::CHANGE_ATTRIBUTE:
+                return Response{id_at(1), d[3], d[4]};
+            case vt_cmd::CHANGE_NUMERIC_VALUE:
+            case vt_cmd::CHANGE_ACTIVE_MASK:
+                return Response{id_at(1), 0, d[3]};
+            case vt_cmd::CHANGE_SOFT_KEY_MASK:
+                return Response{id_at(1), 0, d[5]};
+            case vt_cmd::CHANGE_STRING_VALUE:
+                return Response{id_at(3), 0, d[5]};
+            default:
+                return dp::nullopt;
+            }
+        }
+
+        Result<void> send_via_client(const Entry &e) {
+            switch (e.kind) {
+            case VTCommandKind::Numeric:
+                return client_.change_numeric_value(e.id, e.value);
+            case VTCommandKind::String:
+                return client_.change_string_value(e.id, e.text);
+            case VTCommandKind::Visibility:
+                return client_.hide_show(e.id, e.value != 0);
+            case VTCommandKind::Enable:
+                return client_.enable_disable(e.id, e.value != 0);
+            case VTCommandKind::Attribute:
+                return client_.change_attribute(e.id, e.attribute, e.value);
+            case VTCommandKind::ActiveMask:
+                return client_.change_active_mask(e.id, static_cast<ObjectID>(e.value));
+            case VTCommandKind::SoftKeyMask:
+                return client_.change_soft_key_mask(e.id, static_cast<ObjectID>(e.value));
+            }
+            return Result<void>::err(Error::invalid_state("unknown command kind"));
+        }
+
+        bool dispatch(const Entry &e, u32 frames) {
+            u8 function = function_of(e.kind);
+            Result<void> result = sender_ ? sender_(e) : send_via_client(e);
+
+            if (!result.is_ok()) {
+                stats_.send_failures++;
+                on_send_failed.emit(e.id, e.kind);
+                echo::category("isobus.vt.queue").warn("send failed: id=", e.id);
+                return false;
+            }
+
+            u32 latency = now_ms_ - e.enqueued_ms;
+            stats_.sent++;
+            stats_.frames_sent += frames;
+            stats_.queue_latency_total_ms += latency;
+            stats_.queue_latency_max_ms = std::max(stats_.queue_latency_max_ms, latency);
+            in_flight_.push_back({e, function, now_ms_});
+            on_sent.emit(e.id, e.kind);
+
+            if (e.kind == VTCommandKind::ActiveMask) {
+                active_data_mask_ = static_cast<ObjectID>(e.value);
+                rebuild_active_objects();
+            }
+            return true;
+        }
+
+        void expire_in_flight() {
+            for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+                if (now_ms_ - it->sent_ms >= config_.response_timeout_ms) {
+                    stats_.timeouts++;
+                    echo::category("isobus.vt.queue").debug("response timeout: id=", it->entry.id);
+                    requeue(std::move(it->entry));
+                    it = in_flight_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        void handle_vt_status(const Message &msg) {
+            if (msg.data.size() < 7)
+                return;
+            ObjectID data_mask = static_cast<u16>(msg.data[2]) | (static_cast<u16>(msg.data[3]) << 8);
+            ObjectID sk_mask = static_cast<u16>(msg.data[4]) | (static_cast<u16>(msg.data[5]) << 8);
+            busy_code_ = msg.data[6];
+            if (data_mask != active_data_mask_ || sk_mask != active_soft_key_mask_) {
+                active_data_mask_ = data_mask;
+                active_soft_key_mask_ = sk_mask;
+                rebuild_active_objects();
+            }
+        }
+
+        void rebuild_active_objects() {
+            active_objects_.clear();
+            if (!pool_)
+                return;
+            dp::Vector<ObjectID> stack;
+            stack.push_back(active_data_mask_);
+            stack.push_back(active_soft_key_mask_);
+            while (!stack.empty()) {
+                ObjectID id = stack.back();
+                stack.pop_back();
+                if (id == 0xFFFF || std::binary_search(active_objects_.begin(), active_objects_.end(), id))
+                    continue;
+                auto obj = pool_->find(id);
+                if (!obj)
+                    continue;
+                active_objects_.insert(std::lower_bound(active_objects_.begin(), active_objects_.end(), id), id);
+                for (auto child : (*obj)->children)
+                    stack.push_back(child);
+            }
+        }
+    };
+
+} // namespace agrobus::isobus::vt
@@ -79,6 +79,17 @@ namespace agrobus::isobus::vt {
         inline constexpr u8 EXTENDED_VERSION_SUBFUNCTION = 0xFE;
     } // namespace vt_cmd
 
+    // ─── VT busy codes (VT Status byte 7, ISO 11783-6 Annex F.5) ──────────────────
+    namespace vt_busy {
+        inline constexpr u8 UPDATING_VISIBLE_MASK = 0x01;
+        inline constexpr u8 SAVING_DATA = 0x02;
+        inline constexpr u8 EXECUTING_COMMAND = 0x04;
+        inline constexpr u8 EXECUTING_MACRO = 0x08;
+        inline constexpr u8 PARSING_POOL = 0x10;
+        inline constexpr u8 AUX_LEARN_MODE = 0x40;
+        inline constexpr u8 OUT_OF_MEMORY = 0x80;
+    } // namespace vt_busy
+
     // ─── Button/Key activation codes ─────────────────────────────────────────────
     enum class ActivationCode : u8 { Released = 0, Pressed = 1, Held = 2, Aborted = 3 };
 
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "objects.hpp"
+#include <agrobus/net/types.hpp>
+#include <bit>
+#include <datapod/datapod.hpp>
+
+namespace agrobus::isobus::vt {
+    using namespace agrobus::net;
+
+    // ─── Dense slot index ─────────────────────────────────────────────────────────
+    using Slot = u16;
+    inline constexpr Slot INVALID_SLOT = 0xFFFF;
+
+    // ─── Dirty attribute kinds ────────────────────────────────────────────────────
+    enum class DirtyKind : u8 { Numeric = 0, String = 1, Visibility = 2, Enable = 3 };
+    inline constexpr usize DIRTY_KIND_COUNT = 4;
+
+    // ─── Packed bitset over slots ─────────────────────────────────────────────────
+    class SlotBits {
+        dp::Vector<u64> words_;
+
+      public:
+        void resize(usize bits) { words_.assign((bits + 63) / 64, 0); }
+
+        bool test(Slot s) const noexcept { return (words_[s >> 6] >> (s & 63)) & 1u; }
+        void set(Slot s) noexcept { words_[s >> 6] |= (u64{1} << (s & 63)); }
+        void reset(Slot s) noexcept { words_[s >> 6] &= ~(u64{1} << (s & 63)); }
+        void assign(Slot s, bool v) noexcept { v ? set(s) : reset(s); }
+        void clear() noexcept {
+            for (auto &w : words_)
+                w = 0;
+        }
+
+        usize count() const noexcept {
+            usize n = 0;
+            for (auto w : words_)
+                n += static_cast<usize>(std::popcount(w));
+            return n;
+        }
+
+        bool any() const noexcept {
+            for (auto w : words_)
+                if (w)
+                    return true;
+            return false;
+        }
+
+        // Visit every set bit in ascending order
+        template <typename Fn> void for_each(Fn &&fn) const {
+            for (usize wi = 0; wi < words_.size(); ++wi) {
+                u64 w = words_[wi];
+                while (w) {
+                    usize bit = static_cast<usize>(std::countr_zero(w));
+                    fn(static_cast<Slot>(wi * 64 + bit));
+                    w &= w - 1;
+                }
+            }
+        }
+
+        // Visit and clear every set bit. Bits set by fn for an already visited
+        // word survive until the next drain.
+        template <typename Fn> void drain(Fn &&fn) {
+            for (usize wi = 0; wi < words_.size(); ++wi) {
+                u64 w = words_[wi];
+                words_[wi] = 0;
+                while (w) {
+                    usize bit = static_cast<usize>(std::countr_zero(w));
+                    fn(static_cast<Slot>(wi * 64 + bit));
+                    w &= w - 1;
+                }
+            }
+        }
+    };
+
+    // ─── Small string with inline storage ─────────────────────────────────────────
+    // Output strings on implements are short (units, labels, status text); anything
+    // up to SMALL_STRING_CAPACITY bytes lives inline, longer values spill to the
+    // overflow map of the owning store.
+    inline constexpr usize SMALL_STRING_CAPACITY = 23;
+
+    struct SmallString {
+        u8 length = 0;
+        bool spilled = false;
+        char data[SMALL_STRING_CAPACITY] = {};
+    };
+
+    // ─── Dense VT object state ────────────────────────────────────────────────────
+    // Struct-of-arrays mirror of per-object VT state. Slots are assigned once at
+    // pool load (pool order), so every lookup is two array indexes instead of a
+    // tree walk. Object IDs not in the pool have no slot; callers fall back to
+    // their sparse storage for those.
+    //
+    // Layout:
+    //   id -> slot   two-level page table (256 pages x 256 entries, lazily allocated)
+    //   numeric      dp::Vector<u32> + known bitset
+    //   strings      SmallString per slot + overflow map for long values
+    //   visibility   value bitset + known bitset
+    //   enable       value bitset + known bitset
+    //   dirty        one bitset per DirtyKind, drained by the update helper
+    class DenseObjectState {
+        static constexpr usize PAGE_SIZE = 256;
+        static constexpr usize PAGE_COUNT = 256;
+
+        dp::Vector<dp::Vector<Slot>> pages_;
+        dp::Vector<ObjectID> ids_; // slot -> id
+
+        dp::Vector<u32> numeric_;
+        SlotBits numeric_known_;
+
+        dp::Vector<SmallString> strings_;
+        dp::Map<Slot, dp::String> long_strings_;
+        SlotBits string_known_;
+
+        SlotBits visible_;
+        SlotBits visible_known_;
+        SlotBits enabled_;
+        SlotBits enabled_known_;
+
+        dp::Array<SlotBits, DIRTY_KIND_COUNT> dirty_;
+
+      public:
+        // ─── Slot assignment ──────────────────────────────────────────────────────
+        // Assigns one slot per pool object and clears all state.
+        void assign(const ObjectPool &pool) {
+            dp::Vector<ObjectID> ids;
+            ids.reserve(pool.size());
+            for (const auto &obj : pool.objects())
+                ids.push_back(obj.id);
+            assign(ids);
+        }
+
+        void assign(const dp::Vector<ObjectID> &ids) {
+            pages_.clear();
+            pages_.resize(PAGE_COUNT);
+            ids_.clear();
+            ids_.reserve(ids.size());
+            for (auto id : ids) {
+                if (ids_.size() >= INVALID_SLOT)
+                    break;
+                auto &page = pages_[id >> 8];
+                if (page.empty())
+                    page.assign(PAGE_SIZE, INVALID_SLOT);
+                if (page[id & 0xFF] != INVALID_SLOT)
+                    continue; // duplicate ID keeps its first slot
+                page[id & 0xFF] = static_cast<Slot>(ids_.size());
+                ids_.push_back(id);
+            }
+
+            usize n = ids_.size();
+            numeric_.assign(n, 0);
+            numeric_known_.resize(n);
+            strings_.assign(n, SmallString{});
+            long_strings_.clear();
+            string_known_.resize(n);
+            visible_.resize(n);
+            visible_known_.resize(n);
+            enabled_.resize(n);
+            enabled_known_.resize(n);
+            for (auto &d : dirty_)
+                d.resize(n);
+        }
+
+        void clear() { assign(dp::Vector<ObjectID>{}); }
+
+        usize size() const noexcept { return ids_.size(); }
+        bool empty() const noexcept { return ids_.empty(); }
+
+        Slot slot_of(ObjectID id) const noexcept {
+            if (pages_.empty())
+                return INVALID_SLOT;
+            const auto &page = pages_[id >> 8];
+            return page.empty() ? INVALID_SLOT : page[id & 0xFF];
+        }
+
+        bool contains(ObjectID id) const noexcept { return slot_of(id) != INVALID_SLOT; }
+        ObjectID id_of(Slot slot) const noexcept { return ids_[slot]; }
+
+        // ─── Numeric values ───────────────────────────────────────────────────────
+        dp::Optional<u32> numeric(Slot s) const {
+            if (!numeric_known_.test(s))
+                return dp::nullopt;
+            return numeric_[s];
+        }
+
+        // Returns true when the stored value changed
+        bool set_numeric(Slot s, u32 value) noexcept {
+            if (numeric_known_.test(s) && numeric_[s] == value)
+                return false;
+            numeric_[s] = value;
+            numeric_known_.set(s);
+            return true;
+        }
+
+        // ─── String values ────────────────────────────────────────────────────────
+        dp::Optional<dp::String> string(Slot s) const {
+            if (!string_known_.test(s))
+                return dp::nullopt;
+            const auto &ss = strings_[s];
+            if (ss.spilled)
+                return long_strings_.find(s)->second;
+            dp::String str;
+            for (u8 i = 0; i < ss.length; ++i)
+                str += ss.data[i];
+            return str;
+        }
+
+        bool string_equals(Slot s, const dp::String &value) const {
+            if (!string_known_.test(s))
+                return false;
+            const auto &ss = strings_[s];
+            if (ss.spilled)
+                return long_strings_.find(s)->second == value;
+            if (value.size() != ss.length)
+                return false;
+            for (u8 i = 0; i < ss.length; ++i)
+                if (ss.data[i] != value[i])
+                    return false;
+            return true;
+        }
+
+        bool set_string(Slot s, const dp::String &value) {
+            if (string_equals(s, value))
+                return false;
+            auto &ss = strings_[s];
+            if (value.size() <= SMALL_STRING_CAPACITY) {
+                if (ss.spilled)
+                    long_strings_.erase(s);
+                ss.spilled = false;
+                ss.length = static_cast<u8>(value.size());
+                for (u8 i = 0; i < ss.length; ++i)
+                    ss.data[i] = value[i];
+            } else {
+                ss.spilled = true;
+                ss.length = 0;
+                long_strings_[s] = value;
+            }
+            string_known_.set(s);
+            return true;
+        }
+
+        usize spilled_string_count() const noexcept { return long_strings_.size(); }
+
+        // ─── Visibility / enable ──────────────────────────────────────────────────
+        dp::Optional<bool> visible(Slot s) const {
+            if (!visible_known_.test(s))
+                return dp::nullopt;
+            return visible_.test(s);
+        }
+
+        bool set_visible(Slot s, bool v) noexcept {
+            if (visible_known_.test(s) && visible_.test(s) == v)
+                return false;
+            visible_.assign(s, v);
+            visible_known_.set(s);
+            return true;
+        }
+
+        dp::Optional<bool> enabled(Slot s) const {
+            if (!enabled_known_.test(s))
+                return dp::nullopt;
+            return enabled_.test(s);
+        }
+
+        bool set_enabled(Slot s, bool v) noexcept {
+            if (enabled_known_.test(s) && enabled_.test(s) == v)
+                return false;
+            enabled_.assign(s, v);
+            enabled_known_.set(s);
+            return true;
+        }
+
+        // ─── Dirty tracking ───────────────────────────────────────────────────────
+        void mark_dirty(Slot s, DirtyKind kind) noexcept { dirty_[static_cast<usize>(kind)].set(s); }
+        void clear_dirty(Slot s, DirtyKind kind) noexcept { dirty_[static_cast<usize>(kind)].reset(s); }
+        bool is_dirty(Slot s, DirtyKind kind) const noexcept { return dirty_[static_cast<usize>(kind)].test(s); }
+
+        usize dirty_count() const noexcept {
+            usize n = 0;
+            for (const auto &d : dirty_)
+                n += d.count();
+            return n;
+        }
+
+        bool has_dirty() const noexcept {
+            for (const auto &d : dirty_)
+                if (d.any())
+                    return true;
+            return false;
+        }
+
+        // Drains all dirty bits, calling fn(object_id, slot, kind) once per entry.
+        // Kinds are drained in enum order, slots in ascending order.
+        template <typename Fn> void drain_dirty(Fn &&fn) {
+            for (usize k = 0; k < DIRTY_KIND_COUNT; ++k) {
+                dirty_[k].drain([&](Slot s) { fn(ids_[s], s, static_cast<DirtyKind>(k)); });
+            }
+        }
+
+        void clear_all_dirty() noexcept {
+            for (auto &d : dirty_)
+                d.clear();
+        }
+
+        // Forget all values but keep the slot assignment
+        void reset_values() {
+            for (auto &v : numeric_)
+                v = 0;
+            numeric_known_.clear();
+            for (auto &ss : strings_)
+                ss = SmallString{};
+            long_strings_.clear();
+            string_known_.clear();
+            visible_.clear();
+            visible_known_.clear();
+            enabled_.clear();
+            enabled_known_.clear();
+            clear_all_dirty();
+        }
+    };
+
+} // namespace agrobus::isobus::vt
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <agrobus/net/data_span.hpp>
 #include <agrobus/net/error.hpp>
 #include <agrobus/net/types.hpp>
 #include <datapod/datapod.hpp>
@@ -466,6 +467,12 @@ namespace agrobus::isobus::vt {
             return {};
         }
 
+        // Append without the duplicate-ID scan; the caller guarantees uniqueness
+        // (bulk loaders that already index IDs, where add() would be quadratic).
+        void add_unchecked(VTObject obj) { objects_.push_back(std::move(obj)); }
+
+        void reserve(usize count) { objects_.reserve(count); }
+
         dp::Optional<VTObject *> find(ObjectID id) {
             for (auto &obj : objects_) {
                 if (obj.id == id)
@@ -492,7 +499,10 @@ namespace agrobus::isobus::vt {
         }
 
         // Deserialize a pool from binary data (length-driven parsing)
-        static Result<ObjectPool> deserialize(const dp::Vector<u8> &data) {
+        static Result<ObjectPool> deserialize(const dp::Vector<u8> &data) { return deserialize(DataSpan(data)); }
+
+        // Deserialize directly from a borrowed buffer (e.g. a memory-mapped pool)
+        static Result<ObjectPool> deserialize(DataSpan data) {
             ObjectPool pool;
             usize offset = 0;
 
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <agrobus/net/data_span.hpp>
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/mapped_file.hpp>
+#include <agrobus/net/types.hpp>
+#include <chrono>
+#include <cstdio>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace agrobus::isobus::vt {
+    using namespace agrobus::net;
+
+    // ─── Content hash ─────────────────────────────────────────────────────────────
+    // FNV-1a 64: cheap, stable across builds, good enough to name pool blobs.
+    // Collisions are resolved by byte comparison on insert.
+    inline u64 pool_content_hash(const u8 *data, usize size) noexcept {
+        u64 h = 0xCBF29CE484222325ull;
+        for (usize i = 0; i < size; ++i) {
+            h ^= data[i];
+            h *= 0x100000001B3ull;
+        }
+        return h;
+    }
+
+    // ─── Zero-copy view of a stored pool ─────────────────────────────────────────
+    // Holds its mapping alive; eviction from the store never invalidates a view.
+    class PoolView {
+        std::shared_ptr<MappedFile> blob_;
+
+      public:
+        PoolView() = default;
+        explicit PoolView(std::shared_ptr<MappedFile> blob) : blob_(std::move(blob)) {}
+
+        bool valid() const noexcept { return blob_ != nullptr; }
+        const u8 *data() const noexcept { return blob_ ? blob_->data() : nullptr; }
+        usize size() const noexcept { return blob_ ? blob_->size() : 0; }
+        DataSpan span() const noexcept { return DataSpan(data(), size()); }
+    };
+
+    // ─── Pool store configuration ────────────────────────────────────────────────
+    struct PoolStoreConfig {
+        dp::String root = "./vt_storage";
+        u64 memory_budget = 32ull * 1024 * 1024; // bytes kept mapped by the store
+        u64 disk_budget = 256ull * 1024 * 1024;  // unique blob bytes kept on disk
+
+        PoolStoreConfig &path(const dp::String &p) {
+            root = p;
+            return *this;
+        }
+        PoolStoreConfig &memory(u64 bytes) {
+            memory_budget = bytes;
+            return *this;
+        }
+        PoolStoreConfig &disk(u64 bytes) {
+            disk_budget = bytes;
+            return *this;
+        }
+    };
+
+    // ─── Pool store statistics ───────────────────────────────────────────────────
+    struct PoolStoreStats {
+        u32 puts = 0;
+        u32 dedup_hits = 0; // puts that reused an existing blob
+        u32 hits = 0;       // opens served from an existing mapping
+        u32 misses = 0;     // opens that had to map the blob
+        u32 unmapped = 0;   // mappings dropped for the memory budget
+        u32 evicted = 0;    // labels evicted for the disk budget
+        u32 expired = 0;    // labels removed by age
+    };
+
+    // ─── Label reference metadata ────────────────────────────────────────────────
+    struct PoolLabelInfo {
+        u64 client_key = 0;
+        dp::String label;
+        u64 hash = 0;
+        u64 timestamp_us = 0; // creation time (microseconds since epoch)
+        u64 last_used = 0;    // store tick of last store/load
+        u32 size_bytes = 0;
+        u16 vt_version = 0;
+    };
+
+    // ─── Content-addressed VT pool store ─────────────────────────────────────────
+    // Pools are stored once per content hash under <root>/objects/<hash>.vtp as raw
+    // serialized bytes, so a mapped blob is directly the pool. (client, label) pairs
+    // are references into that set, persisted in <root>/index.bin. Identical pools
+    // uploaded by several implements of the same type share one blob.
+    //
+    // Loads are served via mmap. The store keeps recently used mappings resident
+    // up to memory_budget; unique blob bytes on disk are held to disk_budget by
+    // evicting the least recently used labels. Blobs are deleted once their last
+    // label goes away.
+    //
+    // client_key is the client's NAME when known, otherwise its address.
+    class PoolStore {
+        static constexpr u32 INDEX_VERSION = 1;
+
+        struct Blob {
+            u32 size = 0;
+            u32 refs = 0;
+            u64 last_used = 0;
+            std::shared_ptr<MappedFile> mapping;
+        };
+
+        PoolStoreConfig config_;
+        dp::Map<u64, Blob> blobs_;
+        dp::Vector<PoolLabelInfo> labels_;
+        u64 tick_ = 0;
+        u64 disk_bytes_ = 0;
+        u64 mapped_bytes_ = 0;
+        PoolStoreStats stats_;
+
+      public:
+        explicit PoolStore(PoolStoreConfig config = {}) : config_(std::move(config)) {}
+
+        // ─── Lifecycle ────────────────────────────────────────────────────────────
+        // Creates the directory layout and reads the label index. Blob contents are
+        // not touched until a label is loaded.
+        Result<void> open() {
+            try {
+                std::filesystem::create_directories(objects_dir());
+            } catch (...) {
+                return Result<void>::err(Error::invalid_state("cannot create pool store directory"));
+            }
+            blobs_.clear();
+            labels_.clear();
+            disk_bytes_ = 0;
+            mapped_bytes_ = 0;
+            read_index();
+
+            // Drop references whose blob is missing, then count what is on disk
+            for (auto it = labels_.begin(); it != labels_.end();) {
+                std::error_code ec;
+                auto size = std::filesystem::file_size(blob_path(it->hash), ec);
+                if (ec || size != it->size_bytes) {
+                    it = labels_.erase(it);
+                    continue;
+                }
+                add_ref(it->hash, it->size_bytes, it->last_used);
+                ++it;
+            }
+            remove_orphan_blobs();
+            echo::category("isobus.vt.store")
+                .debug("Pool store opened: ", labels_.size(), " labels, ", blobs_.size(), " blobs, ", disk_bytes_,
+                       " bytes");
+            return {};
+        }
+
+        const PoolStoreConfig &config() const noexcept { return config_; }
+        const PoolStoreStats &stats() const noexcept { return stats_; }
+        usize label_count() const noexcept { return labels_.size(); }
+        usize blob_count() const noexcept { return blobs_.size(); }
+        u64 disk_bytes() const noexcept { return disk_bytes_; }
+        u64 mapped_bytes() const noexcept { return mapped_bytes_; }
+
+        void set_memory_budget(u64 bytes) {
+            config_.memory_budget = bytes;
+            trim_mappings();
+        }
+
+        void set_disk_budget(u64 bytes) {
+            config_.disk_budget = bytes;
+            enforce_disk_budget(0);
+            write_index();
+        }
+
+        // ─── Store / load / delete ────────────────────────────────────────────────
+        Result<void> put(u64 client_key, const dp::String &label, const u8 *data, usize size, u16 vt_version = 5) {
+            if (size == 0)
+                return Result<void>::err(Error::invalid_data("empty pool"));
+            if (size > 0xFFFFFFFFull)
+                return Result<void>::err(Error::invalid_data("pool too large"));
+
+            ++tick_;
+            ++stats_.puts;
+            auto hashed = find_or_write_blob(data, size);
+            if (hashed.is_err())
+                return Result<void>::err(hashed.error());
+            u64 hash = hashed.value();
+
+            auto *info = find_label(client_key, label);
+            if (info) {
+                if (info->hash == hash) {
+                    info->last_used = tick_;
+                    touch(hash);
+                    return write_index();
+                }
+                release_ref(info->hash);
+            } else {
+                labels_.push_back({});
+                info = &labels_.back();
+                info->client_key = client_key;
+                info->label = label;
+            }
+            info->hash = hash;
+            info->size_bytes = static_cast<u32>(size);
+            info->vt_version = vt_version;
+            info->last_used = tick_;
+            info->timestamp_us = now_us();
+            add_ref(hash, info->size_bytes, tick_);
+
+            enforce_disk_budget(hash);
+            return write_index();
+        }
+
+        Result<void> put(u64 client_key, const dp::String &label, const dp::Vector<u8> &data, u16 vt_version = 5) {
+            return put(client_key, label, data.data(), data.size(), vt_version);
+        }
+
+        // Map a stored pool. The view stays valid after eviction or removal.
+        Result<PoolView> load(u64 client_key, const dp::String &label) {
+            auto *info = find_label(client_key, label);
+            if (!info)
+                return Result<PoolView>::err(Error::invalid_state("pool version not found"));
+            auto it = blobs_.find(info->hash);
+            if (it == blobs_.end())
+                return Result<PoolView>::err(Error::invalid_state("pool blob missing"));
+
+            ++tick_;
+            info->last_used = tick_;
+            it->second.last_used = tick_;
+
+            if (it->second.mapping) {
+                ++stats_.hits;
+            } else {
+                ++stats_.misses;
+                auto mapping = MappedFile::open(blob_path(info->hash));
+                if (!mapping || mapping->size() != it->second.size)
+                    return Result<PoolView>::err(Error::invalid_state("cannot map pool blob"));
+                it->second.mapping = std::move(mapping);
+                mapped_bytes_ += it->second.size;
+            }
+            PoolView view(it->second.mapping);
+            trim_mappings();
+            return Result<PoolView>::ok(std::move(view));
+        }
+
+        bool contains(u64 client_key, const dp::String &label) const {
+            for (const auto &l : labels_)
+                if (l.client_key == client_key && l.label == label)
+                    return true;
+            return false;
+        }
+
+        bool remove(u64 client_key, const dp::String &label) {
+            for (auto it = labels_.begin(); it != labels_.end(); ++it) {
+                if (it->client_key == client_key && it->label == label) {
+                    u64 hash = it->hash;
+                    labels_.erase(it);
+                    release_ref(hash);
+                    write_index();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Labels stored for one client, in insertion order
+        dp::Vector<PoolLabelInfo> labels(u64 client_key) const {
+            dp::Vector<PoolLabelInfo> out;
+            for (const auto &l : labels_)
+                if (l.client_key == client_key)
+                    out.push_back(l);
+            return out;
+        }
+
+        // ─── Eviction ─────────────────────────────────────────────────────────────
+        // Remove labels older than max_age_days, then hold the disk budget.
+        u32 cleanup(u32 max_age_days) {
+            u32 removed = 0;
+            u64 now = now_us();
+            u64 max_age = static_cast<u64>(max_age_days) * 24 * 3600 * 1000000;
+            for (auto it = labels_.begin(); it != labels_.end();) {
+                if (it->timestamp_us != 0 && now > it->timestamp_us && now - it->timestamp_us > max_age) {
+                    u64 hash = it->hash;
+                    it = labels_.erase(it);
+                    release_ref(hash);
+                    ++removed;
+                    ++stats_.expired;
+                } else {
+                    ++it;
+                }
+            }
+            removed += enforce_disk_budget(0);
+            if (removed > 0)
+                write_index();
+            return removed;
+        }
+
+      private:
+        // ─── Paths ────────────────────────────────────────────────────────────────
+        std::filesystem::path root_dir() const { return std::filesystem::path(config_.root.c_str()); }
+        std::filesystem::path objects_dir() const { return root_dir() / "objects"; }
+        std::filesystem::path index_path() const { return root_dir() / "index.bin"; }
+
+        std::filesystem::path blob_path(u64 hash) const {
+            char name[24];
+            snprintf(name, sizeof(name), "%016llX.vtp", static_cast<unsigned long long>(hash));
+            return objects_dir() / name;
+        }
+
+        static u64 now_us() {
+            auto duration = std::chrono::system_clock::now().time_since_epoch();
+            return static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+        }
+
+        PoolLabelInfo *find_label(u64 client_key, const dp::String &label) {
+            for (auto &l : labels_)
+                if (l.client_key == client_key && l.label == label)
+                    return &l;
+            return nullptr;
+        }
+
+        // ─── Blob management ──────────────────────────────────────────────────────
+        Result<u64> find_or_write_blob(const u8 *data, usize size) {
+            u64 hash = pool_content_hash(data, size);
+            // Probe past colliding blobs with different content
+            for (u32 probe = 0; probe < 16; ++probe, ++hash) {
+                auto it = blobs_.find(hash);
+                if (it == blobs_.end())
+                    break;
+                if (it->second.size == size && blob_equals(hash, data, size)) {
+                    ++stats_.dedup_hits;
+                    return Result<u64>::ok(hash);
+                }
+            }
+            if (blobs_.find(hash) != blobs_.end())
+                return Result<u64>::err(Error::invalid_state("pool hash collision chain exhausted"));
+
+            // Write to a temporary file, then rename so a crash never leaves a torn blob
+            auto path = blob_path(hash);
+            auto tmp = path;
+            tmp += ".tmp";
+            try {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file)
+                    return Result<u64>::err(Error::invalid_state("cannot write pool blob"));
+                file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+                file.close();
+                if (!file)
+                    return Result<u64>::err(Error::invalid_state("cannot write pool blob"));
+                std::filesystem::rename(tmp, path);
+            } catch (...) {
+                return Result<u64>::err(Error::invalid_state("cannot write pool blob"));
+            }
+            return Result<u64>::ok(hash);
+        }
+
+        bool blob_equals(u64 hash, const u8 *data, usize size) {
+            auto it = blobs_.find(hash);
+            auto mapping = it->second.mapping ? it->second.mapping : MappedFile::open(blob_path(hash));
+            if (!mapping || mapping->size() != size)
+                return false;
+            for (usize i = 0; i < size; ++i)
+                if (mapping->data()[i] != data[i])
+                    return false;
+            return true;
+        }
+
+        void add_ref(u64 hash, u32 size, u64 used) {
+            auto it = blobs_.find(hash);
+            if (it == blobs_.end()) {
+                Blob blob;
+                blob.size = size;
+                blob.last_used = used;
+                it = blobs_.emplace(hash, std::move(blob)).first;
+                disk_bytes_ += size;
+            }
+            ++it->second.refs;
+            if (used > it->second.last_used)
+                it->second.last_used = used;
+        }
+
+        void touch(u64 hash) {
+            auto it = blobs_.find(hash);
+            if (it != blobs_.end())
+                it->second.last_used = tick_;
+        }
+
+        void release_ref(u64 hash) {
+            auto it = blobs_.find(hash);
+            if (it == blobs_.end())
+                return;
+            if (it->second.refs > 1) {
+                --it->second.refs;
+                return;
+            }
+            if (it->second.mapping)
+                mapped_bytes_ -= it->second.size;
+            disk_bytes_ -= it->second.size;
+            blobs_.erase(it);
+            std::error_code ec;
+            std::filesystem::remove(blob_path(hash), ec);
+        }
+
+        void remove_orphan_blobs() {
+            std::error_code ec;
+            for (const auto &entry : std::filesystem::directory_iterator(objects_dir(), ec)) {
+                auto stem = entry.path().stem().string();
+                bool referenced = false;
+                if (entry.path().extension() == ".vtp" && stem.size() == 16) {
+                    u64 hash = std::strtoull(stem.c_str(), nullptr, 16);
+                    referenced = blobs_.find(hash) != blobs_.end();
+                }
+                if (!referenced)
+                    std::filesystem::remove(entry.path(), ec);
+            }
+        }
+
+        // Drop least recently used mappings nobody else holds
+        void trim_mappings() {
+            while (mapped_bytes_ > config_.memory_budget) {
+                Blob *victim = nullptr;
+                for (auto &[hash, blob] : blobs_) {
+                    if (!blob.mapping || blob.mapping.use_count() > 1)
+                        continue;
+                    if (!victim || blob.last_used < victim->last_used)
+                        victim = &blob;
+                }
+                if (!victim)
+                    return;
+                victim->mapping.reset();
+                mapped_bytes_ -= victim->size;
+                ++stats_.unmapped;
+            }
+        }
+
+        // Evict least recently used labels until unique blob bytes fit the disk
+        // budget. The blob just written (protect) is never evicted.
+        u32 enforce_disk_budget(u64 protect) {
+            u32 evicted = 0;
+            while (disk_bytes_ > config_.disk_budget) {
+                usize victim = labels_.size();
+                for (usize i = 0; i < labels_.size(); ++i) {
+                    if (protect != 0 && labels_[i].hash == protect)
+                        continue;
+                    if (victim == labels_.size() || labels_[i].last_used < labels_[victim].last_used)
+                        victim = i;
+                }
+                if (victim == labels_.size())
+                    break;
+                u64 hash = labels_[victim].hash;
+                echo::category("isobus.vt.store")
+                    .debug("Evicting pool '", labels_[victim].label, "' of client ", labels_[victim].client_key);
+                labels_.erase(labels_.begin() + static_cast<std::ptrdiff_t>(victim));
+                release_ref(hash);
+                ++evicted;
+                ++stats_.evicted;
+            }
+            return evicted;
+        }
+
+        // ─── Index persistence ────────────────────────────────────────────────────
+        // [magic "VTPS"][version u32][tick u64][count u32]
+        // count x [client_key u64][label 8][hash u64][timestamp_us u64][last_used u64][size u32][vt_version u16]
+        template <typename T> static void put_raw(std::ofstream &file, const T &v) {
+            file.write(reinterpret_cast<const char *>(&v), sizeof(T));
+        }
+        template <typename T> static bool get_raw(std::ifstream &file, T &v) {
+            return static_cast<bool>(file.read(reinterpret_cast<char *>(&v), sizeof(T)));
+        }
+
+        Result<void> write_index() {
+            auto tmp = index_path();
+            tmp += ".tmp";
+            try {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file)
+                    return Result<void>::err(Error::invalid_state("cannot write pool index"));
+                file.write("VTPS", 4);
+                put_raw(file, INDEX_VERSION);
+                put_raw(file, tick_);
+                put_raw(file, static_cast<u32>(labels_.size()));
+                for (const auto &l : labels_) {
+                    put_raw(file, l.client_key);
+                    char label_buf[8] = {0};
+                    for (usize i = 0; i < 7 && i < l.label.size(); ++i)
+                        label_buf[i] = l.label[i];
+                    file.write(label_buf, 8);
+                    put_raw(file, l.hash);
+                    put_raw(file, l.timestamp_us);
+                    put_raw(file, l.last_used);
+                    put_raw(file, l.size_bytes);
+                    put_raw(file, l.vt_version);
+                }
+                file.close();
+                if (!file)
+                    return Result<void>::err(Error::invalid_state("cannot write pool index"));
+                std::filesystem::rename(tmp, index_path());
+            } catch (...) {
+                return Result<void>::err(Error::invalid_state("cannot write pool index"));
+            }
+            return {};
+        }
+
+        void read_index() {
+            std::ifstream file(index_path(), std::ios::binary);
+            if (!file)
+                return;
+            char magic[4];
+            u32 version = 0;
+            u32 count = 0;
+            if (!file.read(magic, 4) || std::string(magic, 4) != "VTPS")
+                return;
+            if (!get_raw(file, version) || version != INDEX_VERSION)
+                return;
+            if (!get_raw(file, tick_) || !get_raw(file, count))
+                return;
+            for (u32 i = 0; i < count; ++i) {
+                PoolLabelInfo l;
+                char label_buf[9] = {0};
+                if (!get_raw(file, l.client_key) || !file.read(label_buf, 8) || !get_raw(file, l.hash) ||
+                    !get_raw(file, l.timestamp_us) || !get_raw(file, l.last_used) || !get_raw(file, l.size_bytes) ||
+                    !get_raw(file, l.vt_version))
+                    break; // keep what was read before a truncated tail
+                l.label = dp::String(label_buf);
+                labels_.push_back(std::move(l));
+            }
+        }
+    };
+
+} // namespace agrobus::isobus::vt
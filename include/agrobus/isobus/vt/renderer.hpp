@@ -0,0 +1,825 @@
+#pragma once
+
+#include "objects.hpp"
+#include <agrobus/net/types.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <datapod/datapod.hpp>
+#include <fstream>
+
+namespace agrobus::isobus::vt {
+    using namespace agrobus::net;
+
+    // ─── Screen rectangle ────────────────────────────────────────────────────────
+    struct Rect {
+        i32 x = 0;
+        i32 y = 0;
+        i32 w = 0;
+        i32 h = 0;
+
+        bool empty() const noexcept { return w <= 0 || h <= 0; }
+        i32 right() const noexcept { return x + w; }
+        i32 bottom() const noexcept { return y + h; }
+        i64 area() const noexcept { return empty() ? 0 : static_cast<i64>(w) * h; }
+
+        bool contains(i32 px, i32 py) const noexcept { return px >= x && py >= y && px < right() && py < bottom(); }
+
+        Rect intersect(const Rect &o) const noexcept {
+            i32 l = x > o.x ? x : o.x;
+            i32 t = y > o.y ? y : o.y;
+            i32 r = right() < o.right() ? right() : o.right();
+            i32 b = bottom() < o.bottom() ? bottom() : o.bottom();
+            if (r <= l || b <= t)
+                return {};
+            return {l, t, r - l, b - t};
+        }
+
+        Rect unite(const Rect &o) const noexcept {
+            if (empty())
+                return o;
+            if (o.empty())
+                return *this;
+            i32 l = x < o.x ? x : o.x;
+            i32 t = y < o.y ? y : o.y;
+            i32 r = right() > o.right() ? right() : o.right();
+            i32 b = bottom() > o.bottom() ? bottom() : o.bottom();
+            return {l, t, r - l, b - t};
+        }
+
+        bool overlaps(const Rect &o) const noexcept { return !intersect(o).empty(); }
+        bool operator==(const Rect &o) const noexcept { return x == o.x && y == o.y && w == o.w && h == o.h; }
+    };
+
+    // ─── Colours ─────────────────────────────────────────────────────────────────
+    // Pixels are packed so the in-memory byte order is R, G, B, A on little-endian.
+    inline constexpr u32 rgba(u8 r, u8 g, u8 b, u8 a = 0xFF) noexcept {
+        return static_cast<u32>(r) | (static_cast<u32>(g) << 8) | (static_cast<u32>(b) << 16) |
+               (static_cast<u32>(a) << 24);
+    }
+
+    // Colour index meaning "draw nothing" for optional backgrounds and fills.
+    // Indices 232-255 are proprietary in ISO 11783-6, so 0xFF is free to reuse.
+    inline constexpr u8 VT_NO_COLOUR = 0xFF;
+
+    // ISO 11783-6 standard colour palette: 16 named colours, then a 6x6x6 cube
+    inline constexpr u32 vt_colour(u8 index) noexcept {
+        constexpr u8 base[16][3] = {{0x00, 0x00, 0x00}, {0xFF, 0xFF, 0xFF}, {0x00, 0x99, 0x00}, {0x00, 0x99, 0x99},
+                                    {0x99, 0x00, 0x00}, {0x99, 0x00, 0x99}, {0x99, 0x99, 0x00}, {0xCC, 0xCC, 0xCC},
+                                    {0x99, 0x99, 0x99}, {0x00, 0x00, 0xFF}, {0x00, 0xFF, 0x00}, {0x00, 0xFF, 0xFF},
+                                    {0xFF, 0x00, 0x00}, {0xFF, 0x00, 0xFF}, {0xFF, 0xFF, 0x00}, {0x00, 0x00, 0x99}};
+        if (index < 16)
+            return rgba(base[index][0], base[index][1], base[index][2]);
+        if (index < 232) {
+            u8 i = static_cast<u8>(index - 16);
+            return rgba(static_cast<u8>((i / 36) * 0x33), static_cast<u8>(((i / 6) % 6) * 0x33),
+                        static_cast<u8>((i % 6) * 0x33));
+        }
+        return rgba(0, 0, 0);
+    }
+
+    // ─── RGBA framebuffer ────────────────────────────────────────────────────────
+    class Framebuffer {
+        u16 width_ = 0;
+        u16 height_ = 0;
+        dp::Vector<u32> pixels_;
+        u64 written_ = 0;
+
+      public:
+        Framebuffer() = default;
+        Framebuffer(u16 w, u16 h) { resize(w, h); }
+
+        void resize(u16 w, u16 h) {
+            width_ = w;
+            height_ = h;
+            pixels_.assign(static_cast<usize>(w) * h, rgba(0, 0, 0));
+        }
+
+        u16 width() const noexcept { return width_; }
+        u16 height() const noexcept { return height_; }
+        Rect bounds() const noexcept { return {0, 0, width_, height_}; }
+        const dp::Vector<u32> &pixels() const noexcept { return pixels_; }
+        u32 at(i32 x, i32 y) const noexcept { return pixels_[static_cast<usize>(y) * width_ + x]; }
+
+        // Pixels written since construction; used to measure incremental cost
+        u64 written() const noexcept { return written_; }
+
+        void fill(const Rect &r, u32 colour) {
+            Rect c = r.intersect(bounds());
+            if (c.empty())
+                return;
+            for (i32 y = c.y; y < c.bottom(); ++y) {
+                u32 *row = pixels_.data() + static_cast<usize>(y) * width_;
+                for (i32 x = c.x; x < c.right(); ++x)
+                    row[x] = colour;
+            }
+            written_ += static_cast<u64>(c.area());
+        }
+
+        // Single pixel, clipped to clip (which must lie inside the framebuffer)
+        void plot(i32 x, i32 y, u32 colour, const Rect &clip) {
+            if (!clip.contains(x, y))
+                return;
+            pixels_[static_cast<usize>(y) * width_ + x] = colour;
+            ++written_;
+        }
+
+        // Binary PPM (P6) dump for screenshots in CI
+        bool save_ppm(const dp::String &path) const {
+            std::ofstream file(path.c_str(), std::ios::binary);
+            if (!file)
+                return false;
+            file << "P6\n" << width_ << " " << height_ << "\n255\n";
+            for (auto p : pixels_) {
+                char rgb[3] = {static_cast<char>(p & 0xFF), static_cast<char>((p >> 8) & 0xFF),
+                               static_cast<char>((p >> 16) & 0xFF)};
+                file.write(rgb, 3);
+            }
+            return file.good();
+        }
+    };
+
+    // ─── Built-in 5x7 font ───────────────────────────────────────────────────────
+    // Column-major glyphs for ASCII 0x20..0x5A, bit 0 is the top row. Lowercase
+    // letters render as uppercase; anything else renders as a space.
+    namespace font5x7 {
+        inline constexpr u8 FIRST = 0x20;
+        inline constexpr u8 LAST = 0x5A;
+        inline constexpr u8 GLYPHS[LAST - FIRST + 1][5] = {
+            {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+            {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+            {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+            {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+            {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+            {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+            {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+            {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+            {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+            {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+            {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+            {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+            {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+            {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+            {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+            {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+            {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+            {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+            {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+            {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}};
+
+        inline const u8 *glyph(char c) noexcept {
+            u8 ch = static_cast<u8>(c);
+            if (ch >= 'a' && ch <= 'z')
+                ch = static_cast<u8>(ch - 'a' + 'A');
+            if (ch < FIRST || ch > LAST)
+                ch = FIRST;
+            return GLYPHS[ch - FIRST];
+        }
+    } // namespace font5x7
+
+    // ─── Renderer configuration ──────────────────────────────────────────────────
+    struct VTRendererConfig {
+        u16 screen_width = 800;
+        u16 screen_height = 480;
+        u16 data_mask_size = 0;   // square data mask area; 0 = screen height
+        u16 soft_key_height = 80; // height of one soft key slot
+        u8 font_scale = 2;        // built-in font is 6x8 px per cell at scale 1
+        u8 background = 0;        // colour outside the masks
+
+        VTRendererConfig &screen(u16 w, u16 h) {
+            screen_width = w;
+            screen_height = h;
+            return *this;
+        }
+        VTRendererConfig &mask_size(u16 px) {
+            data_mask_size = px;
+            return *this;
+        }
+        VTRendererConfig &key_height(u16 px) {
+            soft_key_height = px;
+            return *this;
+        }
+        VTRendererConfig &font(u8 scale) {
+            font_scale = scale;
+            return *this;
+        }
+    };
+
+    // ─── Render statistics ───────────────────────────────────────────────────────
+    struct RenderStats {
+        u32 frames = 0;
+        u32 full_frames = 0;
+        u32 partial_frames = 0;
+        u64 nodes_painted = 0;
+        u64 rects_painted = 0;
+    };
+
+    struct RenderResult {
+        bool full = false;    // whole screen was repainted
+        u32 rects = 0;        // dirty rectangles repainted
+        u64 pixels = 0;       // pixels written this frame
+        Rect damage;          // bounding box of everything repainted
+    };
+
+    // ─── Headless VT renderer ────────────────────────────────────────────────────
+    // Software renderer for the active data mask and soft key mask of one working
+    // set into an RGBA framebuffer. The pool is laid out once into a flat node list
+    // in paint order (each node knows where its subtree ends), so a repaint of a
+    // dirty rectangle walks the list once and skips whole subtrees that miss it.
+    //
+    // Value changes (Change Numeric Value, Change String Value, Hide/Show) only mark
+    // the affected object's on-screen rectangles dirty; render() then repaints just
+    // those rectangles. Mask changes and position changes rebuild the layout and
+    // repaint the whole screen.
+    //
+    // Key and AlarmMask bodies are decoded with KeyBody and AlarmMaskBody. Other
+    // bodies use the renderer's own layout: [0..1] width and [2..3] height (LE),
+    // then optional type-specific bytes. Missing bytes, or a Key/AlarmMask body
+    // that does not decode, take the defaults in brackets:
+    //   DataMask      [4] background colour (0) [5..6] soft key mask ID (none)
+    //   AlarmMask     AlarmMaskBody background colour (0) and soft key mask
+    //   SoftKeyMask   [4] background colour (8)
+    //   Key           KeyBody background colour (7)
+    //   Button        [4] background colour (7) [5] border colour (0)
+    //   OutputNumber  [4] background (none) [5] font colour (1) [6..9] value
+    //   InputNumber   [10..13] offset i32 (0) [14..17] scale f32 (1) [18] decimals (0)
+    //                 [19] justification 0=left 1=centre 2=right (2)
+    //   OutputString  [4] background (none) [5] font colour (1) [6] justification (0)
+    //   InputString   [7..] text
+    //   Rectangle     [4] line colour (1) [5] fill colour (none) [6] line width (1)
+    //   Line          [4] line colour (1) [5] direction 0=top-left to bottom-right (0)
+    //   Meter         [4] needle colour (1) [5] border colour (1) [6..7] min (0)
+    //                 [8..9] max (100) [10..13] value; needle sweeps the top half
+    //   LinearBarGraph [4] bar colour (10) [5] border colour (1) [6..9] min/max as
+    //                 Meter [10..13] value; fills left to right
+    //   PictureGraphic [4] transparent colour (none) [5..] w*h palette indices
+    //
+    // Children have no coordinates in this object model; they stack top to bottom
+    // inside their parent unless placed with set_position(). Soft keys stack in the
+    // soft key column, one soft_key_height slot each.
+    class VTRenderer {
+        static constexpr usize MAX_DIRTY_RECTS = 16;
+        static constexpr u32 MAX_DEPTH = 16;
+
+        struct Node {
+            const VTObject *obj = nullptr;
+            Rect rect; // full object rectangle
+            Rect clip; // rect clipped to all ancestors
+            u32 end = 0; // one past the last node of this subtree
+        };
+
+        VTRendererConfig config_;
+        Framebuffer fb_;
+        ObjectPool pool_;
+        dp::Map<ObjectID, const VTObject *> objects_;
+        ObjectID active_mask_ = 0xFFFF;
+        ObjectID soft_key_mask_ = 0xFFFF; // 0xFFFF = taken from the data mask body
+
+        dp::Vector<Node> nodes_;
+        dp::Map<ObjectID, dp::Vector<u32>> nodes_of_;
+        dp::Map<ObjectID, dp::Array<i16, 2>> positions_;
+        dp::Map<ObjectID, u32> numeric_;
+        dp::Map<ObjectID, dp::String> strings_;
+        dp::Map<ObjectID, bool> hidden_;
+
+        dp::Vector<Rect> dirty_;
+        bool layout_dirty_ = true;
+        RenderStats stats_;
+
+      public:
+        explicit VTRenderer(VTRendererConfig config = {}) : config_(config) {
+            fb_.resize(config_.screen_width, config_.screen_height);
+        }
+
+        // ─── Pool and masks ───────────────────────────────────────────────────────
+        // Takes a copy of the pool, so the caller may replace or drop its own.
+        // Starts on the first data mask referenced by the working set.
+        void set_pool(const ObjectPool &pool) {
+            pool_ = pool;
+            objects_.clear();
+            for (const auto &obj : pool_.objects())
+                objects_[obj.id] = &obj;
+            numeric_.clear();
+            strings_.clear();
+            hidden_.clear();
+            soft_key_mask_ = 0xFFFF;
+            active_mask_ = 0xFFFF;
+            for (const auto &obj : pool_.objects()) {
+                if (obj.type != ObjectType::WorkingSet)
+                    continue;
+                for (auto child : obj.children) {
+                    auto *c = find(child);
+                    if (c && (c->type == ObjectType::DataMask || c->type == ObjectType::AlarmMask)) {
+                        active_mask_ = child;
+                        break;
+                    }
+                }
+                break;
+            }
+            if (active_mask_ == 0xFFFF) {
+                for (const auto &obj : pool_.objects()) {
+                    if (obj.type == ObjectType::DataMask) {
+                        active_mask_ = obj.id;
+                        break;
+                    }
+                }
+            }
+            layout_dirty_ = true;
+        }
+
+        const ObjectPool &pool() const noexcept { return pool_; }
+        ObjectID active_mask() const noexcept { return active_mask_; }
+
+        void set_active_mask(ObjectID mask) {
+            if (mask == active_mask_)
+                return;
+            active_mask_ = mask;
+            soft_key_mask_ = 0xFFFF;
+            layout_dirty_ = true;
+        }
+
+        void set_soft_key_mask(ObjectID mask) {
+            if (mask == soft_key_mask_)
+                return;
+            soft_key_mask_ = mask;
+            layout_dirty_ = true;
+        }
+
+        // Place an object relative to its parent instead of stacking it
+        void set_position(ObjectID id, i16 x, i16 y) {
+            positions_[id] = dp::Array<i16, 2>{x, y};
+            layout_dirty_ = true;
+        }
+
+        // ─── Value changes ────────────────────────────────────────────────────────
+        void set_numeric_value(ObjectID id, u32 value) {
+            auto it = numeric_.find(id);
+            if (it != numeric_.end() && it->second == value)
+                return;
+            numeric_[id] = value;
+            invalidate(id);
+        }
+
+        void set_string_value(ObjectID id, const dp::String &value) {
+            auto it = strings_.find(id);
+            if (it != strings_.end() && it->second == value)
+                return;
+            strings_[id] = value;
+            invalidate(id);
+        }
+
+        void set_visible(ObjectID id, bool visible) {
+            if (is_hidden(id) == !visible)
+                return;
+            hidden_[id] = !visible;
+            invalidate(id);
+        }
+
+        // Mark every on-screen instance of an object for repaint
+        void invalidate(ObjectID id) {
+            if (layout_dirty_)
+                return;
+            auto it = nodes_of_.find(id);
+            if (it == nodes_of_.end())
+                return;
+            for (auto idx : it->second)
+                add_dirty(nodes_[idx].clip);
+        }
+
+        void invalidate_all() { layout_dirty_ = true; }
+
+        // ─── Rendering ────────────────────────────────────────────────────────────
+        RenderResult render() {
+            RenderResult result;
+            u64 before = fb_.written();
+            if (layout_dirty_) {
+                rebuild_layout();
+                fb_.fill(fb_.bounds(), vt_colour(config_.background));
+                paint(fb_.bounds());
+                dirty_.clear();
+                result.full = true;
+                result.rects = 1;
+                result.damage = fb_.bounds();
+                ++stats_.full_frames;
+            } else if (!dirty_.empty()) {
+                for (const auto &r : dirty_) {
+                    paint(r);
+                    result.damage = result.damage.unite(r);
+                }
+                result.rects = static_cast<u32>(dirty_.size());
+                dirty_.clear();
+                ++stats_.partial_frames;
+            }
+            ++stats_.frames;
+            stats_.rects_painted += result.rects;
+            result.pixels = fb_.written() - before;
+            return result;
+        }
+
+        bool needs_render() const noexcept { return layout_dirty_ || !dirty_.empty(); }
+        const dp::Vector<Rect> &dirty_rects() const noexcept { return dirty_; }
+        const Framebuffer &framebuffer() const noexcept { return fb_; }
+        const RenderStats &stats() const noexcept { return stats_; }
+        usize node_count() const noexcept { return nodes_.size(); }
+
+        // Screen rectangle of the first instance of an object (after a render)
+        dp::Optional<Rect> bounds_of(ObjectID id) const {
+            auto it = nodes_of_.find(id);
+            if (it == nodes_of_.end() || it->second.empty())
+                return dp::nullopt;
+            return nodes_[it->second.front()].rect;
+        }
+
+      private:
+        // ─── Body access ──────────────────────────────────────────────────────────
+        static u8 body_u8(const VTObject &o, usize at, u8 def) { return at < o.body.size() ? o.body[at] : def; }
+
+        static u16 body_u16(const VTObject &o, usize at, u16 def) {
+            if (at + 1 >= o.body.size())
+                return def;
+            return static_cast<u16>(o.body[at]) | (static_cast<u16>(o.body[at + 1]) << 8);
+        }
+
+        static u32 body_u32(const VTObject &o, usize at, u32 def) {
+            if (at + 3 >= o.body.size())
+                return def;
+            return static_cast<u32>(o.body[at]) | (static_cast<u32>(o.body[at + 1]) << 8) |
+                   (static_cast<u32>(o.body[at + 2]) << 16) | (static_cast<u32>(o.body[at + 3]) << 24);
+        }
+
+        const VTObject *find(ObjectID id) const {
+            auto it = objects_.find(id);
+            return it == objects_.end() ? nullptr : it->second;
+        }
+
+        bool is_hidden(ObjectID id) const {
+            auto it = hidden_.find(id);
+            return it != hidden_.end() && it->second;
+        }
+
+        static bool is_drawable(ObjectType t) {
+            switch (t) {
+            case ObjectType::DataMask:
+            case ObjectType::AlarmMask:
+            case ObjectType::SoftKeyMask:
+            case ObjectType::Container:
+            case ObjectType::Key:
+            case ObjectType::Button:
+            case ObjectType::OutputNumber:
+            case ObjectType::InputNumber:
+            case ObjectType::OutputString:
+            case ObjectType::InputString:
+            case ObjectType::Line:
+            case ObjectType::Rectangle:
+            case ObjectType::Meter:
+            case ObjectType::LinearBarGraph:
+            case ObjectType::PictureGraphic:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        // ─── Layout ───────────────────────────────────────────────────────────────
+        void rebuild_layout() {
+            nodes_.clear();
+            nodes_of_.clear();
+            layout_dirty_ = false;
+
+            i32 sw = config_.screen_width;
+            i32 sh = config_.screen_height;
+            i32 dm = config_.data_mask_size ? config_.data_mask_size : (sh < sw ? sh : sw);
+            Rect mask_area = Rect{0, 0, dm, dm}.intersect(fb_.bounds());
+            Rect key_area = Rect{dm, 0, sw - dm, sh}.intersect(fb_.bounds());
+
+            ObjectID sk = soft_key_mask_;
+            if (auto *mask = find(active_mask_)) {
+                place(*mask, mask_area, mask_area, 0);
+                if (sk == 0xFFFF && mask->type == ObjectType::DataMask)
+                    sk = body_u16(*mask, 5, 0xFFFF);
+                if (sk == 0xFFFF && mask->type == ObjectType::AlarmMask)
+                    if (auto am = mask->get_alarm_mask_body(); am.is_ok())
+                        sk = am.value().soft_key_mask;
+            }
+            if (auto *keys = find(sk); keys && !key_area.empty())
+                place(*keys, key_area, key_area, 0);
+        }
+
+        void place(const VTObject &obj, const Rect &rect, const Rect &parent_clip, u32 depth) {
+            u32 index = static_cast<u32>(nodes_.size());
+            Node node;
+            node.obj = &obj;
+            node.rect = rect;
+            node.clip = rect.intersect(parent_clip);
+            nodes_.push_back(node);
+            nodes_of_[obj.id].push_back(index);
+
+            if (depth < MAX_DEPTH) {
+                bool key_column = obj.type == ObjectType::SoftKeyMask;
+                i32 cursor = 0;
+                for (auto child_id : obj.children) {
+                    auto *child = find(child_id);
+                    if (!child || !is_drawable(child->type) || child_id == obj.id)
+                        continue;
+                    Rect child_rect;
+                    if (key_column) {
+                        child_rect = {rect.x, rect.y + cursor, rect.w, config_.soft_key_height};
+                        cursor += config_.soft_key_height;
+                    } else {
+                        i32 w = body_u16(*child, 0, 0);
+                        i32 h = body_u16(*child, 2, 0);
+                        auto pos = positions_.find(child_id);
+                        if (pos != positions_.end()) {
+                            child_rect = {rect.x + pos->second[0], rect.y + pos->second[1], w, h};
+                        } else {
+                            child_rect = {rect.x, rect.y + cursor, w, h};
+                            cursor += h;
+                        }
+                    }
+                    place(*child, child_rect, nodes_[index].clip, depth + 1);
+                }
+            }
+            nodes_[index].end = static_cast<u32>(nodes_.size());
+        }
+
+        // ─── Dirty rectangles ─────────────────────────────────────────────────────
+        void add_dirty(const Rect &r) {
+            if (r.empty())
+                return;
+            // Absorb every overlapping rect; a grown rect may reach further ones
+            Rect merged = r;
+            for (usize i = 0; i < dirty_.size();) {
+                if (dirty_[i].overlaps(merged)) {
+                    merged = merged.unite(dirty_[i]);
+                    dirty_.erase(dirty_.begin() + static_cast<std::ptrdiff_t>(i));
+                    i = 0;
+                } else {
+                    ++i;
+                }
+            }
+            if (dirty_.size() >= MAX_DIRTY_RECTS) {
+                for (const auto &d : dirty_)
+                    merged = merged.unite(d);
+                dirty_.clear();
+            }
+            dirty_.push_back(merged);
+        }
+
+        // ─── Painting ─────────────────────────────────────────────────────────────
+        void paint(const Rect &area) {
+            for (u32 i = 0; i < nodes_.size();) {
+                const auto &n = nodes_[i];
+                Rect c = n.clip.intersect(area);
+                if (c.empty() || is_hidden(n.obj->id)) {
+                    i = n.end; // children are clipped to this node, skip them all
+                    continue;
+                }
+                paint_node(n, c);
+                ++stats_.nodes_painted;
+                ++i;
+            }
+        }
+
+        void paint_node(const Node &n, const Rect &clip) {
+            const VTObject &o = *n.obj;
+            switch (o.type) {
+            case ObjectType::DataMask:
+                fb_.fill(clip, vt_colour(body_u8(o, 4, 0)));
+                break;
+            case ObjectType::AlarmMask: {
+                auto am = o.get_alarm_mask_body();
+                fb_.fill(clip, vt_colour(am.is_ok() ? am.value().background_color : 0));
+                break;
+            }
+            case ObjectType::SoftKeyMask:
+                fb_.fill(clip, vt_colour(body_u8(o, 4, 8)));
+                break;
+            case ObjectType::Key: {
+                auto key = o.get_key_body();
+                fb_.fill(clip, vt_colour(key.is_ok() ? key.value().background_color : 7));
+                break;
+            }
+            case ObjectType::Button:
+                fb_.fill(clip, vt_colour(body_u8(o, 4, 7)));
+                draw_frame(n.rect, 1, vt_colour(body_u8(o, 5, 0)), clip);
+                break;
+            case ObjectType::OutputNumber:
+            case ObjectType::InputNumber:
+                paint_number(n, clip);
+                break;
+            case ObjectType::OutputString:
+            case ObjectType::InputString:
+                paint_string(n, clip);
+                break;
+            case ObjectType::Rectangle: {
+                u8 fill = body_u8(o, 5, VT_NO_COLOUR);
+                if (fill != VT_NO_COLOUR)
+                    fb_.fill(clip, vt_colour(fill));
+                draw_frame(n.rect, body_u8(o, 6, 1), vt_colour(body_u8(o, 4, 1)), clip);
+                break;
+            }
+            case ObjectType::Line: {
+                const Rect &r = n.rect;
+                u32 colour = vt_colour(body_u8(o, 4, 1));
+                if (body_u8(o, 5, 0) == 0)
+                    draw_line(r.x, r.y, r.right() - 1, r.bottom() - 1, colour, clip);
+                else
+                    draw_line(r.x, r.bottom() - 1, r.right() - 1, r.y, colour, clip);
+                break;
+            }
+            case ObjectType::Meter:
+                paint_meter(n, clip);
+                break;
+            case ObjectType::LinearBarGraph:
+                paint_bar(n, clip);
+                break;
+            case ObjectType::PictureGraphic:
+                paint_picture(n, clip);
+                break;
+            default:
+                break; // Container: children only
+            }
+        }
+
+        u32 value_of(const VTObject &o, usize at) const {
+            auto it = numeric_.find(o.id);
+            return it != numeric_.end() ? it->second : body_u32(o, at, 0);
+        }
+
+        // Fraction of value within [min, max], clamped to 0..1
+        static f64 fraction(u32 value, u16 min, u16 max) {
+            if (max <= min)
+                return 0.0;
+            if (value <= min)
+                return 0.0;
+            if (value >= max)
+                return 1.0;
+            return static_cast<f64>(value - min) / static_cast<f64>(max - min);
+        }
+
+        void paint_number(const Node &n, const Rect &clip) {
+            const VTObject &o = *n.obj;
+            u8 bg = body_u8(o, 4, VT_NO_COLOUR);
+            if (bg != VT_NO_COLOUR)
+                fb_.fill(clip, vt_colour(bg));
+
+            i32 offset = static_cast<i32>(body_u32(o, 10, 0));
+            f32 scale = 1.0f;
+            if (o.body.size() >= 18) {
+                u32 bits = body_u32(o, 14, 0);
+                std::memcpy(&scale, &bits, sizeof(scale));
+            }
+            f64 shown = (static_cast<f64>(value_of(o, 6)) + offset) * scale;
+            char text[32];
+            int len = snprintf(text, sizeof(text), "%.*f", static_cast<int>(body_u8(o, 18, 0)), shown);
+            if (len < 0)
+                return;
+            draw_text(n.rect, text, static_cast<usize>(len), body_u8(o, 19, 2), vt_colour(body_u8(o, 5, 1)), clip);
+        }
+
+        void paint_string(const Node &n, const Rect &clip) {
+            const VTObject &o = *n.obj;
+            u8 bg = body_u8(o, 4, VT_NO_COLOUR);
+            if (bg != VT_NO_COLOUR)
+                fb_.fill(clip, vt_colour(bg));
+            u32 colour = vt_colour(body_u8(o, 5, 1));
+            u8 justify = body_u8(o, 6, 0);
+
+            auto it = strings_.find(o.id);
+            if (it != strings_.end()) {
+                draw_text(n.rect, it->second.c_str(), it->second.size(), justify, colour, clip);
+            } else if (o.body.size() > 7) {
+                draw_text(n.rect, reinterpret_cast<const char *>(o.body.data() + 7), o.body.size() - 7, justify, colour,
+                          clip);
+            }
+        }
+
+        void paint_meter(const Node &n, const Rect &clip) {
+            const VTObject &o = *n.obj;
+            const Rect &r = n.rect;
+            i32 radius = (r.w < r.h ? r.w : r.h) / 2 - 1;
+            if (radius <= 0)
+                return;
+            i32 cx = r.x + r.w / 2;
+            i32 cy = r.y + r.h / 2;
+            draw_circle(cx, cy, radius, vt_colour(body_u8(o, 5, 1)), clip);
+
+            f64 f = fraction(value_of(o, 10), body_u16(o, 6, 0), body_u16(o, 8, 100));
+            f64 angle = 3.14159265358979323846 * (1.0 - f); // 180 deg (left) to 0 deg (right)
+            i32 len = radius - 2;
+            i32 ex = cx + static_cast<i32>(len * std::cos(angle));
+            i32 ey = cy - static_cast<i32>(len * std::sin(angle));
+            draw_line(cx, cy, ex, ey, vt_colour(body_u8(o, 4, 1)), clip);
+        }
+
+        void paint_bar(const Node &n, const Rect &clip) {
+            const VTObject &o = *n.obj;
+            const Rect &r = n.rect;
+            f64 f = fraction(value_of(o, 10), body_u16(o, 6, 0), body_u16(o, 8, 100));
+            Rect bar{r.x, r.y, static_cast<i32>(r.w * f), r.h};
+            fb_.fill(bar.intersect(clip), vt_colour(body_u8(o, 4, 10)));
+            draw_frame(r, 1, vt_colour(body_u8(o, 5, 1)), clip);
+        }
+
+        void paint_picture(const Node &n, const Rect &clip) {
+            const VTObject &o = *n.obj;
+            const Rect &r = n.rect;
+            u8 transparent = body_u8(o, 4, VT_NO_COLOUR);
+            usize available = o.body.size() > 5 ? o.body.size() - 5 : 0;
+            const u8 *px = o.body.data() + 5;
+            for (i32 y = clip.y; y < clip.bottom(); ++y) {
+                usize row = static_cast<usize>(y - r.y) * static_cast<usize>(r.w);
+                for (i32 x = clip.x; x < clip.right(); ++x) {
+                    usize i = row + static_cast<usize>(x - r.x);
+                    if (i >= available)
+                        return;
+                    if (px[i] != transparent)
+                        fb_.plot(x, y, vt_colour(px[i]), clip);
+                }
+            }
+        }
+
+        // ─── Primitives ───────────────────────────────────────────────────────────
+        void draw_frame(const Rect &r, u8 width, u32 colour, const Rect &clip) {
+            i32 lw = width;
+            if (lw == 0)
+                return;
+            fb_.fill(Rect{r.x, r.y, r.w, lw}.intersect(clip), colour);
+            fb_.fill(Rect{r.x, r.bottom() - lw, r.w, lw}.intersect(clip), colour);
+            fb_.fill(Rect{r.x, r.y, lw, r.h}.intersect(clip), colour);
+            fb_.fill(Rect{r.right() - lw, r.y, lw, r.h}.intersect(clip), colour);
+        }
+
+        void draw_line(i32 x0, i32 y0, i32 x1, i32 y1, u32 colour, const Rect &clip) {
+            i32 dx = x1 > x0 ? x1 - x0 : x0 - x1;
+            i32 dy = y1 > y0 ? y0 - y1 : y1 - y0;
+            i32 sx = x0 < x1 ? 1 : -1;
+            i32 sy = y0 < y1 ? 1 : -1;
+            i32 err = dx + dy;
+            while (true) {
+                fb_.plot(x0, y0, colour, clip);
+                if (x0 == x1 && y0 == y1)
+                    break;
+                i32 e2 = 2 * err;
+                if (e2 >= dy) {
+                    err += dy;
+                    x0 += sx;
+                }
+                if (e2 <= dx) {
+                    err += dx;
+                    y0 += sy;
+                }
+            }
+        }
+
+        void draw_circle(i32 cx, i32 cy, i32 radius, u32 colour, const Rect &clip) {
+            i32 x = radius;
+            i32 y = 0;
+            i32 err = 1 - radius;
+            while (x >= y) {
+                fb_.plot(cx + x, cy + y, colour, clip);
+                fb_.plot(cx + y, cy + x, colour, clip);
+                fb_.plot(cx - y, cy + x, colour, clip);
+                fb_.plot(cx - x, cy + y, colour, clip);
+                fb_.plot(cx - x, cy - y, colour, clip);
+                fb_.plot(cx - y, cy - x, colour, clip);
+                fb_.plot(cx + y, cy - x, colour, clip);
+                fb_.plot(cx + x, cy - y, colour, clip);
+                ++y;
+                if (err < 0) {
+                    err += 2 * y + 1;
+                } else {
+                    --x;
+                    err += 2 * (y - x) + 1;
+                }
+            }
+        }
+
+        void draw_text(const Rect &r, const char *text, usize len, u8 justify, u32 colour, const Rect &clip) {
+            i32 s = config_.font_scale ? config_.font_scale : 1;
+            i32 cell_w = 6 * s;
+            i32 text_w = static_cast<i32>(len) * cell_w;
+            i32 x = r.x;
+            if (justify == 1)
+                x = r.x + (r.w - text_w) / 2;
+            else if (justify == 2)
+                x = r.right() - text_w;
+            i32 y = r.y + (r.h - 7 * s) / 2;
+
+            for (usize i = 0; i < len; ++i, x += cell_w) {
+                Rect cell{x, y, 5 * s, 7 * s};
+                if (!cell.overlaps(clip))
+                    continue;
+                const u8 *g = font5x7::glyph(text[i]);
+                for (i32 col = 0; col < 5; ++col) {
+                    u8 bits = g[col];
+                    for (i32 row = 0; bits; ++row, bits >>= 1) {
+                        if (bits & 1)
+                            fb_.fill(Rect{x + col * s, y + row * s, s, s}.intersect(clip), colour);
+                    }
+                }
+            }
+        }
+    };
+
+} // namespace agrobus::isobus::vt
@@ -2,6 +2,7 @@
 
 #include "commands.hpp"
 #include "objects.hpp"
+#include "renderer.hpp"
 #include "server_working_set.hpp"
 #include "working_set.hpp"
 #include <agrobus/net/constants.hpp>
@@ -60,6 +61,8 @@ namespace agrobus::isobus::vt {
         u16 screen_width_;
         u16 screen_height_;
         Address active_working_set_ = NULL_ADDRESS;
+        PoolStore *pool_store_ = nullptr;
+        VTRenderer *renderer_ = nullptr;
 
       public:
         VTServer(IsoNet &net, InternalCF *cf, VTServerConfig config = {})
@@ -95,6 +98,23 @@ namespace agrobus::isobus::vt {
             }
         }
 
+        // Use a shared content-addressed store for all clients' stored versions.
+        // Pass nullptr to fall back to the per-client files under the storage path.
+        void set_pool_store(PoolStore *store) {
+            pool_store_ = store;
+            for (auto &client : clients_)
+                client.pool_store = store;
+        }
+
+        PoolStore *pool_store() const noexcept { return pool_store_; }
+
+        // Associate a client's NAME so its stored pools follow it across addresses
+        void set_client_name(Address addr, u64 name) {
+            ensure_client(addr);
+            if (auto *client = find_client(addr))
+                client->client_name = name;
+        }
+
         // Load all versions from disk for all clients
         u32 load_all_versions() {
             u32 total_loaded = 0;
@@ -119,9 +139,10 @@ namespace agrobus::isobus::vt {
             return total_saved;
         }
 
-        // Cleanup expired versions for all clients
+        // Cleanup expired versions for all clients. With a pool store this also
+        // evicts least recently used versions down to the store's disk budget.
         u32 cleanup_expired_versions(u32 max_age_days = 30) {
-            u32 total_deleted = 0;
+            u32 total_deleted = pool_store_ ? pool_store_->cleanup(max_age_days) : 0;
             for (auto &client : clients_) {
                 total_deleted += client.cleanup_expired_versions(max_age_days);
             }
@@ -131,6 +152,20 @@ namespace agrobus::isobus::vt {
             return total_deleted;
         }
 
+        // ─── Rendering ────────────────────────────────────────────────────────────
+        // Attach a renderer that mirrors the active working set. The server feeds it
+        // pool activations and value/visibility/mask commands; the caller decides
+        // when to call VTRenderer::render().
+        void set_renderer(VTRenderer *renderer) {
+            renderer_ = renderer;
+            if (!renderer_)
+                return;
+            if (auto *client = find_client(active_working_set_); client && client->pool_activated)
+                renderer_->set_pool(client->pool);
+        }
+
+        VTRenderer *renderer() const noexcept { return renderer_; }
+
         // ─── Active Working Set management ────────────────────────────────────────
         Address active_working_set() const noexcept { return active_working_set_; }
 
@@ -139,6 +174,10 @@ namespace agrobus::isobus::vt {
             if (old_addr == addr)
                 return;
             active_working_set_ = addr;
+            if (renderer_) {
+                if (auto *client = find_client(addr); client && client->pool_activated)
+                    renderer_->set_pool(client->pool);
+            }
             on_active_ws_changed.emit(old_addr, addr);
             echo::category("isobus.vt.server").info("Active working set changed: ", old_addr, " -> ", addr);
         }
@@ -287,6 +326,15 @@ namespace agrobus::isobus::vt {
             case vt_cmd::CHANGE_STRING_VALUE:
                 handle_string_value_change(msg);
                 break;
+            case vt_cmd::HIDE_SHOW:
+                handle_hide_show(msg);
+                break;
+            case vt_cmd::CHANGE_ACTIVE_MASK:
+                handle_change_active_mask(msg);
+                break;
+            case vt_cmd::CHANGE_SOFT_KEY_MASK:
+                handle_change_soft_key_mask(msg);
+                break;
             default:
                 echo::category("isobus.vt.server")
                     .trace("Unhandled ECU->VT function: 0x", function, " from ", msg.source);
@@ -405,6 +453,8 @@ namespace agrobus::isobus::vt {
 
             if (client && client->load_version(label)) {
                 response[1] = 0x00; // success
+                if (renderer_ && msg.source == active_working_set_)
+                    renderer_->set_pool(client->pool);
                 if (state_.state() != VTServerState::Connected) {
                     state_.transition(VTServerState::Connected);
                     on_state_change.emit(VTServerState::Connected);
@@ -446,12 +496,13 @@ namespace agrobus::isobus::vt {
             dp::Vector<u8> response;
             response.push_back(vt_cmd::GET_VERSIONS_RESPONSE);
 
-            if (client && !client->stored_versions.empty()) {
-                response.push_back(static_cast<u8>(client->stored_versions.size()));
-                for (const auto &ver : client->stored_versions) {
+            auto labels = client ? client->version_labels() : dp::Vector<dp::String>{};
+            if (!labels.empty()) {
+                response.push_back(static_cast<u8>(labels.size()));
+                for (const auto &label : labels) {
                     // Each label is exactly 7 bytes (space-padded)
                     for (usize i = 0; i < 7; ++i) {
-                        response.push_back((i < ver.label.size()) ? static_cast<u8>(ver.label[i]) : 0x20);
+                        response.push_back((i < label.size()) ? static_cast<u8>(label[i]) : 0x20);
                     }
                 }
             } else {
@@ -504,6 +555,8 @@ namespace agrobus::isobus::vt {
                 // Set as active working set if none is currently active
                 if (active_working_set_ == NULL_ADDRESS) {
                     set_active_working_set(msg.source);
+                } else if (renderer_ && msg.source == active_working_set_) {
+                    renderer_->set_pool(client->pool);
                 }
                 on_client_connected.emit(msg.source);
                 echo::category("isobus.vt.server").info("pool activated for addr=", msg.source);
@@ -520,6 +573,8 @@ namespace agrobus::isobus::vt {
             ObjectID obj_id = static_cast<u16>(msg.data[1]) | (static_cast<u16>(msg.data[2]) << 8);
             u32 value = static_cast<u32>(msg.data[4]) | (static_cast<u32>(msg.data[5]) << 8) |
                         (static_cast<u32>(msg.data[6]) << 16) | (static_cast<u32>(msg.data[7]) << 24);
+            if (renderer_ && msg.source == active_working_set_)
+                renderer_->set_numeric_value(obj_id, value);
             on_numeric_value_change.emit(obj_id, value);
         }
 
@@ -532,15 +587,41 @@ namespace agrobus::isobus::vt {
             for (u16 i = 0; i < len && static_cast<usize>(5 + i) < msg.data.size(); ++i) {
                 value += static_cast<char>(msg.data[5 + i]);
             }
+            if (renderer_ && msg.source == active_working_set_)
+                renderer_->set_string_value(obj_id, value);
             on_string_value_change.emit(obj_id, value);
         }
 
+        void handle_hide_show(const Message &msg) {
+            if (msg.data.size() < 4 || !renderer_ || msg.source != active_working_set_)
+                return;
+            ObjectID obj_id = static_cast<u16>(msg.data[1]) | (static_cast<u16>(msg.data[2]) << 8);
+            renderer_->set_visible(obj_id, msg.data[3] != 0);
+        }
+
+        void handle_change_active_mask(const Message &msg) {
+            if (msg.data.size() < 5 || !renderer_ || msg.source != active_working_set_)
+                return;
+            ObjectID mask_id = static_cast<u16>(msg.data[3]) | (static_cast<u16>(msg.data[4]) << 8);
+            renderer_->set_active_mask(mask_id);
+        }
+
+        void handle_change_soft_key_mask(const Message &msg) {
+            if (msg.data.size() < 6 || !renderer_ || msg.source != active_working_set_)
+                return;
+            ObjectID data_mask_id = static_cast<u16>(msg.data[2]) | (static_cast<u16>(msg.data[3]) << 8);
+            ObjectID sk_mask_id = static_cast<u16>(msg.data[4]) | (static_cast<u16>(msg.data[5]) << 8);
+            if (data_mask_id == renderer_->active_mask())
+                renderer_->set_soft_key_mask(sk_mask_id);
+        }
+
         void ensure_client(Address addr) {
             for (auto &c : clients_) {
                 if (c.client_address == addr)
                     return;
             }
             clients_.push_back({addr, {}, {}, false, false, 0, {}});
+            clients_.back().pool_store = pool_store_;
         }
 
         ServerWorkingSet *find_client(Address addr) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "objects.hpp"
+#include "pool_store.hpp"
 #include "working_set.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/types.hpp>
@@ -65,6 +66,24 @@ namespace agrobus::isobus::vt {
         u32 last_status_ms = 0;
         dp::Vector<StoredPoolVersion> stored_versions;
         dp::String storage_path = "./vt_storage"; // default storage directory
+        PoolStore *pool_store = nullptr;          // shared content-addressed store (optional)
+        u64 client_name = 0;                      // raw NAME when known, keys the pool store
+
+        // Key under which this client's pools live in the shared store
+        u64 store_key() const noexcept { return client_name != 0 ? client_name : client_address; }
+
+        // Labels of all stored versions (store index or in-memory list)
+        dp::Vector<dp::String> version_labels() const {
+            dp::Vector<dp::String> out;
+            if (pool_store) {
+                for (const auto &l : pool_store->labels(store_key()))
+                    out.push_back(l.label);
+            } else {
+                for (const auto &v : stored_versions)
+                    out.push_back(v.label);
+            }
+            return out;
+        }
 
         // Find a stored version by label
         StoredPoolVersion *find_version(const dp::String &label) {
@@ -83,6 +102,10 @@ namespace agrobus::isobus::vt {
             if (!data.is_ok())
                 return false;
 
+            // Shared store: deduplicated blob plus a label reference, nothing kept in memory
+            if (pool_store)
+                return pool_store->put(store_key(), label, data.value(), vt_ver).is_ok();
+
             StoredPoolVersion ver;
             ver.label = label;
             ver.pool_data = std::move(data.value());
@@ -105,6 +128,20 @@ namespace agrobus::isobus::vt {
 
         // Load a stored version into the active pool (try memory, then disk)
         bool load_version(const dp::String &label) {
+            // Shared store: deserialize straight from the mapped blob
+            if (pool_store) {
+                auto view = pool_store->load(store_key(), label);
+                if (!view.is_ok())
+                    return false;
+                auto result = ObjectPool::deserialize(view.value().span());
+                if (!result.is_ok())
+                    return false;
+                pool = std::move(result.value());
+                pool_uploaded = true;
+                pool_activated = true;
+                return true;
+            }
+
             // Try in-memory first
             auto *ver = find_version(label);
 
@@ -132,6 +169,8 @@ namespace agrobus::isobus::vt {
 
         // Delete a stored version
         bool delete_version(const dp::String &label) {
+            if (pool_store)
+                return pool_store->remove(store_key(), label);
             for (auto it = stored_versions.begin(); it != stored_versions.end(); ++it) {
                 if (it->label == label) {
                     stored_versions.erase(it);
@@ -256,6 +295,9 @@ namespace agrobus::isobus::vt {
 
         // Load all versions from disk into memory
         u32 load_all_versions_from_disk() {
+            // Shared store: pools stay on disk and are mapped on demand
+            if (pool_store)
+                return 0;
             u32 loaded = 0;
             try {
                 auto dir = get_client_storage_dir();
@@ -288,7 +330,10 @@ namespace agrobus::isobus::vt {
         }
 
         // Clean up expired versions (both in-memory and on-disk)
+        // With a shared store, eviction is store-wide (see PoolStore::cleanup).
         u32 cleanup_expired_versions(u32 max_age_days = 30) {
+            if (pool_store)
+                return 0;
             u32 deleted = 0;
 
             // Remove expired from in-memory cache
@@ -307,6 +352,8 @@ namespace agrobus::isobus::vt {
 
         // Save all in-memory versions to disk
         u32 save_all_versions_to_disk() {
+            if (pool_store)
+                return 0; // already persisted on store
             u32 saved = 0;
             for (const auto &ver : stored_versions) {
                 if (save_version_to_disk(ver))
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "commands.hpp"
+#include "dense_state.hpp"
 #include "objects.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/event.hpp>
@@ -47,9 +48,13 @@ namespace agrobus::isobus::vt {
     // Tracks: active masks, numeric/string values, visibility, enable states,
     // and soft key mask assignments.
     //
+    // Objects of a bound pool (bind_pool) are kept in a dense slot layout
+    // (DenseObjectState); other IDs fall back to the sparse maps.
+    //
     // Usage:
     //   VTClientStateTracker tracker(nm);
     //   tracker.initialize();
+    //   tracker.bind_pool(pool); // optional: O(1) per-object state
     //   // ... later ...
     //   auto mask = tracker.active_data_mask();
     //   auto val = tracker.numeric_value(obj_id);
@@ -64,6 +69,7 @@ namespace agrobus::isobus::vt {
         dp::Map<ObjectID, bool> visibility_;
         dp::Map<ObjectID, bool> enable_state_;
         dp::Map<ObjectID, ObjectID> soft_key_mask_assignments_; // data mask -> soft key mask
+        DenseObjectState dense_;                                // pool objects (when bound)
 
         // ─── Alarm Priority Stack ─────────────────────────────────────────────────
         dp::Vector<AlarmEntry> active_alarms_;              // Sorted by priority (highest first)
@@ -90,6 +96,8 @@ namespace agrobus::isobus::vt {
         u8 vt_busy_code() const noexcept { return vt_busy_code_; }
 
         dp::Optional<u32> numeric_value(ObjectID id) const {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                return dense_.numeric(slot);
             auto it = numeric_values_.find(id);
             if (it != numeric_values_.end())
                 return it->second;
@@ -97,6 +105,8 @@ namespace agrobus::isobus::vt {
         }
 
         dp::Optional<dp::String> string_value(ObjectID id) const {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                return dense_.string(slot);
             auto it = string_values_.find(id);
             if (it != string_values_.end())
                 return it->second;
@@ -104,6 +114,8 @@ namespace agrobus::isobus::vt {
         }
 
         dp::Optional<bool> is_visible(ObjectID id) const {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                return dense_.visible(slot);
             auto it = visibility_.find(id);
             if (it != visibility_.end())
                 return it->second;
@@ -111,12 +123,22 @@ namespace agrobus::isobus::vt {
         }
 
         dp::Optional<bool> is_enabled(ObjectID id) const {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                return dense_.enabled(slot);
             auto it = enable_state_.find(id);
             if (it != enable_state_.end())
                 return it->second;
             return dp::nullopt;
         }
 
+        // Compares without materializing the stored string
+        bool string_value_equals(ObjectID id, const dp::String &value) const {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                return dense_.string_equals(slot, value);
+            auto it = string_values_.find(id);
+            return it != string_values_.end() && it->second == value;
+        }
+
         dp::Optional<ObjectID> soft_key_mask_for(ObjectID data_mask_id) const {
             auto it = soft_key_mask_assignments_.find(data_mask_id);
             if (it != soft_key_mask_assignments_.end())
@@ -223,11 +245,81 @@ namespace agrobus::isobus::vt {
             return false;
         }
 
+        // ─── Dense pool binding ───────────────────────────────────────────────────
+        // Assigns a compact slot to every object in the pool. Values already held
+        // in the sparse maps for pool objects are migrated into the dense store.
+        void bind_pool(const ObjectPool &pool) {
+            dense_.assign(pool);
+            migrate_to_dense(numeric_values_, [this](Slot s, u32 v) { dense_.set_numeric(s, v); });
+            migrate_to_dense(string_values_, [this](Slot s, const dp::String &v) { dense_.set_string(s, v); });
+            migrate_to_dense(visibility_, [this](Slot s, bool v) { dense_.set_visible(s, v); });
+            migrate_to_dense(enable_state_, [this](Slot s, bool v) { dense_.set_enabled(s, v); });
+            echo::category("isobus.vt.tracker").debug("bound pool: ", dense_.size(), " slots");
+        }
+
+        void unbind_pool() { dense_.clear(); }
+        bool is_pool_bound() const noexcept { return !dense_.empty(); }
+
+        DenseObjectState &dense() noexcept { return dense_; }
+        const DenseObjectState &dense() const noexcept { return dense_; }
+
         // ─── Manual state injection (for testing or initial sync) ─────────────────
-        void set_numeric_value(ObjectID id, u32 value) { numeric_values_[id] = value; }
-        void set_string_value(ObjectID id, dp::String value) { string_values_[id] = std::move(value); }
-        void set_visibility(ObjectID id, bool visible) { visibility_[id] = visible; }
-        void set_enable_state(ObjectID id, bool enabled) { enable_state_[id] = enabled; }
+        void set_numeric_value(ObjectID id, u32 value) {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                dense_.set_numeric(slot, value);
+            else
+                numeric_values_[id] = value;
+        }
+        void set_string_value(ObjectID id, dp::String value) {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                dense_.set_string(slot, value);
+            else
+                string_values_[id] = std::move(value);
+        }
+        void set_visibility(ObjectID id, bool visible) {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                dense_.set_visible(slot, visible);
+            else
+                visibility_[id] = visible;
+        }
+        void set_enable_state(ObjectID id, bool enabled) {
+            if (auto slot = dense_.slot_of(id); slot != INVALID_SLOT)
+                dense_.set_enabled(slot, enabled);
+            else
+                enable_state_[id] = enabled;
+        }
+
+        // ─── Staged local changes (dense objects only) ────────────────────────────
+        // Records the desired value and marks the slot dirty when it differs from
+        // the mirrored state. Returns false for unchanged values or unbound IDs.
+        bool stage_numeric_value(ObjectID id, u32 value) {
+            auto slot = dense_.slot_of(id);
+            if (slot == INVALID_SLOT || !dense_.set_numeric(slot, value))
+                return false;
+            dense_.mark_dirty(slot, DirtyKind::Numeric);
+            return true;
+        }
+        bool stage_string_value(ObjectID id, const dp::String &value) {
+            auto slot = dense_.slot_of(id);
+            if (slot == INVALID_SLOT || !dense_.set_string(slot, value))
+                return false;
+            dense_.mark_dirty(slot, DirtyKind::String);
+            return true;
+        }
+        bool stage_visibility(ObjectID id, bool visible) {
+            auto slot = dense_.slot_of(id);
+            if (slot == INVALID_SLOT || !dense_.set_visible(slot, visible))
+                return false;
+            dense_.mark_dirty(slot, DirtyKind::Visibility);
+            return true;
+        }
+        bool stage_enable_state(ObjectID id, bool enabled) {
+            auto slot = dense_.slot_of(id);
+            if (slot == INVALID_SLOT || !dense_.set_enabled(slot, enabled))
+                return false;
+            dense_.mark_dirty(slot, DirtyKind::Enable);
+            return true;
+        }
 
         void reset() {
             active_data_mask_ = 0xFFFF;
@@ -237,6 +329,7 @@ namespace agrobus::isobus::vt {
             string_values_.clear();
             visibility_.clear();
             enable_state_.clear();
+            dense_.reset_values();
             soft_key_mask_assignments_.clear();
             active_alarms_.clear();
             alarm_priorities_.clear();
@@ -316,7 +409,7 @@ namespace agrobus::isobus::vt {
             ObjectID id = static_cast<u16>(msg.data[1]) | (static_cast<u16>(msg.data[2]) << 8);
             u32 value = static_cast<u32>(msg.data[4]) | (static_cast<u32>(msg.data[5]) << 8) |
                         (static_cast<u32>(msg.data[6]) << 16) | (static_cast<u32>(msg.data[7]) << 24);
-            numeric_values_[id] = value;
+            set_numeric_value(id, value);
             on_numeric_value_changed.emit(id, value);
             echo::category("isobus.vt.tracker").trace("numeric: id=", id, " val=", value);
         }
@@ -330,7 +423,7 @@ namespace agrobus::isobus::vt {
             for (u16 i = 0; i < len && static_cast<usize>(5 + i) < msg.data.size(); ++i) {
                 str += static_cast<char>(msg.data[5 + i]);
             }
-            string_values_[id] = str;
+            set_string_value(id, str);
             on_string_value_changed.emit(id, str);
             echo::category("isobus.vt.tracker").trace("string: id=", id, " val=", str);
         }
@@ -340,7 +433,7 @@ namespace agrobus::isobus::vt {
                 return;
             ObjectID id = static_cast<u16>(msg.data[1]) | (static_cast<u16>(msg.data[2]) << 8);
             bool visible = (msg.data[3] != 0);
-            visibility_[id] = visible;
+            set_visibility(id, visible);
             on_visibility_changed.emit(id, visible);
             echo::category("isobus.vt.tracker").trace("visibility: id=", id, " vis=", visible);
         }
@@ -350,7 +443,7 @@ namespace agrobus::isobus::vt {
                 return;
             ObjectID id = static_cast<u16>(msg.data[1]) | (static_cast<u16>(msg.data[2]) << 8);
             bool enabled = (msg.data[3] != 0);
-            enable_state_[id] = enabled;
+            set_enable_state(id, enabled);
             on_enable_state_changed.emit(id, enabled);
             echo::category("isobus.vt.tracker").trace("enable: id=", id, " en=", enabled);
         }
@@ -367,6 +460,18 @@ namespace agrobus::isobus::vt {
             }
         }
 
+        template <typename V, typename Fn> void migrate_to_dense(dp::Map<ObjectID, V> &sparse, Fn &&store) {
+            for (auto it = sparse.begin(); it != sparse.end();) {
+                auto slot = dense_.slot_of(it->first);
+                if (slot != INVALID_SLOT) {
+                    store(slot, it->second);
+                    it = sparse.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
         void sort_alarm_stack() {
             // Sort alarms by priority (highest first), then by timestamp (oldest first)
             std::sort(active_alarms_.begin(), active_alarms_.end());
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "client.hpp"
+#include "command_queue.hpp"
 #include "objects.hpp"
 #include "state_tracker.hpp"
 #include <agrobus/net/error.hpp>
@@ -19,6 +20,12 @@ namespace agrobus::isobus::vt {
     // - Skips sends when the value hasn't changed (reduces bus traffic)
     // - Validates object IDs against the pool before sending
     // - Provides batched update support via begin_batch/end_batch
+    // - Staged updates via stage_*/flush, drained from the tracker's dirty bitset
+    //   (requires tracker.bind_pool)
+    // - Optional VTCommandQueue (with_queue): end_batch/flush enqueue instead of
+    //   sending, so the queue coalesces and paces them; the tracker takes a
+    //   queued value once the VT acknowledges it, and staged values are held
+    //   by the helper until then
     // - Type-safe numeric value helpers (scaled, clamped)
     //
     // Usage:
@@ -26,10 +33,15 @@ namespace agrobus::isobus::vt {
     //   helper.set_numeric_value(gauge_id, 42);        // only sends if changed
     //   helper.set_string_value(label_id, "Hello");    // only sends if changed
     //   helper.show(icon_id);                          // only sends if hidden
+    //
+    //   helper.stage_numeric_value(gauge_id, 43);      // record only
+    //   helper.flush();                                // send everything changed
     class VTClientUpdateHelper {
         VTClient &client_;
         VTClientStateTracker &tracker_;
         const ObjectPool *pool_;
+        VTCommandQueue *queue_ = nullptr;
+        ListenerToken ack_token_ = INVALID_TOKEN;
         bool batch_mode_ = false;
 
         struct PendingUpdate {
@@ -42,17 +54,42 @@ namespace agrobus::isobus::vt {
             ObjectID mask_id = 0;
         };
         dp::Vector<PendingUpdate> pending_;
+        // Staged values while a queue is attached; key: id << 8 | type
+        dp::Map<u32, PendingUpdate> staged_;
 
       public:
         VTClientUpdateHelper(VTClient &client, VTClientStateTracker &tracker, const ObjectPool *pool = nullptr)
             : client_(client), tracker_(tracker), pool_(pool) {}
 
+        ~VTClientUpdateHelper() {
+            if (queue_ && ack_token_ != INVALID_TOKEN)
+                queue_->on_acknowledged.unsubscribe(ack_token_);
+        }
+
+        VTClientUpdateHelper(const VTClientUpdateHelper &) = delete;
+        VTClientUpdateHelper &operator=(const VTClientUpdateHelper &) = delete;
+
         // ─── Configuration ────────────────────────────────────────────────────────
         VTClientUpdateHelper &with_pool(const ObjectPool *pool) {
             pool_ = pool;
             return *this;
         }
 
+        // Values staged for the previous queue but not yet flushed are moved back
+        // into the tracker's dirty set
+        VTClientUpdateHelper &with_queue(VTCommandQueue *queue) {
+            if (queue_ && ack_token_ != INVALID_TOKEN)
+                queue_->on_acknowledged.unsubscribe(ack_token_);
+            ack_token_ = INVALID_TOKEN;
+            if (queue != queue_)
+                restage();
+            queue_ = queue;
+            if (queue_)
+                ack_token_ =
+                    queue_->on_acknowledged.subscribe([this](const VTQueuedCommand &cmd) { acknowledged(cmd); });
+            return *this;
+        }
+
         // ─── Numeric value updates ───────────────────────────────────────────────
         Result<void> set_numeric_value(ObjectID id, u32 value) {
             auto current = tracker_.numeric_value(id);
@@ -90,8 +127,7 @@ namespace agrobus::isobus::vt {
 
         // ─── String value updates ────────────────────────────────────────────────
         Result<void> set_string_value(ObjectID id, dp::String value) {
-            auto current = tracker_.string_value(id);
-            if (current && *current == value) {
+            if (tracker_.string_value_equals(id, value)) {
                 echo::category("isobus.vt.helper").trace("skip string: id=", id, " unchanged");
                 return {};
             }
@@ -189,6 +225,10 @@ namespace agrobus::isobus::vt {
 
         Result<void> end_batch() {
             batch_mode_ = false;
+            if (queue_) {
+                enqueue_pending();
+                return {};
+            }
             Result<void> last_error;
 
             for (auto &update : pending_) {
@@ -236,8 +276,212 @@ namespace agrobus::isobus::vt {
             pending_.clear();
         }
 
+        // ─── Staged updates ──────────────────────────────────────────────────────
+        // Without a queue, stage calls only touch the tracker's dense store;
+        // flush() drains its dirty bitset and sends one command per changed
+        // (object, attribute). With a queue, staged values are kept apart from
+        // the tracker so it only ever holds what the VT acknowledged. Objects
+        // outside the bound pool are sent immediately instead.
+        Result<void> stage_numeric_value(ObjectID id, u32 value) {
+            if (!tracker_.dense().contains(id))
+                return set_numeric_value(id, value);
+            if (queue_) {
+                auto acked = tracker_.numeric_value(id);
+                stage_for_queue({PendingUpdate::Type::Numeric, id, value, {}, false, 0}, VTCommandKind::Numeric,
+                                acked && *acked == value);
+                return {};
+            }
+            tracker_.stage_numeric_value(id, value);
+            return {};
+        }
+
+        Result<void> stage_string_value(ObjectID id, const dp::String &value) {
+            if (!tracker_.dense().contains(id))
+                return set_string_value(id, value);
+            if (queue_) {
+                stage_for_queue({PendingUpdate::Type::String, id, 0, value, false, 0}, VTCommandKind::String,
+                                tracker_.string_value_equals(id, value));
+                return {};
+            }
+            tracker_.stage_string_value(id, value);
+            return {};
+        }
+
+        Result<void> stage_visibility(ObjectID id, bool visible) {
+            if (!tracker_.dense().contains(id))
+                return set_visibility(id, visible);
+            if (queue_) {
+                auto acked = tracker_.is_visible(id);
+                stage_for_queue({PendingUpdate::Type::Visibility, id, 0, {}, visible, 0}, VTCommandKind::Visibility,
+                                acked && *acked == visible);
+                return {};
+            }
+            tracker_.stage_visibility(id, visible);
+            return {};
+        }
+
+        Result<void> stage_enable(ObjectID id, bool enabled) {
+            if (!tracker_.dense().contains(id))
+                return set_enable(id, enabled);
+            if (queue_) {
+                auto acked = tracker_.is_enabled(id);
+                stage_for_queue({PendingUpdate::Type::Enable, id, 0, {}, enabled, 0}, VTCommandKind::Enable,
+                                acked && *acked == enabled);
+                return {};
+            }
+            tracker_.stage_enable_state(id, enabled);
+            return {};
+        }
+
+        // Sends all staged changes. Entries whose send fails stay dirty and are
+        // retried by the next flush.
+        Result<void> flush() {
+            auto &dense = tracker_.dense();
+            if (queue_) {
+                for (auto &[key, update] : staged_)
+                    enqueue(update);
+                staged_.clear();
+                // Slots staged before the queue was attached
+                dense.drain_dirty([&](ObjectID id, Slot slot, DirtyKind kind) {
+                    switch (kind) {
+                    case DirtyKind::Numeric:
+                        queue_->change_numeric_value(id, *dense.numeric(slot));
+                        break;
+                    case DirtyKind::String:
+                        queue_->change_string_value(id, *dense.string(slot));
+                        break;
+                    case DirtyKind::Visibility:
+                        queue_->hide_show(id, *dense.visible(slot));
+                        break;
+                    case DirtyKind::Enable:
+                        queue_->enable_disable(id, *dense.enabled(slot));
+                        break;
+                    }
+                });
+                return {};
+            }
+
+            Result<void> last_error;
+            usize sent = 0;
+
+            // Staged slots always hold a known value, so the optionals are engaged
+            dense.drain_dirty([&](ObjectID id, Slot slot, DirtyKind kind) {
+                Result<void> result;
+                switch (kind) {
+                case DirtyKind::Numeric:
+                    result = client_.change_numeric_value(id, *dense.numeric(slot));
+                    break;
+                case DirtyKind::String:
+                    result = client_.change_string_value(id, *dense.string(slot));
+                    break;
+                case DirtyKind::Visibility:
+                    result = client_.hide_show(id, *dense.visible(slot));
+                    break;
+                case DirtyKind::Enable:
+                    result = client_.enable_disable(id, *dense.enabled(slot));
+                    break;
+                }
+                if (result.is_ok()) {
+                    ++sent;
+                } else {
+                    dense.mark_dirty(slot, kind);
+                    last_error = result;
+                }
+            });
+
+            echo::category("isobus.vt.helper").trace("flush: sent=", sent, " remaining=", dense.dirty_count());
+            if (last_error.is_err())
+                return last_error;
+            return {};
+        }
+
+        usize staged_count() const noexcept { return tracker_.dense().dirty_count() + staged_.size(); }
+
         usize pending_count() const noexcept { return pending_.size(); }
         bool is_batching() const noexcept { return batch_mode_; }
+
+      private:
+        // Hands the batch to the command queue. The tracker is left alone until
+        // the VT acknowledges each command, so a value that never arrives is
+        // not mistaken for the current one.
+        void enqueue_pending() {
+            for (auto &update : pending_)
+                enqueue(update);
+            pending_.clear();
+        }
+
+        void enqueue(PendingUpdate &update) {
+            switch (update.type) {
+            case PendingUpdate::Type::Numeric:
+                queue_->change_numeric_value(update.id, update.numeric_val);
+                break;
+            case PendingUpdate::Type::String:
+                queue_->change_string_value(update.id, std::move(update.string_val));
+                break;
+            case PendingUpdate::Type::Visibility:
+                queue_->hide_show(update.id, update.bool_val);
+                break;
+            case PendingUpdate::Type::Enable:
+                queue_->enable_disable(update.id, update.bool_val);
+                break;
+            case PendingUpdate::Type::ActiveMask:
+                queue_->change_active_mask(update.id, update.mask_id);
+                break;
+            }
+        }
+
+        // A value equal to the acknowledged one is dropped, unless a different
+        // value for the same attribute is still in the queue and must be undone
+        void stage_for_queue(PendingUpdate update, VTCommandKind kind, bool acknowledged_value) {
+            u32 key = (static_cast<u32>(update.id) << 8) | static_cast<u32>(update.type);
+            if (acknowledged_value && !queue_->is_queued(kind, update.id)) {
+                staged_.erase(key);
+                return;
+            }
+            staged_[key] = std::move(update);
+        }
+
+        // Moves values staged for a detached queue into the tracker's dirty set
+        void restage() {
+            for (auto &[key, update] : staged_) {
+                switch (update.type) {
+                case PendingUpdate::Type::Numeric:
+                    tracker_.stage_numeric_value(update.id, update.numeric_val);
+                    break;
+                case PendingUpdate::Type::String:
+                    tracker_.stage_string_value(update.id, update.string_val);
+                    break;
+                case PendingUpdate::Type::Visibility:
+                    tracker_.stage_visibility(update.id, update.bool_val);
+                    break;
+                case PendingUpdate::Type::Enable:
+                    tracker_.stage_enable_state(update.id, update.bool_val);
+                    break;
+                case PendingUpdate::Type::ActiveMask:
+                    break;
+                }
+            }
+            staged_.clear();
+        }
+
+        void acknowledged(const VTQueuedCommand &cmd) {
+            switch (cmd.kind) {
+            case VTCommandKind::Numeric:
+                tracker_.set_numeric_value(cmd.id, cmd.value);
+                break;
+            case VTCommandKind::String:
+                tracker_.set_string_value(cmd.id, cmd.text);
+                break;
+            case VTCommandKind::Visibility:
+                tracker_.set_visibility(cmd.id, cmd.value != 0);
+                break;
+            case VTCommandKind::Enable:
+                tracker_.set_enable_state(cmd.id, cmd.value != 0);
+                break;
+            default:
+                break; // masks are tracked from the VT's own messages
+            }
+        }
     };
 
 } // namespace agrobus::isobus::vt
@@ -1,12 +1,14 @@
 #pragma once
 
 #include "acknowledgment.hpp"
+#include "signal_history.hpp"
 #include <agrobus/net/constants.hpp>
 #include <agrobus/net/error.hpp>
 #include <agrobus/net/event.hpp>
 #include <agrobus/net/message.hpp>
 #include <agrobus/net/network_manager.hpp>
 #include <agrobus/net/types.hpp>
+#include <algorithm>
 #include <datapod/datapod.hpp>
 #include <echo/echo.hpp>
 
@@ -115,8 +117,9 @@ namespace agrobus::j1939 {
     struct DiagnosticConfig {
         u32 dm1_interval_ms = 1000;
         bool auto_send = false;
-        u8 max_freeze_frames_per_dtc = 3;       // Max freeze frames to store per DTC
+        u8 max_freeze_frames_per_dtc = 3;       // Max freeze frames to store per DTC, pre-trigger frames included
         bool auto_capture_freeze_frames = true; // Auto-capture on DTC activation
+        u16 max_previous_dtcs = 64;             // DM2 history entries kept, oldest dropped first
 
         DiagnosticConfig &interval(u32 ms) {
             dm1_interval_ms = ms;
@@ -134,6 +137,10 @@ namespace agrobus::j1939 {
             auto_capture_freeze_frames = enable;
             return *this;
         }
+        DiagnosticConfig &history_depth(u16 entries) {
+            max_previous_dtcs = entries;
+            return *this;
+        }
     };
 
     // ─── DM13 suspend/resume signals ─────────────────────────────────────────────
@@ -732,6 +739,52 @@ namespace agrobus::j1939 {
         }
     };
 
+    // ─── Persistent DTC state ────────────────────────────────────────────────────
+    // Everything DiagnosticProtocol has to keep across a key cycle
+    struct DTCState {
+        dp::Vector<DTC> active;
+        dp::Vector<DTC> previous;                                   // DM2, oldest first
+        dp::Vector<PreviouslyActiveDTC> history;                    // occurrence tracking
+        dp::Map<u32, dp::Vector<FreezeFrame>> freeze_frames;        // Key: (SPN << 8) | FMI
+    };
+
+    // Depth limits a store applies when it rebuilds a DTCState, taken from the
+    // protocol's DiagnosticConfig so replay trims exactly as the protocol did
+    struct DTCLimits {
+        u8 max_frames_per_dtc = 3;
+        u16 max_previous = 64; // DM2 and occurrence history entries (0 = unbounded)
+    };
+
+    // One change to the persistent state; a store replays them in order
+    enum class DTCChange : u8 {
+        Active = 1,          // DTC active, or its occurrence count changed
+        Inactive = 2,        // DTC no longer active
+        Previous = 3,        // DTC added to (or refreshed in) the DM2 list
+        PreviousErased = 4,  // DTC removed from the DM2 list
+        PreviousCleared = 5, // DM2 list emptied
+        History = 6,         // previously active DTC with its occurrence count
+        HistoryCleared = 7,  // occurrence tracking emptied
+        FreezeFrame = 8,     // freeze frame captured
+        FramesErased = 9,    // freeze frames of one DTC removed
+        FramesCleared = 10,  // all freeze frames removed
+    };
+
+    // ─── DTC store ───────────────────────────────────────────────────────────────
+    // Non-volatile home of a DiagnosticProtocol's DTCs. load() is called once on
+    // attach with the protocol's depth limits; every later change is passed to record() as it happens, and the
+    // store may ask for the full state to rewrite itself compactly.
+    class DTCStore {
+      public:
+        virtual ~DTCStore() = default;
+
+        virtual Result<DTCState> load(const DTCLimits &limits) = 0;
+        virtual void record(DTCChange change, const DTC &dtc, u8 count = 0) = 0;
+        virtual void record(const FreezeFrame &frame) = 0;
+
+        virtual bool wants_compaction() const { return false; }
+        virtual void compact(const DTCState &) {}
+    };
+
     // ─── Diagnostic Protocol (DM1/DM2/DM3/DM11/DM13/DM22/DM25) ──────────────────
     class DiagnosticProtocol {
         IsoNet &net_;
@@ -758,6 +811,13 @@ namespace agrobus::j1939 {
         dp::Map<u32, dp::Vector<FreezeFrame>> freeze_frames_; // Key: (SPN << 8) | FMI
         u8 max_freeze_frames_per_dtc_ = 3;
         bool auto_capture_freeze_frames_ = true;
+        u16 max_previous_dtcs_ = 64;
+
+        // Persistence (null = RAM only)
+        DTCStore *store_ = nullptr;
+
+        // Signal source for automatic freeze frames (null = empty snapshots)
+        const SignalHistory *signals_ = nullptr;
 
         // Monitor performance ratios (DM20)
         DM20Response dm20_data_;
@@ -772,7 +832,8 @@ namespace agrobus::j1939 {
         DiagnosticProtocol(IsoNet &net, InternalCF *cf, DiagnosticConfig config = {})
             : net_(net), cf_(cf), dm1_interval_ms_(config.dm1_interval_ms), auto_send_(config.auto_send),
               max_freeze_frames_per_dtc_(config.max_freeze_frames_per_dtc),
-              auto_capture_freeze_frames_(config.auto_capture_freeze_frames) {}
+              auto_capture_freeze_frames_(config.auto_capture_freeze_frames),
+              max_previous_dtcs_(config.max_previous_dtcs) {}
 
         Result<void> initialize() {
             if (!cf_) {
@@ -824,9 +885,42 @@ namespace agrobus::j1939 {
 
         void clear_previously_active_dtcs() {
             previously_active_dtcs_.clear();
+            persist(DTCChange::HistoryCleared);
             echo::category("isobus.diagnostic").info("previously active DTCs cleared");
         }
 
+        // ─── Persistence ─────────────────────────────────────────────────────────
+        // Replaces the in-memory DTCs with the store's and records every later
+        // change there, so DM2 history, occurrence counts and freeze frames
+        // survive a key cycle
+        Result<void> attach_store(DTCStore &store) {
+            auto loaded = store.load(limits());
+            if (!loaded.is_ok())
+                return Result<void>::err(loaded.error());
+            auto &state = loaded.value();
+            active_dtcs_ = std::move(state.active);
+            previous_dtcs_ = std::move(state.previous);
+            previously_active_dtcs_ = std::move(state.history);
+            freeze_frames_ = std::move(state.freeze_frames);
+            store_ = &store;
+            echo::category("isobus.diagnostic")
+                .info("DTC store attached: ", active_dtcs_.size(), " active, ", previous_dtcs_.size(), " previous");
+            return {};
+        }
+
+        void detach_store() noexcept { store_ = nullptr; }
+
+        DTCLimits limits() const noexcept { return {max_freeze_frames_per_dtc_, max_previous_dtcs_}; }
+
+        DTCState state() const {
+            DTCState s;
+            s.active = active_dtcs_;
+            s.previous = previous_dtcs_;
+            s.history = previously_active_dtcs_;
+            s.freeze_frames = freeze_frames_;
+            return s;
+        }
+
         // ─── DTC management ──────────────────────────────────────────────────────
         Result<void> set_active(DTC dtc) {
             bool is_new_dtc = true;
@@ -834,6 +928,7 @@ namespace agrobus::j1939 {
                 if (existing == dtc) {
                     existing.occurrence_count = (existing.occurrence_count < 126) ? existing.occurrence_count + 1 : 126;
                     is_new_dtc = false;
+                    persist(DTCChange::Active, existing);
                     break;
                 }
             }
@@ -841,11 +936,12 @@ namespace agrobus::j1939 {
             if (is_new_dtc) {
                 dtc.occurrence_count = 1;
                 active_dtcs_.push_back(dtc);
+                persist(DTCChange::Active, dtc);
                 echo::category("isobus.diagnostic").info("DTC set active: spn=", dtc.spn);
 
                 // Auto-capture freeze frame on new DTC activation
                 if (auto_capture_freeze_frames_) {
-                    auto result = capture_freeze_frame(dtc, dp::Vector<SPNSnapshot>());
+                    auto result = capture_freeze_frame(dtc);
                     if (result.is_ok()) {
                         echo::category("isobus.diagnostic").debug("Freeze frame captured for DTC spn=", dtc.spn);
                     }
@@ -857,10 +953,12 @@ namespace agrobus::j1939 {
         Result<void> clear_active(u32 spn, FMI fmi) {
             for (auto it = active_dtcs_.begin(); it != active_dtcs_.end(); ++it) {
                 if (it->spn == spn && it->fmi == fmi) {
-                    previous_dtcs_.push_back(*it);
-                    // Track in previously_active_dtcs_ with occurrence count
-                    track_previously_active(*it);
+                    DTC dtc = *it;
                     active_dtcs_.erase(it);
+                    persist(DTCChange::Inactive, dtc);
+                    add_previous(dtc);
+                    // Track in previously_active_dtcs_ with occurrence count
+                    track_previously_active(dtc);
                     echo::category("isobus.diagnostic").info("DTC cleared: spn=", spn);
                     return {};
                 }
@@ -869,17 +967,22 @@ namespace agrobus::j1939 {
         }
 
         Result<void> clear_all_active() {
-            for (auto &dtc : active_dtcs_) {
-                previous_dtcs_.push_back(dtc);
+            // Empty the active list first: a compaction triggered mid-batch must
+            // not snapshot DTCs that are already recorded as inactive
+            auto cleared = std::move(active_dtcs_);
+            active_dtcs_.clear();
+            for (const auto &dtc : cleared) {
+                persist(DTCChange::Inactive, dtc);
+                add_previous(dtc);
                 track_previously_active(dtc);
             }
-            active_dtcs_.clear();
             echo::category("isobus.diagnostic").info("all active DTCs cleared");
             return {};
         }
 
         Result<void> clear_previous() {
             previous_dtcs_.clear();
+            persist(DTCChange::PreviousCleared);
             echo::category("isobus.diagnostic").info("previous DTCs cleared");
             return {};
         }
@@ -1110,27 +1213,45 @@ namespace agrobus::j1939 {
         // ─── Freeze Frame Management (DM25) ──────────────────────────────────────
         Result<void> capture_freeze_frame(const DTC &dtc, const dp::Vector<SPNSnapshot> &snapshots,
                                           u32 timestamp_ms = 0) {
-            u32 key = make_freeze_frame_key(dtc.spn, dtc.fmi);
-
             FreezeFrame ff;
             ff.dtc = dtc;
             ff.timestamp_ms = timestamp_ms;
             ff.snapshots = snapshots;
+            store_freeze_frame(std::move(ff));
+            return {};
+        }
 
-            // Add to storage
-            auto &frames = freeze_frames_[key];
-            frames.push_back(ff);
-
-            // Limit depth per DTC
-            if (frames.size() > max_freeze_frames_per_dtc_) {
-                frames.erase(frames.begin()); // Remove oldest
+        // Samples the attached signal history: with pre-trigger frames configured,
+        // stores them oldest first so DM25 frame 0 is the trigger and frame N is
+        // N steps before it. Without a history, stores one empty frame.
+        Result<void> capture_freeze_frame(const DTC &dtc) {
+            if (!signals_)
+                return capture_freeze_frame(dtc, dp::Vector<SPNSnapshot>());
+
+            const auto &cfg = signals_->config();
+            // Trigger plus pre-trigger frames must fit the u8 frame count
+            u8 pre = std::min<u8>(cfg.pre_trigger_frames, 254);
+            u8 frames = static_cast<u8>(pre + 1);
+            u32 step_ms = pre ? cfg.pre_trigger_ms / pre : 0;
+            dp::Vector<FreezeFrame> captured(frames);
+            u32 now = signals_->now_ms();
+            for (u8 i = 0; i < frames; ++i) {
+                u32 back = static_cast<u32>(frames - 1 - i) * step_ms;
+                captured[i].dtc = dtc;
+                captured[i].timestamp_ms = now >= back ? now - back : 0;
+                captured[i].snapshots.reserve(signals_->signal_count());
             }
-
-            echo::category("isobus.diagnostic")
-                .debug("Freeze frame captured: spn=", dtc.spn, " frames=", frames.size());
+            signals_->capture(frames, step_ms, [&](u8 frame, u32, u32 spn, u32 value) {
+                captured[frame].snapshots.push_back(SPNSnapshot{spn, value});
+            });
+            for (auto &ff : captured)
+                store_freeze_frame(std::move(ff));
             return {};
         }
 
+        // Freeze frames sample this history from now on; it must outlive the protocol
+        void attach_signal_history(const SignalHistory &history) noexcept { signals_ = &history; }
+
         dp::Optional<FreezeFrame> get_freeze_frame(u32 spn, FMI fmi, u8 frame_number = 0) const {
             u32 key = make_freeze_frame_key(spn, fmi);
             auto it = freeze_frames_.find(key);
@@ -1151,11 +1272,13 @@ namespace agrobus::j1939 {
         void clear_freeze_frames(u32 spn, FMI fmi) {
             u32 key = make_freeze_frame_key(spn, fmi);
             freeze_frames_.erase(key);
+            persist(DTCChange::FramesErased, DTC{spn, fmi, 0});
             echo::category("isobus.diagnostic").debug("Freeze frames cleared: spn=", spn);
         }
 
         void clear_all_freeze_frames() {
             freeze_frames_.clear();
+            persist(DTCChange::FramesCleared);
             echo::category("isobus.diagnostic").info("All freeze frames cleared");
         }
 
@@ -1188,17 +1311,68 @@ namespace agrobus::j1939 {
         Event<const DM25Request &, Address> on_dm25_request;   // Freeze frame request
 
       private:
+        void store_freeze_frame(FreezeFrame &&ff) {
+            auto &frames = freeze_frames_[make_freeze_frame_key(ff.dtc.spn, ff.dtc.fmi)];
+            frames.push_back(std::move(ff));
+
+            // Limit depth per DTC
+            if (frames.size() > max_freeze_frames_per_dtc_) {
+                frames.erase(frames.begin()); // Remove oldest
+            }
+            if (frames.empty())
+                return;
+            persist(frames.back());
+
+            echo::category("isobus.diagnostic")
+                .debug("Freeze frame captured: spn=", frames.back().dtc.spn, " frames=", frames.size());
+        }
+
+        void persist(DTCChange change, const DTC &dtc = {}, u8 count = 0) {
+            if (!store_)
+                return;
+            store_->record(change, dtc, count);
+            if (store_->wants_compaction())
+                store_->compact(state());
+        }
+
+        void persist(const FreezeFrame &ff) {
+            if (!store_)
+                return;
+            store_->record(ff);
+            if (store_->wants_compaction())
+                store_->compact(state());
+        }
+
         void track_previously_active(const DTC &dtc) {
             for (auto &pa : previously_active_dtcs_) {
                 if (pa.dtc == dtc) {
                     pa.occurrence_count = (pa.occurrence_count < 126) ? pa.occurrence_count + 1 : 126;
+                    persist(DTCChange::History, pa.dtc, pa.occurrence_count);
                     return;
                 }
             }
+            if (max_previous_dtcs_ > 0 && previously_active_dtcs_.size() >= max_previous_dtcs_)
+                previously_active_dtcs_.erase(previously_active_dtcs_.begin());
             PreviouslyActiveDTC pa;
             pa.dtc = dtc;
             pa.occurrence_count = dtc.occurrence_count > 0 ? dtc.occurrence_count : 1;
             previously_active_dtcs_.push_back(pa);
+            persist(DTCChange::History, pa.dtc, pa.occurrence_count);
+        }
+
+        // One DM2 entry per DTC: a DTC that goes inactive again moves to the end
+        // with its latest occurrence count, and the oldest entry makes room
+        void add_previous(const DTC &dtc) {
+            for (auto it = previous_dtcs_.begin(); it != previous_dtcs_.end(); ++it) {
+                if (*it == dtc) {
+                    previous_dtcs_.erase(it);
+                    break;
+                }
+            }
+            if (max_previous_dtcs_ > 0 && previous_dtcs_.size() >= max_previous_dtcs_)
+                previous_dtcs_.erase(previous_dtcs_.begin());
+            previous_dtcs_.push_back(dtc);
+            persist(DTCChange::Previous, dtc);
         }
 
         dp::Vector<u8> encode_dtc_message(const dp::Vector<DTC> &dtcs) const {
@@ -1251,6 +1425,8 @@ namespace agrobus::j1939 {
             // Clear previously active DTCs
             previously_active_dtcs_.clear();
             previous_dtcs_.clear();
+            persist(DTCChange::HistoryCleared);
+            persist(DTCChange::PreviousCleared);
             echo::category("isobus.diagnostic").info("DM3: previously active DTCs cleared by ", msg.source);
 
             if (is_destination_specific) {
@@ -1333,6 +1509,7 @@ namespace agrobus::j1939 {
                 for (auto it = previous_dtcs_.begin(); it != previous_dtcs_.end(); ++it) {
                     if (it->spn == spn && it->fmi == fmi) {
                         previous_dtcs_.erase(it);
+                        persist(DTCChange::PreviousErased, DTC{spn, fmi, 0});
                         found = true;
                         break;
                     }
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "diagnostic.hpp"
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/event.hpp>
+#include <agrobus/net/message.hpp>
+#include <agrobus/net/network_manager.hpp>
+#include <agrobus/net/types.hpp>
+#include <algorithm>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+
+namespace agrobus::j1939 {
+    using namespace agrobus::net;
+
+    // ═════════════════════════════════════════════════════════════════════════════
+    // Network-wide DM1 aggregator
+    // ═════════════════════════════════════════════════════════════════════════════
+    // Every ECU rebroadcasts its DM1 once a second whether or not anything
+    // changed. The aggregator keeps one DTC table per source, hashes each raw
+    // DM1 payload and only decodes the ones that differ from the last one seen,
+    // then reports the difference as add/remove/occurrence-change events.
+
+    // Severity of a DTC, from the lamps its source reports alongside it
+    enum class DTCSeverity : u8 { Stop = 0, Malfunction = 1, Warning = 2, Protect = 3, Info = 4 };
+    inline constexpr usize DTC_SEVERITY_COUNT = 5;
+
+    inline DTCSeverity severity_of(const DiagnosticLamps &lamps) noexcept {
+        if (lamps.red_stop == LampStatus::On)
+            return DTCSeverity::Stop;
+        if (lamps.malfunction == LampStatus::On)
+            return DTCSeverity::Malfunction;
+        if (lamps.amber_warning == LampStatus::On)
+            return DTCSeverity::Warning;
+        if (lamps.engine_protect == LampStatus::On)
+            return DTCSeverity::Protect;
+        return DTCSeverity::Info;
+    }
+
+    struct FleetDTC {
+        Address source = NULL_ADDRESS;
+        DTC dtc;
+        DTCSeverity severity = DTCSeverity::Info;
+    };
+
+    // ─── Configuration ───────────────────────────────────────────────────────────
+    struct DM1AggregatorConfig {
+        u32 source_timeout_ms = 3000; // a source silent this long has its DTCs removed (0 = never)
+
+        DM1AggregatorConfig &timeout(u32 ms) {
+            source_timeout_ms = ms;
+            return *this;
+        }
+    };
+
+    struct DM1AggregatorStats {
+        u64 messages = 0;  // DM1s received
+        u64 unchanged = 0; // skipped on a hash match, not decoded
+        u64 decoded = 0;
+        u64 added = 0;
+        u64 removed = 0;
+        u64 occurrence_changes = 0;
+        u64 timeouts = 0;
+    };
+
+    // ─── DM1 aggregator ──────────────────────────────────────────────────────────
+    class DM1Aggregator {
+        struct Source {
+            u64 hash = 0;
+            usize size = 0;
+            u16 lamp_bits = 0;
+            DiagnosticLamps lamps;
+            DTCSeverity severity = DTCSeverity::Info;
+            dp::Vector<DTC> dtcs; // sorted by key
+            u32 silent_ms = 0;
+        };
+
+        DM1AggregatorConfig config_;
+        DM1AggregatorStats stats_;
+        dp::Map<Address, Source> sources_;
+        dp::Vector<DTC> scratch_;
+
+        // Global view, rebuilt on demand after a change
+        mutable dp::Vector<FleetDTC> view_;
+        mutable dp::Array<usize, DTC_SEVERITY_COUNT + 1> view_bounds_{};
+        mutable bool view_dirty_ = true;
+
+      public:
+        explicit DM1Aggregator(DM1AggregatorConfig config = {}) : config_(config) {}
+
+        // Listens to every DM1 on the network; the aggregator must outlive it
+        Result<void> attach(IsoNet &net) {
+            return net.register_pgn_callback(PGN_DM1, [this](const Message &msg) {
+                ingest(msg.source, msg.data.data(), msg.data.size());
+            });
+        }
+
+        // Processes one DM1 payload (lamps, then 4-byte DTCs)
+        void ingest(Address source, const u8 *data, usize size) {
+            if (size < 6)
+                return;
+            ++stats_.messages;
+            auto it = sources_.find(source);
+            bool inserted = it == sources_.end();
+            Source &src = inserted ? sources_[source] : it->second;
+            src.silent_ms = 0;
+
+            u64 hash = fnv1a(data, size);
+            if (!inserted && hash == src.hash && size == src.size) {
+                ++stats_.unchanged;
+                return;
+            }
+            src.hash = hash;
+            src.size = size;
+            ++stats_.decoded;
+
+            u16 lamp_bits = static_cast<u16>(data[0] | (data[1] << 8));
+            bool lamps_changed = inserted || lamp_bits != src.lamp_bits;
+            src.lamp_bits = lamp_bits;
+            src.lamps = DiagnosticLamps::decode(data);
+            auto severity = severity_of(src.lamps);
+
+            scratch_.clear();
+            for (usize i = 2; i + 3 < size; i += 4) {
+                DTC dtc = DTC::decode(data + i);
+                if (is_placeholder(dtc))
+                    continue;
+                scratch_.push_back(dtc);
+            }
+            std::sort(scratch_.begin(), scratch_.end(), [](const DTC &a, const DTC &b) { return key(a) < key(b); });
+            // A DTC listed twice counts once
+            scratch_.erase(std::unique(scratch_.begin(), scratch_.end()), scratch_.end());
+
+            // A lamp change re-rates the DTCs the source keeps
+            if (severity != src.severity) {
+                src.severity = severity;
+                view_dirty_ = true;
+            }
+            diff(source, src, scratch_);
+            src.dtcs.swap(scratch_);
+            if (lamps_changed)
+                on_lamps_changed.emit(source, src.lamps);
+        }
+
+        // Drops sources that stopped broadcasting
+        void update(u32 elapsed_ms) {
+            if (config_.source_timeout_ms == 0)
+                return;
+            for (auto it = sources_.begin(); it != sources_.end();) {
+                it->second.silent_ms += elapsed_ms;
+                if (it->second.silent_ms < config_.source_timeout_ms) {
+                    ++it;
+                    continue;
+                }
+                ++stats_.timeouts;
+                echo::category("isobus.diagnostic.dm1").debug("DM1 source lost: ", it->first);
+                for (const auto &dtc : it->second.dtcs)
+                    removed(it->first, it->second, dtc);
+                Address lost = it->first;
+                it = sources_.erase(it);
+                view_dirty_ = true;
+                on_source_lost.emit(lost);
+            }
+        }
+
+        // ─── Views ───────────────────────────────────────────────────────────────
+        // Every active DTC on the network, most severe first, then by source and SPN
+        const dp::Vector<FleetDTC> &active_dtcs() const {
+            rebuild();
+            return view_;
+        }
+
+        // The active DTCs of one severity, as a slice of active_dtcs()
+        dp::Vector<FleetDTC> active_dtcs(DTCSeverity severity) const {
+            rebuild();
+            auto s = static_cast<usize>(severity);
+            return dp::Vector<FleetDTC>(view_.begin() + view_bounds_[s], view_.begin() + view_bounds_[s + 1]);
+        }
+
+        usize count(DTCSeverity severity) const {
+            rebuild();
+            auto s = static_cast<usize>(severity);
+            return view_bounds_[s + 1] - view_bounds_[s];
+        }
+
+        // Worst state of each lamp across all sources
+        DiagnosticLamps lamps() const {
+            DiagnosticLamps out;
+            auto worst = [](LampStatus a, LampStatus b) {
+                auto rank = [](LampStatus s) { return s == LampStatus::On ? 2 : s == LampStatus::Off ? 1 : 0; };
+                return rank(b) > rank(a) ? b : a;
+            };
+            out.malfunction = out.red_stop = out.amber_warning = out.engine_protect = LampStatus::NotAvailable;
+            for (const auto &[addr, src] : sources_) {
+                out.malfunction = worst(out.malfunction, src.lamps.malfunction);
+                out.red_stop = worst(out.red_stop, src.lamps.red_stop);
+                out.amber_warning = worst(out.amber_warning, src.lamps.amber_warning);
+                out.engine_protect = worst(out.engine_protect, src.lamps.engine_protect);
+            }
+            return out;
+        }
+
+        const dp::Vector<DTC> *source_dtcs(Address source) const {
+            auto it = sources_.find(source);
+            return it == sources_.end() ? nullptr : &it->second.dtcs;
+        }
+
+        usize source_count() const noexcept { return sources_.size(); }
+        const DM1AggregatorStats &stats() const noexcept { return stats_; }
+
+        // ─── Events ──────────────────────────────────────────────────────────────
+        Event<const FleetDTC &> on_dtc_added;
+        Event<const FleetDTC &> on_dtc_removed;
+        Event<const FleetDTC &, u8> on_occurrence_changed; // new DTC, previous count
+        Event<Address, const DiagnosticLamps &> on_lamps_changed;
+        Event<Address> on_source_lost;
+
+      private:
+        static u32 key(const DTC &dtc) noexcept { return (dtc.spn << 5) | static_cast<u8>(dtc.fmi); }
+
+        // 64-bit FNV-1a over the raw payload
+        static u64 fnv1a(const u8 *data, usize size) noexcept {
+            u64 h = 0xCBF29CE484222325ull;
+            for (usize i = 0; i < size; ++i)
+                h = (h ^ data[i]) * 0x100000001B3ull;
+            return h;
+        }
+
+        // "No DTC" (all zero) and TP padding (all ones)
+        static bool is_placeholder(const DTC &dtc) noexcept {
+            u8 fmi = static_cast<u8>(dtc.fmi);
+            return (dtc.spn == 0 && fmi == 0) || (dtc.spn == 0x7FFFF && fmi == 0x1F);
+        }
+
+        void diff(Address address, const Source &src, const dp::Vector<DTC> &now) {
+            const auto &before = src.dtcs;
+            usize i = 0, j = 0;
+            while (i < before.size() || j < now.size()) {
+                if (j == now.size() || (i < before.size() && key(before[i]) < key(now[j]))) {
+                    removed(address, src, before[i++]);
+                } else if (i == before.size() || key(now[j]) < key(before[i])) {
+                    ++stats_.added;
+                    view_dirty_ = true;
+                    on_dtc_added.emit(FleetDTC{address, now[j++], src.severity});
+                } else {
+                    if (before[i].occurrence_count != now[j].occurrence_count) {
+                        ++stats_.occurrence_changes;
+                        view_dirty_ = true;
+                        on_occurrence_changed.emit(FleetDTC{address, now[j], src.severity},
+                                                   before[i].occurrence_count);
+                    }
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+
+        void removed(Address address, const Source &src, const DTC &dtc) {
+            ++stats_.removed;
+            view_dirty_ = true;
+            on_dtc_removed.emit(FleetDTC{address, dtc, src.severity});
+        }
+
+        void rebuild() const {
+            if (!view_dirty_)
+                return;
+            view_.clear();
+            for (const auto &[addr, src] : sources_)
+                for (const auto &dtc : src.dtcs)
+                    view_.push_back(FleetDTC{addr, dtc, src.severity});
+            std::sort(view_.begin(), view_.end(), [](const FleetDTC &a, const FleetDTC &b) {
+                if (a.severity != b.severity)
+                    return a.severity < b.severity;
+                if (a.source != b.source)
+                    return a.source < b.source;
+                return key(a.dtc) < key(b.dtc);
+            });
+            usize pos = 0;
+            for (usize s = 0; s <= DTC_SEVERITY_COUNT; ++s) {
+                while (pos < view_.size() && static_cast<usize>(view_[pos].severity) < s)
+                    ++pos;
+                view_bounds_[s] = pos;
+            }
+            view_dirty_ = false;
+        }
+    };
+
+} // namespace agrobus::j1939
@@ -106,6 +106,8 @@ namespace agrobus::j1939 {
     // May use transport protocol if data exceeds 8 bytes.
 
     struct DM16Transfer {
+        static constexpr u8 LENGTH_FROM_TRANSPORT = 0xFF; // num_bytes when the block is longer than 254 bytes
+
         u8 num_bytes = 0;    // Number of data bytes in this message
         dp::Vector<u8> data; // Binary data (up to 7 bytes single-frame, more via TP)
 
@@ -118,13 +120,29 @@ namespace agrobus::j1939 {
             return encoded;
         }
 
+        // A whole block: single frame up to 7 bytes, TP up to 1784, ETP beyond
+        static dp::Vector<u8> encode_block(const u8 *bytes, usize count) {
+            dp::Vector<u8> encoded(std::max<usize>(count + 1, 8), 0xFF);
+            encoded[0] = count < LENGTH_FROM_TRANSPORT ? static_cast<u8>(count) : LENGTH_FROM_TRANSPORT;
+            std::copy(bytes, bytes + count, encoded.begin() + 1);
+            return encoded;
+        }
+
+        // Data bytes in a received DM16 payload
+        static usize block_length(const dp::Vector<u8> &raw) noexcept {
+            if (raw.empty())
+                return 0;
+            if (raw[0] == LENGTH_FROM_TRANSPORT && raw.size() > 8)
+                return raw.size() - 1;
+            return std::min<usize>(raw[0], raw.size() - 1);
+        }
+
         static DM16Transfer decode(const dp::Vector<u8> &raw) {
             DM16Transfer msg;
             if (!raw.empty()) {
                 msg.num_bytes = raw[0];
-                for (usize i = 1; i < raw.size() && i <= msg.num_bytes; ++i) {
-                    msg.data.push_back(raw[i]);
-                }
+                usize n = block_length(raw);
+                msg.data.assign(raw.begin() + 1, raw.begin() + 1 + n);
             }
             return msg;
         }
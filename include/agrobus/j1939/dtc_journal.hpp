@@ -0,0 +1,582 @@
+#pragma once
+
+#include "diagnostic.hpp"
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/types.hpp>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <datapod/datapod.hpp>
+#include <deque>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <filesystem>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace agrobus::j1939 {
+    using namespace agrobus::net;
+
+    // ═════════════════════════════════════════════════════════════════════════════
+    // Crash-safe DTC journal
+    // ═════════════════════════════════════════════════════════════════════════════
+    // DiagnosticProtocol changes are appended to non-volatile memory as small
+    // checksummed records. After a power loss the image is replayed up to the
+    // last intact record and a torn tail is cut off. When the journal has grown
+    // well past the live state it is rewritten as a snapshot of that state.
+    //
+    //   image  := "DTCJ" version record*
+    //   record := kind(1) length(2, LE) payload(length) crc32(4, LE over kind..payload)
+
+    // ─── Non-volatile memory backend ─────────────────────────────────────────────
+    class NvmBackend {
+      public:
+        virtual ~NvmBackend() = default;
+
+        virtual Result<dp::Vector<u8>> read() = 0;                    // whole image
+        virtual Result<void> append(const u8 *data, usize count) = 0; // at the end
+        virtual Result<void> truncate(usize size) = 0;                // drop a torn tail
+        virtual Result<void> replace(const dp::Vector<u8> &image) = 0; // atomic rewrite
+        virtual Result<void> sync() = 0;                               // make writes durable
+    };
+
+    // RAM image; for tests and targets that persist it by other means
+    class MemoryNvm : public NvmBackend {
+        dp::Vector<u8> image_;
+
+      public:
+        Result<dp::Vector<u8>> read() override { return Result<dp::Vector<u8>>::ok(image_); }
+        Result<void> append(const u8 *data, usize count) override {
+            image_.insert(image_.end(), data, data + count);
+            return {};
+        }
+        Result<void> truncate(usize size) override {
+            image_.resize(std::min(size, image_.size()));
+            return {};
+        }
+        Result<void> replace(const dp::Vector<u8> &image) override {
+            image_ = image;
+            return {};
+        }
+        Result<void> sync() override { return {}; }
+
+        dp::Vector<u8> &image() noexcept { return image_; }
+    };
+
+    // One file on a POSIX file system. Appends go through O_APPEND; a rewrite
+    // goes to "<file>.tmp", is synced, and renamed over the journal so a crash
+    // leaves either the old or the new image.
+    class FileNvm : public NvmBackend {
+        std::filesystem::path path_;
+        int fd_ = -1;
+
+        Result<void> reopen() {
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd_ < 0)
+                return Result<void>::err(Error::driver_error("cannot open DTC journal " + path_.string()));
+            return {};
+        }
+
+        static bool write_all(int fd, const u8 *data, usize count) {
+            usize done = 0;
+            while (done < count) {
+                ssize_t n = ::write(fd, data + done, count - done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                done += static_cast<usize>(n);
+            }
+            return true;
+        }
+
+      public:
+        explicit FileNvm(std::filesystem::path path) : path_(std::move(path)) {}
+        ~FileNvm() override {
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        FileNvm(const FileNvm &) = delete;
+        FileNvm &operator=(const FileNvm &) = delete;
+
+        const std::filesystem::path &path() const noexcept { return path_; }
+
+        Result<dp::Vector<u8>> read() override {
+            if (fd_ < 0) {
+                auto r = reopen();
+                if (!r.is_ok())
+                    return Result<dp::Vector<u8>>::err(r.error());
+            }
+            struct stat st {};
+            if (::fstat(fd_, &st) != 0)
+                return Result<dp::Vector<u8>>::err(Error::driver_error("fstat failed"));
+            dp::Vector<u8> image(static_cast<usize>(st.st_size));
+            usize done = 0;
+            while (done < image.size()) {
+                ssize_t n = ::pread(fd_, image.data() + done, image.size() - done, static_cast<off_t>(done));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                done += static_cast<usize>(n);
+            }
+            image.resize(done);
+            return Result<dp::Vector<u8>>::ok(std::move(image));
+        }
+
+        Result<void> append(const u8 *data, usize count) override {
+            if (fd_ < 0) {
+                auto r = reopen();
+                if (!r.is_ok())
+                    return r;
+            }
+            if (!write_all(fd_, data, count))
+                return Result<void>::err(Error::driver_error("DTC journal write failed"));
+            return {};
+        }
+
+        Result<void> truncate(usize size) override {
+            if (fd_ < 0 || ::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+                return Result<void>::err(Error::driver_error("DTC journal truncate failed"));
+            return {};
+        }
+
+        Result<void> replace(const dp::Vector<u8> &image) override {
+            auto tmp = path_;
+            tmp += ".tmp";
+            int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0)
+                return Result<void>::err(Error::driver_error("cannot create " + tmp.string()));
+            bool ok = write_all(fd, image.data(), image.size()) && ::fsync(fd) == 0;
+            ::close(fd);
+            if (!ok || ::rename(tmp.c_str(), path_.c_str()) != 0) {
+                ::unlink(tmp.c_str());
+                return Result<void>::err(Error::driver_error("DTC journal rewrite failed"));
+            }
+            // Make the rename itself durable
+            auto dir = path_.parent_path();
+            int dfd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (dfd >= 0) {
+                ::fsync(dfd);
+                ::close(dfd);
+            }
+            return reopen();
+        }
+
+        Result<void> sync() override {
+            if (fd_ >= 0 && ::fdatasync(fd_) != 0)
+                return Result<void>::err(Error::driver_error("DTC journal sync failed"));
+            return {};
+        }
+    };
+
+    namespace detail {
+        inline constexpr dp::Array<u32, 256> make_crc32_table() {
+            dp::Array<u32, 256> table{};
+            for (u32 i = 0; i < 256; ++i) {
+                u32 c = i;
+                for (u32 k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[i] = c;
+            }
+            return table;
+        }
+        inline constexpr auto CRC32_TABLE = make_crc32_table();
+
+        // IEEE 802.3 CRC-32
+        inline u32 crc32(const u8 *data, usize count) noexcept {
+            u32 c = 0xFFFFFFFFu;
+            for (usize i = 0; i < count; ++i)
+                c = CRC32_TABLE[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+            return c ^ 0xFFFFFFFFu;
+        }
+
+        // Insertion-ordered set keyed by DTC, so replay does not scan vectors
+        template <typename T> class OrderedDTCs {
+            dp::Map<u32, u64> seq_of_;
+            dp::Map<u64, T> items_;
+            u64 next_ = 0;
+
+          public:
+            // Update in place, or append when new
+            void upsert(u32 key, const T &item) {
+                auto it = seq_of_.find(key);
+                if (it != seq_of_.end()) {
+                    items_[it->second] = item;
+                    return;
+                }
+                seq_of_[key] = next_;
+                items_[next_++] = item;
+            }
+            // Append, moving an existing entry to the end
+            void move_back(u32 key, const T &item) {
+                erase(key);
+                upsert(key, item);
+            }
+            void erase(u32 key) {
+                auto it = seq_of_.find(key);
+                if (it == seq_of_.end())
+                    return;
+                items_.erase(it->second);
+                seq_of_.erase(it);
+            }
+            void clear() {
+                seq_of_.clear();
+                items_.clear();
+            }
+            // Drop the oldest entries beyond limit (0 = unbounded)
+            void bound(usize limit, u32 (*key_of)(const T &)) {
+                while (limit > 0 && items_.size() > limit) {
+                    seq_of_.erase(key_of(items_.begin()->second));
+                    items_.erase(items_.begin());
+                }
+            }
+            dp::Vector<T> values() const {
+                dp::Vector<T> out;
+                out.reserve(items_.size());
+                for (const auto &[seq, item] : items_)
+                    out.push_back(item);
+                return out;
+            }
+        };
+
+        inline u32 dtc_key(const DTC &dtc) noexcept { return (dtc.spn << 8) | static_cast<u8>(dtc.fmi); }
+    } // namespace detail
+
+    // ─── Journal configuration ───────────────────────────────────────────────────
+    struct DTCJournalConfig {
+        usize compact_bytes = 64 * 1024; // rewrite once the journal exceeds this and twice the last snapshot
+        bool write_behind = true;        // do NVM I/O on a writer thread
+        bool sync_writes = true;         // fdatasync after each batch of records
+
+        DTCJournalConfig &compact_at(usize bytes) {
+            compact_bytes = bytes;
+            return *this;
+        }
+        DTCJournalConfig &background(bool enable) {
+            write_behind = enable;
+            return *this;
+        }
+        DTCJournalConfig &durable(bool enable) {
+            sync_writes = enable;
+            return *this;
+        }
+    };
+
+    struct DTCJournalStats {
+        u64 records_replayed = 0;
+        u64 discarded_bytes = 0; // torn or corrupt tail cut off at load
+        u64 records_written = 0;
+        u64 compactions = 0;
+        u64 write_errors = 0;
+        usize journal_bytes = 0; // current image size, snapshot included
+    };
+
+    // ─── DTC journal ─────────────────────────────────────────────────────────────
+    class DTCJournal : public DTCStore {
+        static constexpr u8 VERSION = 1;
+        static constexpr usize HEADER_SIZE = 5;
+        static constexpr usize RECORD_OVERHEAD = 7; // kind, length, crc
+
+        struct Job {
+            bool replace = false;
+            dp::Vector<u8> data;
+        };
+
+        NvmBackend &nvm_;
+        DTCJournalConfig config_;
+        DTCLimits limits_; // from the attached protocol, used by replay
+        DTCJournalStats stats_;
+        usize snapshot_bytes_ = HEADER_SIZE;
+        dp::Vector<u8> record_buf_;
+
+        // Writer thread
+        std::mutex mutex_;
+        std::condition_variable work_cv_;
+        std::condition_variable idle_cv_;
+        std::deque<Job> queue_;
+        bool busy_ = false;
+        bool stop_ = false;
+        std::atomic<u64> write_errors_{0};
+        std::thread thread_;
+
+      public:
+        explicit DTCJournal(NvmBackend &nvm, DTCJournalConfig config = {}) : nvm_(nvm), config_(config) {}
+        ~DTCJournal() override {
+            flush();
+            if (!thread_.joinable())
+                return;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            work_cv_.notify_all();
+            thread_.join();
+        }
+
+        DTCJournal(const DTCJournal &) = delete;
+        DTCJournal &operator=(const DTCJournal &) = delete;
+
+        // ─── DTCStore ────────────────────────────────────────────────────────────
+        Result<DTCState> load(const DTCLimits &limits) override {
+            flush();
+            limits_ = limits;
+            auto image = nvm_.read();
+            if (!image.is_ok())
+                return Result<DTCState>::err(image.error());
+            const auto &bytes = image.value();
+
+            if (bytes.size() < HEADER_SIZE || !has_header(bytes)) {
+                if (!bytes.empty()) {
+                    stats_.discarded_bytes += bytes.size();
+                    echo::category("isobus.diagnostic.journal")
+                        .warn("DTC journal header invalid, discarding ", bytes.size(), " bytes");
+                }
+                auto fresh = header();
+                auto r = nvm_.replace(fresh);
+                if (!r.is_ok())
+                    return Result<DTCState>::err(r.error());
+                stats_.journal_bytes = snapshot_bytes_ = fresh.size();
+                return Result<DTCState>::ok(DTCState{});
+            }
+
+            usize good = 0;
+            DTCState state = replay(bytes, good);
+            if (good < bytes.size()) {
+                stats_.discarded_bytes += bytes.size() - good;
+                echo::category("isobus.diagnostic.journal")
+                    .warn("DTC journal torn at byte ", good, ", discarding ", bytes.size() - good, " bytes");
+                auto r = nvm_.truncate(good);
+                if (!r.is_ok())
+                    return Result<DTCState>::err(r.error());
+            }
+            stats_.journal_bytes = good;
+            snapshot_bytes_ = std::min(snapshot_bytes_, good);
+            echo::category("isobus.diagnostic.journal")
+                .debug("DTC journal replayed ", stats_.records_replayed, " records, ", good, " bytes");
+            return Result<DTCState>::ok(std::move(state));
+        }
+
+        void record(DTCChange change, const DTC &dtc, u8 count = 0) override {
+            auto bytes = dtc.encode();
+            u8 payload[5] = {bytes[0], bytes[1], bytes[2], bytes[3], count};
+            append_record(change, payload, sizeof(payload));
+        }
+
+        void record(const FreezeFrame &frame) override {
+            auto payload = frame.encode();
+            append_record(DTCChange::FreezeFrame, payload.data(), payload.size());
+        }
+
+        bool wants_compaction() const override {
+            return stats_.journal_bytes > config_.compact_bytes && stats_.journal_bytes > 2 * snapshot_bytes_;
+        }
+
+        void compact(const DTCState &state) override {
+            dp::Vector<u8> image = header();
+            auto put = [&](DTCChange change, const DTC &dtc, u8 count) {
+                auto bytes = dtc.encode();
+                u8 payload[5] = {bytes[0], bytes[1], bytes[2], bytes[3], count};
+                encode_record(image, change, payload, sizeof(payload));
+            };
+            for (const auto &dtc : state.active)
+                put(DTCChange::Active, dtc, 0);
+            for (const auto &dtc : state.previous)
+                put(DTCChange::Previous, dtc, 0);
+            for (const auto &pa : state.history)
+                put(DTCChange::History, pa.dtc, pa.occurrence_count);
+            for (const auto &[key, frames] : state.freeze_frames) {
+                for (const auto &ff : frames) {
+                    auto payload = ff.encode();
+                    encode_record(image, DTCChange::FreezeFrame, payload.data(), payload.size());
+                }
+            }
+
+            stats_.journal_bytes = snapshot_bytes_ = image.size();
+            ++stats_.compactions;
+            submit(Job{true, std::move(image)});
+        }
+
+        // ─── Control ─────────────────────────────────────────────────────────────
+        // Wait until every record handed to the journal is in NVM
+        void flush() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_cv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+        }
+
+        DTCJournalStats stats() const noexcept {
+            auto s = stats_;
+            s.write_errors = write_errors_.load(std::memory_order_relaxed);
+            return s;
+        }
+
+        const DTCJournalConfig &config() const noexcept { return config_; }
+
+      private:
+        static dp::Vector<u8> header() { return {'D', 'T', 'C', 'J', VERSION}; }
+
+        static bool has_header(const dp::Vector<u8> &bytes) {
+            return bytes[0] == 'D' && bytes[1] == 'T' && bytes[2] == 'C' && bytes[3] == 'J' && bytes[4] == VERSION;
+        }
+
+        static void encode_record(dp::Vector<u8> &out, DTCChange change, const u8 *payload, usize count) {
+            usize start = out.size();
+            out.push_back(static_cast<u8>(change));
+            out.push_back(static_cast<u8>(count & 0xFF));
+            out.push_back(static_cast<u8>((count >> 8) & 0xFF));
+            out.insert(out.end(), payload, payload + count);
+            u32 crc = detail::crc32(out.data() + start, out.size() - start);
+            for (u32 i = 0; i < 4; ++i)
+                out.push_back(static_cast<u8>(crc >> (8 * i)));
+        }
+
+        void append_record(DTCChange change, const u8 *payload, usize count) {
+            record_buf_.clear();
+            encode_record(record_buf_, change, payload, count);
+            stats_.journal_bytes += record_buf_.size();
+            ++stats_.records_written;
+            submit(Job{false, record_buf_});
+        }
+
+        // Rebuilds the state from intact records; `good` ends at the last one
+        DTCState replay(const dp::Vector<u8> &bytes, usize &good) {
+            detail::OrderedDTCs<DTC> active, previous;
+            detail::OrderedDTCs<PreviouslyActiveDTC> history;
+            DTCState state;
+            auto dtc_of = [](const DTC &d) { return detail::dtc_key(d); };
+            auto pa_of = [](const PreviouslyActiveDTC &p) { return detail::dtc_key(p.dtc); };
+
+            usize pos = HEADER_SIZE;
+            good = pos;
+            while (pos + RECORD_OVERHEAD <= bytes.size()) {
+                u8 kind = bytes[pos];
+                usize len = static_cast<usize>(bytes[pos + 1]) | (static_cast<usize>(bytes[pos + 2]) << 8);
+                if (pos + RECORD_OVERHEAD + len > bytes.size())
+                    break;
+                const u8 *payload = bytes.data() + pos + 3;
+                const u8 *tail = payload + len;
+                u32 crc = static_cast<u32>(tail[0]) | (static_cast<u32>(tail[1]) << 8) |
+                          (static_cast<u32>(tail[2]) << 16) | (static_cast<u32>(tail[3]) << 24);
+                if (crc != detail::crc32(bytes.data() + pos, len + 3))
+                    break;
+
+                auto change = static_cast<DTCChange>(kind);
+                if (change == DTCChange::FreezeFrame) {
+                    if (len < 9)
+                        break;
+                    auto ff = FreezeFrame::decode(dp::Vector<u8>(payload, payload + len));
+                    auto &frames = state.freeze_frames[detail::dtc_key(ff.dtc)];
+                    frames.push_back(std::move(ff));
+                    if (frames.size() > limits_.max_frames_per_dtc)
+                        frames.erase(frames.begin(), frames.end() - limits_.max_frames_per_dtc);
+                } else {
+                    if (len != 5)
+                        break;
+                    DTC dtc = DTC::decode(payload);
+                    u32 key = detail::dtc_key(dtc);
+                    switch (change) {
+                    case DTCChange::Active:
+                        active.upsert(key, dtc);
+                        break;
+                    case DTCChange::Inactive:
+                        active.erase(key);
+                        break;
+                    case DTCChange::Previous:
+                        previous.move_back(key, dtc);
+                        previous.bound(limits_.max_previous, +dtc_of);
+                        break;
+                    case DTCChange::PreviousErased:
+                        previous.erase(key);
+                        break;
+                    case DTCChange::PreviousCleared:
+                        previous.clear();
+                        break;
+                    case DTCChange::History:
+                        history.upsert(key, PreviouslyActiveDTC{dtc, payload[4]});
+                        history.bound(limits_.max_previous, +pa_of);
+                        break;
+                    case DTCChange::HistoryCleared:
+                        history.clear();
+                        break;
+                    case DTCChange::FramesErased:
+                        state.freeze_frames.erase(key);
+                        break;
+                    case DTCChange::FramesCleared:
+                        state.freeze_frames.clear();
+                        break;
+                    default:
+                        pos = bytes.size(); // unknown record kind: treat as corrupt
+                        continue;
+                    }
+                }
+                pos += RECORD_OVERHEAD + len;
+                good = pos;
+                ++stats_.records_replayed;
+            }
+
+            state.active = active.values();
+            state.previous = previous.values();
+            state.history = history.values();
+            return state;
+        }
+
+        void submit(Job job) {
+            if (!config_.write_behind) {
+                execute(job);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!thread_.joinable())
+                    thread_ = std::thread([this] { run(); });
+                if (job.replace) {
+                    // A snapshot supersedes every record not yet written
+                    queue_.clear();
+                } else if (!queue_.empty() && !queue_.back().replace) {
+                    auto &last = queue_.back().data;
+                    last.insert(last.end(), job.data.begin(), job.data.end());
+                    return;
+                }
+                queue_.push_back(std::move(job));
+            }
+            work_cv_.notify_one();
+        }
+
+        void execute(const Job &job) {
+            auto r = job.replace ? nvm_.replace(job.data) : nvm_.append(job.data.data(), job.data.size());
+            if (r.is_ok() && !job.replace && config_.sync_writes)
+                r = nvm_.sync();
+            if (!r.is_ok()) {
+                write_errors_.fetch_add(1, std::memory_order_relaxed);
+                echo::category("isobus.diagnostic.journal").error("DTC journal write failed");
+            }
+        }
+
+        void run() {
+            for (;;) {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    work_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                    if (queue_.empty())
+                        return;
+                    job = std::move(queue_.front());
+                    queue_.pop_front();
+                    busy_ = true;
+                }
+                execute(job);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    busy_ = false;
+                }
+                idle_cv_.notify_all();
+            }
+        }
+    };
+
+} // namespace agrobus::j1939
@@ -653,55 +653,32 @@ namespace agrobus::j1939 {
             if (!cf_) {
                 return Result<void>::err(Error::invalid_state("control function not set"));
             }
+            net_.register_pgn_callback(PGN_EEC1, [this](const Message &msg) { emit_decoded(on_eec1, msg); });
+            net_.register_pgn_callback(PGN_EEC2, [this](const Message &msg) { emit_decoded(on_eec2, msg); });
+            net_.register_pgn_callback(PGN_ET1, [this](const Message &msg) { emit_decoded(on_engine_temp, msg); });
+            net_.register_pgn_callback(PGN_ET2, [this](const Message &msg) { emit_decoded(on_engine_temp2, msg); });
+            net_.register_pgn_callback(PGN_EFLP, [this](const Message &msg) { emit_decoded(on_engine_fluid, msg); });
             net_.register_pgn_callback(
-                PGN_EEC1, [this](const Message &msg) { on_eec1.emit(EEC1::decode(msg.data), msg.source); });
+                PGN_ENGINE_HOURS, [this](const Message &msg) { emit_decoded(on_engine_hours, msg); });
             net_.register_pgn_callback(
-                PGN_EEC2, [this](const Message &msg) { on_eec2.emit(EEC2::decode(msg.data), msg.source); });
-            net_.register_pgn_callback(PGN_ET1, [this](const Message &msg) {
-                on_engine_temp.emit(EngineTemp1::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_ET2, [this](const Message &msg) {
-                on_engine_temp2.emit(EngineTemp2::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_EFLP, [this](const Message &msg) {
-                on_engine_fluid.emit(EngineFluidLP::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_ENGINE_HOURS, [this](const Message &msg) {
-                on_engine_hours.emit(EngineHours::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_FUEL_ECONOMY, [this](const Message &msg) {
-                on_fuel_economy.emit(FuelEconomy::decode(msg.data), msg.source);
-            });
+                PGN_FUEL_ECONOMY, [this](const Message &msg) { emit_decoded(on_fuel_economy, msg); });
+            net_.register_pgn_callback(PGN_EEC3, [this](const Message &msg) { emit_decoded(on_eec3, msg); });
+            net_.register_pgn_callback(PGN_TSC1, [this](const Message &msg) { emit_decoded(on_tsc1, msg); });
+            net_.register_pgn_callback(PGN_VEP1, [this](const Message &msg) { emit_decoded(on_vep1, msg); });
             net_.register_pgn_callback(
-                PGN_EEC3, [this](const Message &msg) { on_eec3.emit(EEC3::decode(msg.data), msg.source); });
+                PGN_AMBIENT_CONDITIONS, [this](const Message &msg) { emit_decoded(on_ambient, msg); });
             net_.register_pgn_callback(
-                PGN_TSC1, [this](const Message &msg) { on_tsc1.emit(TSC1::decode(msg.data), msg.source); });
+                PGN_DASH_DISPLAY, [this](const Message &msg) { emit_decoded(on_dash_display, msg); });
             net_.register_pgn_callback(
-                PGN_VEP1, [this](const Message &msg) { on_vep1.emit(VEP1::decode(msg.data), msg.source); });
-            net_.register_pgn_callback(PGN_AMBIENT_CONDITIONS, [this](const Message &msg) {
-                on_ambient.emit(AmbientConditions::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_DASH_DISPLAY, [this](const Message &msg) {
-                on_dash_display.emit(DashDisplay::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_VEHICLE_POSITION, [this](const Message &msg) {
-                on_vehicle_position.emit(VehiclePosition::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_FUEL_CONSUMPTION, [this](const Message &msg) {
-                on_fuel_consumption.emit(FuelConsumption::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_COMPONENT_ID, [this](const Message &msg) {
-                on_component_id.emit(ComponentIdentification::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_VEHICLE_ID, [this](const Message &msg) {
-                on_vehicle_id.emit(VehicleIdentification::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_AT1, [this](const Message &msg) {
-                on_aftertreatment1.emit(Aftertreatment1::decode(msg.data), msg.source);
-            });
-            net_.register_pgn_callback(PGN_AT2, [this](const Message &msg) {
-                on_aftertreatment2.emit(Aftertreatment2::decode(msg.data), msg.source);
-            });
+                PGN_VEHICLE_POSITION, [this](const Message &msg) { emit_decoded(on_vehicle_position, msg); });
+            net_.register_pgn_callback(
+                PGN_FUEL_CONSUMPTION, [this](const Message &msg) { emit_decoded(on_fuel_consumption, msg); });
+            net_.register_pgn_callback(
+                PGN_COMPONENT_ID, [this](const Message &msg) { emit_decoded(on_component_id, msg); });
+            net_.register_pgn_callback(
+                PGN_VEHICLE_ID, [this](const Message &msg) { emit_decoded(on_vehicle_id, msg); });
+            net_.register_pgn_callback(PGN_AT1, [this](const Message &msg) { emit_decoded(on_aftertreatment1, msg); });
+            net_.register_pgn_callback(PGN_AT2, [this](const Message &msg) { emit_decoded(on_aftertreatment2, msg); });
             echo::category("isobus.j1939.engine").debug("initialized");
             return {};
         }
@@ -0,0 +1,900 @@
+#pragma once
+
+#include "dm_memory.hpp"
+#include <agrobus/net/constants.hpp>
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/event.hpp>
+#include <agrobus/net/internal_cf.hpp>
+#include <agrobus/net/message.hpp>
+#include <agrobus/net/network_manager.hpp>
+#include <agrobus/net/types.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace agrobus::j1939 {
+    using namespace agrobus::net;
+
+    // ═════════════════════════════════════════════════════════════════════════════
+    // DM14/DM15/DM16 memory access engines
+    // ═════════════════════════════════════════════════════════════════════════════
+    // A service tool (client) reads, writes or erases an ECU's memory (server)
+    // one block at a time:
+    //
+    //   read:   DM14 Read  ->  DM15 Proceed, DM16 data
+    //   write:  DM14 Write ->  DM15 Proceed;  DM16 data -> DM15 Completed
+    //   erase:  DM14 Erase ->  DM15 Completed
+    //
+    // With security enabled the first DM14 is answered by a Proceed carrying a
+    // seed, and the request is repeated with the matching key. A DM16 block
+    // longer than 8 bytes travels over TP, and over ETP beyond 1785 bytes, so
+    // large blocks spend far less of the bus on handshakes.
+
+    // Error indicator in the DM15 address field when the status is Error
+    enum class DM15Error : u32 {
+        None = 0x000000,
+        NotSupported = 0x000001, // command or pointer type not handled
+        AddressRange = 0x000002, // address + length outside the memory
+        Length = 0x000003,       // zero, over the block limit, or DM16 size mismatch
+        InvalidKey = 0x000004,   // security key does not match the seed
+        AccessFailed = 0x000005, // the memory backend reported a failure
+    };
+
+    // ─── Memory backends ─────────────────────────────────────────────────────────
+    class MemoryBackend {
+      public:
+        virtual ~MemoryBackend() = default;
+
+        virtual u32 size() const = 0;
+        virtual Result<void> read(u32 address, u8 *out, u32 count) = 0;
+        virtual Result<void> write(u32 address, const u8 *data, u32 count) = 0;
+        virtual Result<void> erase(u32 address, u32 count) = 0; // back to 0xFF
+        virtual Result<void> flush() { return {}; }
+    };
+
+    class RamMemory : public MemoryBackend {
+        dp::Vector<u8> image_;
+
+      public:
+        explicit RamMemory(u32 size) : image_(size, 0xFF) {}
+        explicit RamMemory(dp::Vector<u8> image) : image_(std::move(image)) {}
+
+        u32 size() const override { return static_cast<u32>(image_.size()); }
+
+        Result<void> read(u32 address, u8 *out, u32 count) override {
+            if (static_cast<u64>(address) + count > image_.size())
+                return Result<void>::err(Error::invalid_data("read outside memory"));
+            std::memcpy(out, image_.data() + address, count);
+            return {};
+        }
+
+        Result<void> write(u32 address, const u8 *data, u32 count) override {
+            if (static_cast<u64>(address) + count > image_.size())
+                return Result<void>::err(Error::invalid_data("write outside memory"));
+            std::memcpy(image_.data() + address, data, count);
+            return {};
+        }
+
+        Result<void> erase(u32 address, u32 count) override {
+            if (static_cast<u64>(address) + count > image_.size())
+                return Result<void>::err(Error::invalid_data("erase outside memory"));
+            std::fill_n(image_.begin() + address, count, 0xFF);
+            return {};
+        }
+
+        const dp::Vector<u8> &image() const noexcept { return image_; }
+    };
+
+    // An ECU image kept in a file, e.g. a flash dump used to test reprogramming
+    // tools. The file is grown to the memory size with erased (0xFF) bytes.
+    class FileMemory : public MemoryBackend {
+        std::filesystem::path path_;
+        u32 size_;
+        int fd_ = -1;
+
+        Result<void> pwrite_all(u32 address, const u8 *data, u32 count) {
+            u32 done = 0;
+            while (done < count) {
+                ssize_t n = ::pwrite(fd_, data + done, count - done, static_cast<off_t>(address + done));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return Result<void>::err(Error::driver_error("memory image write failed"));
+                done += static_cast<u32>(n);
+            }
+            return {};
+        }
+
+        Result<void> check(u32 address, u32 count) const {
+            if (fd_ < 0)
+                return Result<void>::err(Error::invalid_state("memory image not open"));
+            if (static_cast<u64>(address) + count > size_)
+                return Result<void>::err(Error::invalid_data("access outside memory"));
+            return {};
+        }
+
+      public:
+        FileMemory(std::filesystem::path path, u32 size) : path_(std::move(path)), size_(size) {}
+        ~FileMemory() override {
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        FileMemory(const FileMemory &) = delete;
+        FileMemory &operator=(const FileMemory &) = delete;
+
+        Result<void> open() {
+            if (fd_ >= 0)
+                return {};
+            fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd_ < 0)
+                return Result<void>::err(Error::driver_error("cannot open memory image " + path_.string()));
+            struct stat st {};
+            if (::fstat(fd_, &st) != 0)
+                return Result<void>::err(Error::driver_error("fstat failed"));
+            if (static_cast<u64>(st.st_size) < size_) {
+                u32 from = static_cast<u32>(st.st_size);
+                dp::Vector<u8> erased(std::min<u32>(size_ - from, 64 * 1024), 0xFF);
+                for (u32 at = from; at < size_;) {
+                    u32 n = std::min<u32>(static_cast<u32>(erased.size()), size_ - at);
+                    auto r = pwrite_all(at, erased.data(), n);
+                    if (!r.is_ok())
+                        return r;
+                    at += n;
+                }
+            }
+            return {};
+        }
+
+        const std::filesystem::path &path() const noexcept { return path_; }
+        u32 size() const override { return size_; }
+
+        Result<void> read(u32 address, u8 *out, u32 count) override {
+            auto ok = check(address, count);
+            if (!ok.is_ok())
+                return ok;
+            u32 done = 0;
+            while (done < count) {
+                ssize_t n = ::pread(fd_, out + done, count - done, static_cast<off_t>(address + done));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return Result<void>::err(Error::driver_error("memory image read failed"));
+                done += static_cast<u32>(n);
+            }
+            return {};
+        }
+
+        Result<void> write(u32 address, const u8 *data, u32 count) override {
+            auto ok = check(address, count);
+            if (!ok.is_ok())
+                return ok;
+            return pwrite_all(address, data, count);
+        }
+
+        Result<void> erase(u32 address, u32 count) override {
+            auto ok = check(address, count);
+            if (!ok.is_ok())
+                return ok;
+            dp::Vector<u8> erased(std::min<u32>(count, 64 * 1024), 0xFF);
+            for (u32 at = address; at < address + count;) {
+                u32 n = std::min<u32>(static_cast<u32>(erased.size()), address + count - at);
+                auto r = pwrite_all(at, erased.data(), n);
+                if (!r.is_ok())
+                    return r;
+                at += n;
+            }
+            return {};
+        }
+
+        Result<void> flush() override {
+            if (fd_ >= 0 && ::fdatasync(fd_) != 0)
+                return Result<void>::err(Error::driver_error("memory image sync failed"));
+            return {};
+        }
+    };
+
+    namespace detail {
+        // How long a block may take before its DM15/DM16 is overdue: the
+        // response timeout plus the block's time on the wire at min_rate
+        inline u32 block_allowance_ms(u32 timeout_ms, u32 bytes, u32 min_rate) noexcept {
+            return timeout_ms + (min_rate ? static_cast<u32>(static_cast<u64>(bytes) * 1000 / min_rate) : 0);
+        }
+
+        inline Result<void> send_to(IsoNet &net, InternalCF *cf, PGN pgn, const dp::Vector<u8> &data, Address to) {
+            ControlFunction dest_cf;
+            dest_cf.address = to;
+            return net.send(pgn, data, cf, &dest_cf, Priority::Default);
+        }
+
+        // Sends DM16 blocks. The transport session of the previous block to the
+        // same node may still wait for its EOMA when the next one is ready; the
+        // block is then held and sent on the next update.
+        class DM16Sender {
+            SharedPayload held_;
+            Address to_ = NULL_ADDRESS;
+
+          public:
+            Result<void> send(IsoNet &net, InternalCF *cf, SharedPayload payload, Address to) {
+                held_.reset();
+                ControlFunction dest_cf;
+                dest_cf.address = to;
+                auto r = net.send(PGN_DM16, payload, cf, &dest_cf, Priority::Default);
+                if (!r.is_ok() && r.error().code == ErrorCode::SessionExists) {
+                    held_ = std::move(payload);
+                    to_ = to;
+                    return {};
+                }
+                return r;
+            }
+
+            Result<void> flush(IsoNet &net, InternalCF *cf) {
+                if (!held_)
+                    return {};
+                auto payload = std::move(held_);
+                return send(net, cf, std::move(payload), to_);
+            }
+
+            void drop() noexcept { held_.reset(); }
+        };
+    } // namespace detail
+
+    // ─── Server ──────────────────────────────────────────────────────────────────
+    struct MemoryServerConfig {
+        u32 response_timeout_ms = 1250; // a session left this long by its client is dropped
+        u32 min_rate = 4000;            // bytes/s a DM16 block is allowed to take on top of the timeout
+        u32 unlock_ms = 60000;          // a security unlock lasts this long without requests
+        u16 max_block_bytes = 0xFFFF;   // longest DM14 length accepted
+        bool read_ahead = true;         // prepare the next sequential read block while this one is sent
+        // Expected key for a seed; empty = no security
+        std::function<u8(u8 seed)> key_of;
+
+        MemoryServerConfig &timeout(u32 ms) {
+            response_timeout_ms = ms;
+            return *this;
+        }
+        MemoryServerConfig &block_limit(u16 bytes) {
+            max_block_bytes = bytes;
+            return *this;
+        }
+        MemoryServerConfig &security(std::function<u8(u8)> key_for_seed, u32 unlock_for_ms = 60000) {
+            key_of = std::move(key_for_seed);
+            unlock_ms = unlock_for_ms;
+            return *this;
+        }
+        MemoryServerConfig &prefetch(bool enable) {
+            read_ahead = enable;
+            return *this;
+        }
+    };
+
+    struct MemoryServerStats {
+        u64 requests = 0;
+        u64 reads = 0;
+        u64 writes = 0;
+        u64 erases = 0;
+        u64 bytes_read = 0;
+        u64 bytes_written = 0;
+        u64 prefetch_hits = 0; // reads served from the read-ahead block
+        u64 busy = 0;          // requests refused while another client had the session
+        u64 errors = 0;
+        u64 key_failures = 0;
+        u64 timeouts = 0;
+    };
+
+    class MemoryAccessServer {
+        enum class State : u8 { Idle, AwaitKey, AwaitData };
+
+        IsoNet &net_;
+        InternalCF *cf_;
+        MemoryBackend &memory_;
+        MemoryServerConfig config_;
+        MemoryServerStats stats_;
+        detail::DM16Sender sender_;
+
+        State state_ = State::Idle;
+        Address client_ = NULL_ADDRESS;
+        DM14Request request_;
+        u32 wait_ms_ = 0;
+        u32 allowance_ms_ = 0;
+
+        u8 seed_ = 0xFF;
+        u32 seed_state_ = 0x2545F491;
+        Address unlocked_ = NULL_ADDRESS;
+        u32 unlocked_idle_ms_ = 0;
+
+        SharedPayload ahead_; // encoded DM16 for the block after the last read
+        u32 ahead_address_ = 0;
+        u16 ahead_length_ = 0;
+
+      public:
+        MemoryAccessServer(IsoNet &net, InternalCF *cf, MemoryBackend &memory, MemoryServerConfig config = {})
+            : net_(net), cf_(cf), memory_(memory), config_(std::move(config)) {}
+
+        Result<void> initialize() {
+            if (!cf_)
+                return Result<void>::err(Error::invalid_state("control function not set"));
+            net_.register_pgn_callback(PGN_DM14, [this](const Message &msg) { handle_dm14(msg); });
+            net_.register_pgn_callback(PGN_DM16, [this](const Message &msg) { handle_dm16(msg); });
+            echo::category("isobus.protocol.dm_memory").debug("memory access server initialized, ", memory_.size(),
+                                                              " bytes");
+            return {};
+        }
+
+        void update(u32 elapsed_ms) {
+            auto sent = sender_.flush(net_, cf_);
+            if (!sent.is_ok())
+                echo::category("isobus.protocol.dm_memory").warn("DM16 send failed: ", sent.error().message);
+            if (unlocked_ != NULL_ADDRESS) {
+                unlocked_idle_ms_ += elapsed_ms;
+                if (unlocked_idle_ms_ >= config_.unlock_ms)
+                    unlocked_ = NULL_ADDRESS;
+            }
+            if (state_ == State::Idle)
+                return;
+            wait_ms_ += elapsed_ms;
+            if (wait_ms_ >= allowance_ms_) {
+                ++stats_.timeouts;
+                echo::category("isobus.protocol.dm_memory").debug("memory session with ", client_, " timed out");
+                state_ = State::Idle;
+            }
+        }
+
+        bool busy() const noexcept { return state_ != State::Idle; }
+        Address client() const noexcept { return state_ == State::Idle ? NULL_ADDRESS : client_; }
+        const MemoryServerStats &stats() const noexcept { return stats_; }
+
+        // ─── Events ──────────────────────────────────────────────────────────────
+        Event<DM14Request, Address> on_request; // every accepted DM14
+        Event<u32, u32, Address> on_written;    // address, length, client
+        Event<u32, u32, Address> on_erased;     // address, length, client
+        Event<Address> on_unlocked;
+
+      private:
+        void handle_dm14(const Message &msg) {
+            if (msg.destination != cf_->address() || msg.data.size() < 7)
+                return;
+            auto req = DM14Request::decode(msg.data);
+            ++stats_.requests;
+            if (state_ != State::Idle && msg.source != client_) {
+                ++stats_.busy;
+                respond(msg.source, DM15Status::Busy, req);
+                return;
+            }
+            if (state_ == State::AwaitKey) {
+                if (req.key != config_.key_of(seed_)) {
+                    ++stats_.key_failures;
+                    fail(msg.source, req, DM15Error::InvalidKey);
+                    return;
+                }
+                unlocked_ = msg.source;
+                on_unlocked.emit(msg.source);
+            }
+            // A new request from the session's client replaces whatever it was doing
+            state_ = State::Idle;
+            begin(msg.source, req);
+        }
+
+        void begin(Address client, const DM14Request &req) {
+            if (config_.key_of && unlocked_ != client) {
+                seed_ = next_seed();
+                arm(client, req, State::AwaitKey, 0);
+                DM15Response resp;
+                resp.status = DM15Status::Proceed;
+                resp.length = req.length;
+                resp.address = req.address;
+                resp.seed = seed_;
+                detail::send_to(net_, cf_, PGN_DM15, resp.encode(), client);
+                return;
+            }
+            unlocked_idle_ms_ = 0;
+            if (req.length == 0 || req.length > config_.max_block_bytes) {
+                fail(client, req, DM15Error::Length);
+                return;
+            }
+            if (static_cast<u64>(req.address) + req.length > memory_.size()) {
+                fail(client, req, DM15Error::AddressRange);
+                return;
+            }
+            on_request.emit(req, client);
+
+            switch (req.command) {
+            case DM14Command::Read:
+                serve_read(client, req);
+                break;
+            case DM14Command::Write:
+                arm(client, req, State::AwaitData, req.length);
+                respond(client, DM15Status::Proceed, req);
+                break;
+            case DM14Command::Erase:
+                ahead_.reset();
+                if (!memory_.erase(req.address, req.length).is_ok()) {
+                    fail(client, req, DM15Error::AccessFailed);
+                    break;
+                }
+                ++stats_.erases;
+                respond(client, DM15Status::Completed, req);
+                on_erased.emit(req.address, req.length, client);
+                break;
+            default:
+                fail(client, req, DM15Error::NotSupported);
+                break;
+            }
+        }
+
+        void serve_read(Address client, const DM14Request &req) {
+            SharedPayload block;
+            if (ahead_ && ahead_address_ == req.address && ahead_length_ == req.length) {
+                block = std::move(ahead_);
+                ++stats_.prefetch_hits;
+            } else {
+                block = read_block(req.address, req.length);
+            }
+            if (!block) {
+                fail(client, req, DM15Error::AccessFailed);
+                return;
+            }
+            respond(client, DM15Status::Proceed, req);
+            auto sent = sender_.send(net_, cf_, std::move(block), client);
+            if (!sent.is_ok()) {
+                echo::category("isobus.protocol.dm_memory").warn("DM16 send failed: ", sent.error().message);
+                return;
+            }
+            ++stats_.reads;
+            stats_.bytes_read += req.length;
+
+            // Clients read sequentially; have the next block ready for them
+            ahead_.reset();
+            u32 next = req.address + req.length;
+            if (config_.read_ahead && static_cast<u64>(next) + req.length <= memory_.size()) {
+                ahead_ = read_block(next, req.length);
+                ahead_address_ = next;
+                ahead_length_ = req.length;
+            }
+        }
+
+        void handle_dm16(const Message &msg) {
+            if (msg.destination != cf_->address() || state_ != State::AwaitData || msg.source != client_)
+                return;
+            usize n = DM16Transfer::block_length(msg.data);
+            if (n != request_.length) {
+                fail(client_, request_, DM15Error::Length);
+                return;
+            }
+            ahead_.reset();
+            if (!memory_.write(request_.address, msg.data.data() + 1, request_.length).is_ok()) {
+                fail(client_, request_, DM15Error::AccessFailed);
+                return;
+            }
+            ++stats_.writes;
+            stats_.bytes_written += n;
+            state_ = State::Idle;
+            respond(client_, DM15Status::Completed, request_);
+            on_written.emit(request_.address, request_.length, client_);
+        }
+
+        SharedPayload read_block(u32 address, u16 length) {
+            auto block = std::make_shared<dp::Vector<u8>>(std::max<usize>(length + 1u, 8), 0xFF);
+            (*block)[0] = length < DM16Transfer::LENGTH_FROM_TRANSPORT ? static_cast<u8>(length)
+                                                                       : DM16Transfer::LENGTH_FROM_TRANSPORT;
+            if (!memory_.read(address, block->data() + 1, length).is_ok())
+                return nullptr;
+            return block;
+        }
+
+        void arm(Address client, const DM14Request &req, State state, u32 bytes) {
+            state_ = state;
+            client_ = client;
+            request_ = req;
+            wait_ms_ = 0;
+            allowance_ms_ = detail::block_allowance_ms(config_.response_timeout_ms, bytes, config_.min_rate);
+        }
+
+        void respond(Address client, DM15Status status, const DM14Request &req, u32 address_field = 0xFFFFFFFF) {
+            DM15Response resp;
+            resp.status = status;
+            resp.length = req.length;
+            resp.address = address_field == 0xFFFFFFFF ? req.address : address_field;
+            detail::send_to(net_, cf_, PGN_DM15, resp.encode(), client);
+        }
+
+        void fail(Address client, const DM14Request &req, DM15Error error) {
+            ++stats_.errors;
+            if (client == client_)
+                state_ = State::Idle;
+            echo::category("isobus.protocol.dm_memory")
+                .debug("memory access refused: client=", client, " address=", req.address, " length=", req.length,
+                       " error=", static_cast<u32>(error));
+            respond(client, DM15Status::Error, req, static_cast<u32>(error));
+        }
+
+        // xorshift32; 0xFF means "no seed" on the wire
+        u8 next_seed() noexcept {
+            u8 seed;
+            do {
+                seed_state_ ^= seed_state_ << 13;
+                seed_state_ ^= seed_state_ >> 17;
+                seed_state_ ^= seed_state_ << 5;
+                seed = static_cast<u8>(seed_state_);
+            } while (seed == 0xFF);
+            return seed;
+        }
+    };
+
+    // ─── Client ──────────────────────────────────────────────────────────────────
+    inline constexpr u16 DM16_TP_BLOCK = static_cast<u16>(TP_MAX_DATA_LENGTH - 1); // largest block TP can carry
+    inline constexpr u16 DM16_ETP_BLOCK = 0xFFFF;                                   // largest DM14 length
+
+    struct MemoryClientConfig {
+        u16 block_bytes = DM16_TP_BLOCK; // data bytes per DM14; blocks over 1784 bytes go over ETP
+        u32 response_timeout_ms = 1250;  // DM15/DM16 overdue after this (plus the block's wire time)
+        u32 min_rate = 4000;             // bytes/s a block is allowed to take on the wire
+        u32 busy_backoff_ms = 250;       // wait before asking again after DM15 Busy
+        u8 retries = 3;                  // per block, for timeouts and Busy
+        DM14PointerType pointer = DM14PointerType::DirectPhysical;
+        // Answers a security seed; empty = fail when the server asks for a key
+        std::function<u8(u8 seed)> key_of;
+
+        MemoryClientConfig &block_size(u16 bytes) {
+            block_bytes = bytes;
+            return *this;
+        }
+        MemoryClientConfig &timeout(u32 ms) {
+            response_timeout_ms = ms;
+            return *this;
+        }
+        MemoryClientConfig &retry(u8 count, u32 backoff_ms = 250) {
+            retries = count;
+            busy_backoff_ms = backoff_ms;
+            return *this;
+        }
+        MemoryClientConfig &security(std::function<u8(u8)> key_for_seed) {
+            key_of = std::move(key_for_seed);
+            return *this;
+        }
+    };
+
+    struct MemoryClientStats {
+        u64 blocks = 0;
+        u64 bytes = 0;
+        u64 retries = 0;
+        u64 timeouts = 0;
+        u64 busy = 0;
+    };
+
+    // Where a transfer stands; `done` only counts blocks the server confirmed,
+    // so it is a safe checkpoint to resume from
+    struct MemoryTransferProgress {
+        DM14Command command = DM14Command::Reserved;
+        Address server = NULL_ADDRESS;
+        u32 address = 0;
+        u32 total = 0;
+        u32 done = 0;
+    };
+
+    class MemoryAccessClient {
+      public:
+        using ReadCallback = std::function<void(Result<dp::Vector<u8>>)>;
+        using DoneCallback = std::function<void(Result<void>)>;
+
+      private:
+        enum class Phase : u8 { Idle, AwaitProceed, AwaitData, AwaitCompleted, Backoff };
+
+        IsoNet &net_;
+        InternalCF *cf_;
+        MemoryClientConfig config_;
+        MemoryClientStats stats_;
+        detail::DM16Sender sender_;
+
+        Phase phase_ = Phase::Idle;
+        MemoryTransferProgress progress_;
+        dp::Vector<u8> buffer_; // the image being written, or the bytes read so far
+        u16 block_ = 0;         // length of the block in flight
+        u8 key_ = 0xFF;
+        u8 attempts_ = 0;
+        u32 wait_ms_ = 0;
+        u32 allowance_ms_ = 0;
+        bool interrupted_ = false;
+
+        SharedPayload staged_; // encoded DM16 for the block at staged_at_
+        u32 staged_at_ = 0;
+
+        ReadCallback read_done_;
+        DoneCallback done_;
+
+      public:
+        MemoryAccessClient(IsoNet &net, InternalCF *cf, MemoryClientConfig config = {})
+            : net_(net), cf_(cf), config_(std::move(config)) {}
+
+        Result<void> initialize() {
+            if (!cf_)
+                return Result<void>::err(Error::invalid_state("control function not set"));
+            if (config_.block_bytes == 0)
+                return Result<void>::err(Error::invalid_state("block size must not be zero"));
+            net_.register_pgn_callback(PGN_DM15, [this](const Message &msg) { handle_dm15(msg); });
+            net_.register_pgn_callback(PGN_DM16, [this](const Message &msg) { handle_dm16(msg); });
+            return {};
+        }
+
+        Result<void> read(Address server, u32 address, u32 length, ReadCallback done) {
+            auto ok = start(DM14Command::Read, server, address, length, 0);
+            if (!ok.is_ok())
+                return ok;
+            buffer_.assign(length, 0);
+            read_done_ = std::move(done);
+            return kick();
+        }
+
+        // `from` skips the bytes a previous run already had confirmed
+        Result<void> write(Address server, u32 address, dp::Vector<u8> image, DoneCallback done, u32 from = 0) {
+            if (from > image.size())
+                return Result<void>::err(Error::invalid_data("resume point beyond the image"));
+            auto ok = start(DM14Command::Write, server, address, static_cast<u32>(image.size()), from);
+            if (!ok.is_ok())
+                return ok;
+            buffer_ = std::move(image);
+            done_ = std::move(done);
+            staged_.reset();
+            return kick();
+        }
+
+        Result<void> erase(Address server, u32 address, u32 length, DoneCallback done) {
+            auto ok = start(DM14Command::Erase, server, address, length, 0);
+            if (!ok.is_ok())
+                return ok;
+            done_ = std::move(done);
+            return kick();
+        }
+
+        // Continues an interrupted transfer from the last confirmed block
+        Result<void> resume() {
+            if (phase_ != Phase::Idle)
+                return Result<void>::err(Error::invalid_state("memory transfer in progress"));
+            if (!interrupted_)
+                return Result<void>::err(Error::invalid_state("no interrupted memory transfer"));
+            interrupted_ = false;
+            attempts_ = 0;
+            key_ = 0xFF;
+            echo::category("isobus.protocol.dm_memory")
+                .debug("resuming memory transfer at ", progress_.done, " of ", progress_.total);
+            return kick();
+        }
+
+        // Stops without a callback; the transfer can still be resumed
+        void cancel() {
+            if (phase_ == Phase::Idle)
+                return;
+            phase_ = Phase::Idle;
+            interrupted_ = true;
+            sender_.drop();
+        }
+
+        void update(u32 elapsed_ms) {
+            auto sent = sender_.flush(net_, cf_);
+            if (!sent.is_ok()) {
+                retry(sent.error());
+                return;
+            }
+            if (phase_ == Phase::Idle)
+                return;
+            wait_ms_ += elapsed_ms;
+            if (wait_ms_ < allowance_ms_)
+                return;
+            if (phase_ == Phase::Backoff) {
+                request();
+                return;
+            }
+            ++stats_.timeouts;
+            retry(Error::timeout("no response from memory server"));
+        }
+
+        bool busy() const noexcept { return phase_ != Phase::Idle; }
+        bool resumable() const noexcept { return interrupted_; }
+        const MemoryTransferProgress &progress() const noexcept { return progress_; }
+        const MemoryClientStats &stats() const noexcept { return stats_; }
+
+        // ─── Events ──────────────────────────────────────────────────────────────
+        Event<u32, u32> on_progress; // confirmed bytes, total
+
+      private:
+        Result<void> start(DM14Command command, Address server, u32 address, u32 length, u32 from) {
+            if (phase_ != Phase::Idle)
+                return Result<void>::err(Error::invalid_state("memory transfer in progress"));
+            if (length == 0 || static_cast<u64>(address) + length > 0x1000000)
+                return Result<void>::err(Error::invalid_data("memory range outside the 24-bit address space"));
+            progress_ = MemoryTransferProgress{command, server, address, length, from};
+            interrupted_ = false;
+            attempts_ = 0;
+            key_ = 0xFF;
+            return {};
+        }
+
+        u16 next_block() const noexcept {
+            u32 limit = progress_.command == DM14Command::Erase ? DM16_ETP_BLOCK : config_.block_bytes;
+            return static_cast<u16>(std::min(progress_.total - progress_.done, limit));
+        }
+
+        Result<void> request() {
+            block_ = next_block();
+            if (progress_.command == DM14Command::Write)
+                stage(progress_.done);
+
+            DM14Request req;
+            req.command = progress_.command;
+            req.pointer_type = config_.pointer;
+            req.address = progress_.address + progress_.done;
+            req.length = block_;
+            req.key = key_;
+            wait_for(Phase::AwaitProceed, 0);
+            return detail::send_to(net_, cf_, PGN_DM14, req.encode(), progress_.server); // lost: the timeout retries
+        }
+
+        // First request of a transfer; a failure to send is reported to the caller
+        Result<void> kick() {
+            auto sent = request();
+            if (!sent.is_ok()) {
+                phase_ = Phase::Idle;
+                interrupted_ = true;
+            }
+            return sent;
+        }
+
+        // Encodes the write block at `offset` unless it already is
+        void stage(u32 offset) {
+            if (offset >= progress_.total || (staged_ && staged_at_ == offset))
+                return;
+            u16 n = static_cast<u16>(std::min<u32>(progress_.total - offset, config_.block_bytes));
+            staged_ = std::make_shared<dp::Vector<u8>>(DM16Transfer::encode_block(buffer_.data() + offset, n));
+            staged_at_ = offset;
+        }
+
+        void handle_dm15(const Message &msg) {
+            if (msg.destination != cf_->address() || msg.source != progress_.server)
+                return;
+            if (phase_ != Phase::AwaitProceed && phase_ != Phase::AwaitCompleted)
+                return;
+            auto resp = DM15Response::decode(msg.data);
+            switch (resp.status) {
+            case DM15Status::Busy:
+                ++stats_.busy;
+                if (attempts_ >= config_.retries) {
+                    finish(Error::invalid_state("memory server busy"));
+                    return;
+                }
+                ++attempts_;
+                wait_for(Phase::Backoff, 0, config_.busy_backoff_ms);
+                return;
+            case DM15Status::Error:
+            case DM15Status::EdcpFault:
+                finish(Error::invalid_state("memory access refused, error " + std::to_string(resp.address)));
+                return;
+            case DM15Status::Proceed:
+                if (phase_ == Phase::AwaitProceed)
+                    proceed(resp);
+                return;
+            case DM15Status::Completed:
+                if (phase_ == Phase::AwaitCompleted ||
+                    (phase_ == Phase::AwaitProceed && progress_.command == DM14Command::Erase))
+                    confirm(block_);
+                return;
+            default:
+                return;
+            }
+        }
+
+        void proceed(const DM15Response &resp) {
+            if (resp.seed != 0xFF) {
+                if (!config_.key_of) {
+                    finish(Error::invalid_state("memory server requires a security key"));
+                    return;
+                }
+                key_ = config_.key_of(resp.seed);
+                request();
+                return;
+            }
+            key_ = 0xFF;
+            switch (progress_.command) {
+            case DM14Command::Read:
+                wait_for(Phase::AwaitData, block_);
+                return;
+            case DM14Command::Write: {
+                stage(progress_.done);
+                wait_for(Phase::AwaitCompleted, block_);
+                auto sent = sender_.send(net_, cf_, staged_, progress_.server);
+                if (!sent.is_ok()) {
+                    retry(sent.error());
+                    return;
+                }
+                // Encode the next block while this one is on the wire
+                stage(progress_.done + block_);
+                return;
+            }
+            default:
+                wait_for(Phase::AwaitCompleted, block_);
+                return;
+            }
+        }
+
+        void handle_dm16(const Message &msg) {
+            if (msg.destination != cf_->address() || msg.source != progress_.server || phase_ != Phase::AwaitData)
+                return;
+            usize n = DM16Transfer::block_length(msg.data);
+            if (n != block_) {
+                retry(Error::invalid_data("DM16 block length mismatch"));
+                return;
+            }
+            std::copy(msg.data.begin() + 1, msg.data.begin() + 1 + n, buffer_.begin() + progress_.done);
+            confirm(block_);
+        }
+
+        // The block in flight is done; ask for the next one straight away
+        void confirm(u16 bytes) {
+            progress_.done += bytes;
+            ++stats_.blocks;
+            stats_.bytes += bytes;
+            attempts_ = 0;
+            on_progress.emit(progress_.done, progress_.total);
+            if (progress_.done >= progress_.total) {
+                finish(Result<void>{});
+                return;
+            }
+            request();
+        }
+
+        void wait_for(Phase phase, u32 bytes, u32 timeout_ms = 0) {
+            phase_ = phase;
+            wait_ms_ = 0;
+            allowance_ms_ = timeout_ms;
+            if (allowance_ms_ == 0)
+                allowance_ms_ = detail::block_allowance_ms(config_.response_timeout_ms, bytes, config_.min_rate);
+        }
+
+        void retry(const Error &why) {
+            if (attempts_ >= config_.retries) {
+                finish(why);
+                return;
+            }
+            ++attempts_;
+            ++stats_.retries;
+            echo::category("isobus.protocol.dm_memory")
+                .debug("retrying memory block at ", progress_.address + progress_.done, ": ", why.message);
+            request();
+        }
+
+        void finish(Result<void> result) {
+            phase_ = Phase::Idle;
+            sender_.drop();
+            interrupted_ = !result.is_ok();
+            if (interrupted_)
+                echo::category("isobus.protocol.dm_memory")
+                    .warn("memory transfer interrupted at ", progress_.done, " of ", progress_.total, ": ",
+                          result.error().message);
+            if (progress_.command == DM14Command::Read) {
+                auto done = read_done_; // the callback may start the next transfer
+                if (!done)
+                    return;
+                if (result.is_ok())
+                    done(Result<dp::Vector<u8>>::ok(std::move(buffer_)));
+                else
+                    done(Result<dp::Vector<u8>>::err(result.error()));
+                return;
+            }
+            if (!result.is_ok() && progress_.command == DM14Command::Write)
+                staged_.reset();
+            auto done = done_;
+            if (done)
+                done(std::move(result));
+        }
+
+        void finish(const Error &error) { finish(Result<void>::err(error)); }
+    };
+
+} // namespace agrobus::j1939
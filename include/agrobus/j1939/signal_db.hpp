@@ -0,0 +1,627 @@
+#pragma once
+
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/event.hpp>
+#include <agrobus/net/frame.hpp>
+#include <agrobus/net/message.hpp>
+#include <agrobus/net/network_manager.hpp>
+#include <agrobus/net/pgn_defs.hpp>
+#include <agrobus/net/types.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <datapod/datapod.hpp>
+#include <deque>
+#include <echo/echo.hpp>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace agrobus::j1939 {
+    using namespace agrobus::net;
+
+    // ═════════════════════════════════════════════════════════════════════════════
+    // Declarative SPN signal database
+    // ═════════════════════════════════════════════════════════════════════════════
+    // A signal is described once (PGN, SPN, start bit, length, scale, offset)
+    // instead of hand-coded in a decode() per message. Definitions known at
+    // compile time get extractors whose byte range, shift and mask are
+    // constants; a SignalDB holds definitions at run time (built in, or
+    // imported from a DBC file), a SignalDecoder decodes only the subscribed
+    // ones as messages arrive, and a BatchDecoder decodes whole logs column by
+    // column.
+
+    inline constexpr f64 SIGNAL_NOT_AVAILABLE = std::numeric_limits<f64>::quiet_NaN();
+
+    struct SignalDef {
+        u32 spn = 0; // 0 when unknown (e.g. a DBC signal without an SPN attribute)
+        PGN pgn = 0;
+        u16 start_bit = 0; // bit offset from the start of the data, little-endian
+        u8 length = 8;     // bits, 1..32
+        f64 scale = 1.0;
+        f64 offset = 0.0;
+        std::string_view name;
+        std::string_view unit;
+        bool is_signed = false;
+
+        constexpr f64 physical(u64 raw) const noexcept {
+            if (is_signed) {
+                u8 unused = static_cast<u8>(64 - length);
+                return static_cast<f64>(static_cast<i64>(raw << unused) >> unused) * scale + offset;
+            }
+            return static_cast<f64>(raw) * scale + offset;
+        }
+    };
+
+    // J1939-71 ranges: above 0xFA.. (0xFB error indicator, 0xFE/0xFF not
+    // available) is not a value; a 2..7 bit field is not available when all ones
+    inline constexpr bool signal_valid(u64 raw, u8 length) noexcept {
+        if (length < 8)
+            return length < 2 || raw != (u64(1) << length) - 1;
+        return (raw >> (length - 8)) <= 0xFA;
+    }
+
+    // Bits [start_bit, start_bit + length) of little-endian data
+    inline constexpr u64 extract_bits(const u8 *data, u16 start_bit, u8 length) noexcept {
+        usize first = start_bit / 8;
+        usize last = (start_bit + length - 1) / 8;
+        u64 word = 0;
+        for (usize i = first; i <= last; ++i)
+            word |= static_cast<u64>(data[i]) << (8 * (i - first));
+        return (word >> (start_bit % 8)) & ((u64(1) << length) - 1);
+    }
+
+    // ─── Compile-time extractors ─────────────────────────────────────────────────
+    // decode<spns::EngineSpeed>(data, size): the byte range, shift and mask
+    // fold into constants, so a byte-aligned signal is a load and a multiply.
+    template <const SignalDef &S> constexpr u64 raw_value(const u8 *data) noexcept {
+        static_assert(S.length >= 1 && S.length <= 32, "signal length must be 1..32 bits");
+        constexpr usize first = S.start_bit / 8;
+        constexpr usize last = (S.start_bit + S.length - 1) / 8;
+        constexpr u8 shift = S.start_bit % 8;
+        constexpr u64 mask = (u64(1) << S.length) - 1;
+        u64 word = 0;
+        for (usize i = first; i <= last; ++i)
+            word |= static_cast<u64>(data[i]) << (8 * (i - first));
+        return (word >> shift) & mask;
+    }
+
+    template <const SignalDef &S> constexpr dp::Optional<f64> decode(const u8 *data, usize size) noexcept {
+        if ((S.start_bit + S.length - 1) / 8 >= size)
+            return dp::nullopt;
+        u64 raw = raw_value<S>(data);
+        if (!S.is_signed && !signal_valid(raw, S.length))
+            return dp::nullopt;
+        return S.physical(raw);
+    }
+
+    // ─── Standard engine signals (J1939-71) ──────────────────────────────────────
+    namespace spns {
+        // EEC1
+        inline constexpr SignalDef DriverDemandTorque{512, PGN_EEC1, 8, 8, 1.0, -125.0, "DriverDemandTorque", "%"};
+        inline constexpr SignalDef ActualEngineTorque{513, PGN_EEC1, 0, 8, 1.0, -125.0, "ActualEngineTorque", "%"};
+        inline constexpr SignalDef FrictionTorque{514, PGN_EEC1, 16, 8, 1.0, -125.0, "FrictionTorque", "%"};
+        inline constexpr SignalDef EngineSpeed{190, PGN_EEC1, 24, 16, 0.125, 0.0, "EngineSpeed", "rpm"};
+        inline constexpr SignalDef StarterMode{1675, PGN_EEC1, 48, 4, 1.0, 0.0, "StarterMode", ""};
+        // EEC2
+        inline constexpr SignalDef AccelPedalLowIdle{558, PGN_EEC2, 0, 2, 1.0, 0.0, "AccelPedalLowIdle", ""};
+        inline constexpr SignalDef AccelPedalKickdown{559, PGN_EEC2, 2, 2, 1.0, 0.0, "AccelPedalKickdown", ""};
+        inline constexpr SignalDef AccelPedalPosition{91, PGN_EEC2, 8, 8, 0.4, 0.0, "AccelPedalPosition", "%"};
+        inline constexpr SignalDef EngineLoad{92, PGN_EEC2, 16, 8, 1.0, 0.0, "EngineLoad", "%"};
+        // ET1
+        inline constexpr SignalDef CoolantTemp{110, PGN_ET1, 0, 8, 1.0, -40.0, "CoolantTemp", "degC"};
+        inline constexpr SignalDef FuelTemp{174, PGN_ET1, 8, 8, 1.0, -40.0, "FuelTemp", "degC"};
+        inline constexpr SignalDef OilTemp{175, PGN_ET1, 16, 16, 0.03125, -273.0, "OilTemp", "degC"};
+        inline constexpr SignalDef TurboOilTemp{176, PGN_ET1, 32, 16, 0.03125, -273.0, "TurboOilTemp", "degC"};
+        inline constexpr SignalDef IntercoolerTemp{52, PGN_ET1, 48, 8, 1.0, -40.0, "IntercoolerTemp", "degC"};
+        // EFL/P1
+        inline constexpr SignalDef FuelDeliveryPressure{94, PGN_EFLP, 0, 8, 4.0, 0.0, "FuelDeliveryPressure", "kPa"};
+        inline constexpr SignalDef OilPressure{100, PGN_EFLP, 8, 8, 4.0, 0.0, "OilPressure", "kPa"};
+        inline constexpr SignalDef CoolantPressure{109, PGN_EFLP, 16, 8, 2.0, 0.0, "CoolantPressure", "kPa"};
+        inline constexpr SignalDef OilLevel{98, PGN_EFLP, 24, 8, 0.4, 0.0, "OilLevel", "%"};
+        inline constexpr SignalDef CoolantLevel{111, PGN_EFLP, 32, 8, 0.4, 0.0, "CoolantLevel", "%"};
+        inline constexpr SignalDef CrankcasePressure{101, PGN_EFLP, 40, 16, 0.05, -250.0, "CrankcasePressure", "kPa"};
+        // HOURS
+        inline constexpr SignalDef EngineHours{247, PGN_ENGINE_HOURS, 0, 32, 0.05, 0.0, "EngineHours", "h"};
+        inline constexpr SignalDef EngineRevolutions{249, PGN_ENGINE_HOURS, 32, 32, 1000.0, 0.0, "EngineRevolutions",
+                                                     "r"};
+        // LFE1
+        inline constexpr SignalDef FuelRate{183, PGN_FUEL_ECONOMY, 0, 16, 0.05, 0.0, "FuelRate", "L/h"};
+        inline constexpr SignalDef InstantFuelEconomy{184, PGN_FUEL_ECONOMY, 16, 16, 1.0 / 512, 0.0,
+                                                      "InstantFuelEconomy", "km/L"};
+        inline constexpr SignalDef ThrottlePosition{51, PGN_FUEL_ECONOMY, 32, 8, 0.4, 0.0, "ThrottlePosition", "%"};
+        // AMB
+        inline constexpr SignalDef BarometricPressure{108, PGN_AMBIENT_CONDITIONS, 0, 8, 0.5, 0.0,
+                                                      "BarometricPressure", "kPa"};
+        inline constexpr SignalDef AmbientAirTemp{171, PGN_AMBIENT_CONDITIONS, 8, 16, 0.03125, -273.0,
+                                                  "AmbientAirTemp", "degC"};
+        inline constexpr SignalDef IntakeAirTemp{172, PGN_AMBIENT_CONDITIONS, 24, 8, 1.0, -40.0, "IntakeAirTemp",
+                                                 "degC"};
+        inline constexpr SignalDef RoadSurfaceTemp{79, PGN_AMBIENT_CONDITIONS, 32, 16, 0.03125, -273.0,
+                                                   "RoadSurfaceTemp", "degC"};
+
+        inline constexpr const SignalDef *ENGINE[] = {
+            &DriverDemandTorque, &ActualEngineTorque, &FrictionTorque,     &EngineSpeed,     &StarterMode,
+            &AccelPedalLowIdle,  &AccelPedalKickdown, &AccelPedalPosition, &EngineLoad,      &CoolantTemp,
+            &FuelTemp,           &OilTemp,            &TurboOilTemp,       &IntercoolerTemp, &FuelDeliveryPressure,
+            &OilPressure,        &CoolantPressure,    &OilLevel,           &CoolantLevel,    &CrankcasePressure,
+            &EngineHours,        &EngineRevolutions,  &FuelRate,           &InstantFuelEconomy,
+            &ThrottlePosition,   &BarometricPressure, &AmbientAirTemp,     &IntakeAirTemp,   &RoadSurfaceTemp,
+        };
+    } // namespace spns
+
+    // ─── Signal database ─────────────────────────────────────────────────────────
+    class SignalDB {
+        std::deque<SignalDef> defs_;      // stable addresses for SignalDecoder/SignalColumn
+        std::deque<std::string> strings_; // names and units of imported signals
+        dp::Map<PGN, dp::Vector<const SignalDef *>> by_pgn_;
+
+      public:
+        SignalDB() = default;
+        SignalDB(const SignalDB &) = delete;
+        SignalDB &operator=(const SignalDB &) = delete;
+        SignalDB(SignalDB &&) = default;
+        SignalDB &operator=(SignalDB &&) = default;
+
+        // The J1939-71 engine signals in spns::ENGINE
+        static SignalDB engine() {
+            SignalDB db;
+            for (const auto *def : spns::ENGINE)
+                db.add(*def);
+            return db;
+        }
+
+        const SignalDef &add(const SignalDef &def) {
+            defs_.push_back(def);
+            auto &stored = defs_.back();
+            by_pgn_[stored.pgn].push_back(&stored);
+            return stored;
+        }
+
+        const SignalDef *find(u32 spn) const {
+            for (const auto &def : defs_)
+                if (def.spn == spn && spn != 0)
+                    return &def;
+            return nullptr;
+        }
+
+        const SignalDef *find(std::string_view name) const {
+            for (const auto &def : defs_)
+                if (def.name == name)
+                    return &def;
+            return nullptr;
+        }
+
+        // Signals carried by a PGN, in definition order
+        const dp::Vector<const SignalDef *> *of(PGN pgn) const {
+            auto it = by_pgn_.find(pgn);
+            return it == by_pgn_.end() ? nullptr : &it->second;
+        }
+
+        usize size() const noexcept { return defs_.size(); }
+        auto begin() const { return defs_.begin(); }
+        auto end() const { return defs_.end(); }
+
+        // ─── DBC import ──────────────────────────────────────────────────────────
+        // Reads BO_/SG_ definitions of extended (J1939) messages and the
+        // "SPN" signal attribute. Big-endian (@0) signals, multiplexed
+        // signals and signals over 32 bits are skipped. Returns the number of
+        // signals added.
+        Result<usize> import_dbc(std::string_view text) {
+            PGN pgn = 0;
+            u32 message_id = 0;
+            bool in_message = false;
+            usize added = 0, skipped = 0;
+            dp::Map<u32, dp::Map<std::string, u32>> spn_of;   // message id -> signal name -> SPN
+            dp::Vector<std::pair<u32, SignalDef *>> imported; // message id, signal
+
+            usize line_no = 0;
+            for (auto line : lines(text)) {
+                ++line_no;
+                line = trim(line);
+                if (starts_with(line, "BO_ ")) {
+                    auto fields = split(line.substr(4));
+                    if (fields.empty())
+                        return bad_line(line_no);
+                    message_id = static_cast<u32>(std::strtoul(std::string(fields[0]).c_str(), nullptr, 10));
+                    in_message = (message_id & 0x80000000u) != 0; // extended identifier
+                    pgn = Identifier(message_id & 0x1FFFFFFF).pgn();
+                } else if (starts_with(line, "SG_ ")) {
+                    if (!in_message) {
+                        ++skipped;
+                        continue;
+                    }
+                    SignalDef def;
+                    std::string_view raw_name;
+                    if (!parse_signal(line.substr(4), def, raw_name))
+                        return bad_line(line_no);
+                    if (def.length == 0) {
+                        ++skipped; // unsupported byte order, multiplexing or width
+                        continue;
+                    }
+                    def.pgn = pgn;
+                    def.name = keep(raw_name);
+                    def.unit = keep(def.unit);
+                    add(def);
+                    imported.emplace_back(message_id, &defs_.back());
+                    ++added;
+                } else if (starts_with(line, "BA_ \"SPN\" SG_ ")) {
+                    auto fields = split(line.substr(14));
+                    if (fields.size() >= 3)
+                        spn_of[static_cast<u32>(std::strtoul(std::string(fields[0]).c_str(), nullptr, 10))]
+                              [std::string(fields[1])] =
+                            static_cast<u32>(std::strtoul(std::string(fields[2]).c_str(), nullptr, 10));
+                }
+            }
+            for (auto &[id, def] : imported) {
+                auto msg = spn_of.find(id);
+                if (msg == spn_of.end())
+                    continue;
+                auto sig = msg->second.find(std::string(def->name));
+                if (sig != msg->second.end())
+                    def->spn = sig->second;
+            }
+            echo::category("isobus.j1939.signals").debug("DBC import: ", added, " signals, ", skipped, " skipped");
+            return Result<usize>::ok(added);
+        }
+
+      private:
+        std::string_view keep(std::string_view s) {
+            strings_.emplace_back(s);
+            return strings_.back();
+        }
+
+        static Result<usize> bad_line(usize line_no) {
+            return Result<usize>::err(Error::invalid_data("malformed DBC line " + std::to_string(line_no)));
+        }
+
+        static bool starts_with(std::string_view s, std::string_view prefix) noexcept {
+            return s.substr(0, prefix.size()) == prefix;
+        }
+
+        static std::string_view trim(std::string_view s) noexcept {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+                s.remove_prefix(1);
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r' || s.back() == ';'))
+                s.remove_suffix(1);
+            return s;
+        }
+
+        static dp::Vector<std::string_view> lines(std::string_view text) {
+            dp::Vector<std::string_view> out;
+            while (!text.empty()) {
+                usize end = text.find('\n');
+                out.push_back(text.substr(0, end));
+                if (end == std::string_view::npos)
+                    break;
+                text.remove_prefix(end + 1);
+            }
+            return out;
+        }
+
+        // Whitespace-separated fields; a trailing ':' is dropped
+        static dp::Vector<std::string_view> split(std::string_view s) {
+            dp::Vector<std::string_view> out;
+            usize i = 0;
+            while (i < s.size()) {
+                while (i < s.size() && s[i] == ' ')
+                    ++i;
+                usize start = i;
+                while (i < s.size() && s[i] != ' ')
+                    ++i;
+                if (i > start) {
+                    auto field = s.substr(start, i - start);
+                    if (field.size() > 1 && field.back() == ':')
+                        field.remove_suffix(1);
+                    out.push_back(field);
+                }
+            }
+            return out;
+        }
+
+        // name [mux] : start|length@order sign (scale,offset) [min|max] "unit" receivers
+        // def.length is left 0 for a signal this database does not support
+        static bool parse_signal(std::string_view s, SignalDef &def, std::string_view &name) {
+            usize colon = s.find(':');
+            if (colon == std::string_view::npos)
+                return false;
+            auto head = split(s.substr(0, colon));
+            if (head.empty())
+                return false;
+            name = head[0];
+            s = trim(s.substr(colon + 1));
+
+            usize bar = s.find('|'), at = s.find('@'), open = s.find('('), comma = s.find(','), close = s.find(')');
+            if (bar == std::string_view::npos || at == std::string_view::npos || at + 2 >= s.size() ||
+                open == std::string_view::npos || comma == std::string_view::npos || close == std::string_view::npos)
+                return false;
+            u32 start = static_cast<u32>(std::strtoul(std::string(s.substr(0, bar)).c_str(), nullptr, 10));
+            std::string length_text(s.substr(bar + 1, at - bar - 1));
+            u32 length = static_cast<u32>(std::strtoul(length_text.c_str(), nullptr, 10));
+            def.scale = std::strtod(std::string(s.substr(open + 1, comma - open - 1)).c_str(), nullptr);
+            def.offset = std::strtod(std::string(s.substr(comma + 1, close - comma - 1)).c_str(), nullptr);
+            def.is_signed = s[at + 2] == '-';
+            usize q1 = s.find('"'), q2 = q1 == std::string_view::npos ? q1 : s.find('"', q1 + 1);
+            if (q2 != std::string_view::npos)
+                def.unit = s.substr(q1 + 1, q2 - q1 - 1);
+
+            bool supported =
+                s[at + 1] == '1' && head.size() == 1 && length >= 1 && length <= 32 && start + length <= 64;
+            def.start_bit = static_cast<u16>(start);
+            def.length = supported ? static_cast<u8>(length) : 0;
+            return true;
+        }
+    };
+
+    // ─── Batch decode ────────────────────────────────────────────────────────────
+    // One decoded signal over a log: value[i] came from frames[frame[i]];
+    // NaN where the sender reported "not available"
+    struct SignalColumn {
+        const SignalDef *def = nullptr;
+        dp::Vector<u32> frame;
+        dp::Vector<f64> value;
+    };
+
+    // Decodes one signal out of packed payload words (byte 1 in the low bits).
+    // No branches in the loop, so the compiler can vectorize it.
+    inline void decode_column(const SignalDef &def, const u64 *words, usize n, f64 *out) noexcept {
+        const u8 shift = static_cast<u8>(def.start_bit);
+        const u64 mask = (u64(1) << def.length) - 1;
+        const f64 scale = def.scale, offset = def.offset;
+        if (def.is_signed) {
+            const u8 unused = static_cast<u8>(64 - def.length);
+            for (usize i = 0; i < n; ++i) {
+                i64 raw = static_cast<i64>(((words[i] >> shift) & mask) << unused) >> unused;
+                out[i] = static_cast<f64>(raw) * scale + offset;
+            }
+            return;
+        }
+        // First not-available raw value: 0xFB.. for byte-multiple widths, all ones below 8 bits
+        const u64 limit = def.length < 8 ? (def.length < 2 ? mask + 1 : mask) : (u64(0xFB) << (def.length - 8));
+        for (usize i = 0; i < n; ++i) {
+            u64 raw = (words[i] >> shift) & mask;
+            f64 value = static_cast<f64>(raw) * scale + offset;
+            out[i] = raw < limit ? value : SIGNAL_NOT_AVAILABLE;
+        }
+    }
+
+    // Decodes a fixed set of signals over logged frames, one column each,
+    // a chunk of the log at a time. One pass finds each frame's PGN through a
+    // collision-free hash table (one probe, no branch), a second packs the
+    // payloads of each PGN into a contiguous array, and then every signal runs
+    // decode_column() over its PGN's array. Columns and scratch buffers keep
+    // their capacity between chunks, so a long log is decoded without
+    // allocating after the first chunk.
+    class BatchDecoder {
+        static constexpr usize MAX_PGNS = 32; // keeps a collision-free table easy to find
+        static constexpr usize SLOTS = 256;
+        static constexpr u8 SKIP = 0xFF;
+
+        dp::Vector<SignalColumn> columns_;
+        dp::Vector<u8> column_group_; // PGN group of each column, SKIP past MAX_PGNS
+        dp::Vector<PGN> pgns_;
+        dp::Array<PGN, SLOTS> key_;
+        dp::Array<u8, SLOTS> slot_group_;
+        u32 mult_ = 0x9E3779B1u;
+
+        dp::Vector<u8> group_; // per frame
+        dp::Vector<usize> sizes_;
+        dp::Vector<dp::Vector<u32>> index_;
+        dp::Vector<dp::Vector<u64>> words_;
+
+      public:
+        explicit BatchDecoder(const dp::Vector<const SignalDef *> &wanted) {
+            for (const auto *def : wanted) {
+                auto it = std::find(pgns_.begin(), pgns_.end(), def->pgn);
+                if (it == pgns_.end() && pgns_.size() < MAX_PGNS)
+                    it = pgns_.insert(pgns_.end(), def->pgn);
+                column_group_.push_back(it == pgns_.end() ? SKIP : static_cast<u8>(it - pgns_.begin()));
+                columns_.push_back(SignalColumn{def, {}, {}});
+            }
+            if (std::find(column_group_.begin(), column_group_.end(), SKIP) != column_group_.end())
+                echo::category("isobus.j1939.signals").warn("batch decode limited to ", MAX_PGNS,
+                                                           " PGNs, further signals stay empty");
+
+            // Try multipliers until every PGN lands in a slot of its own
+            bool placed = false;
+            while (!placed) {
+                key_.fill(0xFFFFFFFF); // no PGN has all bits set
+                slot_group_.fill(SKIP);
+                placed = true;
+                for (usize g = 0; g < pgns_.size() && placed; ++g) {
+                    usize h = slot(pgns_[g]);
+                    placed = slot_group_[h] == SKIP;
+                    key_[h] = pgns_[g];
+                    slot_group_[h] = static_cast<u8>(g);
+                }
+                if (!placed)
+                    mult_ += 0x6A09E668u; // stays odd
+            }
+            sizes_.resize(pgns_.size() + 1); // last entry counts the frames of other PGNs
+            index_.resize(pgns_.size());
+            words_.resize(pgns_.size());
+        }
+
+        // Replaces the columns with the signals of the given frames. The
+        // reference stays valid until the next call.
+        const dp::Vector<SignalColumn> &decode(const Frame *frames, usize count) {
+            group_.resize(count);
+            std::fill(sizes_.begin(), sizes_.end(), 0);
+            for (usize i = 0; i < count; ++i) {
+                PGN pgn = frames[i].pgn();
+                usize h = slot(pgn);
+                u8 g = key_[h] == pgn ? slot_group_[h] : SKIP;
+                group_[i] = g;
+                ++sizes_[g == SKIP ? pgns_.size() : g];
+            }
+
+            for (usize g = 0; g < pgns_.size(); ++g) {
+                index_[g].resize(sizes_[g]);
+                words_[g].resize(sizes_[g]);
+                sizes_[g] = 0;
+            }
+            for (usize i = 0; i < count; ++i) {
+                u8 g = group_[i];
+                if (g == SKIP)
+                    continue;
+                u64 word;
+                std::memcpy(&word, frames[i].data.data(), sizeof(word)); // J1939 data is little-endian
+                if (frames[i].length < 8)
+                    word |= ~u64(0) << (8 * frames[i].length); // missing bytes read as not available
+                index_[g][sizes_[g]] = static_cast<u32>(i);
+                words_[g][sizes_[g]++] = word;
+            }
+
+            for (usize c = 0; c < columns_.size(); ++c) {
+                auto &col = columns_[c];
+                u8 g = column_group_[c];
+                if (g == SKIP)
+                    continue;
+                col.frame.assign(index_[g].begin(), index_[g].end());
+                col.value.resize(words_[g].size());
+                decode_column(*col.def, words_[g].data(), words_[g].size(), col.value.data());
+            }
+            return columns_;
+        }
+
+        const dp::Vector<SignalColumn> &columns() const noexcept { return columns_; }
+
+      private:
+        usize slot(PGN pgn) const noexcept { return static_cast<u32>(pgn * mult_) >> 24; }
+    };
+
+    // ─── Lazy decoder ────────────────────────────────────────────────────────────
+    // Decodes a received PGN only if some signal in it has a subscriber, and
+    // then only the subscribed signals. A PGN callback is registered on the
+    // first subscription to one of its signals. Callbacks may subscribe and
+    // unsubscribe; like Event, those changes take effect after the dispatch.
+    class SignalDecoder {
+        struct Subscription {
+            ListenerToken token = INVALID_TOKEN;
+            const SignalDef *def = nullptr;
+            std::function<void(f64, Address)> fn;
+            bool pending_remove = false;
+        };
+
+        const SignalDB &db_;
+        IsoNet *net_ = nullptr;
+        dp::Map<PGN, dp::Vector<Subscription>> subs_;
+        dp::Vector<PGN> registered_;
+        dp::Vector<Subscription> added_; // subscribed during dispatch
+        bool dispatching_ = false;
+        ListenerToken next_token_ = 1;
+        u64 decoded_ = 0;
+
+      public:
+        explicit SignalDecoder(const SignalDB &db) : db_(db) {}
+
+        // Subscriptions made before or after attaching are both served. The PGN
+        // callbacks cannot be removed, so the decoder must outlive the network.
+        void attach(IsoNet &net) {
+            net_ = &net;
+            for (const auto &[pgn, list] : subs_)
+                listen(pgn);
+        }
+
+        // fn(physical value, source) for every valid value of the SPN
+        Result<ListenerToken> subscribe(u32 spn, std::function<void(f64, Address)> fn) {
+            const SignalDef *def = db_.find(spn);
+            if (!def)
+                return Result<ListenerToken>::err(Error::invalid_data("unknown SPN " + std::to_string(spn)));
+            return Result<ListenerToken>::ok(subscribe(*def, std::move(fn)));
+        }
+
+        ListenerToken subscribe(const SignalDef &def, std::function<void(f64, Address)> fn) {
+            ListenerToken token = next_token_++;
+            if (dispatching_) {
+                added_.push_back({token, &def, std::move(fn)});
+                return token;
+            }
+            add(Subscription{token, &def, std::move(fn)});
+            return token;
+        }
+
+        bool unsubscribe(ListenerToken token) {
+            auto match = [&](const Subscription &s) { return s.token == token && !s.pending_remove; };
+            if (dispatching_) {
+                auto it = std::find_if(added_.begin(), added_.end(), match);
+                if (it != added_.end()) {
+                    added_.erase(it);
+                    return true;
+                }
+            }
+            for (auto &[pgn, list] : subs_) {
+                auto it = std::find_if(list.begin(), list.end(), match);
+                if (it == list.end())
+                    continue;
+                if (dispatching_)
+                    it->pending_remove = true; // erased once dispatch is complete
+                else
+                    list.erase(it);
+                return true;
+            }
+            return false;
+        }
+
+        // Decodes the subscribed signals of one PGN (also for logs and tests)
+        void feed(PGN pgn, const u8 *data, usize size, Address source) {
+            auto it = subs_.find(pgn);
+            if (it == subs_.end())
+                return;
+            auto &list = it->second;
+            bool outer = !dispatching_;
+            dispatching_ = true;
+            for (usize i = 0; i < list.size(); ++i) {
+                const auto &sub = list[i];
+                if (sub.pending_remove)
+                    continue;
+                const SignalDef &def = *sub.def;
+                if ((def.start_bit + def.length - 1) / 8 >= size)
+                    continue;
+                u64 raw = extract_bits(data, def.start_bit, def.length);
+                if (!def.is_signed && !signal_valid(raw, def.length))
+                    continue;
+                ++decoded_;
+                sub.fn(def.physical(raw), source);
+            }
+            if (outer) {
+                dispatching_ = false;
+                settle();
+            }
+        }
+
+        u64 decoded() const noexcept { return decoded_; }
+
+      private:
+        void add(Subscription sub) {
+            PGN pgn = sub.def->pgn;
+            subs_[pgn].push_back(std::move(sub));
+            if (net_)
+                listen(pgn);
+        }
+
+        // Applies the subscription changes deferred during dispatch
+        void settle() {
+            for (auto &[pgn, list] : subs_)
+                list.erase(std::remove_if(list.begin(), list.end(),
+                                          [](const Subscription &s) { return s.pending_remove; }),
+                           list.end());
+            auto added = std::move(added_);
+            added_.clear();
+            for (auto &sub : added)
+                add(std::move(sub));
+        }
+
+        void listen(PGN pgn) {
+            if (std::find(registered_.begin(), registered_.end(), pgn) != registered_.end())
+                return;
+            registered_.push_back(pgn);
+            net_->register_pgn_callback(pgn, [this, pgn](const Message &msg) {
+                feed(pgn, msg.data.data(), msg.data.size(), msg.source);
+            });
+        }
+    };
+
+} // namespace agrobus::j1939
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "signal_db.hpp"
+#include <agrobus/net/constants.hpp>
+#include <agrobus/net/error.hpp>
+#include <agrobus/net/message.hpp>
+#include <agrobus/net/network_manager.hpp>
+#include <agrobus/net/pgn_defs.hpp>
+#include <agrobus/net/types.hpp>
+#include <atomic>
+#include <datapod/datapod.hpp>
+#include <echo/echo.hpp>
+#include <memory>
+
+namespace agrobus::j1939 {
+    using namespace agrobus::net;
+
+    // ═════════════════════════════════════════════════════════════════════════════
+    // Signal history for freeze frames (DM25)
+    // ═════════════════════════════════════════════════════════════════════════════
+    // Keeps the recent raw values of a configured set of SPNs, taken from the
+    // PGNs that carry them, so a freeze frame can be captured the moment a DTC
+    // goes active, including how the signals looked shortly before.
+
+    // Where an SPN lives in its PGN (J1939-71 position, little-endian)
+    struct SignalSource {
+        u32 spn = 0;
+        PGN pgn = 0;
+        u16 start_bit = 0;             // bit offset from the start of the data
+        u8 length = 8;                 // bits, 1..32
+        Address source = NULL_ADDRESS; // only from this sender; NULL_ADDRESS = any
+    };
+
+    // ─── Configuration ───────────────────────────────────────────────────────────
+    struct SignalHistoryConfig {
+        dp::Vector<SignalSource> signals;
+        u16 depth = 64;            // samples kept per SPN (rounded up to a power of two)
+        u32 pre_trigger_ms = 0;    // how far back pre-trigger frames reach
+        u8 pre_trigger_frames = 0; // frames before the trigger, evenly spaced over pre_trigger_ms (max 254)
+
+        SignalHistoryConfig &signal(u32 spn, PGN pgn, u16 start_bit, u8 length, Address source = NULL_ADDRESS) {
+            signals.push_back({spn, pgn, start_bit, length, source});
+            return *this;
+        }
+        SignalHistoryConfig &signal(const SignalDef &def, Address source = NULL_ADDRESS) {
+            return signal(def.spn, def.pgn, def.start_bit, def.length, source);
+        }
+        SignalHistoryConfig &samples(u16 per_spn) {
+            depth = per_spn;
+            return *this;
+        }
+        SignalHistoryConfig &pre_trigger(u32 window_ms, u8 frames) {
+            pre_trigger_ms = window_ms;
+            pre_trigger_frames = frames;
+            return *this;
+        }
+
+        // EEC1 and ET1 as laid out by EEC1::encode() / EngineTemp1::encode()
+        SignalHistoryConfig &engine_signals() {
+            for (const auto *def : {&spns::ActualEngineTorque, &spns::DriverDemandTorque, &spns::FrictionTorque,
+                                    &spns::EngineSpeed, &spns::CoolantTemp, &spns::FuelTemp, &spns::OilTemp,
+                                    &spns::TurboOilTemp, &spns::IntercoolerTemp})
+                signal(*def);
+            return *this;
+        }
+    };
+
+    // ─── Sample ring ─────────────────────────────────────────────────────────────
+    // Single writer, any number of readers, no locks. Each slot packs the sample
+    // time and raw value into one atomic word; the writer overwrites the oldest
+    // slot and readers stop at a slot it has lapped or may be writing, so
+    // capacity - 1 samples are always readable.
+    class SignalRing {
+        std::unique_ptr<std::atomic<u64>[]> slots_;
+        u64 mask_;
+        std::atomic<u64> head_{0}; // samples ever written
+
+      public:
+        explicit SignalRing(usize capacity) {
+            usize n = 1;
+            while (n < capacity)
+                n <<= 1;
+            slots_ = std::make_unique<std::atomic<u64>[]>(n);
+            mask_ = n - 1;
+        }
+
+        usize capacity() const noexcept { return static_cast<usize>(mask_ + 1); }
+
+        void push(u32 time_ms, u32 value) noexcept {
+            u64 h = head_.load(std::memory_order_relaxed);
+            slots_[h & mask_].store((static_cast<u64>(time_ms) << 32) | value, std::memory_order_relaxed);
+            head_.store(h + 1, std::memory_order_release);
+        }
+
+        // Visits samples newest first until f returns false
+        template <typename F> void scan(F &&f) const {
+            u64 h = head_.load(std::memory_order_acquire);
+            u64 n = std::min<u64>(h, mask_ + 1);
+            for (u64 i = 1; i <= n; ++i) {
+                u64 packed = slots_[(h - i) & mask_].load(std::memory_order_relaxed);
+                // Stop at a slot the writer has reached again (or may be writing)
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (head_.load(std::memory_order_relaxed) - (h - i) >= mask_ + 1)
+                    return;
+                if (!f(static_cast<u32>(packed >> 32), static_cast<u32>(packed)))
+                    return;
+            }
+        }
+
+        u64 written() const noexcept { return head_.load(std::memory_order_acquire); }
+    };
+
+    // ─── Signal history ──────────────────────────────────────────────────────────
+    class SignalHistory {
+        struct Tracked {
+            SignalSource source;
+            SignalRing ring;
+
+            Tracked(const SignalSource &s, usize depth) : source(s), ring(depth) {}
+        };
+
+        SignalHistoryConfig config_;
+        dp::Vector<std::unique_ptr<Tracked>> signals_;
+        dp::Map<PGN, dp::Vector<Tracked *>> by_pgn_;
+        std::atomic<u32> now_ms_{0};
+        std::atomic<u64> samples_{0};
+
+      public:
+        explicit SignalHistory(SignalHistoryConfig config = {}) : config_(std::move(config)) {
+            for (const auto &source : config_.signals) {
+                if (source.length == 0 || source.length > 32)
+                    continue;
+                signals_.push_back(std::make_unique<Tracked>(source, config_.depth));
+                by_pgn_[source.pgn].push_back(signals_.back().get());
+            }
+        }
+
+        SignalHistory(const SignalHistory &) = delete;
+        SignalHistory &operator=(const SignalHistory &) = delete;
+
+        // Samples every configured PGN the network receives. The history must
+        // outlive the network's callbacks.
+        Result<void> attach(IsoNet &net) {
+            for (const auto &[pgn, tracked] : by_pgn_) {
+                auto r = net.register_pgn_callback(pgn, [this](const Message &msg) {
+                    feed(msg.pgn, msg.data.data(), msg.data.size(), msg.source);
+                });
+                if (!r.is_ok())
+                    return r;
+            }
+            echo::category("isobus.diagnostic.signals")
+                .debug("signal history: ", signals_.size(), " SPNs from ", by_pgn_.size(), " PGNs");
+            return {};
+        }
+
+        // Records the signals carried by one received PGN (callable from an RX thread)
+        void feed(PGN pgn, const u8 *data, usize size, Address source = NULL_ADDRESS) {
+            auto it = by_pgn_.find(pgn);
+            if (it == by_pgn_.end())
+                return;
+            u32 now = now_ms_.load(std::memory_order_relaxed);
+            for (Tracked *t : it->second) {
+                const auto &s = t->source;
+                if (s.source != NULL_ADDRESS && s.source != source)
+                    continue;
+                u32 value;
+                if (!extract(data, size, s.start_bit, s.length, value) || !signal_valid(value, s.length))
+                    continue;
+                t->ring.push(now, value);
+                samples_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void update(u32 elapsed_ms) { now_ms_.fetch_add(elapsed_ms, std::memory_order_relaxed); }
+
+        u32 now_ms() const noexcept { return now_ms_.load(std::memory_order_relaxed); }
+
+        // Values as of `frames` evenly spaced instants ending now, oldest first:
+        // emit(frame, time_ms, spn, value) for every SPN with a sample at or
+        // before that instant. One pass over each ring, newest to oldest.
+        template <typename F> void capture(u8 frames, u32 step_ms, F &&emit) const {
+            if (frames == 0)
+                return;
+            u32 now = now_ms();
+            for (const auto &t : signals_) {
+                i32 frame = frames - 1; // newest instant first
+                t->ring.scan([&](u32 time_ms, u32 value) {
+                    while (frame >= 0) {
+                        u32 back = static_cast<u32>(frames - 1 - frame) * step_ms;
+                        u32 at = now >= back ? now - back : 0;
+                        if (static_cast<i32>(time_ms - at) > 0)
+                            return true; // newer than this instant; keep walking back
+                        emit(static_cast<u8>(frame), at, t->source.spn, value);
+                        --frame;
+                    }
+                    return false;
+                });
+            }
+        }
+
+        // Latest value of one SPN
+        dp::Optional<u32> latest(u32 spn) const {
+            for (const auto &t : signals_) {
+                if (t->source.spn != spn)
+                    continue;
+                dp::Optional<u32> out;
+                t->ring.scan([&](u32, u32 value) {
+                    out = value;
+                    return false;
+                });
+                return out;
+            }
+            return dp::nullopt;
+        }
+
+        const SignalHistoryConfig &config() const noexcept { return config_; }
+        usize signal_count() const noexcept { return signals_.size(); }
+        u64 samples() const noexcept { return samples_.load(std::memory_order_relaxed); }
+
+        // Ring storage; fixed at construction
+        usize memory_bytes() const noexcept {
+            usize bytes = 0;
+            for (const auto &t : signals_)
+                bytes += t->ring.capacity() * sizeof(u64);
+            return bytes;
+        }
+
+      private:
+        static bool extract(const u8 *data, usize size, u16 start_bit, u8 length, u32 &value) noexcept {
+            if ((start_bit + length - 1) / 8 >= size)
+                return false;
+            value = static_cast<u32>(extract_bits(data, start_bit, length));
+            return true;
+        }
+    };
+
+} // namespace agrobus::j1939
@@ -120,11 +120,9 @@ namespace agrobus::j1939 {
             if (!cf_) {
                 return Result<void>::err(Error::invalid_state("control function not set"));
             }
+            net_.register_pgn_callback(PGN_TRANSMISSION_1, [this](const Message &msg) { emit_decoded(on_etc1, msg); });
             net_.register_pgn_callback(
-                PGN_TRANSMISSION_1, [this](const Message &msg) { on_etc1.emit(ETC1::decode(msg.data), msg.source); });
-            net_.register_pgn_callback(PGN_CRUISE_CONTROL, [this](const Message &msg) {
-                on_cruise_control.emit(CruiseControl::decode(msg.data), msg.source);
-            });
+                PGN_CRUISE_CONTROL, [this](const Message &msg) { emit_decoded(on_cruise_control, msg); });
             echo::category("isobus.j1939.transmission").debug("initialized");
             return {};
         }
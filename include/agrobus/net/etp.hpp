@@ -29,46 +29,17 @@ namespace agrobus::net {
 
         Result<dp::Vector<Frame>> send(PGN pgn, const dp::Vector<u8> &data, Address source, Address dest, u8 port = 0,
                                        Priority priority = Priority::Lowest) {
-            if (data.size() > MAX_DATA_LENGTH) {
-                echo::category("isobus.transport.etp")
-                    .error("data exceeds ETP max: size=", data.size(), " max=", MAX_DATA_LENGTH);
-                return Result<dp::Vector<Frame>>::err(Error(ErrorCode::BufferOverflow, "data exceeds ETP max"));
-            }
-            if (data.size() <= TP_MAX_DATA_LENGTH) {
-                return Result<dp::Vector<Frame>>::err(Error::invalid_state("use TP for <= 1785 bytes"));
-            }
-            if (dest == BROADCAST_ADDRESS) {
-                return Result<dp::Vector<Frame>>::err(Error::invalid_state("ETP does not support broadcast"));
-            }
-
-            // Check for existing session by full key
-            for (const auto &s : sessions_) {
-                if (s.source_address == source && s.destination_address == dest && s.pgn == pgn &&
-                    s.direction == TransportDirection::Transmit && s.can_port == port) {
-                    echo::category("isobus.transport.etp")
-                        .error("session already active: pgn=", pgn, " src=", static_cast<u8>(source),
-                               " dst=", static_cast<u8>(dest));
-                    return Result<dp::Vector<Frame>>::err(Error(ErrorCode::SessionExists, "session already active"));
-                }
-            }
-
-            dp::Vector<Frame> frames;
-            TransportSession session;
-            session.direction = TransportDirection::Transmit;
-            session.state = SessionState::WaitingForCTS;
-            session.pgn = pgn;
-            session.data = data;
-            session.total_bytes = static_cast<u32>(data.size());
-            session.source_address = source;
-            session.destination_address = dest;
-            session.can_port = port;
-            session.priority = priority;
-
-            frames.push_back(make_rts(session));
-            sessions_.push_back(std::move(session));
+            return start_send(pgn, data, nullptr, source, dest, port, priority);
+        }
 
-            echo::category("isobus.transport.etp").debug("ETP RTS sent: pgn=", pgn, " bytes=", data.size());
-            return Result<dp::Vector<Frame>>::ok(std::move(frames));
+        // Same as above, but the data frames are read from the caller's buffer
+        // instead of a copy held by the session
+        Result<dp::Vector<Frame>> send(PGN pgn, SharedPayload data, Address source, Address dest, u8 port = 0,
+                                       Priority priority = Priority::Lowest) {
+            if (!data)
+                return Result<dp::Vector<Frame>>::err(Error::invalid_data("null payload"));
+            const auto &bytes = *data;
+            return start_send(pgn, bytes, std::move(data), source, dest, port, priority);
         }
 
         dp::Vector<Frame> process_frame(const Frame &frame, u8 port = 0) {
@@ -140,10 +111,66 @@ namespace agrobus::net {
             return frames;
         }
 
+        // True while a send of this PGN from source to dest is still in progress
+        bool transmitting(PGN pgn, Address source, Address dest) const {
+            for (const auto &s : sessions_)
+                if (s.source_address == source && s.destination_address == dest && s.pgn == pgn &&
+                    s.direction == TransportDirection::Transmit)
+                    return true;
+            return false;
+        }
+
         Event<TransportSession &> on_complete;
         Event<TransportSession &, TransportAbortReason> on_abort;
 
       private:
+        Result<dp::Vector<Frame>> start_send(PGN pgn, const dp::Vector<u8> &data, SharedPayload shared, Address source,
+                                             Address dest, u8 port, Priority priority) {
+            if (data.size() > MAX_DATA_LENGTH) {
+                echo::category("isobus.transport.etp")
+                    .error("data exceeds ETP max: size=", data.size(), " max=", MAX_DATA_LENGTH);
+                return Result<dp::Vector<Frame>>::err(Error(ErrorCode::BufferOverflow, "data exceeds ETP max"));
+            }
+            if (data.size() <= TP_MAX_DATA_LENGTH) {
+                return Result<dp::Vector<Frame>>::err(Error::invalid_state("use TP for <= 1785 bytes"));
+            }
+            if (dest == BROADCAST_ADDRESS) {
+                return Result<dp::Vector<Frame>>::err(Error::invalid_state("ETP does not support broadcast"));
+            }
+
+            // Check for existing session by full key
+            for (const auto &s : sessions_) {
+                if (s.source_address == source && s.destination_address == dest && s.pgn == pgn &&
+                    s.direction == TransportDirection::Transmit && s.can_port == port) {
+                    echo::category("isobus.transport.etp")
+                        .error("session already active: pgn=", pgn, " src=", static_cast<u8>(source),
+                               " dst=", static_cast<u8>(dest));
+                    return Result<dp::Vector<Frame>>::err(Error(ErrorCode::SessionExists, "session already active"));
+                }
+            }
+
+            dp::Vector<Frame> frames;
+            TransportSession session;
+            session.direction = TransportDirection::Transmit;
+            session.state = SessionState::WaitingForCTS;
+            session.pgn = pgn;
+            if (shared)
+                session.shared_data = std::move(shared);
+            else
+                session.data = data;
+            session.total_bytes = static_cast<u32>(data.size());
+            session.source_address = source;
+            session.destination_address = dest;
+            session.can_port = port;
+            session.priority = priority;
+
+            frames.push_back(make_rts(session));
+            sessions_.push_back(std::move(session));
+
+            echo::category("isobus.transport.etp").debug("ETP RTS sent: pgn=", pgn, " bytes=", data.size());
+            return Result<dp::Vector<Frame>>::ok(std::move(frames));
+        }
+
         Frame make_rts(const TransportSession &s) const noexcept {
             Frame f;
             f.id = Identifier::encode(Priority::Lowest, PGN_ETP_CM, s.source_address, s.destination_address);
@@ -230,7 +257,7 @@ namespace agrobus::net {
 
                 for (u8 j = 0; j < 7; ++j) {
                     u32 idx = session.bytes_transferred + j;
-                    f.data[j + 1] = (idx < session.total_bytes) ? session.data[idx] : 0xFF;
+                    f.data[j + 1] = (idx < session.total_bytes) ? session.payload()[idx] : 0xFF;
                 }
                 f.length = 8;
 
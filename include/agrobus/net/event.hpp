@@ -82,4 +82,12 @@ namespace agrobus::net {
 
         ListenerToken operator+=(std::function<void(Args...)> fn) { return subscribe(std::move(fn)); }
     };
+
+    // ─── Lazy message decoding ───────────────────────────────────────────────────
+    // Emits T::decode(msg.data) with the sender address, but only when someone
+    // listens; most nodes subscribe to a few of the PGNs an interface handles
+    template <typename T, typename Msg> void emit_decoded(Event<T, Address> &event, const Msg &msg) {
+        if (event.count() > 0)
+            event.emit(T::decode(msg.data), msg.source);
+    }
 } // namespace agrobus::net
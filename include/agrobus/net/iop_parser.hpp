@@ -7,14 +7,139 @@
 #endif
 
 #include <agrobus/isobus/vt/objects.hpp>
+#include <agrobus/net/data_span.hpp>
 #include <agrobus/net/error.hpp>
+#include <agrobus/net/mapped_file.hpp>
 #include <agrobus/net/types.hpp>
 #include <datapod/datapod.hpp>
 #include <echo/echo.hpp>
+#include <memory>
+#include <thread>
 
 namespace agrobus::net {
     namespace vt = agrobus::isobus::vt;
 
+    // ─── IOP object reference ────────────────────────────────────────────────────
+    // Byte range of one object inside IOP data. The body range starts at the width
+    // field, matching VTObject::body as produced by IOPParser::parse_iop_data.
+    struct IOPObjectRef {
+        vt::ObjectID id = 0;
+        vt::ObjectType type = vt::ObjectType::WorkingSet;
+        u32 body_offset = 0;
+        u32 body_length = 0;
+    };
+
+    // ─── IOP validation options ──────────────────────────────────────────────────
+    struct IOPValidateOptions {
+        u32 threads = 0;                // 0 = std::thread::hardware_concurrency()
+        usize parallel_threshold = 8192; // objects; smaller pools validate inline
+
+        IOPValidateOptions &with_threads(u32 n) {
+            threads = n;
+            return *this;
+        }
+        IOPValidateOptions &min_parallel(usize objects) {
+            parallel_threshold = objects;
+            return *this;
+        }
+    };
+
+    // ─── Zero-copy IOP image ─────────────────────────────────────────────────────
+    // Indexed view over IOP bytes that are either memory-mapped or owned (bulk-copy
+    // fallback). Object bodies are served as spans into those bytes; the first
+    // mutable_body() call for an object copies its body out, later reads see the
+    // copy. to_pool() materializes a regular ObjectPool with one bulk copy per body.
+    class IOPImage {
+        static constexpr u32 NO_INDEX = 0xFFFFFFFF;
+
+        std::shared_ptr<MappedFile> mapping_;
+        dp::Vector<u8> owned_;
+        dp::Vector<IOPObjectRef> refs_;
+        dp::Vector<u32> index_; // object ID -> first ref with that ID
+        dp::Map<vt::ObjectID, dp::Vector<u8>> mutated_;
+        usize duplicates_ = 0;
+
+        friend class IOPParser;
+
+        void build_index() {
+            index_.assign(0x10000, NO_INDEX);
+            duplicates_ = 0;
+            for (u32 i = 0; i < refs_.size(); ++i) {
+                auto &slot = index_[refs_[i].id];
+                if (slot == NO_INDEX)
+                    slot = i;
+                else
+                    ++duplicates_;
+            }
+        }
+
+      public:
+        bool is_mapped() const noexcept { return mapping_ != nullptr; }
+        const u8 *data() const noexcept { return mapping_ ? mapping_->data() : owned_.data(); }
+        usize size() const noexcept { return mapping_ ? mapping_->size() : owned_.size(); }
+        DataSpan bytes() const noexcept { return DataSpan(data(), size()); }
+
+        const dp::Vector<IOPObjectRef> &objects() const noexcept { return refs_; }
+        usize object_count() const noexcept { return refs_.size() - duplicates_; }
+        usize duplicate_count() const noexcept { return duplicates_; }
+
+        // Index of the first ref with this ID, if any
+        dp::Optional<u32> index_of(vt::ObjectID id) const {
+            if (index_.empty() || index_[id] == NO_INDEX)
+                return dp::nullopt;
+            return index_[id];
+        }
+
+        bool contains(vt::ObjectID id) const { return index_of(id).has_value(); }
+
+        const IOPObjectRef *find(vt::ObjectID id) const {
+            auto idx = index_of(id);
+            return idx ? &refs_[*idx] : nullptr;
+        }
+
+        // Current body: the mutated copy if there is one, else the mapped range
+        DataSpan body(vt::ObjectID id) const {
+            auto m = mutated_.find(id);
+            if (m != mutated_.end())
+                return DataSpan(m->second);
+            auto *ref = find(id);
+            return ref ? DataSpan(data() + ref->body_offset, ref->body_length) : DataSpan{};
+        }
+
+        // Copy-on-write access; nullptr for unknown IDs
+        dp::Vector<u8> *mutable_body(vt::ObjectID id) {
+            auto m = mutated_.find(id);
+            if (m != mutated_.end())
+                return &m->second;
+            auto *ref = find(id);
+            if (!ref)
+                return nullptr;
+            const u8 *begin = data() + ref->body_offset;
+            return &(mutated_[id] = dp::Vector<u8>(begin, begin + ref->body_length));
+        }
+
+        bool is_mutated(vt::ObjectID id) const { return mutated_.find(id) != mutated_.end(); }
+        usize mutated_count() const noexcept { return mutated_.size(); }
+
+        // Materialize an ObjectPool (first object wins on duplicate IDs)
+        vt::ObjectPool to_pool() const {
+            vt::ObjectPool pool;
+            pool.reserve(object_count());
+            for (u32 i = 0; i < refs_.size(); ++i) {
+                const auto &ref = refs_[i];
+                if (index_[ref.id] != i)
+                    continue;
+                vt::VTObject obj;
+                obj.id = ref.id;
+                obj.type = ref.type;
+                auto span = body(ref.id);
+                obj.body = dp::Vector<u8>(span.data(), span.data() + span.size());
+                pool.add_unchecked(std::move(obj));
+            }
+            return pool;
+        }
+    };
+
     // ─── IOP (ISOBUS Object Pool) File Parser ───────────────────────────────────
     // Parses standard ISOBUS Object Pool binary files for loading VT object pools.
     // IOP files contain serialized VT objects per ISO 11783-6 Annex B.
@@ -51,49 +176,135 @@ namespace agrobus::net {
 
         // Parse object pool data into structured ObjectPool
         static Result<vt::ObjectPool> parse_iop_data(const dp::Vector<u8> &data) {
-            vt::ObjectPool pool;
-            usize offset = 0;
+            IOPImage image;
+            image.refs_ = index_iop(DataSpan(data));
+            image.build_index();
+            if (image.duplicates_ > 0)
+                echo::category("isobus.util.iop").warn("Skipped ", image.duplicates_, " duplicate object IDs");
 
-            while (offset + 7 <= data.size()) {
+            // Bodies are bulk-copied straight out of the caller's buffer
+            vt::ObjectPool pool;
+            pool.reserve(image.object_count());
+            for (u32 i = 0; i < image.refs_.size(); ++i) {
+                const auto &ref = image.refs_[i];
+                if (image.index_[ref.id] != i)
+                    continue;
                 vt::VTObject obj;
+                obj.id = ref.id;
+                obj.type = ref.type;
+                const u8 *begin = data.data() + ref.body_offset;
+                obj.body = dp::Vector<u8>(begin, begin + ref.body_length);
+                pool.add_unchecked(std::move(obj));
+            }
 
-                // Object ID (2 bytes, little-endian)
-                obj.id = static_cast<u16>(data[offset]) | (static_cast<u16>(data[offset + 1]) << 8);
-                offset += 2;
-
-                // Object type (1 byte)
-                obj.type = static_cast<vt::ObjectType>(data[offset]);
-                offset += 1;
-
-                // Width (2 bytes) + Height (2 bytes) stored as first 4 bytes of body
-                obj.body.push_back(data[offset]);
-                obj.body.push_back(data[offset + 1]);
-                offset += 2;
+            echo::category("isobus.util.iop").info("Parsed ", pool.size(), " objects from IOP data");
+            return Result<vt::ObjectPool>::ok(std::move(pool));
+        }
 
-                obj.body.push_back(data[offset]);
-                obj.body.push_back(data[offset + 1]);
-                offset += 2;
+        // Locate every object in IOP data without copying. Stops at a truncated
+        // object, like parse_iop_data.
+        static dp::Vector<IOPObjectRef> index_iop(DataSpan data) {
+            dp::Vector<IOPObjectRef> refs;
+            refs.reserve(data.size() / 16);
+            usize offset = 0;
+            while (offset + 7 <= data.size()) {
+                IOPObjectRef ref;
+                ref.id = static_cast<u16>(data[offset]) | (static_cast<u16>(data[offset + 1]) << 8);
+                ref.type = static_cast<vt::ObjectType>(data[offset + 2]);
+                usize body_offset = offset + 3;
+                offset += 7; // ID + type + width + height
 
-                // Object-specific data length depends on type
-                usize obj_data_len = get_object_data_length(obj.type, data, offset);
+                usize obj_data_len = get_object_data_length(ref.type, data, offset);
                 if (offset + obj_data_len > data.size()) {
-                    echo::category("isobus.util.iop").warn("Truncated object at offset ", offset, " id=", obj.id);
+                    echo::category("isobus.util.iop").warn("Truncated object at offset ", offset, " id=", ref.id);
                     break;
                 }
-
-                for (usize i = 0; i < obj_data_len; ++i) {
-                    obj.body.push_back(data[offset + i]);
-                }
                 offset += obj_data_len;
+                ref.body_offset = static_cast<u32>(body_offset);
+                ref.body_length = static_cast<u32>(offset - body_offset);
+                refs.push_back(ref);
+            }
+            return refs;
+        }
 
-                auto result = pool.add(std::move(obj));
-                if (!result.is_ok()) {
-                    echo::category("isobus.util.iop").warn("Duplicate object ID: ", obj.id);
-                }
+        // Load an IOP file as a zero-copy image. Maps the file when possible and
+        // falls back to a single bulk read (read_iop_file) otherwise.
+        static Result<IOPImage> load_iop_file(const dp::String &filepath, bool allow_mmap = true) {
+            IOPImage image;
+            if (allow_mmap)
+                image.mapping_ = MappedFile::open(filepath.c_str());
+            if (image.mapping_) {
+                image.mapping_->advise_sequential();
+                echo::category("isobus.util.iop")
+                    .info("Mapped IOP file: ", filepath, " (", image.mapping_->size(), " bytes)");
+            } else {
+                auto read = read_iop_file(filepath);
+                if (!read.is_ok())
+                    return Result<IOPImage>::err(read.error());
+                image.owned_ = std::move(read.value());
             }
+            image.refs_ = index_iop(image.bytes());
+            image.build_index();
+            return Result<IOPImage>::ok(std::move(image));
+        }
 
-            echo::category("isobus.util.iop").info("Parsed ", pool.size(), " objects from IOP data");
-            return Result<vt::ObjectPool>::ok(std::move(pool));
+        // Index IOP bytes already in memory; the image takes ownership
+        static IOPImage load_iop_data(dp::Vector<u8> data) {
+            IOPImage image;
+            image.owned_ = std::move(data);
+            image.refs_ = index_iop(image.bytes());
+            image.build_index();
+            return image;
+        }
+
+        // ─── Structural validation ────────────────────────────────────────────────
+        // Checks every object in the image: known object type, unique ID, and that
+        // mask references (Working Set active mask, soft key masks of data and alarm
+        // masks) point at objects of the right type; plus exactly one Working Set.
+        // Large pools are split into contiguous chunks checked on worker threads
+        // against the read-only ID index. The reported error is the one for the
+        // lowest object index, so the result does not depend on the thread count.
+        static Result<void> validate_structure(const IOPImage &image, IOPValidateOptions options = {}) {
+            const auto &refs = image.objects();
+            usize n = refs.size();
+            u32 threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+            if (threads == 0)
+                threads = 1;
+            if (n < options.parallel_threshold || threads == 1)
+                threads = 1;
+            if (threads > n)
+                threads = n ? static_cast<u32>(n) : 1;
+
+            dp::Vector<ChunkResult> results(threads);
+            usize per = (n + threads - 1) / threads;
+            auto run = [&](u32 t) {
+                usize begin = t * per;
+                usize end = begin + per < n ? begin + per : n;
+                results[t] = validate_chunk(image, begin, end);
+            };
+
+            if (threads == 1) {
+                run(0);
+            } else {
+                dp::Vector<std::thread> workers;
+                workers.reserve(threads - 1);
+                for (u32 t = 1; t < threads; ++t)
+                    workers.emplace_back(run, t);
+                run(0);
+                for (auto &w : workers)
+                    w.join();
+            }
+
+            u32 working_sets = 0;
+            for (const auto &r : results) {
+                if (r.error_index != NO_ERROR)
+                    return Result<void>::err(Error(ErrorCode::PoolValidation, r.error));
+                working_sets += r.working_sets;
+            }
+            if (working_sets != 1)
+                return Result<void>::err(
+                    Error(ErrorCode::PoolValidation, "pool must contain exactly one Working Set object"));
+            return {};
         }
 
         // Generate a version hash string from object pool data
@@ -142,8 +353,75 @@ namespace agrobus::net {
         }
 
       private:
+        static constexpr usize NO_ERROR = static_cast<usize>(-1);
+
+        struct ChunkResult {
+            usize error_index = NO_ERROR;
+            dp::String error;
+            u32 working_sets = 0;
+        };
+
+        static u16 body_u16(DataSpan body, usize at) {
+            return static_cast<u16>(body[at]) | (static_cast<u16>(body[at + 1]) << 8);
+        }
+
+        // Objects are visited in order, so the first error found is the chunk's lowest
+        static ChunkResult validate_chunk(const IOPImage &image, usize begin, usize end) {
+            ChunkResult result;
+            const auto &refs = image.objects();
+            auto fail = [&](usize i, const dp::String &msg) {
+                result.error_index = i;
+                result.error = "object " + dp::String(std::to_string(refs[i].id)) + ": " + msg;
+            };
+            auto type_of = [&](vt::ObjectID id) -> dp::Optional<vt::ObjectType> {
+                auto *ref = image.find(id);
+                if (!ref)
+                    return dp::nullopt;
+                return ref->type;
+            };
+
+            for (usize i = begin; i < end; ++i) {
+                const auto &ref = refs[i];
+                if (static_cast<u8>(ref.type) > static_cast<u8>(vt::ObjectType::ScaledBitmap)) {
+                    fail(i, "unknown object type " + dp::String(std::to_string(static_cast<u8>(ref.type))));
+                    return result;
+                }
+                if (*image.index_of(ref.id) != i) {
+                    fail(i, "duplicate object ID");
+                    return result;
+                }
+                DataSpan body(image.data() + ref.body_offset, ref.body_length);
+                switch (ref.type) {
+                case vt::ObjectType::WorkingSet: {
+                    ++result.working_sets;
+                    auto mask = type_of(body_u16(body, 6));
+                    if (!mask || (*mask != vt::ObjectType::DataMask && *mask != vt::ObjectType::AlarmMask)) {
+                        fail(i, "active mask is not a Data Mask or Alarm Mask");
+                        return result;
+                    }
+                    break;
+                }
+                case vt::ObjectType::DataMask:
+                case vt::ObjectType::AlarmMask: {
+                    vt::ObjectID sk = body_u16(body, 5);
+                    if (sk == 0xFFFF)
+                        break;
+                    auto sk_type = type_of(sk);
+                    if (!sk_type || *sk_type != vt::ObjectType::SoftKeyMask) {
+                        fail(i, "soft key mask reference is not a Soft Key Mask");
+                        return result;
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+            return result;
+        }
+
         // Estimate object-specific data length based on type
-        static usize get_object_data_length(vt::ObjectType type, const dp::Vector<u8> &data, usize offset) {
+        static usize get_object_data_length(vt::ObjectType type, DataSpan data, usize offset) {
             switch (type) {
             case vt::ObjectType::WorkingSet:
                 return 4; // background_color(1) + selectable(1) + active_mask(2)
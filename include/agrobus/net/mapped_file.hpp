@@ -0,0 +1,72 @@
+#pragma once
+
+#include <agrobus/net/data_span.hpp>
+#include <agrobus/net/types.hpp>
+#include <algorithm>
+#include <fcntl.h>
+#include <filesystem>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace agrobus::net {
+
+    // ─── Read-only memory-mapped file ────────────────────────────────────────────
+    // Shared ownership: views keep the mapping alive after the producer drops it.
+    class MappedFile {
+        void *addr_ = nullptr;
+        usize size_ = 0;
+
+      public:
+        MappedFile() = default;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        ~MappedFile() {
+            if (addr_)
+                ::munmap(addr_, size_);
+        }
+
+        // Returns nullptr for missing, empty or unmappable files
+        static std::shared_ptr<MappedFile> open(const std::filesystem::path &path) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return nullptr;
+            struct stat st {};
+            if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+                ::close(fd);
+                return nullptr;
+            }
+            void *addr = ::mmap(nullptr, static_cast<usize>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd); // the mapping keeps the file alive
+            if (addr == MAP_FAILED)
+                return nullptr;
+            auto file = std::make_shared<MappedFile>();
+            file->addr_ = addr;
+            file->size_ = static_cast<usize>(st.st_size);
+            return file;
+        }
+
+        const u8 *data() const noexcept { return static_cast<const u8 *>(addr_); }
+        usize size() const noexcept { return size_; }
+        DataSpan span() const noexcept { return DataSpan(data(), size_); }
+
+        // Tell the kernel the file will be read front to back: aggressive
+        // read-ahead, pages behind the reader dropped first. Advice values are
+        // not flags, so this does not also prefetch the whole file.
+        void advise_sequential() const noexcept {
+            if (addr_)
+                ::madvise(addr_, size_, MADV_SEQUENTIAL);
+        }
+
+        // Drop the resident pages of a range; later access faults them back in
+        void release(usize offset, usize length) const noexcept {
+            static const usize page = static_cast<usize>(::sysconf(_SC_PAGESIZE));
+            usize begin = (offset + page - 1) / page * page;
+            usize end = std::min(offset + length, size_) / page * page;
+            if (addr_ && end > begin)
+                ::madvise(static_cast<u8 *>(addr_) + begin, end - begin, MADV_DONTNEED);
+        }
+    };
+
+} // namespace agrobus::net
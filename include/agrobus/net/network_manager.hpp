@@ -190,6 +190,30 @@ namespace agrobus::net {
             return send_frames(result.value(), source->port());
         }
 
+        // Multi-frame TP/ETP transfers keep a reference to the payload rather than
+        // copying it, so a caller that retains the buffer (e.g. a response cache)
+        // shares one copy with the transport session
+        Result<void> send(PGN pgn, SharedPayload data, InternalCF *source, ControlFunction *dest = nullptr,
+                          Priority priority = Priority::Default) {
+            if (!data)
+                return Result<void>::err(Error::invalid_data("null payload"));
+            Address dst_addr = dest ? dest->address : BROADCAST_ADDRESS;
+            bool fast_packet = is_fast_packet_pgn(pgn) && data->size() <= FAST_PACKET_MAX_DATA;
+            if (!source || !source->cf().address_valid() || data->size() <= CAN_DATA_LENGTH || fast_packet ||
+                (data->size() > TP_MAX_DATA_LENGTH && dst_addr == BROADCAST_ADDRESS)) {
+                return send(pgn, *data, source, dest, priority);
+            }
+
+            Address src_addr = source->address();
+            auto result = data->size() <= TP_MAX_DATA_LENGTH
+                              ? tp_.send(pgn, std::move(data), src_addr, dst_addr, source->port(), priority)
+                              : etp_.send(pgn, std::move(data), src_addr, dst_addr, source->port(), priority);
+            if (!result.is_ok()) {
+                return Result<void>::err(result.error());
+            }
+            return send_frames(result.value(), source->port());
+        }
+
         Result<void> send_frame(const Frame &frame) { return send_frame(frame, 0); }
 
         Result<void> send_frame(const Frame &frame, u8 port) {
@@ -283,6 +307,12 @@ namespace agrobus::net {
         ExtendedTransportProtocol &extended_transport_protocol() noexcept { return etp_; }
         FastPacketProtocol &fast_packet_protocol() noexcept { return fast_packet_; }
 
+        // A multi-frame send of this PGN to dest has not finished yet; another
+        // send() to the same destination would be rejected with SessionExists
+        bool transport_busy(PGN pgn, Address source, Address dest) const {
+            return tp_.transmitting(pgn, source, dest) || etp_.transmitting(pgn, source, dest);
+        }
+
         // ─── Diagnostics ─────────────────────────────────────────────────────────
         f32 bus_load(u8 port) const noexcept {
             auto it = bus_loads_.find(port);
@@ -42,6 +42,7 @@ namespace agrobus::net {
         SessionState state = SessionState::None;
         PGN pgn = 0;
         dp::Vector<u8> data;
+        SharedPayload shared_data; // transmit payload held by reference instead of in data
         u32 total_bytes = 0;
         u32 bytes_transferred = 0;
         u8 source_address = NULL_ADDRESS;
@@ -65,6 +66,8 @@ namespace agrobus::net {
         // Timing
         u32 timer_ms = 0;
 
+        const dp::Vector<u8> &payload() const noexcept { return shared_data ? *shared_data : data; }
+
         f32 progress() const noexcept {
             if (total_bytes == 0)
                 return 0.0f;
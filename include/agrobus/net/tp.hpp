@@ -68,51 +68,17 @@ namespace agrobus::net {
         // ─── Initiate a send ─────────────────────────────────────────────────────
         Result<dp::Vector<Frame>> send(PGN pgn, const dp::Vector<u8> &data, Address source, Address dest, u8 port = 0,
                                        Priority priority = Priority::Lowest) {
-            if (data.size() > MAX_DATA_LENGTH) {
-                echo::category("isobus.transport.tp")
-                    .error("data exceeds TP max: size=", data.size(), " max=", MAX_DATA_LENGTH);
-                return Result<dp::Vector<Frame>>::err(Error(ErrorCode::BufferOverflow, "data exceeds TP max"));
-            }
-            if (data.size() <= CAN_DATA_LENGTH) {
-                return Result<dp::Vector<Frame>>::err(Error::invalid_state("use single frame for <= 8 bytes"));
-            }
-
-            // Check for existing session - key by (src, dst, pgn, direction, port)
-            for (const auto &s : sessions_) {
-                if (s.source_address == source && s.destination_address == dest && s.pgn == pgn &&
-                    s.direction == TransportDirection::Transmit && s.can_port == port) {
-                    echo::category("isobus.transport.tp")
-                        .error("session already active: pgn=", pgn, " src=", static_cast<u8>(source),
-                               " dst=", static_cast<u8>(dest));
-                    return Result<dp::Vector<Frame>>::err(Error(ErrorCode::SessionExists, "session already active"));
-                }
-            }
-
-            dp::Vector<Frame> frames;
-            TransportSession session;
-            session.direction = TransportDirection::Transmit;
-            session.pgn = pgn;
-            session.data = data;
-            session.total_bytes = static_cast<u32>(data.size());
-            session.source_address = source;
-            session.destination_address = dest;
-            session.can_port = port;
-            session.priority = priority;
-
-            if (dest == BROADCAST_ADDRESS) {
-                // BAM mode
-                session.state = SessionState::SendingData;
-                frames.push_back(make_bam(session));
-                echo::category("isobus.transport.tp").debug("BAM started: pgn=", pgn, " bytes=", data.size());
-            } else {
-                // Connection mode - send RTS
-                session.state = SessionState::WaitingForCTS;
-                frames.push_back(make_rts(session));
-                echo::category("isobus.transport.tp").debug("RTS sent: pgn=", pgn, " bytes=", data.size());
-            }
+            return start_send(pgn, data, nullptr, source, dest, port, priority);
+        }
 
-            sessions_.push_back(std::move(session));
-            return Result<dp::Vector<Frame>>::ok(std::move(frames));
+        // Same as above, but the data frames are read from the caller's buffer
+        // instead of a copy held by the session
+        Result<dp::Vector<Frame>> send(PGN pgn, SharedPayload data, Address source, Address dest, u8 port = 0,
+                                       Priority priority = Priority::Lowest) {
+            if (!data)
+                return Result<dp::Vector<Frame>>::err(Error::invalid_data("null payload"));
+            const auto &bytes = *data;
+            return start_send(pgn, bytes, std::move(data), source, dest, port, priority);
         }
 
         // ─── Process incoming frame ──────────────────────────────────────────────
@@ -220,6 +186,15 @@ namespace agrobus::net {
             return frames;
         }
 
+        // True while a send of this PGN from source to dest is still in progress
+        bool transmitting(PGN pgn, Address source, Address dest) const {
+            for (const auto &s : sessions_)
+                if (s.source_address == source && s.destination_address == dest && s.pgn == pgn &&
+                    s.direction == TransportDirection::Transmit)
+                    return true;
+            return false;
+        }
+
         dp::Vector<TransportSession *> active_sessions() {
             dp::Vector<TransportSession *> result;
             for (auto &s : sessions_)
@@ -361,6 +336,58 @@ namespace agrobus::net {
         Event<TPTimerSession &> on_session_timeout;
 
       private:
+        Result<dp::Vector<Frame>> start_send(PGN pgn, const dp::Vector<u8> &data, SharedPayload shared, Address source,
+                                             Address dest, u8 port, Priority priority) {
+            if (data.size() > MAX_DATA_LENGTH) {
+                echo::category("isobus.transport.tp")
+                    .error("data exceeds TP max: size=", data.size(), " max=", MAX_DATA_LENGTH);
+                return Result<dp::Vector<Frame>>::err(Error(ErrorCode::BufferOverflow, "data exceeds TP max"));
+            }
+            if (data.size() <= CAN_DATA_LENGTH) {
+                return Result<dp::Vector<Frame>>::err(Error::invalid_state("use single frame for <= 8 bytes"));
+            }
+
+            // Check for existing session - key by (src, dst, pgn, direction, port)
+            for (const auto &s : sessions_) {
+                if (s.source_address == source && s.destination_address == dest && s.pgn == pgn &&
+                    s.direction == TransportDirection::Transmit && s.can_port == port) {
+                    echo::category("isobus.transport.tp")
+                        .error("session already active: pgn=", pgn, " src=", static_cast<u8>(source),
+                               " dst=", static_cast<u8>(dest));
+                    return Result<dp::Vector<Frame>>::err(Error(ErrorCode::SessionExists, "session already active"));
+                }
+            }
+
+            dp::Vector<Frame> frames;
+            TransportSession session;
+            session.direction = TransportDirection::Transmit;
+            session.pgn = pgn;
+            if (shared)
+                session.shared_data = std::move(shared);
+            else
+                session.data = data;
+            session.total_bytes = static_cast<u32>(data.size());
+            session.source_address = source;
+            session.destination_address = dest;
+            session.can_port = port;
+            session.priority = priority;
+
+            if (dest == BROADCAST_ADDRESS) {
+                // BAM mode
+                session.state = SessionState::SendingData;
+                frames.push_back(make_bam(session));
+                echo::category("isobus.transport.tp").debug("BAM started: pgn=", pgn, " bytes=", data.size());
+            } else {
+                // Connection mode - send RTS
+                session.state = SessionState::WaitingForCTS;
+                frames.push_back(make_rts(session));
+                echo::category("isobus.transport.tp").debug("RTS sent: pgn=", pgn, " bytes=", data.size());
+            }
+
+            sessions_.push_back(std::move(session));
+            return Result<dp::Vector<Frame>>::ok(std::move(frames));
+        }
+
         Frame make_bam(const TransportSession &s) const noexcept {
             Frame f;
             f.id = Identifier::encode(Priority::Lowest, PGN_TP_CM, s.source_address, BROADCAST_ADDRESS);
@@ -447,7 +474,7 @@ namespace agrobus::net {
 
                 for (u8 j = 0; j < 7; ++j) {
                     u32 idx = session.bytes_transferred + j;
-                    f.data[j + 1] = (idx < session.total_bytes) ? session.data[idx] : 0xFF;
+                    f.data[j + 1] = (idx < session.total_bytes) ? session.payload()[idx] : 0xFF;
                 }
                 f.length = 8;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <datapod/datapod.hpp>
+#include <memory>
 
 namespace agrobus::net {
 
@@ -28,6 +29,9 @@ namespace agrobus::net {
     using Address = u8;
     using PGN = u32;
 
+    // Message payload owned jointly by its sender and the transport session
+    using SharedPayload = std::shared_ptr<const dp::Vector<u8>>;
+
     // ─── Priority (3-bit field in CAN identifier) ────────────────────────────────
     enum class Priority : u8 {
         Highest = 0,
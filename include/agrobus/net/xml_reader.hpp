@@ -0,0 +1,247 @@
+#pragma once
+
+#include <agrobus/net/types.hpp>
+#include <charconv>
+#include <cstring>
+#include <datapod/datapod.hpp>
+#include <string_view>
+
+namespace agrobus::net {
+
+    struct XmlAttribute {
+        std::string_view name;
+        std::string_view value; // raw, entities not decoded
+    };
+
+    // ─── Streaming XML reader ────────────────────────────────────────────────────
+    // Pull parser over an in-memory (typically memory-mapped) document. Element
+    // names and attribute values are views into the buffer, so reading a
+    // document allocates nothing beyond the reused attribute list. Text content,
+    // comments, processing instructions, CDATA and DOCTYPE are skipped: enough
+    // for attribute-only formats such as ISO 11783-10 TASKDATA.
+    class XmlReader {
+      public:
+        enum class Event : u8 { Start, End, Eof, Error };
+
+      private:
+        const char *p_;
+        const char *end_;
+        const char *begin_;
+        std::string_view name_;
+        dp::Vector<XmlAttribute> attrs_;
+        usize depth_ = 0;
+        bool pending_end_ = false; // self-closing element: End follows Start
+        const char *error_ = nullptr;
+
+        static bool is_space(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+        static bool is_name_end(char c) noexcept { return is_space(c) || c == '>' || c == '/' || c == '='; }
+
+        Event fail(const char *msg) {
+            error_ = msg;
+            return Event::Error;
+        }
+
+        bool skip_past(std::string_view terminator) {
+            for (; p_ + terminator.size() <= end_; ++p_) {
+                if (std::memcmp(p_, terminator.data(), terminator.size()) == 0) {
+                    p_ += terminator.size();
+                    return true;
+                }
+            }
+            p_ = end_;
+            return false;
+        }
+
+      public:
+        XmlReader(const char *data, usize size) : p_(data), end_(data + size), begin_(data) { attrs_.reserve(16); }
+        explicit XmlReader(std::string_view doc) : XmlReader(doc.data(), doc.size()) {}
+
+        Event next() {
+            if (pending_end_) {
+                pending_end_ = false;
+                --depth_;
+                attrs_.clear();
+                return Event::End;
+            }
+            for (;;) {
+                // Skip text up to the next tag
+                const char *lt = static_cast<const char *>(std::memchr(p_, '<', static_cast<usize>(end_ - p_)));
+                if (!lt) {
+                    p_ = end_;
+                    return depth_ == 0 ? Event::Eof : fail("unexpected end of document");
+                }
+                p_ = lt + 1;
+                if (p_ >= end_)
+                    return fail("unexpected end of document");
+
+                if (*p_ == '?') {
+                    if (!skip_past("?>"))
+                        return fail("unterminated processing instruction");
+                    continue;
+                }
+                if (*p_ == '!') {
+                    bool ok = (end_ - p_ >= 3 && p_[1] == '-' && p_[2] == '-') ? skip_past("-->")
+                              : (end_ - p_ >= 8 && std::memcmp(p_, "![CDATA[", 8) == 0) ? skip_past("]]>")
+                                                                                       : skip_past(">");
+                    if (!ok)
+                        return fail("unterminated markup declaration");
+                    continue;
+                }
+                if (*p_ == '/') {
+                    const char *start = ++p_;
+                    while (p_ < end_ && !is_name_end(*p_))
+                        ++p_;
+                    name_ = std::string_view(start, static_cast<usize>(p_ - start));
+                    if (!skip_past(">"))
+                        return fail("unterminated end tag");
+                    if (depth_ == 0)
+                        return fail("unbalanced end tag");
+                    --depth_;
+                    attrs_.clear();
+                    return Event::End;
+                }
+                return read_start();
+            }
+        }
+
+        std::string_view name() const noexcept { return name_; }
+        const dp::Vector<XmlAttribute> &attributes() const noexcept { return attrs_; }
+        usize depth() const noexcept { return depth_; }
+        usize offset() const noexcept { return static_cast<usize>(p_ - begin_); }
+        const char *error() const noexcept { return error_; }
+
+        // Raw value of an attribute of the current start element, empty if absent
+        std::string_view attr(std::string_view name) const noexcept {
+            for (const auto &a : attrs_)
+                if (a.name == name)
+                    return a.value;
+            return {};
+        }
+        bool has_attr(std::string_view name) const noexcept {
+            for (const auto &a : attrs_)
+                if (a.name == name)
+                    return true;
+            return false;
+        }
+
+        // ─── Value helpers ───────────────────────────────────────────────────────
+        static dp::String unescape(std::string_view raw) {
+            dp::String out;
+            out.reserve(raw.size());
+            for (usize i = 0; i < raw.size(); ++i) {
+                if (raw[i] != '&') {
+                    out += raw[i];
+                    continue;
+                }
+                usize semi = raw.find(';', i);
+                if (semi == std::string_view::npos) {
+                    out += raw[i];
+                    continue;
+                }
+                std::string_view ent = raw.substr(i + 1, semi - i - 1);
+                if (ent == "amp")
+                    out += '&';
+                else if (ent == "lt")
+                    out += '<';
+                else if (ent == "gt")
+                    out += '>';
+                else if (ent == "quot")
+                    out += '"';
+                else if (ent == "apos")
+                    out += '\'';
+                else if (!ent.empty() && ent[0] == '#') {
+                    u32 code = 0;
+                    bool hex = ent.size() > 1 && (ent[1] == 'x' || ent[1] == 'X');
+                    std::from_chars(ent.data() + (hex ? 2 : 1), ent.data() + ent.size(), code, hex ? 16 : 10);
+                    if (code < 0x80) {
+                        out += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        out += static_cast<char>(0xC0 | (code >> 6));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        out += static_cast<char>(0xE0 | (code >> 12));
+                        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                } else {
+                    out.append(raw.data() + i, semi - i + 1);
+                }
+                i = semi;
+            }
+            return out;
+        }
+
+        template <typename T> static dp::Optional<T> to_int(std::string_view s, int base = 10) {
+            T v{};
+            if (s.empty())
+                return dp::nullopt;
+            auto r = std::from_chars(s.data(), s.data() + s.size(), v, base);
+            if (r.ec != std::errc{})
+                return dp::nullopt;
+            return v;
+        }
+
+        static dp::Optional<f64> to_f64(std::string_view s) {
+            f64 v = 0.0;
+            if (s.empty())
+                return dp::nullopt;
+            auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+            if (r.ec != std::errc{})
+                return dp::nullopt;
+            return v;
+        }
+
+      private:
+        Event read_start() {
+            const char *start = p_;
+            while (p_ < end_ && !is_name_end(*p_))
+                ++p_;
+            if (p_ == start)
+                return fail("empty element name");
+            name_ = std::string_view(start, static_cast<usize>(p_ - start));
+            attrs_.clear();
+
+            for (;;) {
+                while (p_ < end_ && is_space(*p_))
+                    ++p_;
+                if (p_ >= end_)
+                    return fail("unterminated start tag");
+                if (*p_ == '>') {
+                    ++p_;
+                    ++depth_;
+                    return Event::Start;
+                }
+                if (*p_ == '/') {
+                    if (p_ + 1 >= end_ || p_[1] != '>')
+                        return fail("malformed empty element");
+                    p_ += 2;
+                    ++depth_;
+                    pending_end_ = true;
+                    return Event::Start;
+                }
+
+                const char *an = p_;
+                while (p_ < end_ && !is_name_end(*p_))
+                    ++p_;
+                std::string_view attr_name(an, static_cast<usize>(p_ - an));
+                while (p_ < end_ && is_space(*p_))
+                    ++p_;
+                if (p_ >= end_ || *p_ != '=' || attr_name.empty())
+                    return fail("malformed attribute");
+                ++p_;
+                while (p_ < end_ && is_space(*p_))
+                    ++p_;
+                if (p_ >= end_ || (*p_ != '"' && *p_ != '\''))
+                    return fail("unquoted attribute value");
+                char quote = *p_++;
+                const char *vs = p_;
+                const char *ve = static_cast<const char *>(std::memchr(p_, quote, static_cast<usize>(end_ - p_)));
+                if (!ve)
+                    return fail("unterminated attribute value");
+                attrs_.push_back({attr_name, std::string_view(vs, static_cast<usize>(ve - vs))});
+                p_ = ve + 1;
+            }
+        }
+    };
+
+} // namespace agrobus::net
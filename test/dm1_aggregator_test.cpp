@@ -0,0 +1,157 @@
+#include <doctest/doctest.h>
+#include <agrobus/j1939/dm1_aggregator.hpp>
+
+using namespace agrobus::j1939;
+
+static dp::Vector<u8> dm1(const DiagnosticLamps &lamps, const dp::Vector<DTC> &dtcs) {
+    auto lamp_bytes = lamps.encode();
+    dp::Vector<u8> data{lamp_bytes[0], lamp_bytes[1]};
+    for (const auto &dtc : dtcs) {
+        auto bytes = dtc.encode();
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+    if (dtcs.empty())
+        data.insert(data.end(), {0, 0, 0, 0});
+    data.resize(std::max<usize>(data.size(), 8), 0xFF);
+    return data;
+}
+
+static DiagnosticLamps amber() {
+    DiagnosticLamps lamps;
+    lamps.amber_warning = LampStatus::On;
+    return lamps;
+}
+
+static DiagnosticLamps red() {
+    DiagnosticLamps lamps;
+    lamps.red_stop = LampStatus::On;
+    return lamps;
+}
+
+struct Recorder {
+    dp::Vector<FleetDTC> added, removed, changed;
+    dp::Vector<u8> previous_counts;
+    usize lamp_events = 0;
+
+    explicit Recorder(DM1Aggregator &agg) {
+        agg.on_dtc_added.subscribe([this](const FleetDTC &d) { added.push_back(d); });
+        agg.on_dtc_removed.subscribe([this](const FleetDTC &d) { removed.push_back(d); });
+        agg.on_occurrence_changed.subscribe([this](const FleetDTC &d, u8 before) {
+            changed.push_back(d);
+            previous_counts.push_back(before);
+        });
+        agg.on_lamps_changed.subscribe([this](Address, const DiagnosticLamps &) { ++lamp_events; });
+    }
+};
+
+TEST_CASE("DM1Aggregator - only differences are reported") {
+    IsoNet nm;
+    DM1Aggregator agg;
+    REQUIRE(agg.attach(nm).is_ok());
+    Recorder rec(agg);
+
+    auto send = [&](Address source, const DiagnosticLamps &lamps, const dp::Vector<DTC> &dtcs) {
+        nm.inject_message(Message(PGN_DM1, dm1(lamps, dtcs), source));
+    };
+
+    send(0x00, amber(), {{100, FMI::VoltageLow, 1}, {200, FMI::VoltageHigh, 2}});
+    CHECK(rec.added.size() == 2);
+    CHECK(rec.lamp_events == 1);
+
+    // The same DM1 every second is not decoded again
+    for (u32 i = 0; i < 10; ++i)
+        send(0x00, amber(), {{100, FMI::VoltageLow, 1}, {200, FMI::VoltageHigh, 2}});
+    CHECK(agg.stats().messages == 11);
+    CHECK(agg.stats().unchanged == 10);
+    CHECK(agg.stats().decoded == 1);
+    CHECK(rec.added.size() == 2);
+
+    // Order within the message does not matter; a count change does
+    send(0x00, amber(), {{200, FMI::VoltageHigh, 3}, {100, FMI::VoltageLow, 1}});
+    CHECK(rec.added.size() == 2);
+    REQUIRE(rec.changed.size() == 1);
+    CHECK(rec.changed[0].dtc.spn == 200);
+    CHECK(rec.changed[0].dtc.occurrence_count == 3);
+    CHECK(rec.previous_counts[0] == 2);
+    CHECK(rec.lamp_events == 1);
+
+    // One DTC goes away, another appears
+    send(0x00, amber(), {{200, FMI::VoltageHigh, 3}, {300, FMI::Erratic, 1}});
+    REQUIRE(rec.removed.size() == 1);
+    CHECK(rec.removed[0].dtc.spn == 100);
+    CHECK(rec.added.size() == 3);
+    CHECK(rec.added.back().dtc.spn == 300);
+
+    // No DTCs: everything from that source is removed
+    send(0x00, DiagnosticLamps{}, {});
+    CHECK(rec.removed.size() == 3);
+    CHECK(agg.active_dtcs().empty());
+    CHECK(rec.lamp_events == 2);
+}
+
+TEST_CASE("DM1Aggregator - global view by severity and lamp") {
+    DM1Aggregator agg;
+    auto ingest = [&](Address source, const DiagnosticLamps &lamps, const dp::Vector<DTC> &dtcs) {
+        auto data = dm1(lamps, dtcs);
+        agg.ingest(source, data.data(), data.size());
+    };
+
+    ingest(0x10, amber(), {{520, FMI::Erratic, 1}, {510, FMI::BadDevice, 1}});
+    ingest(0x00, red(), {{110, FMI::AboveNormal, 4}});
+    ingest(0x20, DiagnosticLamps{}, {{900, FMI::CurrentLow, 1}});
+
+    const auto &all = agg.active_dtcs();
+    REQUIRE(all.size() == 4);
+    CHECK(all[0].severity == DTCSeverity::Stop);
+    CHECK(all[0].source == 0x00);
+    CHECK(all[1].dtc.spn == 510); // same source, by SPN
+    CHECK(all[2].dtc.spn == 520);
+    CHECK(all[3].severity == DTCSeverity::Info);
+    CHECK(agg.count(DTCSeverity::Warning) == 2);
+    CHECK(agg.count(DTCSeverity::Malfunction) == 0);
+    CHECK(agg.active_dtcs(DTCSeverity::Stop).size() == 1);
+
+    auto lamps = agg.lamps();
+    CHECK(lamps.red_stop == LampStatus::On);
+    CHECK(lamps.amber_warning == LampStatus::On);
+    CHECK(lamps.malfunction == LampStatus::Off);
+
+    // A lamp change re-rates the source's DTCs without add/remove events
+    Recorder rec(agg);
+    ingest(0x10, red(), {{520, FMI::Erratic, 1}, {510, FMI::BadDevice, 1}});
+    CHECK(rec.added.empty());
+    CHECK(rec.removed.empty());
+    CHECK(rec.lamp_events == 1);
+    CHECK(agg.count(DTCSeverity::Stop) == 3);
+    CHECK(agg.count(DTCSeverity::Warning) == 0);
+
+    REQUIRE(agg.source_dtcs(0x10) != nullptr);
+    CHECK(agg.source_dtcs(0x10)->size() == 2);
+    CHECK(agg.source_dtcs(0x55) == nullptr);
+}
+
+TEST_CASE("DM1Aggregator - silent sources time out") {
+    DM1Aggregator agg(DM1AggregatorConfig{}.timeout(3000));
+    Recorder rec(agg);
+    Address lost = NULL_ADDRESS;
+    agg.on_source_lost.subscribe([&](Address a) { lost = a; });
+
+    auto a = dm1(amber(), {{100, FMI::VoltageLow, 1}});
+    auto b = dm1(amber(), {{200, FMI::VoltageLow, 1}, {201, FMI::VoltageLow, 1}});
+    for (u32 t = 0; t < 5; ++t) {
+        agg.ingest(0x01, a.data(), a.size());
+        if (t < 2)
+            agg.ingest(0x02, b.data(), b.size());
+        agg.update(1000);
+    }
+    CHECK(lost == 0x02);
+    CHECK(agg.source_count() == 1);
+    CHECK(rec.removed.size() == 2);
+    CHECK(agg.active_dtcs().size() == 1);
+    CHECK(agg.stats().timeouts == 1);
+
+    // Coming back is a fresh source
+    agg.ingest(0x02, b.data(), b.size());
+    CHECK(rec.added.size() == 5);
+    CHECK(agg.active_dtcs().size() == 3);
+}
@@ -0,0 +1,214 @@
+#include <doctest/doctest.h>
+#include <agrobus/j1939/dtc_journal.hpp>
+#include <filesystem>
+
+using namespace agrobus::j1939;
+
+struct DiagNode {
+    IsoNet nm;
+    DiagnosticProtocol diag;
+
+    explicit DiagNode(DiagnosticConfig config = {})
+        : diag(nm, nm.create_internal(Name{}, 0, 0x28).value(), config) {}
+};
+
+TEST_CASE("DTCJournal - state survives a restart") {
+    MemoryNvm nvm;
+    {
+        DTCJournal journal(nvm, DTCJournalConfig{}.background(false));
+        DiagNode node;
+        REQUIRE(node.diag.attach_store(journal).is_ok());
+
+        node.diag.set_active({100, FMI::VoltageLow, 0});
+        node.diag.set_active({100, FMI::VoltageLow, 0});
+        node.diag.set_active({200, FMI::VoltageHigh, 0});
+        node.diag.set_active({300, FMI::Erratic, 0});
+        node.diag.clear_active(200, FMI::VoltageHigh);
+        node.diag.capture_freeze_frame({300, FMI::Erratic, 1}, {{190, 1500}, {110, 85}}, 4242);
+        CHECK(journal.stats().records_written > 0);
+    }
+
+    DTCJournal journal(nvm, DTCJournalConfig{}.background(false));
+    DiagNode node;
+    REQUIRE(node.diag.attach_store(journal).is_ok());
+    CHECK(journal.stats().discarded_bytes == 0);
+
+    REQUIRE(node.diag.active_dtcs().size() == 2);
+    CHECK(node.diag.active_dtcs()[0].spn == 100);
+    CHECK(node.diag.active_dtcs()[0].occurrence_count == 2);
+    CHECK(node.diag.active_dtcs()[1].spn == 300);
+    REQUIRE(node.diag.previous_dtcs().size() == 1);
+    CHECK(node.diag.previous_dtcs()[0].spn == 200);
+    REQUIRE(node.diag.previously_active_dtcs().size() == 1);
+    CHECK(node.diag.previously_active_dtcs()[0].dtc.spn == 200);
+
+    auto ff = node.diag.get_freeze_frame(300, FMI::Erratic);
+    REQUIRE(ff.has_value());
+    CHECK(ff->timestamp_ms == 4242);
+    REQUIRE(ff->snapshots.size() == 2);
+    CHECK(ff->snapshots[0].value == 1500);
+
+    // Changes after the restart keep appending to the same journal
+    node.diag.clear_all_active();
+    DTCJournal again(nvm, DTCJournalConfig{}.background(false));
+    DiagNode restarted;
+    REQUIRE(restarted.diag.attach_store(again).is_ok());
+    CHECK(restarted.diag.active_dtcs().empty());
+    CHECK(restarted.diag.previous_dtcs().size() == 3);
+}
+
+TEST_CASE("DTCJournal - torn and corrupt tails are cut off") {
+    MemoryNvm nvm;
+    usize intact = 0;
+    {
+        DTCJournal journal(nvm, DTCJournalConfig{}.background(false));
+        DiagNode node(DiagnosticConfig{}.auto_capture_freeze_frames_enabled(false));
+        REQUIRE(node.diag.attach_store(journal).is_ok());
+        node.diag.set_active({100, FMI::VoltageLow, 0});
+        node.diag.set_active({200, FMI::VoltageHigh, 0});
+        intact = nvm.image().size();
+        node.diag.set_active({300, FMI::Erratic, 0});
+    }
+
+    SUBCASE("power lost mid-record") {
+        nvm.image().resize(nvm.image().size() - 3);
+    }
+    SUBCASE("bit flip in the last record") {
+        nvm.image()[intact + 4] ^= 0x10;
+    }
+
+    DTCJournal journal(nvm, DTCJournalConfig{}.background(false));
+    DiagNode node;
+    REQUIRE(node.diag.attach_store(journal).is_ok());
+    CHECK(node.diag.active_dtcs().size() == 2);
+    CHECK(journal.stats().records_replayed == 2);
+    CHECK(journal.stats().discarded_bytes > 0);
+    CHECK(nvm.image().size() == intact);
+
+    // New records follow the last intact one
+    node.diag.set_active({400, FMI::BadDevice, 0});
+    DTCJournal reread(nvm, DTCJournalConfig{}.background(false));
+    DiagNode restarted;
+    REQUIRE(restarted.diag.attach_store(reread).is_ok());
+    CHECK(restarted.diag.active_dtcs().size() == 3);
+    CHECK(reread.stats().discarded_bytes == 0);
+
+    // An image without the header starts over
+    nvm.image() = {1, 2, 3, 4, 5, 6, 7, 8};
+    DTCJournal fresh(nvm, DTCJournalConfig{}.background(false));
+    DiagNode blank;
+    REQUIRE(blank.diag.attach_store(fresh).is_ok());
+    CHECK(blank.diag.active_dtcs().empty());
+    CHECK(fresh.stats().discarded_bytes == 8);
+}
+
+TEST_CASE("DTCJournal - compaction bounds the image") {
+    MemoryNvm nvm;
+    DTCJournal journal(nvm, DTCJournalConfig{}.compact_at(4096).background(false));
+    DiagNode node;
+    REQUIRE(node.diag.attach_store(journal).is_ok());
+
+    // An intermittent fault toggling for a whole shift
+    usize peak = 0;
+    for (u32 i = 0; i < 5000; ++i) {
+        node.diag.set_active({100 + i % 8, FMI::Erratic, 0});
+        node.diag.clear_active(100 + i % 8, FMI::Erratic);
+        peak = std::max(peak, nvm.image().size());
+    }
+    CHECK(journal.stats().compactions > 0);
+    CHECK(peak < 8192);
+    CHECK(node.diag.previous_dtcs().size() == 8);
+
+    DTCJournal reread(nvm, DTCJournalConfig{}.background(false));
+    DiagNode restarted;
+    REQUIRE(restarted.diag.attach_store(reread).is_ok());
+    CHECK(restarted.diag.previous_dtcs().size() == 8);
+    CHECK(restarted.diag.previous_dtcs().back().spn == 100 + 4999 % 8);
+    REQUIRE(restarted.diag.previously_active_dtcs().size() == 8);
+    CHECK(restarted.diag.previously_active_dtcs()[0].occurrence_count == 126);
+    CHECK(restarted.diag.freeze_frames().size() == 8);
+    for (const auto &[key, frames] : restarted.diag.freeze_frames())
+        CHECK(frames.size() == 3);
+}
+
+TEST_CASE("DTCJournal - compaction while clearing all active DTCs") {
+    MemoryNvm nvm;
+    {
+        DTCJournal journal(nvm, DTCJournalConfig{}.compact_at(256).background(false));
+        DiagNode node(DiagnosticConfig{}.auto_capture_freeze_frames_enabled(false));
+        REQUIRE(node.diag.attach_store(journal).is_ok());
+        for (u32 spn = 1; spn <= 60; ++spn)
+            node.diag.set_active({spn, FMI::VoltageLow, 0});
+        journal.compact(node.diag.state());
+        u64 before = journal.stats().compactions;
+
+        node.diag.clear_all_active();
+        CHECK(journal.stats().compactions > before); // fired partway through the batch
+        CHECK(node.diag.active_dtcs().empty());
+    }
+
+    DTCJournal journal(nvm, DTCJournalConfig{}.background(false));
+    DiagNode node;
+    REQUIRE(node.diag.attach_store(journal).is_ok());
+    CHECK(node.diag.active_dtcs().empty());
+    CHECK(node.diag.previous_dtcs().size() == 60);
+    CHECK(node.diag.previously_active_dtcs().size() == 60);
+}
+
+TEST_CASE("DTCJournal - file backend with write-behind") {
+    auto dir = std::filesystem::temp_directory_path() / "agrobus_dtc_journal_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto path = dir / "dtc.journal";
+
+    {
+        FileNvm nvm(path);
+        DTCJournal journal(nvm, DTCJournalConfig{}.compact_at(1024));
+        DiagNode node(DiagnosticConfig{}.history_depth(16));
+        REQUIRE(node.diag.attach_store(journal).is_ok());
+        for (u32 i = 0; i < 200; ++i) {
+            node.diag.set_active({1000 + i, FMI::CurrentHigh, 0});
+            node.diag.clear_active(1000 + i, FMI::CurrentHigh);
+        }
+        node.diag.set_active({42, FMI::VoltageLow, 0});
+        journal.flush();
+        CHECK(journal.stats().compactions > 0);
+        CHECK(journal.stats().write_errors == 0);
+        CHECK(std::filesystem::file_size(path) == journal.stats().journal_bytes);
+        CHECK(!std::filesystem::exists(dir / "dtc.journal.tmp"));
+    }
+
+    FileNvm nvm(path);
+    DTCJournal journal(nvm);
+    DiagNode node(DiagnosticConfig{}.history_depth(16));
+    REQUIRE(node.diag.attach_store(journal).is_ok());
+    REQUIRE(node.diag.active_dtcs().size() == 1);
+    CHECK(node.diag.active_dtcs()[0].spn == 42);
+    REQUIRE(node.diag.previous_dtcs().size() == 16);
+    CHECK(node.diag.previous_dtcs().front().spn == 1184);
+    CHECK(node.diag.previous_dtcs().back().spn == 1199);
+    CHECK(journal.stats().discarded_bytes == 0);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("DiagnosticProtocol - DM2 history is bounded and de-duplicated") {
+    DiagNode node(DiagnosticConfig{}.history_depth(4));
+    for (u32 round = 0; round < 3; ++round) {
+        for (u32 spn = 1; spn <= 6; ++spn) {
+            node.diag.set_active({spn, FMI::VoltageLow, 0});
+            node.diag.clear_active(spn, FMI::VoltageLow);
+        }
+    }
+    // Only the four most recent distinct DTCs remain, oldest first
+    REQUIRE(node.diag.previous_dtcs().size() == 4);
+    CHECK(node.diag.previous_dtcs()[0].spn == 3);
+    CHECK(node.diag.previous_dtcs()[3].spn == 6);
+    CHECK(node.diag.previously_active_dtcs().size() == 4);
+
+    // The same DTC going inactive twice is one entry, moved to the end
+    node.diag.set_active({4, FMI::VoltageLow, 0});
+    node.diag.clear_active(4, FMI::VoltageLow);
+    REQUIRE(node.diag.previous_dtcs().size() == 4);
+    CHECK(node.diag.previous_dtcs()[3].spn == 4);
+}
@@ -211,7 +211,7 @@ TEST(tan_cache_expiration) {
     TANResponse response;
     response.tan = 5;
     response.timestamp_ms = 1000;
-    response.response_data = {1, 2, 3};
+    response.response_data = std::make_shared<const dp::Vector<u8>>(dp::Vector<u8>{1, 2, 3});
 
     // Not expired within timeout
     ASSERT(!response.is_expired(5000, 10000));
@@ -387,7 +387,7 @@ TEST(file_operations_write) {
     bool write_complete = false;
 
     client.write_file(handle, write_data,
-        [&write_complete](Result<u8> result) {
+        [&write_complete](Result<u16> result) {
             if (result.is_ok()) {
                 write_complete = true;
             }
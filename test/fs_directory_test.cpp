@@ -0,0 +1,300 @@
+#include <doctest/doctest.h>
+#include <agrobus.hpp>
+#include <deque>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+TEST_CASE("FileEntry - directory record round trip") {
+    FileEntry entry;
+    entry.name = "TASKDATA.XML";
+    entry.size = 0x01020304;
+    entry.attributes = FileAttributes::ReadOnly;
+    entry.date = pack_dos_date(2026, 4, 1);
+    entry.time = pack_dos_time(10, 30, 0);
+
+    dp::Vector<u8> out;
+    entry.encode(out);
+    entry.encode(out);
+    CHECK(out.size() == 2 * entry.encoded_size());
+    CHECK(out[FileEntry::size_offset(entry.name.size())] == 0x04);
+
+    usize consumed = 0;
+    auto decoded = FileEntry::decode(out.data(), out.size(), consumed);
+    CHECK(consumed == entry.encoded_size());
+    CHECK(decoded.name == entry.name);
+    CHECK(decoded.size == entry.size);
+    CHECK(decoded.is_read_only());
+    CHECK(decoded.date == entry.date);
+    CHECK(decoded.time == entry.time);
+
+    FileEntry::decode(out.data(), entry.encoded_size() - 1, consumed);
+    CHECK(consumed == 0);
+}
+
+// ─── Memory volume tree ───────────────────────────────────────────────────────
+
+TEST_CASE("MemoryVolume - listings hold only the directory's own children") {
+    MemoryVolume vol;
+    vol.add_directory("\\TASKDATA\\");
+    vol.add_file("\\TASKDATA\\TASKDATA.XML", {1, 2, 3}, FileAttributes::None);
+    vol.add_file("\\TASKDATA\\LOG\\00001.BIN", {4}, FileAttributes::None);
+    vol.add_file("\\ROOT.TXT", {5}, FileAttributes::None);
+
+    // Parent directories of a new file are created with it
+    CHECK(vol.directory_exists("\\TASKDATA\\LOG\\"));
+    CHECK_FALSE(vol.directory_exists("\\TASKDATA\\NONE\\"));
+    CHECK_FALSE(vol.file_exists("\\TASKDATA\\"));
+    CHECK_FALSE(vol.directory_exists("\\ROOT.TXT\\"));
+
+    auto root = vol.list("\\");
+    REQUIRE(root.size() == 2);
+    auto task = vol.list("\\TASKDATA\\");
+    REQUIRE(task.size() == 2);
+    bool saw_log = false, saw_xml = false;
+    for (const auto &e : task) {
+        saw_log = saw_log || (e.name == "LOG\\" && e.is_directory());
+        saw_xml = saw_xml || (e.name == "TASKDATA.XML" && e.size == 3);
+    }
+    CHECK(saw_log);
+    CHECK(saw_xml);
+    CHECK(vol.list("\\MISSING\\").empty());
+
+    // Moves keep the data and the handles already open on it
+    auto file = vol.open("\\TASKDATA\\TASKDATA.XML", false, true).value();
+    CHECK(vol.move_file("\\TASKDATA\\TASKDATA.XML", "\\ARCHIVE\\T1.XML").is_ok());
+    CHECK_FALSE(vol.file_exists("\\TASKDATA\\TASKDATA.XML"));
+    CHECK(vol.file_exists("\\ARCHIVE\\T1.XML"));
+    u8 more = 9;
+    file->write(3, &more, 1);
+    CHECK(vol.open("\\ARCHIVE\\T1.XML", false, false).value()->size() == 4);
+    CHECK_FALSE(vol.move_file("\\TASKDATA\\TASKDATA.XML", "\\X.XML").is_ok());
+    CHECK_FALSE(vol.move_file("\\ROOT.TXT", "\\ARCHIVE\\T1.XML").is_ok());
+
+    CHECK(vol.remove_file("\\TASKDATA\\LOG\\00001.BIN").is_ok());
+    CHECK(vol.list("\\TASKDATA\\LOG\\").empty());
+}
+
+// ─── Directory reads over the bus ─────────────────────────────────────────────
+
+// One direction of an in-process bus between two nodes
+class QueueLink : public wirebit::Link {
+    std::deque<wirebit::Frame> *tx_;
+    std::deque<wirebit::Frame> *rx_;
+
+  public:
+    QueueLink(std::deque<wirebit::Frame> *tx, std::deque<wirebit::Frame> *rx) : tx_(tx), rx_(rx) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        tx_->push_back(frame);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        if (rx_->empty())
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+        auto frame = std::move(rx_->front());
+        rx_->pop_front();
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::ok(std::move(frame));
+    }
+    wirebit::String name() const override { return "queue"; }
+};
+
+struct DirBus {
+    std::deque<wirebit::Frame> to_client, to_server;
+    wirebit::CanEndpoint server_ep{std::make_shared<QueueLink>(&to_client, &to_server), wirebit::CanConfig{}, 1};
+    wirebit::CanEndpoint client_ep{std::make_shared<QueueLink>(&to_server, &to_client), wirebit::CanConfig{}, 2};
+    IsoNet server_net, client_net;
+    InternalCF *client_cf = nullptr;
+    std::unique_ptr<FileServerEnhanced> server;
+    std::unique_ptr<FileClient> client;
+    dp::Vector<u8> last_response;
+
+    DirBus() {
+        server_net.set_endpoint(0, &server_ep);
+        client_net.set_endpoint(0, &client_ep);
+        server = std::make_unique<FileServerEnhanced>(server_net, server_net.create_internal(Name{}, 0, 0x20).value());
+        client_cf = client_net.create_internal(Name{}, 0, 0x80).value();
+        client = std::make_unique<FileClient>(client_net, client_cf);
+        client_net.register_pgn_callback(PGN_FILE_SERVER_TO_CLIENT, [this](const Message &msg) {
+            if (msg.data.size() >= 3 && msg.data[1] != 0xFF)
+                last_response = msg.data;
+        });
+        server->initialize();
+        client->initialize();
+        client->connect_to_server(0x20);
+        run(10);
+    }
+
+    void run(u32 steps) {
+        for (u32 i = 0; i < steps; ++i) {
+            server_net.update(1);
+            server->update(1);
+            client_net.update(1);
+            client->update(1);
+        }
+    }
+
+    template <typename Pred> bool run_until(Pred done, u32 max_steps = 5000) {
+        for (u32 i = 0; i < max_steps && !done(); ++i)
+            run(1);
+        return done();
+    }
+
+    FileHandle open(const dp::String &path, OpenFlags flags) {
+        FileHandle handle = INVALID_FILE_HANDLE;
+        bool done = false;
+        client->open_file(path, flags, [&](Result<FileHandle> r) {
+            done = true;
+            if (r.is_ok())
+                handle = r.value();
+        });
+        run_until([&] { return done; });
+        return handle;
+    }
+
+    // Reads the whole listing, page by page
+    dp::Vector<FileEntry> list(FileHandle handle, u16 page, usize *pages = nullptr) {
+        dp::Vector<FileEntry> all;
+        while (true) {
+            bool done = false;
+            dp::Vector<FileEntry> entries;
+            client->read_directory(handle, page, [&](Result<dp::Vector<FileEntry>> r) {
+                done = true;
+                if (r.is_ok())
+                    entries = r.value();
+            });
+            if (!run_until([&] { return done; }) || entries.empty())
+                return all;
+            if (pages)
+                ++*pages;
+            all.insert(all.end(), entries.begin(), entries.end());
+        }
+    }
+
+    // Sends a raw request (functions the client has no call for)
+    u8 request(dp::Vector<u8> req) {
+        last_response.clear();
+        req.resize(std::max<usize>(req.size(), 8), 0xFF);
+        ControlFunction dest;
+        dest.address = 0x20;
+        client_net.send(PGN_FILE_CLIENT_TO_SERVER, req, client_cf, &dest);
+        run_until([&] { return !last_response.empty(); });
+        return last_response.size() > 2 ? last_response[2] : 0xFF;
+    }
+};
+
+static dp::String log_name(u32 i) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "L%05u.BIN", i);
+    return name;
+}
+
+TEST_CASE("FileServer - large directory is listed in sorted pages from one cached listing") {
+    DirBus bus;
+    for (u32 i = 0; i < 300; ++i)
+        bus.server->add_file("\\TASKDATA\\" + log_name(299 - i), dp::Vector<u8>(i % 7));
+    bus.server->add_file("\\OTHER\\X.BIN", {1});
+
+    FileHandle handle = bus.open("\\TASKDATA", OpenFlags::OpenDir);
+    REQUIRE(handle != INVALID_FILE_HANDLE);
+
+    usize pages = 0;
+    auto entries = bus.list(handle, 1000, &pages);
+    REQUIRE(entries.size() == 300);
+    CHECK(pages > 1); // one page per TP session
+    for (u32 i = 0; i < 300; ++i)
+        CHECK(entries[i].name == log_name(i));
+    CHECK(entries[5].size == (299 - 5) % 7);
+    CHECK(bus.server->listing_stats().builds == 1);
+    CHECK(bus.server->listing_stats().pages == pages);
+
+    // Seeking a directory handle selects an entry index; small pages honour the count
+    bus.client->seek_file(handle, 298, [](Result<void>) {});
+    bus.run(20);
+    auto tail = bus.list(handle, 1);
+    REQUIRE(tail.size() == 2);
+    CHECK(tail[1].name == log_name(299));
+    CHECK(bus.server->listing_stats().builds == 1);
+}
+
+TEST_CASE("FileServer - listings follow writes, deletes and moves") {
+    DirBus bus;
+    bus.server->add_file("\\DATA\\A.BIN", {1, 2});
+    bus.server->add_file("\\DATA\\B.BIN", {3});
+    bus.server->add_file("\\KEEP\\K.BIN", {4});
+
+    FileHandle dir = bus.open("\\DATA\\", OpenFlags::OpenDir);
+    FileHandle keep = bus.open("\\KEEP\\", OpenFlags::OpenDir);
+    REQUIRE(bus.list(dir, 50).size() == 2);
+    REQUIRE(bus.list(keep, 50).size() == 1);
+    CHECK(bus.server->listing_stats().builds == 2);
+
+    // A write patches the size in place
+    FileHandle b_handle = bus.open("\\DATA\\B.BIN", OpenFlags::ReadWrite);
+    bool b_written = false;
+    bus.client->write_file(b_handle, dp::Vector<u8>(7, 0xCD), [&](Result<u16>) { b_written = true; });
+    REQUIRE(bus.run_until([&] { return b_written; }));
+    bus.client->close_file(b_handle);
+    FileHandle a = bus.open("\\DATA\\A.BIN", OpenFlags::ReadWrite);
+    bool written = false;
+    bus.client->write_file(a, dp::Vector<u8>(10, 0xAB), [&](Result<u16>) { written = true; });
+    REQUIRE(bus.run_until([&] { return written; }));
+    bus.client->seek_file(dir, 0, [](Result<void>) {});
+    bus.run(20);
+    auto listed = bus.list(dir, 50);
+    REQUIRE(listed.size() == 2);
+    CHECK(listed[0].name == "A.BIN");
+    CHECK(listed[0].size == 10);
+    CHECK(listed[1].size == 7);
+    CHECK(bus.server->listing_stats().patches == 2);
+    CHECK(bus.server->listing_stats().builds == 2);
+
+    // An open file cannot be deleted; a closed one can
+    dp::String b = "\\DATA\\B.BIN";
+    dp::Vector<u8> del = {static_cast<u8>(FSFunction::DeleteFile), 200, static_cast<u8>(b.size())};
+    del.insert(del.end(), b.begin(), b.end());
+    CHECK(bus.request(del) == static_cast<u8>(FSError::Success));
+    CHECK_FALSE(bus.server->volume().file_exists(b));
+    del[1] = 201;
+    CHECK(bus.request(del) == static_cast<u8>(FSError::NotFound));
+    dp::String a_path = "\\DATA\\A.BIN";
+    dp::Vector<u8> del_open = {static_cast<u8>(FSFunction::DeleteFile), 202, static_cast<u8>(a_path.size())};
+    del_open.insert(del_open.end(), a_path.begin(), a_path.end());
+    CHECK(bus.request(del_open) == static_cast<u8>(FSError::AccessDenied));
+
+    // Move A into a new directory; the open handle follows it
+    dp::String to = "\\ARCHIVE\\A1.BIN";
+    dp::Vector<u8> mv = {static_cast<u8>(FSFunction::MoveFile), 203, static_cast<u8>(a_path.size()),
+                         static_cast<u8>(to.size())};
+    mv.insert(mv.end(), a_path.begin(), a_path.end());
+    mv.insert(mv.end(), to.begin(), to.end());
+    CHECK(bus.request(mv) == static_cast<u8>(FSError::Success));
+    mv[1] = 204;
+    CHECK(bus.request(mv) == static_cast<u8>(FSError::InvalidSourceName));
+
+    bus.client->seek_file(dir, 0, [](Result<void>) {});
+    bus.run(20);
+    CHECK(bus.list(dir, 50).empty());
+
+    FileHandle archive = bus.open("\\ARCHIVE\\", OpenFlags::OpenDir);
+    auto moved = bus.list(archive, 50);
+    REQUIRE(moved.size() == 1);
+    CHECK(moved[0].name == "A1.BIN");
+    CHECK(moved[0].size == 10);
+
+    // The untouched directory kept its listing
+    bus.client->seek_file(keep, 0, [](Result<void>) {});
+    bus.run(20);
+    auto builds = bus.server->listing_stats().builds;
+    CHECK(bus.list(keep, 50).size() == 1);
+    CHECK(bus.server->listing_stats().builds == builds);
+
+    // The root listing gained the new directory
+    FileHandle root = bus.open("\\", OpenFlags::OpenDir);
+    usize dirs = 0;
+    for (const auto &e : bus.list(root, 50))
+        dirs += e.is_directory();
+    CHECK(dirs == 3);
+}
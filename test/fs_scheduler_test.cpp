@@ -0,0 +1,151 @@
+#include <doctest/doctest.h>
+#include <agrobus.hpp>
+#include <cstring>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+// Keeps single-frame server responses
+class ResponseLink : public wirebit::Link {
+  public:
+    dp::Vector<can_frame> responses;
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        if (((cf.can_id >> 16) & 0xFF) == (PGN_FILE_SERVER_TO_CLIENT >> 8))
+            responses.push_back(cf);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "responses"; }
+};
+
+static Address destination(const can_frame &frame) { return static_cast<Address>((frame.can_id >> 8) & 0xFF); }
+
+struct SchedServer {
+    static constexpr Address READER = 0x81; // streams large reads
+    static constexpr Address VT = 0x82;     // loads a small file
+
+    std::shared_ptr<ResponseLink> link = std::make_shared<ResponseLink>();
+    wirebit::CanEndpoint ep{link, wirebit::CanConfig{}, 1};
+    IsoNet net;
+    std::unique_ptr<FileServerEnhanced> server;
+
+    explicit SchedServer(FileServerConfig config = {}) {
+        net.set_endpoint(0, &ep);
+        auto *cf = net.create_internal(Name{}, 0, 0x20).value();
+        server = std::make_unique<FileServerEnhanced>(net, cf, config);
+        server->initialize();
+    }
+
+    void send(Address client, dp::Vector<u8> data) {
+        data.resize(std::max<usize>(data.size(), 8), 0xFF);
+        net.inject_message(Message(PGN_FILE_CLIENT_TO_SERVER, data, client, 0x20));
+    }
+
+    // A full-size block read; the handle is unknown, so the answer is a single frame
+    void large_read(Address client, TAN tan) {
+        send(client, {static_cast<u8>(FSFunction::ReadFile), tan, 0x42, 0xF4, 0x06});
+    }
+
+    void properties(Address client, TAN tan) {
+        send(client, {static_cast<u8>(FSFunction::GetFileServerProperties), tan});
+    }
+
+    usize first_response_to(Address client) const {
+        for (usize i = 0; i < link->responses.size(); ++i)
+            if (destination(link->responses[i]) == client)
+                return i;
+        return link->responses.size();
+    }
+};
+
+TEST_CASE("FileServer scheduler - small requests are not queued behind a large reader") {
+    SchedServer fifo(FileServerConfig{}.scheduling(FSSchedulePolicy::Fifo));
+    SchedServer drr(FileServerConfig{}.scheduling(FSSchedulePolicy::DeficitRoundRobin, 512));
+    for (auto *node : {&fifo, &drr}) {
+        for (TAN tan = 0; tan < 8; ++tan)
+            node->large_read(SchedServer::READER, tan);
+        node->properties(SchedServer::VT, 0);
+        node->properties(SchedServer::VT, 1);
+        CHECK(node->link->responses.empty()); // nothing runs inside the PGN callback
+        CHECK(node->server->pending_requests() == 10);
+        node->server->update(0);
+        CHECK(node->link->responses.size() == 10);
+        CHECK(node->server->pending_requests() == 0);
+    }
+
+    // Arrival order puts the VT behind every block; with round-robin its
+    // requests fit the first round's credit while each block needs four
+    CHECK(fifo.first_response_to(SchedServer::VT) == 8);
+    CHECK(drr.first_response_to(SchedServer::VT) == 0);
+    CHECK(destination(drr.link->responses[1]) == SchedServer::VT);
+
+    // Requests still run in order per client
+    TAN expected = 0;
+    for (const auto &frame : drr.link->responses)
+        if (destination(frame) == SchedServer::READER)
+            CHECK(frame.data[1] == expected++);
+    CHECK(drr.server->scheduler_stats().executed == 10);
+}
+
+TEST_CASE("FileServer scheduler - response budget paces execution") {
+    // 1% of 250 kbit/s is about 19.5 response frames per second
+    SchedServer node(FileServerConfig{}.response_budget(0.01f));
+    for (TAN tan = 0; tan < 10; ++tan)
+        node.properties(SchedServer::VT, tan);
+
+    node.server->update(0);
+    CHECK(node.link->responses.size() == 1);
+    CHECK(node.server->scheduler_stats().deferred_budget > 0);
+
+    for (u32 i = 0; i < 10; ++i)
+        node.server->update(10);
+    CHECK(node.link->responses.size() >= 2);
+    CHECK(node.link->responses.size() <= 3);
+    for (u32 i = 0; i < 40; ++i)
+        node.server->update(10);
+    CHECK(node.link->responses.size() == 10);
+
+    const auto *stats = node.server->client_stats(SchedServer::VT);
+    REQUIRE(stats != nullptr);
+    CHECK(stats->requests == 10);
+    CHECK(stats->queued == 0);
+    CHECK(stats->response_bytes == 80);
+    CHECK(stats->max_latency_ms >= 400);
+    CHECK(stats->mean_latency_ms() > 0.0);
+    CHECK(node.server->client_stats(0x99) == nullptr);
+
+    // Throughput is measured per one-second window
+    for (u32 i = 0; i < 50; ++i)
+        node.server->update(10);
+    CHECK(stats->bytes_per_s > 0.0f);
+}
+
+TEST_CASE("FileServer scheduler - queued retries and a full queue") {
+    SchedServer node(FileServerConfig{}.request_queue(4));
+    node.properties(SchedServer::VT, 7);
+    node.properties(SchedServer::VT, 7); // retry before the first ran
+    for (TAN tan = 8; tan < 13; ++tan)
+        node.properties(SchedServer::VT, tan);
+
+    const auto *stats = node.server->client_stats(SchedServer::VT);
+    REQUIRE(stats != nullptr);
+    CHECK(stats->duplicates == 1);
+    CHECK(stats->dropped == 2);
+    CHECK(stats->queued == 4);
+    CHECK(node.server->scheduler_stats().max_backlog == 4);
+
+    node.server->update(0);
+    CHECK(node.link->responses.size() == 4);
+
+    // Once run, a retry is answered from the TAN cache
+    node.properties(SchedServer::VT, 7);
+    CHECK(node.link->responses.size() == 5);
+    CHECK(stats->requests == 4);
+}
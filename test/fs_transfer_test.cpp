@@ -0,0 +1,273 @@
+#include <doctest/doctest.h>
+#include <agrobus.hpp>
+#include <deque>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+// One direction of an in-process bus between two nodes
+class QueueLink : public wirebit::Link {
+    std::deque<wirebit::Frame> *tx_;
+    std::deque<wirebit::Frame> *rx_;
+
+  public:
+    QueueLink(std::deque<wirebit::Frame> *tx, std::deque<wirebit::Frame> *rx) : tx_(tx), rx_(rx) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        tx_->push_back(frame);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        if (rx_->empty())
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+        auto frame = std::move(rx_->front());
+        rx_->pop_front();
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::ok(std::move(frame));
+    }
+    wirebit::String name() const override { return "queue"; }
+};
+
+struct FsBus {
+    static constexpr Address SERVER = 0x20;
+    static constexpr Address CLIENT = 0x80;
+
+    std::deque<wirebit::Frame> to_client, to_server;
+    wirebit::CanEndpoint server_ep{std::make_shared<QueueLink>(&to_client, &to_server), wirebit::CanConfig{}, 1};
+    wirebit::CanEndpoint client_ep{std::make_shared<QueueLink>(&to_server, &to_client), wirebit::CanConfig{}, 2};
+    IsoNet server_net, client_net;
+    InternalCF *client_cf = nullptr;
+    std::unique_ptr<FileServerEnhanced> server;
+    std::unique_ptr<FileClient> client;
+    dp::Vector<dp::Vector<u8>> responses; // everything the server sent, for raw requests
+
+    explicit FsBus(FileClientConfig config = {}, FileServerConfig server_config = {}) {
+        server_net.set_endpoint(0, &server_ep);
+        client_net.set_endpoint(0, &client_ep);
+        server = std::make_unique<FileServerEnhanced>(
+            server_net, server_net.create_internal(Name{}, 0, SERVER).value(), server_config);
+        client_cf = client_net.create_internal(Name{}, 0, CLIENT).value();
+        client = std::make_unique<FileClient>(client_net, client_cf, config);
+        client_net.register_pgn_callback(PGN_FILE_SERVER_TO_CLIENT, [this](const Message &msg) {
+            if (msg.data.size() >= 3)
+                responses.push_back(msg.data);
+        });
+        server->initialize();
+        client->initialize();
+        client->connect_to_server(SERVER);
+        run(10);
+    }
+
+    void run(u32 steps) {
+        for (u32 i = 0; i < steps; ++i) {
+            server_net.update(1);
+            server->update(1);
+            client_net.update(1);
+            client->update(1);
+        }
+    }
+
+    template <typename Pred> bool run_until(Pred done, u32 max_steps = 20000) {
+        for (u32 i = 0; i < max_steps && !done(); ++i)
+            run(1);
+        return done();
+    }
+
+    // Sends a raw request with a chosen TAN and returns the matching response
+    dp::Vector<u8> request(dp::Vector<u8> req) {
+        u8 function = req[0], tan = req[1];
+        auto answered = [&] {
+            for (const auto &r : responses)
+                if (r[0] == function && r[1] == tan)
+                    return true;
+            return false;
+        };
+        responses.clear();
+        req.resize(std::max<usize>(req.size(), 8), 0xFF);
+        ControlFunction dest;
+        dest.address = SERVER;
+        client_net.send(PGN_FILE_CLIENT_TO_SERVER, req, client_cf, &dest);
+        if (!run_until(answered, 2000))
+            return {};
+        for (const auto &r : responses)
+            if (r[0] == function && r[1] == tan)
+                return r;
+        return {};
+    }
+};
+
+static dp::Vector<u8> pattern(usize size) {
+    dp::Vector<u8> data(size);
+    for (usize i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(i * 13 + (i >> 7));
+    return data;
+}
+
+TEST_CASE("FileClient - 16-bit read count in one request") {
+    FsBus bus;
+    REQUIRE(bus.client->is_connected());
+    auto content = pattern(1500);
+    bus.server->add_file("\\BIG.BIN", content);
+
+    FileHandle handle = INVALID_FILE_HANDLE;
+    bus.client->open_file("\\BIG.BIN", OpenFlags::Read, [&](Result<FileHandle> r) { handle = r.value(); });
+    REQUIRE(bus.run_until([&] { return handle != INVALID_FILE_HANDLE; }));
+
+    dp::Vector<u8> data;
+    bool done = false;
+    bus.client->read_file(handle, 1200, [&](Result<dp::Vector<u8>> r) {
+        data = r.value();
+        done = true;
+    });
+    REQUIRE(bus.run_until([&] { return done; }));
+    CHECK(data.size() == 1200);
+    CHECK(data == dp::Vector<u8>(content.begin(), content.begin() + 1200));
+
+    // Large write in one request
+    dp::Vector<u8> block = pattern(900);
+    FileHandle wh = INVALID_FILE_HANDLE;
+    bus.client->open_file("\\OUT.BIN", OpenFlags::ReadWrite | OpenFlags::Create,
+                          [&](Result<FileHandle> r) { wh = r.value(); });
+    REQUIRE(bus.run_until([&] { return wh != INVALID_FILE_HANDLE; }));
+    u16 written = 0;
+    bus.client->write_file(wh, block, [&](Result<u16> r) { written = r.value(); });
+    REQUIRE(bus.run_until([&] { return written != 0; }));
+    CHECK(written == 900);
+    CHECK(bus.server->list_directory("\\", "OUT.BIN")[0].size == 900);
+}
+
+TEST_CASE("FileClient - pipelined download delivers the file in order") {
+    for (u8 window : {1, 4, 8}) {
+        FsBus bus(FileClientConfig{}.window(window).block_size(700));
+        auto content = pattern(20'000);
+        bus.server->add_file("\\TASKDATA\\TASKDATA.XML", content);
+
+        dp::Vector<u8> received;
+        dp::Vector<u64> progress;
+        usize closed = 0;
+        bus.client->on_file_closed.subscribe([&](FileHandle) { ++closed; });
+        bool finished = false;
+        u64 total = 0;
+        auto sink = [&](const u8 *data, usize n) { received.insert(received.end(), data, data + n); };
+        bus.client->download_file(
+            "\\TASKDATA\\TASKDATA.XML", sink,
+            [&](Result<u64> r) {
+                finished = true;
+                total = r.value();
+            },
+            [&](u64 bytes) { progress.push_back(bytes); });
+
+        REQUIRE(bus.run_until([&] { return finished; }));
+        CHECK(total == content.size());
+        CHECK(received == content);
+        CHECK(progress.size() == (content.size() + 699) / 700);
+        CHECK(std::is_sorted(progress.begin(), progress.end()));
+        CHECK(bus.client->active_transfers() == 0);
+        CHECK(closed == 1);
+    }
+}
+
+TEST_CASE("FileClient - pipelined upload completes after the close") {
+    FsBus bus(FileClientConfig{}.window(3).block_size(1000));
+    auto content = pattern(7'777);
+
+    bool finished = false;
+    Result<u64> outcome = Result<u64>::err(Error::invalid_state("pending"));
+    u64 last_progress = 0;
+    bus.client->upload_file(
+        "\\LOG.BIN", content,
+        [&](Result<u64> r) {
+            finished = true;
+            outcome = r;
+        },
+        [&](u64 bytes) { last_progress = bytes; });
+
+    REQUIRE(bus.run_until([&] { return finished; }));
+    REQUIRE(outcome.is_ok());
+    CHECK(outcome.value() == content.size());
+    CHECK(last_progress == content.size());
+
+    auto file = bus.server->volume().open("\\LOG.BIN", false, false).value();
+    dp::Vector<u8> stored(file->size());
+    file->read(0, stored.data(), stored.size());
+    CHECK(stored == content);
+}
+
+TEST_CASE("FileClient - download of a missing file fails") {
+    FsBus bus;
+    bool finished = false;
+    bool ok = true;
+    bus.client->download_file(
+        "\\NOPE.BIN", [](const u8 *, usize) {},
+        [&](Result<u64> r) {
+            finished = true;
+            ok = r.is_ok();
+        });
+    REQUIRE(bus.run_until([&] { return finished; }));
+    CHECK_FALSE(ok);
+    CHECK(bus.client->active_transfers() == 0);
+}
+
+static dp::Vector<u8> open_request(TAN tan, const dp::String &path) {
+    dp::Vector<u8> req = {static_cast<u8>(FSFunction::OpenFile), tan, static_cast<u8>(path.size()),
+                          static_cast<u8>(OpenFlags::Read)};
+    req.insert(req.end(), path.begin(), path.end());
+    return req;
+}
+
+static dp::Vector<u8> read_request(TAN tan, FileHandle handle, u16 count) {
+    return {static_cast<u8>(FSFunction::ReadFile), tan, handle, static_cast<u8>(count & 0xFF),
+            static_cast<u8>(count >> 8)};
+}
+
+TEST_CASE("FileServer - retried TAN is answered from the cache without re-reading") {
+    FsBus bus;
+    auto content = pattern(3000);
+    bus.server->add_file("\\DATA.BIN", content);
+
+    auto opened = bus.request(open_request(110, "\\DATA.BIN"));
+    REQUIRE(opened.size() >= 4);
+    FileHandle handle = opened[3];
+
+    auto first = bus.request(read_request(111, handle, 1000));
+    auto retry = bus.request(read_request(111, handle, 1000));
+    auto next = bus.request(read_request(112, handle, 1000));
+    REQUIRE(first.size() == FS_BLOCK_HEADER_SIZE + 1000);
+    CHECK(retry == first);
+    // The retry did not advance the file position
+    CHECK(dp::Vector<u8>(next.begin() + FS_BLOCK_HEADER_SIZE, next.end()) ==
+          dp::Vector<u8>(content.begin() + 1000, content.begin() + 2000));
+
+    const auto &stats = bus.server->tan_cache_stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.entries == stats.stored);
+}
+
+TEST_CASE("FileServer - TAN cache stays within its depth and memory budget") {
+    FsBus bus({}, FileServerConfig{}.tan_cache(4, 2500));
+    bus.server->add_file("\\DATA.BIN", pattern(20'000));
+    auto opened = bus.request(open_request(100, "\\DATA.BIN"));
+    REQUIRE(opened.size() >= 4);
+    FileHandle handle = opened[3];
+
+    for (TAN tan = 101; tan <= 112; ++tan)
+        REQUIRE(bus.request(read_request(tan, handle, 1000)).size() == FS_BLOCK_HEADER_SIZE + 1000);
+
+    const auto &stats = bus.server->tan_cache_stats();
+    CHECK(stats.bytes <= 2500);
+    CHECK(stats.entries == 2);
+    CHECK(stats.evicted > 0);
+    CHECK(stats.replaced > 0);
+
+    // Evicted TANs execute again: TAN 101 now reads the next block
+    auto again = bus.request(read_request(101, handle, 1000));
+    CHECK(again.size() == FS_BLOCK_HEADER_SIZE + 1000);
+    CHECK(stats.hits == 0);
+
+    // Entries expire by age
+    bus.run(11'000);
+    CHECK(stats.entries == 0);
+    CHECK(stats.bytes == 0);
+    CHECK(stats.expired > 0);
+}
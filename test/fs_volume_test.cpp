@@ -0,0 +1,296 @@
+#include <doctest/doctest.h>
+#include <agrobus.hpp>
+#include <cstring>
+#include <fstream>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::fs;
+
+static std::filesystem::path fresh_dir(const char *name) {
+    auto dir = std::filesystem::temp_directory_path() / "agrobus_fs_volume" / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+static void write_bytes(const std::filesystem::path &path, const dp::Vector<u8> &data) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+static dp::Vector<u8> read_bytes(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return dp::Vector<u8>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static dp::Vector<u8> pattern(usize size) {
+    dp::Vector<u8> data(size);
+    for (usize i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(i * 7 + (i >> 8));
+    return data;
+}
+
+static dp::Vector<u8> read_all(VolumeFile &file, usize chunk) {
+    dp::Vector<u8> out;
+    dp::Vector<u8> buf(chunk);
+    for (;;) {
+        auto n = file.read(out.size(), buf.data(), chunk);
+        REQUIRE(n.is_ok());
+        if (n.value() == 0)
+            break;
+        out.insert(out.end(), buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(n.value()));
+    }
+    return out;
+}
+
+TEST_CASE("MemoryVolume - files, directories and listing") {
+    MemoryVolume vol;
+    CHECK(vol.directory_exists("\\"));
+    vol.add_directory("\\data\\");
+    vol.add_file("\\data\\a.bin", {1, 2, 3}, FileAttributes::ReadOnly);
+    vol.add_file("\\root.txt", {9}, FileAttributes::None);
+
+    CHECK(vol.file_exists("\\data\\a.bin"));
+    CHECK_FALSE(vol.file_exists("\\data\\b.bin"));
+    CHECK_FALSE(vol.open("\\data\\b.bin", false, false).is_ok());
+
+    auto file = vol.open("\\data\\a.bin", false, true).value();
+    CHECK(file->size() == 3);
+    u8 extra[2] = {4, 5};
+    CHECK(file->write(3, extra, 2).is_ok());
+    CHECK(vol.open("\\data\\a.bin", false, false).value()->size() == 5); // shared with the volume
+
+    auto root = vol.list("\\");
+    usize dirs = 0;
+    for (const auto &e : root)
+        dirs += e.is_directory();
+    CHECK(dirs == 1);
+
+    auto entries = vol.list("\\data\\");
+    REQUIRE(entries.size() == 1);
+    CHECK(entries[0].name == "a.bin");
+    CHECK(entries[0].size == 5);
+    CHECK(entries[0].is_read_only());
+
+    CHECK(vol.remove_file("\\root.txt").is_ok());
+    CHECK_FALSE(vol.remove_file("\\root.txt").is_ok());
+}
+
+TEST_CASE("DirectoryVolume - pread and mmap reads") {
+    auto dir = fresh_dir("reads");
+    auto small = pattern(3000);
+    auto large = pattern(600'000);
+    write_bytes(dir / "small.bin", small);
+    write_bytes(dir / "large.bin", large);
+
+    // Resident window smaller than the file, so pages behind the reader are released
+    DirectoryVolume vol(dir, DirectoryVolumeConfig{}.mmap_from(64 * 1024).resident(16 * 1024));
+    CHECK(vol.file_exists("\\small.bin"));
+    CHECK(vol.directory_exists("\\"));
+
+    auto f = vol.open("\\small.bin", false, false).value();
+    CHECK(f->size() == small.size());
+    CHECK(read_all(*f, 255) == small);
+
+    auto m = vol.open("\\large.bin", false, false).value();
+    CHECK(m->size() == large.size());
+    CHECK(read_all(*m, 255) == large);
+
+    // Seeking back after pages were dropped faults them in again
+    u8 buf[16];
+    CHECK(m->read(10, buf, sizeof(buf)).value() == sizeof(buf));
+    CHECK(std::memcmp(buf, large.data() + 10, sizeof(buf)) == 0);
+    CHECK(m->read(large.size(), buf, sizeof(buf)).value() == 0);
+    CHECK_FALSE(m->write(0, buf, 1).is_ok());
+
+    CHECK_FALSE(vol.open("\\missing.bin", false, false).is_ok());
+}
+
+TEST_CASE("DirectoryVolume - write-behind completes on flush") {
+    auto dir = fresh_dir("writes");
+    DirectoryVolume vol(dir, DirectoryVolumeConfig{}.write_behind(4096));
+
+    auto data = pattern(100'000);
+    auto f = vol.open("\\log.bin", true, true).value();
+    for (usize off = 0; off < data.size(); off += 200) {
+        usize n = std::min<usize>(200, data.size() - off);
+        REQUIRE(f->write(off, data.data() + off, n).is_ok());
+    }
+    CHECK(f->size() == data.size());
+
+    // Reads through the same handle see queued data
+    u8 buf[8];
+    CHECK(f->read(50'000, buf, sizeof(buf)).value() == sizeof(buf));
+    CHECK(std::memcmp(buf, data.data() + 50'000, sizeof(buf)) == 0);
+
+    CHECK(f->flush().is_ok());
+    CHECK(vol.pending_write_bytes() == 0);
+    CHECK(read_bytes(dir / "log.bin") == data);
+
+    // Overwrite in the middle keeps the rest
+    u8 patch[4] = {0xAA, 0xBB, 0xCC, 0xDD};
+    CHECK(f->write(10, patch, 4).is_ok());
+    f.reset(); // closing drains
+    auto on_disk = read_bytes(dir / "log.bin");
+    CHECK(on_disk.size() == data.size());
+    CHECK(on_disk[10] == 0xAA);
+    CHECK(on_disk[13] == 0xDD);
+    CHECK(on_disk[14] == data[14]);
+}
+
+TEST_CASE("DirectoryVolume - paths, directories and listing") {
+    auto dir = fresh_dir("paths");
+    DirectoryVolume vol(dir);
+
+    CHECK_FALSE(vol.host_path("\\..\\etc\\passwd").has_value());
+    CHECK_FALSE(vol.host_path("\\data\\.\\x").has_value());
+    CHECK_FALSE(vol.host_path("\\a/..\\b").has_value());
+    CHECK_FALSE(vol.open("\\..\\escape.bin", true, true).is_ok());
+    CHECK(*vol.host_path("\\data\\task.xml") == dir / "data" / "task.xml");
+
+    CHECK(vol.add_directory("\\TASKDATA\\").is_ok());
+    CHECK(vol.directory_exists("\\TASKDATA\\"));
+    CHECK(vol.add_file("\\TASKDATA\\TASKDATA.XML", pattern(1234), FileAttributes::None).is_ok());
+    CHECK(vol.add_file("\\.hidden", {1}, FileAttributes::None).is_ok());
+
+    auto root = vol.list("\\");
+    REQUIRE(root.size() == 2);
+    for (const auto &e : root) {
+        if (e.name == "TASKDATA\\") {
+            CHECK(e.is_directory());
+        } else {
+            CHECK(e.name == ".hidden");
+            CHECK(has_attribute(e.attributes, FileAttributes::Hidden));
+            CHECK(e.size == 1);
+        }
+        CHECK(e.date != 0);
+    }
+
+    auto task = vol.list("\\TASKDATA\\");
+    REQUIRE(task.size() == 1);
+    CHECK(task[0].name == "TASKDATA.XML");
+    CHECK(task[0].size == 1234);
+
+    CHECK(vol.remove_file("\\TASKDATA\\TASKDATA.XML").is_ok());
+    CHECK_FALSE(vol.file_exists("\\TASKDATA\\TASKDATA.XML"));
+    CHECK_FALSE(vol.remove_file("\\TASKDATA\\").is_ok());
+}
+
+// ─── Server over a volume ─────────────────────────────────────────────────────
+
+// Keeps single-frame server responses
+class ResponseLink : public wirebit::Link {
+  public:
+    dp::Vector<can_frame> responses;
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        if (((cf.can_id >> 16) & 0xFF) == (PGN_FILE_SERVER_TO_CLIENT >> 8))
+            responses.push_back(cf);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "responses"; }
+};
+
+struct VolumeServer {
+    static constexpr Address CLIENT = 0x80;
+
+    std::shared_ptr<ResponseLink> link = std::make_shared<ResponseLink>();
+    wirebit::CanEndpoint ep{link, wirebit::CanConfig{}, 1};
+    IsoNet net;
+    std::unique_ptr<FileServerEnhanced> server;
+    u8 tan = 0;
+
+    explicit VolumeServer(std::unique_ptr<Volume> volume) {
+        net.set_endpoint(0, &ep);
+        auto *cf = net.create_internal(Name{}, 0, 0x20).value();
+        server = std::make_unique<FileServerEnhanced>(net, cf, FileServerConfig{}, std::move(volume));
+        server->initialize();
+    }
+
+    const can_frame &request(dp::Vector<u8> data) {
+        data[1] = tan++;
+        data.resize(std::max<usize>(data.size(), 8), 0xFF);
+        net.inject_message(Message(PGN_FILE_CLIENT_TO_SERVER, data, CLIENT, 0x20));
+        server->update(0); // requests run from the scheduler
+        REQUIRE(!link->responses.empty());
+        return link->responses.back();
+    }
+
+    const can_frame &open(const dp::String &path, OpenFlags flags) {
+        dp::Vector<u8> req = {static_cast<u8>(FSFunction::OpenFile), 0, static_cast<u8>(path.size()),
+                              static_cast<u8>(flags)};
+        req.insert(req.end(), path.begin(), path.end());
+        return request(req);
+    }
+};
+
+TEST_CASE("FileServerEnhanced - reads and writes through a directory volume") {
+    auto dir = fresh_dir("server");
+    write_bytes(dir / "prescription.bin", {10, 11, 12, 13, 14, 15});
+    VolumeServer node(std::make_unique<DirectoryVolume>(dir));
+
+    auto &opened = node.open("\\prescription.bin", OpenFlags::Read);
+    CHECK(opened.data[0] == static_cast<u8>(FSFunction::OpenFile));
+    CHECK(opened.data[2] == static_cast<u8>(FSError::Success));
+    CHECK(((opened.can_id >> 8) & 0xFF) == VolumeServer::CLIENT); // addressed to the client
+    u8 handle = opened.data[3];
+
+    auto &read = node.request({static_cast<u8>(FSFunction::ReadFile), 0, handle, 3, 0});
+    CHECK(read.data[2] == static_cast<u8>(FSError::Success));
+    CHECK(read.data[3] == 3);
+    CHECK(read.data[5] == 10);
+    CHECK(read.data[7] == 12);
+
+    auto &next = node.request({static_cast<u8>(FSFunction::ReadFile), 0, handle, 3, 0});
+    CHECK(next.data[3] == 3);
+    CHECK(next.data[7] == 15);
+
+    auto &eof = node.request({static_cast<u8>(FSFunction::ReadFile), 0, handle, 3, 0});
+    CHECK(eof.data[2] == static_cast<u8>(FSError::EndOfFile));
+
+    // Read-only handle refuses writes
+    auto &denied = node.request({static_cast<u8>(FSFunction::WriteFile), 0, handle, 1, 0, 0x55});
+    CHECK(denied.data[2] != static_cast<u8>(FSError::Success));
+    node.request({static_cast<u8>(FSFunction::CloseFile), 0, handle});
+
+    // Create, write, close: the data is on disk once the close is acknowledged
+    CHECK(node.open("\\NEW.BIN", OpenFlags::Read).data[2] == static_cast<u8>(FSError::NotFound));
+    auto &created = node.open("\\NEW.BIN", OpenFlags::Write | OpenFlags::Create);
+    REQUIRE(created.data[2] == static_cast<u8>(FSError::Success));
+    handle = created.data[3];
+    auto &written = node.request({static_cast<u8>(FSFunction::WriteFile), 0, handle, 3, 0, 1, 2, 3});
+    CHECK(written.data[2] == static_cast<u8>(FSError::Success));
+    auto &closed = node.request({static_cast<u8>(FSFunction::CloseFile), 0, handle});
+    CHECK(closed.data[2] == static_cast<u8>(FSError::Success));
+    CHECK(read_bytes(dir / "NEW.BIN") == dp::Vector<u8>{1, 2, 3});
+
+    // Escaping the volume root is refused
+    CHECK(node.open("\\..\\outside.bin", OpenFlags::Write | OpenFlags::Create).data[2] ==
+          static_cast<u8>(FSError::AccessDenied));
+    CHECK_FALSE(std::filesystem::exists(dir.parent_path() / "outside.bin"));
+
+    CHECK(node.server->list_directory("\\", "*.BIN").size() == 1);
+}
+
+TEST_CASE("FileServerEnhanced - memory volume by default") {
+    VolumeServer node(nullptr);
+    node.server->add_file("\\a.txt", {'h', 'i'});
+    CHECK(node.server->volume().file_exists("\\a.txt"));
+
+    auto &opened = node.open("\\a.txt", OpenFlags::ReadWrite);
+    u8 handle = opened.data[3];
+    node.request({static_cast<u8>(FSFunction::SeekFile), 0, handle, 2, 0, 0, 0});
+    node.request({static_cast<u8>(FSFunction::WriteFile), 0, handle, 1, 0, '!'});
+    node.request({static_cast<u8>(FSFunction::CloseFile), 0, handle});
+
+    auto entries = node.server->list_directory("\\");
+    REQUIRE(entries.size() == 1);
+    CHECK(entries[0].size == 3);
+}
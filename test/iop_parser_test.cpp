@@ -93,3 +93,134 @@ TEST_CASE("IOPParser - read_iop_file nonexistent") {
     auto result = IOPParser::read_iop_file("/nonexistent/path/test.iop");
     CHECK_FALSE(result.is_ok());
 }
+
+// WS(1, active mask 2) + DataMask(2, soft keys 3) + SoftKeyMask(3) + NumberVariable(4)
+static dp::Vector<u8> make_iop() {
+    return {0x01, 0x00, 0x00, 0xC8, 0x00, 0xC8, 0x00, 0x00, 0x01, 0x02, 0x00,
+            0x02, 0x00, 0x01, 0xC8, 0x00, 0xC8, 0x00, 0x05, 0x03, 0x00,
+            0x03, 0x00, 0x04, 0x3C, 0x00, 0xC8, 0x00,
+            0x04, 0x00, 0x15, 0x00, 0x00, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00};
+}
+
+static dp::String write_temp_iop(const char *name, const dp::Vector<u8> &data) {
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::FILE *f = std::fopen(path.string().c_str(), "wb");
+    std::fwrite(data.data(), 1, data.size(), f);
+    std::fclose(f);
+    return dp::String(path.string().c_str());
+}
+
+TEST_CASE("IOPParser - duplicate IDs keep the first object") {
+    auto data = make_iop();
+    dp::Vector<u8> dup = {0x04, 0x00, 0x15, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00};
+    data.insert(data.end(), dup.begin(), dup.end());
+
+    auto result = IOPParser::parse_iop_data(data);
+    REQUIRE(result.is_ok());
+    CHECK(result.value().size() == 4);
+    CHECK((*result.value().find(4))->body[4] == 0x2A);
+}
+
+TEST_CASE("IOPParser - load_iop_file maps the file") {
+    auto data = make_iop();
+    auto path = write_temp_iop("agrobus_iop_mapped.iop", data);
+
+    auto mapped = IOPParser::load_iop_file(path);
+    REQUIRE(mapped.is_ok());
+    auto &image = mapped.value();
+    CHECK(image.is_mapped());
+    CHECK(image.size() == data.size());
+    CHECK(image.object_count() == 4);
+
+    auto ref = image.find(2);
+    REQUIRE(ref != nullptr);
+    CHECK(ref->type == ObjectType::DataMask);
+    auto body = image.body(2);
+    CHECK(body.size() == 7);
+    CHECK(body.data() == image.data() + 14); // points into the mapping
+
+    SUBCASE("fallback copies the file once") {
+        auto copied = IOPParser::load_iop_file(path, false);
+        REQUIRE(copied.is_ok());
+        CHECK_FALSE(copied.value().is_mapped());
+        CHECK(copied.value().object_count() == 4);
+    }
+
+    SUBCASE("materialized pool matches parse_iop_data") {
+        auto pool = image.to_pool();
+        auto parsed = IOPParser::parse_iop_data(data);
+        REQUIRE(parsed.is_ok());
+        REQUIRE(pool.size() == parsed.value().size());
+        for (usize i = 0; i < pool.size(); ++i) {
+            CHECK(pool.objects()[i].id == parsed.value().objects()[i].id);
+            CHECK(pool.objects()[i].body == parsed.value().objects()[i].body);
+        }
+    }
+
+    CHECK(IOPParser::load_iop_file("/nonexistent/path/test.iop").is_err());
+}
+
+TEST_CASE("IOPImage - copy on write bodies") {
+    auto image = IOPParser::load_iop_data(make_iop());
+    CHECK(image.mutated_count() == 0);
+
+    auto *body = image.mutable_body(4);
+    REQUIRE(body != nullptr);
+    (*body)[4] = 99;
+    CHECK(image.is_mutated(4));
+    CHECK(image.body(4)[4] == 99);
+    CHECK(image.bytes()[35] == 0x2A); // original bytes untouched
+    CHECK(image.mutable_body(4) == body);
+    CHECK(image.mutable_body(0x1234) == nullptr);
+
+    auto pool = image.to_pool();
+    CHECK((*pool.find(4))->body[4] == 99);
+}
+
+TEST_CASE("IOPParser - validate_structure") {
+    auto image = IOPParser::load_iop_data(make_iop());
+    CHECK(IOPParser::validate_structure(image).is_ok());
+
+    SUBCASE("dangling active mask") {
+        auto data = make_iop();
+        data[9] = 0x09;
+        CHECK(IOPParser::validate_structure(IOPParser::load_iop_data(data)).is_err());
+    }
+
+    SUBCASE("soft key mask of the wrong type") {
+        auto data = make_iop();
+        data[19] = 0x04;
+        CHECK(IOPParser::validate_structure(IOPParser::load_iop_data(data)).is_err());
+    }
+
+    SUBCASE("missing working set") {
+        auto data = make_iop();
+        data.erase(data.begin(), data.begin() + 11);
+        CHECK(IOPParser::validate_structure(IOPParser::load_iop_data(data)).is_err());
+    }
+}
+
+TEST_CASE("IOPParser - parallel validation reports the same first error") {
+    auto data = make_iop();
+    // Pad with many NumberVariables, then break two of them far apart
+    for (u16 id = 100; id < 5100; ++id) {
+        dp::Vector<u8> nv = {static_cast<u8>(id & 0xFF), static_cast<u8>(id >> 8), 0x15, 0, 0, 0, 0, 0, 0, 0, 0};
+        data.insert(data.end(), nv.begin(), nv.end());
+    }
+    auto image = IOPParser::load_iop_data(data);
+    auto opts = IOPValidateOptions{}.with_threads(4).min_parallel(1);
+    CHECK(IOPParser::validate_structure(image, opts).is_ok());
+
+    usize early = 39 + 1000 * 11 + 2;
+    usize late = 39 + 4000 * 11 + 2;
+    data[late] = 200;  // unknown type
+    data[early] = 201; // unknown type, lower index
+    auto broken = IOPParser::load_iop_data(data);
+
+    auto serial = IOPParser::validate_structure(broken, IOPValidateOptions{}.with_threads(1));
+    auto parallel = IOPParser::validate_structure(broken, opts);
+    REQUIRE(serial.is_err());
+    REQUIRE(parallel.is_err());
+    CHECK(serial.error().message == parallel.error().message);
+    CHECK(serial.error().message.find("1100") != dp::String::npos);
+}
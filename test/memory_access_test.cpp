@@ -0,0 +1,282 @@
+#include <doctest/doctest.h>
+#include <agrobus.hpp>
+#include <deque>
+#include <filesystem>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::net;
+using namespace agrobus::j1939;
+
+// One direction of an in-process bus; frames are lost while `down` is set
+class DropLink : public wirebit::Link {
+    std::deque<wirebit::Frame> *tx_;
+    std::deque<wirebit::Frame> *rx_;
+    const bool *down_;
+
+  public:
+    DropLink(std::deque<wirebit::Frame> *tx, std::deque<wirebit::Frame> *rx, const bool *down)
+        : tx_(tx), rx_(rx), down_(down) {}
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        if (!*down_)
+            tx_->push_back(frame);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        if (rx_->empty())
+            return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+        auto frame = std::move(rx_->front());
+        rx_->pop_front();
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::ok(std::move(frame));
+    }
+    wirebit::String name() const override { return "drop"; }
+};
+
+struct MemBus {
+    static constexpr Address ECU = 0x00;
+    static constexpr Address TOOL = 0xF9;
+
+    bool down = false;
+    std::deque<wirebit::Frame> to_tool, to_ecu;
+    wirebit::CanEndpoint ecu_ep{std::make_shared<DropLink>(&to_tool, &to_ecu, &down), wirebit::CanConfig{}, 1};
+    wirebit::CanEndpoint tool_ep{std::make_shared<DropLink>(&to_ecu, &to_tool, &down), wirebit::CanConfig{}, 2};
+    IsoNet ecu_net, tool_net;
+    std::unique_ptr<MemoryAccessServer> server;
+    std::unique_ptr<MemoryAccessClient> client;
+
+    MemBus(MemoryBackend &memory, MemoryServerConfig server_config = {}, MemoryClientConfig client_config = {}) {
+        ecu_net.set_endpoint(0, &ecu_ep);
+        tool_net.set_endpoint(0, &tool_ep);
+        server = std::make_unique<MemoryAccessServer>(ecu_net, ecu_net.create_internal(Name{}, 0, ECU).value(),
+                                                      memory, std::move(server_config));
+        client = std::make_unique<MemoryAccessClient>(tool_net, tool_net.create_internal(Name{}, 0, TOOL).value(),
+                                                      std::move(client_config));
+        REQUIRE(server->initialize().is_ok());
+        REQUIRE(client->initialize().is_ok());
+        run(10);
+    }
+
+    void run(u32 steps) {
+        for (u32 i = 0; i < steps; ++i) {
+            ecu_net.update(1);
+            server->update(1);
+            tool_net.update(1);
+            client->update(1);
+        }
+    }
+
+    template <typename Pred> bool run_until(Pred done, u32 max_steps = 60000) {
+        for (u32 i = 0; i < max_steps && !done(); ++i)
+            run(1);
+        return done();
+    }
+};
+
+static dp::Vector<u8> pattern(usize size, u8 seed) {
+    dp::Vector<u8> data(size);
+    for (usize i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(i * 7 + seed + (i >> 8));
+    return data;
+}
+
+// Outcome of one client operation
+struct Outcome {
+    bool done = false;
+    bool ok = false;
+    dp::Vector<u8> data;
+
+    MemoryAccessClient::DoneCallback on_done() {
+        return [this](Result<void> r) {
+            done = true;
+            ok = r.is_ok();
+        };
+    }
+    MemoryAccessClient::ReadCallback on_read() {
+        return [this](Result<dp::Vector<u8>> r) {
+            done = true;
+            ok = r.is_ok();
+            if (ok)
+                data = std::move(r.value());
+        };
+    }
+};
+
+TEST_CASE("MemoryAccess - write and read back in TP and ETP blocks") {
+    RamMemory memory(64 * 1024);
+    MemBus bus(memory, {}, MemoryClientConfig{}.block_size(4000));
+    auto image = pattern(10000, 3);
+
+    Outcome wrote;
+    REQUIRE(bus.client->write(MemBus::ECU, 0x100, image, wrote.on_done()).is_ok());
+    REQUIRE(bus.run_until([&] { return wrote.done; }));
+    CHECK(wrote.ok);
+    CHECK(bus.client->stats().blocks == 3); // 4000 + 4000 + 2000 bytes over ETP
+    CHECK(std::equal(image.begin(), image.end(), memory.image().begin() + 0x100));
+    CHECK(memory.image()[0xFF] == 0xFF);
+    CHECK(bus.server->stats().writes == 3);
+    CHECK(bus.server->stats().bytes_written == 10000);
+
+    Outcome read;
+    REQUIRE(bus.client->read(MemBus::ECU, 0x100, 10000, read.on_read()).is_ok());
+    REQUIRE(bus.run_until([&] { return read.done; }));
+    CHECK(read.ok);
+    CHECK(read.data == image);
+    CHECK(bus.server->stats().prefetch_hits == 1); // the second block was read while the first was sent
+
+    // A block short enough for a single frame
+    Outcome small;
+    REQUIRE(bus.client->read(MemBus::ECU, 0x100, 5, small.on_read()).is_ok());
+    REQUIRE(bus.run_until([&] { return small.done; }));
+    REQUIRE(small.data.size() == 5);
+    CHECK(std::equal(small.data.begin(), small.data.end(), image.begin()));
+
+    // Erase goes back to 0xFF
+    Outcome erased;
+    REQUIRE(bus.client->erase(MemBus::ECU, 0x100, 100, erased.on_done()).is_ok());
+    REQUIRE(bus.run_until([&] { return erased.done; }));
+    CHECK(erased.ok);
+    CHECK(memory.image()[0x100] == 0xFF);
+    CHECK(memory.image()[0x100 + 99] == 0xFF);
+    CHECK(memory.image()[0x100 + 100] == image[100]);
+}
+
+TEST_CASE("MemoryAccess - seed and key") {
+    RamMemory memory(4096);
+    auto key = [](u8 seed) { return static_cast<u8>(seed ^ 0x5A); };
+    auto data = pattern(300, 9);
+
+    SUBCASE("the right key unlocks the server") {
+        MemBus bus(memory, MemoryServerConfig{}.security(key), MemoryClientConfig{}.security(key));
+        Address unlocked = NULL_ADDRESS;
+        bus.server->on_unlocked.subscribe([&](Address a) { unlocked = a; });
+        Outcome wrote;
+        REQUIRE(bus.client->write(MemBus::ECU, 0, data, wrote.on_done()).is_ok());
+        REQUIRE(bus.run_until([&] { return wrote.done; }));
+        CHECK(wrote.ok);
+        CHECK(unlocked == MemBus::TOOL);
+        CHECK(std::equal(data.begin(), data.end(), memory.image().begin()));
+    }
+
+    SUBCASE("a wrong key is refused") {
+        MemBus bus(memory, MemoryServerConfig{}.security(key),
+                   MemoryClientConfig{}.security([](u8 seed) { return static_cast<u8>(seed + 1); }));
+        Outcome wrote;
+        REQUIRE(bus.client->write(MemBus::ECU, 0, data, wrote.on_done()).is_ok());
+        REQUIRE(bus.run_until([&] { return wrote.done; }));
+        CHECK(!wrote.ok);
+        CHECK(bus.server->stats().key_failures == 1);
+        CHECK(memory.image()[0] == 0xFF);
+    }
+
+    SUBCASE("no key at all") {
+        MemBus bus(memory, MemoryServerConfig{}.security(key));
+        Outcome read;
+        REQUIRE(bus.client->read(MemBus::ECU, 0, 16, read.on_read()).is_ok());
+        REQUIRE(bus.run_until([&] { return read.done; }));
+        CHECK(!read.ok);
+        CHECK(bus.server->stats().reads == 0);
+    }
+}
+
+TEST_CASE("MemoryAccess - refusals") {
+    RamMemory memory(4096);
+    MemBus bus(memory, MemoryServerConfig{}.block_limit(1024));
+
+    Outcome range;
+    REQUIRE(bus.client->read(MemBus::ECU, 4000, 200, range.on_read()).is_ok());
+    REQUIRE(bus.run_until([&] { return range.done; }));
+    CHECK(!range.ok);
+    CHECK(bus.server->stats().errors == 1);
+
+    Outcome outside;
+    CHECK(!bus.client->read(MemBus::ECU, 0xFFFFFF, 2, outside.on_read()).is_ok()); // past the 24-bit space
+
+    // While one tool waits to send its DM16, another one is told to wait
+    Outcome wrote;
+    auto data = pattern(64, 1);
+    REQUIRE(bus.client->write(MemBus::ECU, 0, data, wrote.on_done()).is_ok());
+    bus.ecu_net.update(1); // DM14 arrives, Proceed goes out
+    REQUIRE(bus.server->busy());
+    DM14Request other;
+    other.command = DM14Command::Read;
+    other.length = 8;
+    bus.ecu_net.inject_message(Message(PGN_DM14, other.encode(), 0x42, MemBus::ECU));
+    CHECK(bus.server->stats().busy == 1);
+    CHECK(bus.server->client() == MemBus::TOOL);
+    REQUIRE(bus.run_until([&] { return wrote.done; }));
+    CHECK(wrote.ok);
+    CHECK(!bus.server->busy());
+}
+
+TEST_CASE("MemoryAccess - resume after an interruption") {
+    RamMemory memory(32 * 1024);
+    MemBus bus(memory, {}, MemoryClientConfig{}.block_size(1000).timeout(200).retry(2));
+    auto image = pattern(20000, 5);
+
+    Outcome wrote;
+    u32 confirmed = 0;
+    bus.client->on_progress.subscribe([&](u32 done, u32) { confirmed = done; });
+    REQUIRE(bus.client->write(MemBus::ECU, 0, image, wrote.on_done()).is_ok());
+    REQUIRE(bus.run_until([&] { return confirmed >= 5000; }));
+    bus.down = true; // the harness is unplugged mid-transfer
+    REQUIRE(bus.run_until([&] { return wrote.done; }));
+    CHECK(!wrote.ok);
+    CHECK(bus.client->resumable());
+    CHECK(bus.client->stats().timeouts == 3);
+    u32 checkpoint = bus.client->progress().done;
+    CHECK(checkpoint >= 5000);
+    CHECK(checkpoint < 20000);
+    CHECK(checkpoint % 1000 == 0);
+
+    bus.down = false;
+    bus.run(2000); // the server drops its abandoned session
+    CHECK(!bus.server->busy());
+    wrote = Outcome{};
+    REQUIRE(bus.client->resume().is_ok());
+    REQUIRE(bus.run_until([&] { return wrote.done; }));
+    CHECK(wrote.ok);
+    CHECK(bus.client->progress().done == 20000);
+    CHECK(std::equal(image.begin(), image.end(), memory.image().begin()));
+    CHECK(bus.server->stats().bytes_written <= 20000 + 1000); // at most the interrupted block again
+    CHECK(!bus.client->resume().is_ok());
+
+    // A tool restarted from a saved checkpoint only sends the rest
+    RamMemory fresh(32 * 1024);
+    MemBus again(fresh, {}, MemoryClientConfig{}.block_size(1000));
+    Outcome rest;
+    REQUIRE(again.client->write(MemBus::ECU, 0, image, rest.on_done(), 15000).is_ok());
+    REQUIRE(again.run_until([&] { return rest.done; }));
+    CHECK(again.server->stats().bytes_written == 5000);
+    CHECK(fresh.image()[14999] == 0xFF);
+    CHECK(fresh.image()[15000] == image[15000]);
+}
+
+TEST_CASE("MemoryAccess - file-backed image") {
+    auto path = std::filesystem::temp_directory_path() / "agrobus_memory_access_test.bin";
+    std::filesystem::remove(path);
+    auto image = pattern(6000, 11);
+    {
+        FileMemory memory(path, 16 * 1024);
+        REQUIRE(memory.open().is_ok());
+        CHECK(std::filesystem::file_size(path) == 16 * 1024);
+        MemBus bus(memory, {}, MemoryClientConfig{}.block_size(DM16_ETP_BLOCK));
+        Outcome wrote;
+        REQUIRE(bus.client->write(MemBus::ECU, 0x400, image, wrote.on_done()).is_ok());
+        REQUIRE(bus.run_until([&] { return wrote.done; }));
+        CHECK(wrote.ok);
+        CHECK(bus.client->stats().blocks == 1);
+        CHECK(memory.flush().is_ok());
+    }
+
+    FileMemory reopened(path, 16 * 1024);
+    REQUIRE(reopened.open().is_ok());
+    dp::Vector<u8> back(6000);
+    REQUIRE(reopened.read(0x400, back.data(), 6000).is_ok());
+    CHECK(back == image);
+    u8 erased = 0;
+    REQUIRE(reopened.read(0x3FF, &erased, 1).is_ok());
+    CHECK(erased == 0xFF);
+    CHECK(!reopened.read(16 * 1024 - 1, back.data(), 2).is_ok());
+    std::filesystem::remove(path);
+}
@@ -1,6 +1,9 @@
 #include <doctest/doctest.h>
 #include <agrobus/isobus/tc/peer_control.hpp>
 #include <agrobus.hpp>
+#include <cstring>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
 
 using namespace agrobus::net;
 using namespace agrobus::j1939;
@@ -156,3 +159,159 @@ TEST_CASE("PeerControlInterface - events") {
     pc.remove_assignment(7, 70);
     CHECK(removed);
 }
+
+// ─── Peer control router ─────────────────────────────────────────────────────
+
+// Records Value commands sent to implements
+class SetpointLink : public wirebit::Link {
+  public:
+    struct Setpoint {
+        Address destination;
+        ElementNumber element;
+        DDI ddi;
+        i32 value;
+    };
+    dp::Vector<Setpoint> sent;
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        if (((cf.can_id >> 16) & 0xFF) == (PGN_TC_TO_ECU >> 8)) {
+            i32 value;
+            std::memcpy(&value, &cf.data[4], 4);
+            sent.push_back({static_cast<Address>((cf.can_id >> 8) & 0xFF),
+                            static_cast<ElementNumber>((cf.data[0] >> 4) | (cf.data[1] << 4)),
+                            static_cast<DDI>(cf.data[2] | (cf.data[3] << 8)), value});
+        }
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "setpoints"; }
+};
+
+static Message source_value(Address from, ElementNumber element, DDI ddi, i32 value) {
+    dp::Vector<u8> data(8);
+    data[0] = static_cast<u8>(ProcessDataCommands::Value) | static_cast<u8>((element & 0x0F) << 4);
+    data[1] = static_cast<u8>(element >> 4);
+    data[2] = static_cast<u8>(ddi & 0xFF);
+    data[3] = static_cast<u8>(ddi >> 8);
+    std::memcpy(&data[4], &value, 4);
+    return Message(PGN_ECU_TO_TC, data, from, 0xF7);
+}
+
+struct RouterNode {
+    std::shared_ptr<SetpointLink> link = std::make_shared<SetpointLink>();
+    wirebit::CanEndpoint ep{link, wirebit::CanConfig{}, 1};
+    IsoNet net;
+    InternalCF *cf = nullptr;
+
+    RouterNode() {
+        net.set_endpoint(0, &ep);
+        cf = net.create_internal(Name{}, 0, 0x10).value();
+    }
+};
+
+TEST_CASE("PeerControlRouter - on-change forwarding") {
+    RouterNode node;
+    PeerControlInterface pc(node.net, node.cf);
+    PeerControlRouter router(node.net, node.cf, pc);
+    REQUIRE(router.initialize().is_ok());
+
+    // Sensor implement 0x90 element 2 downforce -> seeder 0x80 element 5
+    pc.add_assignment(PeerControlAssignment{}.source(0x90).from(2, 0x1F4).destination(0x80).to(5, 0x1F5));
+    pc.add_assignment(PeerControlAssignment{}.source(0x90).from(2, 0x1F4).destination(0x81).to(1, 0x1F5));
+
+    // Inactive assignments do not forward
+    node.net.inject_message(source_value(0x90, 2, 0x1F4, 100));
+    CHECK(node.link->sent.empty());
+    CHECK(router.routes().empty());
+
+    pc.activate_assignment(2, 0x1F4, true);
+    REQUIRE(router.routes().size() == 1); // the second assignment was rejected as a duplicate
+    node.net.inject_message(source_value(0x90, 2, 0x1F4, 1200));
+    REQUIRE(node.link->sent.size() == 1);
+    CHECK(node.link->sent[0].destination == 0x80);
+    CHECK(node.link->sent[0].element == 5);
+    CHECK(node.link->sent[0].ddi == 0x1F5);
+    CHECK(node.link->sent[0].value == 1200);
+
+    // Unchanged value is suppressed, a new one goes out
+    node.net.inject_message(source_value(0x90, 2, 0x1F4, 1200));
+    node.net.inject_message(source_value(0x90, 2, 0x1F4, 1300));
+    REQUIRE(node.link->sent.size() == 2);
+    CHECK(node.link->sent[1].value == 1300);
+    CHECK(router.stats().received == 3);
+    CHECK(router.stats().suppressed == 1);
+    CHECK(router.stats().forwarded == 2);
+
+    // Other sources and DDIs are ignored
+    node.net.inject_message(source_value(0x91, 2, 0x1F4, 5));
+    node.net.inject_message(source_value(0x90, 3, 0x1F4, 5));
+    CHECK(node.link->sent.size() == 2);
+
+    // Locally produced values use the router's own address
+    pc.add_assignment(PeerControlAssignment{}.from(7, 0x0001).destination(0x82).to(1, 0x0001));
+    pc.activate_assignment(7, 0x0001, true);
+    router.publish(7, 0x0001, 42);
+    REQUIRE(node.link->sent.size() == 3);
+    CHECK(node.link->sent[2].destination == 0x82);
+
+    pc.clear_assignments();
+    node.net.inject_message(source_value(0x90, 2, 0x1F4, 1400));
+    CHECK(node.link->sent.size() == 3);
+}
+
+TEST_CASE("PeerControlRouter - outlived by its assignment interface") {
+    RouterNode node;
+    PeerControlInterface pc(node.net, node.cf);
+    {
+        PeerControlRouter router(node.net, node.cf, pc);
+        pc.add_assignment(PeerControlAssignment{}.source(0x90).from(2, 0x1F4).destination(0x80).to(5, 0x1F5));
+        pc.activate_assignment(2, 0x1F4, true);
+        CHECK(router.routes().size() == 1);
+    }
+    // The destroyed router no longer listens for assignment changes
+    pc.activate_assignment(2, 0x1F4, false);
+    pc.clear_assignments();
+    CHECK(pc.assignments().empty());
+}
+
+TEST_CASE("PeerControlRouter - fixed-rate forwarding and latency") {
+    RouterNode node;
+    PeerControlInterface pc(node.net, node.cf);
+    PeerControlRouter router(node.net, node.cf, pc);
+    router.initialize();
+
+    u64 clock_us = 0;
+    router.set_clock([&] { return clock_us; });
+
+    PeerControlAssignment a;
+    a.source(0x90).from(1, 0x0086).destination(0x80).to(1, 0x0086).every(20); // 50 Hz
+    a.active = true;
+    pc.add_assignment(a);
+
+    // Nothing to send before the first source value
+    router.update(20);
+    CHECK(node.link->sent.empty());
+
+    node.net.inject_message(source_value(0x90, 1, 0x0086, 7));
+    CHECK(node.link->sent.empty()); // fixed-rate waits for its slot
+
+    // 1 s at 5 ms ticks
+    for (u32 i = 0; i < 200; ++i) {
+        clock_us += 5000;
+        if (i % 4 == 1)
+            node.net.inject_message(source_value(0x90, 1, 0x0086, static_cast<i32>(i)));
+        router.update(5);
+    }
+    CHECK(node.link->sent.size() >= 49);
+    CHECK(node.link->sent.size() <= 51);
+    CHECK(node.link->sent.back().value == 197);
+
+    const auto &route = router.routes().front();
+    CHECK(route.stats.forwarded == node.link->sent.size());
+    CHECK(route.stats.latency_max_us <= 20000);
+    CHECK(route.stats.avg_latency_us() > 0.0);
+}
@@ -0,0 +1,265 @@
+#include <doctest/doctest.h>
+#include <agrobus/j1939/engine.hpp>
+#include <agrobus/j1939/signal_db.hpp>
+#include <cmath>
+
+using namespace agrobus::j1939;
+
+static constexpr u8 EEC1_BYTES[8] = {0x9B, 0x7D, 0x80, 0xE0, 0x2E, 0x00, 0x03, 0xFF}; // 1500 rpm, 30 % torque
+static_assert(raw_value<spns::EngineSpeed>(EEC1_BYTES) == 12000);
+static_assert(raw_value<spns::ActualEngineTorque>(EEC1_BYTES) == 0x9B);
+static_assert(raw_value<spns::StarterMode>(EEC1_BYTES) == 3);
+
+static void check_all(const SignalDef *const *defs, usize n, PGN pgn, const dp::Vector<u8> &data,
+                      const dp::Vector<f64> &expected) {
+    usize e = 0;
+    for (usize i = 0; i < n; ++i) {
+        if (defs[i]->pgn != pgn)
+            continue;
+        u64 raw = extract_bits(data.data(), defs[i]->start_bit, defs[i]->length);
+        REQUIRE(e < expected.size());
+        CHECK(defs[i]->physical(raw) == doctest::Approx(expected[e++]));
+    }
+    CHECK(e == expected.size());
+}
+
+TEST_CASE("SignalDB - definitions agree with the hand-written decoders") {
+    EEC1 eec1;
+    eec1.engine_torque_percent = 30.0;
+    eec1.driver_demand_percent = 0.0;
+    eec1.actual_engine_percent = 3.0;
+    eec1.engine_speed_rpm = 1500.0;
+    eec1.starter_mode = 3;
+    auto data = eec1.encode();
+    CHECK(*decode<spns::EngineSpeed>(data.data(), data.size()) == 1500.0);
+    CHECK(*decode<spns::ActualEngineTorque>(data.data(), data.size()) == 30.0);
+    CHECK(*decode<spns::StarterMode>(data.data(), data.size()) == 3.0);
+    CHECK(!decode<spns::EngineSpeed>(data.data(), 4).has_value()); // too short
+
+    constexpr auto N = std::size(spns::ENGINE);
+    EngineTemp1 et1;
+    et1.coolant_temp_c = 85.0;
+    et1.fuel_temp_c = 40.0;
+    et1.oil_temp_c = 102.5;
+    et1.turbo_oil_temp_c = 110.0;
+    et1.intercooler_temp_c = 45.0;
+    auto t = EngineTemp1::decode(et1.encode());
+    check_all(spns::ENGINE, N, PGN_ET1, et1.encode(),
+              {t.coolant_temp_c, t.fuel_temp_c, t.oil_temp_c, t.turbo_oil_temp_c, t.intercooler_temp_c});
+
+    EngineFluidLP fl;
+    fl.fuel_delivery_pressure_kpa = 400.0;
+    fl.oil_pressure_kpa = 300.0;
+    fl.coolant_pressure_kpa = 100.0;
+    fl.oil_level_percent = 200;
+    fl.coolant_level_percent = 150;
+    fl.crankcase_pressure_kpa = 1.5;
+    auto f = EngineFluidLP::decode(fl.encode());
+    check_all(spns::ENGINE, N, PGN_EFLP, fl.encode(),
+              {f.fuel_delivery_pressure_kpa, f.oil_pressure_kpa, f.coolant_pressure_kpa, f.oil_level_percent * 0.4,
+               f.coolant_level_percent * 0.4, f.crankcase_pressure_kpa});
+
+    EngineHours hours;
+    hours.total_hours = 1234.5;
+    hours.total_revolutions = 5'000'000.0;
+    auto h = EngineHours::decode(hours.encode());
+    check_all(spns::ENGINE, N, PGN_ENGINE_HOURS, hours.encode(), {h.total_hours, h.total_revolutions});
+
+    AmbientConditions amb;
+    amb.barometric_pressure_kpa = 101.0;
+    amb.ambient_air_temp_c = 21.5;
+    amb.intake_air_temp_c = 30.0;
+    amb.road_surface_temp_c = 18.0;
+    auto a = AmbientConditions::decode(amb.encode());
+    check_all(spns::ENGINE, N, PGN_AMBIENT_CONDITIONS, amb.encode(),
+              {a.barometric_pressure_kpa, a.ambient_air_temp_c, a.intake_air_temp_c, a.road_surface_temp_c});
+
+    // "Not available" is not a value
+    dp::Vector<u8> na(8, 0xFF);
+    CHECK(!decode<spns::EngineSpeed>(na.data(), na.size()).has_value());
+    CHECK(!decode<spns::AccelPedalLowIdle>(na.data(), na.size()).has_value());
+    na[3] = 0x00;
+    na[4] = 0xFB; // error indicator range
+    CHECK(!decode<spns::EngineSpeed>(na.data(), na.size()).has_value());
+    na[4] = 0xFA;
+    CHECK(decode<spns::EngineSpeed>(na.data(), na.size()).has_value());
+
+    auto db = SignalDB::engine();
+    CHECK(db.size() == N);
+    REQUIRE(db.find(190) != nullptr);
+    CHECK(db.find(190)->name == "EngineSpeed");
+    CHECK(db.find("CoolantTemp")->spn == 110);
+    REQUIRE(db.of(PGN_ET1) != nullptr);
+    CHECK(db.of(PGN_ET1)->size() == 5);
+    CHECK(db.find(9999) == nullptr);
+}
+
+TEST_CASE("SignalDB - DBC import") {
+    const char *dbc = R"(VERSION ""
+
+BO_ 2364540158 EEC1: 8 Vector__XXX
+ SG_ EngineSpeed : 24|16@1+ (0.125,0) [0|8031.875] "rpm" Vector__XXX
+ SG_ ActualEngineTorque : 0|8@1+ (1,-125) [-125|125] "%" Vector__XXX
+ SG_ MotorolaThing : 7|8@0+ (1,0) [0|255] "" Vector__XXX
+BO_ 2566844926 CCVS1: 8 Vector__XXX
+ SG_ WheelBasedVehicleSpeed : 8|16@1+ (0.00390625,0) [0|250.996] "km/h" Vector__XXX
+ SG_ Offset : 40|8@1- (1,0) [-128|127] "" Vector__XXX
+BO_ 100 Standard: 8 Vector__XXX
+ SG_ Ignored : 0|8@1+ (1,0) [0|255] "" Vector__XXX
+
+BA_ "SPN" SG_ 2364540158 EngineSpeed 190;
+BA_ "SPN" SG_ 2566844926 WheelBasedVehicleSpeed 84;
+)";
+    SignalDB db;
+    auto added = db.import_dbc(dbc);
+    REQUIRE(added.is_ok());
+    CHECK(added.value() == 4); // Motorola and 11-bit signals skipped
+
+    const SignalDef *speed = db.find(190);
+    REQUIRE(speed != nullptr);
+    CHECK(speed->pgn == PGN_EEC1);
+    CHECK(speed->start_bit == spns::EngineSpeed.start_bit);
+    CHECK(speed->length == 16);
+    CHECK(speed->scale == 0.125);
+    CHECK(speed->unit == "rpm");
+
+    const SignalDef *wheel = db.find(84);
+    REQUIRE(wheel != nullptr);
+    CHECK(wheel->pgn == 0xFEF1);
+    CHECK(db.find("ActualEngineTorque")->offset == -125.0);
+    CHECK(db.find("ActualEngineTorque")->spn == 0); // no SPN attribute
+    CHECK(db.find("MotorolaThing") == nullptr);
+
+    const SignalDef *offset = db.find("Offset");
+    REQUIRE(offset != nullptr);
+    CHECK(offset->is_signed);
+    CHECK(offset->physical(0xFE) == -2.0);
+
+    SignalDB broken;
+    CHECK(!broken.import_dbc("BO_ 2364540158 EEC1: 8 X\n SG_ Speed 24|16@1+ (0.125,0)\n").is_ok());
+}
+
+TEST_CASE("SignalDecoder - decodes only subscribed signals") {
+    IsoNet nm;
+    auto db = SignalDB::engine();
+    SignalDecoder decoder(db);
+    decoder.attach(nm);
+
+    dp::Vector<f64> speeds;
+    auto token = decoder.subscribe(190, [&](f64 rpm, Address source) {
+        CHECK(source == 0x00);
+        speeds.push_back(rpm);
+    });
+    REQUIRE(token.is_ok());
+    CHECK(!decoder.subscribe(4242, [](f64, Address) {}).is_ok());
+
+    EEC1 eec1;
+    eec1.engine_speed_rpm = 1800.0;
+    nm.inject_message(Message(PGN_EEC1, eec1.encode(), 0x00));
+    EngineTemp1 et1;
+    nm.inject_message(Message(PGN_ET1, et1.encode(), 0x00));
+    REQUIRE(speeds.size() == 1);
+    CHECK(speeds[0] == 1800.0);
+    CHECK(decoder.decoded() == 1); // nothing from EEC1's other SPNs or from ET1
+
+    // A subscription made later is served too
+    f64 coolant = 0;
+    decoder.subscribe(spns::CoolantTemp, [&](f64 c, Address) { coolant = c; });
+    et1.coolant_temp_c = 90.0;
+    nm.inject_message(Message(PGN_ET1, et1.encode(), 0x00));
+    CHECK(coolant == 90.0);
+
+    CHECK(decoder.unsubscribe(token.value()));
+    nm.inject_message(Message(PGN_EEC1, eec1.encode(), 0x00));
+    CHECK(speeds.size() == 1);
+
+    // EngineInterface no longer decodes PGNs nobody listens to
+    auto *cf = nm.create_internal(Name{}, 0, 0x28).value();
+    EngineInterface engine(nm, cf);
+    REQUIRE(engine.initialize().is_ok());
+    nm.inject_message(Message(PGN_EEC1, eec1.encode(), 0x00));
+    f64 rpm = 0;
+    engine.on_eec1.subscribe([&](EEC1 msg, Address) { rpm = msg.engine_speed_rpm; });
+    nm.inject_message(Message(PGN_EEC1, eec1.encode(), 0x00));
+    CHECK(rpm == 1800.0);
+}
+
+TEST_CASE("SignalDecoder - callbacks may unsubscribe and subscribe") {
+    auto db = SignalDB::engine();
+    SignalDecoder decoder(db);
+    EEC1 eec1;
+    eec1.engine_speed_rpm = 1200.0;
+    auto data = eec1.encode();
+
+    usize once = 0, always = 0, late = 0;
+    ListenerToken self = INVALID_TOKEN;
+    self = decoder
+               .subscribe(190,
+                          [&](f64, Address) {
+                              ++once;
+                              CHECK(decoder.unsubscribe(self));
+                              decoder.subscribe(190, [&](f64, Address) { ++late; });
+                          })
+               .value();
+    decoder.subscribe(190, [&](f64, Address) { ++always; });
+
+    decoder.feed(PGN_EEC1, data.data(), data.size(), 0x00);
+    CHECK(once == 1);
+    CHECK(always == 1);
+    CHECK(late == 0); // added during dispatch, served from the next frame
+
+    decoder.feed(PGN_EEC1, data.data(), data.size(), 0x00);
+    CHECK(once == 1);
+    CHECK(always == 2);
+    CHECK(late == 1);
+}
+
+TEST_CASE("SignalDB - batch decode of logged frames") {
+    auto db = SignalDB::engine();
+    dp::Vector<Frame> log;
+    for (u32 i = 0; i < 100; ++i) {
+        EEC1 eec1;
+        eec1.engine_speed_rpm = 800.0 + i;
+        auto d = eec1.encode();
+        log.push_back(Frame::from_message(Priority::Default, PGN_EEC1, 0x00, BROADCAST_ADDRESS, d.data()));
+        EngineTemp1 et1;
+        et1.coolant_temp_c = static_cast<f64>(i % 50);
+        auto t = et1.encode();
+        if (i == 7)
+            t[0] = 0xFE; // sensor not available
+        log.push_back(Frame::from_message(Priority::Default, PGN_ET1, 0x00, BROADCAST_ADDRESS, t.data()));
+    }
+    u8 short_et1[2] = {0x60, 0x50};
+    log.push_back(Frame::from_message(Priority::Default, PGN_ET1, 0x00, BROADCAST_ADDRESS, short_et1, 2));
+
+    BatchDecoder batch({db.find(190), db.find(110), db.find(175)});
+    const auto &columns = batch.decode(log.data(), log.size());
+    REQUIRE(columns.size() == 3);
+    REQUIRE(columns[0].value.size() == 100);
+    for (u32 i = 0; i < 100; ++i) {
+        CHECK(columns[0].frame[i] == 2 * i);
+        CHECK(columns[0].value[i] == 800.0 + i);
+    }
+    REQUIRE(columns[1].value.size() == 101);
+    CHECK(columns[1].frame[3] == 7);
+    CHECK(columns[1].value[3] == 3.0);
+    CHECK(std::isnan(columns[1].value[7]));
+    CHECK(columns[1].value[100] == 0x60 - 40.0);
+    CHECK(std::isnan(columns[2].value[100])); // oil temperature lies past the 2 bytes received
+
+    // Same values as decoding frame by frame
+    for (usize i = 0; i < columns[1].value.size(); ++i) {
+        const auto &frame = log[columns[1].frame[i]];
+        auto one = decode<spns::CoolantTemp>(frame.data.data(), frame.length);
+        CHECK(one.has_value() == !std::isnan(columns[1].value[i]));
+        if (one)
+            CHECK(*one == columns[1].value[i]);
+    }
+
+    // The next chunk replaces the columns
+    batch.decode(log.data() + 1, 2);
+    REQUIRE(columns[0].value.size() == 1);
+    CHECK(columns[0].frame[0] == 1);
+    CHECK(columns[0].value[0] == 801.0);
+    CHECK(columns[1].value.size() == 1);
+}
@@ -0,0 +1,130 @@
+#include <doctest/doctest.h>
+#include <agrobus/j1939/diagnostic.hpp>
+#include <agrobus/j1939/engine.hpp>
+
+using namespace agrobus::j1939;
+
+static void send_eec1(IsoNet &nm, f64 rpm) {
+    EEC1 eec1;
+    eec1.engine_speed_rpm = rpm;
+    eec1.engine_torque_percent = 40.0;
+    nm.inject_message(Message(PGN_EEC1, eec1.encode(), 0x00));
+}
+
+static dp::Optional<u32> value_of(const FreezeFrame &ff, u32 spn) {
+    for (const auto &snap : ff.snapshots)
+        if (snap.spn == spn)
+            return snap.value;
+    return dp::nullopt;
+}
+
+TEST_CASE("SignalHistory - decodes configured SPNs from received PGNs") {
+    IsoNet nm;
+    SignalHistory history(SignalHistoryConfig{}.engine_signals());
+    REQUIRE(history.attach(nm).is_ok());
+    CHECK(history.signal_count() == 9);
+
+    send_eec1(nm, 1500.0);
+    REQUIRE(history.latest(190).has_value());
+    CHECK(*history.latest(190) == 12000); // 0.125 rpm/bit
+    CHECK(*history.latest(513) == 165);
+    CHECK(!history.latest(110).has_value()); // no ET1 yet
+    CHECK(!history.latest(9999).has_value());
+
+    EngineTemp1 et1;
+    et1.coolant_temp_c = 90.0;
+    et1.oil_temp_c = 100.0;
+    nm.inject_message(Message(PGN_ET1, et1.encode(), 0x00));
+    CHECK(*history.latest(110) == 130);
+    CHECK(*history.latest(175) == static_cast<u32>((100.0 + 273.0) / 0.03125));
+
+    // "Not available" keeps the last valid value
+    dp::Vector<u8> na(8, 0xFF);
+    nm.inject_message(Message(PGN_EEC1, na, 0x00));
+    CHECK(*history.latest(190) == 12000);
+}
+
+TEST_CASE("SignalHistory - bounded ring keeps the newest samples") {
+    SignalHistory history(SignalHistoryConfig{}.signal(100, 0xFF10, 0, 16).samples(8));
+    CHECK(history.memory_bytes() == 8 * sizeof(u64));
+    for (u16 i = 0; i < 100; ++i) {
+        u8 data[2] = {static_cast<u8>(i), 0};
+        history.feed(0xFF10, data, sizeof(data));
+        history.update(10);
+    }
+    CHECK(history.samples() == 100);
+    CHECK(*history.latest(100) == 99);
+
+    // Four instants 20 ms apart ending now (t = 1000); sample i was taken at
+    // t = 10 * i
+    dp::Vector<u32> seen(4, 0xFFFF);
+    history.capture(4, 20, [&](u8 frame, u32, u32 spn, u32 value) {
+        CHECK(spn == 100);
+        seen[frame] = value;
+    });
+    CHECK(seen[3] == 99);
+    CHECK(seen[2] == 98);
+    CHECK(seen[1] == 96);
+    CHECK(seen[0] == 94);
+
+    // Instants older than the ring reaches are left out
+    dp::Vector<u8> frames;
+    history.capture(20, 100, [&](u8 frame, u32, u32, u32) { frames.push_back(frame); });
+    REQUIRE(frames.size() == 1);
+    CHECK(frames[0] == 19);
+}
+
+TEST_CASE("DiagnosticProtocol - freeze frames sample the signal history") {
+    IsoNet nm;
+    auto *cf = nm.create_internal(Name{}, 0, 0x28).value();
+    DiagnosticProtocol diag(nm, cf, DiagnosticConfig{}.freeze_frame_depth(4));
+    SignalHistory history(SignalHistoryConfig{}.engine_signals().pre_trigger(300, 3));
+    REQUIRE(history.attach(nm).is_ok());
+    diag.attach_signal_history(history);
+
+    // Engine speed climbs 100 rpm every 100 ms
+    for (u32 i = 0; i <= 10; ++i) {
+        history.update(100);
+        send_eec1(nm, 1000.0 + 100.0 * i);
+    }
+    diag.set_active({190, FMI::AboveNormal, 0});
+
+    // Frame 0 is the trigger, frame N is N * 100 ms earlier
+    for (u8 n = 0; n < 4; ++n) {
+        auto ff = diag.get_freeze_frame(190, FMI::AboveNormal, n);
+        REQUIRE(ff.has_value());
+        CHECK(ff->timestamp_ms == 1100 - 100u * n);
+        auto rpm = value_of(*ff, 190);
+        REQUIRE(rpm.has_value());
+        CHECK(*rpm == static_cast<u32>((2000.0 - 100.0 * n) / 0.125));
+        CHECK(value_of(*ff, 513).has_value());
+        CHECK(!value_of(*ff, 110).has_value()); // never received
+    }
+    CHECK(!diag.get_freeze_frame(190, FMI::AboveNormal, 4).has_value());
+
+    // Snapshots go out on DM25 unchanged
+    auto ff = diag.get_freeze_frame(190, FMI::AboveNormal, 0);
+    auto decoded = FreezeFrame::decode(ff->encode());
+    CHECK(decoded.snapshots.size() == ff->snapshots.size());
+
+    // The explicit form still stores exactly what it is given
+    diag.capture_freeze_frame({520, FMI::Erratic, 1}, {{520, 7}});
+    REQUIRE(diag.get_freeze_frame(520, FMI::Erratic).has_value());
+    CHECK(diag.get_freeze_frame(520, FMI::Erratic)->snapshots.size() == 1);
+}
+
+TEST_CASE("DiagnosticProtocol - the largest pre-trigger setting still captures") {
+    IsoNet nm;
+    auto *cf = nm.create_internal(Name{}, 0, 0x28).value();
+    DiagnosticProtocol diag(nm, cf, DiagnosticConfig{}.freeze_frame_depth(255));
+    SignalHistory history(SignalHistoryConfig{}.engine_signals().pre_trigger(2540, 255));
+    REQUIRE(history.attach(nm).is_ok());
+    diag.attach_signal_history(history);
+    history.update(100);
+    send_eec1(nm, 1500.0);
+
+    diag.set_active({190, FMI::AboveNormal, 0});
+    CHECK(diag.get_freeze_frame(190, FMI::AboveNormal, 0).has_value());
+    CHECK(diag.get_freeze_frame(190, FMI::AboveNormal, 254).has_value()); // clamped to 254 pre-trigger frames
+    CHECK(!diag.get_freeze_frame(190, FMI::AboveNormal, 255).has_value());
+}
@@ -0,0 +1,329 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/tc/client.hpp>
+#include <agrobus/isobus/tc/ddop_cache.hpp>
+#include <agrobus/isobus/tc/server.hpp>
+#include <cstring>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::tc;
+
+static DDOP make_ddop(const char *designator = "Sprayer") {
+    DDOP ddop;
+    DeviceObject dev;
+    dev.id = 1;
+    dev.designator = designator;
+    dev.localization_label = {'e', 'n', 0, 0, 0, 0, 0xFF};
+    ddop.add_device(dev);
+    DeviceElement elem;
+    elem.id = 2;
+    elem.parent_id = 1;
+    elem.type = DeviceElementType::Device;
+    elem.designator = "Root";
+    ddop.add_element(elem);
+    return ddop;
+}
+
+static dp::Vector<u8> transfer_message(const DDOP &ddop) {
+    auto data = ddop.serialize().value();
+    data.insert(data.begin(), tc_cmd::OBJECT_POOL_TRANSFER);
+    return data;
+}
+
+// Records CAN frames sent on one node so tests can forward them to another
+class CaptureLink : public wirebit::Link {
+    dp::Vector<can_frame> tx_;
+    usize cursor_ = 0;
+
+  public:
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        tx_.push_back(cf);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "capture"; }
+
+    // Single-frame TC messages sent since the last call
+    dp::Vector<Message> take(PGN pgn) {
+        dp::Vector<Message> out;
+        for (; cursor_ < tx_.size(); ++cursor_) {
+            const auto &cf = tx_[cursor_];
+            if (((cf.can_id >> 16) & 0xFF) != (pgn >> 8))
+                continue;
+            dp::Vector<u8> data(cf.data, cf.data + 8);
+            out.push_back(Message(pgn, data, static_cast<Address>(cf.can_id & 0xFF),
+                                  static_cast<Address>((cf.can_id >> 8) & 0xFF)));
+        }
+        return out;
+    }
+
+    usize frame_count() const noexcept { return tx_.size(); }
+};
+
+struct Node {
+    std::shared_ptr<CaptureLink> link = std::make_shared<CaptureLink>();
+    wirebit::CanEndpoint ep{link, wirebit::CanConfig{}, 1};
+    IsoNet net;
+    InternalCF *cf = nullptr;
+
+    explicit Node(Address addr) {
+        net.set_endpoint(0, &ep);
+        cf = net.create_internal(Name{}, 0, addr).value();
+    }
+};
+
+TEST_CASE("DDOP content label") {
+    auto a = make_ddop();
+    auto b = make_ddop();
+    CHECK(a.content_label() == b.content_label());
+    CHECK(a.content_label() != make_ddop("Spreader").content_label());
+
+    // Labels themselves do not feed the hash
+    CHECK(a.stamp_structure_label());
+    CHECK(a.devices().front().structure_label == b.content_label());
+    CHECK(a.content_label() == b.content_label());
+    CHECK_FALSE(a.stamp_structure_label()); // already set
+
+    auto manual = make_ddop();
+    DeviceObject dev = manual.devices().front();
+    dev.structure_label = {'M', 'Y', 'P', 'O', 'O', 'L', '1'};
+    DDOP with_label;
+    with_label.add_device(dev);
+    CHECK_FALSE(with_label.stamp_structure_label());
+}
+
+TEST_CASE("DDOPCache stores, evicts and persists") {
+    DDOPCache cache(2);
+    auto pool = make_ddop();
+    pool.stamp_structure_label();
+    REQUIRE(cache.store(0x1111, pool.serialize().value()).is_ok());
+    REQUIRE(cache.store(0x2222, make_ddop("Seeder").serialize().value()).is_ok());
+    CHECK(cache.store(0x3333, dp::Vector<u8>{1, 2}).is_err());
+
+    auto *hit = cache.find(0x1111);
+    REQUIRE(hit != nullptr);
+    CHECK(hit->structure_label == pool.devices().front().structure_label);
+    CHECK(hit->localization_label[0] == 'e');
+    CHECK(hit->ddop.object_count() == 2);
+
+    // 0x2222 is now least recently used
+    REQUIRE(cache.store(0x4444, make_ddop("Baler").serialize().value()).is_ok());
+    CHECK(cache.size() == 2);
+    CHECK(cache.contains(0x1111));
+    CHECK_FALSE(cache.contains(0x2222));
+
+    auto path = std::filesystem::temp_directory_path() / "agrobus_ddop_cache.bin";
+    REQUIRE(cache.save(path).is_ok());
+    DDOPCache reloaded;
+    auto loaded = reloaded.load(path);
+    REQUIRE(loaded.is_ok());
+    CHECK(loaded.value() == 2);
+    REQUIRE(reloaded.find(0x1111) != nullptr);
+    CHECK(reloaded.find(0x1111)->structure_label == pool.devices().front().structure_label);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("TaskControllerServer answers labels from its DDOP cache") {
+    Node tc(0x30);
+    TaskControllerServer server(tc.net, tc.cf);
+    server.start();
+    server.set_client_name(0x81, 0xA1B2C3D4);
+    CHECK(server.clients().empty()); // the NAME waits for the client's first message
+    CHECK(server.state() == TCServerState::WaitForClients);
+
+    auto pool = make_ddop();
+    pool.stamp_structure_label();
+    const auto &label = pool.devices().front().structure_label;
+
+    // Nothing stored yet
+    tc.net.inject_message(Message(PGN_ECU_TO_TC, {tc_cmd::STRUCTURE_LABEL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+                                  0x81, 0x30));
+    auto sent = tc.link->take(PGN_TC_TO_ECU);
+    REQUIRE(sent.size() == 1);
+    CHECK(sent[0].data[0] == tc_cmd::STRUCTURE_LABEL_RESPONSE);
+    CHECK(sent[0].data[1] == 0xFF);
+
+    tc.net.inject_message(Message(PGN_ECU_TO_TC, transfer_message(pool), 0x81, 0x30));
+    sent = tc.link->take(PGN_TC_TO_ECU);
+    REQUIRE(sent.size() == 1);
+    CHECK(sent[0].data[0] == tc_cmd::OBJECT_POOL_RESPONSE);
+    CHECK(sent[0].data[1] == 0);
+    CHECK(server.ddop_cache().size() == 1);
+
+    // Same implement at a new address after key-off
+    server.set_client_name(0x85, 0xA1B2C3D4);
+    tc.net.inject_message(Message(PGN_ECU_TO_TC, {tc_cmd::STRUCTURE_LABEL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+                                  0x85, 0x30));
+    tc.net.inject_message(Message(PGN_ECU_TO_TC,
+                                  {tc_cmd::LOCALIZATION_LABEL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, 0x85, 0x30));
+    sent = tc.link->take(PGN_TC_TO_ECU);
+    REQUIRE(sent.size() == 2);
+    for (usize i = 0; i < 7; ++i)
+        CHECK(sent[0].data[1 + i] == label[i]);
+    CHECK(sent[1].data[0] == tc_cmd::LOCALIZATION_LABEL_RESPONSE);
+    CHECK(sent[1].data[1] == 'e');
+
+    // Activation without transfer picks up the cached pool
+    tc.net.inject_message(Message(PGN_ECU_TO_TC, {tc_cmd::ACTIVATE_POOL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+                                  0x85, 0x30));
+    sent = tc.link->take(PGN_TC_TO_ECU);
+    REQUIRE(sent.size() == 1);
+    CHECK(sent[0].data[0] == tc_cmd::ACTIVATE_RESPONSE);
+    CHECK(sent[0].data[1] == 0);
+    REQUIRE(server.clients().size() == 2);
+    CHECK(server.clients()[1].pool_activated);
+    CHECK(server.clients()[1].ddop.object_count() == 2);
+
+    SUBCASE("unknown client cannot activate") {
+        tc.net.inject_message(Message(
+            PGN_ECU_TO_TC, {tc_cmd::ACTIVATE_POOL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, 0x86, 0x30));
+        sent = tc.link->take(PGN_TC_TO_ECU);
+        REQUIRE(sent.size() == 1);
+        CHECK(sent[0].data[1] != 0);
+    }
+}
+
+TEST_CASE("TaskControllerServer restarts the handshake for a client at the same address") {
+    Node tc(0x30);
+    TaskControllerServer server(tc.net, tc.cf);
+    server.start();
+    server.set_client_name(0x81, 0xA1B2C3D4);
+
+    auto pool = make_ddop();
+    pool.stamp_structure_label();
+    const auto &label = pool.devices().front().structure_label;
+    const dp::Vector<u8> activate{tc_cmd::ACTIVATE_POOL, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+    tc.net.inject_message(Message(PGN_ECU_TO_TC, transfer_message(pool), 0x81, 0x30));
+    tc.net.inject_message(Message(PGN_ECU_TO_TC, activate, 0x81, 0x30));
+    tc.link->take(PGN_TC_TO_ECU);
+    REQUIRE(server.clients().size() == 1);
+    REQUIRE(server.clients()[0].pool_activated);
+
+    // Implement power-cycled: it claims the same address and asks for labels again
+    tc.net.inject_message(Message(PGN_ECU_TO_TC, {tc_cmd::STRUCTURE_LABEL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+                                  0x81, 0x30));
+    auto sent = tc.link->take(PGN_TC_TO_ECU);
+    REQUIRE(sent.size() == 1);
+    CHECK(sent[0].data[0] == tc_cmd::STRUCTURE_LABEL_RESPONSE);
+    for (usize i = 0; i < 7; ++i)
+        CHECK(sent[0].data[1 + i] == label[i]);
+    CHECK_FALSE(server.clients()[0].pool_activated);
+
+    SUBCASE("activation reloads the cached pool") {
+        tc.net.inject_message(Message(PGN_ECU_TO_TC, activate, 0x81, 0x30));
+        sent = tc.link->take(PGN_TC_TO_ECU);
+        REQUIRE(sent.size() == 1);
+        CHECK(sent[0].data[0] == tc_cmd::ACTIVATE_RESPONSE);
+        CHECK(sent[0].data[1] == 0);
+        CHECK(server.clients()[0].pool_activated);
+        CHECK(server.clients()[0].ddop.object_count() == 2);
+    }
+
+    SUBCASE("a new pool replaces the old one") {
+        tc.net.inject_message(Message(PGN_ECU_TO_TC, transfer_message(make_ddop("Seeder")), 0x81, 0x30));
+        sent = tc.link->take(PGN_TC_TO_ECU);
+        REQUIRE(sent.size() == 1);
+        CHECK(sent[0].data[0] == tc_cmd::OBJECT_POOL_RESPONSE);
+        CHECK(sent[0].data[1] == 0);
+        CHECK(server.clients()[0].ddop.devices().front().designator == "Seeder");
+    }
+
+    SUBCASE("activation code 0 deactivates") {
+        tc.net.inject_message(Message(PGN_ECU_TO_TC, activate, 0x81, 0x30));
+        tc.link->take(PGN_TC_TO_ECU);
+        REQUIRE(server.clients()[0].pool_activated);
+        tc.net.inject_message(
+            Message(PGN_ECU_TO_TC, {tc_cmd::ACTIVATE_POOL, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, 0x81, 0x30));
+        sent = tc.link->take(PGN_TC_TO_ECU);
+        REQUIRE(sent.size() == 1);
+        CHECK(sent[0].data[0] == tc_cmd::ACTIVATE_RESPONSE);
+        CHECK(sent[0].data[1] == 0);
+        CHECK_FALSE(server.clients()[0].pool_activated);
+        CHECK(server.clients()[0].routes.empty());
+    }
+}
+
+// Forward single-frame TC traffic between the nodes and tick the client
+static void pump(Node &implement, Node &tc, TaskControllerClient &client, u32 rounds, u32 elapsed_ms = 10) {
+    for (u32 i = 0; i < rounds; ++i) {
+        client.update(elapsed_ms);
+        for (auto &msg : implement.link->take(PGN_ECU_TO_TC))
+            tc.net.inject_message(msg);
+        for (auto &msg : tc.link->take(PGN_TC_TO_ECU))
+            implement.net.inject_message(msg);
+    }
+}
+
+static void start_handshake(Node &implement, TaskControllerClient &client) {
+    REQUIRE(client.connect().is_ok());
+    implement.net.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::TC_STATUS, 0, 0, 0, 0, 0, 0, 0}, 0x30, 0x28));
+    client.update(0);
+    client.update(0);
+    implement.net.inject_message(
+        Message(PGN_TC_TO_ECU, {tc_cmd::VERSION_RESPONSE, 4, 1, 48, 0, 0xFF, 0xFF, 0xFF}, 0x30, 0x28));
+}
+
+TEST_CASE("TaskControllerClient skips the DDOP transfer when labels match") {
+    Node tc(0x30);
+    Node implement(0x28);
+    TaskControllerServer server(tc.net, tc.cf);
+    server.start();
+    server.set_client_name(0x28, 0x55AA);
+
+    // The TC stored this pool during an earlier session
+    auto stored = make_ddop();
+    stored.stamp_structure_label();
+    REQUIRE(server.ddop_cache().store(0x55AA, stored.serialize().value()).is_ok());
+
+    TaskControllerClient client(implement.net, implement.cf);
+    client.set_ddop(make_ddop());
+    start_handshake(implement, client);
+    usize frames_before = implement.link->frame_count();
+    pump(implement, tc, client, 10);
+
+    CHECK(client.state() == TCState::Connected);
+    CHECK(client.transfer_skipped());
+    CHECK(implement.link->frame_count() - frames_before == 3); // two label requests + activate
+    CHECK(server.clients()[0].pool_activated);
+}
+
+TEST_CASE("TaskControllerClient transfers the DDOP when labels differ") {
+    Node tc(0x30);
+    Node implement(0x28);
+    TaskControllerServer server(tc.net, tc.cf);
+    server.start();
+    server.set_client_name(0x28, 0x55AA);
+    auto stored = make_ddop("Old layout");
+    stored.stamp_structure_label();
+    REQUIRE(server.ddop_cache().store(0x55AA, stored.serialize().value()).is_ok());
+
+    TaskControllerClient client(implement.net, implement.cf);
+    client.set_ddop(make_ddop());
+    start_handshake(implement, client);
+    pump(implement, tc, client, 3);
+    CHECK(client.state() == TCState::WaitForPoolResponse);
+    CHECK_FALSE(client.transfer_skipped());
+
+    SUBCASE("TC without label support") {
+        TaskControllerClient quiet(implement.net, implement.cf, TCClientConfig{}.labels(true, 500));
+        quiet.set_ddop(make_ddop());
+        start_handshake(implement, quiet);
+        quiet.update(0); // label request goes out, nobody answers
+        CHECK(quiet.state() == TCState::WaitForStructureLabel);
+        quiet.update(500);
+        CHECK(quiet.state() == TCState::TransferDDOP);
+    }
+
+    SUBCASE("negotiation disabled") {
+        TaskControllerClient legacy(implement.net, implement.cf, TCClientConfig{}.labels(false));
+        legacy.set_ddop(make_ddop());
+        start_handshake(implement, legacy);
+        CHECK(legacy.state() == TCState::TransferDDOP);
+    }
+}
@@ -111,6 +111,64 @@ TEST_CASE("DDOP clear") {
     CHECK(ddop.object_count() == 0);
 }
 
+TEST_CASE("DDOP index and cached image") {
+    DDOP ddop;
+    ddop.add_device(DeviceObject{}.set_id(1).set_designator("Sprayer"));
+    ddop.add_element(DeviceElement{}.set_id(2).set_type(DeviceElementType::Device).set_number(0).add_child(10));
+    ddop.add_element(
+        DeviceElement{}.set_id(3).set_type(DeviceElementType::Section).set_number(7).set_parent(2).add_child(11));
+    ddop.add_process_data(DeviceProcessData{}.set_id(10).set_ddi(ddi::ACTUAL_WORK_STATE).set_presentation(20));
+    ddop.add_property(DeviceProperty{}.set_id(11).set_ddi(ddi::ACTUAL_WORKING_WIDTH).set_value(3000));
+    ddop.add_value_presentation(DeviceValuePresentation{}.set_id(20).set_unit("mm"));
+
+    SUBCASE("object lookup by id") {
+        CHECK(ddop.contains(11));
+        CHECK_FALSE(ddop.contains(99));
+        CHECK(ddop.object_type(10) == TCObjectType::DeviceProcessData);
+        REQUIRE(ddop.property(11) != nullptr);
+        CHECK(ddop.property(11)->value == 3000);
+        CHECK(ddop.process_data(11) == nullptr); // wrong kind
+        CHECK(ddop.value_presentation(20)->unit_designator == "mm");
+        CHECK(ddop.device(1)->designator == "Sprayer");
+        CHECK(ddop.value_presentations().size() == 1);
+    }
+
+    SUBCASE("element number and parent index") {
+        REQUIRE(ddop.element_by_number(7) != nullptr);
+        CHECK(ddop.element_by_number(7)->id == 3);
+        CHECK(ddop.element_by_number(5) == nullptr);
+        CHECK(ddop.parent_element(11)->id == 3);
+        CHECK(ddop.parent_element(3) == nullptr);
+        CHECK(DDOPHelpers::find_parent_element(ddop, 10).value()->id == 2);
+    }
+
+    SUBCASE("image is cached until the pool changes") {
+        const auto *first = ddop.image().data();
+        auto size = ddop.image().size();
+        CHECK(ddop.image().data() == first);
+        CHECK(ddop.serialize().value() == ddop.image());
+
+        ddop.add_property(DeviceProperty{}.set_id(12).set_ddi(ddi::DEVICE_ELEMENT_OFFSET_X).set_value(-500));
+        CHECK(ddop.image().size() > size);
+        CHECK(ddop.property(12)->value == -500);
+
+        auto round_trip = DDOP::deserialize(ddop.image());
+        REQUIRE(round_trip.is_ok());
+        CHECK(round_trip.value().image() == ddop.image());
+        CHECK(round_trip.value().element_by_number(7)->id == 3);
+
+        ddop.clear();
+        CHECK(ddop.image().empty());
+        CHECK_FALSE(ddop.contains(11));
+    }
+
+    SUBCASE("validation uses the index") {
+        CHECK(ddop.validate().is_ok());
+        ddop.add_element(DeviceElement{}.set_id(4).set_parent(2).add_child(99));
+        CHECK(ddop.validate().is_err());
+    }
+}
+
 TEST_CASE("DDOP deserialize round-trip") {
     DDOP original;
 
@@ -273,6 +331,30 @@ TEST_CASE("DDI Database") {
         // DDI 116 (Total Area) has resolution 1.0
         CHECK(DDIDatabase::to_engineering(116, 500) == doctest::Approx(500.0));
     }
+
+    SUBCASE("indexed lookup matches a linear scan") {
+        for (u32 d = 0; d <= 0xFFFF; ++d) {
+            const DDIDefinition *linear = nullptr;
+            for (usize i = 0; i < DDI_DATABASE_SIZE; ++i)
+                if (DDI_DATABASE[i].ddi == d)
+                    linear = &DDI_DATABASE[i];
+            REQUIRE(ddi_lookup(static_cast<u16>(d)) == linear);
+        }
+    }
+
+    SUBCASE("compile-time Ddi") {
+        static_assert(ddi_lookup(ddi::ACTUAL_WORKING_WIDTH) != nullptr);
+        static_assert(ddi_lookup(9999) == nullptr);
+        static_assert(Ddi<1>::resolution == 0.01);
+        static_assert(Ddi<ddi::DEVICE_ELEMENT_OFFSET_Y>::to_engineering(250) == 250.0);
+        CHECK(dp::String(Ddi<116>::unit) == "m2");
+        CHECK(Ddi<1>::to_engineering(1000) == doctest::Approx(10.0));
+        CHECK(Ddi<1>::from_engineering(10.0) == 1000);
+        CHECK(Ddi<1>::from_engineering(10.0) == DDIDatabase::from_engineering(1, 10.0));
+        CHECK(Ddi<ddi::ACTUAL_WORKING_WIDTH>::in_range(3000));
+        CHECK_FALSE(Ddi<ddi::ACTUAL_WORKING_WIDTH>::in_range(-1));
+        CHECK(Ddi<574>::resolution == doctest::Approx(1e-7)); // "1,0E-7" in the export
+    }
 }
 
 TEST_CASE("DDOP Helpers") {
@@ -106,3 +106,119 @@ TEST_CASE("TCGEOInterface - rate at position") {
         CHECK_FALSE(rate.has_value());
     }
 }
+
+static PrescriptionMap checkerboard(u32 n, f64 cell_deg) {
+    PrescriptionMap map;
+    map.structure_label = "GRID";
+    for (u32 r = 0; r < n; ++r)
+        for (u32 c = 0; c < n; ++c) {
+            f64 lat = 48.0 + r * cell_deg, lon = 11.0 + c * cell_deg;
+            PrescriptionZone zone;
+            zone.boundary = {concord::earth::WGS(lat, lon, 0), concord::earth::WGS(lat + cell_deg, lon, 0),
+                             concord::earth::WGS(lat + cell_deg, lon + cell_deg, 0),
+                             concord::earth::WGS(lat, lon + cell_deg, 0)};
+            zone.application_rate = static_cast<i32>(r * n + c);
+            map.zones.push_back(zone);
+        }
+    return map;
+}
+
+TEST_CASE("TCGEOInterface - indexed lookup matches linear scan") {
+    IsoNet nm;
+    auto* cf = nm.create_internal(Name::build().set_identity_number(1), 0, 0x10).value();
+    TCGEOInterface geo(nm, cf);
+    geo.add_prescription_map(checkerboard(20, 0.001));
+
+    // Overlapping zone in a second map: the first map keeps priority
+    PrescriptionMap overlay;
+    overlay.zones.push_back({{concord::earth::WGS(47.9, 10.9, 0), concord::earth::WGS(48.1, 10.9, 0),
+                              concord::earth::WGS(48.1, 11.1, 0), concord::earth::WGS(47.9, 11.1, 0)},
+                             -1});
+    geo.add_prescription_map(std::move(overlay));
+
+    u32 lcg = 7;
+    for (int i = 0; i < 2000; ++i) {
+        lcg = lcg * 1664525u + 1013904223u;
+        f64 lat = 47.995 + (lcg >> 8) % 30000 * 1e-6;
+        lcg = lcg * 1664525u + 1013904223u;
+        f64 lon = 10.995 + (lcg >> 8) % 30000 * 1e-6;
+        concord::earth::WGS p(lat, lon, 0);
+        auto fast = geo.get_rate_at_position(p);
+        auto slow = geo.get_rate_at_position_linear(p);
+        REQUIRE(fast.has_value() == slow.has_value());
+        if (fast.has_value())
+            CHECK(*fast == *slow);
+    }
+    CHECK(*geo.get_rate_at_position(concord::earth::WGS(48.0005, 11.0015, 0)) == 1);
+    CHECK(*geo.get_rate_at_position(concord::earth::WGS(47.95, 11.05, 0)) == -1);
+}
+
+TEST_CASE("TCGEOInterface - raster prescriptions") {
+    IsoNet nm;
+    auto* cf = nm.create_internal(Name::build().set_identity_number(1), 0, 0x10).value();
+    TCGEOInterface geo(nm, cf);
+
+    RasterPrescription raster;
+    raster.min_north = 48.0;
+    raster.min_east = 11.0;
+    raster.cell_north = 0.01;
+    raster.cell_east = 0.01;
+    raster.columns = 3;
+    raster.rows = 2;
+    raster.rates = {1, 2, 3, 4, raster.no_data, 6};
+    REQUIRE(geo.add_raster_prescription(raster).is_ok());
+
+    CHECK(*geo.get_rate_at_position(concord::earth::WGS(48.005, 11.025, 0)) == 3);
+    CHECK(*geo.get_rate_at_position(concord::earth::WGS(48.015, 11.005, 0)) == 4);
+    CHECK_FALSE(geo.get_rate_at_position(concord::earth::WGS(48.015, 11.015, 0)).has_value());
+    CHECK_FALSE(geo.get_rate_at_position(concord::earth::WGS(48.025, 11.005, 0)).has_value());
+
+    raster.rates.pop_back();
+    CHECK(geo.add_raster_prescription(raster).is_err());
+
+    SUBCASE("rasterized from polygons") {
+        dp::Vector<PrescriptionMap> maps{checkerboard(4, 0.001)};
+        auto grid = RasterPrescription::from_maps(maps, 10.0);
+        REQUIRE(grid.valid());
+        CHECK(*grid.rate_at(concord::earth::WGS(48.0025, 11.0035, 0)) == 2 * 4 + 3);
+    }
+}
+
+TEST_CASE("TCGEOInterface - look-ahead rate") {
+    IsoNet nm;
+    auto* cf = nm.create_internal(Name::build().set_identity_number(1), 0, 0x10).value();
+    TCGEOInterface geo(nm, cf);
+    geo.initialize();
+    geo.add_prescription_map(checkerboard(2, 0.001)); // ~111 m north, ~74 m east per zone
+
+    i32 emitted = -1;
+    geo.on_application_rate_changed.subscribe([&](i32 rate) { emitted = rate; });
+
+    // Heading north at 5 m/s, 100 m short of the zone boundary
+    geo.set_position(GeoPoint{concord::earth::WGS(48.0001, 11.0005, 0), 0});
+    geo.set_motion(5.0, 0.0);
+    geo.update(100);
+    CHECK(emitted == 0);
+
+    geo.set_look_ahead(2000); // 10 m
+    CHECK(*geo.rate_ahead() == 0);
+    geo.set_look_ahead(30000); // 150 m, past the boundary
+    CHECK(*geo.rate_ahead() == 2);
+    geo.update(100);
+    CHECK(emitted == 2);
+
+    SUBCASE("motion from COG/SOG") {
+        // COG 1.5708 rad (east), SOG 3.00 m/s
+        nm.inject_message(Message(PGN_GNSS_COG_SOG, {0, 0, 0x5C, 0x3D, 0x2C, 0x01, 0xFF, 0xFF}, 0x20, 0xFF));
+        CHECK(geo.speed() == doctest::Approx(3.0));
+        CHECK(geo.heading() == doctest::Approx(1.5708));
+    }
+
+    SUBCASE("motion from consecutive fixes") {
+        TCGEOInterface derived(nm, cf);
+        derived.set_position(GeoPoint{concord::earth::WGS(48.0, 11.0, 0), 0});
+        derived.set_position(GeoPoint{concord::earth::WGS(48.0 + 10.0 / 111195.0, 11.0, 0), 2000000});
+        CHECK(derived.speed() == doctest::Approx(5.0).epsilon(0.01));
+        CHECK(derived.heading() == doctest::Approx(0.0));
+    }
+}
@@ -0,0 +1,250 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/implement/speed_distance.hpp>
+#include <agrobus/isobus/tc/client.hpp>
+#include <agrobus/isobus/tc/measurement.hpp>
+#include <cstring>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::tc;
+
+struct Sent {
+    ElementNumber element;
+    DDI ddi;
+    i32 value;
+};
+
+static auto collect(dp::Vector<Sent> &out) {
+    return [&out](ElementNumber e, DDI d, i32 v) { out.push_back(Sent{e, d, v}); };
+}
+
+static auto no_fetch() {
+    return [](ElementNumber, DDI) -> dp::Optional<i32> { return dp::nullopt; };
+}
+
+TEST_CASE("MeasurementEngine time interval") {
+    MeasurementEngine engine;
+    dp::Vector<Sent> sent;
+    REQUIRE(engine.configure(ProcessDataCommands::MeasurementTimeInterval, 3, 0x0074, 1000));
+    CHECK_FALSE(engine.configure(ProcessDataCommands::RequestValue, 3, 0x0074, 0));
+    CHECK(engine.size() == 1);
+
+    // No value known yet: the fetch function is asked
+    u32 fetched = 0;
+    auto fetch = [&](ElementNumber, DDI) -> dp::Optional<i32> {
+        ++fetched;
+        return 55;
+    };
+    engine.advance(999, 0, fetch, collect(sent));
+    CHECK(sent.empty());
+    engine.advance(1, 0, fetch, collect(sent));
+    REQUIRE(sent.size() == 1);
+    CHECK(sent[0].value == 55);
+    CHECK(fetched == 1);
+
+    // Pushed values take precedence over fetching
+    engine.set_value(3, 0x0074, 77, collect(sent));
+    CHECK(sent.size() == 1); // no value trigger configured
+    engine.advance(1000, 0, fetch, collect(sent));
+    REQUIRE(sent.size() == 2);
+    CHECK(sent[1].value == 77);
+    CHECK(fetched == 1);
+
+    // Ticks between deadlines do not scan the subscriptions
+    u64 scans = engine.stats().scans;
+    for (u32 i = 0; i < 99; ++i)
+        engine.advance(10, 0, fetch, collect(sent));
+    CHECK(engine.stats().scans == scans);
+
+    // A long stall fires once and re-arms from now
+    engine.advance(5000, 0, fetch, collect(sent));
+    CHECK(sent.size() == 3);
+    CHECK(engine.next_time_due() == engine.now_ms() + 1000);
+
+    // Zero interval switches the trigger off
+    engine.configure(ProcessDataCommands::MeasurementTimeInterval, 3, 0x0074, 0);
+    engine.advance(10000, 0, fetch, collect(sent));
+    CHECK(sent.size() == 3);
+}
+
+TEST_CASE("MeasurementEngine distance interval") {
+    MeasurementEngine engine;
+    dp::Vector<Sent> sent;
+    engine.configure(ProcessDataCommands::MeasurementDistanceInterval, 1, 0x0010, 5000);
+    engine.set_value(1, 0x0010, 9, collect(sent));
+
+    engine.advance(100, 4999, no_fetch(), collect(sent));
+    CHECK(sent.empty());
+    engine.advance(100, 1, no_fetch(), collect(sent));
+    CHECK(sent.size() == 1);
+    engine.advance(100000, 0, no_fetch(), collect(sent)); // standing still
+    CHECK(sent.size() == 1);
+    engine.advance(100, 5000, no_fetch(), collect(sent));
+    CHECK(sent.size() == 2);
+    CHECK(engine.stats().fired_distance == 2);
+}
+
+TEST_CASE("MeasurementEngine thresholds fire on entering the window") {
+    MeasurementEngine engine;
+    dp::Vector<Sent> sent;
+    engine.configure(ProcessDataCommands::MeasurementMinimumWithinThreshold, 2, 0x0021, 100);
+    engine.configure(ProcessDataCommands::MeasurementMaximumWithinThreshold, 2, 0x0021, 200);
+
+    CHECK_FALSE(engine.set_value(2, 0x0021, 50, collect(sent)));
+    CHECK(engine.set_value(2, 0x0021, 150, collect(sent)));
+    CHECK_FALSE(engine.set_value(2, 0x0021, 160, collect(sent)));
+    CHECK_FALSE(engine.set_value(2, 0x0021, 250, collect(sent)));
+    CHECK(engine.set_value(2, 0x0021, 199, collect(sent)));
+    CHECK(sent.size() == 2);
+    CHECK(engine.stats().fired_threshold == 2);
+
+    // Unsubscribed pairs are ignored
+    CHECK_FALSE(engine.set_value(2, 0x0022, 150, collect(sent)));
+}
+
+TEST_CASE("MeasurementEngine change threshold") {
+    MeasurementEngine engine;
+    dp::Vector<Sent> sent;
+    engine.configure(ProcessDataCommands::MeasurementChangeThreshold, 4, 0x00A0, 10);
+
+    CHECK(engine.set_value(4, 0x00A0, 0, collect(sent))); // first value always reported
+    CHECK_FALSE(engine.set_value(4, 0x00A0, 9, collect(sent)));
+    CHECK(engine.set_value(4, 0x00A0, 10, collect(sent)));
+    CHECK_FALSE(engine.set_value(4, 0x00A0, 1, collect(sent)));
+    CHECK(engine.set_value(4, 0x00A0, -1, collect(sent)));
+    CHECK(sent.size() == 3);
+
+    SUBCASE("zero threshold reports every change") {
+        engine.configure(ProcessDataCommands::MeasurementChangeThreshold, 4, 0x00A0, 0);
+        CHECK_FALSE(engine.set_value(4, 0x00A0, -1, collect(sent)));
+        CHECK(engine.set_value(4, 0x00A0, 0, collect(sent)));
+    }
+}
+
+// Captures transmitted CAN frames
+class CaptureLink : public wirebit::Link {
+    dp::Vector<can_frame> tx_;
+
+  public:
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        tx_.push_back(cf);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "capture"; }
+
+    // Value messages (ECU to TC, command 0x3)
+    dp::Vector<Sent> values() const {
+        dp::Vector<Sent> out;
+        for (const auto &cf : tx_) {
+            if (((cf.can_id >> 16) & 0xFF) != (PGN_ECU_TO_TC >> 8) || (cf.data[0] & 0x0F) != 0x03)
+                continue;
+            ElementNumber e = static_cast<u16>(cf.data[0] >> 4) | (static_cast<u16>(cf.data[1]) << 4);
+            DDI d = static_cast<u16>(cf.data[2]) | (static_cast<u16>(cf.data[3]) << 8);
+            i32 v = static_cast<i32>(cf.data[4]) | (static_cast<i32>(cf.data[5]) << 8) |
+                    (static_cast<i32>(cf.data[6]) << 16) | (static_cast<i32>(cf.data[7]) << 24);
+            out.push_back(Sent{e, d, v});
+        }
+        return out;
+    }
+};
+
+static dp::Vector<u8> measurement_cmd(ProcessDataCommands cmd, ElementNumber e, DDI d, i32 v) {
+    return {static_cast<u8>((static_cast<u8>(cmd) & 0x0F) | ((e & 0x0F) << 4)),
+            static_cast<u8>(e >> 4),
+            static_cast<u8>(d & 0xFF),
+            static_cast<u8>(d >> 8),
+            static_cast<u8>(v & 0xFF),
+            static_cast<u8>((v >> 8) & 0xFF),
+            static_cast<u8>((v >> 16) & 0xFF),
+            static_cast<u8>((v >> 24) & 0xFF)};
+}
+
+TEST_CASE("TaskControllerClient reports subscribed values") {
+    auto link = std::make_shared<CaptureLink>();
+    wirebit::CanEndpoint ep(link, wirebit::CanConfig{}, 1);
+    IsoNet nm;
+    nm.set_endpoint(0, &ep);
+    Name name;
+    auto *cf = nm.create_internal(name, 0, 0x28).value();
+
+    TaskControllerClient tc(nm, cf);
+    DDOP ddop;
+    DeviceObject dev;
+    dev.id = 1;
+    dev.designator = "Sprayer";
+    ddop.add_device(dev);
+    DeviceElement elem;
+    elem.id = 2;
+    elem.parent_id = 1;
+    elem.type = DeviceElementType::Device;
+    ddop.add_element(elem);
+    tc.set_ddop(std::move(ddop));
+    tc.on_value_request([](ElementNumber, DDI ddi) -> Result<i32> { return Result<i32>::ok(ddi * 10); });
+
+    // Handshake up to an active pool
+    REQUIRE(tc.connect().is_ok());
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::TC_STATUS, 0, 0, 0, 0, 0, 0, 0}, 0x30, 0x28));
+    tc.update(0);
+    tc.update(0);
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::VERSION_RESPONSE, 4, 1, 48, 0, 0xFF, 0xFF, 0xFF}, 0x30, 0x28));
+    tc.update(0);
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::OBJECT_POOL_RESPONSE, 0, 0, 0, 0, 0, 0, 0}, 0x30, 0x28));
+    tc.update(0);
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::ACTIVATE_RESPONSE, 0, 0, 0, 0, 0, 0, 0}, 0x30, 0x28));
+    REQUIRE(tc.state() == TCState::Connected);
+
+    // Request Value with element 0x12 uses both nibbles
+    nm.inject_message(Message(PGN_TC_TO_ECU, {0x22, 0x01, 0x74, 0x00, 0, 0, 0, 0}, 0x30, 0x28));
+    auto values = link->values();
+    REQUIRE(values.size() == 1);
+    CHECK(values[0].element == 0x12);
+    CHECK(values[0].value == 0x74 * 10);
+
+    // Time interval on (0x12, 0x74), change threshold on (5, 0xA0)
+    nm.inject_message(
+        Message(PGN_TC_TO_ECU, measurement_cmd(ProcessDataCommands::MeasurementTimeInterval, 0x12, 0x74, 500), 0x30,
+                0x28));
+    nm.inject_message(
+        Message(PGN_TC_TO_ECU, measurement_cmd(ProcessDataCommands::MeasurementChangeThreshold, 5, 0xA0, 100), 0x30,
+                0x28));
+    CHECK(tc.measurements().size() == 2);
+
+    for (u32 i = 0; i < 100; ++i)
+        tc.update(10); // 1 s: two time triggers
+    CHECK(link->values().size() == 3);
+
+    tc.set_value(5, 0xA0, 1000);
+    tc.set_value(5, 0xA0, 1050);
+    tc.set_value(5, 0xA0, 1100);
+    values = link->values();
+    REQUIRE(values.size() == 5);
+    CHECK(values.back().element == 5);
+    CHECK(values.back().value == 1100);
+    CHECK(tc.values_sent() == 5);
+
+    SUBCASE("distance from machine selected speed") {
+        REQUIRE(tc.track_distance().is_ok());
+        nm.inject_message(
+            Message(PGN_TC_TO_ECU, measurement_cmd(ProcessDataCommands::MeasurementDistanceInterval, 7, 0x10, 2000),
+                    0x30, 0x28));
+        implement::MachineSelectedSpeed mss;
+        for (u32 m = 0; m <= 5; ++m) {
+            mss.distance_m = 100.0 + m;
+            nm.inject_message(Message(PGN_MACHINE_SELECTED_SPEED, mss.encode(), 0x80, 0xFF));
+            tc.update(0);
+        }
+        // 5 m travelled: two 2 m intervals
+        CHECK(tc.measurements().stats().fired_distance == 2);
+    }
+
+    SUBCASE("disconnect drops subscriptions") {
+        tc.disconnect();
+        CHECK(tc.measurements().size() == 0);
+    }
+}
@@ -0,0 +1,161 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/tc/section_control.hpp>
+#include <cstring>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::tc;
+
+// Four 1 m sections side by side, 2 m behind the reference point
+static ImplementGeometry four_sections() {
+    ImplementGeometry geo;
+    for (i32 i = 0; i < 4; ++i) {
+        SectionInfo s;
+        s.number = static_cast<ElementNumber>(i + 1);
+        s.offset_x_mm = -2000;
+        s.offset_y_mm = 1500 - i * 1000; // section 1 leftmost
+        s.width_mm = 1000;
+        geo.sections.push_back(s);
+    }
+    geo.total_width_mm = 4000;
+    return geo;
+}
+
+static void drive(SectionControl &sc, f64 x, f64 y0, f64 y1, f64 heading, f64 step = 0.2) {
+    f64 dir = y1 >= y0 ? 1.0 : -1.0;
+    for (f64 y = y0; dir * (y1 - y) >= 0; y += dir * step)
+        sc.update_local(LocalPoint{x, y}, heading, 4.0);
+}
+
+TEST_CASE("CoverageGrid spans cross tiles and words") {
+    CoverageGrid grid(0.1);
+    CHECK(grid.mark_span(0, -70, 300) == 371);
+    CHECK(grid.mark_span(0, 0, 10) == 0);
+    CHECK(grid.count_span(0, -100, 400) == 371);
+    CHECK(grid.count_span(0, 63, 64) == 2);
+    CHECK(grid.count_span(1, -100, 400) == 0);
+    CHECK(grid.test(-70, 0));
+    CHECK_FALSE(grid.test(-71, 0));
+    CHECK(grid.tile_count() == 3);
+
+    // 2 m x 1 m rotated square at 10 cm: ~200 cells
+    grid.clear();
+    f64 c = std::cos(0.3), s = std::sin(0.3);
+    SwathQuad quad{LocalPoint{0, 0}, LocalPoint{2 * c, 2 * s}, LocalPoint{2 * c - s, 2 * s + c}, LocalPoint{-s, c}};
+    u64 added = grid.fill(quad);
+    CHECK(added == doctest::Approx(200).epsilon(0.05));
+    u64 total = 0;
+    CHECK(grid.count(quad, total) == added);
+    CHECK(total == added);
+    CHECK(grid.covered_area_m2() == doctest::Approx(2.0).epsilon(0.05));
+}
+
+TEST_CASE("SectionControl switches off over covered ground") {
+    SectionControl sc(four_sections(), SectionControlConfig{}.resolution(0.05).look_ahead(0.5));
+    drive(sc, 0.0, 0.0, 20.0, 0.0);
+    for (usize i = 0; i < 4; ++i)
+        CHECK(sc.section_on(i));
+    // Sections trail 2 m behind the reference point
+    CHECK(sc.coverage().covered_area_m2() == doctest::Approx(4.0 * 20.0).epsilon(0.02));
+
+    // Come back heading south, 2 m further east: the two sections on the west
+    // (right-hand side when heading south) run over the first pass
+    dp::Vector<dp::Vector<bool>> changes;
+    sc.on_sections_changed.subscribe([&](const dp::Vector<bool> &states) { changes.push_back(states); });
+    drive(sc, 2.0, 14.0, 4.0, 3.14159265358979);
+    CHECK(sc.section_on(0));
+    CHECK(sc.section_on(1));
+    CHECK_FALSE(sc.section_on(2));
+    CHECK_FALSE(sc.section_on(3));
+    CHECK(sc.overlap(3) == doctest::Approx(1.0));
+    CHECK(sc.overlap(0) == doctest::Approx(0.0));
+    CHECK(changes.size() == 1);
+
+    // Condensed work state 1-16: 01 01 00 00, unused sections 11
+    CHECK(sc.condensed(0) == static_cast<i32>(0xFFFFFF05u));
+    CHECK(sc.condensed(1) == -1);
+
+    sc.set_master(false);
+    sc.update_local(LocalPoint{2.0, 3.8}, 3.14159265358979, 4.0);
+    CHECK_FALSE(sc.section_on(0));
+}
+
+TEST_CASE("SectionControl respects the field boundary") {
+    SectionControl sc(four_sections(), SectionControlConfig{}.resolution(0.05).boundary_resolution(0.1));
+    concord::earth::WGS origin(52.0, 5.0);
+    sc.set_origin(origin);
+    LocalFrame frame(52.0, 5.0);
+    // Field edge at x = -1.25: the leftmost section (x -2 .. -1) is 3/4 outside
+    sc.set_boundary({frame.to_wgs(-1.25, -50), frame.to_wgs(50, -50), frame.to_wgs(50, 50), frame.to_wgs(-1.25, 50)});
+
+    sc.update(frame.to_wgs(0.0, 0.0), 0.0, 3.0);
+    CHECK_FALSE(sc.section_on(0));
+    CHECK(sc.outside(0) == doctest::Approx(0.75).epsilon(0.1));
+    CHECK(sc.section_on(1));
+    CHECK(sc.outside(1) == doctest::Approx(0.0));
+    CHECK(sc.section_on(3));
+}
+
+class CaptureLink : public wirebit::Link {
+  public:
+    dp::Vector<can_frame> tx;
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        tx.push_back(cf);
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "capture"; }
+};
+
+TEST_CASE("SectionControl reports condensed work state through the TC client") {
+    auto link = std::make_shared<CaptureLink>();
+    wirebit::CanEndpoint ep(link, wirebit::CanConfig{}, 1);
+    IsoNet nm;
+    nm.set_endpoint(0, &ep);
+    auto *cf = nm.create_internal(Name{}, 0, 0x28).value();
+
+    TaskControllerClient tc(nm, cf, TCClientConfig{}.labels(false));
+    DDOP ddop;
+    DeviceObject dev;
+    dev.id = 1;
+    dev.designator = "Sprayer";
+    ddop.add_device(dev);
+    DeviceElement boom;
+    boom.id = 2;
+    boom.parent_id = 1;
+    boom.type = DeviceElementType::Device;
+    ddop.add_element(boom);
+    tc.set_ddop(std::move(ddop));
+    REQUIRE(tc.connect().is_ok());
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::TC_STATUS, 0, 0, 0, 0, 0, 0, 0}, 0x30, 0x28));
+    tc.update(0);
+    tc.update(0);
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::VERSION_RESPONSE, 4, 1, 48, 0, 0xFF, 0xFF, 0xFF}, 0x30, 0x28));
+    tc.update(0);
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::OBJECT_POOL_RESPONSE, 0, 0, 0, 0, 0, 0, 0}, 0x30, 0x28));
+    tc.update(0);
+    nm.inject_message(Message(PGN_TC_TO_ECU, {tc_cmd::ACTIVATE_RESPONSE, 0, 0, 0, 0, 0, 0, 0}, 0x30, 0x28));
+    REQUIRE(tc.state() == TCState::Connected);
+
+    // TC subscribes to on-change of element 2, DDI 161
+    nm.inject_message(Message(PGN_TC_TO_ECU, {0x28, 0x00, 0xA1, 0x00, 0x01, 0, 0, 0}, 0x30, 0x28));
+    REQUIRE(tc.measurements().size() == 1);
+
+    SectionControl sc(four_sections(), SectionControlConfig{}.resolution(0.05));
+    sc.bind(tc, 2);
+    usize before = link->tx.size();
+    sc.update_local(LocalPoint{0, 0}, 0.0, 2.0);
+    CHECK(sc.stats().condensed_updates == 2); // initial all-off, then all-on
+    REQUIRE(link->tx.size() == before + 1);
+    const auto &frame = link->tx.back();
+    CHECK((frame.data[0] & 0x0F) == 0x03);
+    CHECK(frame.data[2] == 0xA1);
+    u32 value = static_cast<u32>(frame.data[4]) | (static_cast<u32>(frame.data[5]) << 8) |
+                (static_cast<u32>(frame.data[6]) << 16) | (static_cast<u32>(frame.data[7]) << 24);
+    CHECK(value == 0xFFFFFF55u);
+}
@@ -1,6 +1,9 @@
 #include <doctest/doctest.h>
 #include <agrobus.hpp>
 #include <agrobus/isobus/tc/server.hpp>
+#include <cstring>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/link.hpp>
 
 using namespace agrobus::net;
 using namespace agrobus::j1939;
@@ -83,3 +86,165 @@ TEST_CASE("TaskControllerServer - update sends status") {
         server.update(100);
     }
 }
+
+// ─── Multi-client routing ────────────────────────────────────────────────────
+
+// Counts TC -> ECU value requests per destination address
+class RequestLink : public wirebit::Link {
+  public:
+    dp::Map<Address, usize> requests;
+
+    wirebit::Result<wirebit::Unit, wirebit::Error> send(const wirebit::Frame &frame) override {
+        can_frame cf;
+        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+        if (((cf.can_id >> 16) & 0xFF) == (PGN_TC_TO_ECU >> 8) &&
+            (cf.data[0] & 0x0F) == static_cast<u8>(ProcessDataCommands::RequestValue) && cf.data[3] != 0xFF)
+            ++requests[static_cast<Address>((cf.can_id >> 8) & 0xFF)];
+        return wirebit::Result<wirebit::Unit, wirebit::Error>::ok(wirebit::Unit{});
+    }
+    wirebit::Result<wirebit::Frame, wirebit::Error> recv() override {
+        return wirebit::Result<wirebit::Frame, wirebit::Error>::err(wirebit::Error::timeout("empty"));
+    }
+    wirebit::String name() const override { return "requests"; }
+};
+
+// Boom element 1 with two sections (3, 4), each with work state and rate
+static DDOP routed_ddop() {
+    DDOP ddop;
+    ddop.add_device(DeviceObject{}.set_designator("Sprayer"));
+    ObjectID root = ddop.add_element(DeviceElement{}.set_type(DeviceElementType::Device)).value();
+    DeviceElement boom;
+    boom.set_type(DeviceElementType::Function).set_number(1).set_parent(root);
+    boom.add_child(ddop.add_process_data(DeviceProcessData{}.set_ddi(ddi::TOTAL_AREA)).value());
+    ddop.add_element(std::move(boom));
+    for (ElementNumber n : {3, 4}) {
+        DeviceElement sec;
+        sec.set_type(DeviceElementType::Section).set_number(n).set_parent(root);
+        sec.add_child(ddop.add_process_data(DeviceProcessData{}.set_ddi(ddi::ACTUAL_WORK_STATE)).value());
+        sec.add_child(
+            ddop.add_process_data(DeviceProcessData{}.set_ddi(ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE)).value());
+        ddop.add_element(std::move(sec));
+    }
+    return ddop;
+}
+
+static void connect_client(IsoNet &net, Address addr, const DDOP &ddop) {
+    auto pool = ddop.serialize().value();
+    pool.insert(pool.begin(), tc_cmd::OBJECT_POOL_TRANSFER);
+    net.inject_message(Message(PGN_ECU_TO_TC, pool, addr, 0x10));
+    net.inject_message(
+        Message(PGN_ECU_TO_TC, {tc_cmd::ACTIVATE_POOL, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, addr, 0x10));
+}
+
+static Message value_message(Address from, ElementNumber element, DDI ddi, i32 value) {
+    dp::Vector<u8> data(8);
+    data[0] = static_cast<u8>(ProcessDataCommands::Value) | static_cast<u8>((element & 0x0F) << 4);
+    data[1] = static_cast<u8>(element >> 4);
+    data[2] = static_cast<u8>(ddi & 0xFF);
+    data[3] = static_cast<u8>(ddi >> 8);
+    for (usize i = 0; i < 4; ++i)
+        data[4 + i] = static_cast<u8>(static_cast<u32>(value) >> (8 * i));
+    return Message(PGN_ECU_TO_TC, data, from, 0x10);
+}
+
+struct RoutedServer {
+    std::shared_ptr<RequestLink> link = std::make_shared<RequestLink>();
+    wirebit::CanEndpoint ep{link, wirebit::CanConfig{}, 1};
+    IsoNet net;
+    InternalCF *cf = nullptr;
+
+    RoutedServer() {
+        net.set_endpoint(0, &ep);
+        cf = net.create_internal(Name{}, 0, 0x10).value();
+    }
+};
+
+TEST_CASE("TaskControllerServer - per-client routing tables") {
+    RoutedServer node;
+    TaskControllerServer server(node.net, node.cf);
+    server.start();
+    connect_client(node.net, 0x81, routed_ddop());
+    connect_client(node.net, 0x82, routed_ddop());
+
+    REQUIRE(server.clients().size() == 2);
+    REQUIRE(server.client(0x81) != nullptr);
+    CHECK(server.client(0x81)->pool_activated);
+    CHECK(server.client(0x81)->routes.size() == 5);
+    CHECK(server.client(0x83) == nullptr);
+    CHECK(server.route(0x82, 3, ddi::ACTUAL_WORK_STATE) != nullptr);
+    CHECK(server.route(0x82, 1, ddi::ACTUAL_WORK_STATE) == nullptr);
+
+    dp::Vector<std::pair<Address, i32>> rates;
+    server.on_route_value(ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE,
+                          [&](TCClientInfo &c, const TCProcessRoute &r) { rates.push_back({c.address, r.value}); });
+
+    server.update(100);
+    node.net.inject_message(value_message(0x81, 3, ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE, 1500));
+    node.net.inject_message(value_message(0x82, 4, ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE, 2500));
+    node.net.inject_message(value_message(0x82, 4, ddi::ACTUAL_WORK_STATE, 1));
+    node.net.inject_message(value_message(0x82, 9, ddi::ACTUAL_WORK_STATE, 1)); // not in the DDOP
+
+    REQUIRE(rates.size() == 2);
+    CHECK(rates[0] == std::pair<Address, i32>{0x81, 1500});
+    CHECK(rates[1] == std::pair<Address, i32>{0x82, 2500});
+
+    // Same pair, different clients: values stay separate
+    CHECK(server.route(0x81, 3, ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE)->value == 1500);
+    CHECK_FALSE(server.route(0x82, 3, ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE)->has_value);
+    CHECK(server.route(0x82, 4, ddi::ACTUAL_WORK_STATE)->received == 1);
+
+    const auto &stats = server.client(0x82)->stats;
+    CHECK(stats.values == 2);
+    CHECK(stats.unrouted == 1);
+    CHECK(stats.messages >= 3);
+
+    server.update(250);
+    REQUIRE(server.value_age_ms(0x81, 3, ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE).has_value());
+    CHECK(*server.value_age_ms(0x81, 3, ddi::ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE) == 250);
+    CHECK_FALSE(server.value_age_ms(0x81, 4, ddi::ACTUAL_WORK_STATE).has_value());
+}
+
+TEST_CASE("TaskControllerServer - scheduled value requests") {
+    RoutedServer node;
+    TaskControllerServer server(node.net, node.cf);
+    server.start();
+    server.poll(ddi::ACTUAL_WORK_STATE, 100); // rule applies to clients activated later, too
+    connect_client(node.net, 0x81, routed_ddop());
+    connect_client(node.net, 0x82, routed_ddop());
+    CHECK(server.client(0x81)->polls.size() == 2);
+
+    SUBCASE("interval is kept for every client") {
+        for (u32 i = 0; i < 100; ++i)
+            server.update(10); // 1 s
+        // 2 sections, due at 0, 100, ... 1000 ms
+        CHECK(node.link->requests[0x81] == 22);
+        CHECK(node.link->requests[0x81] == node.link->requests[0x82]);
+        CHECK(server.client(0x82)->stats.requests_sent == node.link->requests[0x82]);
+        CHECK(server.poll_stats().deferred_budget == 0);
+    }
+
+    SUBCASE("budget limits the request rate and is shared fairly") {
+        // 250 kbit/s x 1% / 128 bit ~ 19.5 requests/s for 40 due per second
+        TaskControllerServer tight(node.net, node.cf, TCServerConfig{}.poll_budget(0.01f));
+        tight.start();
+        tight.poll(ddi::ACTUAL_WORK_STATE, 100);
+        connect_client(node.net, 0x83, routed_ddop());
+        connect_client(node.net, 0x84, routed_ddop());
+        node.link->requests.clear();
+        for (u32 i = 0; i < 200; ++i)
+            tight.update(10); // 2 s
+
+        usize a = node.link->requests[0x83], b = node.link->requests[0x84];
+        CHECK(a + b <= 42);
+        CHECK(a + b >= 36);
+        CHECK((a > b ? a - b : b - a) <= 1);
+        CHECK(tight.poll_stats().deferred_budget > 0);
+    }
+
+    SUBCASE("single route polling") {
+        CHECK(server.poll_value(0x81, 1, ddi::TOTAL_AREA, 500).is_ok());
+        CHECK(server.poll_value(0x81, 2, ddi::TOTAL_AREA, 500).is_err());
+        CHECK(server.poll_value(0x90, 1, ddi::TOTAL_AREA, 500).is_err());
+        CHECK(server.client(0x81)->polls.size() == 3);
+    }
+}
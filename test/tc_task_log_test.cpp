@@ -0,0 +1,148 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/tc/server.hpp>
+#include <agrobus/isobus/tc/task_log.hpp>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::tc;
+
+static std::filesystem::path fresh_dir(const char *name) {
+    auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    return dir;
+}
+
+static dp::Vector<u8> read_bytes(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return dp::Vector<u8>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static std::string read_text(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+template <typename T> static T get(const dp::Vector<u8> &data, usize &pos) {
+    T v{};
+    std::memcpy(&v, data.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return v;
+}
+
+TEST_CASE("TaskLogger writes TLG records and header") {
+    auto dir = fresh_dir("agrobus_tlg_basic");
+    TaskLogger logger(TaskLogConfig{}.path(dir));
+    REQUIRE(logger.start().is_ok());
+    logger.set_time(16000, 3600000);
+    logger.set_position(GeoPoint{concord::earth::WGS(52.5, 5.25), 0});
+
+    CHECK(logger.log(0xAA, 1, 0x0074, 100));
+    CHECK(logger.log(0xAA, 2, 0x0002, -5));
+    logger.update(200);
+    CHECK(logger.log(0xAA, 1, 0x0074, 140));
+    logger.flush();
+
+    auto stats = logger.stats();
+    CHECK(stats.samples == 3);
+    CHECK(stats.records == 2);
+    CHECK(stats.dropped == 0);
+
+    auto bin = read_bytes(logger.binary_path(0xAA));
+    REQUIRE(bin.size() == stats.bytes_written);
+    usize pos = 0;
+    CHECK(get<u32>(bin, pos) == 3600000u);
+    CHECK(get<u16>(bin, pos) == 16000);
+    CHECK(get<i32>(bin, pos) == 525000000);
+    CHECK(get<i32>(bin, pos) == 52500000);
+    CHECK(get<u8>(bin, pos) == 1);
+    REQUIRE(get<u8>(bin, pos) == 2);
+    CHECK(get<u8>(bin, pos) == 0);
+    CHECK(get<i32>(bin, pos) == 100);
+    CHECK(get<u8>(bin, pos) == 1);
+    CHECK(get<i32>(bin, pos) == -5);
+
+    CHECK(get<u32>(bin, pos) == 3600200u);
+    pos += sizeof(u16) + 9;
+    REQUIRE(get<u8>(bin, pos) == 1);
+    CHECK(get<u8>(bin, pos) == 0);
+    CHECK(get<i32>(bin, pos) == 140);
+    CHECK(pos == bin.size());
+
+    auto xml = read_text(logger.header_path(0xAA));
+    CHECK(xml.find("<TIM A=\"\" D=\"4\">") != std::string::npos);
+    CHECK(xml.find("<PTN A=\"\" B=\"\" D=\"\"/>") != std::string::npos);
+    CHECK(xml.find("<DLV A=\"0074\" B=\"\" C=\"DET-1\"/>") != std::string::npos);
+    CHECK(xml.find("<DLV A=\"0002\" B=\"\" C=\"DET-2\"/>") != std::string::npos);
+
+    logger.stop();
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("TaskLogger keeps one TLG per client and flushes on interval") {
+    auto dir = fresh_dir("agrobus_tlg_clients");
+    TaskLogger logger(TaskLogConfig{}.path(dir).position(false).flush_interval(500));
+    REQUIRE(logger.start().is_ok());
+    logger.set_time(1, 0);
+
+    logger.log(1, 0, 0x0001, 7);
+    logger.log(2, 0, 0x0001, 8);
+    CHECK(logger.client_count() == 2);
+    CHECK(logger.binary_path(1) != logger.binary_path(2));
+
+    logger.update(499);
+    CHECK(logger.stats().blocks_written == 0);
+    logger.update(1);
+    logger.flush();
+    CHECK(logger.stats().blocks_written == 2);
+    // time + count + one DLV
+    CHECK(read_bytes(logger.binary_path(2)).size() == 6 + 1 + 5);
+
+    logger.stop();
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("TaskLogger memory is bounded") {
+    auto dir = fresh_dir("agrobus_tlg_bounded");
+    TaskLogger logger(TaskLogConfig{}.path(dir).blocks(4, 2));
+    // Writer not started: nothing is drained, so the two blocks fill up
+    for (i32 i = 0; i < 10; ++i)
+        logger.log(1, 0, 0x0001, i);
+    CHECK(logger.stats().samples == 8);
+    CHECK(logger.stats().dropped == 2);
+    CHECK(logger.memory_bound() == 2 * 4 * 22);
+
+    // More than 255 DLVs cannot be indexed in one TLG
+    TaskLogger wide(TaskLogConfig{}.path(dir).blocks(1024, 1));
+    for (u16 d = 0; d < 256; ++d)
+        wide.log(1, 0, d, 0);
+    CHECK(wide.stats().unmapped == 1);
+}
+
+TEST_CASE("TaskControllerServer feeds the task logger") {
+    auto dir = fresh_dir("agrobus_tlg_server");
+    IsoNet net;
+    auto *cf = net.create_internal(Name{}, 0, 0x30).value();
+    TaskControllerServer server(net, cf);
+    server.start();
+    server.set_client_name(0x81, 0xCAFE);
+
+    TaskLogger logger(TaskLogConfig{}.path(dir).position(false));
+    REQUIRE(logger.start().is_ok());
+    server.set_task_logger(&logger);
+
+    // Value, element 5, DDI 0x0074, value 1000
+    net.inject_message(Message(PGN_ECU_TO_TC, {0x53, 0x00, 0x74, 0x00, 0xE8, 0x03, 0x00, 0x00}, 0x81, 0x30));
+    logger.flush();
+
+    CHECK(logger.stats().samples == 1);
+    auto xml = read_text(logger.header_path(0xCAFE));
+    CHECK(xml.find("C=\"DET-5\"") != std::string::npos);
+
+    server.set_task_logger(nullptr);
+    logger.stop();
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,173 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/tc/taskdata.hpp>
+#include <agrobus/net/xml_reader.hpp>
+#include <fstream>
+
+using namespace agrobus::net;
+using namespace agrobus::isobus::tc;
+
+static const char *TASKDATA = R"(<?xml version="1.0" encoding="UTF-8"?>
+<!-- exported by a farm management system -->
+<ISO11783_TaskData VersionMajor="4" VersionMinor="3" DataTransferOrigin="1">
+  <DVC A="DVC1" B="Sprayer &amp; Co" C="1.2" D="A00086000C2000E3" E="SN42" F="31323334353637" G="656E0000000000">
+    <DET A="DET1" B="1" C="1" D="Device" E="0" F="0">
+      <DOR A="10"/>
+    </DET>
+    <DET A="DET2" B="2" C="4" D="Section 1" E="1" F="1">
+      <DOR A="11"/>
+    </DET>
+    <DPD A="10" B="0001" C="1" D="8" E="Setpoint rate" F="20"/>
+    <DPT A="11" B="0043" C="750" D="Width"/>
+    <DVP A="20" B="0" C="0.001" D="1" E="l/ha"/>
+  </DVC>
+  <PFD A="PFD1" C="North field">
+    <PLN A="1">
+      <LSG A="1">
+        <PNT A="2" C="52.0" D="5.0"/><PNT A="2" C="52.01" D="5.0"/>
+        <PNT A="2" C="52.01" D="5.01"/><PNT A="2" C="52.0" D="5.01"/>
+      </LSG>
+      <LSG A="2">
+        <PNT A="2" C="52.004" D="5.004"/><PNT A="2" C="52.005" D="5.004"/><PNT A="2" C="52.005" D="5.005"/>
+      </LSG>
+    </PLN>
+  </PFD>
+  <TSK A="TSK1" B="Spray north" E="PFD1" G="1">
+    <TZN A="1" B="low">
+      <PDV A="0001" B="100000"/>
+      <PLN A="2"><LSG A="1">
+        <PNT A="2" C="52.0" D="5.0"/><PNT A="2" C="52.005" D="5.0"/><PNT A="2" C="52.005" D="5.01"/><PNT A="2" C="52.0" D="5.01"/>
+      </LSG></PLN>
+    </TZN>
+    <TZN A="2" B="high"><PDV A="0001" B="200000"/></TZN>
+    <GRD A="52.0" B="5.0" C="0.001" D="0.002" E="3" F="2" G="GRD00001" I="1"/>
+  </TSK>
+  <TSK A="TSK2" B="Type 2 grid">
+    <TZN A="5"><PDV A="0006" B="0"/><PDV A="0001" B="0"/></TZN>
+    <GRD A="52.0" B="5.0" C="0.001" D="0.001" E="2" F="1" G="GRD00002" I="2" J="5"/>
+  </TSK>
+</ISO11783_TaskData>
+)";
+
+static std::filesystem::path write_set() {
+    auto dir = std::filesystem::temp_directory_path() / "agrobus_taskdata";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "TASKDATA.XML") << TASKDATA;
+    // Type 1: zone codes, south row first
+    const u8 codes[] = {1, 2, 1, 2, 2, 9};
+    std::ofstream(dir / "GRD00001.bin", std::ios::binary).write(reinterpret_cast<const char *>(codes), sizeof(codes));
+    // Type 2: two PDVs per cell (DDI 6, then DDI 1)
+    const i32 values[] = {11, 111, 22, 222};
+    std::ofstream(dir / "GRD00002.BIN", std::ios::binary).write(reinterpret_cast<const char *>(values), sizeof(values));
+    return dir;
+}
+
+TEST_CASE("XmlReader streams elements and attributes") {
+    XmlReader r(std::string_view("<?xml version=\"1.0\"?><a x='1' y=\"two\"><!-- c --><b/>text<![CDATA[<x>]]></a>"));
+    REQUIRE(r.next() == XmlReader::Event::Start);
+    CHECK(r.name() == "a");
+    CHECK(r.attr("y") == "two");
+    CHECK(XmlReader::to_int<u32>(r.attr("x")).value() == 1);
+    CHECK(r.attr("z").empty());
+    REQUIRE(r.next() == XmlReader::Event::Start);
+    CHECK(r.name() == "b");
+    CHECK(r.depth() == 2);
+    REQUIRE(r.next() == XmlReader::Event::End);
+    CHECK(r.name() == "b");
+    REQUIRE(r.next() == XmlReader::Event::End);
+    CHECK(r.name() == "a");
+    CHECK(r.next() == XmlReader::Event::Eof);
+
+    CHECK(XmlReader::unescape("a &amp; b &lt;&#65;&#x42;&gt;") == "a & b <AB>");
+
+    XmlReader bad(std::string_view("<a b=c/>"));
+    CHECK(bad.next() == XmlReader::Event::Error);
+    XmlReader open(std::string_view("<a><b>"));
+    open.next();
+    open.next();
+    CHECK(open.next() == XmlReader::Event::Error);
+}
+
+TEST_CASE("TASKDATA import: partfields, tasks, grids and devices") {
+    auto dir = write_set();
+    auto result = load_taskdata(dir);
+    REQUIRE(result.is_ok());
+    auto &set = result.value();
+
+    REQUIRE(set.partfields.size() == 1);
+    const auto &pfd = set.partfields[0];
+    CHECK(pfd.id == "PFD1");
+    CHECK(pfd.designator == "North field");
+    CHECK(pfd.boundary.size() == 4);
+    REQUIRE(pfd.holes.size() == 1);
+    CHECK(pfd.holes[0].size() == 3);
+
+    REQUIRE(set.tasks.size() == 2);
+    const auto &t1 = set.tasks[0];
+    CHECK(t1.partfield == "PFD1");
+    CHECK(t1.rate_ddi == 0x0001);
+    REQUIRE(t1.zones.zones.size() == 1);
+    CHECK(t1.zones.zones[0].application_rate == 100000);
+    REQUIRE(t1.grid.has_value());
+    CHECK(t1.grid->columns == 3);
+    CHECK(t1.grid->rows == 2);
+    CHECK(*t1.grid->rate_at(concord::earth::WGS(52.0005, 5.0001)) == 100000);
+    CHECK(*t1.grid->rate_at(concord::earth::WGS(52.0005, 5.0021)) == 200000);
+    CHECK(*t1.grid->rate_at(concord::earth::WGS(52.0015, 5.0001)) == 200000);
+    CHECK_FALSE(t1.grid->rate_at(concord::earth::WGS(52.0015, 5.0041)).has_value()); // code 9: no zone
+
+    const auto &t2 = set.tasks[1];
+    REQUIRE(t2.grid.has_value());
+    CHECK(t2.rate_ddi == 0x0006); // no rate DDI configured: first PDV
+    CHECK(t2.grid->rates[0] == 11);
+    CHECK(t2.grid->rates[1] == 22);
+
+    REQUIRE(set.devices.size() == 1);
+    const auto &dvc = set.devices[0];
+    CHECK(dvc.client_name == 0xA00086000C2000E3ull);
+    const auto &ddop = dvc.ddop;
+    REQUIRE(ddop.devices().size() == 1);
+    CHECK(ddop.devices()[0].designator == "Sprayer & Co");
+    CHECK(ddop.devices()[0].structure_label[0] == '1');
+    CHECK(ddop.devices()[0].localization_label[0] == 'e');
+    CHECK(ddop.object_count() == 6);
+    REQUIRE(ddop.elements().size() == 2);
+    CHECK(ddop.elements()[1].type == DeviceElementType::Section);
+    CHECK(ddop.elements()[1].number == 1);
+    REQUIRE(ddop.elements()[1].child_objects.size() == 1);
+    CHECK(ddop.elements()[1].child_objects[0] == 11);
+    CHECK(ddop.serialize().is_ok());
+
+    CHECK(set.stats.grid_cells == 8);
+    CHECK(set.stats.zones == 1);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("TASKDATA import: rate DDI selection and streaming callbacks") {
+    auto dir = write_set();
+    TaskDataReader reader(TaskDataConfig{}.rate(0x0001).grids(false));
+    dp::Vector<dp::String> order;
+    TaskDataHandlers handlers;
+    handlers.on_task = [&](TaskDataTask &&t) {
+        order.push_back(t.id);
+        CHECK_FALSE(t.grid.has_value());
+        if (t.id == "TSK2")
+            CHECK(t.rate_ddi == 0x0001);
+    };
+    handlers.on_device = [&](TaskDataDevice &&d) { order.push_back(d.id); };
+    auto stats = reader.read(dir, handlers);
+    REQUIRE(stats.is_ok());
+    REQUIRE(order.size() == 3);
+    CHECK(order[0] == "DVC1");
+    CHECK(order[2] == "TSK2");
+
+    auto by_ddi = load_taskdata(dir, TaskDataConfig{}.rate(0x0001));
+    REQUIRE(by_ddi.is_ok());
+    REQUIRE(by_ddi.value().tasks[1].grid.has_value());
+    CHECK(by_ddi.value().tasks[1].grid->rates[0] == 111);
+    CHECK(by_ddi.value().tasks[1].grid->rates[1] == 222);
+
+    CHECK(reader.read(std::string_view("<NotTaskData/>"), dir, handlers).is_err());
+    CHECK(reader.read(std::string_view("<ISO11783_TaskData><TSK A=\"x\">"), dir, handlers).is_err());
+    std::filesystem::remove_all(dir);
+}
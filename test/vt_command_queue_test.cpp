@@ -0,0 +1,320 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/vt/command_queue.hpp>
+#include <agrobus/isobus/vt/update_helper.hpp>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::vt;
+
+struct QueueFixture {
+    IsoNet nm;
+    InternalCF *cf = nullptr;
+    dp::Optional<VTClient> client;
+    ObjectPool pool;
+    dp::Vector<VTQueuedCommand> sent;
+
+    QueueFixture() {
+        Name name;
+        cf = nm.create_internal(name, 0, 0x28).value();
+        client.emplace(nm, cf);
+
+        // WS(0) -> DataMask(10) -> [100, 101]; DataMask(20) -> [200]
+        pool.add(VTObject{}.set_id(0).set_type(ObjectType::WorkingSet).set_children({10, 20}));
+        pool.add(VTObject{}.set_id(10).set_type(ObjectType::DataMask).set_children({100, 101}));
+        pool.add(VTObject{}.set_id(20).set_type(ObjectType::DataMask).set_children({200}));
+        pool.add(VTObject{}.set_id(100).set_type(ObjectType::OutputNumber));
+        pool.add(VTObject{}.set_id(101).set_type(ObjectType::OutputString));
+        pool.add(VTObject{}.set_id(200).set_type(ObjectType::OutputNumber));
+    }
+
+    void capture(VTCommandQueue &queue) {
+        queue.set_sender([this](const VTQueuedCommand &cmd) {
+            sent.push_back(cmd);
+            return Result<void>{};
+        });
+    }
+
+    static Message vt_status(ObjectID data_mask, u8 busy = 0) {
+        Message msg;
+        msg.pgn = PGN_VT_TO_ECU;
+        msg.source = 0x26;
+        msg.data = {vt_cmd::VT_STATUS, 0x28, static_cast<u8>(data_mask & 0xFF), static_cast<u8>(data_mask >> 8),
+                    0xFF, 0xFF, busy, 0xFF};
+        return msg;
+    }
+
+    // Change Numeric Value / Hide-Show style response: object id in bytes 2-3
+    static Message response(u8 function, ObjectID id, u8 error = 0) {
+        Message msg;
+        msg.pgn = PGN_VT_TO_ECU;
+        msg.source = 0x26;
+        msg.data = {function, static_cast<u8>(id & 0xFF), static_cast<u8>(id >> 8), 0, 0, 0xFF, 0xFF, 0xFF};
+        msg.data[function == vt_cmd::CHANGE_NUMERIC_VALUE ? 3 : 4] = error;
+        return msg;
+    }
+};
+
+TEST_CASE("VTCommandQueue coalesces per object attribute") {
+    QueueFixture f;
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.outstanding(8));
+    f.capture(queue);
+
+    queue.change_numeric_value(100, 1);
+    queue.change_numeric_value(100, 2);
+    queue.change_numeric_value(100, 3);
+    queue.hide_show(100, false); // different attribute, kept
+    CHECK(queue.pending_count() == 2);
+    CHECK(queue.stats().coalesced == 2);
+    CHECK(queue.stats().enqueued == 4);
+
+    queue.update(0);
+    REQUIRE(f.sent.size() == 2);
+    CHECK(f.sent[0].kind == VTCommandKind::Numeric);
+    CHECK(f.sent[0].value == 3);
+    CHECK(f.sent[1].kind == VTCommandKind::Visibility);
+}
+
+TEST_CASE("VTCommandQueue orders by user-visible priority") {
+    QueueFixture f;
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.outstanding(8));
+    f.capture(queue);
+    queue.set_pool(&f.pool);
+    queue.process_vt_message(QueueFixture::vt_status(10));
+
+    CHECK(queue.is_on_active_mask(100));
+    CHECK(queue.is_on_active_mask(101));
+    CHECK_FALSE(queue.is_on_active_mask(200));
+
+    queue.change_numeric_value(200, 5);  // background
+    queue.change_numeric_value(100, 6);  // on active mask
+    queue.change_active_mask(0, 20);     // mask change
+    queue.update(0);
+
+    // The mask switch goes first and makes 200 the user-visible object
+    REQUIRE(f.sent.size() == 3);
+    CHECK(f.sent[0].kind == VTCommandKind::ActiveMask);
+    CHECK(f.sent[1].id == 200);
+    CHECK(f.sent[2].id == 100);
+    CHECK(queue.active_data_mask() == 20);
+    CHECK(queue.is_on_active_mask(200));
+}
+
+TEST_CASE("VTCommandQueue outstanding command window") {
+    QueueFixture f;
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.response_timeout(500));
+    f.capture(queue);
+
+    queue.change_numeric_value(100, 1);
+    queue.change_numeric_value(200, 2);
+
+    queue.update(0);
+    CHECK(f.sent.size() == 1);
+    CHECK(queue.in_flight_count() == 1);
+
+    SUBCASE("response releases the next command") {
+        queue.update(40);
+        queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 200)); // not in flight
+        CHECK(queue.in_flight_count() == 1);
+        queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 100));
+        CHECK(queue.in_flight_count() == 0);
+        CHECK(queue.stats().responses == 1);
+        CHECK(queue.stats().response_time_max_ms == 40);
+        queue.update(10);
+        CHECK(f.sent.size() == 2);
+        CHECK(queue.stats().queue_latency_max_ms == 50);
+    }
+
+    SUBCASE("timeout releases the window and retries") {
+        queue.update(499);
+        CHECK(f.sent.size() == 1);
+        queue.update(1);
+        CHECK(queue.stats().timeouts == 1);
+        REQUIRE(f.sent.size() == 2);
+        CHECK(f.sent[1].id == 100); // unanswered command goes again, ahead of newer ones
+        CHECK(queue.pending_count() == 1);
+    }
+
+    SUBCASE("a newer value replaces an unanswered one") {
+        queue.change_numeric_value(100, 9);
+        queue.update(500);
+        queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 200));
+        queue.update(10);
+        REQUIRE(f.sent.size() == 3);
+        CHECK(f.sent[2].id == 100);
+        CHECK(f.sent[2].value == 9); // the stale 1 is not sent again
+        CHECK(queue.pending_count() == 0);
+    }
+}
+
+TEST_CASE("VTCommandQueue holds while VT is busy") {
+    QueueFixture f;
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.outstanding(8));
+    f.capture(queue);
+
+    queue.process_vt_message(QueueFixture::vt_status(10, vt_busy::PARSING_POOL));
+    CHECK(queue.is_held());
+    queue.change_numeric_value(100, 1);
+    queue.update(100);
+    CHECK(f.sent.empty());
+
+    // Busy bits outside the hold mask do not block
+    queue.process_vt_message(QueueFixture::vt_status(10, vt_busy::UPDATING_VISIBLE_MASK));
+    queue.update(0);
+    CHECK(f.sent.size() == 1);
+}
+
+TEST_CASE("VTCommandQueue paces to the bus-load budget") {
+    QueueFixture f;
+    // 250 kbit/s * 5% / 128 bit ~ 97 frames/s, burst ~ 9 frames
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.bus_load(0.05f).outstanding(255));
+    f.capture(queue);
+
+    for (u16 i = 0; i < 200; ++i)
+        queue.change_numeric_value(static_cast<ObjectID>(1000 + i), i);
+
+    queue.update(0);
+    usize burst = f.sent.size();
+    CHECK(burst > 0);
+    CHECK(burst < 20);
+
+    for (int i = 0; i < 10; ++i)
+        queue.update(100); // one second
+    CHECK(f.sent.size() <= burst + 100);
+    CHECK(f.sent.size() >= burst + 90);
+}
+
+TEST_CASE("VTCommandQueue without sender uses the VT client") {
+    QueueFixture f;
+    VTCommandQueue queue(f.nm, *f.client);
+    queue.change_numeric_value(100, 1);
+    queue.update(0); // client is disconnected
+    CHECK(queue.stats().send_failures == 1);
+    CHECK(queue.pending_count() == 1); // kept for the next attempt
+    queue.update(10);
+    CHECK(queue.stats().send_failures == 2);
+    CHECK(queue.pending_count() == 1);
+}
+
+TEST_CASE("VTCommandQueue retries a failed send") {
+    QueueFixture f;
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.outstanding(8));
+    bool link_up = false;
+    queue.set_sender([&](const VTQueuedCommand &cmd) {
+        if (!link_up)
+            return Result<void>::err(Error::invalid_state("bus off"));
+        f.sent.push_back(cmd);
+        return Result<void>{};
+    });
+
+    queue.change_numeric_value(100, 1);
+    queue.change_numeric_value(200, 2);
+    queue.update(0);
+    CHECK(queue.stats().send_failures == 1); // stops at the first failure
+    CHECK(queue.pending_count() == 2);
+
+    link_up = true;
+    queue.update(10);
+    REQUIRE(f.sent.size() == 2);
+    CHECK(f.sent[0].id == 100);
+    CHECK(f.sent[1].id == 200);
+}
+
+TEST_CASE("VTCommandQueue matches responses by object id") {
+    QueueFixture f;
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.outstanding(8));
+    f.capture(queue);
+    dp::Vector<ObjectID> acked, rejected;
+    queue.on_acknowledged.subscribe([&](const VTQueuedCommand &cmd) { acked.push_back(cmd.id); });
+    queue.on_rejected.subscribe([&](ObjectID id, VTCommandKind, u8 error) {
+        CHECK(error == 0x04);
+        rejected.push_back(id);
+    });
+
+    queue.change_numeric_value(100, 1);
+    queue.change_numeric_value(200, 2);
+    queue.change_attribute(100, 3, 7);
+    queue.change_attribute(100, 4, 8);
+    queue.update(0);
+    CHECK(queue.in_flight_count() == 4);
+
+    // Answered out of order
+    queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 200));
+    REQUIRE(acked.size() == 1);
+    CHECK(acked[0] == 200);
+
+    auto attr = QueueFixture::response(vt_cmd::CHANGE_ATTRIBUTE, 100);
+    attr.data[3] = 4;
+    queue.process_vt_message(attr);
+    CHECK(queue.in_flight_count() == 2);
+
+    queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 100, 0x04));
+    CHECK(rejected.size() == 1);
+    CHECK(queue.stats().rejected == 1);
+    CHECK(queue.in_flight_count() == 1);
+    CHECK(queue.pending_count() == 0); // rejected commands are not retried
+}
+
+TEST_CASE("VTClientUpdateHelper end_batch enqueues into the queue") {
+    QueueFixture f;
+    VTClientStateTracker tracker(f.nm);
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.outstanding(8));
+    f.capture(queue);
+    VTClientUpdateHelper helper(*f.client, tracker, &f.pool);
+    helper.with_queue(&queue);
+
+    helper.begin_batch();
+    helper.set_numeric_value(100, 7);
+    helper.set_string_value(101, "ok");
+    auto result = helper.end_batch();
+    CHECK(result.is_ok());
+    CHECK(queue.pending_count() == 2);
+    CHECK(!tracker.numeric_value(100)); // not on the VT yet
+
+    queue.update(0);
+    CHECK(f.sent.size() == 2);
+    queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 100));
+    REQUIRE(tracker.numeric_value(100));
+    CHECK(*tracker.numeric_value(100) == 7);
+    CHECK(!tracker.string_value_equals(101, "ok"));
+
+    // An unanswered value is sent again, and a repeated set is not suppressed meanwhile
+    helper.begin_batch();
+    helper.set_string_value(101, "ok");
+    CHECK(helper.end_batch().is_ok());
+    CHECK(queue.pending_count() == 1);
+}
+
+TEST_CASE("VTClientUpdateHelper keeps staged values out of the tracker until acknowledged") {
+    QueueFixture f;
+    VTClientStateTracker tracker(f.nm);
+    tracker.bind_pool(f.pool);
+    tracker.set_numeric_value(100, 1);
+    VTCommandQueue queue(f.nm, *f.client, VTCommandQueueConfig{}.outstanding(8));
+    f.capture(queue);
+    VTClientUpdateHelper helper(*f.client, tracker, &f.pool);
+    helper.with_queue(&queue);
+
+    CHECK(helper.stage_numeric_value(100, 5).is_ok());
+    CHECK(helper.staged_count() == 1);
+    CHECK(*tracker.numeric_value(100) == 1);
+    CHECK(helper.stage_numeric_value(100, 1).is_ok()); // back to what the VT shows
+    CHECK(helper.staged_count() == 0);
+
+    CHECK(helper.stage_numeric_value(100, 5).is_ok());
+    CHECK(helper.flush().is_ok());
+    CHECK(queue.pending_count() == 1);
+    CHECK(*tracker.numeric_value(100) == 1);
+
+    // The VT rejects it: the tracker still holds 1, so staging 5 again resends
+    queue.update(0);
+    REQUIRE(f.sent.size() == 1);
+    queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 100, 0x04));
+    CHECK(*tracker.numeric_value(100) == 1);
+    CHECK(helper.stage_numeric_value(100, 5).is_ok());
+    CHECK(helper.flush().is_ok());
+    queue.update(10);
+    REQUIRE(f.sent.size() == 2);
+    CHECK(f.sent[1].value == 5);
+
+    queue.process_vt_message(QueueFixture::response(vt_cmd::CHANGE_NUMERIC_VALUE, 100));
+    CHECK(*tracker.numeric_value(100) == 5);
+}
@@ -0,0 +1,189 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/vt/dense_state.hpp>
+#include <agrobus/isobus/vt/state_tracker.hpp>
+#include <agrobus/isobus/vt/update_helper.hpp>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::vt;
+
+static ObjectPool make_numeric_pool(u16 count, ObjectID first_id = 1000) {
+    ObjectPool pool;
+    pool.add(VTObject{}.set_id(0).set_type(ObjectType::WorkingSet));
+    for (u16 i = 0; i < count; ++i)
+        pool.add(VTObject{}.set_id(static_cast<ObjectID>(first_id + i)).set_type(ObjectType::OutputNumber));
+    return pool;
+}
+
+TEST_CASE("SlotBits set, test and drain") {
+    SlotBits bits;
+    bits.resize(200);
+    CHECK_FALSE(bits.any());
+
+    bits.set(0);
+    bits.set(63);
+    bits.set(64);
+    bits.set(199);
+    CHECK(bits.test(63));
+    CHECK_FALSE(bits.test(62));
+    CHECK(bits.count() == 4);
+
+    dp::Vector<Slot> seen;
+    bits.drain([&](Slot s) { seen.push_back(s); });
+    REQUIRE(seen.size() == 4);
+    CHECK(seen[0] == 0);
+    CHECK(seen[1] == 63);
+    CHECK(seen[2] == 64);
+    CHECK(seen[3] == 199);
+    CHECK_FALSE(bits.any());
+}
+
+TEST_CASE("DenseObjectState slot assignment") {
+    DenseObjectState dense;
+    dense.assign(make_numeric_pool(3));
+
+    CHECK(dense.size() == 4);
+    CHECK(dense.slot_of(0) == 0);
+    CHECK(dense.slot_of(1000) == 1);
+    CHECK(dense.slot_of(1002) == 3);
+    CHECK(dense.slot_of(1003) == INVALID_SLOT);
+    CHECK(dense.slot_of(0xFFFE) == INVALID_SLOT);
+    CHECK(dense.id_of(2) == 1001);
+
+    SUBCASE("duplicate ids keep first slot") {
+        dense.assign(dp::Vector<ObjectID>{5, 7, 5});
+        CHECK(dense.size() == 2);
+        CHECK(dense.slot_of(5) == 0);
+    }
+}
+
+TEST_CASE("DenseObjectState values") {
+    DenseObjectState dense;
+    dense.assign(dp::Vector<ObjectID>{10, 20, 30});
+    Slot s = dense.slot_of(20);
+
+    SUBCASE("numeric unknown until set") {
+        CHECK_FALSE(dense.numeric(s).has_value());
+        CHECK(dense.set_numeric(s, 0));
+        CHECK(dense.numeric(s).has_value());
+        CHECK_FALSE(dense.set_numeric(s, 0));
+        CHECK(dense.set_numeric(s, 7));
+        CHECK(*dense.numeric(s) == 7);
+    }
+
+    SUBCASE("short strings stay inline") {
+        CHECK(dense.set_string(s, "km/h"));
+        CHECK(dense.string_equals(s, "km/h"));
+        CHECK_FALSE(dense.set_string(s, "km/h"));
+        CHECK(*dense.string(s) == "km/h");
+        CHECK(dense.spilled_string_count() == 0);
+    }
+
+    SUBCASE("long strings spill and shrink back") {
+        dp::String long_str = "Section 12 blocked: pressure too low";
+        CHECK(dense.set_string(s, long_str));
+        CHECK(dense.spilled_string_count() == 1);
+        CHECK(*dense.string(s) == long_str);
+        CHECK(dense.set_string(s, "ok"));
+        CHECK(dense.spilled_string_count() == 0);
+        CHECK(*dense.string(s) == "ok");
+    }
+
+    SUBCASE("visibility and enable bitsets") {
+        CHECK_FALSE(dense.visible(s).has_value());
+        CHECK(dense.set_visible(s, false));
+        CHECK(*dense.visible(s) == false);
+        CHECK(dense.set_enabled(s, true));
+        CHECK(*dense.enabled(s) == true);
+        CHECK_FALSE(dense.enabled(dense.slot_of(10)).has_value());
+    }
+
+    SUBCASE("dirty drain reports ids by kind") {
+        dense.mark_dirty(dense.slot_of(30), DirtyKind::Numeric);
+        dense.mark_dirty(dense.slot_of(10), DirtyKind::Visibility);
+        CHECK(dense.dirty_count() == 2);
+
+        dp::Vector<ObjectID> ids;
+        dp::Vector<DirtyKind> kinds;
+        dense.drain_dirty([&](ObjectID id, Slot, DirtyKind kind) {
+            ids.push_back(id);
+            kinds.push_back(kind);
+        });
+        REQUIRE(ids.size() == 2);
+        CHECK(ids[0] == 30);
+        CHECK(kinds[0] == DirtyKind::Numeric);
+        CHECK(ids[1] == 10);
+        CHECK(kinds[1] == DirtyKind::Visibility);
+        CHECK_FALSE(dense.has_dirty());
+    }
+}
+
+TEST_CASE("VTClientStateTracker dense binding") {
+    IsoNet net;
+    VTClientStateTracker tracker(net);
+    auto pool = make_numeric_pool(4);
+
+    SUBCASE("sparse values migrate on bind") {
+        tracker.set_numeric_value(1001, 55);
+        tracker.set_numeric_value(9999, 1); // not in pool
+        tracker.bind_pool(pool);
+        CHECK(tracker.is_pool_bound());
+        CHECK(*tracker.numeric_value(1001) == 55);
+        CHECK(*tracker.numeric_value(9999) == 1);
+        CHECK(tracker.dense().numeric(tracker.dense().slot_of(1001)).has_value());
+    }
+
+    SUBCASE("VT change messages update dense state") {
+        tracker.initialize();
+        tracker.bind_pool(pool);
+        tracker.set_visibility(1003, true);
+        CHECK(*tracker.is_visible(1003));
+        tracker.set_string_value(1002, "abc");
+        CHECK(tracker.string_value_equals(1002, "abc"));
+    }
+
+    SUBCASE("staging marks dirty only on change") {
+        tracker.bind_pool(pool);
+        CHECK(tracker.stage_numeric_value(1000, 5));
+        CHECK_FALSE(tracker.stage_numeric_value(1000, 5));
+        CHECK(tracker.stage_enable_state(1001, false));
+        CHECK_FALSE(tracker.stage_numeric_value(4242, 1)); // unbound id
+        CHECK(tracker.dense().dirty_count() == 2);
+    }
+
+    SUBCASE("reset keeps slots but forgets values") {
+        tracker.bind_pool(pool);
+        tracker.set_numeric_value(1000, 3);
+        tracker.reset();
+        CHECK(tracker.is_pool_bound());
+        CHECK_FALSE(tracker.numeric_value(1000).has_value());
+    }
+}
+
+TEST_CASE("VTClientUpdateHelper staged flush") {
+    IsoNet nm;
+    Name name;
+    auto cf_result = nm.create_internal(name, 0, 0x28);
+    auto *cf = cf_result.value();
+
+    VTClient client(nm, cf);
+    VTClientStateTracker tracker(nm);
+    auto pool = make_numeric_pool(8);
+    tracker.bind_pool(pool);
+    VTClientUpdateHelper helper(client, tracker, &pool);
+
+    SUBCASE("repeated stages coalesce into one dirty entry") {
+        helper.stage_numeric_value(1000, 1);
+        helper.stage_numeric_value(1000, 2);
+        helper.stage_numeric_value(1000, 3);
+        CHECK(helper.staged_count() == 1);
+        CHECK(*tracker.numeric_value(1000) == 3);
+    }
+
+    SUBCASE("failed sends stay dirty") {
+        helper.stage_numeric_value(1000, 1);
+        helper.stage_visibility(1001, false);
+        auto result = helper.flush(); // client is not connected
+        CHECK(result.is_err());
+        CHECK(helper.staged_count() == 2);
+    }
+}
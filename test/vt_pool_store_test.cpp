@@ -0,0 +1,205 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/vt/pool_store.hpp>
+#include <agrobus/isobus/vt/server.hpp>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::vt;
+
+static dp::String fresh_store_dir(const char *name) {
+    auto dir = std::filesystem::temp_directory_path() / "agrobus_pool_store" / name;
+    std::filesystem::remove_all(dir);
+    return dp::String(dir.string().c_str());
+}
+
+static dp::Vector<u8> make_blob(u8 seed, usize size) {
+    dp::Vector<u8> data(size);
+    for (usize i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(seed + i * 31);
+    return data;
+}
+
+static usize count_blob_files(const dp::String &root) {
+    usize n = 0;
+    for (const auto &e : std::filesystem::directory_iterator(std::filesystem::path(root.c_str()) / "objects"))
+        if (e.path().extension() == ".vtp")
+            ++n;
+    return n;
+}
+
+TEST_CASE("PoolStore deduplicates identical pools") {
+    auto root = fresh_store_dir("dedup");
+    PoolStore store(PoolStoreConfig{}.path(root));
+    REQUIRE(store.open().is_ok());
+
+    auto pool = make_blob(1, 1000);
+    CHECK(store.put(0x81, "v1", pool).is_ok());
+    CHECK(store.put(0x82, "v1", pool).is_ok());
+    CHECK(store.put(0x82, "backup", pool).is_ok());
+
+    CHECK(store.label_count() == 3);
+    CHECK(store.blob_count() == 1);
+    CHECK(store.disk_bytes() == 1000);
+    CHECK(store.stats().dedup_hits == 2);
+    CHECK(count_blob_files(root) == 1);
+
+    SUBCASE("blob survives until its last label is removed") {
+        CHECK(store.remove(0x81, "v1"));
+        CHECK(store.remove(0x82, "v1"));
+        CHECK(count_blob_files(root) == 1);
+        CHECK(store.remove(0x82, "backup"));
+        CHECK(store.blob_count() == 0);
+        CHECK(count_blob_files(root) == 0);
+        CHECK_FALSE(store.remove(0x82, "backup"));
+    }
+
+    SUBCASE("relabel to new content releases the old blob") {
+        auto other = make_blob(9, 500);
+        CHECK(store.put(0x81, "v1", other).is_ok());
+        CHECK(store.blob_count() == 2);
+        CHECK(store.remove(0x82, "v1"));
+        CHECK(store.remove(0x82, "backup"));
+        CHECK(store.blob_count() == 1);
+        CHECK(store.disk_bytes() == 500);
+    }
+}
+
+TEST_CASE("PoolStore serves loads from a mapping") {
+    auto root = fresh_store_dir("mmap");
+    PoolStore store(PoolStoreConfig{}.path(root));
+    REQUIRE(store.open().is_ok());
+
+    auto pool = make_blob(3, 4096);
+    REQUIRE(store.put(0x90, "v2", pool).is_ok());
+
+    auto first = store.load(0x90, "v2");
+    REQUIRE(first.is_ok());
+    REQUIRE(first.value().size() == pool.size());
+    bool same = true;
+    for (usize i = 0; i < pool.size(); ++i)
+        same = same && first.value().data()[i] == pool[i];
+    CHECK(same);
+    CHECK(store.stats().misses == 1);
+
+    auto second = store.load(0x90, "v2");
+    REQUIRE(second.is_ok());
+    CHECK(second.value().data() == first.value().data());
+    CHECK(store.stats().hits == 1);
+
+    CHECK(store.load(0x90, "nope").is_err());
+    CHECK(store.load(0x91, "v2").is_err());
+}
+
+TEST_CASE("PoolStore memory budget unmaps idle blobs only") {
+    auto root = fresh_store_dir("memory");
+    PoolStore store(PoolStoreConfig{}.path(root).memory(3000));
+    REQUIRE(store.open().is_ok());
+
+    REQUIRE(store.put(1, "a", make_blob(1, 2000)).is_ok());
+    REQUIRE(store.put(1, "b", make_blob(2, 2000)).is_ok());
+
+    auto held = store.load(1, "a");
+    REQUIRE(held.is_ok());
+    {
+        auto idle = store.load(1, "b");
+        REQUIRE(idle.is_ok());
+    }
+    // Both views were alive while mapping b, so neither could be dropped yet
+    CHECK(store.mapped_bytes() == 4000);
+
+    store.set_memory_budget(3000);
+    CHECK(store.mapped_bytes() == 2000); // b dropped, a still held by a view
+    CHECK(store.stats().unmapped == 1);
+    CHECK(held.value().data()[0] == make_blob(1, 1)[0]);
+}
+
+TEST_CASE("PoolStore disk budget evicts least recently used labels") {
+    auto root = fresh_store_dir("disk");
+    PoolStore store(PoolStoreConfig{}.path(root).disk(2500));
+    REQUIRE(store.open().is_ok());
+
+    REQUIRE(store.put(1, "old", make_blob(1, 1000)).is_ok());
+    REQUIRE(store.put(2, "mid", make_blob(2, 1000)).is_ok());
+    REQUIRE(store.load(1, "old").is_ok()); // touch: "mid" is now least recently used
+    REQUIRE(store.put(3, "new", make_blob(3, 1000)).is_ok());
+
+    CHECK(store.contains(1, "old"));
+    CHECK_FALSE(store.contains(2, "mid"));
+    CHECK(store.contains(3, "new"));
+    CHECK(store.disk_bytes() == 2000);
+    CHECK(store.stats().evicted == 1);
+
+    SUBCASE("a pool larger than the budget keeps itself") {
+        REQUIRE(store.put(4, "huge", make_blob(4, 4000)).is_ok());
+        CHECK(store.contains(4, "huge"));
+        CHECK(store.label_count() == 1);
+    }
+}
+
+TEST_CASE("PoolStore index persists across reopen") {
+    auto root = fresh_store_dir("reopen");
+    {
+        PoolStore store(PoolStoreConfig{}.path(root));
+        REQUIRE(store.open().is_ok());
+        REQUIRE(store.put(0xABCDEF, "v1", make_blob(5, 300), 4).is_ok());
+        REQUIRE(store.put(0xABCDEF, "v2", make_blob(6, 400)).is_ok());
+    }
+    // A stray temporary from an interrupted write is cleaned up
+    { std::ofstream(std::filesystem::path(root.c_str()) / "objects" / "0000000000000001.vtp.tmp") << "x"; }
+
+    PoolStore store(PoolStoreConfig{}.path(root));
+    REQUIRE(store.open().is_ok());
+    CHECK(store.label_count() == 2);
+    CHECK(store.disk_bytes() == 700);
+    CHECK(count_blob_files(root) == 2);
+
+    auto labels = store.labels(0xABCDEF);
+    REQUIRE(labels.size() == 2);
+    CHECK(labels[0].label == "v1");
+    CHECK(labels[0].vt_version == 4);
+    CHECK(labels[0].size_bytes == 300);
+
+    auto view = store.load(0xABCDEF, "v2");
+    REQUIRE(view.is_ok());
+    CHECK(view.value().size() == 400);
+}
+
+TEST_CASE("VTServer stores versions in a shared pool store") {
+    auto root = fresh_store_dir("server");
+    PoolStore store(PoolStoreConfig{}.path(root));
+    REQUIRE(store.open().is_ok());
+
+    IsoNet nm;
+    Name name;
+    auto *cf = nm.create_internal(name, 0, 0x26).value();
+    VTServer server(nm, cf);
+    server.set_pool_store(&store);
+
+    ObjectPool pool;
+    pool.add(VTObject{}.set_id(0).set_type(ObjectType::WorkingSet).set_children({1}));
+    pool.add(VTObject{}.set_id(1).set_type(ObjectType::DataMask));
+    pool.add(VTObject{}.set_id(2).set_type(ObjectType::OutputNumber));
+
+    // Two implements of the same type at different addresses
+    server.set_client_name(0x81, 0x1111);
+    server.set_client_name(0x82, 0x2222);
+    auto &clients = const_cast<dp::Vector<ServerWorkingSet> &>(server.clients());
+    REQUIRE(clients.size() == 2);
+    for (auto &c : clients) {
+        c.pool = pool;
+        c.pool_uploaded = true;
+        CHECK(c.store_version("v1"));
+        CHECK(c.stored_versions.empty());
+    }
+    CHECK(store.blob_count() == 1);
+    CHECK(store.label_count() == 2);
+
+    auto &client = clients[0];
+    client.pool = ObjectPool{};
+    CHECK(client.load_version("v1"));
+    CHECK(client.pool.size() == 3);
+    CHECK(client.version_labels().size() == 1);
+
+    CHECK(client.delete_version("v1"));
+    CHECK_FALSE(client.load_version("v1"));
+    CHECK(store.blob_count() == 1);
+}
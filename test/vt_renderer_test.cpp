@@ -0,0 +1,235 @@
+#include <doctest/doctest.h>
+#include <agrobus/isobus/vt/renderer.hpp>
+#include <agrobus/isobus/vt/server.hpp>
+
+using namespace agrobus::isobus;
+using namespace agrobus::isobus::vt;
+
+static dp::Vector<u8> sized(u16 w, u16 h, std::initializer_list<u8> extra = {}) {
+    dp::Vector<u8> body = {static_cast<u8>(w & 0xFF), static_cast<u8>(w >> 8), static_cast<u8>(h & 0xFF),
+                           static_cast<u8>(h >> 8)};
+    for (auto b : extra)
+        body.push_back(b);
+    return body;
+}
+
+// WS(0) -> DataMask(1, blue, soft keys 2) -> [Container(10) -> OutputNumber(11), Rectangle(12)]
+//                                           [OutputString(13)]
+//          SoftKeyMask(2) -> [Key(20), Key(21)]
+static ObjectPool make_pool() {
+    ObjectPool pool;
+    pool.add(VTObject{}.set_id(0).set_type(ObjectType::WorkingSet).set_children({1}));
+    pool.add(VTObject{}.set_id(1).set_type(ObjectType::DataMask).set_body(sized(200, 200, {9, 2, 0})).set_children(
+        {10, 13}));
+    pool.add(VTObject{}.set_id(2).set_type(ObjectType::SoftKeyMask).set_body(sized(60, 200)).set_children({20, 21}));
+    pool.add(VTObject{}.set_id(10).set_type(ObjectType::Container).set_body(sized(100, 60)).set_children({11, 12}));
+    pool.add(VTObject{}.set_id(11).set_type(ObjectType::OutputNumber).set_body(sized(100, 20, {0, 1, 42, 0, 0, 0})));
+    pool.add(VTObject{}.set_id(12).set_type(ObjectType::Rectangle).set_body(sized(40, 40, {12, 14})));
+    pool.add(VTObject{}.set_id(13).set_type(ObjectType::OutputString).set_body(sized(120, 16, {0xFF, 1, 0, 'O', 'K'})));
+    pool.add(VTObject{}.set_id(20).set_type(ObjectType::Key).set_key_body(KeyBody{3, 1, 0}));
+    pool.add(VTObject{}.set_id(21).set_type(ObjectType::Key));
+    return pool;
+}
+
+static VTRendererConfig small_screen() { return VTRendererConfig{}.screen(260, 200).key_height(50).font(1); }
+
+static usize count_colour(const Framebuffer &fb, const Rect &r, u32 colour) {
+    usize n = 0;
+    for (i32 y = r.y; y < r.bottom(); ++y)
+        for (i32 x = r.x; x < r.right(); ++x)
+            if (fb.at(x, y) == colour)
+                ++n;
+    return n;
+}
+
+TEST_CASE("Rect operations") {
+    Rect a{0, 0, 10, 10};
+    Rect b{5, 5, 10, 10};
+    CHECK(a.intersect(b) == Rect{5, 5, 5, 5});
+    CHECK(a.unite(b) == Rect{0, 0, 15, 15});
+    CHECK(a.intersect(Rect{20, 20, 5, 5}).empty());
+    CHECK(Rect{}.unite(b) == b);
+    CHECK(a.contains(9, 9));
+    CHECK_FALSE(a.contains(10, 0));
+}
+
+TEST_CASE("VT standard palette") {
+    CHECK(vt_colour(0) == rgba(0, 0, 0));
+    CHECK(vt_colour(1) == rgba(0xFF, 0xFF, 0xFF));
+    CHECK(vt_colour(12) == rgba(0xFF, 0, 0));
+    CHECK(vt_colour(16) == rgba(0, 0, 0));
+    CHECK(vt_colour(231) == rgba(0xFF, 0xFF, 0xFF));
+    CHECK(vt_colour(16 + 36 * 1 + 6 * 2 + 3) == rgba(0x33, 0x66, 0x99));
+}
+
+TEST_CASE("VTRenderer full render lays out masks") {
+    VTRenderer renderer(small_screen());
+    renderer.set_pool(make_pool());
+    CHECK(renderer.active_mask() == 1);
+
+    auto frame = renderer.render();
+    CHECK(frame.full);
+    CHECK(renderer.node_count() == 8);
+
+    const auto &fb = renderer.framebuffer();
+    CHECK(fb.at(199, 199) == vt_colour(9));  // data mask background
+    CHECK(fb.at(230, 20) == vt_colour(3));   // first soft key
+    CHECK(fb.at(230, 70) == vt_colour(7));   // second soft key, default colour
+    CHECK(fb.at(230, 150) == vt_colour(8));  // soft key mask background
+
+    // Container stacks number (0..20) then rectangle (20..60)
+    auto rect = renderer.bounds_of(12);
+    REQUIRE(rect.has_value());
+    CHECK(*rect == Rect{0, 20, 40, 40});
+    CHECK(fb.at(0, 20) == vt_colour(12));  // border
+    CHECK(fb.at(20, 40) == vt_colour(14)); // fill
+
+    // Number text is drawn in white inside its rectangle
+    CHECK(count_colour(fb, Rect{0, 0, 100, 20}, vt_colour(1)) > 0);
+    CHECK(count_colour(fb, *renderer.bounds_of(13), vt_colour(1)) > 0);
+}
+
+TEST_CASE("VTRenderer paints an alarm mask from its typed body") {
+    AlarmMaskBody alarm;
+    alarm.background_color = 12;
+    alarm.soft_key_mask = 2;
+    alarm.acoustic_signal = 1;
+    ObjectPool pool;
+    pool.add(VTObject{}.set_id(0).set_type(ObjectType::WorkingSet).set_children({5}));
+    pool.add(VTObject{}.set_id(5).set_type(ObjectType::AlarmMask).set_alarm_mask_body(alarm));
+    pool.add(VTObject{}.set_id(2).set_type(ObjectType::SoftKeyMask).set_body(sized(60, 200)).set_children({20}));
+    pool.add(VTObject{}.set_id(20).set_type(ObjectType::Key).set_key_body(KeyBody{3, 1, 0}));
+
+    VTRenderer renderer(small_screen());
+    renderer.set_pool(pool);
+    CHECK(renderer.active_mask() == 5);
+    renderer.render();
+    const auto &fb = renderer.framebuffer();
+    CHECK(fb.at(100, 100) == vt_colour(12));
+    CHECK(fb.at(230, 20) == vt_colour(3)); // soft key mask taken from the alarm mask
+}
+
+TEST_CASE("VTRenderer numeric change repaints only the object") {
+    VTRenderer renderer(small_screen());
+    renderer.set_pool(make_pool());
+    renderer.render();
+
+    CHECK_FALSE(renderer.needs_render());
+    renderer.set_numeric_value(11, 42); // same as body value, but first override
+    renderer.render();
+
+    renderer.set_numeric_value(11, 42);
+    CHECK_FALSE(renderer.needs_render());
+
+    renderer.set_numeric_value(11, 7);
+    REQUIRE(renderer.dirty_rects().size() == 1);
+    CHECK(renderer.dirty_rects()[0] == Rect{0, 0, 100, 20});
+
+    auto frame = renderer.render();
+    CHECK_FALSE(frame.full);
+    CHECK(frame.rects == 1);
+    CHECK(frame.damage == Rect{0, 0, 100, 20});
+    CHECK(frame.pixels < 100 * 20 * 3);
+
+    SUBCASE("result matches a full repaint") {
+        auto partial = renderer.framebuffer().pixels();
+        renderer.invalidate_all();
+        renderer.render();
+        CHECK(partial == renderer.framebuffer().pixels());
+    }
+}
+
+TEST_CASE("VTRenderer hide and show") {
+    VTRenderer renderer(small_screen());
+    renderer.set_pool(make_pool());
+    renderer.render();
+
+    renderer.set_visible(10, false);
+    auto frame = renderer.render();
+    CHECK(frame.damage == Rect{0, 0, 100, 60});
+    CHECK(count_colour(renderer.framebuffer(), Rect{0, 0, 100, 60}, vt_colour(9)) == 100 * 60);
+
+    renderer.set_visible(10, true);
+    renderer.render();
+    CHECK(renderer.framebuffer().at(20, 40) == vt_colour(14));
+}
+
+TEST_CASE("VTRenderer dirty rects merge and cap") {
+    VTRenderer renderer(small_screen());
+    renderer.set_pool(make_pool());
+    renderer.render();
+
+    renderer.set_numeric_value(11, 1);
+    renderer.set_visible(12, false); // disjoint from 11
+    CHECK(renderer.dirty_rects().size() == 2);
+    renderer.set_visible(10, false); // covers both
+    CHECK(renderer.dirty_rects().size() == 1);
+}
+
+TEST_CASE("VTRenderer primitives") {
+    ObjectPool pool;
+    pool.add(VTObject{}.set_id(1).set_type(ObjectType::DataMask).set_body(sized(100, 100)).set_children(
+        {2, 3, 4, 5}));
+    pool.add(VTObject{}.set_id(2).set_type(ObjectType::Line).set_body(sized(10, 10, {1, 0})));
+    pool.add(VTObject{}.set_id(3).set_type(ObjectType::Meter).set_body(
+        sized(40, 40, {12, 1, 0, 0, 100, 0, 100, 0, 0, 0})));
+    pool.add(VTObject{}.set_id(4).set_type(ObjectType::LinearBarGraph).set_body(
+        sized(40, 10, {10, 1, 0, 0, 100, 0, 50, 0, 0, 0})));
+    pool.add(VTObject{}.set_id(5).set_type(ObjectType::PictureGraphic).set_body(sized(2, 2, {0xFF, 12, 10, 9, 14})));
+
+    VTRenderer renderer(VTRendererConfig{}.screen(100, 100));
+    renderer.set_position(2, 0, 0);
+    renderer.set_position(3, 50, 0);
+    renderer.set_position(4, 0, 50);
+    renderer.set_position(5, 90, 90);
+    renderer.set_pool(pool);
+    renderer.render();
+    const auto &fb = renderer.framebuffer();
+
+    // Diagonal line
+    CHECK(fb.at(0, 0) == vt_colour(1));
+    CHECK(fb.at(9, 9) == vt_colour(1));
+    CHECK(fb.at(9, 0) == vt_colour(0));
+
+    // Meter at max points right from the centre
+    CHECK(fb.at(80, 20) == vt_colour(12));
+    CHECK(count_colour(fb, Rect{50, 0, 40, 40}, vt_colour(12)) > 10);
+
+    // Bar graph half filled
+    CHECK(fb.at(10, 55) == vt_colour(10));
+    CHECK(fb.at(30, 55) == vt_colour(0));
+
+    // Bitmap pixels
+    CHECK(fb.at(90, 90) == vt_colour(12));
+    CHECK(fb.at(91, 90) == vt_colour(10));
+    CHECK(fb.at(90, 91) == vt_colour(9));
+    CHECK(fb.at(91, 91) == vt_colour(14));
+}
+
+TEST_CASE("VTServer drives the renderer from client commands") {
+    IsoNet nm;
+    Name name;
+    auto *cf = nm.create_internal(name, 0, 0x26).value();
+    VTServer server(nm, cf);
+    server.start();
+
+    VTRenderer renderer(small_screen());
+    server.set_renderer(&renderer);
+    server.set_active_working_set(0x81);
+    renderer.set_pool(make_pool());
+
+    CHECK(renderer.render().full);
+    CHECK(renderer.node_count() == 8);
+
+    nm.inject_message(Message(PGN_ECU_TO_VT, {vt_cmd::CHANGE_NUMERIC_VALUE, 11, 0, 0xFF, 99, 0, 0, 0}, 0x81, 0x26));
+    auto frame = renderer.render();
+    CHECK_FALSE(frame.full);
+    CHECK(frame.damage == Rect{0, 0, 100, 20});
+
+    // Commands from other working sets do not touch the screen
+    nm.inject_message(Message(PGN_ECU_TO_VT, {vt_cmd::HIDE_SHOW, 10, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF}, 0x82, 0x26));
+    CHECK_FALSE(renderer.needs_render());
+
+    nm.inject_message(Message(PGN_ECU_TO_VT, {vt_cmd::HIDE_SHOW, 10, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF}, 0x81, 0x26));
+    CHECK(renderer.render().damage == Rect{0, 0, 100, 60});
+}
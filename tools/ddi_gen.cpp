@@ -0,0 +1,262 @@
+// ─── DDI database generator ──────────────────────────────────────────────────
+// Rebuilds include/agrobus/isobus/tc/ddi_database.hpp from the ISO 11783-11
+// online database export (export.txt at the repository root):
+//
+//   ddi_gen <export.txt> <ddi_database.hpp>
+//
+// The generated part of the header (constants and the DDI_DATABASE table) is
+// rewritten; everything from the "DDI Lookup" section onwards is hand-written
+// and copied over from the existing header unchanged. Built and run by the
+// `ddi_database` CMake target (`make ddi`).
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct Entry {
+        unsigned ddi = 0;
+        std::string name;
+        std::string unit;
+        std::string resolution = "1.0";
+        long long min_value = 0;
+        long long max_value = 2147483647;
+    };
+
+    constexpr const char *LOOKUP_MARKER = "    // ─── DDI Lookup";
+
+    std::string trim(std::string s) {
+        auto not_space = [](unsigned char c) { return !std::isspace(c); };
+        s.erase(s.begin(), std::find_if(s.begin(), s.end(), not_space));
+        s.erase(std::find_if(s.rbegin(), s.rend(), not_space).base(), s.end());
+        return s;
+    }
+
+    bool starts_with(const std::string &s, const char *prefix) { return s.rfind(prefix, 0) == 0; }
+
+    std::string replace_all(std::string s, const std::string &from, const std::string &to) {
+        for (std::size_t pos = 0; (pos = s.find(from, pos)) != std::string::npos; pos += to.size())
+            s.replace(pos, from.size(), to);
+        return s;
+    }
+
+    // "mm³/m² - Capacity per area unit" -> "mm3/m2"; "not defined - ..." -> ""
+    std::string parse_unit(const std::string &field) {
+        std::string unit = field;
+        auto dash = unit.find(" - ");
+        if (dash != std::string::npos)
+            unit = unit.substr(0, dash);
+        unit = trim(unit);
+        if (unit == "not defined")
+            return "";
+        if (unit == "n.a." || unit == "n.a. -")
+            return "n.a. -";
+        unit = replace_all(unit, "³", "3");
+        unit = replace_all(unit, "²", "2");
+        unit = replace_all(unit, "°", "deg");
+        return unit;
+    }
+
+    // "0,01" -> "0.01", "1,0E-7" -> "1e-07", "1" -> "1.0"
+    std::string parse_resolution(const std::string &field) {
+        std::string s = replace_all(trim(field), ",", ".");
+        double v = std::strtod(s.c_str(), nullptr);
+        if (s.find_first_of("eE") != std::string::npos) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%g", v);
+            return buf;
+        }
+        if (s.find('.') == std::string::npos)
+            s += ".0";
+        return s;
+    }
+
+    // "-2147483648", "0xFFFFFFFF"; blank bounds keep the default. The table stores
+    // i32, so unsigned 32-bit ranges are clamped.
+    void parse_bound(const std::string &field, long long &out) {
+        std::string s = trim(field);
+        if (s.empty())
+            return;
+        out = std::clamp(std::strtoll(s.c_str(), nullptr, 0), -2147483648LL, 2147483647LL);
+    }
+
+    // "Setpoint Volume Per Area Application Rate as [mm³/m²]" -> without the unit suffix
+    std::string parse_name(const std::string &field) {
+        std::string name = trim(field);
+        for (const char *suffix : {" as [", " in ["}) {
+            auto pos = name.find(suffix);
+            if (pos != std::string::npos && name.back() == ']')
+                name = trim(name.substr(0, pos));
+        }
+        return replace_all(replace_all(name, "\\", "\\\\"), "\"", "\\\"");
+    }
+
+    // "Setpoint Volume Per Area Application Rate" -> SETPOINT_VOLUME_PER_AREA_APPLICATION_RATE
+    std::string constant_name(const std::string &name) {
+        std::string out;
+        bool gap = false;
+        for (unsigned char c : name) {
+            if (std::isalnum(c)) {
+                if (gap && !out.empty())
+                    out += '_';
+                out += static_cast<char>(std::toupper(c));
+                gap = false;
+            } else {
+                gap = true;
+            }
+        }
+        if (!out.empty() && std::isdigit(static_cast<unsigned char>(out[0])))
+            out = "N" + out;
+        return out;
+    }
+
+    std::vector<Entry> parse_export(std::istream &in, std::string &version) {
+        std::vector<Entry> entries;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (starts_with(line, "Version: ") && version.empty()) {
+                version = trim(line.substr(9));
+            } else if (starts_with(line, "DD Entity: ")) {
+                Entry e;
+                std::istringstream ss(line.substr(11));
+                ss >> e.ddi;
+                std::string rest;
+                std::getline(ss, rest);
+                e.name = parse_name(rest);
+                entries.push_back(e);
+            } else if (entries.empty()) {
+                continue;
+            } else if (starts_with(line, "Unit: ")) {
+                entries.back().unit = parse_unit(line.substr(6));
+            } else if (starts_with(line, "Resolution: ")) {
+                entries.back().resolution = parse_resolution(line.substr(12));
+            } else if (starts_with(line, "CANBus Range: ")) {
+                std::string range = line.substr(14);
+                auto sep = range.find(" - ");
+                if (sep != std::string::npos) {
+                    parse_bound(range.substr(0, sep), entries.back().min_value);
+                    parse_bound(range.substr(sep + 3), entries.back().max_value);
+                }
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.ddi < b.ddi; });
+        return entries;
+    }
+
+    void write_header(std::ostream &out, const std::vector<Entry> &entries, const std::string &version) {
+        char buf[256];
+        out << "#pragma once\n\n"
+            << "// ─── ISO 11783-11 Data Dictionary (DDI) Database ─────────────────────────────\n"
+            << "// Generated from ISO 11783-11 online database export, Version: " << version << "\n"
+            << "//\n"
+            << "// Copyright International Organization for Standardization, see:\n"
+            << "// www.iso.org/iso/copyright.htm\n"
+            << "// No reproduction on networking permitted without license from ISO.\n"
+            << "// The export file from the online data base is supplied without liability.\n"
+            << "// Hard and Saved copies of this document are considered uncontrolled and\n"
+            << "// represents a snap-shot of the ISO11783-11 online data base.\n"
+            << "//\n"
+            << "// Total entries: " << entries.size() << "\n"
+            << "// DDI range: " << entries.front().ddi << " - " << entries.back().ddi << "\n"
+            << "// ─────────────────────────────────────────────────────────────────────────────\n\n"
+            << "#include <agrobus/net/types.hpp>\n"
+            << "#include <datapod/datapod.hpp>\n\n"
+            << "namespace agrobus::isobus::tc {\n"
+            << "    using namespace agrobus::net;\n\n"
+            << "    // ─── DDI Entry structure ─────────────────────────────────────────────────\n"
+            << "    struct DDIDefinition {\n"
+            << "        u16 ddi;\n"
+            << "        const char *name;\n"
+            << "        const char *unit;\n"
+            << "        f64 resolution;\n"
+            << "        i32 min_value;\n"
+            << "        i32 max_value;\n"
+            << "    };\n\n"
+            << "    // Legacy alias\n"
+            << "    using DDIEntry = DDIDefinition;\n\n"
+            << "    // ─── DDI Constants (ISO 11783-11, complete) ──────────────────────────────\n"
+            << "    namespace ddi {\n\n";
+
+        std::vector<std::string> used;
+        for (const auto &e : entries) {
+            std::string name = constant_name(e.name);
+            if (std::find(used.begin(), used.end(), name) != used.end())
+                name += "_" + std::to_string(e.ddi);
+            used.push_back(name);
+            std::string decl = "        inline constexpr u16 " + name + " = " + std::to_string(e.ddi) + ";";
+            std::snprintf(buf, sizeof(buf), "// 0x%04X", e.ddi);
+            out << decl << std::string(decl.size() < 97 ? 97 - decl.size() : 1, ' ') << buf << "\n";
+        }
+
+        out << "\n"
+            << "        // ─── Convenience aliases ────────────────────────────────────────────────\n"
+            << "        inline constexpr u16 SETPOINT_VOLUME_PER_AREA = SETPOINT_VOLUME_PER_AREA_APPLICATION_RATE;\n"
+            << "        inline constexpr u16 ACTUAL_VOLUME_PER_AREA = ACTUAL_VOLUME_PER_AREA_APPLICATION_RATE;\n"
+            << "        inline constexpr u16 EFFECTIVE_TOTAL_AREA = TOTAL_AREA;\n"
+            << "        inline constexpr u16 SETPOINT_SECTION_CONTROL_STATE = SECTION_CONTROL_STATE;\n"
+            << "        inline constexpr u16 WORKING_WIDTH = ACTUAL_WORKING_WIDTH;\n\n"
+            << "    } // namespace ddi\n\n"
+            << "    // ─── Full DDI Database (" << entries.size() << " entries) ─────────────────────────────────\n"
+            << "    inline constexpr DDIDefinition DDI_DATABASE[] = {\n";
+
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            const auto &e = entries[i];
+            out << "        {" << e.ddi << ", \"" << e.name << "\", \"" << e.unit << "\", " << e.resolution << ", "
+                << e.min_value << ", " << e.max_value << "}" << (i + 1 < entries.size() ? ",\n" : "};\n");
+        }
+        out << "\n    inline constexpr usize DDI_DATABASE_SIZE = " << entries.size() << ";\n\n";
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "usage: ddi_gen <export.txt> <ddi_database.hpp>\n";
+        return 2;
+    }
+
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "ddi_gen: cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    std::string version;
+    auto entries = parse_export(in, version);
+    if (entries.empty()) {
+        std::cerr << "ddi_gen: no DD entities found in " << argv[1] << "\n";
+        return 1;
+    }
+
+    // Keep the hand-written tail (lookup, helpers, license notice)
+    std::string tail;
+    {
+        std::ifstream existing(argv[2]);
+        std::string line;
+        bool copying = false;
+        while (std::getline(existing, line)) {
+            copying = copying || starts_with(line, LOOKUP_MARKER);
+            if (copying)
+                tail += line + "\n";
+        }
+    }
+    if (tail.empty()) {
+        std::cerr << "ddi_gen: " << argv[2] << " has no DDI Lookup section to preserve\n";
+        return 1;
+    }
+
+    std::ostringstream out;
+    write_header(out, entries, version);
+    out << tail;
+    std::ofstream(argv[2], std::ios::trunc) << out.str();
+    std::cout << "ddi_gen: " << entries.size() << " entries (version " << version << ") -> " << argv[2] << "\n";
+    return 0;
+}